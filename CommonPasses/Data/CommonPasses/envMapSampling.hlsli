@@ -0,0 +1,99 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Importance sampling of our lat-long environment map.  The tables are built on the CPU by EnvMapSampler (see
+//     ResourceManager::updateEnvironmentMap()) and picks texels proportionally to luminance * sin(theta) using a 2D
+//     alias table:  the marginal table picks a row, then that row's conditional table picks a column.  Both steps are O(1).
+//  -> Requires nextRand() and wsVectorToLatLong() (see simpleDiffuseGIUtils.hlsli) to be defined before inclusion.
+
+// Per texel: x = probability of keeping this column, y = alias column, z = density of the texel in uv-space
+Texture2D<float4> gEnvConditional;
+
+// Per row:   x = probability of keeping this row, y = alias row
+Texture2D<float2> gEnvMarginal;
+
+// Inverse of wsVectorToLatLong()
+float3 latLongToWsVector(float2 uv)
+{
+	float theta = uv.y * M_PI;
+	float phi = (2.0f * uv.x - 1.0f) * M_PI;
+	float sinTheta = sin(theta);
+	return float3(sinTheta * sin(phi), cos(theta), -sinTheta * cos(phi));
+}
+
+// Pick an entry from an alias table.  The random number is re-used to place the sample inside the selected entry.
+uint selectAlias(uint index, float f, float2 entry, out float jitter)
+{
+	if (f < entry.x)
+	{
+		jitter = f / entry.x;
+		return index;
+	}
+	jitter = (f - entry.x) / (1.0f - entry.x);
+	return uint(entry.y);
+}
+
+// Converts the uv-space density stored in the table to a density over solid angle
+float envMapUVPdfToSolidAngle(float uvPdf, float v)
+{
+	float sinTheta = sin(v * M_PI);
+	return (sinTheta > 0.0f) ? uvPdf / (2.0f * M_PI * M_PI * sinTheta) : 0.0f;
+}
+
+// Density over solid angle of picking direction 'dir' with sampleEnvMap()
+float envMapPdf(float3 dir)
+{
+	uint2 dims;
+	gEnvConditional.GetDimensions(dims.x, dims.y);
+	float2 uv = wsVectorToLatLong(dir);
+	uint2 texel = min(uint2(uv * dims), dims - 1);
+	return envMapUVPdfToSolidAngle(gEnvConditional[texel].z, uv.y);
+}
+
+// Pick a direction towards the environment proportionally to its brightness.
+//    -> Returns the direction, plus its lat-long coordinate and its density over solid angle
+float3 sampleEnvMap(inout uint randSeed, out float2 uv, out float pdf)
+{
+	uint2 dims;
+	gEnvConditional.GetDimensions(dims.x, dims.y);
+	float2 u = float2(nextRand(randSeed), nextRand(randSeed));
+
+	// Pick a row, then a column in that row
+	float2 jitter;
+	float y = u.y * dims.y;
+	uint row = min(uint(y), dims.y - 1);
+	row = selectAlias(row, y - row, gEnvMarginal[uint2(row, 0)], jitter.y);
+
+	float x = u.x * dims.x;
+	uint col = min(uint(x), dims.x - 1);
+	col = selectAlias(col, x - col, gEnvConditional[uint2(col, row)].xy, jitter.x);
+
+	// Uniformly place the sample inside the texel
+	uv = (float2(col, row) + min(jitter, 0.99999994f)) / float2(dims);
+	uint2 texel = min(uint2(uv * dims), dims - 1);
+	pdf = envMapUVPdfToSolidAngle(gEnvConditional[texel].z, uv.y);
+	return latLongToWsVector(uv);
+}
+
+// The power heuristic (with beta = 2) for multiple importance sampling
+float misPowerHeuristic(float pdfA, float pdfB)
+{
+	float a2 = pdfA * pdfA;
+	float b2 = pdfB * pdfB;
+	return (a2 + b2 > 0.0f) ? a2 / (a2 + b2) : 0.0f;
+}
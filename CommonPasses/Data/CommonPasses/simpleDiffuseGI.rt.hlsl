@@ -39,6 +39,7 @@ cbuffer RayGenCB
 	uint  gFrameCount;     // An integer changing every frame to update the random number
 	bool  gDoIndirectGI;   // A boolean determining if we should shoot indirect GI rays
 	bool  gCosSampling;    // Use cosine sampling (true) or uniform sampling (false)
+	bool  gEnvSampling;    // Also importance sample the environment map, and combine both strategies with MIS
 }
 
 // Input and out textures that need to be set by the C++ code (for the ray gen shader)
@@ -52,11 +53,15 @@ struct IndirectRayPayload
 {
 	float3 color;    // The (returned) color in the ray's direction
 	uint   rndSeed;  // Our random seed, so we pick uncorrelated RNGs along our ray
+	float  misPdf;   // Density the ray direction was picked with, if the environment is also sampled directly (0 otherwise)
 };
 
 // Our environment map, used for the miss shader for indirect rays
 Texture2D<float4> gEnvMap;
 
+// Tables to importance sample gEnvMap (for next event estimation against the environment)
+#include "envMapSampling.hlsli"
+
 // What code is executed when our ray misses all geometry?
 [shader("miss")]
 void IndirectMiss(inout IndirectRayPayload rayData)
@@ -70,6 +75,10 @@ void IndirectMiss(inout IndirectRayPayload rayData)
 
 	// Load our background color, then store it into our ray payload
 	rayData.color = gEnvMap[uint2(uv * dims)].rgb;
+
+	// If the environment was also sampled directly, weight this sample for MIS
+	if (rayData.misPdf > 0.0f)
+		rayData.color *= misPowerHeuristic(rayData.misPdf, envMapPdf(WorldRayDirection()));
 }
 
 [shader("anyhit")]
@@ -109,7 +118,7 @@ void IndirectClosestHit(inout IndirectRayPayload rayData, BuiltInTriangleInterse
 
 // A utility function to trace an idirect ray and return the color it sees.
 //    -> Note:  This assumes the indirect hit programs and miss programs are index 1!
-float3 shootIndirectRay(float3 rayOrigin, float3 rayDir, float minT, uint seed)
+float3 shootIndirectRay(float3 rayOrigin, float3 rayDir, float minT, uint seed, float misPdf)
 {
 	// Setup shadow ray
 	RayDesc rayColor;
@@ -122,6 +131,7 @@ float3 shootIndirectRay(float3 rayOrigin, float3 rayDir, float minT, uint seed)
 	IndirectRayPayload payload;
 	payload.color = float3(0, 0, 0);  
 	payload.rndSeed = seed;
+	payload.misPdf = misPdf;
 
 	// Trace our ray to get a color in the indirect direction.  Use hit group #1 and miss shader #1
 	TraceRay(gRtScene, 0, 0xFF, 1, hitProgramCount, 1, rayColor, payload);
@@ -182,14 +192,36 @@ void SimpleDiffuseGIRayGen()
 			// Get NdotL for our selected ray direction
 			float NdotL = saturate(dot(worldNorm.xyz, bounceDir));
 
-			// Shoot our indirect global illumination ray
-			float3 bounceColor = shootIndirectRay(worldPos.xyz, bounceDir, gMinT, randSeed);
-
 			// Probability of selecting this ray ( cos/pi for cosine sampling, 1/2pi for uniform sampling )
 			float sampleProb = gCosSampling ? (NdotL / M_PI) : (1.0f / (2.0f * M_PI));
 
+			// Shoot our indirect global illumination ray.  If it escapes, the miss shader applies the MIS weight.
+			float3 bounceColor = shootIndirectRay(worldPos.xyz, bounceDir, gMinT, randSeed, gEnvSampling ? sampleProb : 0.0f);
+
 			// Accumulate the color.  For performance, terms could (and should) be cancelled here.
 			shadeColor += (NdotL * bounceColor * difMatlColor.rgb / M_PI) / sampleProb;
+
+			// Next event estimation against the environment:  pick a bright direction and check if it's visible
+			if (gEnvSampling)
+			{
+				float2 envUV;
+				float envProb;
+				float3 envDir = sampleEnvMap(randSeed, envUV, envProb);
+				float envNdotL = dot(worldNorm.xyz, envDir);
+				if (envNdotL > 0.0f && envProb > 0.0f)
+				{
+					float envVis = shadowRayVisibility(worldPos.xyz, envDir, gMinT, 1.0e38f);
+
+					// Density the hemisphere sampling above would have picked this direction with
+					float bsdfProb = gCosSampling ? (envNdotL / M_PI) : (1.0f / (2.0f * M_PI));
+					float misWeight = misPowerHeuristic(envProb, bsdfProb);
+
+					uint2 envDims;
+					gEnvMap.GetDimensions(envDims.x, envDims.y);
+					float3 envColor = gEnvMap[min(uint2(envUV * envDims), envDims - 1)].rgb;
+					shadeColor += misWeight * envVis * (envNdotL * envColor * difMatlColor.rgb / M_PI) / envProb;
+				}
+			}
 		}
 	}
 	
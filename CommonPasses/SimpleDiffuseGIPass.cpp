@@ -82,6 +82,7 @@ void SimpleDiffuseGIPass::renderGui(Gui* pGui)
 	dirty |= (int)pGui->addCheckBox(mDoIndirectGI ? "Shooting global illumination rays" : "Skipping global illumination", 
 		                            mDoIndirectGI);
 	dirty |= (int)pGui->addCheckBox(mDoCosSampling ? "Use cosine sampling" : "Use uniform sampling", mDoCosSampling);
+	dirty |= (int)pGui->addCheckBox(mDoEnvSampling ? "Importance sampling environment (MIS)" : "Not sampling environment directly", mDoEnvSampling);
 	if (dirty) setRefreshFlag();
 }
 
@@ -94,12 +95,18 @@ void SimpleDiffuseGIPass::execute(RenderContext* pRenderContext)
 	// Do we have all the resources we need to render?  If not, return
 	if (!pDstTex || !mpRays || !mpRays->readyToRender()) return;
 
+	// The environment map's sampling tables only exist once the resource manager has loaded a map
+	Texture::SharedPtr pEnvConditional = mpResManager->getTexture(ResourceManager::kEnvironmentMapConditional);
+	Texture::SharedPtr pEnvMarginal    = mpResManager->getTexture(ResourceManager::kEnvironmentMapMarginal);
+	bool doEnvSampling = mDoEnvSampling && pEnvConditional && pEnvMarginal;
+
 	// Set our shader variables for the ray generation shader
 	auto rayGenVars = mpRays->getRayGenVars();
 	rayGenVars["RayGenCB"]["gMinT"]         = mpResManager->getMinTDist();
 	rayGenVars["RayGenCB"]["gFrameCount"]   = mFrameCount++;
 	rayGenVars["RayGenCB"]["gDoIndirectGI"] = mDoIndirectGI;
 	rayGenVars["RayGenCB"]["gCosSampling"]  = mDoCosSampling;
+	rayGenVars["RayGenCB"]["gEnvSampling"]  = doEnvSampling;
 	rayGenVars["RayGenCB"]["gDirectShadow"] = mDoDirectShadows;
 
 	// Pass our G-buffer textures down to the HLSL so we can shade
@@ -108,9 +115,16 @@ void SimpleDiffuseGIPass::execute(RenderContext* pRenderContext)
 	rayGenVars["gDiffuseMatl"] = mpResManager->getTexture("MaterialDiffuse");
 	rayGenVars["gOutput"]      = pDstTex;
 
+	// Our ray generation shader samples the environment map directly (next event estimation)
+	rayGenVars["gEnvMap"]         = mpResManager->getTexture(ResourceManager::kEnvironmentMap);
+	rayGenVars["gEnvConditional"] = pEnvConditional;
+	rayGenVars["gEnvMarginal"]    = pEnvMarginal;
+
 	// Set our environment map texture for indirect rays that miss geometry 
 	auto missVars = mpRays->getMissVars(1);       // Remember, indirect rays are ray type #1
 	missVars["gEnvMap"] = mpResManager->getTexture(ResourceManager::kEnvironmentMap);
+	missVars["gEnvConditional"] = pEnvConditional;   // Needed to compute MIS weights for escaped rays
+	missVars["gEnvMarginal"]    = pEnvMarginal;
 
 	// Execute our shading pass and shoot indirect rays
 	mpRays->execute( pRenderContext, uvec2(pDstTex->getWidth(), pDstTex->getHeight()) );
@@ -57,6 +57,7 @@ protected:
 	bool                                    mDoIndirectGI = true;
 	bool                                    mDoCosSampling = true;
 	bool                                    mDoDirectShadows = true;
+	bool                                    mDoEnvSampling = true;  ///< Importance sample the environment map and combine with MIS
     
 	// Various internal parameters
 	uint32_t                                mFrameCount = 0x1337u;  ///< A frame counter to vary random numbers over time
@@ -58,6 +58,13 @@ void SimpleGBufferPass::initScene(RenderContext* pRenderContext, Scene::SharedPt
 		mpRaster->setScene(mpScene);
 }
 
+void SimpleGBufferPass::renderGui(Gui* pGui)
+{
+	// Show the draw sorting toggle and the state changes / CPU time of the last frame's scene submission
+	if (mpRaster && mpRaster->getSceneRenderer())
+		mpRaster->getSceneRenderer()->renderUI(pGui, "Scene submission");
+}
+
 void SimpleGBufferPass::execute(RenderContext* pRenderContext)
 {
 	// Create a framebuffer for rendering.  (Creating once per frame is for simplicity, not performance).
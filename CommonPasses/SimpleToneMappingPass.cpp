@@ -38,6 +38,9 @@ bool SimpleToneMappingPass::initialize(RenderContext* pRenderContext, ResourceMa
 	// Falcor has a built-in utility for tonemapping.  Initialize that
 	mpToneMapper = ToneMapping::create(ToneMapping::Operator::Clamp);
 
+	// Compute the exposure from a luminance histogram on the GPU, rather than a luminance mip chain.  (Unused by the clamp operator.)
+	mpToneMapper->setExposureMode(ToneMapping::ExposureMode::Histogram);
+
 	return true;
 }
 
@@ -63,9 +63,14 @@ namespace Falcor
         }
     }
 
-    CopyContext::ReadTextureTask::SharedPtr CopyContext::asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex)
+    bool CopyContext::ReadTextureTask::isReady() const
     {
-        return CopyContext::ReadTextureTask::create(shared_from_this(), pTexture, subresourceIndex);
+        return mpFence->getGpuValue() >= mFenceValue;
+    }
+
+    CopyContext::ReadTextureTask::SharedPtr CopyContext::asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex, const Buffer::SharedPtr& pBuffer, bool flush)
+    {
+        return CopyContext::ReadTextureTask::create(shared_from_this(), pTexture, subresourceIndex, pBuffer, flush);
     }
 
     std::vector<uint8> CopyContext::readTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex)
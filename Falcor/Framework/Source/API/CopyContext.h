@@ -45,11 +45,25 @@ namespace Falcor
         {
         public:
             using SharedPtr = std::shared_ptr<ReadTextureTask>;
-            static SharedPtr create(CopyContext::SharedPtr pCtx, const Texture* pTexture, uint32_t subresourceIndex);
+
+            /** Copy a subresource to a staging buffer.
+                \param[in] pBuffer A staging buffer to copy into. If it's null or too small, a new one is created. The caller must make sure no other task still uses it.
+                \param[in] flush If false, the copy is submitted with the context's next flush. getData() flushes the context if it's called before that.
+            */
+            static SharedPtr create(CopyContext::SharedPtr pCtx, const Texture* pTexture, uint32_t subresourceIndex, const Buffer::SharedPtr& pBuffer = nullptr, bool flush = true);
             std::vector<uint8> getData();
+
+            /** Check if the GPU finished the copy. If it did, getData() won't block.
+            */
+            bool isReady() const;
+
+            /** Get the staging buffer, so it can be reused once the data was read
+            */
+            const Buffer::SharedPtr& getBuffer() const { return mpBuffer; }
         private:
             ReadTextureTask() = default;
             GpuFence::SharedPtr mpFence;
+            uint64_t mFenceValue = 0;       // The value the fence reaches once the copy is done
             Buffer::SharedPtr mpBuffer;
             CopyContext::SharedPtr mpContext;
 #ifdef FALCOR_D3D12
@@ -85,6 +99,27 @@ namespace Falcor
         */
         virtual void uavBarrier(const Resource* pResource);
 
+        /** A whole-resource transition for resourceBarriers()
+        */
+        struct ResourceTransition
+        {
+            enum class Split
+            {
+                None,   ///< A complete transition
+                Begin,  ///< Start the transition. The tracked state of the resource doesn't change.
+                End,    ///< Complete a transition started with Begin and the same new state. The resource must not be used in between.
+            };
+
+            const Resource* pResource;
+            Resource::State newState;
+            Split split;
+        };
+
+        /** Record a batch of whole-resource transitions and UAV barriers in a single API call.
+            Transitions to the current state are skipped. Resources with per-subresource states are transitioned separately, and are never split.
+        */
+        void resourceBarriers(const std::vector<ResourceTransition>& transitions, const std::vector<const Resource*>& uavResources);
+
         /** Copy an entire resource
         */
         void copyResource(const Resource* pDst, const Resource* pSrc);
@@ -120,9 +155,9 @@ namespace Falcor
         */
         std::vector<uint8> readTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex);
 
-        /** Read texture data Asynchronously
+        /** Read texture data Asynchronously. See ReadTextureTask::create() for the optional arguments.
         */
-        ReadTextureTask::SharedPtr asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex);
+        ReadTextureTask::SharedPtr asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex, const Buffer::SharedPtr& pBuffer = nullptr, bool flush = true);
         
         /** Get the low-level context data
         */
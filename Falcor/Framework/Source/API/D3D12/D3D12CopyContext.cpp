@@ -143,7 +143,7 @@ namespace Falcor
         pBuffer->unmap();
     }
 
-    CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(CopyContext::SharedPtr pCtx, const Texture* pTexture, uint32_t subresourceIndex)
+    CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(CopyContext::SharedPtr pCtx, const Texture* pTexture, uint32_t subresourceIndex, const Buffer::SharedPtr& pBuffer, bool flush)
     {
         SharedPtr pThis = SharedPtr(new ReadTextureTask);
         pThis->mpContext = pCtx;
@@ -155,19 +155,20 @@ namespace Falcor
         ID3D12Device* pDevice = gpDevice->getApiHandle();
         pDevice->GetCopyableFootprints(&texDesc, subresourceIndex, 1, 0, &footprint, &pThis->mRowCount, &rowSize, &size);
 
-        //Create buffer 
-        pThis->mpBuffer = Buffer::create(size, Buffer::BindFlags::None, Buffer::CpuAccess::Read, nullptr);
+        //Create buffer, unless the caller's is large enough
+        pThis->mpBuffer = (pBuffer && pBuffer->getSize() >= size) ? pBuffer : Buffer::create(size, Buffer::BindFlags::None, Buffer::CpuAccess::Read, nullptr);
 
         //Copy from texture to buffer
         D3D12_TEXTURE_COPY_LOCATION srcLoc = { pTexture->getApiHandle(), D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX, subresourceIndex };
         D3D12_TEXTURE_COPY_LOCATION dstLoc = { pThis->mpBuffer->getApiHandle(), D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT, footprint };
         pCtx->resourceBarrier(pTexture, Resource::State::CopySource);
         pCtx->getLowLevelData()->getCommandList()->CopyTextureRegion(&dstLoc, 0, 0, 0, &srcLoc, nullptr);
+        pCtx->setPendingCommands(true);
 
-        // Create a fence and signal
-        pThis->mpFence = GpuFence::create();
-        pCtx->flush(false);
-        pThis->mpFence->gpuSignal(pCtx->getLowLevelData()->getCommandQueue());
+        // The context signals its fence on every flush. The copy is done once it reaches the value of the next signal.
+        pThis->mpFence = pCtx->getLowLevelData()->getFence();
+        pThis->mFenceValue = pThis->mpFence->getCpuValue();
+        if (flush) pCtx->flush(false);
         pThis->mTextureFormat = pTexture->getFormat();
 
         return pThis;
@@ -175,7 +176,13 @@ namespace Falcor
 
     std::vector<uint8_t> CopyContext::ReadTextureTask::getData()
     {
-        mpFence->syncCpu();
+        // The fence belongs to the context, so syncCpu() also waits for the work submitted after the copy. Only wait if the copy isn't done.
+        if (isReady() == false)
+        {
+            // Submit the copy if the context wasn't flushed since
+            if (mpFence->getCpuValue() <= mFenceValue) mpContext->flush(false);
+            mpFence->syncCpu();
+        }
         D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = mFootprint;
 
         //Get buffer data
@@ -274,6 +281,57 @@ namespace Falcor
         mCommandsPending = true;
     }
 
+    void CopyContext::resourceBarriers(const std::vector<ResourceTransition>& transitions, const std::vector<const Resource*>& uavResources)
+    {
+        std::vector<D3D12_RESOURCE_BARRIER> barriers;
+        barriers.reserve(transitions.size() + uavResources.size());
+
+        for (const auto& t : transitions)
+        {
+            if (t.pResource->getType() == Resource::Type::Buffer)
+            {
+                if (static_cast<const Buffer*>(t.pResource)->getCpuAccess() != Buffer::CpuAccess::None) continue;
+            }
+            else if (t.pResource->isStateGlobal() == false)
+            {
+                if (t.split != ResourceTransition::Split::Begin) resourceBarrier(t.pResource, t.newState);
+                continue;
+            }
+
+            // The tracked state doesn't change until the End half, so it's also the before state of a split transition
+            Resource::State oldState = t.pResource->getGlobalState();
+            if (oldState == t.newState) continue;
+
+            D3D12_RESOURCE_BARRIER barrier;
+            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+            if (t.split == ResourceTransition::Split::Begin) barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+            if (t.split == ResourceTransition::Split::End) barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+            barrier.Transition.pResource = t.pResource->getApiHandle();
+            barrier.Transition.StateBefore = getD3D12ResourceState(oldState);
+            barrier.Transition.StateAfter = getD3D12ResourceState(t.newState);
+            barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+            barriers.push_back(barrier);
+
+            if (t.split != ResourceTransition::Split::Begin) t.pResource->setGlobalState(t.newState);
+        }
+
+        for (const Resource* pResource : uavResources)
+        {
+            D3D12_RESOURCE_BARRIER barrier;
+            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+            barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+            barrier.UAV.pResource = pResource->getApiHandle();
+            barriers.push_back(barrier);
+        }
+
+        if (barriers.size())
+        {
+            mpLowLevelData->getCommandList()->ResourceBarrier((uint32_t)barriers.size(), barriers.data());
+            mCommandsPending = true;
+        }
+    }
+
     void CopyContext::copyResource(const Resource* pDst, const Resource* pSrc)
     {
         resourceBarrier(pDst, Resource::State::CopyDest);
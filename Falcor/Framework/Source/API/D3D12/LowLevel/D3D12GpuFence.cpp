@@ -72,6 +72,12 @@ namespace Falcor
         d3d_call(pQueue->Wait(mApiHandle, mCpuValue - 1));
     }
 
+    void GpuFence::syncGpu(CommandQueueHandle pQueue, uint64_t value)
+    {
+        assert(value < mCpuValue);
+        d3d_call(pQueue->Wait(mApiHandle, value));
+    }
+
     void GpuFence::syncCpu()
     {
         uint64_t gpuVal = getGpuValue();
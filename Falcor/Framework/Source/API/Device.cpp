@@ -183,6 +183,7 @@ namespace Falcor
 
         mpRenderContext.reset();
         mpResourceAllocator.reset();
+        mpGpuDescPool->clearSetCache();
         mpCpuDescPool.reset();
         mpGpuDescPool.reset();
         mpFrameFence.reset();
@@ -120,6 +120,10 @@ namespace Falcor
         */
         CommandQueueHandle getCommandQueueHandle(LowLevelContextData::CommandQueueType type, uint32_t index) const;
 
+        /** Get the number of command queues of a type, as requested in Desc::cmdQueues
+        */
+        uint32_t getCommandQueueCount(LowLevelContextData::CommandQueueType type) const { return (uint32_t)mCmdQueues[(uint32_t)type].size(); }
+
         /** Get the API queue type
         */
         ApiCommandQueueType getApiCommandQueueType(LowLevelContextData::CommandQueueType type) const;
@@ -43,17 +43,33 @@ namespace Falcor
     void DescriptorPool::executeDeferredReleases()
     {
         uint64_t gpuVal = mpFence->getGpuValue();
-        while (mpDeferredReleases.size() && mpDeferredReleases.top().fenceValue <= gpuVal)
+        while (mDeferredReleases.size() && mDeferredReleases.front().fenceValue <= gpuVal)
         {
-            mpDeferredReleases.pop();
+            mDeferredReleases.pop();
         }
+
+        // Evicted sets are released like any other set, so the GPU can finish using them
+        mSetCache.evictStale(mpFence->getCpuValue());
     }
 
     void DescriptorPool::releaseAllocation(std::shared_ptr<DescriptorSetApiData> pData)
     {
-        DeferredRelease d;
-        d.pData = pData;
-        d.fenceValue = mpFence->getCpuValue();
-        mpDeferredReleases.push(d);
+        uint64_t fenceValue = mpFence->getCpuValue();
+        if (mDeferredReleases.empty() || mDeferredReleases.back().fenceValue != fenceValue)
+        {
+            mDeferredReleases.push({ {}, fenceValue });
+        }
+        mDeferredReleases.back().data.push_back(std::move(pData));
+    }
+
+    std::shared_ptr<DescriptorSet> DescriptorPool::findCachedSet(const DescriptorTableKey& key)
+    {
+        const auto* pSet = mSetCache.find(key, mpFence->getCpuValue());
+        return pSet ? *pSet : nullptr;
+    }
+
+    void DescriptorPool::addCachedSet(const DescriptorTableKey& key, const std::shared_ptr<DescriptorSet>& pSet, std::vector<std::shared_ptr<const void>> views)
+    {
+        mSetCache.insert(key, pSet, std::move(views), mpFence->getCpuValue());
     }
 }
@@ -29,6 +29,7 @@
 #include "Framework.h"
 #include <queue>
 #include "API/LowLevel/GpuFence.h"
+#include "API/LowLevel/DescriptorTableCache.h"
 #include <functional>
 
 namespace Falcor
@@ -94,7 +95,31 @@ namespace Falcor
         bool isShaderVisible() const { return mDesc.mShaderVisible; }
         const ApiHandle& getApiHandle(uint32_t heapIndex) const;
         const ApiData* getApiData() const { return mpApiData.get(); }
+
+        /** Release the sets whose fence value was reached, and retire the cached tables which weren't used recently
+        */
         void executeDeferredReleases();
+
+        using TableCache = DescriptorTableCache<std::shared_ptr<DescriptorSet>>;
+
+        /** Look for a filled set with the given contents
+            \param[in] key The layout and the views of the set
+            \return The cached set, or nullptr if there is none
+        */
+        std::shared_ptr<DescriptorSet> findCachedSet(const DescriptorTableKey& key);
+
+        /** Add a filled set to the cache. The set must not be modified afterwards.
+            \param[in] key The layout and the views of the set
+            \param[in] pSet The set
+            \param[in] views The views referenced by the key
+        */
+        void addCachedSet(const DescriptorTableKey& key, const std::shared_ptr<DescriptorSet>& pSet, std::vector<std::shared_ptr<const void>> views);
+
+        /** Remove all the cached sets. The cached sets reference the pool, so this must be called before releasing it.
+        */
+        void clearSetCache() { mSetCache.clear(); }
+
+        const TableCache::Stats& getSetCacheStats() const { return mSetCache.getStats(); }
     private:
         friend DescriptorSet;
         DescriptorPool(const Desc& desc, GpuFence::SharedPtr pFence);
@@ -104,13 +129,14 @@ namespace Falcor
         std::shared_ptr<ApiData> mpApiData;
         GpuFence::SharedPtr mpFence;
 
-        struct DeferredRelease
+        // Releases are batched by fence value. The fence values only increase, so the batches are retired in order.
+        struct DeferredReleaseBatch
         {
-            std::shared_ptr<DescriptorSetApiData> pData;
+            std::vector<std::shared_ptr<DescriptorSetApiData>> data;
             uint64_t fenceValue;
-            bool operator>(const DeferredRelease& other) const { return fenceValue > other.fenceValue; }
         };
 
-        std::priority_queue<DeferredRelease, std::vector<DeferredRelease>, std::greater<DeferredRelease>> mpDeferredReleases;
+        std::queue<DeferredReleaseBatch> mDeferredReleases;
+        TableCache mSetCache;
     };
 }
@@ -0,0 +1,178 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace Falcor
+{
+    /** Identifies the contents of a descriptor table: its layout and the views bound to it. Built by appending words; two keys match only if all their words do.
+    */
+    struct DescriptorTableKey
+    {
+        std::vector<uint64_t> words;
+        size_t hash = 14695981039346656037ull;
+
+        void add(uint64_t word)
+        {
+            words.push_back(word);
+            hash = (hash ^ word) * 1099511628211ull;
+        }
+
+        void add(const void* ptr) { add(uint64_t(uintptr_t(ptr))); }
+
+        void clear()
+        {
+            words.clear();
+            hash = DescriptorTableKey().hash;
+        }
+
+        bool operator==(const DescriptorTableKey& other) const { return hash == other.hash && words == other.words; }
+
+        struct Hasher
+        {
+            size_t operator()(const DescriptorTableKey& key) const { return key.hash; }
+        };
+    };
+
+    /** Cache of filled descriptor tables, keyed by their contents. Rebinding the same views reuses the existing table instead of allocating and filling a new one.
+        Tables are immutable once filled, so one table can be bound by several blocks and in several frames.
+        Each entry keeps a reference to the views it was built from, so their addresses (which the keys use) can't be recycled while the entry exists.
+        Entries are retired in bulk by evictStale() once they haven't been used for maxAge fence values, and the least recently used ones are evicted when the cache is full.
+    */
+    template<typename TableType>
+    class DescriptorTableCache
+    {
+    public:
+        struct Stats
+        {
+            uint64_t lookupCount = 0;
+            uint64_t hitCount = 0;
+            uint64_t insertCount = 0;
+            uint64_t staleEvictionCount = 0;        ///< Entries retired by evictStale()
+            uint64_t capacityEvictionCount = 0;     ///< Entries evicted because the cache was full
+
+            float getHitRate() const { return lookupCount ? float(hitCount) / float(lookupCount) : 0.0f; }
+        };
+
+        /** Create a cache
+            \param[in] maxEntries The maximum number of cached tables
+            \param[in] maxAge Entries not used for this many fence values are retired by evictStale()
+        */
+        DescriptorTableCache(uint32_t maxEntries = 4096, uint64_t maxAge = 8) : mMaxEntries(maxEntries), mMaxAge(maxAge) {}
+
+        /** Look for a table
+            \param[in] key The table contents
+            \param[in] fenceValue The fence value of the work which will use the table
+            \return The cached table, or nullptr if there is none
+        */
+        const TableType* find(const DescriptorTableKey& key, uint64_t fenceValue)
+        {
+            mStats.lookupCount++;
+            auto it = mEntries.find(key);
+            if (it == mEntries.end()) return nullptr;
+
+            // Move the entry to the back of the LRU list
+            mStats.hitCount++;
+            it->second->lastUse = fenceValue;
+            mLru.splice(mLru.end(), mLru, it->second);
+            return &it->second->table;
+        }
+
+        /** Add a table. If the cache is full, the least recently used entry is evicted.
+            \param[in] key The table contents
+            \param[in] table The table
+            \param[in] views The objects referenced by the key, kept alive while the table is cached
+            \param[in] fenceValue The fence value of the work which will use the table
+        */
+        void insert(const DescriptorTableKey& key, const TableType& table, std::vector<std::shared_ptr<const void>> views, uint64_t fenceValue)
+        {
+            if (mMaxEntries == 0) return;
+            auto it = mEntries.find(key);
+            if (it != mEntries.end()) erase(it->second);
+            while (mEntries.size() >= mMaxEntries)
+            {
+                erase(mLru.begin());
+                mStats.capacityEvictionCount++;
+            }
+
+            mLru.push_back({ table, std::move(views), fenceValue, nullptr });
+            auto entryIt = mEntries.emplace(key, std::prev(mLru.end())).first;
+            mLru.back().pKey = &entryIt->first;
+            mStats.insertCount++;
+        }
+
+        /** Retire the entries which weren't used by recent work. The LRU list is ordered by last use, so this only touches the retired entries.
+            \param[in] fenceValue The current CPU fence value
+        */
+        void evictStale(uint64_t fenceValue)
+        {
+            while (mLru.size() && mLru.front().lastUse + mMaxAge < fenceValue)
+            {
+                erase(mLru.begin());
+                mStats.staleEvictionCount++;
+            }
+        }
+
+        /** Remove all the entries
+        */
+        void clear()
+        {
+            mEntries.clear();
+            mLru.clear();
+        }
+
+        size_t getEntryCount() const { return mEntries.size(); }
+        const Stats& getStats() const { return mStats; }
+        void resetStats() { mStats = Stats(); }
+
+    private:
+        struct Entry
+        {
+            TableType table;
+            std::vector<std::shared_ptr<const void>> views;
+            uint64_t lastUse;
+            const DescriptorTableKey* pKey;     ///< The key in mEntries, used to erase the entry when it's evicted
+        };
+
+        using LruList = std::list<Entry>;
+
+        void erase(typename LruList::iterator it)
+        {
+            mEntries.erase(mEntries.find(*it->pKey));
+            mLru.erase(it);
+        }
+
+        uint32_t mMaxEntries;
+        uint64_t mMaxAge;
+        LruList mLru;       ///< Least recently used first
+        std::unordered_map<DescriptorTableKey, typename LruList::iterator, DescriptorTableKey::Hasher> mEntries;
+        Stats mStats;
+    };
+}
@@ -63,6 +63,10 @@ namespace Falcor
         */
         void syncGpu(CommandQueueHandle pQueue);
 
+        /** Tell the GPU to wait until the fence reaches a value returned by gpuSignal(). Use it when later signals shouldn't delay the wait.
+        */
+        void syncGpu(CommandQueueHandle pQueue, uint64_t value);
+
         /** Tell the CPU to wait until the fence reaches the current value
         */
         void syncCpu();
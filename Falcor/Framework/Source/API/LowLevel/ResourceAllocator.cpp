@@ -31,107 +31,54 @@
 
 namespace Falcor
 {
-    ResourceAllocator::~ResourceAllocator()
+    ResourceAllocator::ResourceAllocator(size_t pageSize, GpuFence::SharedPtr pFence) : mpFence(pFence), mPageSize(pageSize)
     {
-        mDeferredReleases = decltype(mDeferredReleases)();
+        TransientAllocator::Desc desc;
+        desc.pageSize = align_to(TransientAllocator::kMinAlignment, pageSize);
+
+        TransientAllocator::Callbacks callbacks;
+        callbacks.createPage = [this](uint32_t page, uint64_t size)
+        {
+            if (page >= mPages.size()) mPages.resize(page + 1);
+            initBasePageData(mPages[page], size_t(size));
+        };
+        // Buffers still referencing the page hold a reference to the resource, so it's only destroyed once they're gone
+        callbacks.destroyPage = [this](uint32_t page) { mPages[page] = BaseData(); };
+
+        mpAllocator = TransientAllocator::create(desc, callbacks);
     }
 
-    ResourceAllocator::SharedPtr ResourceAllocator::create(size_t pageSize, GpuFence::SharedPtr pFence)
+    ResourceAllocator::~ResourceAllocator()
     {
-        SharedPtr pAllocator = SharedPtr(new ResourceAllocator(pageSize, pFence));
-        pAllocator->allocateNewPage();
-        return pAllocator;
+        mpAllocator = nullptr;
     }
 
-    void ResourceAllocator::allocateNewPage()
+    ResourceAllocator::SharedPtr ResourceAllocator::create(size_t pageSize, GpuFence::SharedPtr pFence)
     {
-        if (mpActivePage)
-        {
-            mUsedPages[mCurrentPageId] = std::move(mpActivePage);
-        }
-
-        if (mAvailablePages.size())
-        {
-            mpActivePage = std::move(mAvailablePages.front());
-            mAvailablePages.pop();
-            mpActivePage->allocationsCount = 0;
-            mpActivePage->currentOffset = 0;
-        }
-        else
-        {
-            mpActivePage = std::make_unique<PageData>();
-            initBasePageData((*mpActivePage), mPageSize);
-        }
-
-        mpActivePage->currentOffset = 0;
-        mCurrentPageId++;
+        return SharedPtr(new ResourceAllocator(pageSize, pFence));
     }
 
     ResourceAllocator::AllocationData ResourceAllocator::allocate(size_t size, size_t alignment)
     {
         AllocationData data;
-        if (size > mPageSize)
-        {
-            data.pageID = ResourceAllocator::AllocationData::kMegaPageId;
-            initBasePageData(data, size);
-        }
-        else
-        {
-            // Calculate the start
-            size_t currentOffset = align_to(alignment, mpActivePage->currentOffset);
-            if (currentOffset + size > mPageSize)
-            {
-                currentOffset = 0;
-                allocateNewPage();
-            }
+        data.allocation = mpAllocator->allocate(std::max<uint64_t>(size, 1), alignment);
 
-            data.pageID = mCurrentPageId;
-            data.offset = currentOffset;
-            data.pData = mpActivePage->pData + currentOffset;
-            data.pResourceHandle = mpActivePage->pResourceHandle;
-            mpActivePage->currentOffset = currentOffset + size;
-            mpActivePage->allocationsCount++;
-        }
-
-        data.fenceValue = mpFence->getCpuValue();
+        const BaseData& page = mPages[data.allocation.page];
+        data.pResourceHandle = page.pResourceHandle;
+        data.offset = data.allocation.offset;
+        data.pData = page.pData + data.allocation.offset;
         return data;
     }
 
     void ResourceAllocator::release(AllocationData& data)
     {
         assert(data.pResourceHandle);
-        mDeferredReleases.push(data);
+        // The GPU may use the memory until the work submitted so far completes
+        mpAllocator->release(data.allocation, mpFence->getCpuValue());
     }
 
     void ResourceAllocator::executeDeferredReleases()
     {
-        uint64_t gpuVal = mpFence->getGpuValue();
-        while (mDeferredReleases.size() && mDeferredReleases.top().fenceValue <= gpuVal)
-        {
-            const AllocationData& data = mDeferredReleases.top();
-            if (data.pageID == mCurrentPageId)
-            {
-                mpActivePage->allocationsCount--;
-                if (mpActivePage->allocationsCount == 0)
-                {
-                    mpActivePage->currentOffset = 0;
-                }
-            }
-            else
-            {
-                if (data.pageID != AllocationData::kMegaPageId)
-                {
-                    auto& pData = mUsedPages[data.pageID];
-                    pData->allocationsCount--;
-                    if (pData->allocationsCount == 0)
-                    {
-                        mAvailablePages.push(std::move(pData));
-                        mUsedPages.erase(data.pageID);
-                    }
-                }
-                // else it's a mega-page. Popping it will release the resource
-            }
-            mDeferredReleases.pop();
-        }
+        mpAllocator->executeDeferredReleases(mpFence->getGpuValue());
     }
 }
@@ -26,12 +26,13 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ***************************************************************************/
 #pragma once
-#include <unordered_map>
-#include <queue>
 #include "GpuFence.h"
+#include "TransientAllocator.h"
 
 namespace Falcor
 {
+    /** Allocates transient upload memory for dynamic buffers. The sub-allocation is done by a TransientAllocator, this class creates the GPU pages and feeds it the fence values.
+    */
     class ResourceAllocator
     {
     public:
@@ -48,11 +49,7 @@ namespace Falcor
 
         struct AllocationData : public BaseData
         {
-            uint64_t pageID = 0;
-            uint64_t fenceValue = 0;
-
-            static const uint64_t kMegaPageId = -1;
-            bool operator<(const AllocationData& other)  const { return fenceValue > other.fenceValue; }
+            TransientAllocator::Allocation allocation;
         };
         ~ResourceAllocator();
 
@@ -61,26 +58,18 @@ namespace Falcor
         size_t getPageSize() const { return mPageSize; }
         void executeDeferredReleases();
 
+        /** Get the allocation statistics
+        */
+        TransientAllocator::Stats getStats() const { return mpAllocator->getStats(); }
+
     private:
-        ResourceAllocator(size_t pageSize, GpuFence::SharedPtr pFence) : mPageSize(pageSize), mpFence(pFence) {}
-        struct PageData : public BaseData
-        {
-            uint32_t allocationsCount = 0;
-            size_t currentOffset = 0;
+        ResourceAllocator(size_t pageSize, GpuFence::SharedPtr pFence);
 
-            using UniquePtr = std::unique_ptr<PageData>;
-        };
-        
         GpuFence::SharedPtr mpFence;
         size_t mPageSize = 0;
-        size_t mCurrentPageId = 0;
-        PageData::UniquePtr mpActivePage;
-
-        std::priority_queue<AllocationData> mDeferredReleases;
-        std::unordered_map<size_t, PageData::UniquePtr> mUsedPages;
-        std::queue<PageData::UniquePtr> mAvailablePages;
+        TransientAllocator::UniquePtr mpAllocator;
+        std::vector<BaseData> mPages;   ///< Indexed by the TransientAllocator page index
 
-        void allocateNewPage();
         static void initBasePageData(BaseData& data, size_t size);
     };
 }
@@ -0,0 +1,671 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "TransientAllocator.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kMinAlignmentLog2 = 8;
+        const uint32_t kSmallBlockLog2 = kMinAlignmentLog2 + 4;    // Sizes up to kMinAlignment * kSecondLevelCount share the first level
+        const uint64_t kSmallBlockSize = 1ull << kSmallBlockLog2;
+
+        uint32_t log2Floor(uint64_t v)
+        {
+            uint32_t high = uint32_t(v >> 32);
+            return high ? bitScanReverse(high) + 32 : bitScanReverse(uint32_t(v));
+        }
+
+        bool isPowerOfTwo(uint64_t v)
+        {
+            return v && ((v & (v - 1)) == 0);
+        }
+    }
+
+    static_assert(TransientAllocator::kMinAlignment == (1ull << kMinAlignmentLog2), "kMinAlignmentLog2 doesn't match kMinAlignment");
+
+    /** Maps a size to its TLSF free list. Sizes below kSmallBlockSize are split linearly, larger ones use the power of two as the first level and split it in kSecondLevelCount.
+    */
+    void TransientAllocator::mapSize(uint64_t size, uint32_t& fl, uint32_t& sl)
+    {
+        if (size < kSmallBlockSize)
+        {
+            fl = 0;
+            sl = uint32_t(size >> kMinAlignmentLog2);
+        }
+        else
+        {
+            uint32_t log2 = log2Floor(size);
+            sl = uint32_t(size >> (log2 - kSecondLevelLog2)) ^ kSecondLevelCount;
+            fl = log2 - kSmallBlockLog2 + 1;
+        }
+    }
+
+    TransientAllocator::UniquePtr TransientAllocator::create(const Desc& desc, const Callbacks& callbacks)
+    {
+        if (desc.pageSize < desc.slabSize || desc.slabSize < kMaxSmallSize || (desc.slabSize >> kMinAlignmentLog2) > 0x10000)
+        {
+            logError("TransientAllocator::create() - the slab size must be between kMaxSmallSize and the page size, and hold at most 65536 blocks");
+            return nullptr;
+        }
+        if ((desc.pageSize % kMinAlignment) != 0 || (desc.slabSize % kMinAlignment) != 0)
+        {
+            logError("TransientAllocator::create() - the page and slab sizes must be multiples of kMinAlignment");
+            return nullptr;
+        }
+        if (!callbacks.createPage || !callbacks.destroyPage)
+        {
+            logError("TransientAllocator::create() - missing page callbacks");
+            return nullptr;
+        }
+        return UniquePtr(new TransientAllocator(desc, callbacks));
+    }
+
+    TransientAllocator::TransientAllocator(const Desc& desc, const Callbacks& callbacks) : mDesc(desc), mCallbacks(callbacks)
+    {
+        for (auto& lists : mFreeLists)
+        {
+            for (auto& head : lists) head = kInvalidIndex;
+        }
+    }
+
+    TransientAllocator::~TransientAllocator()
+    {
+        for (uint32_t page = 0; page < uint32_t(mPages.size()); page++)
+        {
+            if (mPages[page].size) mCallbacks.destroyPage(page);
+        }
+    }
+
+    TransientAllocator::Allocation TransientAllocator::allocate(uint64_t size, uint64_t alignment)
+    {
+        assert(size > 0 && isPowerOfTwo(alignment));
+
+        Allocation allocation;
+        uint64_t padding = (alignment > kMinAlignment) ? alignment - kMinAlignment : 0;
+        if (size <= kMaxSmallSize && alignment <= kMinAlignment)
+        {
+            allocation = allocateSmall(size);
+        }
+        else if (align_to(kMinAlignment, size) + padding <= mDesc.pageSize)
+        {
+            allocation = allocateMedium(size, alignment);
+        }
+        else
+        {
+            // Mega-pages start at offset 0, which satisfies any alignment
+            allocation = allocateMega(size);
+        }
+
+        uint32_t tier = uint32_t(allocation.tier);
+        mStats.liveCount[tier]++;
+        mStats.liveBytes[tier] += size;
+        mStats.allocationCount[tier]++;
+        return allocation;
+    }
+
+    void TransientAllocator::release(const Allocation& allocation, uint64_t fenceValue)
+    {
+        assert(allocation.isValid());
+        assert(mDeferredReleases.empty() || mDeferredReleases.back().fenceValue <= fenceValue);
+        mDeferredReleases.push({ allocation, fenceValue });
+    }
+
+    void TransientAllocator::executeDeferredReleases(uint64_t completedFenceValue)
+    {
+        while (mDeferredReleases.size() && mDeferredReleases.front().fenceValue <= completedFenceValue)
+        {
+            releaseNow(mDeferredReleases.front().allocation);
+            mDeferredReleases.pop();
+        }
+    }
+
+    void TransientAllocator::releaseNow(const Allocation& allocation)
+    {
+        switch (allocation.tier)
+        {
+        case Tier::Small:
+            releaseSmall(allocation);
+            break;
+        case Tier::Medium:
+            releaseMedium(allocation);
+            break;
+        case Tier::Mega:
+            releaseMega(allocation);
+            break;
+        default:
+            should_not_get_here();
+        }
+
+        uint32_t tier = uint32_t(allocation.tier);
+        mStats.liveCount[tier]--;
+        mStats.liveBytes[tier] -= allocation.size;
+    }
+
+    uint32_t TransientAllocator::createPage(uint64_t size, Tier tier)
+    {
+        uint32_t page;
+        if (mFreePageIndices.size())
+        {
+            page = mFreePageIndices.back();
+            mFreePageIndices.pop_back();
+        }
+        else
+        {
+            page = uint32_t(mPages.size());
+            mPages.emplace_back();
+        }
+
+        mPages[page].size = size;
+        mPages[page].tier = tier;
+        mPages[page].inUse = true;
+        mCallbacks.createPage(page, size);
+        return page;
+    }
+
+    void TransientAllocator::destroyPage(uint32_t page)
+    {
+        mCallbacks.destroyPage(page);
+        mPages[page] = Page();
+        mFreePageIndices.push_back(page);
+    }
+
+    // Small tier
+
+    TransientAllocator::Allocation TransientAllocator::allocateSmall(uint64_t size)
+    {
+        uint32_t sizeClass = (size <= kMinAlignment) ? 0 : log2Floor(size - 1) + 1 - kMinAlignmentLog2;
+        uint64_t classSize = kMinAlignment << sizeClass;
+        auto& available = mAvailableSlabs[sizeClass];
+
+        if (available.empty())
+        {
+            uint32_t slabIndex;
+            if (mFreeSlabIndices.size())
+            {
+                slabIndex = mFreeSlabIndices.back();
+                mFreeSlabIndices.pop_back();
+            }
+            else
+            {
+                slabIndex = uint32_t(mSlabs.size());
+                mSlabs.emplace_back();
+            }
+
+            Slab& slab = mSlabs[slabIndex];
+            slab.allocation = allocateMedium(mDesc.slabSize, kMinAlignment);
+            slab.sizeClass = sizeClass;
+            uint32_t blockCount = uint32_t(mDesc.slabSize / classSize);
+            slab.freeBlocks.resize(blockCount);
+            // Hand out the blocks in address order
+            for (uint32_t i = 0; i < blockCount; i++) slab.freeBlocks[i] = uint16_t(blockCount - 1 - i);
+            slab.availableIndex = uint32_t(available.size());
+            available.push_back(slabIndex);
+            mStats.slabCount++;
+        }
+
+        uint32_t slabIndex = available.back();
+        Slab& slab = mSlabs[slabIndex];
+        uint32_t block = slab.freeBlocks.back();
+        slab.freeBlocks.pop_back();
+        if (slab.freeBlocks.empty())
+        {
+            available.pop_back();
+            slab.availableIndex = kInvalidIndex;
+        }
+
+        mStats.smallWastedBytes += classSize - size;
+
+        Allocation allocation;
+        allocation.page = slab.allocation.page;
+        allocation.offset = slab.allocation.offset + block * classSize;
+        allocation.size = size;
+        allocation.tier = Tier::Small;
+        allocation.block = slabIndex;
+        return allocation;
+    }
+
+    void TransientAllocator::releaseSmall(const Allocation& allocation)
+    {
+        uint32_t slabIndex = allocation.block;
+        Slab& slab = mSlabs[slabIndex];
+        uint64_t classSize = kMinAlignment << slab.sizeClass;
+        auto& available = mAvailableSlabs[slab.sizeClass];
+
+        slab.freeBlocks.push_back(uint16_t((allocation.offset - slab.allocation.offset) / classSize));
+        mStats.smallWastedBytes -= classSize - allocation.size;
+
+        if (slab.availableIndex == kInvalidIndex)
+        {
+            slab.availableIndex = uint32_t(available.size());
+            available.push_back(slabIndex);
+        }
+
+        // Keep one empty slab per size class, so a class which is repeatedly allocated and released doesn't thrash the medium tier
+        if (slab.freeBlocks.size() == mDesc.slabSize / classSize && available.size() > 1)
+        {
+            uint32_t last = available.back();
+            available[slab.availableIndex] = last;
+            mSlabs[last].availableIndex = slab.availableIndex;
+            available.pop_back();
+
+            releaseMedium(slab.allocation);
+            slab = Slab();
+            mFreeSlabIndices.push_back(slabIndex);
+            mStats.slabCount--;
+        }
+    }
+
+    // Medium tier
+
+    uint32_t TransientAllocator::newBlock()
+    {
+        if (mFreeBlockIndices.size())
+        {
+            uint32_t block = mFreeBlockIndices.back();
+            mFreeBlockIndices.pop_back();
+            return block;
+        }
+        mBlocks.emplace_back();
+        return uint32_t(mBlocks.size() - 1);
+    }
+
+    void TransientAllocator::deleteBlock(uint32_t block)
+    {
+        mBlocks[block] = Block();
+        mFreeBlockIndices.push_back(block);
+    }
+
+    void TransientAllocator::insertFreeBlock(uint32_t b)
+    {
+        Block& block = mBlocks[b];
+        uint32_t fl, sl;
+        mapSize(block.size, fl, sl);
+        assert(fl < kFirstLevelCount);
+
+        uint32_t head = mFreeLists[fl][sl];
+        block.isFree = true;
+        block.prevFree = kInvalidIndex;
+        block.nextFree = head;
+        if (head != kInvalidIndex) mBlocks[head].prevFree = b;
+        mFreeLists[fl][sl] = b;
+        mFirstLevelBitmap |= 1u << fl;
+        mSecondLevelBitmaps[fl] |= 1u << sl;
+    }
+
+    void TransientAllocator::removeFreeBlock(uint32_t b)
+    {
+        Block& block = mBlocks[b];
+        uint32_t fl, sl;
+        mapSize(block.size, fl, sl);
+
+        if (block.prevFree != kInvalidIndex) mBlocks[block.prevFree].nextFree = block.nextFree;
+        if (block.nextFree != kInvalidIndex) mBlocks[block.nextFree].prevFree = block.prevFree;
+        if (mFreeLists[fl][sl] == b)
+        {
+            mFreeLists[fl][sl] = block.nextFree;
+            if (block.nextFree == kInvalidIndex)
+            {
+                mSecondLevelBitmaps[fl] &= ~(1u << sl);
+                if (mSecondLevelBitmaps[fl] == 0) mFirstLevelBitmap &= ~(1u << fl);
+            }
+        }
+        block.isFree = false;
+        block.prevFree = kInvalidIndex;
+        block.nextFree = kInvalidIndex;
+    }
+
+    uint32_t TransientAllocator::findFreeBlock(uint64_t size) const
+    {
+        // Round the size up to the next list, so any block in the list found is large enough
+        if (size >= kSmallBlockSize) size += (1ull << (log2Floor(size) - kSecondLevelLog2)) - 1;
+
+        uint32_t fl, sl;
+        mapSize(size, fl, sl);
+        if (fl >= kFirstLevelCount) return kInvalidIndex;
+
+        uint32_t slMap = mSecondLevelBitmaps[fl] & (~0u << sl);
+        if (slMap == 0)
+        {
+            uint32_t flMap = (fl + 1 < kFirstLevelCount) ? mFirstLevelBitmap & (~0u << (fl + 1)) : 0;
+            if (flMap == 0) return kInvalidIndex;
+            fl = bitScanForward(flMap);
+            slMap = mSecondLevelBitmaps[fl];
+        }
+        sl = bitScanForward(slMap);
+        return mFreeLists[fl][sl];
+    }
+
+    TransientAllocator::Allocation TransientAllocator::allocateMedium(uint64_t size, uint64_t alignment)
+    {
+        uint64_t blockSize = align_to(kMinAlignment, size);
+        uint64_t padding = (alignment > kMinAlignment) ? alignment - kMinAlignment : 0;
+
+        uint32_t b = findFreeBlock(blockSize + padding);
+        if (b == kInvalidIndex)
+        {
+            // The new page isn't added to the free lists, it's split right away
+            uint32_t page = createPage(mDesc.pageSize, Tier::Medium);
+            b = newBlock();
+            mBlocks[b].page = page;
+            mBlocks[b].size = mDesc.pageSize;
+            mStats.pageCreateCount++;
+        }
+        else
+        {
+            removeFreeBlock(b);
+            if (isWholePage(mBlocks[b])) mIdlePageCount--;
+        }
+
+        uint64_t blockOffset = mBlocks[b].offset;
+        uint64_t offset = align_to(alignment, blockOffset);
+        uint64_t usedSize = offset - blockOffset + blockSize;
+        assert(usedSize <= mBlocks[b].size);
+
+        // Split the remainder into a new free block
+        if (mBlocks[b].size - usedSize >= kMinAlignment)
+        {
+            uint32_t r = newBlock();
+            Block& block = mBlocks[b];
+            Block& remainder = mBlocks[r];
+            remainder.offset = blockOffset + usedSize;
+            remainder.size = block.size - usedSize;
+            remainder.page = block.page;
+            remainder.prevPhysical = b;
+            remainder.nextPhysical = block.nextPhysical;
+            if (block.nextPhysical != kInvalidIndex) mBlocks[block.nextPhysical].prevPhysical = r;
+            block.nextPhysical = r;
+            block.size = usedSize;
+            insertFreeBlock(r);
+        }
+
+        Allocation allocation;
+        allocation.page = mBlocks[b].page;
+        allocation.offset = offset;
+        allocation.size = size;
+        allocation.tier = Tier::Medium;
+        allocation.block = b;
+        return allocation;
+    }
+
+    void TransientAllocator::releaseMedium(const Allocation& allocation)
+    {
+        uint32_t b = allocation.block;
+        assert(mBlocks[b].isFree == false && mBlocks[b].page == allocation.page);
+
+        // Coalesce with the physical neighbors
+        uint32_t prev = mBlocks[b].prevPhysical;
+        if (prev != kInvalidIndex && mBlocks[prev].isFree)
+        {
+            removeFreeBlock(prev);
+            mBlocks[prev].size += mBlocks[b].size;
+            mBlocks[prev].nextPhysical = mBlocks[b].nextPhysical;
+            if (mBlocks[b].nextPhysical != kInvalidIndex) mBlocks[mBlocks[b].nextPhysical].prevPhysical = prev;
+            deleteBlock(b);
+            b = prev;
+        }
+
+        uint32_t next = mBlocks[b].nextPhysical;
+        if (next != kInvalidIndex && mBlocks[next].isFree)
+        {
+            removeFreeBlock(next);
+            mBlocks[b].size += mBlocks[next].size;
+            mBlocks[b].nextPhysical = mBlocks[next].nextPhysical;
+            if (mBlocks[next].nextPhysical != kInvalidIndex) mBlocks[mBlocks[next].nextPhysical].prevPhysical = b;
+            deleteBlock(next);
+        }
+
+        if (isWholePage(mBlocks[b]))
+        {
+            if (mIdlePageCount >= mDesc.maxIdlePages)
+            {
+                uint32_t page = mBlocks[b].page;
+                deleteBlock(b);
+                destroyPage(page);
+                return;
+            }
+            mIdlePageCount++;
+        }
+        insertFreeBlock(b);
+    }
+
+    // Mega tier
+
+    uint64_t TransientAllocator::getMegaPageBucketSize(uint64_t size)
+    {
+        // 4 buckets per power of two, so at most 25% of a mega-page is wasted
+        uint32_t log2 = log2Floor(size);
+        uint64_t step = 1ull << (log2 >= 2 ? log2 - 2 : 0);
+        return align_to(step, size);
+    }
+
+    TransientAllocator::Allocation TransientAllocator::allocateMega(uint64_t size)
+    {
+        uint64_t bucketSize = getMegaPageBucketSize(size);
+        uint32_t page;
+
+        auto it = mMegaPageCache.find(bucketSize);
+        if (it != mMegaPageCache.end() && it->second.size())
+        {
+            page = it->second.back();
+            it->second.pop_back();
+            mMegaPageCacheOrder.erase(mPages[page].cacheIt);
+            mPages[page].inUse = true;
+            mCachedMegaPageBytes -= bucketSize;
+            mStats.megaPageReuseCount++;
+        }
+        else
+        {
+            page = createPage(bucketSize, Tier::Mega);
+            mStats.megaPageCreateCount++;
+        }
+
+        mStats.megaPageCount++;
+        mStats.megaPageBytes += bucketSize;
+
+        Allocation allocation;
+        allocation.page = page;
+        allocation.offset = 0;
+        allocation.size = size;
+        allocation.tier = Tier::Mega;
+        return allocation;
+    }
+
+    void TransientAllocator::releaseMega(const Allocation& allocation)
+    {
+        uint32_t page = allocation.page;
+        uint64_t bucketSize = mPages[page].size;
+        assert(mPages[page].inUse && mPages[page].tier == Tier::Mega);
+
+        mStats.megaPageCount--;
+        mStats.megaPageBytes -= bucketSize;
+
+        mPages[page].inUse = false;
+        mMegaPageCache[bucketSize].push_back(page);
+        mPages[page].cacheIt = mMegaPageCacheOrder.insert(mMegaPageCacheOrder.end(), page);
+        mCachedMegaPageBytes += bucketSize;
+        trimMegaPageCache();
+    }
+
+    void TransientAllocator::trimMegaPageCache()
+    {
+        while (mCachedMegaPageBytes > mDesc.megaPageCacheSize)
+        {
+            uint32_t page = mMegaPageCacheOrder.front();
+            mMegaPageCacheOrder.pop_front();
+
+            uint64_t bucketSize = mPages[page].size;
+            auto& bucket = mMegaPageCache[bucketSize];
+            bucket.erase(std::find(bucket.begin(), bucket.end(), page));
+            mCachedMegaPageBytes -= bucketSize;
+            destroyPage(page);
+        }
+    }
+
+    // Statistics and validation
+
+    TransientAllocator::Stats TransientAllocator::getStats() const
+    {
+        Stats stats = mStats;
+        stats.pendingReleaseCount = mDeferredReleases.size();
+        stats.idlePageCount = mIdlePageCount;
+        stats.cachedMegaPageCount = mMegaPageCacheOrder.size();
+        stats.cachedMegaPageBytes = mCachedMegaPageBytes;
+
+        for (const Page& page : mPages)
+        {
+            if (page.size && page.tier == Tier::Medium) stats.pageCount++;
+        }
+
+        for (const Block& block : mBlocks)
+        {
+            if (block.page == kInvalidIndex || block.isFree == false || isWholePage(block)) continue;
+            stats.mediumFreeBytes += block.size;
+            stats.mediumLargestFreeBlock = std::max(stats.mediumLargestFreeBlock, block.size);
+        }
+        if (stats.mediumFreeBytes) stats.fragmentation = 1.0f - float(double(stats.mediumLargestFreeBlock) / double(stats.mediumFreeBytes));
+        return stats;
+    }
+
+    std::string TransientAllocator::Stats::toString() const
+    {
+        static const char* kTierNames[] = { "small", "medium", "mega" };
+
+        std::string s;
+        for (uint32_t t = 0; t < uint32_t(Tier::Count); t++)
+        {
+            s += std::string(kTierNames[t]) + ": " + std::to_string(liveCount[t]) + " live (" + std::to_string(liveBytes[t]) + " bytes), " + std::to_string(allocationCount[t]) + " total\n";
+        }
+        s += "pending releases: " + std::to_string(pendingReleaseCount) + "\n";
+        s += "pages: " + std::to_string(pageCount) + " (" + std::to_string(idlePageCount) + " idle), " + std::to_string(pageCreateCount) + " created\n";
+        s += "slabs: " + std::to_string(slabCount) + ", " + std::to_string(smallWastedBytes) + " bytes lost to size classes\n";
+        s += "medium free: " + std::to_string(mediumFreeBytes) + " bytes, largest block " + std::to_string(mediumLargestFreeBlock) + ", fragmentation " + std::to_string(fragmentation) + "\n";
+        s += "mega-pages: " + std::to_string(megaPageCount) + " (" + std::to_string(megaPageBytes) + " bytes), " + std::to_string(cachedMegaPageCount) + " cached (" + std::to_string(cachedMegaPageBytes) + " bytes), ";
+        s += std::to_string(megaPageCreateCount) + " created, " + std::to_string(megaPageReuseCount) + " reused\n";
+        return s;
+    }
+
+    bool TransientAllocator::validate() const
+    {
+        auto fail = [](const std::string& msg)
+        {
+            logError("TransientAllocator::validate() - " + msg);
+            return false;
+        };
+
+        // The blocks of each medium page must tile it, with linked physical neighbors and no two adjacent free blocks
+        std::vector<std::vector<uint32_t>> pageBlocks(mPages.size());
+        uint32_t freeBlockCount = 0;
+        uint32_t idlePageCount = 0;
+        for (uint32_t b = 0; b < uint32_t(mBlocks.size()); b++)
+        {
+            const Block& block = mBlocks[b];
+            if (block.page == kInvalidIndex) continue;
+            if (block.page >= mPages.size() || mPages[block.page].size == 0 || mPages[block.page].tier != Tier::Medium) return fail("block " + std::to_string(b) + " references an invalid page");
+            pageBlocks[block.page].push_back(b);
+            if (block.isFree) freeBlockCount++;
+            if (block.isFree && isWholePage(block)) idlePageCount++;
+        }
+
+        for (uint32_t page = 0; page < uint32_t(mPages.size()); page++)
+        {
+            if (mPages[page].size == 0 || mPages[page].tier != Tier::Medium) continue;
+            auto& blocks = pageBlocks[page];
+            if (blocks.empty()) return fail("page " + std::to_string(page) + " has no blocks");
+            std::sort(blocks.begin(), blocks.end(), [this](uint32_t a, uint32_t b) { return mBlocks[a].offset < mBlocks[b].offset; });
+
+            uint64_t offset = 0;
+            for (size_t i = 0; i < blocks.size(); i++)
+            {
+                const Block& block = mBlocks[blocks[i]];
+                uint32_t prev = i ? blocks[i - 1] : kInvalidIndex;
+                uint32_t next = (i + 1 < blocks.size()) ? blocks[i + 1] : kInvalidIndex;
+                if (block.offset != offset || block.size == 0 || (block.size % kMinAlignment) != 0) return fail("the blocks of page " + std::to_string(page) + " don't tile it");
+                if (block.prevPhysical != prev || block.nextPhysical != next) return fail("broken physical links in page " + std::to_string(page));
+                if (block.isFree && prev != kInvalidIndex && mBlocks[prev].isFree) return fail("adjacent free blocks weren't coalesced in page " + std::to_string(page));
+                offset += block.size;
+            }
+            if (offset != mPages[page].size) return fail("the blocks of page " + std::to_string(page) + " don't cover it");
+        }
+
+        // Every free block must be in the list matching its size, and the bitmaps must match the lists
+        uint32_t listedCount = 0;
+        for (uint32_t fl = 0; fl < kFirstLevelCount; fl++)
+        {
+            for (uint32_t sl = 0; sl < kSecondLevelCount; sl++)
+            {
+                bool bit = (mSecondLevelBitmaps[fl] & (1u << sl)) != 0;
+                if (bit != (mFreeLists[fl][sl] != kInvalidIndex)) return fail("the second level bitmap doesn't match the free lists");
+
+                uint32_t prev = kInvalidIndex;
+                for (uint32_t b = mFreeLists[fl][sl]; b != kInvalidIndex; b = mBlocks[b].nextFree)
+                {
+                    uint32_t blockFl, blockSl;
+                    mapSize(mBlocks[b].size, blockFl, blockSl);
+                    if (!mBlocks[b].isFree || blockFl != fl || blockSl != sl || mBlocks[b].prevFree != prev) return fail("block " + std::to_string(b) + " is in the wrong free list");
+                    prev = b;
+                    if (++listedCount > freeBlockCount) return fail("the free lists contain a cycle");
+                }
+            }
+            if (((mFirstLevelBitmap >> fl) & 1) != (mSecondLevelBitmaps[fl] ? 1u : 0u)) return fail("the first level bitmap doesn't match the second level");
+        }
+        if (listedCount != freeBlockCount) return fail("some free blocks are missing from the free lists");
+        if (idlePageCount != mIdlePageCount || mIdlePageCount > mDesc.maxIdlePages) return fail("wrong idle page count");
+
+        // Slabs
+        uint64_t slabCount = 0;
+        for (uint32_t c = 0; c < kSizeClassCount; c++)
+        {
+            for (uint32_t i = 0; i < uint32_t(mAvailableSlabs[c].size()); i++)
+            {
+                const Slab& slab = mSlabs[mAvailableSlabs[c][i]];
+                if (slab.sizeClass != c || slab.availableIndex != i || slab.freeBlocks.empty()) return fail("wrong available slab list");
+            }
+        }
+        for (const Slab& slab : mSlabs)
+        {
+            if (!slab.allocation.isValid()) continue;
+            slabCount++;
+            if (mBlocks[slab.allocation.block].isFree) return fail("a slab is backed by a free block");
+            if ((slab.availableIndex == kInvalidIndex) != slab.freeBlocks.empty()) return fail("a slab with free blocks isn't available");
+        }
+        if (slabCount != mStats.slabCount) return fail("wrong slab count");
+
+        // Mega-pages
+        uint64_t cachedBytes = 0;
+        for (uint32_t page : mMegaPageCacheOrder)
+        {
+            if (mPages[page].inUse || mPages[page].tier != Tier::Mega) return fail("a cached mega-page is in use");
+            cachedBytes += mPages[page].size;
+        }
+        if (cachedBytes != mCachedMegaPageBytes || cachedBytes > mDesc.megaPageCacheSize) return fail("wrong cached mega-page size");
+
+        return true;
+    }
+}
@@ -0,0 +1,245 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <functional>
+#include <list>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace Falcor
+{
+    /** Sub-allocates transient memory, such as dynamic buffers and per-frame constants, out of pages.
+        The allocator only manages offsets. The caller creates and destroys the page resources through callbacks, so the allocation logic doesn't depend on the GPU and can be tested on the CPU.
+        Allocations are served by one of three tiers:
+        - Small allocations (up to kMaxSmallSize) come from size-class slabs. The slabs are carved out of the medium tier.
+        - Medium allocations (up to the page size) use a TLSF allocator over the pages.
+        - Larger allocations get a dedicated mega-page. Mega-page sizes are rounded up to a bucket, and released mega-pages are cached and reused by later allocations in the same bucket.
+        Releases are deferred until the fence value passed to release() has been reached.
+    */
+    class TransientAllocator
+    {
+    public:
+        using UniquePtr = std::unique_ptr<TransientAllocator>;
+        static const uint32_t kInvalidIndex = uint32_t(-1);
+        static const uint64_t kMinAlignment = 256;              ///< Granularity of the medium tier. Every offset is aligned to at least this.
+        static const uint64_t kMaxSmallSize = 16 * 1024;         ///< Largest allocation served by the small tier
+
+        enum class Tier : uint8_t
+        {
+            Small,
+            Medium,
+            Mega,
+            Count
+        };
+
+        struct Desc
+        {
+            uint64_t pageSize = 2 * 1024 * 1024;                ///< Size of the medium-tier pages. Larger allocations use mega-pages.
+            uint64_t slabSize = 64 * 1024;                      ///< Size of the slabs holding small allocations
+            uint32_t maxIdlePages = 2;                          ///< Number of empty medium pages kept around instead of being destroyed
+            uint64_t megaPageCacheSize = 64 * 1024 * 1024;      ///< Total size of released mega-pages kept for reuse
+        };
+
+        struct Callbacks
+        {
+            std::function<void(uint32_t page, uint64_t size)> createPage;   ///< Creates the resource for a page. Page indices are reused after destroyPage().
+            std::function<void(uint32_t page)> destroyPage;                ///< Destroys the resource of a page
+        };
+
+        struct Allocation
+        {
+            uint32_t page = kInvalidIndex;      ///< The page index passed to Callbacks::createPage
+            uint64_t offset = 0;                ///< Offset inside the page, aligned as requested
+            uint64_t size = 0;                  ///< The requested size
+            Tier tier = Tier::Small;
+            uint32_t block = kInvalidIndex;     ///< Internal. The medium-tier block or the small-tier slab.
+
+            bool isValid() const { return page != kInvalidIndex; }
+        };
+
+        struct Stats
+        {
+            uint64_t liveCount[uint32_t(Tier::Count)] = {};     ///< Number of allocations which weren't released yet, per tier
+            uint64_t liveBytes[uint32_t(Tier::Count)] = {};     ///< Requested bytes of the live allocations, per tier
+            uint64_t allocationCount[uint32_t(Tier::Count)] = {};   ///< Total number of allocations, per tier
+            uint64_t pendingReleaseCount = 0;                   ///< Releases waiting for their fence value
+
+            uint64_t pageCount = 0;                             ///< Medium pages, including idle ones
+            uint64_t idlePageCount = 0;
+            uint64_t pageCreateCount = 0;
+            uint64_t slabCount = 0;
+            uint64_t smallWastedBytes = 0;                      ///< Bytes lost to size-class rounding of the live small allocations
+            uint64_t mediumFreeBytes = 0;                       ///< Free bytes in the medium pages, excluding idle pages
+            uint64_t mediumLargestFreeBlock = 0;                ///< Largest free block in the medium pages, excluding idle pages
+            float fragmentation = 0;                            ///< External fragmentation of the medium tier, 1 - largest free block / free bytes
+
+            uint64_t megaPageCount = 0;                         ///< Mega-pages in use
+            uint64_t megaPageBytes = 0;
+            uint64_t cachedMegaPageCount = 0;                   ///< Released mega-pages kept for reuse
+            uint64_t cachedMegaPageBytes = 0;
+            uint64_t megaPageCreateCount = 0;
+            uint64_t megaPageReuseCount = 0;
+
+            std::string toString() const;
+        };
+
+        /** Create a new allocator
+            \param[in] desc The allocator configuration
+            \param[in] callbacks Callbacks creating and destroying the page resources
+        */
+        static UniquePtr create(const Desc& desc, const Callbacks& callbacks);
+
+        /** Destroys all the pages. Pending releases are dropped.
+        */
+        ~TransientAllocator();
+
+        /** Allocate memory
+            \param[in] size The size of the allocation in bytes. Must be larger than zero.
+            \param[in] alignment The required alignment of the offset. Must be a power of two.
+            \return The allocation
+        */
+        Allocation allocate(uint64_t size, uint64_t alignment = 1);
+
+        /** Release an allocation once the fence reaches a value
+            \param[in] allocation The allocation to release
+            \param[in] fenceValue The memory will be reused once executeDeferredReleases() is called with a value equal to or larger than this. Should not decrease between calls.
+        */
+        void release(const Allocation& allocation, uint64_t fenceValue);
+
+        /** Release the allocations whose fence value was reached
+            \param[in] completedFenceValue The last fence value the GPU has reached
+        */
+        void executeDeferredReleases(uint64_t completedFenceValue);
+
+        /** Get the allocation statistics. Walks the medium-tier free lists, so it's not meant to be called per allocation.
+        */
+        Stats getStats() const;
+
+        /** Check the internal data structures for consistency. Used by the tests.
+            \return true if the state is consistent, otherwise false and an error is logged
+        */
+        bool validate() const;
+
+        const Desc& getDesc() const { return mDesc; }
+
+    private:
+        TransientAllocator(const Desc& desc, const Callbacks& callbacks);
+
+        // TLSF parameters. The first level is the power of two of the size, the second level subdivides it linearly.
+        static const uint32_t kSecondLevelLog2 = 4;
+        static const uint32_t kSecondLevelCount = 1 << kSecondLevelLog2;
+        static const uint32_t kFirstLevelCount = 32;
+        static const uint32_t kSizeClassCount = 7;              ///< Small size classes, kMinAlignment << i
+        static_assert((kMinAlignment << (kSizeClassCount - 1)) == kMaxSmallSize, "The small size classes don't end at kMaxSmallSize");
+
+        struct Block
+        {
+            uint64_t offset = 0;
+            uint64_t size = 0;
+            uint32_t page = kInvalidIndex;
+            uint32_t prevPhysical = kInvalidIndex;
+            uint32_t nextPhysical = kInvalidIndex;
+            uint32_t prevFree = kInvalidIndex;
+            uint32_t nextFree = kInvalidIndex;
+            bool isFree = false;
+        };
+
+        struct Slab
+        {
+            Allocation allocation;                  ///< The medium-tier allocation backing the slab
+            uint32_t sizeClass = 0;
+            uint32_t availableIndex = kInvalidIndex;    ///< Position in mAvailableSlabs, or kInvalidIndex if the slab is full
+            std::vector<uint16_t> freeBlocks;
+        };
+
+        struct Page
+        {
+            uint64_t size = 0;
+            Tier tier = Tier::Medium;
+            bool inUse = false;
+            std::list<uint32_t>::iterator cacheIt;  ///< Position in mMegaPageCacheOrder for cached mega-pages
+        };
+
+        struct PendingRelease
+        {
+            Allocation allocation;
+            uint64_t fenceValue;
+        };
+
+        Desc mDesc;
+        Callbacks mCallbacks;
+
+        std::vector<Page> mPages;
+        std::vector<uint32_t> mFreePageIndices;
+
+        // Medium tier
+        std::vector<Block> mBlocks;
+        std::vector<uint32_t> mFreeBlockIndices;
+        uint32_t mFirstLevelBitmap = 0;
+        uint32_t mSecondLevelBitmaps[kFirstLevelCount] = {};
+        uint32_t mFreeLists[kFirstLevelCount][kSecondLevelCount];
+        uint32_t mIdlePageCount = 0;
+
+        // Small tier
+        std::vector<Slab> mSlabs;
+        std::vector<uint32_t> mFreeSlabIndices;
+        std::vector<uint32_t> mAvailableSlabs[kSizeClassCount];
+
+        // Mega tier. Cached pages are bucketed by size, mMegaPageCacheOrder keeps them oldest first for trimming.
+        std::unordered_map<uint64_t, std::vector<uint32_t>> mMegaPageCache;
+        std::list<uint32_t> mMegaPageCacheOrder;
+        uint64_t mCachedMegaPageBytes = 0;
+
+        std::queue<PendingRelease> mDeferredReleases;
+        Stats mStats;
+
+        uint32_t createPage(uint64_t size, Tier tier);
+        void destroyPage(uint32_t page);
+
+        Allocation allocateSmall(uint64_t size);
+        void releaseSmall(const Allocation& allocation);
+
+        Allocation allocateMedium(uint64_t size, uint64_t alignment);
+        void releaseMedium(const Allocation& allocation);
+        uint32_t newBlock();
+        void deleteBlock(uint32_t block);
+        void insertFreeBlock(uint32_t block);
+        void removeFreeBlock(uint32_t block);
+        uint32_t findFreeBlock(uint64_t size) const;
+        static void mapSize(uint64_t size, uint32_t& fl, uint32_t& sl);
+        bool isWholePage(const Block& block) const { return block.offset == 0 && block.size == mPages[block.page].size; }
+
+        Allocation allocateMega(uint64_t size);
+        void releaseMega(const Allocation& allocation);
+        void trimMegaPageCache();
+        static uint64_t getMegaPageBucketSize(uint64_t size);
+
+        void releaseNow(const Allocation& allocation);
+    };
+}
@@ -193,6 +193,37 @@ namespace Falcor
 
         /** Add defines to notify a shader program about vertex what input properties have associated buffer data
         */
+        /** Get the VERTEX_COMPRESSED_POSITION, VERTEX_OCT_NORMAL, VERTEX_OCT_BITANGENT and VERTEX_HALF_TEXCOORD bits matching the element formats
+        */
+        uint32_t getVertexCompressionFlags() const
+        {
+            uint32_t flags = 0;
+            for (const auto& l : mpBufferLayouts)
+            {
+                if (l == nullptr) continue;
+                for (uint32_t i = 0; i < l->getElementCount(); i++)
+                {
+                    ResourceFormat format = l->getElementFormat(i);
+                    switch (l->getElementShaderLocation(i))
+                    {
+                    case VERTEX_POSITION_LOC:
+                        if (format == ResourceFormat::RGBA16Snorm) flags |= VERTEX_COMPRESSED_POSITION;
+                        break;
+                    case VERTEX_NORMAL_LOC:
+                        if (format == ResourceFormat::RG16Snorm) flags |= VERTEX_OCT_NORMAL;
+                        break;
+                    case VERTEX_BITANGENT_LOC:
+                        if (format == ResourceFormat::RG16Snorm) flags |= VERTEX_OCT_BITANGENT;
+                        break;
+                    case VERTEX_TEXCOORD_LOC:
+                        if (format == ResourceFormat::RG16Float) flags |= VERTEX_HALF_TEXCOORD;
+                        break;
+                    }
+                }
+            }
+            return flags;
+        }
+
         void addVertexAttribDclToProg(Program* pProg) const
         {
             pProg->removeDefine("HAS_NORMAL");
@@ -201,6 +232,9 @@ namespace Falcor
             pProg->removeDefine("HAS_COLORS");
             pProg->removeDefine("HAS_LIGHTMAP_UV");
             pProg->removeDefine("HAS_PREV_POSITION");
+            pProg->removeDefine("HAS_COMPRESSED_POSITION");
+            pProg->removeDefine("HAS_OCT_NORMAL");
+            pProg->removeDefine("HAS_OCT_BITANGENT");
 
             for (const auto& l : mpBufferLayouts)
             {
@@ -235,6 +269,11 @@ namespace Falcor
                     }
                 }
             }
+
+            uint32_t compression = getVertexCompressionFlags();
+            if (compression & VERTEX_COMPRESSED_POSITION) pProg->addDefine("HAS_COMPRESSED_POSITION");
+            if (compression & VERTEX_OCT_NORMAL) pProg->addDefine("HAS_OCT_NORMAL");
+            if (compression & VERTEX_OCT_BITANGENT) pProg->addDefine("HAS_OCT_BITANGENT");
         }
 
     private:
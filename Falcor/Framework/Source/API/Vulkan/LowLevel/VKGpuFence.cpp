@@ -202,6 +202,12 @@ namespace Falcor
         vk_call(vkQueueSubmit(pQueue, 1, &submit, nullptr));
         mpApiData->semaphoreWaitList.clear();
     }
+
+    void GpuFence::syncGpu(CommandQueueHandle pQueue, uint64_t value)
+    {
+        // #VKTODO The fence is a list of binary semaphores, so we can't wait for a specific value. Waiting for the last one is conservative.
+        syncGpu(pQueue);
+    }
     
     void releaseSemaphores(FenceApiData* pApiData)
     {
@@ -184,8 +184,11 @@ namespace Falcor
 
         dataSize = getMipLevelPackedDataSize(pTexture, vkCopy.imageExtent.width, vkCopy.imageExtent.height, vkCopy.imageExtent.depth, pTexture->getFormat());
 
-        // Upload the data to a staging buffer
-        pStaging = Buffer::create(dataSize, Buffer::BindFlags::None, pSrcData ? Buffer::CpuAccess::Write : Buffer::CpuAccess::Read, pSrcData);
+        // Upload the data to a staging buffer. A readback can pass in a buffer to reuse.
+        if (pSrcData || pStaging == nullptr || pStaging->getSize() < dataSize)
+        {
+            pStaging = Buffer::create(dataSize, Buffer::BindFlags::None, pSrcData ? Buffer::CpuAccess::Write : Buffer::CpuAccess::Read, pSrcData);
+        }
         vkCopy.bufferOffset = pStaging->getGpuAddressOffset();
     }
 
@@ -219,30 +222,38 @@ namespace Falcor
         }
     }
 
-    CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(CopyContext::SharedPtr pCtx, const Texture* pTexture, uint32_t subresourceIndex)
+    CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(CopyContext::SharedPtr pCtx, const Texture* pTexture, uint32_t subresourceIndex, const Buffer::SharedPtr& pBuffer, bool flush)
     {
         SharedPtr pThis = SharedPtr(new ReadTextureTask);
         pThis->mpContext = pCtx;
 
         VkBufferImageCopy vkCopy;
+        pThis->mpBuffer = pBuffer;
         initTexAccessParams(pTexture, subresourceIndex, vkCopy, pThis->mpBuffer, nullptr, {}, uvec3(-1, -1, -1), pThis->mDataSize);
 
         // Execute the copy
         pCtx->resourceBarrier(pTexture, Resource::State::CopySource);
         pCtx->resourceBarrier(pThis->mpBuffer.get(), Resource::State::CopyDest);
         vkCmdCopyImageToBuffer(pCtx->getLowLevelData()->getCommandList(), pTexture->getApiHandle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, pThis->mpBuffer->getApiHandle(), 1, &vkCopy);
+        pCtx->setPendingCommands(true);
 
-        // Create a fence and signal
-        pThis->mpFence = GpuFence::create();
-        pCtx->flush(false);
-        pThis->mpFence->gpuSignal(pCtx->getLowLevelData()->getCommandQueue());
+        // The context signals its fence on every flush. The copy is done once it reaches the value of the next signal.
+        pThis->mpFence = pCtx->getLowLevelData()->getFence();
+        pThis->mFenceValue = pThis->mpFence->getCpuValue();
+        if (flush) pCtx->flush(false);
 
         return pThis;
     }
 
     std::vector<uint8_t> CopyContext::ReadTextureTask::getData()
     {
-        mpFence->syncCpu();
+        // The fence belongs to the context, so syncCpu() also waits for the work submitted after the copy. Only wait if the copy isn't done.
+        if (isReady() == false)
+        {
+            // Submit the copy if the context wasn't flushed since
+            if (mpFence->getCpuValue() <= mFenceValue) mpContext->flush(false);
+            mpFence->syncCpu();
+        }
         // Map and read the results
         std::vector<uint8> result(mDataSize);
         uint8* pData = reinterpret_cast<uint8*>(mpBuffer->map(Buffer::MapType::Read));
@@ -273,6 +284,16 @@ namespace Falcor
         vkCmdPipelineBarrier(mpLowLevelData->getCommandList(), getShaderStageMask(oldState, true), getShaderStageMask(newState, false), 0, 0, nullptr, 0, nullptr, 1, &barrier);
     }
 
+    void CopyContext::resourceBarriers(const std::vector<ResourceTransition>& transitions, const std::vector<const Resource*>& uavResources)
+    {
+        // No split barriers here. Skip the Begin half, the End half does the whole transition.
+        // UAV barriers are not supported yet, see uavBarrier().
+        for (const auto& t : transitions)
+        {
+            if (t.split != ResourceTransition::Split::Begin) resourceBarrier(t.pResource, t.newState);
+        }
+    }
+
     void CopyContext::textureBarrier(const Texture* pTexture, Resource::State newState)
     {
         assert(pTexture->getApiHandle().getType() == VkResourceType::Image);
@@ -38,6 +38,12 @@
 
 #define VERTEX_LOCATION_COUNT       9
 
+// Compressed vertex formats, see Model::LoadFlags::CompressVertices. Used as bits of the per-mesh gVertexCompression.
+#define VERTEX_COMPRESSED_POSITION  0x1     // RGBA16Snorm, decoded with the per-mesh gPositionScale and gPositionOffset
+#define VERTEX_OCT_NORMAL           0x2     // RG16Snorm, octahedral
+#define VERTEX_OCT_BITANGENT        0x4     // RG16Snorm, octahedral
+#define VERTEX_HALF_TEXCOORD        0x8     // RG16Float
+
 #define VERTEX_USER_ELEM_COUNT      4
 #define VERTEX_USER0_LOC            (VERTEX_LOCATION_COUNT)
 
@@ -0,0 +1,69 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "HistogramExposure.h"
+#include <cmath>
+
+namespace Falcor
+{
+    float HistogramExposure::computeAverageLuminance(const std::vector<uint32_t>& histogram, const Settings& settings)
+    {
+        assert(histogram.size() == kHistogramBinCount);
+        uint64_t total = 0;
+        for (auto b : histogram) total += b;
+        if (total == 0) return 1.0f;
+
+        // Only the part of each bin between the percentiles counts
+        float lowCount = settings.lowPercentile * float(total);
+        float highCount = settings.highPercentile * float(total);
+        float binWidth = (settings.range.maxLog2 - settings.range.minLog2) / float(kHistogramBinCount);
+        uint64_t prefix = 0;
+        float sum = 0;
+        float weight = 0;
+        for (uint32_t i = 0; i < kHistogramBinCount; i++)
+        {
+            float begin = float(prefix);
+            float end = float(prefix + histogram[i]);
+            float count = glm::clamp(end, lowCount, highCount) - glm::clamp(begin, lowCount, highCount);
+            sum += count * (settings.range.minLog2 + (float(i) + 0.5f) * binWidth);
+            weight += count;
+            prefix += histogram[i];
+        }
+        return weight > 0 ? std::exp2(sum / weight) : 1.0f;
+    }
+
+    float HistogramExposure::adapt(float prevLuminance, float targetLuminance, float deltaTime, const Settings& settings)
+    {
+        if (!(prevLuminance > 0)) return targetLuminance;
+        float prevLog2 = std::log2(prevLuminance);
+        float targetLog2 = std::log2(targetLuminance);
+        float speed = targetLog2 > prevLog2 ? settings.speedUp : settings.speedDown;
+        float t = 1.0f - std::exp(-deltaTime * speed);
+        return std::exp2(prevLog2 + (targetLog2 - prevLog2) * t);
+    }
+}
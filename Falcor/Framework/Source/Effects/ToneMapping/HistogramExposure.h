@@ -0,0 +1,65 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "Utils/Math/CpuReduction.h"
+
+namespace Falcor
+{
+    /** CPU reference for the histogram-based auto-exposure in ToneMapping. ToneMapping.cs.slang runs the same computations on the GPU.
+        The average luminance is the geometric mean of the luminance histogram (see ReductionType::Histogram), ignoring the texels below the low percentile
+        and above the high percentile, so a few very dark or very bright pixels don't swing the exposure.
+        The result adapts over time towards that average, in log2 space.
+    */
+    class HistogramExposure
+    {
+    public:
+        struct Settings
+        {
+            HistogramRange range;           ///< The log2 luminance range covered by the histogram
+            float lowPercentile = 0.5f;     ///< Fraction of the texels, darkest first, to ignore
+            float highPercentile = 0.95f;   ///< Fraction of the texels, darkest first, after which to ignore the rest
+            float speedUp = 3.0f;           ///< Adaptation speed towards brighter luminance, in 1/seconds
+            float speedDown = 1.0f;         ///< Adaptation speed towards darker luminance, in 1/seconds
+        };
+
+        /** Compute the average luminance of a histogram
+            \param[in] histogram kHistogramBinCount bins
+            \param[in] settings The range and percentiles to use
+            \return The average luminance, or 1 if the histogram is empty
+        */
+        static float computeAverageLuminance(const std::vector<uint32_t>& histogram, const Settings& settings);
+
+        /** Adapt the luminance used for exposure towards a new average
+            \param[in] prevLuminance The luminance used in the previous frame. Values <= 0 mean there is no history, and the target is returned.
+            \param[in] targetLuminance The average luminance of the current frame
+            \param[in] deltaTime Time since the previous frame, in seconds
+            \param[in] settings The adaptation speeds to use
+        */
+        static float adapt(float prevLuminance, float targetLuminance, float deltaTime, const Settings& settings);
+    };
+}
@@ -33,6 +33,8 @@
 namespace Falcor
 {
     static const char* kShaderFilename = "Effects/ToneMapping.ps.slang";
+    static const char* kExposureShaderFilename = "Effects/ToneMappingExposure.cs.slang";
+    static const uint32_t kExposureGroupWidth = 16;     // Must match GROUP_WIDTH in ToneMappingExposure.cs.slang
     const Gui::DropdownList kOperatorList = { 
     { (uint32_t)ToneMapping::Operator::Clamp, "Clamp to LDR" },
     { (uint32_t)ToneMapping::Operator::Linear, "Linear" }, 
@@ -43,6 +45,11 @@ namespace Falcor
     { (uint32_t)ToneMapping::Operator::Aces, "ACES" }
     };
 
+    const Gui::DropdownList kExposureModeList = {
+    { (uint32_t)ToneMapping::ExposureMode::LuminanceMip, "Luminance mip" },
+    { (uint32_t)ToneMapping::ExposureMode::Histogram, "Histogram" }
+    };
+
     static const std::string kOperator = "operator";
 
     ToneMapping::~ToneMapping() = default;
@@ -50,6 +57,7 @@ namespace Falcor
     ToneMapping::ToneMapping(ToneMapping::Operator op) : RenderPass("ToneMapping")
     {
         createLuminancePass();
+        createHistogramPasses();
         createToneMapPass(op);
 
         Sampler::Desc samplerDesc;
@@ -117,26 +125,33 @@ namespace Falcor
     void ToneMapping::execute(RenderContext* pRenderContext, const Texture::SharedPtr& pSrc, const Fbo::SharedPtr& pDst)
     {
         GraphicsState::SharedPtr pState = pRenderContext->getGraphicsState();
-        createLuminanceFbo(pSrc);
-
-        //Set shared vars
-        mpToneMapVars->getDefaultBlock()->setSrv(mBindLocations.colorTex, 0, pSrc->getSRV());
-        mpLuminanceVars->getDefaultBlock()->setSrv(mBindLocations.colorTex, 0, pSrc->getSRV());
-        mpToneMapVars->getDefaultBlock()->setSampler(mBindLocations.colorSampler, 0, mpPointSampler);
-        mpLuminanceVars->getDefaultBlock()->setSampler(mBindLocations.colorSampler, 0, mpLinearSampler);
 
         //Calculate luminance
-        pRenderContext->setGraphicsVars(mpLuminanceVars);
-        pState->setFbo(mpLuminanceFbo);
-        mpLuminancePass->execute(pRenderContext);
-        mpLuminanceFbo->getColorTexture(0)->generateMips(pRenderContext);
+        if (mExposureMode == ExposureMode::Histogram)
+        {
+            // Clamp doesn't use the exposure. Keep the adaptation state for when the operator changes back.
+            if (mOperator != Operator::Clamp) computeHistogramExposure(pRenderContext, pSrc);
+        }
+        else
+        {
+            computeLuminanceMip(pRenderContext, pSrc);
+        }
 
         //Set Tone map vars
+        mpToneMapVars->getDefaultBlock()->setSrv(mBindLocations.colorTex, 0, pSrc->getSRV());
+        mpToneMapVars->getDefaultBlock()->setSampler(mBindLocations.colorSampler, 0, mpPointSampler);
         if (mOperator != Operator::Clamp)
         {
             mpToneMapCBuffer->setBlob(&mConstBufferData, 0u, sizeof(mConstBufferData));
-            mpToneMapVars->getDefaultBlock()->setSampler(mBindLocations.luminanceSampler, 0, mpLinearSampler);
-            mpToneMapVars->getDefaultBlock()->setSrv(mBindLocations.luminanceTex, 0, mpLuminanceFbo->getColorTexture(0)->getSRV());
+            if (mExposureMode == ExposureMode::Histogram)
+            {
+                mpToneMapVars->setStructuredBuffer("gExposureData", mpExposureData);
+            }
+            else
+            {
+                mpToneMapVars->getDefaultBlock()->setSampler(mBindLocations.luminanceSampler, 0, mpLinearSampler);
+                mpToneMapVars->getDefaultBlock()->setSrv(mBindLocations.luminanceTex, 0, mpLuminanceFbo->getColorTexture(0)->getSRV());
+            }
         }
 
         //Tone map
@@ -145,11 +160,72 @@ namespace Falcor
         mpToneMapPass->execute(pRenderContext);
     }
 
+    void ToneMapping::computeLuminanceMip(RenderContext* pRenderContext, const Texture::SharedPtr& pSrc)
+    {
+        PROFILE(ToneMappingLuminanceMip);
+        GraphicsState::SharedPtr pState = pRenderContext->getGraphicsState();
+        createLuminanceFbo(pSrc);
+
+        mpLuminanceVars->getDefaultBlock()->setSrv(mBindLocations.colorTex, 0, pSrc->getSRV());
+        mpLuminanceVars->getDefaultBlock()->setSampler(mBindLocations.colorSampler, 0, mpLinearSampler);
+
+        pRenderContext->setGraphicsVars(mpLuminanceVars);
+        pState->setFbo(mpLuminanceFbo);
+        mpLuminancePass->execute(pRenderContext);
+        mpLuminanceFbo->getColorTexture(0)->generateMips(pRenderContext);
+    }
+
+    void ToneMapping::computeHistogramExposure(RenderContext* pRenderContext, const Texture::SharedPtr& pSrc)
+    {
+        PROFILE(ToneMappingHistogram);
+        mAdaptationTimer.update();
+        if (mResetAdaptation)
+        {
+            // An adapted luminance of 0 tells the shader there is no history
+            pRenderContext->clearUAV(mpExposureData->getUAV().get(), vec4(0));
+            mResetAdaptation = false;
+        }
+        pRenderContext->clearUAV(mpHistogram->getUAV().get(), uvec4(0));
+
+        const auto& settings = mHistogramSettings;
+        uvec2 dims(pSrc->getWidth(), pSrc->getHeight());
+        for (ExposurePass* pPass : { &mHistogramPass, &mAdaptPass })
+        {
+            auto pCB = pPass->pVars["PerFrameCB"];
+            pCB["gDims"] = dims;
+            pCB["gHistogramMin"] = settings.range.minLog2;
+            pCB["gBinsPerStop"] = float(kHistogramBinCount) / (settings.range.maxLog2 - settings.range.minLog2);
+            pCB["gLowPercentile"] = settings.lowPercentile;
+            pCB["gHighPercentile"] = settings.highPercentile;
+            pCB["gSpeedUp"] = settings.speedUp;
+            pCB["gSpeedDown"] = settings.speedDown;
+            pCB["gDeltaTime"] = mAdaptationTimer.getElapsedTime();
+        }
+        mHistogramPass.pVars->setTexture("gColorTex", pSrc);
+
+        pRenderContext->pushComputeState(mHistogramPass.pState);
+        pRenderContext->pushComputeVars(mHistogramPass.pVars);
+        pRenderContext->dispatch((dims.x + kExposureGroupWidth - 1) / kExposureGroupWidth, (dims.y + kExposureGroupWidth - 1) / kExposureGroupWidth, 1);
+        pRenderContext->popComputeVars();
+        pRenderContext->popComputeState();
+
+        pRenderContext->pushComputeState(mAdaptPass.pState);
+        pRenderContext->pushComputeVars(mAdaptPass.pVars);
+        pRenderContext->dispatch(1, 1, 1);
+        pRenderContext->popComputeVars();
+        pRenderContext->popComputeState();
+    }
+
     void ToneMapping::createToneMapPass(ToneMapping::Operator op)
     {
         mpToneMapPass = FullScreenPass::create(kShaderFilename);
 
         mOperator = op;
+        if (mExposureMode == ExposureMode::Histogram)
+        {
+            mpToneMapPass->getProgram()->addDefine("_HISTOGRAM_EXPOSURE");
+        }
+
         switch(op)
         {
         case Operator::Clamp:
@@ -195,6 +271,25 @@ namespace Falcor
         mpLuminanceVars = GraphicsVars::create(pReflector);
     }
 
+    void ToneMapping::createHistogramPasses()
+    {
+        ComputeProgram::SharedPtr pHistogramProg = ComputeProgram::createFromFile(kExposureShaderFilename, "buildHistogram");
+        mHistogramPass.pVars = ComputeVars::create(pHistogramProg->getReflector());
+        mHistogramPass.pState = ComputeState::create();
+        mHistogramPass.pState->setProgram(pHistogramProg);
+
+        ComputeProgram::SharedPtr pAdaptProg = ComputeProgram::createFromFile(kExposureShaderFilename, "adaptExposure");
+        mAdaptPass.pVars = ComputeVars::create(pAdaptProg->getReflector());
+        mAdaptPass.pState = ComputeState::create();
+        mAdaptPass.pState->setProgram(pAdaptProg);
+
+        mpHistogram = StructuredBuffer::create(pHistogramProg, "gHistogram", kHistogramBinCount);
+        mpExposureData = StructuredBuffer::create(pAdaptProg, "gExposureData", 1);
+        mHistogramPass.pVars->setStructuredBuffer("gHistogram", mpHistogram);
+        mAdaptPass.pVars->setStructuredBuffer("gHistogram", mpHistogram);
+        mAdaptPass.pVars->setStructuredBuffer("gExposureData", mpExposureData);
+    }
+
     void ToneMapping::renderUI(Gui* pGui, const char* uiGroup)
     {
         if((uiGroup == nullptr) || pGui->beginGroup(uiGroup))
@@ -207,7 +302,27 @@ namespace Falcor
             }
 
             pGui->addFloatVar("Exposure Key", mConstBufferData.exposureKey, 0.0001f, 200.0f);
-            pGui->addFloatVar("Luminance LOD", mConstBufferData.luminanceLod, 0, 16, 0.025f);
+
+            uint32_t exposureMode = static_cast<uint32_t>(mExposureMode);
+            if (pGui->addDropdown("Exposure Mode", kExposureModeList, exposureMode))
+            {
+                setExposureMode(static_cast<ExposureMode>(exposureMode));
+            }
+            if (mExposureMode == ExposureMode::Histogram)
+            {
+                auto& settings = mHistogramSettings;
+                pGui->addFloatVar("Min Log2 Luminance", settings.range.minLog2, -20, settings.range.maxLog2 - 1);
+                pGui->addFloatVar("Max Log2 Luminance", settings.range.maxLog2, settings.range.minLog2 + 1, 20);
+                pGui->addFloatVar("Low Percentile", settings.lowPercentile, 0, settings.highPercentile, 0.01f);
+                pGui->addFloatVar("High Percentile", settings.highPercentile, settings.lowPercentile, 1, 0.01f);
+                pGui->addFloatVar("Adaptation Speed Up", settings.speedUp, 0.01f, 100, 0.1f);
+                pGui->addFloatVar("Adaptation Speed Down", settings.speedDown, 0.01f, 100, 0.1f);
+                if (pGui->addButton("Reset Adaptation")) resetExposureAdaptation();
+            }
+            else
+            {
+                pGui->addFloatVar("Luminance LOD", mConstBufferData.luminanceLod, 0, 16, 0.025f);
+            }
             //Only give option to change these if the relevant operator is selected
             if (mOperator == Operator::ReinhardModified)
             {
@@ -230,6 +345,16 @@ namespace Falcor
         }
     }
 
+    void ToneMapping::setExposureMode(ExposureMode mode)
+    {
+        if (mode != mExposureMode)
+        {
+            mExposureMode = mode;
+            mResetAdaptation = true;
+            createToneMapPass(mOperator);
+        }
+    }
+
     void ToneMapping::setExposureKey(float exposureKey)
     {
         mConstBufferData.exposureKey = max(0.001f, exposureKey);
@@ -32,6 +32,10 @@
 #include "API/Sampler.h"
 #include "Utils/Gui.h"
 #include "Graphics/RenderGraph/RenderPass.h"
+#include "Graphics/ComputeState.h"
+#include "Graphics/Program/ProgramVars.h"
+#include "Utils/CpuTimer.h"
+#include "HistogramExposure.h"
 
 namespace Falcor
 {
@@ -59,6 +63,14 @@ namespace Falcor
             Aces,               ///< Aces Filmic Tone-Mapping
         };
 
+        /** How the average luminance used for exposure is computed
+        */
+        enum class ExposureMode
+        {
+            LuminanceMip,       ///< Sample a mip of the log luminance. Requires generating the mip chain every frame. See setLuminanceLod().
+            Histogram,          ///< Luminance histogram with temporal adaptation, computed and applied on the GPU. See HistogramExposure.
+        };
+
         /** Create a new object
         */
         static SharedPtr create(Operator op = Operator::Aces);       
@@ -110,6 +122,18 @@ namespace Falcor
         */
         void setWhiteScale(float whiteScale);
 
+        /** Set how the average luminance is computed. Triggers shader recompilation.
+        */
+        void setExposureMode(ExposureMode mode);
+
+        /** Set the histogram range, percentiles and adaptation speeds. Only used with ExposureMode::Histogram.
+        */
+        void setHistogramExposureSettings(const HistogramExposure::Settings& settings) { mHistogramSettings = settings; }
+
+        /** Restart the temporal adaptation. The next frame is exposed for its own average luminance.
+        */
+        void resetExposureAdaptation() { mResetAdaptation = true; }
+
         /** Called once before compilation. Describes I/O requirements of the pass.
         The requirements can't change after the graph is compiled. If the IO requests are dynamic, you'll need to trigger compilation of the render-graph yourself.
         */
@@ -139,12 +163,22 @@ namespace Falcor
 		*/
         float getWhiteScale() const { return mConstBufferData.whiteScale; }
 
+        /** Get how the average luminance is computed.
+        */
+        ExposureMode getExposureMode() const { return mExposureMode; }
+
+        /** Get the histogram exposure settings.
+        */
+        const HistogramExposure::Settings& getHistogramExposureSettings() const { return mHistogramSettings; }
+
         /** Get the scripting dictionary
         */
         Dictionary getScriptingDictionary() const override;
     private:
         ToneMapping(Operator op);
         void createLuminanceFbo(const Texture::SharedPtr& pSrc);
+        void computeLuminanceMip(RenderContext* pRenderContext, const Texture::SharedPtr& pSrc);
+        void computeHistogramExposure(RenderContext* pRenderContext, const Texture::SharedPtr& pSrc);
 
         Operator mOperator;
         FullScreenPass::UniquePtr mpToneMapPass;
@@ -156,6 +190,21 @@ namespace Falcor
         Sampler::SharedPtr mpPointSampler;
         Sampler::SharedPtr mpLinearSampler;
 
+        // Histogram exposure
+        struct ExposurePass
+        {
+            ComputeVars::SharedPtr pVars;
+            ComputeState::SharedPtr pState;
+        };
+        ExposurePass mHistogramPass;
+        ExposurePass mAdaptPass;
+        StructuredBuffer::SharedPtr mpHistogram;
+        StructuredBuffer::SharedPtr mpExposureData;
+        ExposureMode mExposureMode = ExposureMode::LuminanceMip;
+        HistogramExposure::Settings mHistogramSettings;
+        CpuTimer mAdaptationTimer;
+        bool mResetAdaptation = true;
+
         struct PassBindLocations
         {
             ParameterBlockReflection::BindLocation luminanceSampler;
@@ -174,6 +223,7 @@ namespace Falcor
 
         void createToneMapPass(Operator op);
         void createLuminancePass();
+        void createHistogramPasses();
     };
 
 #define tonemap_op(a) case ToneMapping::Operator::a: return #a
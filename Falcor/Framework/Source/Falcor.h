@@ -107,6 +107,7 @@
 #include "Utils/Math/FalcorMath.h"
 #include "Utils/Math/CubicSpline.h"
 #include "Utils/Math/ParallelReduction.h"
+#include "Utils/Math/FrustumCulling.h"
 
 // RenderGraph
 #include "Graphics/RenderGraph/RenderGraph.h"
@@ -125,6 +126,7 @@
 // Utils
 #include "Utils/Bitmap.h"
 #include "Utils/DDSHeader.h"
+#include "Utils/BcCompression.h"
 #include "Utils/Font.h"
 #include "Utils/Gui.h"
 #include "Utils/Logger.h"
@@ -140,6 +142,7 @@
 #include "Utils/Platform/OS.h"
 #include "Utils/Platform/ProgressBar.h"
 #include "Utils/ThreadPool.h"
+#include "Utils/ParallelFor.h"
 #include "Utils/PatternGenerators/DxSamplePattern.h"
 #include "Utils/PatternGenerators/HaltonSamplePattern.h"
 
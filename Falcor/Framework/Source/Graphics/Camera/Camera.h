@@ -195,6 +195,11 @@ namespace Falcor
         */
         bool isObjectCulled(const BoundingBox& box) const;
 
+        /** Get a frustum plane in world space. A point p is on the inner side of the plane if dot(plane.xyz, p) + plane.w > 0.
+            \param[in] index Plane index, 0 to 5
+        */
+        glm::vec4 getFrustumPlane(uint32_t index) const;
+
         /** Set camera data into a program's constant buffer.
             \param[in] pBuffer The constant buffer to set the parameters into.
             \param[in] varName The name of the light variable in the program.
@@ -28,8 +28,14 @@
 #include "Framework.h"
 #include "Animation.h"
 #include "AnimationController.h"
-#include "glm/gtc/matrix_transform.hpp"
-#include "glm/gtx/transform.hpp"
+#include <algorithm>
+#include <cmath>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
 
 namespace Falcor
 {
@@ -43,107 +49,205 @@ namespace Falcor
         return UniquePtr(new Animation(other));
     }
 
-    Animation::Animation(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond) : mName(name), mAnimationSets(animationSets), mDuration(duration), mTicksPerSecond(ticksPerSecond)
+    Animation::Animation(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond) : mName(name), mDuration(duration), mTicksPerSecond(ticksPerSecond)
     {
-
+        initTracks(animationSets);
+        resizeBatches();
     }
 
-    Animation::Animation(const Animation& other) : mName(other.mName), mDuration(other.mDuration), mTicksPerSecond(other.mTicksPerSecond)
+    Animation::Animation(const Animation& other) : mName(other.mName), mDuration(other.mDuration), mTicksPerSecond(other.mTicksPerSecond),
+        mTracks(other.mTracks), mTranslationKeys(other.mTranslationKeys), mScalingKeys(other.mScalingKeys), mRotationKeys(other.mRotationKeys)
     {
-        mAnimationSets = other.mAnimationSets;
+        resizeBatches();
     }
 
     Animation::~Animation() = default;
 
-    template<typename T>
-    uint32_t findCurrentFrame(T channel, float ticks)
+    void Animation::initTracks(const std::vector<AnimationSet>& animationSets)
     {
-        uint32_t curKeyID = channel.lastKeyUsed;
-        while(curKeyID < channel.keys.size() - 1)
+        auto appendChannel = [](const auto& channel, auto& stream)
         {
-            if(channel.keys[curKeyID + 1].time > ticks)
+            ChannelRange range;
+            range.firstKey = (uint32_t)stream.times.size();
+            range.keyCount = (uint32_t)channel.keys.size();
+            for (const auto& key : channel.keys)
             {
-                break;
+                stream.times.push_back(key.time);
+                stream.values.push_back(key.value);
             }
-            curKeyID++;
+            return range;
+        };
+
+        for (const auto& set : animationSets)
+        {
+            Track track;
+            track.boneID = set.boneID;
+            track.translation = appendChannel(set.translation, mTranslationKeys);
+            track.scaling = appendChannel(set.scaling, mScalingKeys);
+            track.rotation = appendChannel(set.rotation, mRotationKeys);
+            mTracks.push_back(track);
         }
-        return curKeyID;
     }
 
-    glm::vec3 interpolate(const glm::vec3& start, const glm::vec3& end, float ratio)
+    void Animation::resizeBatches()
     {
-        return start + ((end - start) * ratio);
+        size_t paddedCount = (mTracks.size() + 3) & ~size_t(3);
+        auto resize = [paddedCount](auto& batch)
+        {
+            for (auto& v : batch.start) v.assign(paddedCount, 0.0f);
+            for (auto& v : batch.end) v.assign(paddedCount, 0.0f);
+            batch.ratio.assign(paddedCount, 0.0f);
+        };
+        resize(mTranslationBatch);
+        resize(mScalingBatch);
+        resize(mRotationBatch);
+        mCursors.assign(mTracks.size() * 3, 0);
+        mLastTicks = 0;
     }
 
-    glm::quat interpolate(const glm::quat& start, const glm::quat& end, float ratio)
+    // Find the last key at or before ticks, or the first key if there is none.
+    // Playback usually advances by less than a key per frame, so start from the key used last time and only binary search on long jumps.
+    static uint32_t findKey(const float* pTimes, uint32_t keyCount, float ticks, bool rewind, uint32_t& cursor)
     {
-        return glm::slerp(start, end, ratio);
+        const uint32_t kMaxSteps = 4;
+        uint32_t key = cursor;
+        bool search = rewind || key >= keyCount;
+        for (uint32_t step = 0; search == false && key + 1 < keyCount && pTimes[key + 1] <= ticks; step++, key++)
+        {
+            search = (step == kMaxSteps);
+        }
+        if (search)
+        {
+            uint32_t upper = uint32_t(std::upper_bound(pTimes, pTimes + keyCount, ticks) - pTimes);
+            key = upper ? upper - 1 : 0;
+        }
+        cursor = key;
+        return key;
     }
 
-    template<typename KeyType>
-    KeyType Animation::calcCurrentKey(AnimationChannel<KeyType>& channel, float ticks, float lastUpdateTime)
+    static void storeComponents(std::vector<float>* pDst, uint32_t index, const glm::vec3& v) { for (uint32_t c = 0; c < 3; c++) pDst[c][index] = v[c]; }
+    static void storeComponents(std::vector<float>* pDst, uint32_t index, const glm::quat& q) { pDst[0][index] = q.x; pDst[1][index] = q.y; pDst[2][index] = q.z; pDst[3][index] = q.w; }
+
+    template<typename T, uint32_t N>
+    void Animation::gatherKeys(const ChannelRange& range, const KeyStream<T>& keys, float ticks, bool rewind, uint32_t& cursor, const T& defaultValue, Batch<N>& batch, uint32_t index)
     {
-        KeyType curValue;
-        if(channel.keys.size() > 0)
+        if (range.keyCount == 0)
         {
-            if(ticks < lastUpdateTime)
-            {
-                channel.lastKeyUsed = 0;
-            }
+            storeComponents(batch.start, index, defaultValue);
+            storeComponents(batch.end, index, defaultValue);
+            batch.ratio[index] = 0;
+            return;
+        }
 
-            // search for the next keyframe
-            uint32_t curKeyIndex = findCurrentFrame(channel, ticks);
-            uint32_t nextKeyIndex = (curKeyIndex + 1) % channel.keys.size();
-            const AnimationKey<KeyType>& curKey = channel.keys[curKeyIndex];
-            const AnimationKey<KeyType>& nextKey = channel.keys[nextKeyIndex];
+        const float* pTimes = keys.times.data() + range.firstKey;
+        uint32_t curKey = findKey(pTimes, range.keyCount, ticks, rewind, cursor);
+        uint32_t nextKey = (curKey + 1) % range.keyCount;
 
-            assert(ticks >= curKey.time);
-            // Interpolate between them
-            float diff = nextKey.time - curKey.time;
+        // Past the last key, interpolate towards the first one across the loop
+        float diff = pTimes[nextKey] - pTimes[curKey];
+        if (diff < 0) diff += mDuration;
 
-            if (diff == 0)
+        storeComponents(batch.start, index, keys.values[range.firstKey + curKey]);
+        storeComponents(batch.end, index, keys.values[range.firstKey + nextKey]);
+        batch.ratio[index] = (diff == 0) ? 0 : (ticks - pTimes[curKey]) / diff;
+    }
+
+    static void lerpBatch(std::vector<float>* pStart, const std::vector<float>* pEnd, const std::vector<float>& ratio)
+    {
+        for (size_t i = 0; i < ratio.size(); i += 4)
+        {
+            __m128 t = _mm_loadu_ps(&ratio[i]);
+            for (uint32_t c = 0; c < 3; c++)
             {
-                curValue = curKey.value;
+                __m128 a = _mm_loadu_ps(&pStart[c][i]);
+                __m128 b = _mm_loadu_ps(&pEnd[c][i]);
+                _mm_storeu_ps(&pStart[c][i], _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t)));
             }
-            else
-            {
-                if (diff < 0)
-                {
-                    diff += mDuration;
-                }
+        }
+    }
 
-                float ratio = (ticks - curKey.time) / diff;
-                curValue = interpolate(curKey.value, nextKey.value, ratio);
+    // Normalized lerp with a corrected interpolation parameter, which approximates slerp without trigonometry.
+    // From "Approximating slerp" by Arseny Kapoulkine. Takes the shortest path, like glm::slerp().
+    static void slerpBatch(std::vector<float>* pStart, const std::vector<float>* pEnd, const std::vector<float>& ratio)
+    {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        for (size_t i = 0; i < ratio.size(); i += 4)
+        {
+            __m128 a[4], b[4];
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                a[c] = _mm_loadu_ps(&pStart[c][i]);
+                b[c] = _mm_loadu_ps(&pEnd[c][i]);
             }
-            
-            channel.lastKeyUsed = curKeyIndex;
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_add_ps(_mm_mul_ps(a[2], b[2]), _mm_mul_ps(a[3], b[3])));
+
+            // Flip the end quaternion to take the shortest path
+            __m128 sign = _mm_and_ps(d, signMask);
+            for (uint32_t c = 0; c < 4; c++) b[c] = _mm_xor_ps(b[c], sign);
+            d = _mm_andnot_ps(signMask, d);
+
+            __m128 t = _mm_loadu_ps(&ratio[i]);
+            __m128 ka = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-3.2452f), _mm_mul_ps(d, _mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(d, _mm_set1_ps(1.43519f)))))));
+            __m128 kb = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-1.06021f), _mm_mul_ps(d, _mm_set1_ps(0.215638f)))));
+            __m128 tc = _mm_sub_ps(t, half);
+            __m128 k = _mm_add_ps(_mm_mul_ps(ka, _mm_mul_ps(tc, tc)), kb);
+            __m128 ot = _mm_add_ps(t, _mm_mul_ps(_mm_mul_ps(t, _mm_mul_ps(tc, _mm_sub_ps(t, one))), k));
+
+            __m128 r[4];
+            __m128 lengthSq = zero;
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                r[c] = _mm_add_ps(a[c], _mm_mul_ps(_mm_sub_ps(b[c], a[c]), ot));
+                lengthSq = _mm_add_ps(lengthSq, _mm_mul_ps(r[c], r[c]));
+            }
+            // Padding lanes are all zero, keep them finite
+            __m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(_mm_max_ps(lengthSq, _mm_set1_ps(1e-30f))));
+            for (uint32_t c = 0; c < 4; c++) _mm_storeu_ps(&pStart[c][i], _mm_mul_ps(r[c], invLength));
         }
-        return curValue;
     }
 
-    void Animation::animate(double totalTime, AnimationController* pAnimationController)
+    void Animation::evaluate(double totalTime, glm::mat4* pLocalTransforms)
     {
         // Calculate the relative time
         float ticks = (float)fmod(totalTime * mTicksPerSecond, mDuration);
+        bool rewind = ticks < mLastTicks;
+        mLastTicks = ticks;
 
-        for(auto& Key : mAnimationSets)
+        // Find the keys of every channel and gather them into the batches
+        for (uint32_t i = 0; i < (uint32_t)mTracks.size(); i++)
         {
-            glm::mat4 translation;
-            translation[3] = glm::vec4(calcCurrentKey(Key.translation, ticks, Key.lastUpdateTime), 1);
-
-            glm::mat4 scaling;
-            if (Key.scaling.keys.size() > 0)
-            {
-                scaling = glm::scale(calcCurrentKey(Key.scaling, ticks, Key.lastUpdateTime));
-            }
-
-            glm::quat q = calcCurrentKey(Key.rotation, ticks, Key.lastUpdateTime);
-            glm::mat4 rotation = glm::mat4_cast(q);
+            const Track& track = mTracks[i];
+            uint32_t* pCursors = &mCursors[i * 3];
+            gatherKeys(track.translation, mTranslationKeys, ticks, rewind, pCursors[0], glm::vec3(0), mTranslationBatch, i);
+            gatherKeys(track.scaling, mScalingKeys, ticks, rewind, pCursors[1], glm::vec3(1), mScalingBatch, i);
+            gatherKeys(track.rotation, mRotationKeys, ticks, rewind, pCursors[2], glm::quat(1, 0, 0, 0), mRotationBatch, i);
+        }
 
-            Key.lastUpdateTime = ticks;
+        lerpBatch(mTranslationBatch.start, mTranslationBatch.end, mTranslationBatch.ratio);
+        lerpBatch(mScalingBatch.start, mScalingBatch.end, mScalingBatch.ratio);
+        slerpBatch(mRotationBatch.start, mRotationBatch.end, mRotationBatch.ratio);
 
-            glm::mat4 T = translation * rotation * scaling;
-            pAnimationController->setBoneLocalTransform(Key.boneID, T);
+        // translation * rotation * scaling, without the matrix products
+        const auto& t = mTranslationBatch.start;
+        const auto& s = mScalingBatch.start;
+        const auto& r = mRotationBatch.start;
+        for (uint32_t i = 0; i < (uint32_t)mTracks.size(); i++)
+        {
+            float x = r[0][i], y = r[1][i], z = r[2][i], w = r[3][i];
+            float xx = x * x, yy = y * y, zz = z * z, xy = x * y, xz = x * z, yz = y * z, wx = w * x, wy = w * y, wz = w * z;
+            glm::mat4& m = pLocalTransforms[mTracks[i].boneID];
+            m[0] = glm::vec4((1 - 2 * (yy + zz)) * s[0][i], 2 * (xy + wz) * s[0][i], 2 * (xz - wy) * s[0][i], 0);
+            m[1] = glm::vec4(2 * (xy - wz) * s[1][i], (1 - 2 * (xx + zz)) * s[1][i], 2 * (yz + wx) * s[1][i], 0);
+            m[2] = glm::vec4(2 * (xz + wy) * s[2][i], 2 * (yz - wx) * s[2][i], (1 - 2 * (xx + yy)) * s[2][i], 0);
+            m[3] = glm::vec4(t[0][i], t[1][i], t[2][i], 1);
         }
     }
+
+    void Animation::animate(double totalTime, AnimationController* pAnimationController)
+    {
+        evaluate(totalTime, pAnimationController->mLocalTransforms.data());
+    }
 }
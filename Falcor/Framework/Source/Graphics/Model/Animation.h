@@ -28,12 +28,18 @@
 #pragma once
 #include <vector>
 #include "glm/vec3.hpp"
+#include "glm/mat4x4.hpp"
 #include "glm/gtc/quaternion.hpp"
 
 namespace Falcor
 {
     class AnimationController;
 
+    /** A keyframe animation of a bone hierarchy.
+        The keys are passed in as one AnimationSet per bone, and stored as SoA tracks: the key times and values of each channel are contiguous, and the
+        keys used by the last evaluation are cached, so playing forward only checks the next few keys.
+        The bones are interpolated 4 at a time with SSE. Rotations use an approximation of slerp which stays within 1e-3 of the exact result.
+    */
     class Animation
     {
     public:
@@ -51,7 +57,6 @@ namespace Falcor
         struct AnimationChannel
         {
             std::vector<AnimationKey<T>> keys;
-            uint32_t lastKeyUsed = 0;
         };
 
         struct AnimationSet
@@ -60,7 +65,6 @@ namespace Falcor
             AnimationChannel<glm::vec3> translation;
             AnimationChannel<glm::vec3> scaling;
             AnimationChannel<glm::quat> rotation;
-            float lastUpdateTime = 0;
         };
 
         static UniquePtr create(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond);
@@ -69,17 +73,71 @@ namespace Falcor
         void animate(double totalTime, AnimationController* pAnimationController);
         const std::string& getName() const { return mName; }
 
+        /** Evaluate the local transforms of the animated bones
+            \param[in] totalTime The global time in seconds
+            \param[out] pLocalTransforms Indexed by bone ID. Bones without keys in the animation are left untouched.
+        */
+        void evaluate(double totalTime, glm::mat4* pLocalTransforms);
+
+        /** Get the number of bones with keys in the animation
+        */
+        uint32_t getTrackCount() const { return uint32_t(mTracks.size()); }
+
     private:
         Animation(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond);
         Animation(const Animation& other);
-        
+
         const std::string mName;
         float mDuration;
         float mTicksPerSecond;
 
-        std::vector<AnimationSet> mAnimationSets;
+        struct ChannelRange
+        {
+            uint32_t firstKey = 0;
+            uint32_t keyCount = 0;
+        };
+
+        struct Track
+        {
+            uint32_t boneID;
+            ChannelRange translation;
+            ChannelRange scaling;
+            ChannelRange rotation;
+        };
+
+        template<typename T>
+        struct KeyStream
+        {
+            std::vector<float> times;
+            std::vector<T> values;
+        };
+
+        // Interpolation inputs for 4 bones at a time. Each array holds one component of every track, padded to a multiple of 4.
+        // The interpolation writes the result over the start values.
+        template<uint32_t N>
+        struct Batch
+        {
+            std::vector<float> start[N];
+            std::vector<float> end[N];
+            std::vector<float> ratio;
+        };
+
+        std::vector<Track> mTracks;
+        KeyStream<glm::vec3> mTranslationKeys;
+        KeyStream<glm::vec3> mScalingKeys;
+        KeyStream<glm::quat> mRotationKeys;
+
+        // The key index used by the last evaluation of each channel, relative to the channel's first key. 3 per track.
+        std::vector<uint32_t> mCursors;
+        float mLastTicks = 0;
+
+        Batch<3> mTranslationBatch;
+        Batch<3> mScalingBatch;
+        Batch<4> mRotationBatch;
 
-        template<typename _KeyType>
-        _KeyType calcCurrentKey(AnimationChannel<_KeyType>& channel, float ticks, float lastUpdateTime);
+        void initTracks(const std::vector<AnimationSet>& animationSets);
+        void resizeBatches();
+        template<typename T, uint32_t N>
+        void gatherKeys(const ChannelRange& range, const KeyStream<T>& keys, float ticks, bool rewind, uint32_t& cursor, const T& defaultValue, Batch<N>& batch, uint32_t index);
     };
-}
\ No newline at end of file
+}
@@ -27,11 +27,16 @@
 ***************************************************************************/
 #include "Framework.h"
 #include "AnimationController.h"
-#include "Model.h"
 #include <fstream>
 #include "Animation.h"
 #include <algorithm>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+
 namespace Falcor
 {
     void dumpBonesHeirarchy(const std::string& filename, Bone* pBone, uint32_t count)
@@ -74,14 +79,27 @@ namespace Falcor
     AnimationController::AnimationController(const std::vector<Bone>& Bones)
     {
         mBones = Bones;
+        for (const auto& bone : mBones)
+        {
+            mLocalTransforms.push_back(bone.localTransform);
+            mOffsets.push_back(bone.offset);
+            mParentIDs.push_back(bone.parentID);
+        }
+        mGlobalTransforms.resize(mBones.size());
         mBoneTransforms.resize(mBones.size());
         mBoneInvTransposeTransforms.resize(mBones.size());
+        initEvaluationOrder();
         setActiveAnimation(kBindPoseAnimationId);
     }
 
     AnimationController::AnimationController(const AnimationController& other)
     {
         mBones = other.mBones;
+        mLocalTransforms = other.mLocalTransforms;
+        mGlobalTransforms = other.mGlobalTransforms;
+        mOffsets = other.mOffsets;
+        mParentIDs = other.mParentIDs;
+        mEvalOrder = other.mEvalOrder;
         mBoneTransforms = other.mBoneTransforms;
         mBoneInvTransposeTransforms = other.mBoneInvTransposeTransforms;
         for (const auto& it : other.mAnimations)
@@ -98,29 +116,100 @@ namespace Falcor
 
     AnimationController::~AnimationController() = default;
 
+    void AnimationController::initEvaluationOrder()
+    {
+        // Sort the bones by depth. The sort is stable, so a skeleton which is already ordered keeps its order.
+        uint32_t boneCount = (uint32_t)mBones.size();
+        std::vector<uint32_t> depth(boneCount, 0);
+        for (uint32_t i = 0; i < boneCount; i++)
+        {
+            uint32_t parent = mParentIDs[i];
+            while (parent != kInvalidBoneID)
+            {
+                assert(parent < boneCount);
+                if (depth[i] >= boneCount)
+                {
+                    logError("AnimationController: the bone hierarchy contains a cycle");
+                    break;
+                }
+                depth[i]++;
+                parent = mParentIDs[parent];
+            }
+        }
+
+        mEvalOrder.resize(boneCount);
+        for (uint32_t i = 0; i < boneCount; i++) mEvalOrder[i] = i;
+        std::stable_sort(mEvalOrder.begin(), mEvalOrder.end(), [&depth](uint32_t a, uint32_t b) { return depth[a] < depth[b]; });
+    }
+
     void AnimationController::setBoneLocalTransform(uint32_t boneID, const glm::mat4& transform)
     {
         assert(boneID < mBones.size());
-        mBones[boneID].localTransform = transform;
+        mLocalTransforms[boneID] = transform;
     }
 
-    void AnimationController::animate(double currentTime)
+    // result = a * b, for column-major matrices. result can alias a or b.
+    static void multiplyMatrices(const glm::mat4& a, const glm::mat4& b, glm::mat4& result)
     {
-        if(mActiveAnimation != kBindPoseAnimationId)
+        const float* pA = &a[0][0];
+        const float* pB = &b[0][0];
+        __m128 a0 = _mm_loadu_ps(pA);
+        __m128 a1 = _mm_loadu_ps(pA + 4);
+        __m128 a2 = _mm_loadu_ps(pA + 8);
+        __m128 a3 = _mm_loadu_ps(pA + 12);
+        __m128 col[4];
+        for (uint32_t c = 0; c < 4; c++)
         {
-            mAnimations[mActiveAnimation]->animate(currentTime, this);
+            const float* pCol = pB + c * 4;
+            col[c] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(pCol[0])), _mm_mul_ps(a1, _mm_set1_ps(pCol[1]))),
+                _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(pCol[2])), _mm_mul_ps(a3, _mm_set1_ps(pCol[3]))));
         }
+        float* pResult = &result[0][0];
+        for (uint32_t c = 0; c < 4; c++) _mm_storeu_ps(pResult + c * 4, col[c]);
+    }
 
-        for(uint32_t i = 0; i < mBones.size(); i++)
+    // transpose(inverse(m)) for an affine matrix. The rows of the inverse of the upper 3x3 are the cross products of its columns, divided by the determinant.
+    static void affineInverseTranspose(const glm::mat4& m, glm::mat4& result)
+    {
+        glm::vec3 c0(m[0]), c1(m[1]), c2(m[2]), t(m[3]);
+        glm::vec3 r0 = glm::cross(c1, c2);
+        glm::vec3 r1 = glm::cross(c2, c0);
+        glm::vec3 r2 = glm::cross(c0, c1);
+        float invDet = 1.0f / glm::dot(c0, r0);
+        r0 *= invDet;
+        r1 *= invDet;
+        r2 *= invDet;
+        result[0] = glm::vec4(r0, -glm::dot(r0, t));
+        result[1] = glm::vec4(r1, -glm::dot(r1, t));
+        result[2] = glm::vec4(r2, -glm::dot(r2, t));
+        result[3] = glm::vec4(0, 0, 0, 1);
+    }
+
+    void AnimationController::calculateBoneTransforms()
+    {
+        for (uint32_t i : mEvalOrder)
         {
-            mBones[i].globalTransform = mBones[i].localTransform;
-            if(mBones[i].parentID != kInvalidBoneID)
+            uint32_t parentID = mParentIDs[i];
+            if (parentID != kInvalidBoneID)
             {
-                mBones[i].globalTransform = mBones[mBones[i].parentID].globalTransform * mBones[i].localTransform;
+                multiplyMatrices(mGlobalTransforms[parentID], mLocalTransforms[i], mGlobalTransforms[i]);
             }
-            mBoneTransforms[i] = mBones[i].globalTransform * mBones[i].offset;
-            mBoneInvTransposeTransforms[i] = transpose(inverse(mBoneTransforms[i]));
+            else
+            {
+                mGlobalTransforms[i] = mLocalTransforms[i];
+            }
+            multiplyMatrices(mGlobalTransforms[i], mOffsets[i], mBoneTransforms[i]);
+            affineInverseTranspose(mBoneTransforms[i], mBoneInvTransposeTransforms[i]);
+        }
+    }
+
+    void AnimationController::animate(double currentTime)
+    {
+        if(mActiveAnimation != kBindPoseAnimationId)
+        {
+            mAnimations[mActiveAnimation]->animate(currentTime, this);
         }
+        calculateBoneTransforms();
     }
 
     void AnimationController::setActiveAnimation(uint32_t id)
@@ -129,9 +218,9 @@ namespace Falcor
         mActiveAnimation = id;
         if(id == kBindPoseAnimationId)
         {
-            for(auto& bone : mBones)
+            for(uint32_t i = 0; i < mBones.size(); i++)
             {
-                bone.localTransform = bone.originalLocalTransform;
+                mLocalTransforms[i] = mBones[i].originalLocalTransform;
             }
         }
         animate(0);
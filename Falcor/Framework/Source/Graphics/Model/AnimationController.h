@@ -47,6 +47,10 @@ namespace Falcor
     class Model;
     class AssimpModelImporter;
 
+    /** Evaluates the active animation of a skeleton and computes the skinning matrices.
+        The bone transforms are stored as SoA arrays and the hierarchy is evaluated in topological order, so parents are always ready before their children
+        regardless of the bone IDs the importer assigned. Controllers don't share state, and different models can be animated concurrently (see Model::animateModels()).
+    */
     class AnimationController
     {
     public:
@@ -74,17 +78,28 @@ namespace Falcor
         uint32_t getBoneIdFromName(const std::string& name) const;
         void setBoneLocalTransform(uint32_t boneID, const glm::mat4& transform);
 
+        /** Get the order in which the bones are evaluated. Every bone comes after its parent.
+        */
+        const std::vector<uint32_t>& getEvaluationOrder() const { return mEvalOrder; }
+
     private:
+        friend class Animation;
         AnimationController(const std::vector<Bone>& bones);
         AnimationController(const AnimationController& other);
 
         std::vector<Bone> mBones;
+        std::vector<glm::mat4> mLocalTransforms;
+        std::vector<glm::mat4> mGlobalTransforms;
+        std::vector<glm::mat4> mOffsets;
+        std::vector<uint32_t> mParentIDs;
+        std::vector<uint32_t> mEvalOrder;
         std::vector<glm::mat4> mBoneTransforms;
         std::vector<glm::mat4> mBoneInvTransposeTransforms;
         std::vector<Animation::UniquePtr> mAnimations;
 
         uint32_t mActiveAnimation = kBindPoseAnimationId;
 
+        void initEvaluationOrder();
         void calculateBoneTransforms();
     };
 }
\ No newline at end of file
@@ -34,6 +34,7 @@
 #include "Graphics/Model/Model.h"
 #include "Graphics/Model/Animation.h"
 #include "Graphics/Model/Mesh.h"
+#include "Graphics/Model/MeshOptimizer.h"
 #include "Graphics/Model/AnimationController.h"
 #include "API/Texture.h"
 #include "API/Buffer.h"
@@ -194,6 +195,23 @@ namespace Falcor
         { VERTEX_DIFFUSE_COLOR_LOC, VERTEX_DIFFUSE_COLOR_NAME,  ResourceFormat::RGBA32Float },
     };
 
+    // Formats used with Model::LoadFlags::CompressVertices. See VertexLayout::getVertexCompressionFlags().
+    ResourceFormat getCompressedFormat(uint32_t location)
+    {
+        switch (location)
+        {
+        case VERTEX_POSITION_LOC:
+            return ResourceFormat::RGBA16Snorm;
+        case VERTEX_NORMAL_LOC:
+        case VERTEX_BITANGENT_LOC:
+            return ResourceFormat::RG16Snorm;
+        case VERTEX_TEXCOORD_LOC:
+            return ResourceFormat::RG16Float;
+        default:
+            return kLayoutData[location].format;
+        }
+    }
+
 
     glm::mat4 aiMatToGLM(const aiMatrix4x4& aiMat)
     {
@@ -523,6 +541,9 @@ namespace Falcor
         // Never use Assimp's tangent gen code
         assimpFlags &= ~(aiProcess_CalcTangentSpace);
 
+        // MeshOptimizer replaces Assimp's cache locality pass
+        if(is_set(mFlags, Model::LoadFlags::OptimizeMeshes))                    assimpFlags &= ~aiProcess_ImproveCacheLocality;
+
         Assimp::Importer importer;
         const aiScene* pScene = importer.ReadFile(fullpath, assimpFlags);
 
@@ -553,6 +574,12 @@ namespace Falcor
             return false;
         }
 
+        if (mCacheStatsBefore.triangleCount > 0)
+        {
+            logInfo("Optimized meshes of " + filename + ": ACMR " + std::to_string(mCacheStatsBefore.acmr) + " -> " + std::to_string(mCacheStatsAfter.acmr) +
+                ", ATVR " + std::to_string(mCacheStatsBefore.atvr) + " -> " + std::to_string(mCacheStatsAfter.atvr) + ", " + std::to_string(mMeshletCount) + " meshlets");
+        }
+
         return true;
     }
 
@@ -767,16 +794,42 @@ namespace Falcor
     {
         uint32_t vertexCount = pAiMesh->mNumVertices;
         uint32_t indexCount = pAiMesh->mNumFaces * pAiMesh->mFaces[0].mNumIndices;
-        auto pIB = createIndexBuffer(pAiMesh);
+        std::vector<uint32_t> indices = createIndexBufferData(pAiMesh);
         BoundingBox boundingBox = createMeshBbox(pAiMesh);
 
+        // The vertex buffers are written in the optimized order. An empty order keeps the Assimp order.
+        std::vector<uint32_t> vertexOrder;
+        MeshletData meshlets;
+        if (is_set(mFlags, Model::LoadFlags::OptimizeMeshes) && pAiMesh->mFaces[0].mNumIndices == 3)
+        {
+            MeshOptimizer::Result result = MeshOptimizer::optimize(indices, (const glm::vec3*)pAiMesh->mVertices, vertexCount, MeshOptimizer::Desc());
+            indices = std::move(result.indices);
+            vertexOrder = std::move(result.vertexOrder);
+            meshlets = std::move(result.meshlets);
+            vertexCount = (uint32_t)vertexOrder.size();
+            mCacheStatsBefore.accumulate(result.before);
+            mCacheStatsAfter.accumulate(result.after);
+            mMeshletCount += (uint32_t)meshlets.meshlets.size();
+        }
+        auto pIB = createIndexBuffer(indices);
+
         const bool generateTangentSpace = (pAiMesh->HasTangentsAndBitangents() == false) && (is_set(mFlags, Model::LoadFlags::DontGenerateTangentSpace) == false);
         if (generateTangentSpace)
         {
             genTangentSpace(pAiMesh);
         }
 
-        VertexLayout::SharedPtr pLayout = createVertexLayout(pAiMesh);
+        // Skinned meshes are left alone, the skinning writes float positions. So are emissive meshes, the area lights read float positions on the CPU.
+        const Material* pMeshMaterial = mAiMaterialToFalcor[pAiMesh->mMaterialIndex].get();
+        const bool isEmissive = pMeshMaterial && (EXTRACT_EMISSIVE_TYPE(pMeshMaterial->getFlags()) != ChannelTypeUnused);
+        const bool compressVertices = is_set(mFlags, Model::LoadFlags::CompressVertices) && (pAiMesh->HasBones() == false) && (isEmissive == false);
+        VertexCompression::PositionQuantization quantization;
+        if (compressVertices)
+        {
+            quantization = VertexCompression::computePositionQuantization(boundingBox.getMinPos(), boundingBox.getMaxPos());
+        }
+
+        VertexLayout::SharedPtr pLayout = createVertexLayout(pAiMesh, compressVertices);
         if (pLayout == nullptr)
         {
             assert(0);
@@ -790,14 +843,14 @@ namespace Falcor
         VertexIdsVec ids;
         if (pAiMesh->HasBones())
         {
-            loadBones(pAiMesh, weights, ids, vertexCount, mBoneNameToIdMap);
+            loadBones(pAiMesh, weights, ids, pAiMesh->mNumVertices, mBoneNameToIdMap);
         }
 
         // Create corresponding vertex buffers
         for (uint32_t i = 0; i < pLayout->getBufferCount(); i++)
         {
             const VertexBufferLayout* pVbLayout = pLayout->getBufferLayout(i).get();
-            pVBs[i] = createVertexBuffer(pAiMesh, pVbLayout, (uint8_t*)ids.data(), weights.data());
+            pVBs[i] = createVertexBuffer(pAiMesh, pVbLayout, (uint8_t*)ids.data(), weights.data(), vertexOrder, quantization);
         }
 
         Vao::Topology topology = Vao::Topology::TriangleList;
@@ -821,6 +874,8 @@ namespace Falcor
         assert(pMaterial);
 
         Mesh::SharedPtr pMesh = Mesh::create(pVBs, vertexCount, pIB, indexCount, pLayout, topology, pMaterial, boundingBox, pAiMesh->HasBones());
+        pMesh->setMeshlets(std::move(meshlets));
+        pMesh->setPositionQuantization(quantization);
 
         if (generateTangentSpace)
         {
@@ -831,9 +886,8 @@ namespace Falcor
         return pMesh;
     }
 
-    Buffer::SharedPtr AssimpModelImporter::createIndexBuffer(const aiMesh* pAiMesh)
+    Buffer::SharedPtr AssimpModelImporter::createIndexBuffer(const std::vector<uint32_t>& indices)
     {
-        std::vector<uint32_t> indices = createIndexBufferData(pAiMesh);
         const uint32_t size = (uint32_t)(sizeof(uint32_t) * indices.size());
         Buffer::BindFlags bindFlags = Buffer::BindFlags::Index;
         if (is_set(mFlags, Model::LoadFlags::BuffersAsShaderResource))
@@ -871,7 +925,37 @@ namespace Falcor
         }
     }
 
-    VertexLayout::SharedPtr AssimpModelImporter::createVertexLayout(const aiMesh* pAiMesh)
+    void encodeCompressedElement(const aiMesh* pAiMesh, uint32_t location, uint32_t vertexID, const VertexCompression::PositionQuantization& quantization, uint8_t* pDst)
+    {
+        switch (location)
+        {
+        case VERTEX_POSITION_LOC:
+        {
+            const aiVector3D& p = pAiMesh->mVertices[vertexID];
+            VertexCompression::encodePosition(vec3(p.x, p.y, p.z), quantization, (int16_t*)pDst);
+            break;
+        }
+        case VERTEX_NORMAL_LOC:
+        case VERTEX_BITANGENT_LOC:
+        {
+            const aiVector3D& n = (location == VERTEX_NORMAL_LOC) ? pAiMesh->mNormals[vertexID] : pAiMesh->mBitangents[vertexID];
+            VertexCompression::encodeOctahedral(vec3(n.x, n.y, n.z), (int16_t*)pDst);
+            break;
+        }
+        case VERTEX_TEXCOORD_LOC:
+        {
+            const aiVector3D& uv = pAiMesh->mTextureCoords[0][vertexID];
+            uint16_t* pHalf = (uint16_t*)pDst;
+            pHalf[0] = VertexCompression::encodeHalf(uv.x);
+            pHalf[1] = VertexCompression::encodeHalf(uv.y);
+            break;
+        }
+        default:
+            should_not_get_here();
+        }
+    }
+
+    VertexLayout::SharedPtr AssimpModelImporter::createVertexLayout(const aiMesh* pAiMesh, bool compressVertices)
     {
         static const uint32_t kMaxSupportedUVs = 2;
         // Must have position!!!
@@ -903,7 +987,8 @@ namespace Falcor
             if (isElementUsed(pAiMesh, location))
             {
                 VertexBufferLayout::SharedPtr pVbLayout = VertexBufferLayout::create();
-                pVbLayout->addElement(kLayoutData[location].name, 0, kLayoutData[location].format, 1, location);
+                ResourceFormat format = compressVertices ? getCompressedFormat(location) : kLayoutData[location].format;
+                pVbLayout->addElement(kLayoutData[location].name, 0, format, 1, location);
                 pLayout->addBufferLayout(bufferCount, pVbLayout);
                 bufferCount++;
             }
@@ -912,14 +997,16 @@ namespace Falcor
         return pLayout;
     }
 
-    Buffer::SharedPtr AssimpModelImporter::createVertexBuffer(const aiMesh* pAiMesh, const VertexBufferLayout* pLayout, const uint8_t* pBoneIds, const vec4* pBoneWeights)
+    Buffer::SharedPtr AssimpModelImporter::createVertexBuffer(const aiMesh* pAiMesh, const VertexBufferLayout* pLayout, const uint8_t* pBoneIds, const vec4* pBoneWeights, const std::vector<uint32_t>& vertexOrder, const VertexCompression::PositionQuantization& quantization)
     {
         const uint32_t vertexStride = pLayout->getStride();
-        std::vector<uint8_t> initData(vertexStride * pAiMesh->mNumVertices, 0);
+        const uint32_t vertexCount = vertexOrder.empty() ? pAiMesh->mNumVertices : (uint32_t)vertexOrder.size();
+        std::vector<uint8_t> initData(vertexStride * vertexCount, 0);
 
-        for (uint32_t vertexID = 0; vertexID < pAiMesh->mNumVertices; vertexID++)
+        for (uint32_t dstVertexID = 0; dstVertexID < vertexCount; dstVertexID++)
         {
-            uint8_t* pVertex = &initData[vertexStride * vertexID];
+            uint8_t* pVertex = &initData[vertexStride * dstVertexID];
+            const uint32_t vertexID = vertexOrder.empty() ? dstVertexID : vertexOrder[dstVertexID];
 
             for (uint32_t elementID = 0; elementID < pLayout->getElementCount(); elementID++)
             {
@@ -927,6 +1014,12 @@ namespace Falcor
                 uint32_t location = pLayout->getElementShaderLocation(elementID);
                 uint8_t* pDst = pVertex + offset;
 
+                if (pLayout->getElementFormat(elementID) != kLayoutData[location].format)
+                {
+                    encodeCompressedElement(pAiMesh, location, vertexID, quantization, pDst);
+                    continue;
+                }
+
                 uint8_t* pSrc = nullptr;
                 uint32_t size = 0;
                 switch (location)
@@ -985,6 +1078,6 @@ namespace Falcor
             bindFlags |= Buffer::BindFlags::ShaderResource;
         }
 
-        return Buffer::create(vertexStride * pAiMesh->mNumVertices, bindFlags, Buffer::CpuAccess::None, initData.data());;
+        return Buffer::create(vertexStride * vertexCount, bindFlags, Buffer::CpuAccess::None, initData.data());;
     }
 }
\ No newline at end of file
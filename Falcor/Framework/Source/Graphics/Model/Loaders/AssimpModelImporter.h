@@ -86,9 +86,9 @@ namespace Falcor
         Animation::UniquePtr createAnimation(const aiAnimation* pAiAnim);
 
         Mesh::SharedPtr createMesh(const aiMesh* pAiMesh);
-        VertexLayout::SharedPtr createVertexLayout(const aiMesh* pAiMesh);
-        Buffer::SharedPtr createIndexBuffer(const aiMesh* pAiMesh);
-        Buffer::SharedPtr createVertexBuffer(const aiMesh* pAiMesh, const VertexBufferLayout* pLayout, const uint8_t* pBoneIds, const vec4* pBoneWeights);
+        VertexLayout::SharedPtr createVertexLayout(const aiMesh* pAiMesh, bool compressVertices);
+        Buffer::SharedPtr createIndexBuffer(const std::vector<uint32_t>& indices);
+        Buffer::SharedPtr createVertexBuffer(const aiMesh* pAiMesh, const VertexBufferLayout* pLayout, const uint8_t* pBoneIds, const vec4* pBoneWeights, const std::vector<uint32_t>& vertexOrder, const VertexCompression::PositionQuantization& quantization);
         void loadTextures(const aiMaterial* pAiMaterial, const std::string& folder, Material* pMaterial, bool isObjFile, bool useSrgb);
         Material::SharedPtr createMaterial(const aiMaterial* pAiMaterial, const std::string& folder, bool isObjFile, bool useSrgb);
 
@@ -106,5 +106,10 @@ namespace Falcor
         std::vector<Bone> mBones;
         Model::LoadFlags mFlags;
         std::map<const std::string, Texture::SharedPtr> mTextureCache;
+
+        // Totals of the meshes optimized with Model::LoadFlags::OptimizeMeshes
+        VertexCacheStats mCacheStatsBefore;
+        VertexCacheStats mCacheStatsAfter;
+        uint32_t mMeshletCount = 0;
     };
 }
@@ -0,0 +1,629 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "BakedModelCache.h"
+#include "../Mesh.h"
+#include "Utils/Platform/OS.h"
+#include "Utils/BinaryFileStream.h"
+#include "API/VertexLayout.h"
+#include "API/Buffer.h"
+#include "API/Texture.h"
+#include "API/Device.h"
+#include "Graphics/TextureHelper.h"
+#include "Graphics/Material/Material.h"
+#include <map>
+#include <cstdio>
+#include <algorithm>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kMagic = 0x4B425346;     // 'FSBK'
+        const uint32_t kVersion = 3;
+        const size_t kBlobAlignment = 16;       // Blobs are aligned so the mapping can be handed directly to the upload code
+
+        enum class TextureStorage : uint32_t
+        {
+            Embedded,   ///< All the mip levels are stored in the file
+            File,       ///< Reference to the source file. Used for formats the readback can't handle (compressed formats)
+        };
+
+        const uint32_t kMaterialTextureCount = 7;
+
+        Texture::SharedPtr getMaterialTexture(const Material* pMaterial, uint32_t slot)
+        {
+            switch (slot)
+            {
+            case 0: return pMaterial->getBaseColorTexture();
+            case 1: return pMaterial->getSpecularTexture();
+            case 2: return pMaterial->getEmissiveTexture();
+            case 3: return pMaterial->getNormalMap();
+            case 4: return pMaterial->getOcclusionMap();
+            case 5: return pMaterial->getLightMap();
+            case 6: return pMaterial->getHeightMap();
+            default: should_not_get_here(); return nullptr;
+            }
+        }
+
+        void setMaterialTexture(Material* pMaterial, uint32_t slot, Texture::SharedPtr pTexture)
+        {
+            switch (slot)
+            {
+            case 0: pMaterial->setBaseColorTexture(pTexture); break;
+            case 1: pMaterial->setSpecularTexture(pTexture); break;
+            case 2: pMaterial->setEmissiveTexture(pTexture); break;
+            case 3: pMaterial->setNormalMap(pTexture); break;
+            case 4: pMaterial->setOcclusionMap(pTexture); break;
+            case 5: pMaterial->setLightMap(pTexture); break;
+            case 6: pMaterial->setHeightMap(pTexture); break;
+            default: should_not_get_here();
+            }
+        }
+
+        class Writer
+        {
+        public:
+            Writer(const std::string& filename) : mStream(filename, BinaryFileStream::Mode::Write) {}
+
+            template<typename T>
+            void write(const T& val)
+            {
+                mStream.write(&val, sizeof(T));
+                mOffset += sizeof(T);
+            }
+
+            void writeString(const std::string& str)
+            {
+                write((uint32_t)str.size());
+                mStream.write(str.data(), str.size());
+                mOffset += str.size();
+            }
+
+            void writeBlob(const void* pData, uint64_t size)
+            {
+                write(size);
+                static const uint8_t kZeros[kBlobAlignment] = {};
+                size_t aligned = align_to(kBlobAlignment, mOffset);
+                mStream.write(kZeros, aligned - mOffset);
+                mStream.write(pData, (size_t)size);
+                mOffset = aligned + (size_t)size;
+            }
+
+            bool isGood() { return mStream.isGood(); }
+            void close() { mStream.close(); }
+
+        private:
+            BinaryFileStream mStream;
+            size_t mOffset = 0;
+        };
+
+        class Reader
+        {
+        public:
+            Reader(const void* pData, size_t size) : mpData((const uint8_t*)pData), mSize(size) {}
+
+            template<typename T>
+            T read()
+            {
+                T val = {};
+                if (mFailed || mOffset + sizeof(T) > mSize)
+                {
+                    mFailed = true;
+                    return val;
+                }
+                std::memcpy(&val, mpData + mOffset, sizeof(T));
+                mOffset += sizeof(T);
+                return val;
+            }
+
+            // Reads an element count. Fails if the rest of the file can't hold that many elements of at least minElementSize bytes, so a corrupt count never sizes an allocation.
+            uint32_t readCount(size_t minElementSize)
+            {
+                uint32_t count = read<uint32_t>();
+                if (mFailed || uint64_t(count) * minElementSize > mSize - mOffset)
+                {
+                    mFailed = true;
+                    return 0;
+                }
+                return count;
+            }
+
+            std::string readString()
+            {
+                uint32_t length = read<uint32_t>();
+                if (mFailed || mOffset + length > mSize)
+                {
+                    mFailed = true;
+                    return std::string();
+                }
+                std::string str((const char*)mpData + mOffset, length);
+                mOffset += length;
+                return str;
+            }
+
+            const void* readBlob(uint64_t& size)
+            {
+                size = read<uint64_t>();
+                size_t aligned = align_to(kBlobAlignment, mOffset);
+                if (mFailed || aligned > mSize || size > mSize - aligned)
+                {
+                    mFailed = true;
+                    return nullptr;
+                }
+                mOffset = aligned + (size_t)size;
+                return mpData + aligned;
+            }
+
+            bool hasFailed() const { return mFailed; }
+
+            // Marks the file as corrupt when a value read from it doesn't make sense
+            void fail() { mFailed = true; }
+
+        private:
+            const uint8_t* mpData;
+            size_t mSize;
+            size_t mOffset = 0;
+            bool mFailed = false;
+        };
+
+        std::vector<uint8_t> readBufferData(const Buffer* pBuffer)
+        {
+            RenderContext* pContext = gpDevice->getRenderContext().get();
+            Buffer::SharedPtr pStaging = Buffer::create(pBuffer->getSize(), Resource::BindFlags::None, Buffer::CpuAccess::Read);
+            pContext->copyResource(pStaging.get(), pBuffer);
+            pContext->flush(true);
+
+            const uint8_t* pData = (const uint8_t*)pStaging->map(Buffer::MapType::Read);
+            std::vector<uint8_t> data(pData, pData + pBuffer->getSize());
+            pStaging->unmap();
+            return data;
+        }
+
+        // Returns the data of all the mip levels, tightly packed. Returns an empty vector if the texture can't be embedded.
+        std::vector<uint8_t> readTextureData(const Texture* pTexture)
+        {
+            std::vector<uint8_t> data;
+            if (pTexture->getType() != Resource::Type::Texture2D || pTexture->getArraySize() != 1 || isCompressedFormat(pTexture->getFormat())) return data;
+
+            RenderContext* pContext = gpDevice->getRenderContext().get();
+            uint32_t bytesPerPixel = getFormatBytesPerBlock(pTexture->getFormat());
+            for (uint32_t mip = 0; mip < pTexture->getMipCount(); mip++)
+            {
+                std::vector<uint8_t> mipData = pContext->readTextureSubresource(pTexture, pTexture->getSubresourceIndex(0, mip));
+                if (mipData.size() != size_t(pTexture->getWidth(mip)) * pTexture->getHeight(mip) * bytesPerPixel) return std::vector<uint8_t>();
+                data.insert(data.end(), mipData.begin(), mipData.end());
+            }
+            return data;
+        }
+
+        void writeBoundingBox(Writer& writer, const BoundingBox& box)
+        {
+            writer.write(box.center);
+            writer.write(box.extent);
+        }
+
+        BoundingBox readBoundingBox(Reader& reader)
+        {
+            BoundingBox box;
+            box.center = reader.read<glm::vec3>();
+            box.extent = reader.read<glm::vec3>();
+            return box;
+        }
+
+        void writeMeshlets(Writer& writer, const MeshletData& data)
+        {
+            writer.writeBlob(data.meshlets.data(), data.meshlets.size() * sizeof(Meshlet));
+            writer.writeBlob(data.vertices.data(), data.vertices.size() * sizeof(uint32_t));
+            writer.writeBlob(data.triangles.data(), data.triangles.size());
+        }
+
+        template<typename T>
+        void readVector(Reader& reader, std::vector<T>& vec)
+        {
+            uint64_t size;
+            const T* pData = (const T*)reader.readBlob(size);
+            if (reader.hasFailed() || size % sizeof(T)) return;
+            vec.assign(pData, pData + size / sizeof(T));
+        }
+
+        MeshletData readMeshlets(Reader& reader)
+        {
+            MeshletData data;
+            readVector(reader, data.meshlets);
+            readVector(reader, data.vertices);
+            readVector(reader, data.triangles);
+            return data;
+        }
+
+        bool isValidFormat(ResourceFormat format)
+        {
+            return format != ResourceFormat::Unknown && (uint32_t)format < (uint32_t)ResourceFormat::Count;
+        }
+
+        // The size of the mip chain readTextureData() writes for a texture. Returns 0 if the export can't produce that texture.
+        uint64_t getEmbeddedTextureSize(uint32_t width, uint32_t height, ResourceFormat format, uint32_t mipCount)
+        {
+            if (width == 0 || height == 0 || isValidFormat(format) == false || isCompressedFormat(format)) return 0;
+            if (mipCount == 0 || mipCount > bitScanReverse(std::max(width, height)) + 1) return 0;
+
+            uint64_t size = 0;
+            for (uint32_t mip = 0; mip < mipCount; mip++)
+            {
+                size += uint64_t(std::max(width >> mip, 1u)) * std::max(height >> mip, 1u) * getFormatBytesPerBlock(format);
+            }
+            return size;
+        }
+
+        // The smallest each entry can be in the file, which bounds the counts read from it
+        const size_t kMinTextureSize = sizeof(TextureStorage) + 3 * sizeof(uint32_t);
+        const size_t kMinMaterialSize = 4 * sizeof(uint32_t) + 2 * sizeof(glm::vec4) + sizeof(glm::vec3) + 4 * sizeof(float) + kMaterialTextureCount * sizeof(int32_t);
+        const size_t kMinMeshSize = sizeof(Vao::Topology) + 5 * sizeof(uint32_t) + 2 * sizeof(glm::vec3) + sizeof(Resource::BindFlags) + 4 * sizeof(uint64_t) + sizeof(VertexCompression::PositionQuantization);
+        const size_t kMinVertexBufferSize = sizeof(uint32_t);
+        const size_t kMinVertexElementSize = 4 * sizeof(uint32_t) + sizeof(ResourceFormat);
+    }
+
+    std::string BakedModelCache::getCacheFilename(const std::string& fullpath)
+    {
+        // The hash keeps models with the same name in different folders apart
+        char hash[17];
+        snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)std::hash<std::string>()(canonicalizeFilename(fullpath)));
+        return getExecutableDirectory() + "/BakedModels/" + getFilenameFromPath(fullpath) + "." + hash + ".fbake";
+    }
+
+    bool BakedModelCache::canBake(const Model* pModel)
+    {
+        return pModel->hasBones() == false && pModel->hasAnimations() == false;
+    }
+
+    bool BakedModelCache::exportToFile(const std::string& cacheFilename, const Model* pModel, Model::LoadFlags flags, time_t sourceTime)
+    {
+        if (canBake(pModel) == false) return false;
+
+        // Collect the unique materials and textures
+        std::vector<const Material*> materials;
+        std::map<const Material*, uint32_t> materialIndex;
+        std::vector<const Texture*> textures;
+        std::map<const Texture*, int32_t> textureIndex;
+        for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+        {
+            const Material* pMaterial = pModel->getMesh(meshID)->getMaterial().get();
+            if (materialIndex.find(pMaterial) != materialIndex.end()) continue;
+            materialIndex[pMaterial] = (uint32_t)materials.size();
+            materials.push_back(pMaterial);
+
+            for (uint32_t slot = 0; slot < kMaterialTextureCount; slot++)
+            {
+                const Texture* pTexture = getMaterialTexture(pMaterial, slot).get();
+                if (pTexture && textureIndex.find(pTexture) == textureIndex.end())
+                {
+                    textureIndex[pTexture] = (int32_t)textures.size();
+                    textures.push_back(pTexture);
+                }
+            }
+        }
+
+        // Write into a temporary file and rename it once complete, so an interrupted export never leaves a truncated cache behind
+        std::string directory = getDirectoryFromFile(cacheFilename);
+        if (isDirectoryExists(directory) == false) createDirectory(directory);
+        std::string tempFilename = cacheFilename + ".tmp";
+        Writer writer(tempFilename);
+        if (writer.isGood() == false)
+        {
+            logWarning("Can't create baked model file '" + cacheFilename + "'");
+            return false;
+        }
+
+        writer.write(kMagic);
+        writer.write(kVersion);
+        writer.write((uint32_t)flags);
+        writer.write((int64_t)sourceTime);
+
+        // Textures
+        writer.write((uint32_t)textures.size());
+        for (const Texture* pTexture : textures)
+        {
+            std::vector<uint8_t> data = readTextureData(pTexture);
+            if (data.size())
+            {
+                writer.write(TextureStorage::Embedded);
+                writer.writeString(pTexture->getSourceFilename());
+                writer.write(pTexture->getWidth());
+                writer.write(pTexture->getHeight());
+                writer.write(pTexture->getFormat());
+                writer.write(pTexture->getMipCount());
+                writer.writeBlob(data.data(), data.size());
+            }
+            else
+            {
+                writer.write(TextureStorage::File);
+                writer.writeString(pTexture->getSourceFilename());
+                writer.write((uint32_t)(pTexture->getMipCount() > 1));
+                writer.write((uint32_t)isSrgbFormat(pTexture->getFormat()));
+            }
+        }
+
+        // Materials
+        writer.write((uint32_t)materials.size());
+        for (const Material* pMaterial : materials)
+        {
+            writer.writeString(pMaterial->getName());
+            writer.write(pMaterial->getShadingModel());
+            writer.write(pMaterial->getAlphaMode());
+            writer.write((uint32_t)pMaterial->getDoubleSided());
+            writer.write(pMaterial->getBaseColor());
+            writer.write(pMaterial->getSpecularParams());
+            writer.write(pMaterial->getEmissiveColor());
+            writer.write(pMaterial->getAlphaThreshold());
+            writer.write(pMaterial->getHeightScale());
+            writer.write(pMaterial->getHeightOffset());
+            writer.write(pMaterial->getIndexOfRefraction());
+            for (uint32_t slot = 0; slot < kMaterialTextureCount; slot++)
+            {
+                const Texture* pTexture = getMaterialTexture(pMaterial, slot).get();
+                writer.write(pTexture ? textureIndex[pTexture] : -1);
+            }
+        }
+
+        // Meshes and their instances
+        writer.write(pModel->getMeshCount());
+        for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+        {
+            const Mesh* pMesh = pModel->getMesh(meshID).get();
+            const Vao* pVao = pMesh->getVao().get();
+            const VertexLayout* pLayout = pVao->getVertexLayout().get();
+
+            writer.write(pVao->getPrimitiveTopology());
+            writer.write(pMesh->getVertexCount());
+            writer.write(pMesh->getIndexCount());
+            writer.write(materialIndex[pMesh->getMaterial().get()]);
+            writeBoundingBox(writer, pMesh->getBoundingBox());
+
+            const Buffer* pIB = pVao->getIndexBuffer().get();
+            writer.write(pIB->getBindFlags());
+            std::vector<uint8_t> indices = readBufferData(pIB);
+            writer.writeBlob(indices.data(), indices.size());
+
+            writer.write(pVao->getVertexBuffersCount());
+            for (uint32_t i = 0; i < pVao->getVertexBuffersCount(); i++)
+            {
+                const VertexBufferLayout* pBufferLayout = (i < pLayout->getBufferCount()) ? pLayout->getBufferLayout(i).get() : nullptr;
+                const Buffer* pVB = pVao->getVertexBuffer(i).get();
+                writer.write((uint32_t)(pBufferLayout != nullptr && pVB != nullptr));
+                if (pBufferLayout == nullptr || pVB == nullptr) continue;
+
+                writer.write(pBufferLayout->getInputClass());
+                writer.write(pBufferLayout->getInstanceStepRate());
+                writer.write(pBufferLayout->getElementCount());
+                for (uint32_t e = 0; e < pBufferLayout->getElementCount(); e++)
+                {
+                    writer.writeString(pBufferLayout->getElementName(e));
+                    writer.write(pBufferLayout->getElementOffset(e));
+                    writer.write(pBufferLayout->getElementFormat(e));
+                    writer.write(pBufferLayout->getElementArraySize(e));
+                    writer.write(pBufferLayout->getElementShaderLocation(e));
+                }
+
+                writer.write(pVB->getBindFlags());
+                std::vector<uint8_t> vertices = readBufferData(pVB);
+                writer.writeBlob(vertices.data(), vertices.size());
+            }
+
+            writeMeshlets(writer, pMesh->getMeshlets());
+            writer.write(pMesh->getPositionQuantization());
+
+            writer.write(pModel->getMeshInstanceCount(meshID));
+            for (uint32_t i = 0; i < pModel->getMeshInstanceCount(meshID); i++)
+            {
+                writer.write(pModel->getMeshInstance(meshID, i)->getTransformMatrix());
+            }
+        }
+
+        bool good = writer.isGood();
+        writer.close();
+        std::remove(cacheFilename.c_str());
+        if (good == false || std::rename(tempFilename.c_str(), cacheFilename.c_str()) != 0)
+        {
+            logWarning("Failed to write baked model file '" + cacheFilename + "'");
+            std::remove(tempFilename.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool BakedModelCache::import(Model& model, const std::string& cacheFilename, Model::LoadFlags flags, time_t sourceTime)
+    {
+        if (doesFileExist(cacheFilename) == false) return false;
+
+        size_t fileSize;
+        const void* pFile = mapFileForReading(cacheFilename, fileSize);
+        if (pFile == nullptr) return false;
+
+        Reader reader(pFile, fileSize);
+        bool valid = (reader.read<uint32_t>() == kMagic) && (reader.read<uint32_t>() == kVersion);
+        valid = valid && (reader.read<uint32_t>() == (uint32_t)flags) && (reader.read<int64_t>() == (int64_t)sourceTime);
+        if (valid == false)
+        {
+            unmapFile(pFile, fileSize);
+            return false;
+        }
+
+        // Textures. The embedded data is uploaded directly from the mapping.
+        std::vector<Texture::SharedPtr> textures(reader.readCount(kMinTextureSize));
+        for (auto& pTexture : textures)
+        {
+            TextureStorage storage = reader.read<TextureStorage>();
+            std::string sourceFilename = reader.readString();
+            if (storage == TextureStorage::Embedded)
+            {
+                uint32_t width = reader.read<uint32_t>();
+                uint32_t height = reader.read<uint32_t>();
+                ResourceFormat format = reader.read<ResourceFormat>();
+                uint32_t mipCount = reader.read<uint32_t>();
+                uint64_t size;
+                const void* pData = reader.readBlob(size);
+                if (reader.hasFailed()) break;
+
+                // The description sizes the upload, so it has to match the data
+                uint64_t expectedSize = getEmbeddedTextureSize(width, height, format, mipCount);
+                if (expectedSize == 0 || size != expectedSize)
+                {
+                    reader.fail();
+                    break;
+                }
+                pTexture = Texture::create2D(width, height, format, 1, mipCount, pData);
+            }
+            else
+            {
+                bool generateMips = reader.read<uint32_t>() != 0;
+                bool srgb = reader.read<uint32_t>() != 0;
+                if (reader.hasFailed()) break;
+                pTexture = createTextureFromFile(sourceFilename, generateMips, srgb);
+            }
+            if (pTexture) pTexture->setSourceFilename(sourceFilename);
+        }
+
+        // Materials
+        std::vector<Material::SharedPtr> materials(reader.readCount(kMinMaterialSize));
+        for (auto& pMaterial : materials)
+        {
+            if (reader.hasFailed()) break;
+            pMaterial = Material::create(reader.readString());
+            pMaterial->setShadingModel(reader.read<uint32_t>());
+            pMaterial->setAlphaMode(reader.read<uint32_t>());
+            pMaterial->setDoubleSided(reader.read<uint32_t>() != 0);
+            pMaterial->setBaseColor(reader.read<glm::vec4>());
+            pMaterial->setSpecularParams(reader.read<glm::vec4>());
+            pMaterial->setEmissiveColor(reader.read<glm::vec3>());
+            pMaterial->setAlphaThreshold(reader.read<float>());
+            float heightScale = reader.read<float>();
+            float heightOffset = reader.read<float>();
+            pMaterial->setHeightScaleOffset(heightScale, heightOffset);
+            pMaterial->setIndexOfRefraction(reader.read<float>());
+            for (uint32_t slot = 0; slot < kMaterialTextureCount; slot++)
+            {
+                int32_t index = reader.read<int32_t>();
+                if (index >= 0 && index < (int32_t)textures.size()) setMaterialTexture(pMaterial.get(), slot, textures[index]);
+            }
+        }
+
+        // Meshes. Build everything before touching the model so a corrupt file leaves it empty.
+        struct MeshData
+        {
+            Mesh::SharedPtr pMesh;
+            std::vector<glm::mat4> instances;
+        };
+        std::vector<MeshData> meshes(reader.readCount(kMinMeshSize));
+        for (auto& meshData : meshes)
+        {
+            Vao::Topology topology = reader.read<Vao::Topology>();
+            uint32_t vertexCount = reader.read<uint32_t>();
+            uint32_t indexCount = reader.read<uint32_t>();
+            uint32_t materialID = reader.read<uint32_t>();
+            BoundingBox box = readBoundingBox(reader);
+
+            Resource::BindFlags ibBindFlags = reader.read<Resource::BindFlags>();
+            uint64_t ibSize;
+            const void* pIbData = reader.readBlob(ibSize);
+            if (reader.hasFailed()) break;
+            // Mesh always creates 32-bit indices
+            if (materialID >= materials.size() || ibSize != uint64_t(indexCount) * sizeof(uint32_t))
+            {
+                reader.fail();
+                break;
+            }
+            Buffer::SharedPtr pIB = Buffer::create((size_t)ibSize, ibBindFlags, Buffer::CpuAccess::None, pIbData);
+
+            VertexLayout::SharedPtr pLayout = VertexLayout::create();
+            Vao::BufferVec vertexBuffers(reader.readCount(kMinVertexBufferSize));
+            for (uint32_t i = 0; i < (uint32_t)vertexBuffers.size(); i++)
+            {
+                if (reader.read<uint32_t>() == 0) continue;
+
+                VertexBufferLayout::SharedPtr pBufferLayout = VertexBufferLayout::create();
+                VertexBufferLayout::InputClass inputClass = reader.read<VertexBufferLayout::InputClass>();
+                uint32_t stepRate = reader.read<uint32_t>();
+                pBufferLayout->setInputClass(inputClass, stepRate);
+
+                uint32_t elementCount = reader.readCount(kMinVertexElementSize);
+                for (uint32_t e = 0; e < elementCount && reader.hasFailed() == false; e++)
+                {
+                    std::string name = reader.readString();
+                    uint32_t offset = reader.read<uint32_t>();
+                    ResourceFormat format = reader.read<ResourceFormat>();
+                    uint32_t arraySize = reader.read<uint32_t>();
+                    uint32_t shaderLocation = reader.read<uint32_t>();
+                    if (reader.hasFailed() == false && (isValidFormat(format) == false || arraySize == 0)) reader.fail();
+                    if (reader.hasFailed()) break;
+                    pBufferLayout->addElement(name, offset, format, arraySize, shaderLocation);
+                }
+                pLayout->addBufferLayout(i, pBufferLayout);
+
+                Resource::BindFlags vbBindFlags = reader.read<Resource::BindFlags>();
+                uint64_t vbSize;
+                const void* pVbData = reader.readBlob(vbSize);
+                if (reader.hasFailed()) break;
+                if (inputClass == VertexBufferLayout::InputClass::PerVertexData && vbSize < uint64_t(vertexCount) * pBufferLayout->getStride())
+                {
+                    reader.fail();
+                    break;
+                }
+                vertexBuffers[i] = Buffer::create((size_t)vbSize, vbBindFlags, Buffer::CpuAccess::None, pVbData);
+            }
+
+            MeshletData meshlets = readMeshlets(reader);
+            VertexCompression::PositionQuantization quantization = reader.read<VertexCompression::PositionQuantization>();
+
+            meshData.instances.resize(reader.readCount(sizeof(glm::mat4)));
+            for (auto& transform : meshData.instances) transform = reader.read<glm::mat4>();
+            if (reader.hasFailed()) break;
+
+            meshData.pMesh = Mesh::create(vertexBuffers, vertexCount, pIB, indexCount, pLayout, topology, materials[materialID], box, false);
+            meshData.pMesh->setMeshlets(std::move(meshlets));
+            meshData.pMesh->setPositionQuantization(quantization);
+        }
+
+        // The buffers and textures own copies of the data now
+        unmapFile(pFile, fileSize);
+
+        if (reader.hasFailed())
+        {
+            logWarning("Baked model file '" + cacheFilename + "' is corrupt. Ignoring it.");
+            return false;
+        }
+
+        for (const auto& meshData : meshes)
+        {
+            for (const auto& transform : meshData.instances)
+            {
+                model.addMeshInstance(meshData.pMesh, transform);
+            }
+        }
+        return true;
+    }
+}
@@ -0,0 +1,69 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <string>
+#include "../Model.h"
+
+namespace Falcor
+{
+    /** Memory-mappable cache of imported models.
+        A baked file holds the vertex and index buffers in their final layout, the meshlets, the position quantization of compressed vertices, the materials, the mesh instances and the texture mip chains, so loading it doesn't need to run the importer, generate tangents or decode images.
+        The file is mapped into memory on load and the GPU resources are initialized straight from the mapping.
+        Models with bones or animations are not baked.
+    */
+    class BakedModelCache
+    {
+    public:
+        /** Get the name of the baked file matching a model file. The files are stored in the 'BakedModels' folder next to the executable.
+            \param[in] fullpath Full path of the source model file
+        */
+        static std::string getCacheFilename(const std::string& fullpath);
+
+        /** Check if a model can be baked
+        */
+        static bool canBake(const Model* pModel);
+
+        /** Write a baked file. Reads the buffers and textures back from the GPU.
+            \param[in] cacheFilename The file to write
+            \param[in] pModel The model to bake
+            \param[in] flags The flags the model was imported with
+            \param[in] sourceTime Modification time of the source model file
+            \return true if the file was written
+        */
+        static bool exportToFile(const std::string& cacheFilename, const Model* pModel, Model::LoadFlags flags, time_t sourceTime);
+
+        /** Load a baked file
+            \param[out] model The model to fill
+            \param[in] cacheFilename The baked file
+            \param[in] flags The flags the model is being loaded with. The file is rejected if it was baked with different flags.
+            \param[in] sourceTime Modification time of the source model file. The file is rejected if the source changed since it was baked.
+            \return false if the file doesn't exist, is stale or is invalid. The model is left untouched in that case.
+        */
+        static bool import(Model& model, const std::string& cacheFilename, Model::LoadFlags flags, time_t sourceTime);
+    };
+}
@@ -30,6 +30,7 @@
 #include "BinaryModelSpec.h"
 #include "../Model.h"
 #include "../Mesh.h"
+#include "../MeshOptimizer.h"
 #include "Utils/Platform/OS.h"
 #include "API/VertexLayout.h"
 #include "Data/VertexAttrib.h"
@@ -570,6 +571,10 @@ namespace Falcor
             return false;
         }
 
+        // Totals of the meshes optimized with Model::LoadFlags::OptimizeMeshes
+        VertexCacheStats cacheStatsBefore, cacheStatsAfter;
+        uint32_t meshletCount = 0;
+
         int numTextureSlots;
         int numAttributesType = AttribType_AORadius + 1;
 
@@ -887,6 +892,26 @@ namespace Falcor
                 uint32_t ibSize = 3 * numTriangles * sizeof(uint32_t);
                 mStream.read(&indices[0], ibSize);
 
+                // The vertex buffers are already created, so only the triangles are reordered
+                MeshletData meshlets;
+                if (is_set(flags, Model::LoadFlags::OptimizeMeshes) && numTriangles > 0)
+                {
+                    uint32_t positionStride = pLayout->getBufferLayout(positionBufferIndex)->getStride();
+                    std::vector<glm::vec3> positions(numVertices);
+                    for (uint32_t i = 0; i < (uint32_t)numVertices; i++)
+                    {
+                        positions[i] = *(const glm::vec3*)(buffers[positionBufferIndex].vec.data() + positionStride * i);
+                    }
+
+                    MeshOptimizer::Desc desc;
+                    desc.optimizeVertexFetch = false;
+                    MeshOptimizer::Result result = MeshOptimizer::optimize(indices, positions.data(), (uint32_t)numVertices, desc);
+                    indices = std::move(result.indices);
+                    meshlets = std::move(result.meshlets);
+                    cacheStatsBefore.accumulate(result.before);
+                    cacheStatsAfter.accumulate(result.after);
+                    meshletCount += (uint32_t)meshlets.meshlets.size();
+                }
 
                 Buffer::BindFlags ibBindFlags = Buffer::BindFlags::Index;
                 if (is_set(flags, Model::LoadFlags::BuffersAsShaderResource))
@@ -939,6 +964,7 @@ namespace Falcor
 
                 // create the mesh
                 auto pMesh = Mesh::create(pVBs, numVertices, pIB, numIndices, pLayout, Vao::Topology::TriangleList, pMaterial, box, false);
+                pMesh->setMeshlets(std::move(meshlets));
 
                 if (version >= 6)
                 {
@@ -974,7 +1000,12 @@ namespace Falcor
                 }
             }
         }
-        
+
+        if (cacheStatsBefore.triangleCount > 0)
+        {
+            logInfo("Optimized meshes of " + mModelName + ": ACMR " + std::to_string(cacheStatsBefore.acmr) + " -> " + std::to_string(cacheStatsAfter.acmr) +
+                ", ATVR " + std::to_string(cacheStatsBefore.atvr) + " -> " + std::to_string(cacheStatsAfter.atvr) + ", " + std::to_string(meshletCount) + " meshlets");
+        }
         return true;
     }
 }
@@ -88,6 +88,35 @@ namespace Falcor
         mPrimitiveCount = mIndexCount / VertsPerPrim;
 
         mpVao = Vao::create(topology, pLayout, vertexBuffers, pIndexBuffer, ResourceFormat::R32Uint);
+        mVertexCompressionFlags = pLayout->getVertexCompressionFlags();
+    }
+
+    size_t Mesh::getVertexBufferSize() const
+    {
+        size_t size = 0;
+        for (uint32_t i = 0; i < mpVao->getVertexBuffersCount(); i++)
+        {
+            size += mpVao->getVertexBuffer(i)->getSize();
+        }
+        return size;
+    }
+
+    size_t Mesh::getUncompressedVertexBufferSize() const
+    {
+        // Each compressed element replaces an RGB32Float one
+        size_t size = getVertexBufferSize();
+        static const uint32_t kSavedBytes[] =
+        {
+            12 - getFormatBytesPerBlock(ResourceFormat::RGBA16Snorm),   // VERTEX_COMPRESSED_POSITION
+            12 - getFormatBytesPerBlock(ResourceFormat::RG16Snorm),     // VERTEX_OCT_NORMAL
+            12 - getFormatBytesPerBlock(ResourceFormat::RG16Snorm),     // VERTEX_OCT_BITANGENT
+            12 - getFormatBytesPerBlock(ResourceFormat::RG16Float),     // VERTEX_HALF_TEXCOORD
+        };
+        for (uint32_t bit = 0; bit < arraysize(kSavedBytes); bit++)
+        {
+            if (mVertexCompressionFlags & (1 << bit)) size += (size_t)kSavedBytes[bit] * mVertexCount;
+        }
+        return size;
     }
 
     void Mesh::resetGlobalIdCounter()
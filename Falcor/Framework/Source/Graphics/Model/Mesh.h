@@ -35,6 +35,8 @@
 #include "Utils/AABB.h"
 #include "Graphics/Material/Material.h"
 #include "Graphics/Paths/MovableObject.h"
+#include "MeshOptimizer.h"
+#include "VertexCompression.h"
 
 namespace Falcor
 {
@@ -122,6 +124,34 @@ namespace Falcor
 
         static const uint32_t kMaxBonesPerVertex = 4; ///> Max supported bones per vertex
 
+        /** Get the meshlets. Empty unless the model was loaded with Model::LoadFlags::OptimizeMeshes.
+        */
+        const MeshletData& getMeshlets() const { return mMeshlets; }
+
+        /** Set the meshlets. They must match the index buffer.
+        */
+        void setMeshlets(MeshletData meshlets) { mMeshlets = std::move(meshlets); }
+
+        /** Get the VERTEX_COMPRESSED_POSITION, VERTEX_OCT_NORMAL, VERTEX_OCT_BITANGENT and VERTEX_HALF_TEXCOORD bits of the vertex layout
+        */
+        uint32_t getVertexCompressionFlags() const { return mVertexCompressionFlags; }
+
+        /** Get the scale and offset decoding the positions. Identity unless the positions are compressed.
+        */
+        const VertexCompression::PositionQuantization& getPositionQuantization() const { return mPositionQuantization; }
+
+        /** Set the scale and offset decoding the positions. Must match the data in the vertex buffer.
+        */
+        void setPositionQuantization(const VertexCompression::PositionQuantization& quantization) { mPositionQuantization = quantization; }
+
+        /** Get the size of the vertex buffers in bytes
+        */
+        size_t getVertexBufferSize() const;
+
+        /** Get the size the vertex buffers would have with the uncompressed vertex formats
+        */
+        size_t getUncompressedVertexBufferSize() const;
+
         // TODO: Get mesh ID in file mesh was loaded from (temporary, fix better solution later)
         const uint32_t getLoadId() const { return mLoadId; }
 
@@ -152,5 +182,8 @@ namespace Falcor
         Material::SharedPtr mpMaterial;
         BoundingBox mBoundingBox;
         Vao::SharedPtr mpVao;
+        MeshletData mMeshlets;
+        uint32_t mVertexCompressionFlags = 0;
+        VertexCompression::PositionQuantization mPositionQuantization;
     };
 }
\ No newline at end of file
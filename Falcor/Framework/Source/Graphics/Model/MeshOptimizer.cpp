@@ -0,0 +1,470 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kInvalidIndex = uint32_t(-1);
+
+        // Scoring constants from Forsyth's reference implementation
+        const uint32_t kForsythCacheSize = 32;
+        const float kCacheDecayPower = 1.5f;
+        const float kLastTriScore = 0.75f;
+        const float kValenceBoostScale = 2.0f;
+        const float kValenceBoostPower = 0.5f;
+
+        float forsythVertexScore(int32_t cachePosition, uint32_t remainingTriangles)
+        {
+            if (remainingTriangles == 0) return -1.0f;
+
+            float score = 0;
+            if (cachePosition >= 0)
+            {
+                if (cachePosition < 3)
+                {
+                    // The vertices of the last triangle get a fixed score, so the next triangle doesn't just reuse the same edge
+                    score = kLastTriScore;
+                }
+                else
+                {
+                    const float scaler = 1.0f / (kForsythCacheSize - 3);
+                    score = std::pow(1.0f - (cachePosition - 3) * scaler, kCacheDecayPower);
+                }
+            }
+            // Prefer vertices with few triangles left, to avoid leaving isolated triangles behind
+            score += kValenceBoostScale * std::pow((float)remainingTriangles, -kValenceBoostPower);
+            return score;
+        }
+
+        // FIFO cache simulation using timestamps. A vertex is in the cache if it was loaded less than cacheSize misses ago.
+        class FifoCache
+        {
+        public:
+            FifoCache(uint32_t vertexCount, uint32_t cacheSize) : mTimestamps(vertexCount, 0), mCacheSize(cacheSize), mTime(cacheSize + 1) {}
+
+            // Returns true on a miss
+            bool access(uint32_t vertex)
+            {
+                if (mTime - mTimestamps[vertex] > mCacheSize)
+                {
+                    mTimestamps[vertex] = mTime++;
+                    return true;
+                }
+                return false;
+            }
+
+            uint32_t accessTriangle(const uint32_t* pIndices)
+            {
+                return (access(pIndices[0]) ? 1 : 0) + (access(pIndices[1]) ? 1 : 0) + (access(pIndices[2]) ? 1 : 0);
+            }
+
+            void flush() { mTime += mCacheSize + 1; }
+
+        private:
+            std::vector<uint32_t> mTimestamps;
+            uint32_t mCacheSize;
+            uint32_t mTime;
+        };
+
+        glm::vec3 triangleNormal(const glm::vec3* pPositions, const uint32_t* pIndices)
+        {
+            const glm::vec3& p0 = pPositions[pIndices[0]];
+            return glm::cross(pPositions[pIndices[1]] - p0, pPositions[pIndices[2]] - p0);
+        }
+    }
+
+    void VertexCacheStats::accumulate(const VertexCacheStats& other)
+    {
+        misses += other.misses;
+        triangleCount += other.triangleCount;
+        vertexCount += other.vertexCount;
+        acmr = triangleCount ? float(misses) / float(triangleCount) : 0;
+        atvr = vertexCount ? float(misses) / float(vertexCount) : 0;
+    }
+
+    MeshOptimizer::Result MeshOptimizer::optimize(const std::vector<uint32_t>& indices, const glm::vec3* pPositions, uint32_t vertexCount, const Desc& desc)
+    {
+        assert(indices.size() % 3 == 0);
+        Result result;
+        result.before = analyzeVertexCache(indices, vertexCount, desc.cacheSize);
+
+        std::vector<uint32_t> optimized = optimizeVertexCache(indices, vertexCount);
+        if (desc.overdrawThreshold > 1.0f)
+        {
+            optimized = optimizeOverdraw(optimized, pPositions, vertexCount, desc.cacheSize, desc.overdrawThreshold);
+        }
+        if (desc.optimizeVertexFetch)
+        {
+            result.indices = optimizeVertexFetch(optimized, vertexCount, result.vertexOrder);
+        }
+        else
+        {
+            result.indices = std::move(optimized);
+            result.vertexOrder.resize(vertexCount);
+            for (uint32_t i = 0; i < vertexCount; i++) result.vertexOrder[i] = i;
+        }
+        result.after = analyzeVertexCache(result.indices, (uint32_t)result.vertexOrder.size(), desc.cacheSize);
+
+        if (desc.buildMeshlets)
+        {
+            std::vector<glm::vec3> positions(result.vertexOrder.size());
+            for (size_t i = 0; i < positions.size(); i++) positions[i] = pPositions[result.vertexOrder[i]];
+            result.meshlets = buildMeshlets(result.indices, positions.data(), (uint32_t)positions.size(), desc.maxMeshletVertices, desc.maxMeshletTriangles);
+        }
+        return result;
+    }
+
+    std::vector<uint32_t> MeshOptimizer::optimizeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount)
+    {
+        const uint32_t triangleCount = (uint32_t)indices.size() / 3;
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+
+        // Triangle adjacency, with the emitted triangles swapped to the end of each vertex's range
+        std::vector<uint32_t> liveTriangles(vertexCount, 0);
+        for (uint32_t index : indices) liveTriangles[index]++;
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (uint32_t v = 0; v < vertexCount; v++) adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+        std::vector<uint32_t> adjacency(indices.size());
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (uint32_t i = 0; i < (uint32_t)indices.size(); i++) adjacency[fill[indices[i]]++] = i / 3;
+        }
+
+        std::vector<int32_t> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScores(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++) vertexScores[v] = forsythVertexScore(-1, liveTriangles[v]);
+
+        std::vector<bool> emitted(triangleCount, false);
+
+        std::vector<uint32_t> cache, newCache;
+        cache.reserve(kForsythCacheSize + 3);
+        newCache.reserve(kForsythCacheSize + 3);
+
+        uint32_t bestTriangle = kInvalidIndex;
+        uint32_t cursor = 0;
+        for (uint32_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+        {
+            // Dead end, none of the cached vertices has triangles left. Continue from the next triangle in input order.
+            if (bestTriangle == kInvalidIndex)
+            {
+                while (emitted[cursor]) cursor++;
+                bestTriangle = cursor;
+            }
+
+            const uint32_t* pTriangle = &indices[bestTriangle * 3];
+            emitted[bestTriangle] = true;
+            newCache.clear();
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                uint32_t v = pTriangle[i];
+                result.push_back(v);
+                if (std::find(newCache.begin(), newCache.end(), v) == newCache.end()) newCache.push_back(v);
+
+                // Remove the triangle from the vertex's live range
+                uint32_t* pAdjacency = &adjacency[adjacencyOffsets[v]];
+                uint32_t* pLast = pAdjacency + liveTriangles[v] - 1;
+                *std::find(pAdjacency, pLast + 1, bestTriangle) = *pLast;
+                *pLast = bestTriangle;
+                liveTriangles[v]--;
+            }
+
+            // LRU update. The triangle's vertices move to the front.
+            for (uint32_t v : cache)
+            {
+                if (v != pTriangle[0] && v != pTriangle[1] && v != pTriangle[2]) newCache.push_back(v);
+            }
+
+            for (uint32_t i = 0; i < (uint32_t)newCache.size(); i++)
+            {
+                uint32_t v = newCache[i];
+                cachePosition[v] = (i < kForsythCacheSize) ? (int32_t)i : -1;
+                vertexScores[v] = forsythVertexScore(cachePosition[v], liveTriangles[v]);
+            }
+
+            // Rescore the triangles touching the cache, including the vertices which were just evicted
+            float bestScore = -1;
+            bestTriangle = kInvalidIndex;
+            for (uint32_t v : newCache)
+            {
+                for (uint32_t j = 0; j < liveTriangles[v]; j++)
+                {
+                    uint32_t t = adjacency[adjacencyOffsets[v] + j];
+                    float score = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+                    if (score > bestScore)
+                    {
+                        bestScore = score;
+                        bestTriangle = t;
+                    }
+                }
+            }
+
+            if (newCache.size() > kForsythCacheSize) newCache.resize(kForsythCacheSize);
+            std::swap(cache, newCache);
+        }
+        return result;
+    }
+
+    std::vector<uint32_t> MeshOptimizer::optimizeOverdraw(const std::vector<uint32_t>& indices, const glm::vec3* pPositions, uint32_t vertexCount, uint32_t cacheSize, float threshold)
+    {
+        const uint32_t triangleCount = (uint32_t)indices.size() / 3;
+        if (triangleCount == 0) return indices;
+
+        // Hard boundaries are where the cache-optimized order already starts over, i.e. none of the vertices are cached
+        std::vector<uint32_t> hardBoundaries;
+        {
+            FifoCache cache(vertexCount, cacheSize);
+            for (uint32_t t = 0; t < triangleCount; t++)
+            {
+                if (cache.accessTriangle(&indices[t * 3]) == 3) hardBoundaries.push_back(t);
+            }
+            if (hardBoundaries.empty() || hardBoundaries[0] != 0) hardBoundaries.insert(hardBoundaries.begin(), 0);
+            hardBoundaries.push_back(triangleCount);
+        }
+
+        // Split further wherever the cluster's ACMR is within the threshold of the hard cluster it belongs to.
+        // Starting a cluster flushes the cache, so it can be moved anywhere without affecting the others.
+        std::vector<uint32_t> clusters;
+        FifoCache cache(vertexCount, cacheSize);
+        for (size_t h = 0; h + 1 < hardBoundaries.size(); h++)
+        {
+            uint32_t begin = hardBoundaries[h], end = hardBoundaries[h + 1];
+            cache.flush();
+            uint32_t hardMisses = 0;
+            for (uint32_t t = begin; t < end; t++) hardMisses += cache.accessTriangle(&indices[t * 3]);
+            float targetAcmr = float(hardMisses) / float(end - begin) * threshold;
+
+            cache.flush();
+            uint32_t start = begin;
+            uint32_t misses = 0;
+            clusters.push_back(begin);
+            for (uint32_t t = begin; t < end; t++)
+            {
+                misses += cache.accessTriangle(&indices[t * 3]);
+                if (t + 1 < end && float(misses) / float(t + 1 - start) <= targetAcmr)
+                {
+                    start = t + 1;
+                    misses = 0;
+                    clusters.push_back(start);
+                    cache.flush();
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+
+        // Sort the clusters by how much they face away from the mesh centroid
+        glm::vec3 meshCentroid(0);
+        for (uint32_t index : indices) meshCentroid += pPositions[index];
+        meshCentroid *= 1.0f / float(indices.size());
+
+        const uint32_t clusterCount = (uint32_t)clusters.size() - 1;
+        std::vector<float> sortKeys(clusterCount);
+        for (uint32_t c = 0; c < clusterCount; c++)
+        {
+            glm::vec3 centroid(0), normal(0);
+            float area = 0;
+            for (uint32_t t = clusters[c]; t < clusters[c + 1]; t++)
+            {
+                const uint32_t* pTriangle = &indices[t * 3];
+                glm::vec3 n = triangleNormal(pPositions, pTriangle);
+                float a = glm::length(n);
+                centroid += (pPositions[pTriangle[0]] + pPositions[pTriangle[1]] + pPositions[pTriangle[2]]) * (a / 3.0f);
+                normal += n;
+                area += a;
+            }
+            float normalLength = glm::length(normal);
+            sortKeys[c] = (area > 0 && normalLength > 0) ? glm::dot(centroid * (1.0f / area) - meshCentroid, normal * (1.0f / normalLength)) : 0.0f;
+        }
+
+        std::vector<uint32_t> order(clusterCount);
+        for (uint32_t c = 0; c < clusterCount; c++) order[c] = c;
+        std::stable_sort(order.begin(), order.end(), [&sortKeys](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+        for (uint32_t c : order)
+        {
+            result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+        }
+        return result;
+    }
+
+    std::vector<uint32_t> MeshOptimizer::optimizeVertexFetch(const std::vector<uint32_t>& indices, uint32_t vertexCount, std::vector<uint32_t>& vertexOrder)
+    {
+        std::vector<uint32_t> remap(vertexCount, kInvalidIndex);
+        std::vector<uint32_t> result(indices.size());
+        vertexOrder.clear();
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            uint32_t v = indices[i];
+            if (remap[v] == kInvalidIndex)
+            {
+                remap[v] = (uint32_t)vertexOrder.size();
+                vertexOrder.push_back(v);
+            }
+            result[i] = remap[v];
+        }
+        return result;
+    }
+
+    MeshletData MeshOptimizer::buildMeshlets(const std::vector<uint32_t>& indices, const glm::vec3* pPositions, uint32_t vertexCount, uint32_t maxVertices, uint32_t maxTriangles)
+    {
+        // The local indices are 8 bits
+        assert(maxVertices >= 3 && maxVertices <= 256 && maxTriangles >= 1);
+        MeshletData data;
+        std::vector<uint32_t> localIndex(vertexCount, kInvalidIndex);
+        Meshlet current;
+
+        auto finishMeshlet = [&]()
+        {
+            if (current.triangleCount == 0) return;
+            for (uint32_t i = 0; i < current.vertexCount; i++) localIndex[data.vertices[current.vertexOffset + i]] = kInvalidIndex;
+
+            // Bounding sphere around the box center
+            glm::vec3 boxMin(FLT_MAX), boxMax(-FLT_MAX);
+            for (uint32_t i = 0; i < current.vertexCount; i++)
+            {
+                const glm::vec3& p = pPositions[data.vertices[current.vertexOffset + i]];
+                boxMin = glm::min(boxMin, p);
+                boxMax = glm::max(boxMax, p);
+            }
+            current.center = (boxMin + boxMax) * 0.5f;
+            current.radius = 0;
+            for (uint32_t i = 0; i < current.vertexCount; i++)
+            {
+                current.radius = std::max(current.radius, glm::length(pPositions[data.vertices[current.vertexOffset + i]] - current.center));
+            }
+
+            // Normal cone
+            std::vector<glm::vec3> normals;
+            glm::vec3 axis(0);
+            for (uint32_t t = 0; t < current.triangleCount; t++)
+            {
+                uint32_t triangle[3];
+                for (uint32_t i = 0; i < 3; i++) triangle[i] = data.vertices[current.vertexOffset + data.triangles[current.triangleOffset + t * 3 + i]];
+                glm::vec3 n = triangleNormal(pPositions, triangle);
+                float length = glm::length(n);
+                if (length == 0) continue;
+                normals.push_back(n * (1.0f / length));
+                axis += normals.back();
+            }
+
+            current.coneAxis = glm::vec3(1, 0, 0);
+            current.coneApex = current.center;
+            current.coneCutoff = 1;
+            float axisLength = glm::length(axis);
+            if (axisLength > 0)
+            {
+                axis *= 1.0f / axisLength;
+                float minDot = 1;
+                for (const auto& n : normals) minDot = std::min(minDot, glm::dot(axis, n));
+
+                // Past ~85 degrees the cone is too wide to cull anything useful
+                if (minDot > 0.1f)
+                {
+                    // Move the apex back until it's behind all the triangle planes
+                    float maxT = 0;
+                    for (uint32_t t = 0, n = 0; t < current.triangleCount; t++)
+                    {
+                        uint32_t triangle[3];
+                        for (uint32_t i = 0; i < 3; i++) triangle[i] = data.vertices[current.vertexOffset + data.triangles[current.triangleOffset + t * 3 + i]];
+                        if (glm::length(triangleNormal(pPositions, triangle)) == 0) continue;
+                        const glm::vec3& normal = normals[n++];
+                        maxT = std::max(maxT, glm::dot(current.center - pPositions[triangle[0]], normal) / glm::dot(axis, normal));
+                    }
+                    current.coneAxis = axis;
+                    current.coneApex = current.center - axis * maxT;
+                    current.coneCutoff = std::sqrt(1 - minDot * minDot);
+                }
+            }
+
+            data.meshlets.push_back(current);
+            current = Meshlet();
+            current.vertexOffset = (uint32_t)data.vertices.size();
+            current.triangleOffset = (uint32_t)data.triangles.size();
+        };
+
+        for (size_t t = 0; t < indices.size(); t += 3)
+        {
+            uint32_t newVertices = 0;
+            for (uint32_t i = 0; i < 3; i++) newVertices += (localIndex[indices[t + i]] == kInvalidIndex) ? 1 : 0;
+            if (current.vertexCount + newVertices > maxVertices || current.triangleCount == maxTriangles) finishMeshlet();
+
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                uint32_t v = indices[t + i];
+                if (localIndex[v] == kInvalidIndex)
+                {
+                    localIndex[v] = current.vertexCount++;
+                    data.vertices.push_back(v);
+                }
+                data.triangles.push_back((uint8_t)localIndex[v]);
+            }
+            current.triangleCount++;
+        }
+        finishMeshlet();
+        return data;
+    }
+
+    bool MeshOptimizer::isMeshletBackFacing(const Meshlet& meshlet, const glm::vec3& viewPosition)
+    {
+        glm::vec3 dir = meshlet.coneApex - viewPosition;
+        float length = glm::length(dir);
+        return length > 0 && glm::dot(dir, meshlet.coneAxis) > meshlet.coneCutoff * length;
+    }
+
+    VertexCacheStats MeshOptimizer::analyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize)
+    {
+        VertexCacheStats stats;
+        if (indices.empty()) return stats;
+
+        FifoCache cache(vertexCount, cacheSize);
+        std::vector<bool> used(vertexCount, false);
+        uint32_t uniqueCount = 0;
+        for (uint32_t index : indices)
+        {
+            stats.misses += cache.access(index) ? 1 : 0;
+            if (used[index] == false)
+            {
+                used[index] = true;
+                uniqueCount++;
+            }
+        }
+        stats.triangleCount = (uint32_t)indices.size() / 3;
+        stats.vertexCount = uniqueCount;
+        stats.acmr = float(stats.misses) / float(stats.triangleCount);
+        stats.atvr = float(stats.misses) / float(uniqueCount);
+        return stats;
+    }
+}
@@ -0,0 +1,133 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include "glm/vec3.hpp"
+
+namespace Falcor
+{
+    /** A cluster of up to a few dozen triangles with culling bounds
+    */
+    struct Meshlet
+    {
+        uint32_t vertexOffset = 0;      ///< First entry in MeshletData::vertices
+        uint32_t triangleOffset = 0;    ///< First entry in MeshletData::triangles. 3 entries per triangle.
+        uint32_t vertexCount = 0;
+        uint32_t triangleCount = 0;
+        glm::vec3 center;               ///< Bounding sphere
+        float radius = 0;
+        glm::vec3 coneApex;             ///< Normal cone. See MeshOptimizer::isMeshletBackFacing().
+        glm::vec3 coneAxis;
+        float coneCutoff = 1;           ///< 1 if the normals spread too much for the meshlet to be culled
+    };
+
+    struct MeshletData
+    {
+        std::vector<Meshlet> meshlets;
+        std::vector<uint32_t> vertices;     ///< Indices into the mesh vertex buffer
+        std::vector<uint8_t> triangles;     ///< Indices into the meshlet's range of 'vertices'
+    };
+
+    /** Post-transform vertex cache statistics, measured by simulating a FIFO cache
+    */
+    struct VertexCacheStats
+    {
+        uint32_t misses = 0;
+        uint32_t triangleCount = 0;
+        uint32_t vertexCount = 0;   ///< Number of unique vertices referenced
+        float acmr = 0;             ///< Average cache miss ratio: vertex shader invocations per triangle. 0.5 is the best case for a regular grid, 3 the worst.
+        float atvr = 0;             ///< Average transformed vertex ratio: vertex shader invocations per unique vertex. 1 is optimal.
+
+        /** Add the counts of another mesh and update the ratios
+        */
+        void accumulate(const VertexCacheStats& other);
+    };
+
+    /** CPU optimization of triangle list meshes, run by the model importers when Model::LoadFlags::OptimizeMeshes is set.
+        The stages are meant to run in order: vertex cache, overdraw, vertex fetch, then meshlets. optimize() runs all of them.
+    */
+    class MeshOptimizer
+    {
+    public:
+        struct Desc
+        {
+            uint32_t cacheSize = 16;            ///< FIFO size used by the overdraw pass and the statistics. The vertex cache pass targets LRU caches and doesn't depend on it.
+            float overdrawThreshold = 1.05f;    ///< How much the overdraw pass can increase the ACMR. 1 disables it.
+            bool optimizeVertexFetch = true;    ///< Reorder the vertices. Disable it if the vertex buffers can't be changed. Result::vertexOrder is the identity then.
+            bool buildMeshlets = true;
+            uint32_t maxMeshletVertices = 64;
+            uint32_t maxMeshletTriangles = 124;
+        };
+
+        struct Result
+        {
+            std::vector<uint32_t> indices;      ///< The optimized index buffer, indexing the reordered vertices
+            std::vector<uint32_t> vertexOrder;  ///< For each new vertex, the index of the source vertex. Unused vertices are removed.
+            MeshletData meshlets;
+            VertexCacheStats before;
+            VertexCacheStats after;
+        };
+
+        /** Run all the stages
+            \param[in] indices Triangle list
+            \param[in] pPositions The vertex positions, used by the overdraw pass and for the meshlet bounds
+            \param[in] vertexCount The number of vertices
+        */
+        static Result optimize(const std::vector<uint32_t>& indices, const glm::vec3* pPositions, uint32_t vertexCount, const Desc& desc);
+
+        /** Reorder the triangles for the post-transform vertex cache, using Tom Forsyth's linear-speed algorithm
+        */
+        static std::vector<uint32_t> optimizeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+        /** Reorder clusters of triangles so the ones facing away from the mesh center are drawn first, as they are likely to occlude the rest.
+            The input should be optimized for the vertex cache. The clusters are split so the ACMR grows by at most 'threshold'.
+            Based on "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" [Sander et al. 2007].
+        */
+        static std::vector<uint32_t> optimizeOverdraw(const std::vector<uint32_t>& indices, const glm::vec3* pPositions, uint32_t vertexCount, uint32_t cacheSize, float threshold);
+
+        /** Order the vertices by first use
+            \param[in] indices Triangle list
+            \param[in] vertexCount The number of vertices
+            \param[out] vertexOrder For each new vertex, the index of the source vertex. Unused vertices are dropped.
+            \return The index buffer remapped to the new vertex order
+        */
+        static std::vector<uint32_t> optimizeVertexFetch(const std::vector<uint32_t>& indices, uint32_t vertexCount, std::vector<uint32_t>& vertexOrder);
+
+        /** Split a triangle list into meshlets. Triangles are taken in order, so the input should be optimized for the vertex cache.
+        */
+        static MeshletData buildMeshlets(const std::vector<uint32_t>& indices, const glm::vec3* pPositions, uint32_t vertexCount, uint32_t maxVertices, uint32_t maxTriangles);
+
+        /** Check if all the triangles of a meshlet are facing away from a position
+        */
+        static bool isMeshletBackFacing(const Meshlet& meshlet, const glm::vec3& viewPosition);
+
+        /** Simulate a FIFO post-transform cache
+        */
+        static VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize);
+    };
+}
@@ -30,6 +30,9 @@
 #include "Loaders/AssimpModelImporter.h"
 #include "Loaders/BinaryModelImporter.h"
 #include "Loaders/BinaryModelExporter.h"
+#include "Loaders/BakedModelCache.h"
+#include "Utils/CpuTimer.h"
+#include "Utils/ParallelFor.h"
 #include "Utils/Platform/OS.h"
 #include "Mesh.h"
 #include "AnimationController.h"
@@ -86,6 +89,35 @@ namespace Falcor
 
     Model::~Model() = default;
 
+    static bool importWithBakedCache(Model& model, const char* filename, Model::LoadFlags flags)
+    {
+        std::string fullpath;
+        if (is_set(flags, Model::LoadFlags::DontUseBakedCache) || findFileInDataDirectories(filename, fullpath) == false)
+        {
+            return AssimpModelImporter::import(model, filename, flags);
+        }
+
+        CpuTimer timer;
+        timer.update();
+        time_t sourceTime = getFileModifiedTime(fullpath);
+        std::string cacheFilename = BakedModelCache::getCacheFilename(fullpath);
+        bool baked = BakedModelCache::import(model, cacheFilename, flags, sourceTime);
+        bool res = baked || AssimpModelImporter::import(model, filename, flags);
+        if (res && !baked && BakedModelCache::canBake(&model))
+        {
+            BakedModelCache::exportToFile(cacheFilename, &model, flags, sourceTime);
+        }
+        timer.update();
+
+        if (res)
+        {
+            std::string msg = std::string(baked ? "Loaded baked model" : "Imported model") + " '" + filename + "' in " + std::to_string(timer.getElapsedTime()) + " seconds. ";
+            msg += "Peak memory usage " + std::to_string(getProcessPeakUsedPhysicalMemory() / (1024 * 1024)) + " MB";
+            logInfo(msg);
+        }
+        return res;
+    }
+
     Model::SharedPtr Model::createFromFile(const char* filename, LoadFlags flags)
     {
         SharedPtr pModel = SharedPtr(new Model());
@@ -96,7 +128,7 @@ namespace Falcor
         }
         else
         {
-            res = AssimpModelImporter::import(*pModel, filename, flags);
+            res = importWithBakedCache(*pModel, filename, flags);
         }
 
         if(res)
@@ -235,6 +267,31 @@ namespace Falcor
         return changed;
     }
 
+    bool Model::animateModels(const std::vector<Model*>& models, double currentTime)
+    {
+        std::vector<Model*> animated;
+        std::set<Model*> unique;
+        for (Model* pModel : models)
+        {
+            if (pModel->mpAnimationController && unique.insert(pModel).second) animated.push_back(pModel);
+        }
+
+        // The controllers are independent. The update is kept on the calling thread since it touches GPU resources.
+        parallelFor((uint32_t)animated.size(), 1, [&animated, currentTime](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; i++)
+            {
+                animated[i]->mpAnimationController->animate(currentTime);
+            }
+        });
+
+        for (Model* pModel : animated)
+        {
+            pModel->update();
+        }
+        return animated.empty() == false;
+    }
+
     bool Model::hasAnimations() const
     {
         return (getAnimationsCount() != 0);
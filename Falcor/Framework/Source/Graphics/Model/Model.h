@@ -67,6 +67,9 @@ namespace Falcor
             BuffersAsShaderResource     = 0x10,   ///< Generate the VBs and IB with the shader-resource-view bind flag
             RemoveInstancing            = 0x20,   ///< Flatten mesh instances
             UseSpecGlossMaterials       = 0x40,   ///< Set materials to use Spec-Gloss shading model. Otherwise default is Metal-Rough.
+            DontUseBakedCache           = 0x80,   ///< Always import from the source file. Otherwise imported models are baked into a memory-mappable cache which is used by later loads.
+            OptimizeMeshes              = 0x100,  ///< Reorder the triangles and vertices for the post-transform cache, vertex fetch and overdraw, and build meshlets. See MeshOptimizer.
+            CompressVertices            = 0x200,  ///< Store positions as 16-bit normalized relative to the mesh bounds, normals and bitangents as octahedral 16-bit, and texture coordinates as half. Skinned and emissive meshes are not compressed. See VertexCompression.
         };
 
         /** Create a new model from file
@@ -166,6 +169,13 @@ namespace Falcor
         */
         bool animate(double currentTime);
 
+        /** Animate a group of models. The animations are evaluated in parallel, the GPU resources are updated serially afterwards.
+            \param[in] models The models to animate. Duplicates are animated once.
+            \param[in] currentTime The current global time
+            \return true if any of the models has changed
+        */
+        static bool animateModels(const std::vector<Model*>& models, double currentTime);
+
         /** Get the animation name from animation ID.
         */
         const std::string& getAnimationName(uint32_t animationID) const;
@@ -303,6 +313,9 @@ namespace Falcor
             flag_str(BuffersAsShaderResource);
             flag_str(RemoveInstancing);            
             flag_str(UseSpecGlossMaterials);
+            flag_str(DontUseBakedCache);
+            flag_str(OptimizeMeshes);
+            flag_str(CompressVertices);
         default:
             should_not_get_here();
             return "";
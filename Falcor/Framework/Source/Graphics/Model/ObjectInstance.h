@@ -126,6 +126,7 @@ namespace Falcor
 
             mBase.translation = translation;
             mBase.matrixDirty = true;
+            markTransformChanged();
         };
 
         /** Gets the position/translation of the instance
@@ -136,7 +137,7 @@ namespace Falcor
         /** Sets scale of the instance
             \param[in] scaling Instance scale
         */
-        void setScaling(const glm::vec3& scaling) { mBase.scale = scaling; mBase.matrixDirty = true; }
+        void setScaling(const glm::vec3& scaling) { mBase.scale = scaling; mBase.matrixDirty = true; markTransformChanged(); }
 
         /** Gets scale of the instance
             \return Scale of the instance
@@ -156,6 +157,7 @@ namespace Falcor
             mBase.target = mBase.translation + rotMtx[2]; // position + forward
 
             mBase.matrixDirty = true;
+            markTransformChanged();
         }
 
         /** Gets rotation for the instance
@@ -173,11 +175,11 @@ namespace Falcor
 
         /** Sets the up vector orientation
         */
-        void setUpVector(const glm::vec3& up) { mBase.up = glm::normalize(up); mBase.matrixDirty = true; }
+        void setUpVector(const glm::vec3& up) { mBase.up = glm::normalize(up); mBase.matrixDirty = true; markTransformChanged(); }
 
         /** Sets the look-at target
         */
-        void setTarget(const glm::vec3& target) { mBase.target = target; mBase.matrixDirty = true; }
+        void setTarget(const glm::vec3& target) { mBase.target = target; mBase.matrixDirty = true; markTransformChanged(); }
 
         /** Gets the up vector of the instance
             \return Up vector
@@ -222,6 +224,7 @@ namespace Falcor
             mMovable.up = up;
             mMovable.scale = glm::vec3(1.0f);
             mMovable.matrixDirty = true;
+            markTransformChanged();
         }
 
         SharedPtr shared_from_this()
@@ -0,0 +1,163 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "VertexCompression.h"
+#include <cmath>
+#include <cstring>
+
+namespace Falcor
+{
+    // The quantization step of the octahedral coordinates is 2/65534. Near the octahedron edges, a step covers up to ~1.5x more angle than at the center.
+    const float VertexCompression::kOctahedralErrorBound = 1e-4f;
+    const float VertexCompression::kHalfRelativeErrorBound = 1.0f / 2048.0f;
+
+    VertexCompression::PositionQuantization VertexCompression::computePositionQuantization(const glm::vec3& boxMin, const glm::vec3& boxMax)
+    {
+        PositionQuantization quantization;
+        quantization.offset = (boxMin + boxMax) * 0.5f;
+        quantization.scale = (boxMax - boxMin) * 0.5f;
+
+        // Flat boxes still need a valid scale
+        for (int i = 0; i < 3; i++)
+        {
+            if (quantization.scale[i] <= 0) quantization.scale[i] = 1;
+        }
+        return quantization;
+    }
+
+    int16_t VertexCompression::encodeSnorm16(float value)
+    {
+        value = std::min(std::max(value, -1.0f), 1.0f);
+        return (int16_t)std::lround(value * 32767.0f);
+    }
+
+    void VertexCompression::encodePosition(const glm::vec3& position, const PositionQuantization& quantization, int16_t encoded[4])
+    {
+        for (int i = 0; i < 3; i++) encoded[i] = encodeSnorm16((position[i] - quantization.offset[i]) / quantization.scale[i]);
+        encoded[3] = 32767;
+    }
+
+    glm::vec3 VertexCompression::decodePosition(const int16_t encoded[4], const PositionQuantization& quantization)
+    {
+        glm::vec3 position;
+        for (int i = 0; i < 3; i++) position[i] = decodeSnorm16(encoded[i]) * quantization.scale[i] + quantization.offset[i];
+        return position;
+    }
+
+    glm::vec3 VertexCompression::getPositionErrorBound(const PositionQuantization& quantization)
+    {
+        // Half a quantization step, plus a couple of float ulps at the largest decoded magnitude for the decode math
+        glm::vec3 magnitude = glm::abs(quantization.offset) + quantization.scale;
+        return quantization.scale * (0.5f / 32767.0f) + magnitude * (2.0f / 8388608.0f);
+    }
+
+    void VertexCompression::encodeOctahedral(const glm::vec3& dir, int16_t encoded[2])
+    {
+        float l1 = std::abs(dir.x) + std::abs(dir.y) + std::abs(dir.z);
+        if (l1 == 0)
+        {
+            encoded[0] = encoded[1] = 0;
+            return;
+        }
+        float u = dir.x / l1, v = dir.y / l1;
+        if (dir.z < 0)
+        {
+            // Fold the lower hemisphere over the diagonals
+            float foldedU = (1 - std::abs(v)) * (u >= 0 ? 1.0f : -1.0f);
+            float foldedV = (1 - std::abs(u)) * (v >= 0 ? 1.0f : -1.0f);
+            u = foldedU;
+            v = foldedV;
+        }
+        encoded[0] = encodeSnorm16(u);
+        encoded[1] = encodeSnorm16(v);
+    }
+
+    glm::vec3 VertexCompression::decodeOctahedral(const int16_t encoded[2])
+    {
+        // Same as decodeOctahedral() in ShaderCommon.slang
+        glm::vec3 n(decodeSnorm16(encoded[0]), decodeSnorm16(encoded[1]), 0);
+        n.z = 1 - std::abs(n.x) - std::abs(n.y);
+        float t = std::max(-n.z, 0.0f);
+        n.x += (n.x >= 0) ? -t : t;
+        n.y += (n.y >= 0) ? -t : t;
+        return glm::normalize(n);
+    }
+
+    uint16_t VertexCompression::encodeHalf(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        uint32_t sign = (bits >> 16) & 0x8000;
+        uint32_t absBits = bits & 0x7FFFFFFF;
+
+        if (absBits > 0x7F800000) return (uint16_t)(sign | 0x7E00);    // NaN
+        if (absBits >= 0x477FF000) return (uint16_t)(sign | 0x7BFF);   // Rounds to more than 65504, clamp
+
+        if (absBits < 0x38800000)
+        {
+            // Denormal half. Align the mantissa so the shift rounds it, the +0.5 ulp bias below takes care of ties.
+            if (absBits < 0x33000000) return (uint16_t)sign;
+            uint32_t exponent = absBits >> 23;
+            uint32_t mantissa = (absBits & 0x7FFFFF) | 0x800000;
+            uint32_t shift = 126 - exponent;
+            uint32_t halfMantissa = mantissa >> shift;
+            uint32_t remainder = mantissa & ((1u << shift) - 1);
+            uint32_t halfway = 1u << (shift - 1);
+            if (remainder > halfway || (remainder == halfway && (halfMantissa & 1))) halfMantissa++;
+            return (uint16_t)(sign | halfMantissa);
+        }
+
+        // Normal half: rebias the exponent and round the mantissa to nearest even
+        uint32_t rounded = absBits + 0xFFF + ((absBits >> 13) & 1);
+        return (uint16_t)(sign | ((rounded - 0x38000000) >> 13));
+    }
+
+    float VertexCompression::decodeHalf(uint16_t value)
+    {
+        uint32_t sign = uint32_t(value & 0x8000) << 16;
+        uint32_t exponent = (value >> 10) & 0x1F;
+        uint32_t mantissa = value & 0x3FF;
+        uint32_t bits;
+        if (exponent == 0x1F)
+        {
+            bits = sign | 0x7F800000 | (mantissa << 13);
+        }
+        else if (exponent == 0)
+        {
+            float f = std::ldexp((float)mantissa, -24);
+            return sign ? -f : f;
+        }
+        else
+        {
+            bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+        }
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+}
@@ -0,0 +1,80 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "glm/vec3.hpp"
+#include "glm/vec2.hpp"
+
+namespace Falcor
+{
+    /** CPU codec for the compressed vertex formats used with Model::LoadFlags::CompressVertices. The shader decode is in ShaderCommon.slang.
+        - Positions are RGBA16Snorm, relative to the mesh bounding box. Decoded with the per-mesh scale and offset: p = q * scale + offset. W is always 1.
+        - Normals and bitangents are RG16Snorm, octahedral encoded.
+        - Texture coordinates are RG16Float.
+    */
+    class VertexCompression
+    {
+    public:
+        struct PositionQuantization
+        {
+            glm::vec3 scale = glm::vec3(1);
+            glm::vec3 offset = glm::vec3(0);
+        };
+
+        /** Get the quantization covering a bounding box
+        */
+        static PositionQuantization computePositionQuantization(const glm::vec3& boxMin, const glm::vec3& boxMax);
+
+        static void encodePosition(const glm::vec3& position, const PositionQuantization& quantization, int16_t encoded[4]);
+        static glm::vec3 decodePosition(const int16_t encoded[4], const PositionQuantization& quantization);
+
+        /** Get the largest per-axis error of a position inside the quantized box
+        */
+        static glm::vec3 getPositionErrorBound(const PositionQuantization& quantization);
+
+        /** Octahedral encoding of a unit vector. The input doesn't have to be normalized, the decoded vector is.
+        */
+        static void encodeOctahedral(const glm::vec3& dir, int16_t encoded[2]);
+        static glm::vec3 decodeOctahedral(const int16_t encoded[2]);
+
+        /** Largest angle between a unit vector and its decoded octahedral encoding, in radians
+        */
+        static const float kOctahedralErrorBound;
+
+        /** IEEE half precision, with round to nearest even. Values outside the half range are clamped to the largest finite half.
+        */
+        static uint16_t encodeHalf(float value);
+        static float decodeHalf(uint16_t value);
+
+        /** Largest relative error of encodeHalf() for values in the normal half range
+        */
+        static const float kHalfRelativeErrorBound;
+
+        static float decodeSnorm16(int16_t value) { return value < -32767 ? -1.0f : value / 32767.0f; }
+        static int16_t encodeSnorm16(float value);
+    };
+}
@@ -41,9 +41,17 @@ namespace Falcor
         virtual void move(const glm::vec3& position, const glm::vec3& target, const glm::vec3& up) = 0;
         const ObjectPath* getAttachedPath() const { return mpPath; }
 
+        /** Get a counter which is incremented every time the object's transform changes. Used to track per-object updates without polling matrices.
+        */
+        uint32_t getTransformVersion() const { return mTransformVersion; }
+
+    protected:
+        void markTransformChanged() { mTransformVersion++; }
+
     private:
         friend class ObjectPath;
         void attachPath(const ObjectPath* pPath) { mpPath = pPath; }
         const ObjectPath* mpPath = nullptr;
+        uint32_t mTransformVersion = 0;
     };
 }
\ No newline at end of file
@@ -39,4 +39,11 @@ namespace Falcor
         pProg->init(d, programDefines);
         return pProg;
     }
-}
\ No newline at end of file
+
+    ComputeProgram::SharedPtr ComputeProgram::create(const Desc& desc, const DefineList& programDefines)
+    {
+        SharedPtr pProg = SharedPtr(new ComputeProgram);
+        pProg->init(desc, programDefines);
+        return pProg;
+    }
+}
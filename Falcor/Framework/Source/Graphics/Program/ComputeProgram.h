@@ -47,6 +47,13 @@ namespace Falcor
             Note that this call merely creates a program object. The actual compilation and link happens when calling Program#getActiveVersion().
         */
         static SharedPtr createFromFile(const std::string& filename, const std::string& csEntry, const DefineList& programDefines = DefineList(), Shader::CompilerFlags flags = Shader::CompilerFlags::None);
+
+        /** Create a new program object.
+            \param[in] desc Description of the source file and entry point to use. Use this version to select a shader model.
+            \param[in] programDefines A list of macro definitions to set into the shader
+            \return A new object, or nullptr if creation failed.
+        */
+        static SharedPtr create(const Desc& desc, const DefineList& programDefines = DefineList());
     private:
         ComputeProgram() = default;
     };
@@ -642,68 +642,124 @@ namespace Falcor
             }
         }
 
-        // Allocate the missing sets
+        // Allocate the missing sets. A set with the same layout and views as a recently filled one reuses it.
+        const DescriptorPool::SharedPtr& pPool = gpDevice->getGpuDescriptorPool();
+        DescriptorTableKey key;
+        std::vector<std::shared_ptr<const void>> views;
         for (uint32_t i = 0; i < mRootSets.size(); i++)
         {
             mRootSets[i].dirty = (mRootSets[i].pSet == nullptr);
             if (mRootSets[i].pSet == nullptr)
             {
-                DescriptorSet::Layout layout;
+                getRootSetKey(i, key, views);
+                mRootSets[i].pSet = pPool->findCachedSet(key);
+                if (mRootSets[i].pSet) continue;
+
                 const auto& set = mpReflector->getDescriptorSetLayouts()[i];
-                mRootSets[i].pSet = DescriptorSet::create(gpDevice->getGpuDescriptorPool(), set);
-                if (mRootSets[i].pSet == nullptr)
+                mRootSets[i].pSet = DescriptorSet::create(pPool, set);
+                if (mRootSets[i].pSet == nullptr || writeRootSet(i) == false)
                 {
                     return false;
                 }
+                pPool->addCachedSet(key, mRootSets[i].pSet, std::move(views));
             }
         }
+        return true;
+    }
 
-        // bind the resources
-        for (uint32_t s = 0; s < mAssignedResources.size(); s++)
+    void ParameterBlock::getRootSetKey(uint32_t s, DescriptorTableKey& key, std::vector<std::shared_ptr<const void>>& views) const
+    {
+        key.clear();
+        views.clear();
+
+        const auto& layout = mpReflector->getDescriptorSetLayouts()[s];
+        key.add(uint64_t(layout.getVisibility()));
+        for (size_t r = 0; r < layout.getRangeCount(); r++)
         {
-            if (mRootSets[s].dirty == false) continue;
-            const auto& pDescSet = mRootSets[s].pSet;
+            const auto& range = layout.getRange(r);
+            key.add((uint64_t(range.type) << 32) | range.descCount);
+            key.add((uint64_t(range.regSpace) << 32) | range.baseRegIndex);
+        }
 
-            const auto& set = mAssignedResources[s];
-            for (uint32_t r = 0 ; r < set.size() ; r++)
+        // The views are immutable, so their addresses identify the descriptors copied into the set
+        for (const auto& range : mAssignedResources[s])
+        {
+            for (const auto& desc : range)
             {
-                const auto& range = set[r];
-                for (uint32_t d = 0; d < range.size(); d++)
+                std::shared_ptr<const void> pView;
+                switch (desc.type)
                 {
-                    const auto& desc = range[d];
-                    switch (desc.type)
-                    {
-                    case DescriptorSet::Type::Cbv:
-                    {
-                        ConstantBuffer* pCB = dynamic_cast<ConstantBuffer*>(desc.pResource.get());
-                        ConstantBufferView::SharedPtr pView = pCB ? pCB->getCbv() : ConstantBufferView::getNullView();
-                        pDescSet->setCbv(r, d, pView);
-                    }
+                case DescriptorSet::Type::Cbv:
+                {
+                    ConstantBuffer* pCB = dynamic_cast<ConstantBuffer*>(desc.pResource.get());
+                    pView = pCB ? pCB->getCbv() : ConstantBufferView::getNullView();
+                }
+                break;
+                case DescriptorSet::Type::Sampler:
+                    pView = desc.pSampler;
                     break;
-                    case DescriptorSet::Type::Sampler:
-                        assert(desc.pSampler);
-                        pDescSet->setSampler(r, d, desc.pSampler.get());
-                        break;
-                    case DescriptorSet::Type::StructuredBufferSrv:
-                    case DescriptorSet::Type::TypedBufferSrv:
-                    case DescriptorSet::Type::TextureSrv:
-                        assert(desc.pSRV);
-                        pDescSet->setSrv(r, d, desc.pSRV.get());
-                        break;
-                    case DescriptorSet::Type::StructuredBufferUav:
-                    case DescriptorSet::Type::TypedBufferUav:
-                    case DescriptorSet::Type::TextureUav:
-                        assert(desc.pUAV);
-                        pDescSet->setUav(r, d, desc.pUAV.get());
-                        break;
+                case DescriptorSet::Type::StructuredBufferSrv:
+                case DescriptorSet::Type::TypedBufferSrv:
+                case DescriptorSet::Type::TextureSrv:
+                    pView = desc.pSRV;
+                    break;
+                case DescriptorSet::Type::StructuredBufferUav:
+                case DescriptorSet::Type::TypedBufferUav:
+                case DescriptorSet::Type::TextureUav:
+                    pView = desc.pUAV;
+                    break;
+                default:
+                    should_not_get_here();
+                }
+                key.add(uint64_t(desc.type));
+                key.add(pView.get());
+                views.push_back(std::move(pView));
+            }
+        }
+    }
 
-                    default:
-                        should_not_get_here();
-                        return false;
-                    }
+    bool ParameterBlock::writeRootSet(uint32_t s)
+    {
+        const auto& pDescSet = mRootSets[s].pSet;
+        const auto& set = mAssignedResources[s];
+        for (uint32_t r = 0 ; r < set.size() ; r++)
+        {
+            const auto& range = set[r];
+            for (uint32_t d = 0; d < range.size(); d++)
+            {
+                const auto& desc = range[d];
+                switch (desc.type)
+                {
+                case DescriptorSet::Type::Cbv:
+                {
+                    ConstantBuffer* pCB = dynamic_cast<ConstantBuffer*>(desc.pResource.get());
+                    ConstantBufferView::SharedPtr pView = pCB ? pCB->getCbv() : ConstantBufferView::getNullView();
+                    pDescSet->setCbv(r, d, pView);
+                }
+                break;
+                case DescriptorSet::Type::Sampler:
+                    assert(desc.pSampler);
+                    pDescSet->setSampler(r, d, desc.pSampler.get());
+                    break;
+                case DescriptorSet::Type::StructuredBufferSrv:
+                case DescriptorSet::Type::TypedBufferSrv:
+                case DescriptorSet::Type::TextureSrv:
+                    assert(desc.pSRV);
+                    pDescSet->setSrv(r, d, desc.pSRV.get());
+                    break;
+                case DescriptorSet::Type::StructuredBufferUav:
+                case DescriptorSet::Type::TypedBufferUav:
+                case DescriptorSet::Type::TextureUav:
+                    assert(desc.pUAV);
+                    pDescSet->setUav(r, d, desc.pUAV.get());
+                    break;
+
+                default:
+                    should_not_get_here();
+                    return false;
                 }
             }
         }
-         return true;
+        return true;
     }
 }
\ No newline at end of file
@@ -255,6 +255,10 @@ namespace Falcor
         std::vector<SetResourceVec> mAssignedResources;
         bool checkResourceIndices(const BindLocation& bindLocation, uint32_t arrayIndex, DescriptorSet::Type type, const std::string& funcName) const;
 
+        // Identifies the contents of a root set, to reuse a cached set with the same contents
+        void getRootSetKey(uint32_t s, DescriptorTableKey& key, std::vector<std::shared_ptr<const void>>& views) const;
+        bool writeRootSet(uint32_t s);
+
         std::vector<RootSet> mRootSets;
         void setResourceSrvUavCommon(std::string name, uint32_t descOffset, DescriptorSet::Type type, const Resource::SharedPtr& pResource, const std::string& funcName);
         template<typename ResourceType>
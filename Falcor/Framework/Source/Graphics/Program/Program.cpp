@@ -158,6 +158,8 @@ namespace Falcor
 
     // Program
     std::vector<Program*> Program::sPrograms;
+    ShaderDependencyGraph Program::sDependencyGraph;
+    FileWatcher::SharedPtr Program::spFileWatcher;
 
     Program::Program()
     {
@@ -181,6 +183,7 @@ namespace Falcor
                 break;;
             }
         }
+        sDependencyGraph.removeProgram(this);
     }
 
     std::string Program::getProgramDescString() const
@@ -571,6 +574,7 @@ namespace Falcor
             std::string depFilePath = spGetDependencyFilePath(slangRequest, ii);
             mFileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
         }
+        watchDependencies();
 
         spDestroyCompileRequest(slangRequest);
 
@@ -652,6 +656,24 @@ namespace Falcor
         mProgramVersions.clear();
         mFileTimeMap.clear();
         mLinkRequired = true;
+        sDependencyGraph.removeProgram(this);
+    }
+
+    void Program::watchDependencies() const
+    {
+        if (spFileWatcher == nullptr)
+        {
+            spFileWatcher = FileWatcher::create();
+            sDependencyGraph.setSearchPaths(getDataDirectoriesList());
+        }
+
+        std::vector<std::string> files;
+        for (const auto& f : mFileTimeMap)
+        {
+            files.push_back(f.first);
+            spFileWatcher->watchFile(f.first);
+        }
+        sDependencyGraph.addProgramFiles(this, files);
     }
 
     void Program::reloadAllPrograms()
@@ -664,4 +686,33 @@ namespace Falcor
             }
         }
     }
+
+    uint32_t Program::reloadChangedPrograms()
+    {
+        if (spFileWatcher == nullptr) return 0;
+
+        std::unordered_set<const void*> affected;
+        for (const auto& file : spFileWatcher->getChangedFiles())
+        {
+            // The file's includes might have changed, so update its edges before looking for dependents
+            sDependencyGraph.scanFile(file);
+            auto programs = sDependencyGraph.getAffectedPrograms(file);
+            if (programs.size())
+            {
+                logInfo("Shader file '" + file + "' changed, reloading " + std::to_string(programs.size()) + " program(s)");
+            }
+            affected.insert(programs.begin(), programs.end());
+        }
+
+        uint32_t count = 0;
+        for (auto& pProgram : sPrograms)
+        {
+            if (affected.count(pProgram))
+            {
+                pProgram->reset();
+                count++;
+            }
+        }
+        return count;
+    }
 }
@@ -30,6 +30,8 @@
 #include <map>
 #include <vector>
 #include "Graphics/Program//ProgramVersion.h"
+#include "Graphics/Program/ShaderDependencyGraph.h"
+#include "Utils/FileWatcher.h"
 
 namespace Falcor
 {
@@ -266,6 +268,13 @@ namespace Falcor
         */
         static void reloadAllPrograms();
 
+        /** Reset the programs affected by shader files which changed on disk since the last call.
+            Only programs which depend on a changed file, directly or through includes, are reset. They are relinked lazily the next time they are used.
+            Should be called at a frame boundary, so that a program never changes in the middle of a frame.
+            \return The number of programs which were reset
+        */
+        static uint32_t reloadChangedPrograms();
+
         deprecate("3.2", "Use setDefines({}) instead")
         bool clearDefines();
 
@@ -320,5 +329,9 @@ namespace Falcor
 
         bool checkIfFilesChanged();
         void reset();
+
+        void watchDependencies() const;
+        static ShaderDependencyGraph sDependencyGraph;
+        static FileWatcher::SharedPtr spFileWatcher;
     };
 }
\ No newline at end of file
@@ -0,0 +1,259 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "ShaderDependencyGraph.h"
+#include "Utils/FileWatcher.h"
+#include <experimental/filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::experimental::filesystem;
+
+namespace Falcor
+{
+    namespace
+    {
+        std::string stripComments(const std::string& source)
+        {
+            std::string result;
+            result.reserve(source.size());
+            for (size_t i = 0; i < source.size(); i++)
+            {
+                if (source[i] == '/' && i + 1 < source.size() && source[i + 1] == '/')
+                {
+                    while (i < source.size() && source[i] != '\n') i++;
+                    if (i < source.size()) result += '\n';
+                }
+                else if (source[i] == '/' && i + 1 < source.size() && source[i + 1] == '*')
+                {
+                    // Keep the newlines so that line-based parsing still sees the same lines
+                    for (i += 2; i < source.size() && !(source[i] == '*' && i + 1 < source.size() && source[i + 1] == '/'); i++)
+                    {
+                        if (source[i] == '\n') result += '\n';
+                    }
+                    i++;
+                }
+                else
+                {
+                    result += source[i];
+                }
+            }
+            return result;
+        }
+
+        bool consumeKeyword(const std::string& line, size_t& pos, const std::string& keyword)
+        {
+            if (line.compare(pos, keyword.size(), keyword) != 0) return false;
+            size_t end = pos + keyword.size();
+            if (end < line.size() && (isalnum((unsigned char)line[end]) || line[end] == '_')) return false;
+            pos = end;
+            return true;
+        }
+
+        void skipWhitespace(const std::string& line, size_t& pos)
+        {
+            while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t')) pos++;
+        }
+    }
+
+    std::string ShaderDependencyGraph::normalizePath(const std::string& filename)
+    {
+        return FileWatcher::canonicalizePath(filename);
+    }
+
+    std::vector<std::string> ShaderDependencyGraph::parseIncludes(const std::string& source)
+    {
+        std::vector<std::string> includes;
+        std::istringstream stream(stripComments(source));
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            size_t pos = 0;
+            skipWhitespace(line, pos);
+            if (pos < line.size() && line[pos] == '#')
+            {
+                pos++;
+                skipWhitespace(line, pos);
+                if (consumeKeyword(line, pos, "include") == false) continue;
+                skipWhitespace(line, pos);
+                if (pos >= line.size()) continue;
+
+                char close = (line[pos] == '"') ? '"' : ((line[pos] == '<') ? '>' : 0);
+                if (close == 0) continue;
+                size_t end = line.find(close, pos + 1);
+                if (end == std::string::npos) continue;
+                includes.push_back(line.substr(pos + 1, end - pos - 1));
+            }
+            else if (consumeKeyword(line, pos, "import") || consumeKeyword(line, pos, "__import"))
+            {
+                skipWhitespace(line, pos);
+                size_t end = line.find(';', pos);
+                if (end == std::string::npos) continue;
+                std::string module = line.substr(pos, end - pos);
+                while (module.size() && (module.back() == ' ' || module.back() == '\t')) module.pop_back();
+                if (module.empty()) continue;
+                std::replace(module.begin(), module.end(), '.', '/');
+                includes.push_back(module + ".slang");
+            }
+        }
+        return includes;
+    }
+
+    std::string ShaderDependencyGraph::resolveInclude(const std::string& includingFile, const std::string& include) const
+    {
+        fs::path local = fs::path(includingFile).parent_path() / include;
+        if (fs::exists(local)) return normalizePath(local.string());
+
+        for (const auto& dir : mSearchPaths)
+        {
+            fs::path p = fs::path(dir) / include;
+            if (fs::exists(p)) return normalizePath(p.string());
+        }
+        return "";
+    }
+
+    bool ShaderDependencyGraph::scanFile(const std::string& filename)
+    {
+        std::string path = normalizePath(filename);
+        std::vector<std::string> pending = { path };
+        std::unordered_set<std::string> visited;
+        bool success = true;
+
+        while (pending.size())
+        {
+            std::string file = pending.back();
+            pending.pop_back();
+            if (visited.insert(file).second == false) continue;
+
+            std::ifstream stream(file);
+            if (stream.fail())
+            {
+                if (file == path) success = false;
+                continue;
+            }
+            std::stringstream source;
+            source << stream.rdbuf();
+
+            std::vector<std::string> resolved;
+            for (const auto& include : parseIncludes(source.str()))
+            {
+                std::string includePath = resolveInclude(file, include);
+                if (includePath.empty()) continue;
+                resolved.push_back(includePath);
+
+                // Only descend into files we haven't seen before. Known files are re-scanned when they change.
+                if (mIncludes.count(includePath) == 0) pending.push_back(includePath);
+            }
+            setFileIncludes(file, resolved);
+        }
+        return success;
+    }
+
+    void ShaderDependencyGraph::setFileIncludes(const std::string& filename, const std::vector<std::string>& includes)
+    {
+        std::string path = normalizePath(filename);
+        auto& edges = mIncludes[path];
+        for (const auto& old : edges)
+        {
+            mIncludedBy[old].erase(path);
+        }
+
+        edges.clear();
+        for (const auto& include : includes)
+        {
+            std::string includePath = normalizePath(include);
+            edges.insert(includePath);
+            mIncludedBy[includePath].insert(path);
+        }
+    }
+
+    void ShaderDependencyGraph::addProgramFiles(ProgramHandle program, const std::vector<std::string>& files)
+    {
+        auto& programFiles = mProgramFiles[program];
+        for (const auto& f : files)
+        {
+            std::string path = normalizePath(f);
+            if (mIncludes.count(path) == 0) scanFile(path);
+            programFiles.insert(path);
+            mFilePrograms[path].insert(program);
+        }
+    }
+
+    void ShaderDependencyGraph::removeProgram(ProgramHandle program)
+    {
+        auto it = mProgramFiles.find(program);
+        if (it == mProgramFiles.end()) return;
+        for (const auto& f : it->second)
+        {
+            mFilePrograms[f].erase(program);
+        }
+        mProgramFiles.erase(it);
+    }
+
+    std::vector<std::string> ShaderDependencyGraph::getDependentFiles(const std::string& filename) const
+    {
+        std::string path = normalizePath(filename);
+        std::vector<std::string> result;
+        std::unordered_set<std::string> visited = { path };
+        std::vector<std::string> pending = { path };
+
+        while (pending.size())
+        {
+            std::string file = pending.back();
+            pending.pop_back();
+            result.push_back(file);
+
+            auto it = mIncludedBy.find(file);
+            if (it == mIncludedBy.end()) continue;
+            for (const auto& parent : it->second)
+            {
+                if (visited.insert(parent).second) pending.push_back(parent);
+            }
+        }
+        return result;
+    }
+
+    std::vector<ShaderDependencyGraph::ProgramHandle> ShaderDependencyGraph::getAffectedPrograms(const std::string& filename) const
+    {
+        std::unordered_set<ProgramHandle> programs;
+        for (const auto& file : getDependentFiles(filename))
+        {
+            auto it = mFilePrograms.find(file);
+            if (it == mFilePrograms.end()) continue;
+            programs.insert(it->second.begin(), it->second.end());
+        }
+        return std::vector<ProgramHandle>(programs.begin(), programs.end());
+    }
+
+    std::vector<std::string> ShaderDependencyGraph::getProgramFiles(ProgramHandle program) const
+    {
+        auto it = mProgramFiles.find(program);
+        if (it == mProgramFiles.end()) return {};
+        return std::vector<std::string>(it->second.begin(), it->second.end());
+    }
+}
@@ -0,0 +1,97 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Falcor
+{
+    /** Tracks which shader files include which, and which programs depend on which files.
+        Used by the shader hot-reload to find the minimal set of programs that need to be recompiled when a file changes - editing
+        a file used by a single pass shouldn't recompile every program in the application.
+        The graph doesn't depend on the graphics API, so it can be used and tested without a device.
+    */
+    class ShaderDependencyGraph
+    {
+    public:
+        using ProgramHandle = const void*;
+
+        /** Set the directories used to resolve include paths which are not relative to the including file.
+        */
+        void setSearchPaths(const std::vector<std::string>& searchPaths) { mSearchPaths = searchPaths; }
+
+        /** Extract the names of the files referenced by `#include` and `import` directives in shader source.
+            `import a.b;` is returned as "a/b.slang". Directives inside comments are ignored.
+        */
+        static std::vector<std::string> parseIncludes(const std::string& source);
+
+        /** Read a file from disk and update its outgoing edges. Included files which are not yet part of the graph are scanned recursively.
+            \return false if the file can't be read
+        */
+        bool scanFile(const std::string& filename);
+
+        /** Replace the outgoing edges of a file. The includes are expected to be resolved paths.
+        */
+        void setFileIncludes(const std::string& filename, const std::vector<std::string>& includes);
+
+        /** Add files a program depends on. Files which aren't part of the graph are scanned from disk.
+        */
+        void addProgramFiles(ProgramHandle program, const std::vector<std::string>& files);
+
+        /** Remove a program and all its file associations.
+        */
+        void removeProgram(ProgramHandle program);
+
+        /** Get a file and all the files which include it, directly or transitively.
+        */
+        std::vector<std::string> getDependentFiles(const std::string& filename) const;
+
+        /** Get the programs which need to be recompiled when a file changes.
+        */
+        std::vector<ProgramHandle> getAffectedPrograms(const std::string& filename) const;
+
+        /** Get the files a program depends on, as registered with addProgramFiles().
+        */
+        std::vector<std::string> getProgramFiles(ProgramHandle program) const;
+
+        /** Convert a path to the form used as a key in the graph.
+        */
+        static std::string normalizePath(const std::string& filename);
+
+    private:
+        std::string resolveInclude(const std::string& includingFile, const std::string& include) const;
+
+        std::vector<std::string> mSearchPaths;
+        std::unordered_map<std::string, std::unordered_set<std::string>> mIncludes;       // File -> files it includes
+        std::unordered_map<std::string, std::unordered_set<std::string>> mIncludedBy;     // File -> files including it
+        std::unordered_map<std::string, std::unordered_set<ProgramHandle>> mFilePrograms;
+        std::unordered_map<ProgramHandle, std::unordered_set<std::string>> mProgramFiles;
+    };
+}
@@ -0,0 +1,214 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "QueueSchedule.h"
+#include <array>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kQueueCount = uint32_t(QueueSchedule::Queue::Count);
+        const uint32_t kGraphics = uint32_t(QueueSchedule::Queue::Graphics);
+
+        // Sync points are pass indices. A queue that never synced with another one only knows about its own work.
+        const int32_t kNotSynced = -2;
+        const int32_t kFrameStartPoint = -1;
+        using SyncPoints = std::array<int32_t, kQueueCount>;
+
+        std::string costToString(float cost)
+        {
+            char s[32];
+            snprintf(s, sizeof(s), "%g", cost);
+            return s;
+        }
+    }
+
+    QueueSchedule QueueSchedule::build(const std::vector<Pass>& passes)
+    {
+        const uint32_t passCount = uint32_t(passes.size());
+        QueueSchedule schedule;
+        schedule.mQueues.resize(passCount);
+        schedule.mSignals.assign(passCount, false);
+        schedule.mLifetimeEnd.resize(passCount);
+
+        // known[q][r] is the last pass of queue r that queue q knows is complete at its current point. syncedAt[p] is the same for the queue of pass p when it starts.
+        std::array<SyncPoints, kQueueCount> known;
+        for (uint32_t q = 0; q < kQueueCount; q++)
+        {
+            known[q].fill(kNotSynced);
+            known[q][q] = kFrameStartPoint;
+        }
+        // The graphics queue is the one the frame is submitted on, so it's always in sync with the work before the frame
+        known[kGraphics].fill(kFrameStartPoint);
+
+        std::vector<SyncPoints> syncedAt(passCount);
+        SyncPoints lastPass;
+        lastPass.fill(kFrameStartPoint);
+
+        for (uint32_t p = 0; p < passCount; p++)
+        {
+            const Pass& pass = passes[p];
+            const uint32_t q = uint32_t(pass.queue);
+            assert(q < kQueueCount);
+            schedule.mQueues[p] = pass.queue;
+
+            // The last pass of each other queue this one depends on. Passes on the same queue are ordered by the queue.
+            SyncPoints needed;
+            needed.fill(kNotSynced);
+            for (uint32_t d : pass.dependencies)
+            {
+                assert(d < p);
+                uint32_t r = uint32_t(passes[d].queue);
+                if (r != q) needed[r] = max(needed[r], int32_t(d));
+            }
+
+            // The fork, on the first pass of the compute queue. A handoff waits for the latest graphics pass, since the transitions are recorded after it.
+            bool handoff = pass.handoff && (q != kGraphics);
+            if (q != kGraphics && known[q][kGraphics] == kNotSynced) needed[kGraphics] = max(needed[kGraphics], kFrameStartPoint);
+            if (handoff) needed[kGraphics] = max(needed[kGraphics], lastPass[kGraphics]);
+
+            for (uint32_t r = 0; r < kQueueCount; r++)
+            {
+                if (r == q || needed[r] == kNotSynced) continue;
+                bool forced = handoff && (r == kGraphics);
+                if (!forced && needed[r] <= known[q][r]) continue;
+
+                int32_t src = needed[r];
+                schedule.mFences.push_back({ Queue(r), (src == kFrameStartPoint) ? kFrameStart : uint32_t(src), p, forced });
+                known[q][r] = max(known[q][r], src);
+                if (src == kFrameStartPoint) continue;
+
+                // Waiting on a pass also covers everything that pass waited on
+                if (!forced) schedule.mSignals[src] = true;
+                for (uint32_t s = 0; s < kQueueCount; s++)
+                {
+                    if (s != q) known[q][s] = max(known[q][s], syncedAt[src][s]);
+                }
+            }
+
+            known[q][q] = int32_t(p);
+            syncedAt[p] = known[q];
+            lastPass[q] = int32_t(p);
+            schedule.mQueuePasses[q].push_back(p);
+        }
+
+        // The join
+        for (uint32_t r = 0; r < kQueueCount; r++)
+        {
+            if (r == kGraphics || lastPass[r] <= known[kGraphics][r]) continue;
+            schedule.mFences.push_back({ Queue(r), uint32_t(lastPass[r]), passCount, false });
+            schedule.mSignals[lastPass[r]] = true;
+        }
+
+        // A pass may overlap the passes of other queues up to the first one that waited for it, directly or not
+        for (uint32_t p = 0; p < passCount; p++)
+        {
+            const uint32_t q = uint32_t(schedule.mQueues[p]);
+            uint32_t end = p;
+            for (uint32_t r = 0; r < kQueueCount; r++)
+            {
+                if (r == q) continue;
+                for (uint32_t other : schedule.mQueuePasses[r])
+                {
+                    if (other < p) continue;
+                    if (syncedAt[other][q] >= int32_t(p)) break;
+                    end = max(end, other);
+                }
+            }
+            schedule.mLifetimeEnd[p] = end;
+        }
+
+        // Simulate the queues to find the critical path. A pass starts when its queue is done with the previous pass and all the fences it waits on are signaled.
+        std::vector<float> finish(passCount);
+        std::vector<uint32_t> critical(passCount, kFrameStart);    // The pass that gated the start of each pass
+        size_t fence = 0;
+        for (uint32_t p = 0; p < passCount; p++)
+        {
+            float start = 0;
+            const uint32_t q = uint32_t(schedule.mQueues[p]);
+            const auto& queuePasses = schedule.mQueuePasses[q];
+            auto it = std::lower_bound(queuePasses.begin(), queuePasses.end(), p);
+            if (it != queuePasses.begin())
+            {
+                critical[p] = *(it - 1);
+                start = finish[critical[p]];
+            }
+
+            for (; fence < schedule.mFences.size() && schedule.mFences[fence].waitPass == p; fence++)
+            {
+                // On ties, prefer the fence so the path shows the cross-queue dependency
+                uint32_t src = schedule.mFences[fence].srcPass;
+                if (src != kFrameStart && finish[src] >= start)
+                {
+                    start = finish[src];
+                    critical[p] = src;
+                }
+            }
+            finish[p] = start + passes[p].cost;
+            schedule.mSerialLength += passes[p].cost;
+        }
+
+        if (passCount)
+        {
+            uint32_t last = uint32_t(std::max_element(finish.begin(), finish.end()) - finish.begin());
+            schedule.mCriticalPathLength = finish[last];
+            for (uint32_t p = last; p != kFrameStart; p = critical[p]) schedule.mCriticalPath.push_back(p);
+            std::reverse(schedule.mCriticalPath.begin(), schedule.mCriticalPath.end());
+        }
+        return schedule;
+    }
+
+    std::string QueueSchedule::toString(const std::vector<std::string>& passNames) const
+    {
+        auto passName = [&](uint32_t pass) { return (pass < passNames.size()) ? passNames[pass] : std::to_string(pass); };
+
+        std::string s;
+        for (uint32_t q = 0; q < kQueueCount; q++)
+        {
+            if (mQueuePasses[q].empty()) continue;
+            s += to_string(Queue(q)) + ":";
+            for (uint32_t p : mQueuePasses[q]) s += " " + passName(p);
+            s += "\n";
+        }
+
+        for (const Fence& f : mFences)
+        {
+            s += std::string(f.handoff ? "handoff " : "fence ") + to_string(f.srcQueue) + " ";
+            s += (f.srcPass == kFrameStart) ? std::string("start") : passName(f.srcPass);
+            s += " -> ";
+            s += (f.waitPass == getPassCount()) ? std::string("end") : passName(f.waitPass);
+            s += "\n";
+        }
+
+        s += "critical path " + costToString(mCriticalPathLength) + " of " + costToString(mSerialLength) + ":";
+        for (uint32_t p : mCriticalPath) s += " " + passName(p);
+        s += "\n";
+        return s;
+    }
+}
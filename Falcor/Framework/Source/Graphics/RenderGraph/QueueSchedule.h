@@ -0,0 +1,143 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include <string>
+
+namespace Falcor
+{
+    /** Partitions a frame's passes across the graphics and async-compute queues and places the fences between them.
+        Each queue executes its passes in the frame's execution order. A pass waits on another queue only if it depends on a pass of that queue
+        which the waiting queue doesn't already know is complete, either directly or through an earlier fence.
+        The frame is bracketed by a fork, where the compute queue waits for the graphics work submitted before its first pass, and a join, where the
+        graphics queue waits for the compute queue before the frame ends. This orders the work of consecutive frames.
+        The schedule is CPU only. RenderGraph builds it when compiling and issues the fences while executing.
+    */
+    class QueueSchedule
+    {
+    public:
+        enum class Queue
+        {
+            Graphics,
+            Compute,
+            Count
+        };
+
+        static const uint32_t kFrameStart = -1;     ///< Fence source for the work submitted before the frame's first pass
+
+        /** A pass, in execution order
+        */
+        struct Pass
+        {
+            Queue queue = Queue::Graphics;
+            float cost = 1;                         ///< Estimated execution time, used for the critical path
+            std::vector<uint32_t> dependencies;     ///< Earlier passes this one must execute after (read after write, write after read or write after write)
+            bool handoff = false;                   ///< For compute passes: the graphics queue transitions resources for the pass, so it waits on the graphics queue even if that's redundant
+        };
+
+        /** The queue of `waitPass` waits until `srcPass` is complete on `srcQueue`
+        */
+        struct Fence
+        {
+            Queue srcQueue;
+            uint32_t srcPass;       ///< kFrameStart if the fence only orders work submitted before the frame
+            uint32_t waitPass;      ///< The pass count for the join at the end of the frame
+            bool handoff;           ///< The source queue signals right before the wait rather than right after `srcPass`, so the signal covers the work it records for the waiting pass
+        };
+
+        /** Build a schedule.
+            \param[in] passes The passes in execution order. Dependencies must refer to earlier passes.
+        */
+        static QueueSchedule build(const std::vector<Pass>& passes);
+
+        /** Get the number of passes
+        */
+        uint32_t getPassCount() const { return uint32_t(mQueues.size()); }
+
+        /** Get the queue a pass executes on
+        */
+        Queue getQueue(uint32_t pass) const { return mQueues[pass]; }
+
+        /** Get the passes a queue executes, in order
+        */
+        const std::vector<uint32_t>& getQueuePasses(Queue queue) const { return mQueuePasses[uint32_t(queue)]; }
+
+        /** Get the fences, sorted by their wait pass
+        */
+        const std::vector<Fence>& getFences() const { return mFences; }
+
+        /** Check if the queue of a pass needs to signal after the pass executes, because a fence waits on it
+        */
+        bool signalsAfter(uint32_t pass) const { return mSignals[pass]; }
+
+        /** Get the last pass, in execution order, that may execute concurrently with a pass. The resources the pass uses must live until then.
+        */
+        uint32_t getLifetimeEnd(uint32_t pass) const { return mLifetimeEnd[pass]; }
+
+        /** Get the estimated frame time with both queues running concurrently, which is the length of the critical path
+        */
+        float getCriticalPathLength() const { return mCriticalPathLength; }
+
+        /** Get the passes on the critical path, in execution order
+        */
+        const std::vector<uint32_t>& getCriticalPath() const { return mCriticalPath; }
+
+        /** Get the estimated frame time with all passes executing serially
+        */
+        float getSerialLength() const { return mSerialLength; }
+
+        /** Get a human-readable dump of the schedule: the passes of each queue, the fences and the critical path
+            \param[in] passNames Optional names for the passes. Indices are printed if empty.
+        */
+        std::string toString(const std::vector<std::string>& passNames = {}) const;
+
+    private:
+        std::vector<Queue> mQueues;
+        std::vector<uint32_t> mQueuePasses[uint32_t(Queue::Count)];
+        std::vector<Fence> mFences;
+        std::vector<bool> mSignals;
+        std::vector<uint32_t> mLifetimeEnd;
+        std::vector<uint32_t> mCriticalPath;
+        float mCriticalPathLength = 0;
+        float mSerialLength = 0;
+    };
+
+    inline std::string to_string(QueueSchedule::Queue queue)
+    {
+        switch (queue)
+        {
+        case QueueSchedule::Queue::Graphics:
+            return "graphics";
+        case QueueSchedule::Queue::Compute:
+            return "compute";
+        default:
+            should_not_get_here();
+            return "";
+        }
+    }
+}
@@ -608,33 +608,325 @@ namespace Falcor
             if (insertAutoPasses()) if (resolveExecutionOrder() == false) return false;
             if (resolveResourceTypes() == false) return false;
             if (isValid(log) == false) return false;
+            buildExecutionPlan();
         }
         mRecompile = false;
         return true;
     }
 
+    /** Get the state a pass needs a field's resource in, from the field's type and bind flags.
+        Returns false if the bind flags don't imply a state, in which case the pass handles the resource's state itself.
+        Passes with compute affinity read shader resources in the NonPixelShader state, which the compute queue supports.
+    */
+    static bool getFieldAccess(const RenderPassReflection::Field& field, bool computeAffinity, ResourceBarrierPlan::Access& access)
+    {
+        Resource::BindFlags flags = field.getBindFlags();
+        access.write = is_set(field.getType(), RenderPassReflection::Field::Type::Output | RenderPassReflection::Field::Type::Internal);
+        if (is_set(flags, Resource::BindFlags::DepthStencil)) access.state = Resource::State::DepthStencil;
+        else if (access.write && is_set(flags, Resource::BindFlags::RenderTarget)) access.state = Resource::State::RenderTarget;
+        else if (access.write && is_set(flags, Resource::BindFlags::UnorderedAccess)) access.state = Resource::State::UnorderedAccess;
+        else if (!access.write && is_set(flags, Resource::BindFlags::ShaderResource)) access.state = computeAffinity ? Resource::State::NonPixelShader : Resource::State::ShaderResource;
+        else if (!access.write && is_set(flags, Resource::BindFlags::UnorderedAccess)) access.state = Resource::State::UnorderedAccess;
+        else return false;
+        return true;
+    }
+
+    /** Check if a compute queue can transition a resource from or to a state
+    */
+    static bool isComputeQueueState(Resource::State state)
+    {
+        switch (state)
+        {
+        case Resource::State::Common:
+        case Resource::State::UnorderedAccess:
+        case Resource::State::NonPixelShader:
+        case Resource::State::IndirectArg:
+        case Resource::State::CopyDest:
+        case Resource::State::CopySource:
+        case Resource::State::GenericRead:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void RenderGraph::buildExecutionPlan()
+    {
+        mExecutionPlan = ExecutionPlan();
+        mExecutionPlan.passes.reserve(mExecutionList.size());
+        mExecutionPlan.renderData.reserve(mExecutionList.size());
+        mExecutionPlan.profileNames.reserve(mExecutionList.size());
+
+        for (uint32_t nodeIndex : mExecutionList)
+        {
+            const NodeData& nodeData = mNodeData[nodeIndex];
+            RenderPassReflection reflection = nodeData.pPass->reflect();
+            RenderData renderData(nodeData.nodeName, reflection, mpPassDictionary);
+
+            // Resolve every field through the cache once. External inputs take precedence, the same as ResourceCache::getResource().
+            uint32_t passIndex = uint32_t(mExecutionPlan.passes.size());
+            for (uint32_t slot = 0; slot < uint32_t(reflection.getFieldCount()); slot++)
+            {
+                std::string fullFieldName = nodeData.nodeName + '.' + reflection.getField(slot).getName();
+                renderData.setResource(slot, mpResourcesCache->getResource(fullFieldName));
+                mExecutionPlan.fieldSlots[fullFieldName] = { passIndex, slot };
+            }
+
+            mExecutionPlan.passes.push_back(nodeData.pPass);
+            mExecutionPlan.renderData.push_back(std::move(renderData));
+            mExecutionPlan.profileNames.push_back(nodeData.nodeName);
+            mExecutionPlan.computeAffinity.push_back(nodeData.pPass->getQueueAffinity() == QueueSchedule::Queue::Compute);
+        }
+        buildBarrierPlan();
+    }
+
+    void RenderGraph::buildBarrierPlan()
+    {
+        // Plan the state transitions from the fields' usage. Aliased fields share a resource, so resources are identified by pointer.
+        mExecutionPlan.barrierResources.clear();
+        mExecutionPlan.barriersDirty = false;
+        std::unordered_map<const Resource*, uint32_t> resourceIndices;
+        std::vector<std::vector<ResourceBarrierPlan::Access>> passAccesses(mExecutionPlan.passes.size());
+        for (uint32_t pass = 0; pass < uint32_t(mExecutionPlan.passes.size()); pass++)
+        {
+            RenderPassReflection reflection = mExecutionPlan.passes[pass]->reflect();
+            const RenderData& renderData = mExecutionPlan.renderData[pass];
+            for (uint32_t slot = 0; slot < renderData.getSlotCount(); slot++)
+            {
+                const Resource* pResource = renderData.getResource(slot).get();
+                ResourceBarrierPlan::Access access;
+                if (!pResource || !getFieldAccess(reflection.getField(slot), mExecutionPlan.computeAffinity[pass], access)) continue;
+
+                auto it = resourceIndices.find(pResource);
+                if (it == resourceIndices.end())
+                {
+                    it = resourceIndices.emplace(pResource, uint32_t(mExecutionPlan.barrierResources.size())).first;
+                    mExecutionPlan.barrierResources.push_back({ pass, slot });
+                }
+                access.resource = it->second;
+                passAccesses[pass].push_back(access);
+            }
+        }
+        mExecutionPlan.barriers = ResourceBarrierPlan::build(uint32_t(mExecutionPlan.barrierResources.size()), passAccesses);
+        mExecutionPlan.splitBegun.assign(mExecutionPlan.barrierResources.size(), false);
+
+        buildQueueSchedule(passAccesses);
+    }
+
+    void RenderGraph::buildQueueSchedule(const std::vector<std::vector<ResourceBarrierPlan::Access>>& passAccesses)
+    {
+        auto& plan = mExecutionPlan;
+        const uint32_t passCount = uint32_t(plan.passes.size());
+        bool async = mAsyncCompute && gpDevice && (gpDevice->getCommandQueueCount(LowLevelContextData::CommandQueueType::Compute) > 0);
+
+        // A pass depends on the last pass that wrote a resource it accesses, and on the passes that read a resource since it was last written, if it writes it
+        std::vector<QueueSchedule::Pass> passes(passCount);
+        std::vector<uint32_t> lastWriter(plan.barrierResources.size(), kInvalidIndex);
+        std::vector<std::vector<uint32_t>> readers(plan.barrierResources.size());
+        for (uint32_t pass = 0; pass < passCount; pass++)
+        {
+            QueueSchedule::Pass& schedulePass = passes[pass];
+            schedulePass.queue = (async && plan.computeAffinity[pass]) ? QueueSchedule::Queue::Compute : QueueSchedule::Queue::Graphics;
+            for (const auto& access : passAccesses[pass])
+            {
+                uint32_t writer = lastWriter[access.resource];
+                if (writer != kInvalidIndex && writer != pass) schedulePass.dependencies.push_back(writer);
+                if (access.write)
+                {
+                    for (uint32_t reader : readers[access.resource])
+                    {
+                        if (reader != pass) schedulePass.dependencies.push_back(reader);
+                    }
+                    readers[access.resource].clear();
+                    lastWriter[access.resource] = pass;
+                }
+                else readers[access.resource].push_back(pass);
+            }
+
+            // Transitions from or to graphics states are handed off to the graphics queue. Split transitions are not used with async compute, so EndSplit is a full transition.
+            if (schedulePass.queue == QueueSchedule::Queue::Compute)
+            {
+                for (const auto& b : plan.barriers.getBarriers(pass))
+                {
+                    if (b.type == ResourceBarrierPlan::Barrier::Type::Uav || b.type == ResourceBarrierPlan::Barrier::Type::BeginSplit) continue;
+                    if (!isComputeQueueState(b.before) || !isComputeQueueState(b.after)) schedulePass.handoff = true;
+                }
+            }
+        }
+        plan.schedule = QueueSchedule::build(passes);
+        plan.signalValues.assign(passCount, 0);
+        plan.forkAtFrameStart = false;
+        for (const auto& fence : plan.schedule.getFences())
+        {
+            if (fence.srcPass == QueueSchedule::kFrameStart) plan.forkAtFrameStart = true;
+        }
+
+        if (plan.schedule.getQueuePasses(QueueSchedule::Queue::Compute).size() && !mpComputeContext)
+        {
+            mpComputeContext = ComputeContext::create(gpDevice->getCommandQueueHandle(LowLevelContextData::CommandQueueType::Compute, 0));
+        }
+    }
+
+    CopyContext* RenderGraph::getQueueContext(RenderContext* pContext, QueueSchedule::Queue queue) const
+    {
+        return (queue == QueueSchedule::Queue::Compute) ? (CopyContext*)mpComputeContext.get() : pContext;
+    }
+
+    void RenderGraph::issueBarriers(RenderContext* pContext, CopyContext* pQueueContext, uint32_t pass)
+    {
+        auto& plan = mExecutionPlan;
+        plan.handoff = false;
+        plan.transitions.clear();
+        plan.graphicsTransitions.clear();
+        plan.uavResources.clear();
+        const auto& barriers = plan.barriers.getBarriers(pass);
+        if (barriers.empty()) return;
+
+        // Split transitions can't begin and end on different queues
+        bool allowSplit = plan.schedule.getQueuePasses(QueueSchedule::Queue::Compute).empty();
+        bool computeQueue = (pQueueContext != pContext);
+
+        for (const auto& b : barriers)
+        {
+            const auto& binding = plan.barrierResources[b.resource];
+            const Resource* pResource = plan.renderData[binding.first].getResource(binding.second).get();
+            if (!pResource) continue;
+
+            CopyContext::ResourceTransition transition = { pResource, b.after, CopyContext::ResourceTransition::Split::None };
+            switch (b.type)
+            {
+            case ResourceBarrierPlan::Barrier::Type::Uav:
+                plan.uavResources.push_back(pResource);
+                continue;
+            case ResourceBarrierPlan::Barrier::Type::Transition:
+                break;
+            case ResourceBarrierPlan::Barrier::Type::BeginSplit:
+                // Only split if the resource is in the planned state. It isn't on the first frame, or if something outside the graph used it.
+                if (!allowSplit || !pResource->isStateGlobal() || pResource->getGlobalState() != b.before) continue;
+                transition.split = CopyContext::ResourceTransition::Split::Begin;
+                plan.splitBegun[b.resource] = true;
+                break;
+            case ResourceBarrierPlan::Barrier::Type::EndSplit:
+                if (plan.splitBegun[b.resource]) transition.split = CopyContext::ResourceTransition::Split::End;
+                plan.splitBegun[b.resource] = false;
+                break;
+            default:
+                should_not_get_here();
+            }
+
+            // Check the actual state rather than the planned one, which differs on the first frame
+            Resource::State before = pResource->isStateGlobal() ? pResource->getGlobalState() : b.before;
+            bool handoff = computeQueue && (!isComputeQueueState(before) || !isComputeQueueState(b.after));
+            (handoff ? plan.graphicsTransitions : plan.transitions).push_back(transition);
+        }
+
+        // The handoff transitions are recorded before waitForQueues() signals the graphics queue
+        if (plan.graphicsTransitions.size())
+        {
+            pContext->resourceBarriers(plan.graphicsTransitions, {});
+            plan.handoff = true;
+        }
+    }
+
+    void RenderGraph::waitForQueues(RenderContext* pContext, uint32_t pass, size_t& fence)
+    {
+        auto& plan = mExecutionPlan;
+        const auto& fences = plan.schedule.getFences();
+        QueueSchedule::Queue queue = (pass < plan.passes.size()) ? plan.schedule.getQueue(pass) : QueueSchedule::Queue::Graphics;
+        CopyContext* pDst = getQueueContext(pContext, queue);
+        bool waitedOnGraphics = false;
+
+        for (; fence < fences.size() && fences[fence].waitPass == pass; fence++)
+        {
+            const auto& f = fences[fence];
+            CopyContext* pSrc = getQueueContext(pContext, f.srcQueue);
+            uint64_t value;
+            if (f.handoff || (plan.handoff && f.srcQueue == QueueSchedule::Queue::Graphics))
+            {
+                pSrc->flush(false);
+                value = pSrc->getLowLevelData()->getFence()->getCpuValue() - 1;
+            }
+            else
+            {
+                value = (f.srcPass == QueueSchedule::kFrameStart) ? plan.frameStartValue : plan.signalValues[f.srcPass];
+            }
+
+            // Submit what the queue recorded so far, so it doesn't wait too
+            pDst->flush(false);
+            pSrc->getLowLevelData()->getFence()->syncGpu(pDst->getLowLevelData()->getCommandQueue(), value);
+            waitedOnGraphics = waitedOnGraphics || (f.srcQueue == QueueSchedule::Queue::Graphics);
+        }
+
+        // A handoff the schedule didn't plan, because the resource wasn't in the planned state
+        if (plan.handoff && !waitedOnGraphics)
+        {
+            pContext->flush(false);
+            pDst->flush(false);
+            pContext->getLowLevelData()->getFence()->syncGpu(pDst->getLowLevelData()->getCommandQueue());
+        }
+    }
+
     void RenderGraph::execute(RenderContext* pContext)
     {
+        static const HashedString kExecuteEvent("RenderGraph::execute()");
         bool profile = mProfileGraph && gProfileEnabled;
 
-        if (profile) Profiler::startEvent("RenderGraph::execute()");
+        if (profile) Profiler::startEvent(kExecuteEvent);
 
-        std::string log;
-        if (!compile(log))
+        if (mRecompile)
         {
-            logWarning("Failed to compile RenderGraph\n" + log + "Ignoring RenderGraph::execute() call");
-            return;
+            std::string log;
+            if (!compile(log))
+            {
+                logWarning("Failed to compile RenderGraph\n" + log + "Ignoring RenderGraph::execute() call");
+                if (profile) Profiler::endEvent(kExecuteEvent);
+                return;
+            }
+        }
+        if (mExecutionPlan.barriersDirty) buildBarrierPlan();
+
+        auto& plan = mExecutionPlan;
+        if (plan.forkAtFrameStart)
+        {
+            pContext->flush(false);
+            plan.frameStartValue = pContext->getLowLevelData()->getFence()->getCpuValue() - 1;
         }
 
-        for (const auto& node : mExecutionList)
+        size_t fence = 0;
+        for (uint32_t i = 0; i < uint32_t(plan.passes.size()); i++)
         {
-            if (profile) Profiler::startEvent(mNodeData[node].nodeName);
-            RenderData renderData(mNodeData[node].nodeName, mpResourcesCache, mpPassDictionary);
-            mNodeData[node].pPass->execute(pContext, &renderData);
-            if (profile) Profiler::endEvent(mNodeData[node].nodeName);
+            if (profile) Profiler::startEvent(plan.profileNames[i]);
+            CopyContext* pQueueContext = getQueueContext(pContext, plan.schedule.getQueue(i));
+            issueBarriers(pContext, pQueueContext, i);
+            waitForQueues(pContext, i, fence);
+            if (plan.transitions.size() || plan.uavResources.size()) pQueueContext->resourceBarriers(plan.transitions, plan.uavResources);
+
+            if (plan.computeAffinity[i])
+            {
+                ComputeContext* pComputeContext = (pQueueContext == pContext) ? pContext : mpComputeContext.get();
+                plan.passes[i]->executeCompute(pComputeContext, &plan.renderData[i]);
+            }
+            else plan.passes[i]->execute(pContext, &plan.renderData[i]);
+
+            if (plan.schedule.signalsAfter(i))
+            {
+                pQueueContext->flush(false);
+                plan.signalValues[i] = pQueueContext->getLowLevelData()->getFence()->getCpuValue() - 1;
+            }
+            if (profile) Profiler::endEvent(plan.profileNames[i]);
         }
 
-        if (profile) Profiler::endEvent("RenderGraph::execute()");
+        // The join
+        waitForQueues(pContext, uint32_t(plan.passes.size()), fence);
+
+        if (profile) Profiler::endEvent(kExecuteEvent);
+    }
+
+    void RenderGraph::setAsyncCompute(bool enabled)
+    {
+        if (mAsyncCompute == enabled) return;
+        mAsyncCompute = enabled;
+        mRecompile = true;
     }
 
     void RenderGraph::update(const SharedPtr& pGraph)
@@ -701,6 +993,19 @@ namespace Falcor
         RenderPass* pPass = getRenderPassAndNamePair<true>(this, name, "RenderGraph::setInput()", strPair);
         if (pPass == nullptr) return false;
         mpResourcesCache->registerExternalInput(name, pResource);
+
+        // Patch the compiled plan. Fields that are not part of it (e.g., their pass is not executed) will be resolved by the next compilation.
+        // The barriers were planned from the previous binding, which may have been unbound or aliased another field, so they are planned again.
+        auto slotIt = mExecutionPlan.fieldSlots.find(name);
+        if (slotIt != mExecutionPlan.fieldSlots.end())
+        {
+            RenderData& renderData = mExecutionPlan.renderData[slotIt->second.first];
+            if (renderData.getResource(slotIt->second.second) != pResource)
+            {
+                renderData.setResource(slotIt->second.second, pResource);
+                mExecutionPlan.barriersDirty = true;
+            }
+        }
         return true;
     }
 
@@ -938,6 +1243,17 @@ namespace Falcor
             pGui->addCheckBox("Profile Passes", mProfileGraph);
             pGui->addTooltip("Profile the render-passes. The results will be shown in the profiler window. If you can't see it, click 'P'");
 
+            if (gpDevice->getCommandQueueCount(LowLevelContextData::CommandQueueType::Compute) > 0)
+            {
+                bool asyncCompute = mAsyncCompute;
+                if (pGui->addCheckBox("Async Compute", asyncCompute)) setAsyncCompute(asyncCompute);
+                pGui->addTooltip("Execute the passes with compute affinity on the async-compute queue");
+            }
+            const QueueSchedule& schedule = mExecutionPlan.schedule;
+            std::string scheduleText = std::to_string(schedule.getQueuePasses(QueueSchedule::Queue::Compute).size()) + " async passes, " + std::to_string(schedule.getFences().size()) + " fences, critical path " +
+                std::to_string(schedule.getCriticalPath().size()) + " of " + std::to_string(schedule.getPassCount()) + " passes";
+            pGui->addText(scheduleText.c_str());
+
             for (const auto& passId : mExecutionList)
             {
                 const auto& pass = mNodeData[passId];
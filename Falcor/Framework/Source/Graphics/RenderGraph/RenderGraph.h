@@ -29,6 +29,10 @@
 #include "RenderPass.h"
 #include "Utils/DirectedGraph.h"
 #include "ResourceCache.h"
+#include "ResourceBarrierPlan.h"
+#include "API/CopyContext.h"
+#include "API/ComputeContext.h"
+#include "Utils/Profiler.h"
 
 namespace Falcor
 {
@@ -158,6 +162,18 @@ namespace Falcor
         */
         void profileGraph(bool enabled) { mProfileGraph = enabled; }
 
+        /** Enable/disable async compute. When enabled and the device has a compute queue, passes with compute affinity execute on it. Enabled by default.
+        */
+        void setAsyncCompute(bool enabled);
+
+        /** Check if async compute is enabled. It's only used if the device has a compute queue.
+        */
+        bool isAsyncComputeEnabled() const { return mAsyncCompute; }
+
+        /** Get the queue schedule of the last compilation, e.g., to report its critical path. All passes are on the graphics queue if the graph runs on a single queue.
+        */
+        const QueueSchedule& getQueueSchedule() const { return mExecutionPlan.schedule; }
+
         /** Mouse event handler.
             Returns true if the event was handled by the object, false otherwise
         */
@@ -191,6 +207,12 @@ namespace Falcor
         bool resolveExecutionOrder();
         bool insertAutoPasses();
         bool resolveResourceTypes();
+        void buildExecutionPlan();
+        void buildBarrierPlan();
+        void buildQueueSchedule(const std::vector<std::vector<ResourceBarrierPlan::Access>>& passAccesses);
+        void issueBarriers(RenderContext* pContext, CopyContext* pQueueContext, uint32_t pass);
+        void waitForQueues(RenderContext* pContext, uint32_t pass, size_t& fence);
+        CopyContext* getQueueContext(RenderContext* pContext, QueueSchedule::Queue queue) const;
         
         struct EdgeData
         {
@@ -244,6 +266,34 @@ namespace Falcor
         std::vector<uint32_t> mExecutionList;
         ResourceCache::SharedPtr mpResourcesCache;
 
+        /** What execute() runs, built by compile(). The resources are resolved once per compilation, so executing does no name lookups.
+        */
+        struct ExecutionPlan
+        {
+            std::vector<RenderPass::SharedPtr> passes;
+            std::vector<RenderData> renderData;                                         ///< Parallel to `passes`
+            std::vector<HashedString> profileNames;                                     ///< Parallel to `passes`, hashed once for the profiler events
+            std::unordered_map<std::string, std::pair<uint32_t, uint32_t>> fieldSlots;  ///< `renderPassName.resourceName` to (index in `passes`, slot). Used to bind external inputs without recompiling.
+
+            // State transitions, issued in a batch before each pass. Passes still transition resources lazily, which is a no-op for the planned ones.
+            ResourceBarrierPlan barriers;
+            std::vector<std::pair<uint32_t, uint32_t>> barrierResources;               ///< The (pass, slot) each planned resource is read from, so external inputs bound after compilation are used
+            std::vector<bool> splitBegun;                                               ///< Per planned resource, whether the Begin half of a split transition was issued
+            bool barriersDirty = false;                                                 ///< Set by setInput() when a binding changes, the barriers are planned again before the next execution
+            std::vector<CopyContext::ResourceTransition> transitions;                   ///< Scratch space for issueBarriers()
+            std::vector<const Resource*> uavResources;                                  ///< Scratch space for issueBarriers()
+
+            // Async compute. The graphics queue executes the transitions the compute queue can't, which makes the compute pass wait on it (a handoff).
+            QueueSchedule schedule;
+            std::vector<bool> computeAffinity;                                          ///< Parallel to `passes`, whether to call executeCompute()
+            std::vector<uint64_t> signalValues;                                         ///< Parallel to `passes`, the fence value signaled after the pass, if the schedule signals
+            uint64_t frameStartValue = 0;                                               ///< The graphics fence value signaled at the start of execute(), for the fork
+            bool forkAtFrameStart = false;                                              ///< Whether the fork waits for the frame start rather than a graphics pass
+            bool handoff = false;                                                       ///< Scratch space for issueBarriers(), whether it recorded transitions on the graphics queue
+            std::vector<CopyContext::ResourceTransition> graphicsTransitions;           ///< Scratch space for issueBarriers()
+        };
+        ExecutionPlan mExecutionPlan;
+
         // TODO Better way to track history, or avoid changing the original graph altogether?
         struct {
             std::vector<std::string> generatedPasses;
@@ -251,6 +301,8 @@ namespace Falcor
         } mCompilationChanges;
 
         bool mProfileGraph = true;
+        bool mAsyncCompute = true;
+        ComputeContext::SharedPtr mpComputeContext;
         Dictionary::SharedPtr mpPassDictionary;
     };
 
@@ -0,0 +1,58 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "RenderPass.h"
+
+namespace Falcor
+{
+    RenderData::RenderData(const std::string& passName, const RenderPassReflection& reflection, const Dictionary::SharedPtr& pDict) : mName(passName), mpDictionary(pDict)
+    {
+        if (!mpDictionary) mpDictionary = Dictionary::create();
+
+        mFieldNames.resize(reflection.getFieldCount());
+        for (size_t i = 0; i < reflection.getFieldCount(); i++) mFieldNames[i] = reflection.getField(i).getName();
+        mResources.resize(mFieldNames.size());
+        mTextures.resize(mFieldNames.size());
+    }
+
+    uint32_t RenderData::getSlot(const std::string& name) const
+    {
+        for (size_t i = 0; i < mFieldNames.size(); i++)
+        {
+            if (mFieldNames[i] == name) return uint32_t(i);
+        }
+        return RenderPassReflection::kInvalidField;
+    }
+
+    void RenderData::setResource(uint32_t slot, const Resource::SharedPtr& pResource)
+    {
+        assert(slot < mResources.size());
+        mResources[slot] = pResource;
+        mTextures[slot] = std::dynamic_pointer_cast<Texture>(pResource);
+    }
+}
@@ -28,6 +28,7 @@
 #pragma once
 #include "RenderPassReflection.h"
 #include "ResourceCache.h"
+#include "QueueSchedule.h"
 #include "Utils/Dictionary.h"
 #include "API/Texture.h"
 
@@ -37,23 +38,55 @@ namespace Falcor
     class Texture;
     class Gui;
     class RenderContext;
+    class ComputeContext;
 
+    /** The resources bound to a render-pass' fields.
+        Built by RenderGraph::compile() and reused by every execute() call until the next compilation. The resources are stored in a dense array
+        indexed by slot, where the slot of a field is its index in the pass' RenderPassReflection (the order of the add*() calls).
+    */
     class RenderData
     {
     public:
-        RenderData(const std::string& passName, const ResourceCache::SharedPtr& pResourceCache, const Dictionary::SharedPtr& pDict) : mName(passName), mpResources(pResourceCache), mpDictionary(pDict) 
+        RenderData(const std::string& passName, const RenderPassReflection& reflection, const Dictionary::SharedPtr& pDict);
+
+        /** Get a texture by slot. Returns nullptr if the slot is out of range or nothing is bound to it.
+        */
+        const Texture::SharedPtr& getTexture(uint32_t slot) const
         {
-            if (!mpDictionary) mpDictionary = Dictionary::create();
+            static const Texture::SharedPtr pNull;
+            return (slot < mTextures.size()) ? mTextures[slot] : pNull;
         }
-        std::shared_ptr<Texture> getTexture(const std::string& name) const
+
+        /** Get a texture by field name. This searches the pass' field names, prefer the slot version in passes with many fields.
+        */
+        const Texture::SharedPtr& getTexture(const std::string& name) const { return getTexture(getSlot(name)); }
+
+        /** Get a resource by slot. Returns nullptr if the slot is out of range or nothing is bound to it.
+        */
+        const Resource::SharedPtr& getResource(uint32_t slot) const
         {
-            return std::dynamic_pointer_cast<Texture>(mpResources->getResource(mName + '.' + name));
+            static const Resource::SharedPtr pNull;
+            return (slot < mResources.size()) ? mResources[slot] : pNull;
         }
 
+        /** Get the slot of a field, or RenderPassReflection::kInvalidField if the pass has no such field
+        */
+        uint32_t getSlot(const std::string& name) const;
+
+        /** Get the number of slots, which is the pass' field count
+        */
+        uint32_t getSlotCount() const { return uint32_t(mResources.size()); }
+
+        const std::string& getName() const { return mName; }
         Dictionary& getDictionary() const { return (*mpDictionary); }
     protected:
-        const std::string& mName;
-        ResourceCache::SharedPtr mpResources;
+        friend class RenderGraph;
+        void setResource(uint32_t slot, const Resource::SharedPtr& pResource);
+
+        std::string mName;
+        std::vector<std::string> mFieldNames;
+        std::vector<Resource::SharedPtr> mResources;
+        std::vector<Texture::SharedPtr> mTextures;      ///< The same resources cast to textures when binding them, so getTexture() doesn't cast
         Dictionary::SharedPtr mpDictionary;
     };
 
@@ -71,6 +104,15 @@ namespace Falcor
         */
         virtual void execute(RenderContext* pRenderContext, const RenderData* pData) = 0;
 
+        /** Get the queue the pass prefers. When the device has an async-compute queue, RenderGraph executes passes with compute affinity on it, overlapping the graphics passes they don't depend on.
+        */
+        virtual QueueSchedule::Queue getQueueAffinity() const { return QueueSchedule::Queue::Graphics; }
+
+        /** Executes a pass with compute affinity. RenderGraph calls it instead of execute(), with the async-compute context, or with the graphics context if the graph runs on a single queue.
+            The pass can only dispatch and copy. The resources it reads through shader resource fields are in the NonPixelShader state.
+        */
+        virtual void executeCompute(ComputeContext* pContext, const RenderData* pData) { should_not_get_here(); }
+
         /** Get a dictionary that can be used to reconstruct the object
         */
         virtual Dictionary getScriptingDictionary() const { return {}; }
@@ -88,4 +88,12 @@ namespace Falcor
         throw std::runtime_error(error.c_str());
     }
 
-}
\ No newline at end of file
+    uint32_t RenderPassReflection::getFieldIndex(const std::string& name) const
+    {
+        for (size_t i = 0; i < mFields.size(); i++)
+        {
+            if (mFields[i].getName() == name) return uint32_t(i);
+        }
+        return kInvalidField;
+    }
+}
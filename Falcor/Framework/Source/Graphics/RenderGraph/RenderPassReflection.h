@@ -33,6 +33,8 @@ namespace Falcor
     class RenderPassReflection
     {
     public:
+        static const uint32_t kInvalidField = -1;
+
         /** Global render-pass flags
         */
         enum class Flags
@@ -110,6 +112,10 @@ namespace Falcor
         size_t getFieldCount() const { return mFields.size(); }
         const Field& getField(size_t f) const { return mFields[f]; }
         const Field& getField(const std::string& name, Field::Type type = Field::Type::None) const;
+
+        /** Get the index of a field, or kInvalidField if it doesn't exist. The index is the field's slot in RenderData.
+        */
+        uint32_t getFieldIndex(const std::string& name) const;
         Flags getFlags() const { return mFlags; }
     private:
         Field& addField(const std::string& name, Field::Type type);
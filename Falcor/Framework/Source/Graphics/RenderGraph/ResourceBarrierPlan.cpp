@@ -0,0 +1,121 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "ResourceBarrierPlan.h"
+
+namespace Falcor
+{
+    ResourceBarrierPlan ResourceBarrierPlan::build(uint32_t resourceCount, const std::vector<std::vector<Access>>& passAccesses)
+    {
+        struct Use
+        {
+            uint32_t pass;
+            Resource::State state;
+            bool write;
+        };
+
+        // Collect the uses of each resource in execution order, with a single use per pass
+        std::vector<std::vector<Use>> uses(resourceCount);
+        for (uint32_t pass = 0; pass < uint32_t(passAccesses.size()); pass++)
+        {
+            for (const Access& access : passAccesses[pass])
+            {
+                assert(access.resource < resourceCount);
+                auto& resourceUses = uses[access.resource];
+                if (resourceUses.size() && resourceUses.back().pass == pass)
+                {
+                    Use& use = resourceUses.back();
+                    if (access.write && !use.write) use = { pass, access.state, true };
+                    continue;
+                }
+                resourceUses.push_back({ pass, access.state, access.write });
+            }
+        }
+
+        ResourceBarrierPlan plan;
+        plan.mBatches.resize(passAccesses.size());
+        for (uint32_t r = 0; r < resourceCount; r++)
+        {
+            const auto& resourceUses = uses[r];
+            for (size_t u = 0; u < resourceUses.size(); u++)
+            {
+                const Use& curr = resourceUses[u];
+
+                // The first use follows the last use of the previous frame
+                const Use& prev = (u == 0) ? resourceUses.back() : resourceUses[u - 1];
+                if (prev.state != curr.state)
+                {
+                    uint32_t begin = (u == 0) ? 0 : prev.pass + 1;
+                    if (begin < curr.pass)
+                    {
+                        plan.mBatches[begin].push_back({ Barrier::Type::BeginSplit, r, prev.state, curr.state });
+                        plan.mBatches[curr.pass].push_back({ Barrier::Type::EndSplit, r, prev.state, curr.state });
+                    }
+                    else
+                    {
+                        plan.mBatches[curr.pass].push_back({ Barrier::Type::Transition, r, prev.state, curr.state });
+                    }
+                }
+                else if (u > 0 && curr.state == Resource::State::UnorderedAccess && (prev.write || curr.write))
+                {
+                    // Work from the previous frame is ordered by the frame boundary, so only order passes within a frame
+                    plan.mBatches[curr.pass].push_back({ Barrier::Type::Uav, r, curr.state, curr.state });
+                }
+            }
+        }
+        return plan;
+    }
+
+    uint32_t ResourceBarrierPlan::getBarrierCount() const
+    {
+        uint32_t count = 0;
+        for (const auto& batch : mBatches) count += uint32_t(batch.size());
+        return count;
+    }
+
+    std::string ResourceBarrierPlan::toString(const std::vector<std::string>& resourceNames) const
+    {
+        static const char* kTypeNames[] = { "transition", "begin", "end", "uav" };
+
+        std::string s;
+        for (size_t pass = 0; pass < mBatches.size(); pass++)
+        {
+            if (mBatches[pass].empty()) continue;
+            s += "pass " + std::to_string(pass) + ":";
+            for (const Barrier& b : mBatches[pass])
+            {
+                s += std::string(" ") + kTypeNames[uint32_t(b.type)] + " ";
+                s += (b.resource < resourceNames.size()) ? resourceNames[b.resource] : std::to_string(b.resource);
+                if (b.type != Barrier::Type::Uav) s += " " + to_string(b.before) + "->" + to_string(b.after);
+                s += ";";
+            }
+            s += "\n";
+        }
+        return s;
+    }
+}
@@ -0,0 +1,95 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "API/Resource.h"
+#include <vector>
+#include <string>
+
+namespace Falcor
+{
+    /** Plans the resource state transitions of a frame from the resources each pass uses, in execution order.
+        RenderGraph builds it when compiling and issues each pass' barriers in a single batch before the pass executes.
+        The plan assumes a steady state, where a resource starts the frame in the state of its last use in the previous frame. When a resource is
+        idle between two uses in different states, the transition is split: it begins right after the first use and ends right before the second one.
+        The plan is CPU only. It doesn't know the actual resource states, the caller has to handle resources that are not in the planned state (e.g., on the first frame).
+    */
+    class ResourceBarrierPlan
+    {
+    public:
+        /** A pass' use of a resource
+        */
+        struct Access
+        {
+            uint32_t resource;      ///< Index of the resource, in [0, resourceCount)
+            Resource::State state;  ///< The state the pass needs the resource in
+            bool write;             ///< Whether the pass writes to the resource
+        };
+
+        struct Barrier
+        {
+            enum class Type
+            {
+                Transition,     ///< A complete transition
+                BeginSplit,     ///< The first half of a split transition
+                EndSplit,       ///< The second half of a split transition, in a later batch than its BeginSplit
+                Uav,            ///< A UAV barrier between two passes accessing a resource as UnorderedAccess, at least one of them writing
+            };
+
+            Type type;
+            uint32_t resource;
+            Resource::State before;
+            Resource::State after;
+        };
+
+        /** Build a plan.
+            \param[in] resourceCount The number of resources
+            \param[in] passAccesses The resources used by each pass, in execution order. If a pass lists a resource more than once, a write access takes precedence.
+        */
+        static ResourceBarrierPlan build(uint32_t resourceCount, const std::vector<std::vector<Access>>& passAccesses);
+
+        /** Get the barriers to issue before a pass executes
+        */
+        const std::vector<Barrier>& getBarriers(uint32_t pass) const { return mBatches[pass]; }
+
+        /** Get the number of passes
+        */
+        uint32_t getPassCount() const { return uint32_t(mBatches.size()); }
+
+        /** Get the total number of barriers in the plan, counting each half of a split transition
+        */
+        uint32_t getBarrierCount() const;
+
+        /** Get a human-readable dump of the plan, one batch per line
+            \param[in] resourceNames Optional names for the resources. Indices are printed if empty.
+        */
+        std::string toString(const std::vector<std::string>& resourceNames = {}) const;
+
+    private:
+        std::vector<std::vector<Barrier>> mBatches;
+    };
+}
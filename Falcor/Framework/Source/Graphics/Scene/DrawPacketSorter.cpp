@@ -0,0 +1,106 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "DrawPacketSorter.h"
+
+namespace Falcor
+{
+    uint64_t DrawPacketSorter::createKey(uint32_t pass, uint32_t materialID, uint32_t vaoID, uint32_t instanceID, float depth)
+    {
+        const uint32_t maxBucket = (1u << kDepthBits) - 1;
+        depth = (depth > 0) ? depth : 0;    // Also catches NaNs
+        uint32_t bucket = (depth >= 1) ? maxBucket : uint32_t(depth * maxBucket);
+
+        uint64_t key = uint64_t(pass & ((1u << kPassBits) - 1));
+        key = (key << kMaterialBits) | (materialID & ((1u << kMaterialBits) - 1));
+        key = (key << kVaoBits) | (vaoID & ((1u << kVaoBits) - 1));
+        key = (key << kInstanceBits) | (instanceID & ((1u << kInstanceBits) - 1));
+        key = (key << kDepthBits) | bucket;
+        return key;
+    }
+
+    void DrawPacketSorter::clear()
+    {
+        mKeys.clear();
+        mPayloads.clear();
+    }
+
+    void DrawPacketSorter::addPacket(uint64_t key, uint32_t payload)
+    {
+        mKeys.push_back(key);
+        mPayloads.push_back(payload);
+    }
+
+    void DrawPacketSorter::sort()
+    {
+        const size_t count = mKeys.size();
+        if (count < 2) return;
+
+        // Build the histograms of all the digits in a single pass
+        const uint32_t kDigitCount = sizeof(uint64_t);
+        mHistograms.assign(kDigitCount * 256, 0);
+        for (uint64_t key : mKeys)
+        {
+            for (uint32_t d = 0; d < kDigitCount; d++)
+            {
+                mHistograms[d * 256 + ((key >> (d * 8)) & 0xFF)]++;
+            }
+        }
+
+        mTempKeys.resize(count);
+        mTempPayloads.resize(count);
+
+        for (uint32_t d = 0; d < kDigitCount; d++)
+        {
+            uint32_t* pHistogram = mHistograms.data() + d * 256;
+
+            // If all keys share this digit the pass wouldn't change the order
+            uint32_t firstDigit = uint32_t((mKeys[0] >> (d * 8)) & 0xFF);
+            if (pHistogram[firstDigit] == count) continue;
+
+            // Exclusive prefix sum
+            uint32_t offset = 0;
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t c = pHistogram[i];
+                pHistogram[i] = offset;
+                offset += c;
+            }
+
+            for (size_t i = 0; i < count; i++)
+            {
+                uint32_t digit = uint32_t((mKeys[i] >> (d * 8)) & 0xFF);
+                uint32_t dst = pHistogram[digit]++;
+                mTempKeys[dst] = mKeys[i];
+                mTempPayloads[dst] = mPayloads[i];
+            }
+            mKeys.swap(mTempKeys);
+            mPayloads.swap(mTempPayloads);
+        }
+    }
+}
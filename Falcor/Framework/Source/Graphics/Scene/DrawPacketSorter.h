@@ -0,0 +1,85 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+
+namespace Falcor
+{
+    /** Collects draw packets and sorts them by a 64-bit key.
+        The key packs, from the most significant bits: pass, material ID, VAO ID, instance ID and a depth bucket. Submitting the packets in key order groups draws sharing the same state, keeps the draws of a model instance together so they can be instanced, and orders the draws front-to-back inside each group.
+        Each packet carries a 32-bit payload identifying the draw.
+    */
+    class DrawPacketSorter
+    {
+    public:
+        static const uint32_t kPassBits = 4;
+        static const uint32_t kMaterialBits = 18;
+        static const uint32_t kVaoBits = 18;
+        static const uint32_t kInstanceBits = 12;
+        static const uint32_t kDepthBits = 12;
+
+        /** Create a sort key. IDs are truncated to their bit count, so IDs which are equal modulo 2^bits share a group.
+            \param[in] pass The pass index. Lower passes are drawn first.
+            \param[in] materialID The material ID
+            \param[in] vaoID The vertex array ID
+            \param[in] instanceID Identifies the model instance
+            \param[in] depth Normalized depth. Clamped to [0, 1].
+        */
+        static uint64_t createKey(uint32_t pass, uint32_t materialID, uint32_t vaoID, uint32_t instanceID, float depth);
+
+        static uint32_t getPass(uint64_t key) { return uint32_t(key >> (kMaterialBits + kVaoBits + kInstanceBits + kDepthBits)); }
+        static uint32_t getMaterialID(uint64_t key) { return uint32_t(key >> (kVaoBits + kInstanceBits + kDepthBits)) & ((1u << kMaterialBits) - 1); }
+        static uint32_t getVaoID(uint64_t key) { return uint32_t(key >> (kInstanceBits + kDepthBits)) & ((1u << kVaoBits) - 1); }
+        static uint32_t getInstanceID(uint64_t key) { return uint32_t(key >> kDepthBits) & ((1u << kInstanceBits) - 1); }
+        static uint32_t getDepthBucket(uint64_t key) { return uint32_t(key) & ((1u << kDepthBits) - 1); }
+
+        /** Remove all the packets. Keeps the allocations.
+        */
+        void clear();
+
+        /** Add a packet
+        */
+        void addPacket(uint64_t key, uint32_t payload);
+
+        /** Sort the packets by key. The sort is stable, packets with the same key keep the order they were added in.
+            Uses an LSD radix sort on 8-bit digits. Digits which are the same in all the keys are skipped.
+        */
+        void sort();
+
+        uint32_t getCount() const { return (uint32_t)mKeys.size(); }
+        uint64_t getKey(uint32_t index) const { return mKeys[index]; }
+        uint32_t getPayload(uint32_t index) const { return mPayloads[index]; }
+
+    private:
+        std::vector<uint64_t> mKeys;
+        std::vector<uint32_t> mPayloads;
+        std::vector<uint64_t> mTempKeys;
+        std::vector<uint32_t> mTempPayloads;
+        std::vector<uint32_t> mHistograms;
+    };
+}
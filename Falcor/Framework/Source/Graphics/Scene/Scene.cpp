@@ -114,12 +114,15 @@ namespace Falcor
             }
         }
 
+        std::vector<Model*> models;
+        models.reserve(mModels.size());
         for (uint32_t i = 0; i < mModels.size(); i++)
         {
-            if (mModels[i][0]->getObject()->animate(currentTime))
-            {
-                changed = true;
-            }
+            models.push_back(mModels[i][0]->getObject().get());
+        }
+        if (Model::animateModels(models, currentTime))
+        {
+            changed = true;
         }
 
         mExtentsDirty = mExtentsDirty || changed;
@@ -366,4 +369,102 @@ namespace Falcor
     {
         for (auto& c : mCameras) c->setAspectRatio(ratio);
     }
+
+    bool Scene::isMeshInstanceBoundsLayoutDirty() const
+    {
+        if (mMeshInstanceBoundsLayout.size() != getModelCount()) return true;
+        for (uint32_t modelID = 0; modelID < getModelCount(); modelID++)
+        {
+            const auto& layout = mMeshInstanceBoundsLayout[modelID];
+            const Model* pModel = getModel(modelID).get();
+            if (layout.pModel.get() != pModel || layout.instanceCount != getModelInstanceCount(modelID) || layout.meshOffset.size() != pModel->getMeshCount()) return true;
+
+            uint32_t meshInstanceCount = 0;
+            for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++) meshInstanceCount += pModel->getMeshInstanceCount(meshID);
+            if (layout.meshInstanceCount != meshInstanceCount) return true;
+
+            // The counts can match after an instance was replaced, so compare every slot
+            uint32_t entry = layout.base;
+            for (uint32_t instanceID = 0; instanceID < layout.instanceCount; instanceID++)
+            {
+                const ModelInstance* pModelInstance = getModelInstance(modelID, instanceID).get();
+                for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+                {
+                    for (uint32_t meshInstanceID = 0; meshInstanceID < pModel->getMeshInstanceCount(meshID); meshInstanceID++, entry++)
+                    {
+                        const auto& cached = mMeshInstanceBoundsEntries[entry];
+                        if (cached.pModelInstance.get() != pModelInstance || cached.pMeshInstance != pModel->getMeshInstance(meshID, meshInstanceID)) return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    const BoundingBoxSoA& Scene::getMeshInstanceBounds()
+    {
+        if (isMeshInstanceBoundsLayoutDirty())
+        {
+            mMeshInstanceBoundsLayout.resize(getModelCount());
+            mMeshInstanceBoundsEntries.clear();
+
+            for (uint32_t modelID = 0; modelID < getModelCount(); modelID++)
+            {
+                const Model* pModel = getModel(modelID).get();
+                auto& layout = mMeshInstanceBoundsLayout[modelID];
+                layout.pModel = getModel(modelID);
+                layout.instanceCount = getModelInstanceCount(modelID);
+                layout.base = (uint32_t)mMeshInstanceBoundsEntries.size();
+                layout.meshOffset.resize(pModel->getMeshCount());
+                layout.meshInstanceCount = 0;
+                for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+                {
+                    layout.meshOffset[meshID] = layout.meshInstanceCount;
+                    layout.meshInstanceCount += pModel->getMeshInstanceCount(meshID);
+                }
+
+                for (uint32_t instanceID = 0; instanceID < layout.instanceCount; instanceID++)
+                {
+                    const ModelInstance::SharedPtr& pModelInstance = getModelInstance(modelID, instanceID);
+                    for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+                    {
+                        for (uint32_t meshInstanceID = 0; meshInstanceID < pModel->getMeshInstanceCount(meshID); meshInstanceID++)
+                        {
+                            MeshInstanceBoundsEntry entry;
+                            entry.pModelInstance = pModelInstance;
+                            entry.pMeshInstance = pModel->getMeshInstance(meshID, meshInstanceID);
+                            // Make sure the box is computed below
+                            entry.modelInstanceVersion = pModelInstance->getTransformVersion() - 1;
+                            entry.meshInstanceVersion = entry.pMeshInstance->getTransformVersion();
+                            mMeshInstanceBoundsEntries.push_back(entry);
+                        }
+                    }
+                }
+            }
+            mMeshInstanceBounds.resize((uint32_t)mMeshInstanceBoundsEntries.size());
+        }
+
+        // Only recompute the boxes of the instances that moved
+        for (uint32_t i = 0; i < (uint32_t)mMeshInstanceBoundsEntries.size(); i++)
+        {
+            auto& entry = mMeshInstanceBoundsEntries[i];
+            uint32_t modelInstanceVersion = entry.pModelInstance->getTransformVersion();
+            uint32_t meshInstanceVersion = entry.pMeshInstance->getTransformVersion();
+            if (entry.modelInstanceVersion != modelInstanceVersion || entry.meshInstanceVersion != meshInstanceVersion)
+            {
+                entry.modelInstanceVersion = modelInstanceVersion;
+                entry.meshInstanceVersion = meshInstanceVersion;
+                mMeshInstanceBounds.set(i, entry.pMeshInstance->getBoundingBox().transform(entry.pModelInstance->getTransformMatrix()));
+            }
+        }
+
+        return mMeshInstanceBounds;
+    }
+
+    uint32_t Scene::getMeshInstanceBoundsBase(uint32_t modelID, uint32_t modelInstanceID, uint32_t meshID) const
+    {
+        assert(modelID < mMeshInstanceBoundsLayout.size());
+        const auto& layout = mMeshInstanceBoundsLayout[modelID];
+        return layout.base + modelInstanceID * layout.meshInstanceCount + layout.meshOffset[meshID];
+    }
 }
@@ -37,6 +37,7 @@
 #include "Graphics/Paths/ObjectPath.h"
 #include "Graphics/Model/ObjectInstance.h"
 #include "Graphics/Model/SkinningCache.h"
+#include "Utils/Math/FrustumCulling.h"
 
 namespace Falcor
 {
@@ -229,6 +230,16 @@ namespace Falcor
         /** Set a new aspect ratio for all the cameras in the scene
         */
         void setCamerasAspectRatio(float ratio);
+
+        /** Get the world-space bounding boxes of all the mesh instances in the scene.
+            The boxes are ordered by model, model instance, mesh and mesh instance. Only the boxes of instances that moved since the last call are recomputed.
+        */
+        const BoundingBoxSoA& getMeshInstanceBounds();
+
+        /** Get the index of the first box of a mesh in the array returned by getMeshInstanceBounds(). The boxes of the mesh instances are consecutive.
+            Only valid after getMeshInstanceBounds() was called, as long as no models or instances were added or removed.
+        */
+        uint32_t getMeshInstanceBoundsBase(uint32_t modelID, uint32_t modelInstanceID, uint32_t meshID) const;
     protected:
 
         Scene();
@@ -237,6 +248,10 @@ namespace Falcor
         */
         void updateExtents();
 
+        /** Check if models, model instances or mesh instances were added or removed since the mesh instance bounds were created
+        */
+        bool isMeshInstanceBoundsLayoutDirty() const;
+
         static uint32_t sSceneCounter;
 
         uint32_t mId;
@@ -260,6 +275,27 @@ namespace Falcor
 
         bool mExtentsDirty = true;
 
+        struct MeshInstanceBoundsLayout
+        {
+            Model::SharedPtr pModel;            ///< Keeps the model alive, so the layout check can compare model addresses
+            uint32_t instanceCount;             ///< Number of model instances
+            uint32_t meshInstanceCount;         ///< Number of mesh instances in a single model instance
+            uint32_t base;                      ///< Index of the first box of the model
+            std::vector<uint32_t> meshOffset;   ///< Offset of each mesh inside a model instance
+        };
+
+        struct MeshInstanceBoundsEntry
+        {
+            ModelInstance::SharedPtr pModelInstance;        ///< Shared, so a replaced instance can't be freed while it's cached
+            Model::MeshInstance::SharedPtr pMeshInstance;
+            uint32_t modelInstanceVersion;
+            uint32_t meshInstanceVersion;
+        };
+
+        std::vector<MeshInstanceBoundsLayout> mMeshInstanceBoundsLayout;
+        std::vector<MeshInstanceBoundsEntry> mMeshInstanceBoundsEntries;
+        BoundingBoxSoA mMeshInstanceBounds;
+
         std::string mFilename;
 
         using string_uservar_map = std::map<const std::string, UserVariable>;
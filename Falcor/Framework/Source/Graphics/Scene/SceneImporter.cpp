@@ -1024,6 +1024,11 @@ namespace Falcor
                 mScene.createAreaLights();
             }
 
+            if (is_set(mModelLoadFlags, Model::LoadFlags::CompressVertices))
+            {
+                logVertexMemory();
+            }
+
             return true;
         }
         else
@@ -1032,6 +1037,27 @@ namespace Falcor
         }
     }
 
+    void SceneImporter::logVertexMemory()
+    {
+        size_t vertexBytes = 0;
+        size_t uncompressedBytes = 0;
+        for (uint32_t modelID = 0; modelID < mScene.getModelCount(); modelID++)
+        {
+            const Model* pModel = mScene.getModel(modelID).get();
+            for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+            {
+                const Mesh* pMesh = pModel->getMesh(meshID).get();
+                vertexBytes += pMesh->getVertexBufferSize();
+                uncompressedBytes += pMesh->getUncompressedVertexBufferSize();
+            }
+        }
+
+        const double kMB = 1024.0 * 1024.0;
+        double saved = uncompressedBytes ? 100.0 * (1.0 - double(vertexBytes) / double(uncompressedBytes)) : 0.0;
+        logInfo("Vertex buffers of " + mFilename + ": " + std::to_string(vertexBytes / kMB) + " MB, " + std::to_string(uncompressedBytes / kMB) +
+            " MB uncompressed (" + std::to_string(saved) + "% saved)");
+    }
+
     bool SceneImporter::parseAmbientIntensity(const rapidjson::Value& jsonVal)
     {
         logWarning("SceneImporter: Global ambient term is no longer supported. Ignoring value.");
@@ -62,6 +62,7 @@ namespace Falcor
         bool parseEnvMap(const rapidjson::Value& jsonVal);
 
         bool topLevelLoop();
+        void logVertexMemory();
 
         bool loadIncludeFile(const std::string& Include);
 
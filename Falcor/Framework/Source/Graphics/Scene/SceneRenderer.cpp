@@ -36,6 +36,7 @@
 #include "VR/OpenVR/VRSystem.h"
 #include "API/Device.h"
 #include "glm/matrix.hpp"
+#include <algorithm>
 
 namespace Falcor
 {
@@ -48,6 +49,9 @@ namespace Falcor
     size_t SceneRenderer::sWorldInvTransposeMatOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sMeshIdOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sDrawIDOffset = ConstantBuffer::kInvalidOffset;
+    size_t SceneRenderer::sPositionScaleOffset = ConstantBuffer::kInvalidOffset;
+    size_t SceneRenderer::sPositionOffsetOffset = ConstantBuffer::kInvalidOffset;
+    size_t SceneRenderer::sVertexCompressionOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sLightCountOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sLightArrayOffset = ConstantBuffer::kInvalidOffset;
 
@@ -91,6 +95,9 @@ namespace Falcor
                 sMeshIdOffset = pType->findMember("gMeshId")->getOffset();
                 sDrawIDOffset = pType->findMember("gDrawId[0]")->getOffset();
                 sPrevWorldMatOffset = pType->findMember("gPrevWorldMat[0]")->getOffset();
+                sPositionScaleOffset = pType->findMember("gPositionScale")->getOffset();
+                sPositionOffsetOffset = pType->findMember("gPositionOffset")->getOffset();
+                sVertexCompressionOffset = pType->findMember("gVertexCompression")->getOffset();
             }
         }
 
@@ -223,6 +230,12 @@ namespace Falcor
 
             // Set mesh id
             pCB->setVariable(sMeshIdOffset, pMesh->getId());
+
+            // Decoding of compressed vertices
+            const VertexCompression::PositionQuantization& quantization = pMesh->getPositionQuantization();
+            pCB->setVariable(sPositionScaleOffset, quantization.scale);
+            pCB->setVariable(sPositionOffsetOffset, quantization.offset);
+            pCB->setVariable(sVertexCompressionOffset, pMesh->getVertexCompressionFlags());
         }
 
         return true;
@@ -240,27 +253,43 @@ namespace Falcor
         currentData.pContext->drawIndexedInstanced(indexCount, instanceCount, 0, 0, 0);
     }
 
-    void SceneRenderer::draw(CurrentWorkingData& currentData, const Mesh* pMesh, uint32_t instanceCount)
+    bool SceneRenderer::bindMaterial(CurrentWorkingData& currentData, const Material* pMaterial)
     {
-        currentData.pMaterial = pMesh->getMaterial().get();
-        // Bind material
-        if(mpLastMaterial != pMesh->getMaterial().get())
+        currentData.pMaterial = pMaterial;
+        if (mpLastMaterial != pMaterial)
         {
-            if (setPerMaterialData(currentData, currentData.pMaterial) == false)
+            if (setPerMaterialData(currentData, pMaterial) == false)
             {
-                return;
+                return false;
             }
-            mpLastMaterial = pMesh->getMaterial().get();
+            mpLastMaterial = pMaterial;
+            mDrawStats.materialChangeCount++;
 
             if(mCompileMaterialWithProgram)
             {
                 currentData.pState->getProgram()->addDefine("_MS_STATIC_MATERIAL_FLAGS", std::to_string(mpLastMaterial->getFlags()));
             }
         }
+        return true;
+    }
+
+    void SceneRenderer::draw(CurrentWorkingData& currentData, const Mesh* pMesh, uint32_t instanceCount)
+    {
+        // Bind material
+        if (bindMaterial(currentData, pMesh->getMaterial().get()) == false)
+        {
+            return;
+        }
 
         executeDraw(currentData, pMesh->getIndexCount(), instanceCount);
         postFlushDraw(currentData);
-        currentData.pState->getProgram()->removeDefine("_MS_STATIC_MATERIAL_FLAGS");
+        mDrawStats.drawCallCount++;
+
+        // The sorted path keeps the material define until the material changes
+        if (mSortDraws == false)
+        {
+            currentData.pState->getProgram()->removeDefine("_MS_STATIC_MATERIAL_FLAGS");
+        }
     }
 
     void SceneRenderer::postFlushDraw(const CurrentWorkingData& currentData)
@@ -268,10 +297,20 @@ namespace Falcor
 
     }
 
-    bool SceneRenderer::cullMeshInstance(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance)
+    uint32_t SceneRenderer::getVisibleMeshInstances(const CurrentWorkingData& currentData, uint32_t meshID, const uint32_t*& pVisible, uint32_t& boundsBase) const
     {
-        BoundingBox box = pMeshInstance->getBoundingBox().transform(pModelInstance->getTransformMatrix());
-        return currentData.pCamera->isObjectCulled(box);
+        pVisible = nullptr;
+        boundsBase = 0;
+        const uint32_t instanceCount = currentData.pModel->getMeshInstanceCount(meshID);
+        if (currentData.pVisibleMeshInstances == nullptr) return instanceCount;
+
+        // The visible list is sorted and the instances of a mesh are consecutive
+        const auto& visible = *currentData.pVisibleMeshInstances;
+        boundsBase = mpScene->getMeshInstanceBoundsBase(currentData.modelID, currentData.modelInstanceID, meshID);
+        auto first = std::lower_bound(visible.begin(), visible.end(), boundsBase);
+        auto last = std::lower_bound(first, visible.end(), boundsBase + instanceCount);
+        pVisible = visible.data() + (first - visible.begin());
+        return (uint32_t)(last - first);
     }
 
     void SceneRenderer::renderMeshInstances(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, uint32_t meshID)
@@ -279,6 +318,11 @@ namespace Falcor
         const Model* pModel = currentData.pModel;
         const Mesh* pMesh = pModel->getMesh(meshID).get();
 
+        const uint32_t* pVisible;
+        uint32_t boundsBase;
+        uint32_t visibleCount = getVisibleMeshInstances(currentData, meshID, pVisible, boundsBase);
+        if (visibleCount == 0) return;
+
         if (setPerMeshData(currentData, pMesh))
         {
             Program* pProgram = currentData.pState->getProgram().get();
@@ -290,30 +334,29 @@ namespace Falcor
 
             // Bind VAO and set topology            
             currentData.pState->setVao(useVsSkinning ? pMesh->getVao() : pModel->getMeshVao(pMesh));
+            mDrawStats.vaoChangeCount++;
 
             uint32_t activeInstances = 0;
 
-            const uint32_t instanceCount = pModel->getMeshInstanceCount(meshID);
-            for (uint32_t instanceID = 0; instanceID < instanceCount; instanceID++)
+            for (uint32_t i = 0; i < visibleCount; i++)
             {
+                uint32_t instanceID = pVisible ? pVisible[i] - boundsBase : i;
                 const Model::MeshInstance* pMeshInstance = pModel->getMeshInstance(meshID, instanceID).get();
 
                 if (pMeshInstance->isVisible())
                 {
-                    if ((mCullEnabled == false) || (cullMeshInstance(currentData, pModelInstance, pMeshInstance) == false))
+                    if (setPerMeshInstanceData(currentData, pModelInstance, pMeshInstance, activeInstances))
                     {
-                        if (setPerMeshInstanceData(currentData, pModelInstance, pMeshInstance, activeInstances))
-                        {
-                            currentData.drawID++;
-                            activeInstances++;
+                        currentData.drawID++;
+                        activeInstances++;
+                        mDrawStats.meshInstanceCount++;
 
-                            if (activeInstances == mMaxInstanceCount)
-                            {
-                                // DISABLED_FOR_D3D12
-                                //pContext->setProgram(currentData.pProgram->getActiveProgramVersion());
-                                draw(currentData, pMesh, activeInstances);
-                                activeInstances = 0;
-                            }
+                        if (activeInstances == mMaxInstanceCount)
+                        {
+                            // DISABLED_FOR_D3D12
+                            //pContext->setProgram(currentData.pProgram->getActiveProgramVersion());
+                            draw(currentData, pMesh, activeInstances);
+                            activeInstances = 0;
                         }
                     }
                 }
@@ -352,29 +395,243 @@ namespace Falcor
         renderScene(pContext, mpScene->getActiveCamera().get());
     }
 
-    void SceneRenderer::renderScene(CurrentWorkingData& currentData)
+    void SceneRenderer::cullScene(CurrentWorkingData& currentData)
     {
-        setPerFrameData(currentData);
+        currentData.pVisibleMeshInstances = nullptr;
+        if (mCullEnabled == false || currentData.pCamera == nullptr) return;
+
+        // Test all the mesh instances at once. The per-mesh loops only walk the visible ones
+        FrustumCulling::Planes planes;
+        for (uint32_t i = 0; i < 6; i++) planes[i] = currentData.pCamera->getFrustumPlane(i);
+        FrustumCulling::cull(planes, mpScene->getMeshInstanceBounds(), mVisibleMeshInstances);
+        currentData.pVisibleMeshInstances = &mVisibleMeshInstances;
+    }
+
+    void SceneRenderer::buildDrawPackets(const CurrentWorkingData& currentData)
+    {
+        mDrawItems.clear();
+        mPacketSorter.clear();
+
+        const BoundingBoxSoA& bounds = mpScene->getMeshInstanceBounds();
+
+        // Depth is the distance along the view direction, normalized by the far plane
+        glm::vec3 cameraPos(0);
+        glm::vec3 cameraDir(0);
+        float invFarZ = 0;
+        if (currentData.pCamera)
+        {
+            cameraPos = currentData.pCamera->getPosition();
+            cameraDir = glm::normalize(currentData.pCamera->getTarget() - cameraPos);
+            invFarZ = 1.0f / currentData.pCamera->getFarPlane();
+        }
 
+        CurrentWorkingData data = currentData;
+        uint32_t sortInstanceID = 0;    // Running index of the model instances, groups the draws of an instance in the sort key
         for (uint32_t modelID = 0; modelID < mpScene->getModelCount(); modelID++)
         {
-            currentData.pModel = mpScene->getModel(modelID).get();
+            const Model* pModel = mpScene->getModel(modelID).get();
+            data.pModel = pModel;
+            data.modelID = modelID;
 
-            if (setPerModelData(currentData))
+            for (uint32_t instanceID = 0; instanceID < mpScene->getModelInstanceCount(modelID); instanceID++, sortInstanceID++)
             {
-                for (uint32_t instanceID = 0; instanceID < mpScene->getModelInstanceCount(modelID); instanceID++)
+                if (mpScene->getModelInstance(modelID, instanceID)->isVisible() == false) continue;
+                data.modelInstanceID = instanceID;
+
+                for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
                 {
-                    const auto pInstance = mpScene->getModelInstance(modelID, instanceID).get();
-                    if (pInstance->isVisible())
+                    const Mesh* pMesh = pModel->getMesh(meshID).get();
+                    const Material* pMaterial = pMesh->getMaterial().get();
+                    uint32_t pass = (pMaterial->getAlphaMode() == AlphaModeMask) ? 1 : 0;  // Draw alpha-tested geometry after the opaque occluders
+
+                    const uint32_t* pVisible;
+                    uint32_t visibleBase;
+                    uint32_t visibleCount = getVisibleMeshInstances(data, meshID, pVisible, visibleBase);
+                    uint32_t boundsBase = mpScene->getMeshInstanceBoundsBase(modelID, instanceID, meshID);
+
+                    for (uint32_t i = 0; i < visibleCount; i++)
                     {
-                        if (setPerModelInstanceData(currentData, pInstance, instanceID))
+                        uint32_t meshInstanceID = pVisible ? pVisible[i] - visibleBase : i;
+                        if (pModel->getMeshInstance(meshID, meshInstanceID)->isVisible() == false) continue;
+
+                        uint32_t b = boundsBase + meshInstanceID;
+                        glm::vec3 center(bounds.getCenterX()[b], bounds.getCenterY()[b], bounds.getCenterZ()[b]);
+                        float depth = glm::dot(center - cameraPos, cameraDir) * invFarZ;
+
+                        mPacketSorter.addPacket(DrawPacketSorter::createKey(pass, pMaterial->getId(), pMesh->getId(), sortInstanceID, depth), (uint32_t)mDrawItems.size());
+                        mDrawItems.push_back({ modelID, instanceID, meshID, meshInstanceID });
+                    }
+                }
+            }
+        }
+    }
+
+    void SceneRenderer::restoreSortedProgramState(CurrentWorkingData& currentData, bool& vsSkinning)
+    {
+        Program* pProgram = currentData.pState->getProgram().get();
+        pProgram->removeDefine("_MS_STATIC_MATERIAL_FLAGS");
+        if (vsSkinning)
+        {
+            pProgram->removeDefine("_VERTEX_BLENDING");
+            vsSkinning = false;
+        }
+        mpLastMaterial = nullptr;
+    }
+
+    void SceneRenderer::renderSortedScene(CurrentWorkingData& currentData)
+    {
+        auto buildStart = CpuTimer::getCurrentTimePoint();
+        buildDrawPackets(currentData);
+        auto sortStart = CpuTimer::getCurrentTimePoint();
+        mPacketSorter.sort();
+        mDrawStats.buildTime = CpuTimer::calcDuration(buildStart, sortStart);
+        mDrawStats.sortTime = CpuTimer::calcDuration(sortStart, CpuTimer::getCurrentTimePoint());
+
+        static const uint32_t kInvalidID = uint32_t(-1);
+        uint32_t modelID = kInvalidID;
+        uint32_t modelInstanceID = kInvalidID;
+        uint32_t meshID = kInvalidID;
+        bool modelValid = false;
+        bool instanceValid = false;
+        bool meshValid = false;
+        bool vsSkinning = false;
+        const Scene::ModelInstance* pModelInstance = nullptr;
+        const Mesh* pMesh = nullptr;
+        const Vao* pLastVao = nullptr;
+        uint32_t activeInstances = 0;
+        mpLastMaterial = nullptr;
+
+        for (uint32_t i = 0; i < mPacketSorter.getCount(); i++)
+        {
+            const DrawItem& item = mDrawItems[mPacketSorter.getPayload(i)];
+            const bool modelChanged = (item.modelID != modelID);
+            const bool instanceChanged = modelChanged || (item.modelInstanceID != modelInstanceID);
+            const bool meshChanged = instanceChanged || (item.meshID != meshID);
+
+            if (meshChanged && activeInstances != 0)
+            {
+                draw(currentData, pMesh, activeInstances);
+                activeInstances = 0;
+            }
+
+            if (modelChanged)
+            {
+                // The model callbacks may change the program, so don't carry the program state over.
+                // Model instances only set per-instance data, so the material stays bound across instances.
+                restoreSortedProgramState(currentData, vsSkinning);
+            }
+
+            if (modelChanged)
+            {
+                modelID = item.modelID;
+                modelInstanceID = kInvalidID;
+                currentData.modelID = modelID;
+                currentData.pModel = mpScene->getModel(modelID).get();
+                modelValid = setPerModelData(currentData);
+                mDrawStats.modelChangeCount++;
+            }
+            if (modelValid == false) continue;
+
+            if (instanceChanged)
+            {
+                modelInstanceID = item.modelInstanceID;
+                meshID = kInvalidID;
+                currentData.modelInstanceID = modelInstanceID;
+                pModelInstance = mpScene->getModelInstance(modelID, modelInstanceID).get();
+                instanceValid = setPerModelInstanceData(currentData, pModelInstance, modelInstanceID);
+                mDrawStats.modelInstanceChangeCount++;
+            }
+            if (instanceValid == false) continue;
+
+            if (meshChanged)
+            {
+                meshID = item.meshID;
+                pMesh = currentData.pModel->getMesh(meshID).get();
+                meshValid = setPerMeshData(currentData, pMesh);
+                if (meshValid)
+                {
+                    bool useVsSkinning = pMesh->hasBones() && !currentData.pModel->getSkinningCache();
+                    if (useVsSkinning != vsSkinning)
+                    {
+                        Program* pProgram = currentData.pState->getProgram().get();
+                        if (useVsSkinning) pProgram->addDefine("_VERTEX_BLENDING");
+                        else pProgram->removeDefine("_VERTEX_BLENDING");
+                        vsSkinning = useVsSkinning;
+                    }
+
+                    Vao::SharedPtr pVao = useVsSkinning ? pMesh->getVao() : currentData.pModel->getMeshVao(pMesh);
+                    if (pVao.get() != pLastVao)
+                    {
+                        currentData.pState->setVao(pVao);
+                        pLastVao = pVao.get();
+                        mDrawStats.vaoChangeCount++;
+                    }
+                }
+            }
+            if (meshValid == false) continue;
+
+            const Model::MeshInstance* pMeshInstance = currentData.pModel->getMeshInstance(meshID, item.meshInstanceID).get();
+            if (setPerMeshInstanceData(currentData, pModelInstance, pMeshInstance, activeInstances))
+            {
+                currentData.drawID++;
+                activeInstances++;
+                mDrawStats.meshInstanceCount++;
+
+                if (activeInstances == mMaxInstanceCount)
+                {
+                    draw(currentData, pMesh, activeInstances);
+                    activeInstances = 0;
+                }
+            }
+        }
+
+        if (activeInstances != 0)
+        {
+            draw(currentData, pMesh, activeInstances);
+        }
+        restoreSortedProgramState(currentData, vsSkinning);
+    }
+
+    void SceneRenderer::renderScene(CurrentWorkingData& currentData)
+    {
+        auto start = CpuTimer::getCurrentTimePoint();
+        mDrawStats = DrawStats();
+
+        setPerFrameData(currentData);
+        cullScene(currentData);
+
+        if (mSortDraws)
+        {
+            renderSortedScene(currentData);
+        }
+        else
+        {
+            for (uint32_t modelID = 0; modelID < mpScene->getModelCount(); modelID++)
+            {
+                currentData.pModel = mpScene->getModel(modelID).get();
+                currentData.modelID = modelID;
+                mDrawStats.modelChangeCount++;
+
+                if (setPerModelData(currentData))
+                {
+                    for (uint32_t instanceID = 0; instanceID < mpScene->getModelInstanceCount(modelID); instanceID++)
+                    {
+                        const auto pInstance = mpScene->getModelInstance(modelID, instanceID).get();
+                        currentData.modelInstanceID = instanceID;
+                        if (pInstance->isVisible())
                         {
-                            renderModelInstance(currentData, pInstance);
+                            mDrawStats.modelInstanceChangeCount++;
+                            if (setPerModelInstanceData(currentData, pInstance, instanceID))
+                            {
+                                renderModelInstance(currentData, pInstance);
+                            }
                         }
                     }
                 }
             }
         }
+
+        mDrawStats.submitTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
     }
 
     void SceneRenderer::renderScene(RenderContext* pContext, const Camera* pCamera)
@@ -392,6 +649,30 @@ namespace Falcor
         renderScene(currentData);
     }
 
+    void SceneRenderer::renderUI(Gui* pGui, const char* uiGroup)
+    {
+        if ((uiGroup == nullptr) || pGui->beginGroup(uiGroup))
+        {
+            pGui->addCheckBox("Sort Draws", mSortDraws);
+
+            std::string stats = "Mesh instances: " + std::to_string(mDrawStats.meshInstanceCount) + "\n";
+            stats += "Draw calls: " + std::to_string(mDrawStats.drawCallCount) + "\n";
+            stats += "Material changes: " + std::to_string(mDrawStats.materialChangeCount) + "\n";
+            stats += "VAO changes: " + std::to_string(mDrawStats.vaoChangeCount) + "\n";
+            stats += "Model changes: " + std::to_string(mDrawStats.modelChangeCount) + "\n";
+            stats += "Model instance changes: " + std::to_string(mDrawStats.modelInstanceChangeCount) + "\n";
+            if (mSortDraws)
+            {
+                stats += "Build time: " + std::to_string(mDrawStats.buildTime) + " ms\n";
+                stats += "Sort time: " + std::to_string(mDrawStats.sortTime) + " ms\n";
+            }
+            stats += "Submit time: " + std::to_string(mDrawStats.submitTime) + " ms";
+            pGui->addText(stats.c_str());
+
+            if (uiGroup) pGui->endGroup();
+        }
+    }
+
     void SceneRenderer::setCameraControllerType(CameraControllerType type)
     {
         switch(type)
@@ -33,6 +33,7 @@
 #include "Utils/CpuTimer.h"
 #include "API/ConstantBuffer.h"
 #include "Utils/DebugDrawer.h"
+#include "Graphics/Scene/DrawPacketSorter.h"
 
 namespace Falcor
 {
@@ -85,6 +86,38 @@ namespace Falcor
         */
         void setMaxInstanceCount(uint32_t instanceCount) { mMaxInstanceCount = instanceCount; }
 
+        /** Enable/disable sorted draw submission. When enabled, the visible mesh instances are sorted by pass, material, VAO and depth before drawing, and redundant state changes are skipped.
+            The per-model and per-model-instance callbacks are called whenever the model or model instance changes in the sorted order, so they can be called more than once per frame.
+        */
+        void toggleDrawSorting(bool enable) { mSortDraws = enable; }
+
+        /** Check if sorted draw submission is enabled
+        */
+        bool isDrawSortingEnabled() const { return mSortDraws; }
+
+        struct DrawStats
+        {
+            uint32_t meshInstanceCount = 0;         ///< Number of mesh instances drawn
+            uint32_t drawCallCount = 0;             ///< Number of draw calls
+            uint32_t materialChangeCount = 0;       ///< Number of setPerMaterialData() calls
+            uint32_t vaoChangeCount = 0;            ///< Number of VAO changes
+            uint32_t modelChangeCount = 0;          ///< Number of setPerModelData() calls
+            uint32_t modelInstanceChangeCount = 0;  ///< Number of setPerModelInstanceData() calls
+            float buildTime = 0;                    ///< CPU time in ms spent creating the draw packets
+            float sortTime = 0;                     ///< CPU time in ms spent sorting the draw packets
+            float submitTime = 0;                   ///< Total CPU time in ms of the renderScene() call
+        };
+
+        /** Get the statistics of the last renderScene() call
+        */
+        const DrawStats& getDrawStats() const { return mDrawStats; }
+
+        /** Render the draw sorting controls and the draw statistics
+            \param[in] pGui GUI instance to render UI with
+            \param[in] uiGroup Optional name. If specified, UI elements will be rendered within a named group
+        */
+        void renderUI(Gui* pGui, const char* uiGroup = nullptr);
+
         enum class CameraControllerType
         {
             FirstPerson,
@@ -112,6 +145,9 @@ namespace Falcor
             const Material* pMaterial = nullptr;
 
             uint32_t drawID; // Zero-based mesh instance draw order/ID. Resets at the beginning of renderScene, and increments per mesh instance drawn.
+            uint32_t modelID = 0;
+            uint32_t modelInstanceID = 0;
+            const std::vector<uint32_t>* pVisibleMeshInstances = nullptr; // Sorted indices into Scene::getMeshInstanceBounds() of the mesh instances that passed frustum culling. nullptr when culling is disabled.
         };
 
         SceneRenderer(const Scene::SharedPtr& pScene);
@@ -135,6 +171,9 @@ namespace Falcor
         static size_t sWorldInvTransposeMatOffset;
         static size_t sMeshIdOffset;
         static size_t sDrawIDOffset;
+        static size_t sPositionScaleOffset;
+        static size_t sPositionOffsetOffset;
+        static size_t sVertexCompressionOffset;
 
         static void updateVariableOffsets(const ProgramReflection* pReflector);
 
@@ -146,11 +185,25 @@ namespace Falcor
         virtual bool setPerMaterialData(const CurrentWorkingData& currentData, const Material* pMaterial);
         virtual void executeDraw(const CurrentWorkingData& currentData, uint32_t indexCount, uint32_t instanceCount);
         virtual void postFlushDraw(const CurrentWorkingData& currentData);
-        virtual bool cullMeshInstance(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance);
 
         void renderModelInstance(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance);
         void renderMeshInstances(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, uint32_t meshID);
         void draw(CurrentWorkingData& currentData, const Mesh* pMesh, uint32_t instanceCount);
+        bool bindMaterial(CurrentWorkingData& currentData, const Material* pMaterial);
+        void cullScene(CurrentWorkingData& currentData);
+        uint32_t getVisibleMeshInstances(const CurrentWorkingData& currentData, uint32_t meshID, const uint32_t*& pVisible, uint32_t& boundsBase) const;
+
+        struct DrawItem
+        {
+            uint32_t modelID;
+            uint32_t modelInstanceID;
+            uint32_t meshID;
+            uint32_t meshInstanceID;
+        };
+
+        void buildDrawPackets(const CurrentWorkingData& currentData);
+        void renderSortedScene(CurrentWorkingData& currentData);
+        void restoreSortedProgramState(CurrentWorkingData& currentData, bool& vsSkinning);
 
         void renderScene(CurrentWorkingData& currentData);
 
@@ -160,6 +213,11 @@ namespace Falcor
         uint32_t mMaxInstanceCount = 64;
         const Material* mpLastMaterial = nullptr;
         bool mCullEnabled = true;
+        std::vector<uint32_t> mVisibleMeshInstances;
+        bool mSortDraws = true;
+        std::vector<DrawItem> mDrawItems;
+        DrawPacketSorter mPacketSorter;
+        DrawStats mDrawStats;
         bool mCompileMaterialWithProgram = true;
     };
 }
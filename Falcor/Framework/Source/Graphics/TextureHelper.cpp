@@ -32,7 +32,10 @@
 #include "Utils/DDSHeader.h"
 #include "Utils/BinaryFileStream.h"
 #include "Utils/StringUtils.h"
+#include "Utils/BcCompression.h"
+#include "Utils/CpuTimer.h"
 #include <cstring>
+#include "glm/gtc/packing.hpp"
 
 static const bool kTopDown = true;
 
@@ -697,6 +700,226 @@ namespace Falcor
         return nullptr;
     }
 
+    static DXFormat dxgiFormatFromFalcorFormat(ResourceFormat format)
+    {
+        switch (format)
+        {
+        case ResourceFormat::RGBA8Unorm:
+            return FORMAT_R8G8B8A8_UNORM;
+        case ResourceFormat::RGBA32Float:
+            return FORMAT_R32G32B32A32_FLOAT;
+        case ResourceFormat::BC1Unorm:
+            return FORMAT_BC1_UNORM;
+        case ResourceFormat::BC3Unorm:
+            return FORMAT_BC3_UNORM;
+        case ResourceFormat::BC4Unorm:
+            return FORMAT_BC4_UNORM;
+        case ResourceFormat::BC5Unorm:
+            return FORMAT_BC5_UNORM;
+        case ResourceFormat::BC6HU16:
+            return FORMAT_BC6H_UF16;
+        case ResourceFormat::BC7Unorm:
+            return FORMAT_BC7_UNORM;
+        default:
+            return FORMAT_UNKNOWN;
+        }
+    }
+
+    std::string getBakedTextureFilename(const std::string& filename)
+    {
+        return filename + ".dds";
+    }
+
+    static bool findBakedTextureFile(const std::string& filename, Texture::BindFlags bindFlags, std::string& bakedFilename)
+    {
+        // Block-compressed textures can't be render-targets or UAVs
+        if (bindFlags != Texture::BindFlags::ShaderResource) return false;
+
+        std::string fullpath;
+        if (findFileInDataDirectories(filename, fullpath) == false) return false;
+        bakedFilename = getBakedTextureFilename(fullpath);
+        return doesFileExist(bakedFilename) && getFileModifiedTime(bakedFilename) >= getFileModifiedTime(fullpath);
+    }
+
+    bool saveDdsFile(const std::string& filename, ResourceFormat format, uint32_t width, uint32_t height, const std::vector<std::vector<uint8_t>>& mips)
+    {
+        DXFormat dxgiFormat = dxgiFormatFromFalcorFormat(format);
+        if (dxgiFormat == FORMAT_UNKNOWN || mips.empty())
+        {
+            logError("saveDdsFile() - unsupported format or missing data when writing " + filename);
+            return false;
+        }
+
+        DdsHeader header = {};
+        header.headerSize = sizeof(DdsHeader);
+        header.flags = DdsHeader::kCapsMask | DdsHeader::kHeightMask | DdsHeader::kWidthMask | DdsHeader::kPixelFormatMask | DdsHeader::kMipCountMask | DdsHeader::kLinearSizeMask;
+        header.height = height;
+        header.width = width;
+        header.linearSize = (uint32_t)mips[0].size();
+        header.depth = 1;
+        header.mipCount = (uint32_t)mips.size();
+        header.pixelFormat.structSize = sizeof(DdsHeader::PixelFormat);
+        header.pixelFormat.flags = DdsHeader::PixelFormat::kFourCCFlag;
+        header.pixelFormat.fourCC = makeFourCC("DX10");
+        header.caps[0] = DdsHeader::kCapsTextureMask | (mips.size() > 1 ? DdsHeader::kCapsMipMapMask | DdsHeader::kCapsComplexMask : 0);
+
+        DdsHeaderDX10 dx10Header = {};
+        dx10Header.dxgiFormat = dxgiFormat;
+        dx10Header.resourceDimension = DXResourceDimension::RESOURCE_DIMENSION_TEXTURE2D;
+        dx10Header.arraySize = 1;
+
+        BinaryFileStream stream(filename, BinaryFileStream::Mode::Write);
+        stream << kDdsMagicNumber << header << dx10Header;
+        for (const auto& mip : mips)
+        {
+            stream.write(mip.data(), mip.size());
+        }
+        bool good = stream.isGood();
+        stream.close();
+        if (good == false) logError("saveDdsFile() - failed to write " + filename);
+        return good;
+    }
+
+    // Convert a bitmap into the source format of the BC encoder
+    static std::vector<uint8_t> convertBitmapForCompression(const Bitmap* pBitmap, ResourceFormat dstFormat)
+    {
+        size_t texelCount = size_t(pBitmap->getWidth()) * pBitmap->getHeight();
+        ResourceFormat srcFormat = pBitmap->getFormat();
+        const uint8_t* pSrc = pBitmap->getData();
+        bool dstFloat = (dstFormat == ResourceFormat::RGBA32Float);
+        std::vector<uint8_t> dst(texelCount * (dstFloat ? 16 : 4));
+
+        for (size_t i = 0; i < texelCount; i++)
+        {
+            float texel[4] = { 0, 0, 0, 1 };
+            switch (srcFormat)
+            {
+            case ResourceFormat::BGRA8Unorm:
+            case ResourceFormat::BGRX8Unorm:
+                texel[0] = pSrc[i * 4 + 2] / 255.0f;
+                texel[1] = pSrc[i * 4 + 1] / 255.0f;
+                texel[2] = pSrc[i * 4 + 0] / 255.0f;
+                texel[3] = (srcFormat == ResourceFormat::BGRA8Unorm) ? pSrc[i * 4 + 3] / 255.0f : 1.0f;
+                break;
+            case ResourceFormat::RG8Unorm:
+                texel[0] = pSrc[i * 2 + 0] / 255.0f;
+                texel[1] = pSrc[i * 2 + 1] / 255.0f;
+                break;
+            case ResourceFormat::R8Unorm:
+                texel[0] = pSrc[i] / 255.0f;
+                break;
+            case ResourceFormat::RGBA32Float:
+            case ResourceFormat::RGB32Float:
+            {
+                uint32_t channels = getFormatChannelCount(srcFormat);
+                for (uint32_t c = 0; c < channels; c++) texel[c] = ((const float*)pSrc)[i * channels + c];
+                break;
+            }
+            case ResourceFormat::RGBA16Float:
+            case ResourceFormat::RGB16Float:
+            {
+                uint32_t channels = getFormatChannelCount(srcFormat);
+                for (uint32_t c = 0; c < channels; c++) texel[c] = glm::unpackHalf1x16(((const uint16_t*)pSrc)[i * channels + c]);
+                break;
+            }
+            default:
+                should_not_get_here();
+            }
+
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                if (dstFloat) ((float*)dst.data())[i * 4 + c] = texel[c];
+                else dst[i * 4 + c] = (uint8_t)(glm::clamp(texel[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+            }
+        }
+        return dst;
+    }
+
+    static ResourceFormat selectBcFormat(const Bitmap* pBitmap)
+    {
+        ResourceFormat format = pBitmap->getFormat();
+        if (getFormatType(format) == FormatType::Float) return ResourceFormat::BC6HU16;
+
+        switch (format)
+        {
+        case ResourceFormat::R8Unorm:
+            return ResourceFormat::BC4Unorm;
+        case ResourceFormat::RG8Unorm:
+            return ResourceFormat::BC5Unorm;
+        case ResourceFormat::BGRA8Unorm:
+        {
+            size_t texelCount = size_t(pBitmap->getWidth()) * pBitmap->getHeight();
+            for (size_t i = 0; i < texelCount; i++)
+            {
+                if (pBitmap->getData()[i * 4 + 3] != 255) return ResourceFormat::BC7Unorm;
+            }
+            return ResourceFormat::BC1Unorm;
+        }
+        default:
+            return ResourceFormat::BC1Unorm;
+        }
+    }
+
+    bool bakeTextureFile(const std::string& filename, ResourceFormat format, bool isSrgb, TextureBakeStats* pStats)
+    {
+        std::string fullpath;
+        if (findFileInDataDirectories(filename, fullpath) == false)
+        {
+            logError("bakeTextureFile() - can't find " + filename);
+            return false;
+        }
+
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(fullpath, kTopDown);
+        if (pBitmap == nullptr) return false;
+
+        uint32_t width = pBitmap->getWidth();
+        uint32_t height = pBitmap->getHeight();
+        if ((width % 4) != 0 || (height % 4) != 0)
+        {
+            logWarning("bakeTextureFile() - " + filename + " is " + std::to_string(width) + "x" + std::to_string(height) + ". Block-compressed textures must be a multiple of 4 in size. Skipping.");
+            return false;
+        }
+
+        if (format == ResourceFormat::Unknown) format = selectBcFormat(pBitmap.get());
+        if (BcCompression::isFormatSupported(format) == false)
+        {
+            logError("bakeTextureFile() - unsupported compressed format " + to_string(format));
+            return false;
+        }
+
+        CpuTimer timer;
+        timer.update();
+
+        ResourceFormat srcFormat = BcCompression::getUncompressedFormat(format);
+        std::vector<uint8_t> level = convertBitmapForCompression(pBitmap.get(), srcFormat);
+        std::vector<std::vector<uint8_t>> mips;
+        size_t uncompressedSize = 0;
+        uint32_t bitmapBytesPerPixel = getFormatBytesPerBlock(pBitmap->getFormat());
+        for (uint32_t w = width, h = height; ; w = std::max(1u, w / 2), h = std::max(1u, h / 2))
+        {
+            mips.push_back(BcCompression::compress(format, w, h, level.data()));
+            uncompressedSize += size_t(w) * h * bitmapBytesPerPixel;
+            if (w == 1 && h == 1) break;
+            level = BcCompression::generateMipLevel(srcFormat, w, h, level.data(), isSrgb);
+        }
+        timer.update();
+
+        if (saveDdsFile(getBakedTextureFilename(fullpath), format, width, height, mips) == false) return false;
+
+        if (pStats)
+        {
+            pStats->format = format;
+            pStats->width = width;
+            pStats->height = height;
+            pStats->mipCount = (uint32_t)mips.size();
+            pStats->uncompressedSize = uncompressedSize;
+            pStats->compressedSize = 0;
+            for (const auto& mip : mips) pStats->compressedSize += mip.size();
+            pStats->encodeTime = timer.getElapsedTime();
+        }
+        return true;
+    }
+
     Texture::SharedPtr createTextureFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags)
     {
 #define no_srgb()   \
@@ -706,10 +929,16 @@ namespace Falcor
     }
 
         Texture::SharedPtr pTex;
+        std::string bakedFilename;
         if (hasSuffix(filename, ".dds"))
         {
             pTex = createTextureFromDDSFile(filename, generateMipLevels, loadAsSrgb, bindFlags);
         }
+        else if (findBakedTextureFile(filename, bindFlags, bakedFilename))
+        {
+            // The baked file already has the mip-chain
+            pTex = createTextureFromDDSFile(bakedFilename, false, loadAsSrgb, bindFlags);
+        }
         else
         {
             Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(filename, kTopDown);
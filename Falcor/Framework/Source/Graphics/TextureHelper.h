@@ -43,5 +43,42 @@ namespace Falcor
     */
     Texture::SharedPtr createTextureFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags = Texture::BindFlags::ShaderResource);
 
+    /** Get the name of the baked DDS file matching an image file. This is the image filename with '.dds' appended.
+        createTextureFromFile() loads the baked file instead of the image if it exists, is newer than the image and the texture only needs the shader-resource bind flag.
+    */
+    std::string getBakedTextureFilename(const std::string& filename);
+
+    /** Write a 2D texture into a DDS file
+        \param[in] filename The output file
+        \param[in] format The texture format
+        \param[in] width The width of the top mip level
+        \param[in] height The height of the top mip level
+        \param[in] mips The data of each mip level, tightly packed
+        \return true if the file was written
+    */
+    bool saveDdsFile(const std::string& filename, ResourceFormat format, uint32_t width, uint32_t height, const std::vector<std::vector<uint8_t>>& mips);
+
+    /** Statistics returned by bakeTextureFile()
+    */
+    struct TextureBakeStats
+    {
+        ResourceFormat format = ResourceFormat::Unknown;    ///< The compressed format
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t mipCount = 0;
+        size_t uncompressedSize = 0;    ///< Size of the texture createTextureFromFile() creates from the image, including mips
+        size_t compressedSize = 0;      ///< Size of the baked texture, including mips
+        double encodeTime = 0;          ///< Time in seconds spent generating mips and compressing
+    };
+
+    /** Bake an image file into a block-compressed DDS file with a full mip-chain. The file is written to getBakedTextureFilename().
+        \param[in] filename The image file. Can also include a full path or relative path from a data directory.
+        \param[in] format The compressed format, see BcCompression::isFormatSupported(). Unknown selects BC6H for HDR images, BC4/BC5 for 1/2-channel images, BC7 for images with alpha and BC1 otherwise.
+        \param[in] isSrgb Whether the color channels are sRGB-encoded. Used by the mip filter.
+        \param[out] pStats Optional. The statistics of the bake.
+        \return true if the file was written
+    */
+    bool bakeTextureFile(const std::string& filename, ResourceFormat format, bool isSrgb, TextureBakeStats* pStats = nullptr);
+
     /*! @} */
 }
\ No newline at end of file
@@ -188,6 +188,11 @@ namespace Falcor
         for (auto& blasData : mBottomLevelData)
         {
             std::vector<D3D12_RAYTRACING_GEOMETRY_DESC> geomDesc(blasData.meshCount);
+
+            // Compressed positions are dequantized by the BLAS build with a 3x4 row-major transform per mesh
+            std::vector<float> transforms(12 * blasData.meshCount, 0.0f);
+            bool hasCompressedPositions = false;
+
             for (size_t meshIndex = blasData.meshBaseIndex; meshIndex < blasData.meshBaseIndex + blasData.meshCount; meshIndex++)
             {
                 assert(meshIndex < mMeshes.size());
@@ -210,6 +215,18 @@ namespace Falcor
                 desc.Triangles.VertexCount = pMesh->getVertexCount();
                 desc.Triangles.VertexFormat = getDxgiFormat(pVbLayout->getElementFormat(elemDesc.elementIndex));
 
+                if (pMesh->getVertexCompressionFlags() & VERTEX_COMPRESSED_POSITION)
+                {
+                    const VertexCompression::PositionQuantization& quantization = pMesh->getPositionQuantization();
+                    float* pTransform = &transforms[12 * (meshIndex - blasData.meshBaseIndex)];
+                    for (uint32_t row = 0; row < 3; row++)
+                    {
+                        pTransform[row * 4 + row] = quantization.scale[row];
+                        pTransform[row * 4 + 3] = quantization.offset[row];
+                    }
+                    hasCompressedPositions = true;
+                }
+
                 // Get the IB
                 const Buffer* pIB = pVao->getIndexBuffer().get();
                 pContext->resourceBarrier(pIB, Resource::State::NonPixelShader);
@@ -224,6 +241,20 @@ namespace Falcor
                 }
             }
 
+            if (hasCompressedPositions)
+            {
+                blasData.pGeometryTransforms = Buffer::create(transforms.size() * sizeof(float), Buffer::BindFlags::None, Buffer::CpuAccess::None, transforms.data());
+                pContext->resourceBarrier(blasData.pGeometryTransforms.get(), Resource::State::NonPixelShader);
+                for (size_t i = 0; i < geomDesc.size(); i++)
+                {
+                    const Mesh* pMesh = getMesh((uint32_t)(blasData.meshBaseIndex + i)).get();
+                    if (pMesh->getVertexCompressionFlags() & VERTEX_COMPRESSED_POSITION)
+                    {
+                        geomDesc[i].Triangles.Transform3x4 = blasData.pGeometryTransforms->getGpuAddress() + i * 12 * sizeof(float);
+                    }
+                }
+            }
+
             // Create the acceleration and aux buffers
             D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS inputs = {};
             inputs.Type = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL;
@@ -46,6 +46,7 @@ namespace Falcor
             uint32_t meshCount = 0;
             bool isStatic = true;
             Buffer::SharedPtr pBlas;
+            Buffer::SharedPtr pGeometryTransforms;  ///< Dequantization transforms of the meshes with compressed positions. Null if there are none.
         };
 
         uint32_t getBottomLevelDataCount() const { return (uint32_t)mBottomLevelData.size(); }
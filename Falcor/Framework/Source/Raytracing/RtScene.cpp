@@ -74,13 +74,40 @@ namespace Falcor
     bool RtScene::update(double currentTime, CameraController* cameraController)
     {
         bool changed = Scene::update(currentTime, cameraController);
-        mTlasHitProgCount = mExtentsDirty ? -1 : mTlasHitProgCount;
+        markDirtyTlasInstances();
+        return changed;
+    }
 
-        if (mEnableRefit)
+    bool RtScene::isTlasLayoutDirty() const
+    {
+        if (mTlasLayout.size() != getModelCount()) return true;
+        for (uint32_t modelId = 0; modelId < getModelCount(); modelId++)
         {
-            mRefit = true;
+            const auto& layout = mTlasLayout[modelId];
+            if (layout.pModel != getModel(modelId).get() || layout.instances.size() != getModelInstanceCount(modelId)) return true;
+            for (uint32_t i = 0; i < (uint32_t)layout.instances.size(); i++)
+            {
+                if (layout.instances[i] != getModelInstance(modelId, i).get()) return true;
+            }
+        }
+        return false;
+    }
+
+    void RtScene::markDirtyTlasInstances()
+    {
+        // If the layout changed the TLAS will be regenerated from scratch anyway
+        if (mTlasInstances.empty() || isTlasLayoutDirty()) return;
+
+        for (uint32_t i = 0; i < (uint32_t)mTlasInstances.size(); i++)
+        {
+            const auto& inst = mTlasInstances[i];
+            const auto& pMeshInstance = inst.pModel->getMeshInstance(inst.pModel->getBottomLevelData(inst.blasId).meshBaseIndex, inst.meshInstance);
+            bool dirty = (inst.modelInstanceVersion != inst.pModelInstance->getTransformVersion()) || (inst.meshInstanceVersion != pMeshInstance->getTransformVersion());
+
+            // Skinned models rebuild their BLAS when animated
+            dirty = dirty || (mInstanceDesc[i].AccelerationStructure != inst.pModel->getBottomLevelData(inst.blasId).pBlas->getGpuAddress());
+            if (dirty) mTlasTracker.markDirty(i);
         }
-        return changed;
     }
 
     void RtScene::addModelInstance(const ModelInstance::SharedPtr& pInstance)
@@ -127,6 +154,8 @@ namespace Falcor
         mGeometryCount = 0;
         std::vector<D3D12_RAYTRACING_INSTANCE_DESC> instanceDesc;
         mModelInstanceData.resize(pScene->getModelCount());
+        mTlasInstances.clear();
+        mTlasLayout.clear();
 
         uint32_t tlasIndex = 0;
         uint32_t instanceContributionToHitGroupIndex = 0;
@@ -139,17 +168,18 @@ namespace Falcor
             modelInstanceData.modelBase = tlasIndex;
             modelInstanceData.meshInstancesPerModelInstance = 0;
             modelInstanceData.meshBase.resize(pModel->getMeshCount());
+            mTlasLayout.push_back({ pModel, {} });
 
             for (uint32_t modelInstance = 0; modelInstance < pScene->getModelInstanceCount(modelId); modelInstance++)
             {
                 const auto& pModelInstance = pScene->getModelInstance(modelId, modelInstance);
+                mTlasLayout.back().instances.push_back(pModelInstance.get());
                 // Loop over the meshes
                 for (uint32_t blasId = 0; blasId < pModel->getBottomLevelDataCount(); blasId++)
                 {
                     // Initialize the instance desc
                     const auto& blasData = pModel->getBottomLevelData(blasId);
                     D3D12_RAYTRACING_INSTANCE_DESC idesc = {};
-                    idesc.AccelerationStructure = blasData.pBlas->getGpuAddress();
 
                     // Set the meshes tlas offset
                     if (modelInstance == 0)
@@ -177,14 +207,12 @@ namespace Falcor
                             idesc.Flags |= D3D12_RAYTRACING_INSTANCE_FLAG_TRIANGLE_CULL_DISABLE;
                         }
 
-                        // Only apply mesh-instance transform on non-skinned meshes
-                        mat4 transform = pModelInstance->getTransformMatrix();
-                        if (blasData.isStatic)
-                        {
-                            transform = transform * pModel->getMeshInstance(blasData.meshBaseIndex, meshInstance)->getTransformMatrix();    // If there are multiple meshes in a BLAS, they all have the same transform
-                        }
-                        transform = transpose(transform);
-                        memcpy(idesc.Transform, &transform, sizeof(idesc.Transform));
+                        TlasInstance tlasInstance;
+                        tlasInstance.pModelInstance = pModelInstance;
+                        tlasInstance.pModel = pModel;
+                        tlasInstance.blasId = blasId;
+                        tlasInstance.meshInstance = meshInstance;
+                        mTlasInstances.push_back(tlasInstance);
                         instanceDesc.push_back(idesc);
                         mGeometryCount += blasData.meshCount;
                         if (modelInstance == 0) modelInstanceData.meshInstancesPerModelInstance += blasData.meshCount;
@@ -216,35 +244,83 @@ namespace Falcor
         return instanceDesc;
     }
 
+    void RtScene::updateInstanceDesc(uint32_t instanceIndex)
+    {
+        TlasInstance& inst = mTlasInstances[instanceIndex];
+        D3D12_RAYTRACING_INSTANCE_DESC& idesc = mInstanceDesc[instanceIndex];
+        const auto& blasData = inst.pModel->getBottomLevelData(inst.blasId);
+        const auto& pMeshInstance = inst.pModel->getMeshInstance(blasData.meshBaseIndex, inst.meshInstance);
+
+        idesc.AccelerationStructure = blasData.pBlas->getGpuAddress();
+
+        // Only apply mesh-instance transform on non-skinned meshes
+        mat4 transform = inst.pModelInstance->getTransformMatrix();
+        if (blasData.isStatic)
+        {
+            transform = transform * pMeshInstance->getTransformMatrix();    // If there are multiple meshes in a BLAS, they all have the same transform
+        }
+
+        // Track the world-space bounds for the refit/rebuild heuristic
+        BoundingBox bounds = pMeshInstance->getObject()->getBoundingBox();
+        for (uint32_t i = 1; i < blasData.meshCount; i++)
+        {
+            bounds = BoundingBox::fromUnion(bounds, inst.pModel->getMesh(blasData.meshBaseIndex + i)->getBoundingBox());
+        }
+        mTlasTracker.setBounds(instanceIndex, bounds.transform(transform));
+
+        transform = transpose(transform);
+        memcpy(idesc.Transform, &transform, sizeof(idesc.Transform));
+
+        inst.modelInstanceVersion = inst.pModelInstance->getTransformVersion();
+        inst.meshInstanceVersion = pMeshInstance->getTransformVersion();
+    }
+
     // TODO: Cache TLAS per hitProgCount, as some render pipelines need multiple TLAS:es with different #hit progs in same frame, currently that trigger rebuild every frame. See issue #365.
     void RtScene::createTlas(uint32_t hitProgCount)
     {
-        if (mTlasHitProgCount == hitProgCount) return;
+        bool layoutChanged = (mTlasHitProgCount != hitProgCount) || isTlasLayoutDirty();
+        if (layoutChanged == false && mTlasTracker.hasDirtyInstances() == false) return;
         mTlasHitProgCount = hitProgCount;
 
         // Early out if hit program count is zero or if scene is empty.
         if (hitProgCount == 0 || getModelCount() == 0)
         {
             mModelInstanceData.clear();
+            mTlasInstances.clear();
+            mInstanceDesc.clear();
+            mTlasLayout.clear();
+            mTlasTracker.reset(0);
             mpTopLevelAS = nullptr;
+            mpInstanceData = nullptr;
+            mpScratchBuffer = nullptr;
             mTlasSrv = nullptr;
             mGeometryCount = 0;
             mInstanceCount = 0;
-            mRefit = false;
             return;
         }
 
         // todo: move this somewhere fair.
         mRtFlags |= RtBuildFlags::AllowUpdate;
 
-        D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAGS dxrFlags = getDxrBuildFlags(mRtFlags);
         RenderContext* pContext = gpDevice->getRenderContext().get();
-        std::vector<D3D12_RAYTRACING_INSTANCE_DESC> instanceDesc = createInstanceDesc(this, hitProgCount);
 
-        // todo: improve this check - make sure things have not changed much and update was enabled last time
-        bool isRefitPossible = mRefit && mpTopLevelAS && (mInstanceCount == (uint32_t)instanceDesc.size());
+        if (layoutChanged)
+        {
+            // The instances changed, regenerate all the descriptors
+            mInstanceDesc = createInstanceDesc(this, hitProgCount);
+            mInstanceCount = (uint32_t)mInstanceDesc.size();
+            mTlasTracker.reset(mInstanceCount);
+        }
+
+        // Patch the descriptors of the instances that changed
+        std::vector<TlasUpdateTracker::Range> dirtyRanges = mTlasTracker.getDirtyRanges();
+        for (const auto& range : dirtyRanges)
+        {
+            for (uint32_t i = range.first; i < range.first + range.count; i++) updateInstanceDesc(i);
+        }
 
-        mInstanceCount = (uint32_t)instanceDesc.size();
+        TlasUpdateTracker::BuildMode buildMode = mTlasTracker.chooseBuildMode(mEnableRefit && mpTopLevelAS);
+        bool isRefit = (buildMode == TlasUpdateTracker::BuildMode::Refit);
 
         // Create the top-level acceleration buffers
         D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS inputs = {};
@@ -253,41 +329,50 @@ namespace Falcor
         inputs.NumDescs = mInstanceCount;
         inputs.Flags = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_UPDATE;
 
-        D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO info;
-        GET_COM_INTERFACE(gpDevice->getApiHandle(), ID3D12Device5, pDevice5);
-        pDevice5->GetRaytracingAccelerationStructurePrebuildInfo(&inputs, &info);
-
-        Buffer::SharedPtr pScratchBuffer = Buffer::create(align_to(D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, info.ScratchDataSizeInBytes), Buffer::BindFlags::UnorderedAccess, Buffer::CpuAccess::None);
-
-        if (!isRefitPossible)
+        if (layoutChanged)
         {
+            D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO info;
+            GET_COM_INTERFACE(gpDevice->getApiHandle(), ID3D12Device5, pDevice5);
+            pDevice5->GetRaytracingAccelerationStructurePrebuildInfo(&inputs, &info);
+
+            // The scratch buffer is kept around for refits, so make it large enough for both build types
+            uint64_t scratchSize = std::max(info.ScratchDataSizeInBytes, info.UpdateScratchDataSizeInBytes);
+            mpScratchBuffer = Buffer::create(align_to(D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, scratchSize), Buffer::BindFlags::UnorderedAccess, Buffer::CpuAccess::None);
             mpTopLevelAS = Buffer::create(align_to(D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, info.ResultDataMaxSizeInBytes), Buffer::BindFlags::AccelerationStructure, Buffer::CpuAccess::None);
+            mpInstanceData = Buffer::create(mInstanceCount * sizeof(D3D12_RAYTRACING_INSTANCE_DESC), Buffer::BindFlags::None, Buffer::CpuAccess::None, mInstanceDesc.data());
         }
         else
         {
+            // Only upload the descriptors that changed
+            for (const auto& range : dirtyRanges)
+            {
+                pContext->updateBuffer(mpInstanceData.get(), mInstanceDesc.data(), range.first * sizeof(D3D12_RAYTRACING_INSTANCE_DESC), range.count * sizeof(D3D12_RAYTRACING_INSTANCE_DESC));
+            }
             pContext->uavBarrier(mpTopLevelAS.get());
         }
-
-        Buffer::SharedPtr pInstanceData = Buffer::create(mInstanceCount * sizeof(D3D12_RAYTRACING_INSTANCE_DESC), Buffer::BindFlags::None, Buffer::CpuAccess::None, instanceDesc.data());
-        assert((mInstanceCount != 0) && pInstanceData->getApiHandle() && mpTopLevelAS->getApiHandle() && pScratchBuffer->getApiHandle());
+        assert((mInstanceCount != 0) && mpInstanceData->getApiHandle() && mpTopLevelAS->getApiHandle() && mpScratchBuffer->getApiHandle());
 
         // Create the TLAS
         D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC asDesc = {};
         asDesc.Inputs = inputs;
-        asDesc.Inputs.InstanceDescs = pInstanceData->getGpuAddress();
+        asDesc.Inputs.InstanceDescs = mpInstanceData->getGpuAddress();
         asDesc.DestAccelerationStructureData = mpTopLevelAS->getGpuAddress();
-        asDesc.ScratchAccelerationStructureData = pScratchBuffer->getGpuAddress();
+        asDesc.ScratchAccelerationStructureData = mpScratchBuffer->getGpuAddress();
 
-        if (isRefitPossible)
+        if (isRefit)
         {
             asDesc.Inputs.Flags |= D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PERFORM_UPDATE;
             asDesc.SourceAccelerationStructureData = asDesc.DestAccelerationStructureData;
         }
 
         GET_COM_INTERFACE(pContext->getLowLevelData()->getCommandList(), ID3D12GraphicsCommandList4, pList4);
-        pContext->resourceBarrier(pInstanceData.get(), Resource::State::NonPixelShader);
+        pContext->resourceBarrier(mpInstanceData.get(), Resource::State::NonPixelShader);
         pList4->BuildRaytracingAccelerationStructure(&asDesc, 0, nullptr);
         pContext->uavBarrier(mpTopLevelAS.get());
+        mTlasTracker.onBuild(buildMode);
+
+        // The SRV only needs to be recreated when the TLAS buffer changes
+        if (layoutChanged == false) return;
 
         // Create the SRV
         D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
@@ -303,7 +388,5 @@ namespace Falcor
 
         ResourceWeakPtr pWeak = mpTopLevelAS;
         mTlasSrv = std::make_shared<ShaderResourceView>(pWeak, pSet, 0, 1, 0, 1);
-
-        mRefit = false;
     }
-}
\ No newline at end of file
+}
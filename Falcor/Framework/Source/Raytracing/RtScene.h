@@ -28,6 +28,7 @@
 #pragma once
 #include "Graphics/Scene/Scene.h"
 #include "RtModel.h"
+#include "TlasUpdateTracker.h"
 #include <map>
 
 namespace Falcor
@@ -60,6 +61,14 @@ namespace Falcor
 
         void setRefit(bool enableRefit) { mEnableRefit = enableRefit; }
 
+        /** Set the accumulated SAH growth above which the TLAS is rebuilt instead of refit. See TlasUpdateTracker.
+        */
+        void setRefitRebuildThreshold(float threshold) { mTlasTracker.setRebuildThreshold(threshold); }
+
+        /** Get the TLAS update bookkeeping
+        */
+        const TlasUpdateTracker& getTlasUpdateTracker() const { return mTlasTracker; }
+
     protected:
         RtScene(RtBuildFlags rtFlags) : mRtFlags(rtFlags), mpSkinningCache(SkinningCache::create()) {}
         uint32_t mTlasHitProgCount = -1;
@@ -69,6 +78,9 @@ namespace Falcor
         ShaderResourceView::SharedPtr mTlasSrv;
         void createTlas(uint32_t rayCount);
         std::vector<D3D12_RAYTRACING_INSTANCE_DESC> createInstanceDesc(const RtScene* pScene, uint32_t hitProgCount);
+        void updateInstanceDesc(uint32_t instanceIndex);
+        bool isTlasLayoutDirty() const;
+        void markDirtyTlasInstances();
 
         uint32_t mGeometryCount = 0;    // The total number of geometries in the scene
         uint32_t mInstanceCount = 0;    // The total number of TLAS instances in the scene
@@ -81,12 +93,35 @@ namespace Falcor
         };
 
         std::vector<ModelInstanceData> mModelInstanceData;
+
+        // Describes where a TLAS instance comes from, so that its descriptor can be patched without regenerating the entire array
+        struct TlasInstance
+        {
+            ModelInstance::SharedPtr pModelInstance;     // Keeps the instance alive, so the layout check can compare instance addresses
+            const RtModel* pModel = nullptr;
+            uint32_t blasId = 0;
+            uint32_t meshInstance = 0;
+            uint32_t modelInstanceVersion = 0;
+            uint32_t meshInstanceVersion = 0;
+        };
+
+        std::vector<TlasInstance> mTlasInstances;
+        std::vector<D3D12_RAYTRACING_INSTANCE_DESC> mInstanceDesc;
+        // The models and model instances the TLAS was created with
+        struct TlasLayoutEntry
+        {
+            const Model* pModel = nullptr;
+            std::vector<const ModelInstance*> instances;
+        };
+        std::vector<TlasLayoutEntry> mTlasLayout;
+        TlasUpdateTracker mTlasTracker;
+        Buffer::SharedPtr mpInstanceData;
+        Buffer::SharedPtr mpScratchBuffer;
         std::unordered_map<const Model*, RtModel::SharedPtr> mModelToRtModel;
         std::unordered_map<IMovableObject*, IMovableObject::SharedPtr> mModelInstanceToRtModelInstance;
 
         SkinningCache::SharedPtr mpSkinningCache;
 
         bool mEnableRefit = false;
-        bool mRefit = false;
     };
 }
\ No newline at end of file
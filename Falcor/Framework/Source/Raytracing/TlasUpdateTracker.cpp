@@ -0,0 +1,136 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "TlasUpdateTracker.h"
+
+namespace Falcor
+{
+    float TlasUpdateTracker::surfaceArea(const BoundingBox& box)
+    {
+        glm::vec3 size = box.getSize();
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    void TlasUpdateTracker::reset(uint32_t instanceCount)
+    {
+        mDirty.assign(instanceCount, 1);
+        mDirtyCount = instanceCount;
+        mBuildBounds.assign(instanceCount, BoundingBox());
+        mCurrentBounds.assign(instanceCount, BoundingBox());
+        mGrownArea.assign(instanceCount, 0.0f);
+        mBuildArea = 0;
+        mGrownAreaSum = 0;
+        mRefitCount = 0;
+        mRebuildPending = true;
+    }
+
+    void TlasUpdateTracker::markDirty(uint32_t instance)
+    {
+        assert(instance < getInstanceCount());
+        if (mDirty[instance] == 0)
+        {
+            mDirty[instance] = 1;
+            mDirtyCount++;
+        }
+    }
+
+    void TlasUpdateTracker::setBounds(uint32_t instance, const BoundingBox& bounds)
+    {
+        assert(instance < getInstanceCount());
+        mCurrentBounds[instance] = bounds;
+
+        // The reference bounds will be reset on the next build, no need to track the growth
+        if (mRebuildPending) return;
+
+        float grown = surfaceArea(BoundingBox::fromUnion(mBuildBounds[instance], bounds));
+        mGrownAreaSum += double(grown) - double(mGrownArea[instance]);
+        mGrownArea[instance] = grown;
+    }
+
+    std::vector<TlasUpdateTracker::Range> TlasUpdateTracker::getDirtyRanges(uint32_t maxGap) const
+    {
+        std::vector<Range> ranges;
+        if (mDirtyCount == 0) return ranges;
+
+        for (uint32_t i = 0; i < getInstanceCount(); i++)
+        {
+            if (mDirty[i] == 0) continue;
+
+            if (ranges.size() && (i - (ranges.back().first + ranges.back().count)) <= maxGap)
+            {
+                ranges.back().count = i - ranges.back().first + 1;
+            }
+            else
+            {
+                ranges.push_back({ i, 1 });
+            }
+        }
+        return ranges;
+    }
+
+    float TlasUpdateTracker::getSahGrowth() const
+    {
+        if (mRebuildPending || mBuildArea <= 0) return 1.0f;
+        return float(mGrownAreaSum / mBuildArea);
+    }
+
+    TlasUpdateTracker::BuildMode TlasUpdateTracker::chooseBuildMode(bool allowRefit) const
+    {
+        if (mRebuildPending) return BuildMode::Rebuild;
+        if (mDirtyCount == 0) return BuildMode::None;
+        if (allowRefit == false) return BuildMode::Rebuild;
+        if (mMaxRefitCount && mRefitCount >= mMaxRefitCount) return BuildMode::Rebuild;
+        return (getSahGrowth() > mRebuildThreshold) ? BuildMode::Rebuild : BuildMode::Refit;
+    }
+
+    void TlasUpdateTracker::onBuild(BuildMode mode)
+    {
+        if (mode == BuildMode::None) return;
+
+        std::fill(mDirty.begin(), mDirty.end(), uint8_t(0));
+        mDirtyCount = 0;
+
+        if (mode == BuildMode::Refit)
+        {
+            mRefitCount++;
+            return;
+        }
+
+        // Rebuild. The current bounds are the new reference
+        mBuildBounds = mCurrentBounds;
+        mBuildArea = 0;
+        for (uint32_t i = 0; i < getInstanceCount(); i++)
+        {
+            mGrownArea[i] = surfaceArea(mBuildBounds[i]);
+            mBuildArea += mGrownArea[i];
+        }
+        mGrownAreaSum = mBuildArea;
+        mRefitCount = 0;
+        mRebuildPending = false;
+    }
+}
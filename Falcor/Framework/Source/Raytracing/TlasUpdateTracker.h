@@ -0,0 +1,138 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "Utils/AABB.h"
+#include <vector>
+
+namespace Falcor
+{
+    /** CPU-side bookkeeping for incremental TLAS updates.
+        Tracks which TLAS instances changed since the last build, which instance descriptors need to be uploaded and whether the
+        acceleration structure should be refit or rebuilt.
+        The refit/rebuild decision is based on the accumulated SAH growth: for each instance we keep the world-space bounds it had when the
+        TLAS was last rebuilt. A refit keeps the BVH topology, so every node grows to contain both the old and new positions of its children.
+        The ratio sum(area(union(buildBounds, currentBounds))) / sum(area(buildBounds)) is used as an estimate of how much the traversal
+        cost has grown since the last rebuild.
+        This class doesn't touch the GPU and can be used and tested on its own.
+    */
+    class TlasUpdateTracker
+    {
+    public:
+        enum class BuildMode
+        {
+            None,       ///< Nothing changed, the TLAS is up-to-date
+            Refit,      ///< Update the existing TLAS in-place
+            Rebuild,    ///< Build the TLAS from scratch
+        };
+
+        /** A contiguous range of instances
+        */
+        struct Range
+        {
+            uint32_t first = 0;
+            uint32_t count = 0;
+        };
+
+        /** Reset the tracker for a new set of instances. All instances are marked as dirty and the next build will be a rebuild.
+            \param[in] instanceCount The number of TLAS instances
+        */
+        void reset(uint32_t instanceCount);
+
+        /** Get the number of tracked instances
+        */
+        uint32_t getInstanceCount() const { return (uint32_t)mDirty.size(); }
+
+        /** Mark an instance as changed. The instance descriptor will be uploaded on the next build.
+        */
+        void markDirty(uint32_t instance);
+
+        /** Check if an instance changed since the last build
+        */
+        bool isDirty(uint32_t instance) const { return mDirty[instance] != 0; }
+
+        /** Check if any instance changed since the last build
+        */
+        bool hasDirtyInstances() const { return mDirtyCount != 0; }
+
+        /** Get the number of dirty instances
+        */
+        uint32_t getDirtyCount() const { return mDirtyCount; }
+
+        /** Set the current world-space bounds of an instance. Doesn't mark the instance as dirty.
+        */
+        void setBounds(uint32_t instance, const BoundingBox& bounds);
+
+        /** Get the dirty instances as a list of sorted, non-overlapping ranges.
+            \param[in] maxGap Adjacent ranges separated by at most this many clean instances are merged. Merging reduces the number of uploads at the cost of re-uploading some unchanged descriptors.
+        */
+        std::vector<Range> getDirtyRanges(uint32_t maxGap = 0) const;
+
+        /** Get the estimated SAH growth since the last rebuild. 1 means the TLAS is as good as when it was built.
+        */
+        float getSahGrowth() const;
+
+        /** Get the number of refits performed since the last rebuild
+        */
+        uint32_t getRefitCount() const { return mRefitCount; }
+
+        /** Set the SAH growth above which a rebuild is requested instead of a refit
+        */
+        void setRebuildThreshold(float threshold) { mRebuildThreshold = threshold; }
+        float getRebuildThreshold() const { return mRebuildThreshold; }
+
+        /** Set the maximum number of consecutive refits. 0 means no limit.
+        */
+        void setMaxRefitCount(uint32_t count) { mMaxRefitCount = count; }
+        uint32_t getMaxRefitCount() const { return mMaxRefitCount; }
+
+        /** Choose how to bring the TLAS up-to-date
+            \param[in] allowRefit If false, any change results in a rebuild
+        */
+        BuildMode chooseBuildMode(bool allowRefit) const;
+
+        /** Notify the tracker that the TLAS was built. Clears the dirty state. After a rebuild, the current bounds become the new reference bounds.
+        */
+        void onBuild(BuildMode mode);
+
+    private:
+        static float surfaceArea(const BoundingBox& box);
+
+        std::vector<uint8_t> mDirty;
+        std::vector<BoundingBox> mBuildBounds;      // The instance bounds when the TLAS was last rebuilt
+        std::vector<BoundingBox> mCurrentBounds;
+        std::vector<float> mGrownArea;              // Surface area of union(buildBounds, currentBounds)
+        uint32_t mDirtyCount = 0;
+        double mBuildArea = 0;
+        double mGrownAreaSum = 0;
+
+        bool mRebuildPending = true;
+        uint32_t mRefitCount = 0;
+        float mRebuildThreshold = 1.5f;
+        uint32_t mMaxRefitCount = 0;
+    };
+}
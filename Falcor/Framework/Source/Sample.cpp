@@ -447,6 +447,9 @@ namespace Falcor
             return;
         }
 
+        // Pick up shader edits between frames, so a program never changes mid-frame
+        Program::reloadChangedPrograms();
+
         mFrameRate.newFrame();
         beginTestFrame();
         {
@@ -649,7 +652,7 @@ namespace Falcor
     {
         if (mVideoCapture.pVideoCapture)
         {
-            mVideoCapture.pVideoCapture->appendFrame(mpRenderContext->readTextureSubresource(mpBackBufferFBO->getColorTexture(0).get(), 0).data());
+            mVideoCapture.pVideoCapture->appendFrame(mpRenderContext.get(), mpBackBufferFBO->getColorTexture(0).get());
 
             if (mVideoCapture.pUI->useTimeRange())
             {
@@ -203,33 +203,37 @@ namespace Falcor
         // Construct the json string from the string buffer.
         std::string jsonString(jsonStringBuffer.GetString(), jsonStringBuffer.GetSize());
 
-        std::string exeName = getExecutableName();
-        std::string shortName = exeName.substr(0, exeName.size() - 4);
+        std::string jsonFilename = getOutputFilePath(".json");
+        std::ofstream outputStream(jsonFilename.c_str());
+        if (outputStream.fail())
+        {
+            logError("Cannot write to " + jsonFilename + ".\n");
+        }
+        outputStream << jsonString;
+        outputStream.close();
+    }
 
-        std::string jsonFilename = "";
+    // Get the path of an output file.
+    std::string SampleTest::getOutputFilePath(const std::string& extension) const
+    {
+        std::string filename = "";
 
         if (mHasSetFilename)
         {
-            jsonFilename = mTestOutputFilename + ".json";
+            filename = mTestOutputFilename + extension;
         }
         else
         {
-            // Write the json file.
-            jsonFilename = shortName + ".json";
+            std::string exeName = getExecutableName();
+            std::string shortName = exeName.substr(0, exeName.size() - 4);
+            filename = shortName + extension;
         }
 
         if (mHasSetDirectory)
         {
-            jsonFilename = mTestOutputDirectory + jsonFilename;
+            filename = mTestOutputDirectory + filename;
         }
-
-        std::ofstream outputStream(jsonFilename.c_str());
-        if (outputStream.fail())
-        {
-            logError("Cannot write to " + jsonFilename + ".\n");
-        }
-        outputStream << jsonString;
-        outputStream.close();
+        return filename;
     }
 
     // Write the Json Test Results.
@@ -294,6 +298,52 @@ namespace Falcor
         }
 
         jsonTestResults.AddMember("Performance Time Checks", pctArray, jsonAllocator);
+
+        // Write the per-event breakdown of the benchmark and its verdict.
+        if (mBenchmarkTask != nullptr && mBenchmarkTask->mIsTaskComplete)
+        {
+            rapidjson::Value benchmark;
+            benchmark.SetObject();
+            writeJsonLiteral(benchmark, jsonAllocator, "Frames", mBenchmarkTask->mResults.getFrameCount());
+            writeJsonString(benchmark, jsonAllocator, "Results File", mBenchmarkTask->mResultsFilename);
+
+            rapidjson::Value eventsArray(rapidjson::kArrayType);
+            for (const auto& e : mBenchmarkTask->mResults.getEvents())
+            {
+                rapidjson::Value event;
+                event.SetObject();
+                writeJsonString(event, jsonAllocator, "Name", e.first);
+                writeJsonLiteral(event, jsonAllocator, "CPU Median", PerformanceBaseline::median(e.second.cpuMs));
+                writeJsonLiteral(event, jsonAllocator, "GPU Median", PerformanceBaseline::median(e.second.gpuMs));
+                eventsArray.PushBack(event, jsonAllocator);
+            }
+            writeJsonValue(benchmark, jsonAllocator, "Events", eventsArray);
+
+            if (mBenchmarkTask->mHasComparison)
+            {
+                const PerformanceBaseline::Comparison& comparison = mBenchmarkTask->mComparison;
+                writeJsonString(benchmark, jsonAllocator, "Baseline File", mBenchmarkTask->mBaselineFilename);
+                writeJsonString(benchmark, jsonAllocator, "Verdict File", mBenchmarkTask->mComparisonFilename);
+                writeJsonString(benchmark, jsonAllocator, "Verdict", comparison.regressed ? "regression" : "pass");
+
+                rapidjson::Value regressionsArray(rapidjson::kArrayType);
+                for (const auto& m : comparison.metrics)
+                {
+                    if (m.verdict != PerformanceBaseline::Verdict::Regression) continue;
+                    std::string name = m.event + (m.gpu ? " (GPU)" : " (CPU)");
+                    rapidjson::Value jname;
+                    jname.SetString(name.c_str(), (uint32_t)name.size(), jsonAllocator);
+                    regressionsArray.PushBack(jname, jsonAllocator);
+                }
+                writeJsonValue(benchmark, jsonAllocator, "Regressions", regressionsArray);
+            }
+            else
+            {
+                writeJsonString(benchmark, jsonAllocator, "Verdict", "no baseline");
+            }
+
+            jsonTestResults.AddMember("Performance Benchmark", benchmark, jsonAllocator);
+        }
     }
 
     // Write the Screen Capture Results.
@@ -437,7 +487,54 @@ namespace Falcor
             }
         }
 
+        // Check for a Benchmark, given as the number of warm-up frames and the number of recorded frames.
+        if (args.argExists("perfbenchmark"))
+        {
+            std::vector<ArgList::Arg> benchmarkArgs = args.getValues("perfbenchmark");
+            if (benchmarkArgs.size() < 2 || benchmarkArgs[1].asUint() == 0)
+            {
+                logError("Please provide the number of warm-up frames and a non-zero number of frames to record for the Performance Benchmark.");
+            }
+            else
+            {
+                mBenchmarkTask = std::make_shared<BenchmarkFrameTask>(benchmarkArgs[0].asUint(), benchmarkArgs[1].asUint());
+                mBenchmarkTask->mResultsFilename = getOutputFilePath(".perf.json");
+
+                if (args.argExists("perfbaseline"))
+                {
+                    std::vector<ArgList::Arg> baselineArgs = args.getValues("perfbaseline");
+                    if (!baselineArgs.empty()) mBenchmarkTask->mBaselineFilename = baselineArgs[0].asString();
+                }
+                if (args.argExists("perfthreshold"))
+                {
+                    std::vector<ArgList::Arg> thresholdArgs = args.getValues("perfthreshold");
+                    if (!thresholdArgs.empty()) mBenchmarkTask->mCompareOptions.threshold = thresholdArgs[0].asFloat();
+                }
+                if (args.argExists("perfsignificance"))
+                {
+                    std::vector<ArgList::Arg> significanceArgs = args.getValues("perfsignificance");
+                    if (!significanceArgs.empty()) mBenchmarkTask->mCompareOptions.significance = significanceArgs[0].asFloat();
+                }
+                mFrameTasks.push_back(mBenchmarkTask);
+
+                // Profile the warm-up frames too, so the double-buffered GPU times are valid from the first recorded frame
+                gProfileEnabled = true;
+            }
+        }
+
         std::sort(mFrameTasks.begin(), mFrameTasks.end(), FrameTaskPtrCompare());
+
+        // Frame tasks run one at a time, so tasks starting during the benchmark wait for it to finish
+        if (mBenchmarkTask)
+        {
+            for (const auto& pTask : mFrameTasks)
+            {
+                if (pTask != mBenchmarkTask && pTask->mStartFrame >= mBenchmarkTask->mStartFrame && pTask->mStartFrame <= mBenchmarkTask->mEndFrame)
+                {
+                    logWarning("A test task at frame " + std::to_string(pTask->mStartFrame) + " overlaps the Performance Benchmark and will be delayed until it ends.");
+                }
+            }
+        }
     }
 
     // Initialize Time Tests.
@@ -704,7 +801,8 @@ namespace Falcor
 
     bool SampleTest::ShutdownFrameTask::isActive(SampleCallbacks* pSample)
     {
-        return pSample->getFrameID() == mStartFrame && !mIsTaskComplete;
+        // Can be delayed past its frame by a multi-frame task
+        return pSample->getFrameID() >= mStartFrame && !mIsTaskComplete;
     }
 
     void SampleTest::ShutdownFrameTask::onFrameEnd(SampleCallbacks* pSample, SampleTest* pSampleTest)
@@ -722,6 +820,57 @@ namespace Falcor
         mIsTaskComplete = true;
     }
 
+    // BenchmarkFrameTask
+
+    bool SampleTest::BenchmarkFrameTask::isActive(SampleCallbacks* pSample)
+    {
+        return pSample->getFrameID() >= mStartFrame && !mIsTaskComplete;
+    }
+
+    void SampleTest::BenchmarkFrameTask::onFrameEnd(SampleCallbacks* pSample, SampleTest* pSampleTest)
+    {
+        // Called before the profiler ends the frame. The GPU times are for the previous frame.
+        std::vector<Profiler::EventTimes> times;
+        Profiler::getEventTimes(times);
+        for (const auto& t : times)
+        {
+            mResults.addSample(t.name, t.cpuMs, t.gpuMs);
+        }
+        mResults.endFrame();
+
+        if (pSample->getFrameID() < mEndFrame) return;
+
+        mResults.setDescription(getExecutableName());
+        mResults.save(mResultsFilename);
+
+        if (mBaselineFilename.size())
+        {
+            PerformanceBaseline baseline;
+            if (PerformanceBaseline::load(mBaselineFilename, baseline))
+            {
+                mComparison = PerformanceBaseline::compare(baseline, mResults, mCompareOptions);
+                mHasComparison = true;
+                mComparisonFilename = pSampleTest->getOutputFilePath(".perfverdict.json");
+
+                std::ofstream outputStream(mComparisonFilename.c_str());
+                if (outputStream.fail())
+                {
+                    logError("Cannot write to " + mComparisonFilename + ".\n");
+                }
+                outputStream << mComparison.toJson();
+                outputStream.close();
+
+                if (mComparison.regressed)
+                {
+                    logWarning("Performance regression against " + mBaselineFilename + ". See " + mComparisonFilename + ".");
+                }
+            }
+        }
+
+        // Task is Complete!
+        mIsTaskComplete = true;
+    }
+
     // MemoryCheckTimeTask
 
     void SampleTest::MemoryCheckTimeTask::onFrameEnd(SampleCallbacks* pSample, SampleTest* pSampleTest)
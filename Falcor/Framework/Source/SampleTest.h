@@ -29,6 +29,7 @@
 #include "rapidjson/document.h"
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/prettywriter.h"
+#include "Utils/PerformanceBaseline.h"
 
 namespace Falcor
 {
@@ -60,6 +61,7 @@ namespace Falcor
             PerformanceCheckTask,
             ScreenCaptureTask,
             ShutdownTask,
+            BenchmarkTask,
             None
         };
 
@@ -195,6 +197,30 @@ namespace Falcor
             uint32_t mShutdownFrame = 0;
         };
 
+        /** Records the per-event CPU/GPU times of a range of frames and compares them against a baseline
+        */
+        class BenchmarkFrameTask : public FrameTask
+        {
+        public:
+            BenchmarkFrameTask(uint32_t startFrame, uint32_t frameCount) : FrameTask(TaskType::BenchmarkTask, startFrame, startFrame + frameCount - 1) {};
+
+            virtual bool isActive(SampleCallbacks* pSample);
+            virtual void onFrameBegin(SampleCallbacks* pSample) {}
+            virtual void onFrameEnd(SampleCallbacks* pSample, SampleTest* pSampleTest);
+
+            PerformanceBaseline mResults;
+            std::string mResultsFilename;
+
+            // The comparison against the baseline, if one was given
+            std::string mBaselineFilename;
+            PerformanceBaseline::CompareOptions mCompareOptions;
+            bool mHasComparison = false;
+            PerformanceBaseline::Comparison mComparison;
+            std::string mComparisonFilename;
+        };
+
+        std::shared_ptr<BenchmarkFrameTask> mBenchmarkTask;
+
         class TimeTask
         {
         public:
@@ -337,6 +363,11 @@ namespace Falcor
         */
         void writeScreenCaptureResults(rapidjson::Document & jsonTestResults);
 
+        /** Get the path of an output file, based on the output directory and filename.
+            \param[in] extension The extension of the file, including the dot
+        */
+        std::string getOutputFilePath(const std::string& extension) const;
+
         
         /** Initialize the Frame Tests.
         */
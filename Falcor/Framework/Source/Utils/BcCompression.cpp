@@ -0,0 +1,830 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "BcCompression.h"
+#include "Utils/ParallelFor.h"
+#include <cmath>
+#include <cfloat>
+
+namespace Falcor
+{
+    namespace BcCompression
+    {
+        namespace
+        {
+            // Interpolation weights for 4-bit indices (BC6H/BC7), in 1/64 units
+            const uint32_t kWeights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+            /** Little-endian bit stream over a 128-bit block
+            */
+            class BitWriter
+            {
+            public:
+                void write(uint32_t value, uint32_t bitCount)
+                {
+                    for (uint32_t i = 0; i < bitCount; i++, mPos++)
+                    {
+                        if (value & (1u << i)) mBits[mPos / 64] |= (1ull << (mPos % 64));
+                    }
+                }
+                void store(uint8_t* pDst) const { std::memcpy(pDst, mBits, 16); }
+            private:
+                uint64_t mBits[2] = {};
+                uint32_t mPos = 0;
+            };
+
+            class BitReader
+            {
+            public:
+                BitReader(const uint8_t* pSrc) { std::memcpy(mBits, pSrc, 16); }
+                uint32_t read(uint32_t bitCount)
+                {
+                    uint32_t value = 0;
+                    for (uint32_t i = 0; i < bitCount; i++, mPos++)
+                    {
+                        if (mBits[mPos / 64] & (1ull << (mPos % 64))) value |= (1u << i);
+                    }
+                    return value;
+                }
+            private:
+                uint64_t mBits[2];
+                uint32_t mPos = 0;
+            };
+
+            uint16_t floatToHalf(float f)
+            {
+                // Positive finite values only. The encoder clamps its input to the BC6H unsigned range.
+                if (!(f > 0.0f)) return 0;
+                if (f >= 65504.0f) return 0x7BFF;
+                int exponent;
+                float mantissa = std::frexp(f, &exponent);   // f = mantissa * 2^exponent, mantissa in [0.5, 1)
+                int halfExponent = exponent + 14;
+                if (halfExponent <= 0)
+                {
+                    // Denormal
+                    return (uint16_t)std::lround(std::ldexp(f, 24));
+                }
+                uint32_t bits = (uint32_t)std::lround(std::ldexp(mantissa, 11)) - 1024;   // 10 bits plus rounding carry
+                return (uint16_t)(((uint32_t)halfExponent << 10) + bits);
+            }
+
+            float halfToFloat(uint16_t h)
+            {
+                uint32_t exponent = (h >> 10) & 0x1F;
+                uint32_t mantissa = h & 0x3FF;
+                float value = (exponent == 0) ? std::ldexp((float)mantissa, -24) : std::ldexp((float)(mantissa | 0x400), (int)exponent - 25);
+                return (h & 0x8000) ? -value : value;
+            }
+
+            /** Fit a line through a set of points and return the extreme projections on it.
+                Points are 'dims'-dimensional, stored with a stride of 4 floats.
+            */
+            void fitEndpoints(const float points[16][4], uint32_t dims, float e0[4], float e1[4])
+            {
+                float mean[4] = {};
+                float lo[4], hi[4];
+                for (uint32_t c = 0; c < dims; c++) { lo[c] = FLT_MAX; hi[c] = -FLT_MAX; }
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    for (uint32_t c = 0; c < dims; c++)
+                    {
+                        mean[c] += points[i][c];
+                        lo[c] = std::min(lo[c], points[i][c]);
+                        hi[c] = std::max(hi[c], points[i][c]);
+                    }
+                }
+                for (uint32_t c = 0; c < dims; c++) mean[c] /= 16.0f;
+
+                float cov[4][4] = {};
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    for (uint32_t a = 0; a < dims; a++)
+                    {
+                        for (uint32_t b = 0; b < dims; b++)
+                        {
+                            cov[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+                        }
+                    }
+                }
+
+                // Power iteration for the principal axis, starting from the bounding box diagonal
+                float axis[4] = {};
+                for (uint32_t c = 0; c < dims; c++) axis[c] = hi[c] - lo[c];
+                for (uint32_t iter = 0; iter < 8; iter++)
+                {
+                    float next[4] = {};
+                    float maxComponent = 0;
+                    for (uint32_t a = 0; a < dims; a++)
+                    {
+                        for (uint32_t b = 0; b < dims; b++) next[a] += cov[a][b] * axis[b];
+                        maxComponent = std::max(maxComponent, std::abs(next[a]));
+                    }
+                    if (maxComponent == 0) break;
+                    for (uint32_t c = 0; c < dims; c++) axis[c] = next[c] / maxComponent;
+                }
+
+                float lengthSq = 0;
+                for (uint32_t c = 0; c < dims; c++) lengthSq += axis[c] * axis[c];
+                if (lengthSq < 1e-12f)
+                {
+                    for (uint32_t c = 0; c < dims; c++) e0[c] = e1[c] = mean[c];
+                    return;
+                }
+
+                float tMin = FLT_MAX, tMax = -FLT_MAX;
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    float t = 0;
+                    for (uint32_t c = 0; c < dims; c++) t += (points[i][c] - mean[c]) * axis[c];
+                    tMin = std::min(tMin, t);
+                    tMax = std::max(tMax, t);
+                }
+                for (uint32_t c = 0; c < dims; c++)
+                {
+                    e0[c] = std::min(std::max(mean[c] + axis[c] * tMax / lengthSq, lo[c]), hi[c]);
+                    e1[c] = std::min(std::max(mean[c] + axis[c] * tMin / lengthSq, lo[c]), hi[c]);
+                }
+            }
+
+            uint32_t findClosest(const float point[4], uint32_t dims, const int32_t palette[][4], uint32_t paletteSize, float& error)
+            {
+                uint32_t best = 0;
+                error = FLT_MAX;
+                for (uint32_t i = 0; i < paletteSize; i++)
+                {
+                    float e = 0;
+                    for (uint32_t c = 0; c < dims; c++)
+                    {
+                        float d = point[c] - (float)palette[i][c];
+                        e += d * d;
+                    }
+                    if (e < error)
+                    {
+                        error = e;
+                        best = i;
+                    }
+                }
+                return best;
+            }
+
+            // BC1 color block
+
+            uint16_t packRgb565(const float rgb[4])
+            {
+                uint32_t r = (uint32_t)std::lround(std::min(std::max(rgb[0], 0.0f), 255.0f) * 31.0f / 255.0f);
+                uint32_t g = (uint32_t)std::lround(std::min(std::max(rgb[1], 0.0f), 255.0f) * 63.0f / 255.0f);
+                uint32_t b = (uint32_t)std::lround(std::min(std::max(rgb[2], 0.0f), 255.0f) * 31.0f / 255.0f);
+                return (uint16_t)((r << 11) | (g << 5) | b);
+            }
+
+            void unpackRgb565(uint16_t c, int32_t rgb[4])
+            {
+                uint32_t r = (c >> 11) & 0x1F, g = (c >> 5) & 0x3F, b = c & 0x1F;
+                rgb[0] = (r << 3) | (r >> 2);
+                rgb[1] = (g << 2) | (g >> 4);
+                rgb[2] = (b << 3) | (b >> 2);
+                rgb[3] = 255;
+            }
+
+            void createBc1Palette(uint16_t c0, uint16_t c1, int32_t palette[4][4])
+            {
+                unpackRgb565(c0, palette[0]);
+                unpackRgb565(c1, palette[1]);
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    if (c0 > c1)
+                    {
+                        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+                    }
+                    else
+                    {
+                        palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                        palette[3][c] = 0;
+                    }
+                }
+                palette[2][3] = 255;
+                palette[3][3] = (c0 > c1) ? 255 : 0;
+            }
+
+            // Expects c0 > c1, i.e. the 4-color mode
+            float computeBc1Indices(const float points[16][4], uint16_t c0, uint16_t c1, uint32_t& indices)
+            {
+                int32_t palette[4][4];
+                createBc1Palette(c0, c1, palette);
+                indices = 0;
+                float totalError = 0;
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    float error;
+                    indices |= findClosest(points[i], 3, palette, 4, error) << (2 * i);
+                    totalError += error;
+                }
+                return totalError;
+            }
+
+            void encodeBc1Block(const float points[16][4], uint8_t* pDst)
+            {
+                float e0[4], e1[4];
+                fitEndpoints(points, 3, e0, e1);
+                uint16_t a = packRgb565(e0), b = packRgb565(e1);
+                uint16_t c0 = std::max(a, b), c1 = std::min(a, b);
+
+                // Equal endpoints select the 3-color mode, where index 0 is still c0
+                uint32_t indices = 0;
+                if (c0 != c1)
+                {
+                    float error = computeBc1Indices(points, c0, c1, indices);
+
+                    // One least-squares refinement of the endpoints given the selected indices
+                    static const float kWeight[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+                    float aa = 0, bb = 0, ab = 0;
+                    float ax[3] = {}, bx[3] = {};
+                    for (uint32_t i = 0; i < 16; i++)
+                    {
+                        float wa = kWeight[(indices >> (2 * i)) & 3];
+                        float wb = 1.0f - wa;
+                        aa += wa * wa; bb += wb * wb; ab += wa * wb;
+                        for (uint32_t c = 0; c < 3; c++) { ax[c] += wa * points[i][c]; bx[c] += wb * points[i][c]; }
+                    }
+                    float det = aa * bb - ab * ab;
+                    if (std::abs(det) > 1e-6f)
+                    {
+                        float r0[4], r1[4];
+                        for (uint32_t c = 0; c < 3; c++)
+                        {
+                            r0[c] = (ax[c] * bb - bx[c] * ab) / det;
+                            r1[c] = (bx[c] * aa - ax[c] * ab) / det;
+                        }
+                        uint16_t n0 = packRgb565(r0), n1 = packRgb565(r1);
+                        if (n0 != n1)
+                        {
+                            uint32_t newIndices;
+                            float newError = computeBc1Indices(points, std::max(n0, n1), std::min(n0, n1), newIndices);
+                            if (newError < error)
+                            {
+                                c0 = std::max(n0, n1);
+                                c1 = std::min(n0, n1);
+                                indices = newIndices;
+                            }
+                        }
+                    }
+                }
+
+                std::memcpy(pDst, &c0, 2);
+                std::memcpy(pDst + 2, &c1, 2);
+                std::memcpy(pDst + 4, &indices, 4);
+            }
+
+            void decodeBc1Block(const uint8_t* pSrc, uint8_t texels[16][4], bool forceFourColors)
+            {
+                uint16_t c0, c1;
+                uint32_t indices;
+                std::memcpy(&c0, pSrc, 2);
+                std::memcpy(&c1, pSrc + 2, 2);
+                std::memcpy(&indices, pSrc + 4, 4);
+                int32_t palette[4][4];
+                if (forceFourColors && c0 <= c1)
+                {
+                    // BC2/BC3 color blocks always interpolate 4 colors
+                    unpackRgb565(c0, palette[0]);
+                    unpackRgb565(c1, palette[1]);
+                    for (uint32_t c = 0; c < 3; c++)
+                    {
+                        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+                    }
+                    palette[2][3] = palette[3][3] = 255;
+                }
+                else
+                {
+                    createBc1Palette(c0, c1, palette);
+                }
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    uint32_t index = (indices >> (2 * i)) & 3;
+                    for (uint32_t c = 0; c < 4; c++) texels[i][c] = (uint8_t)palette[index][c];
+                }
+            }
+
+            // BC4 single-channel block, also used for the BC3 alpha and the BC5 channels
+
+            void createBc4Palette(uint32_t a0, uint32_t a1, int32_t palette[8][4])
+            {
+                palette[0][0] = a0;
+                palette[1][0] = a1;
+                if (a0 > a1)
+                {
+                    for (uint32_t i = 1; i < 7; i++) palette[i + 1][0] = ((7 - i) * a0 + i * a1 + 3) / 7;
+                }
+                else
+                {
+                    for (uint32_t i = 1; i < 5; i++) palette[i + 1][0] = ((5 - i) * a0 + i * a1 + 2) / 5;
+                    palette[6][0] = 0;
+                    palette[7][0] = 255;
+                }
+            }
+
+            void encodeBc4Block(const float points[16][4], uint32_t channel, uint8_t* pDst)
+            {
+                float lo = 255.0f, hi = 0.0f;
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    lo = std::min(lo, points[i][channel]);
+                    hi = std::max(hi, points[i][channel]);
+                }
+                uint32_t a0 = (uint32_t)std::lround(hi);
+                uint32_t a1 = (uint32_t)std::lround(lo);
+
+                uint64_t indices = 0;
+                if (a0 > a1)
+                {
+                    int32_t palette[8][4];
+                    createBc4Palette(a0, a1, palette);
+                    for (uint32_t i = 0; i < 16; i++)
+                    {
+                        float value[4] = { points[i][channel] };
+                        float error;
+                        uint64_t index = findClosest(value, 1, palette, 8, error);
+                        indices |= index << (3 * i);
+                    }
+                }
+
+                pDst[0] = (uint8_t)a0;
+                pDst[1] = (uint8_t)a1;
+                for (uint32_t i = 0; i < 6; i++) pDst[2 + i] = (uint8_t)(indices >> (8 * i));
+            }
+
+            void decodeBc4Block(const uint8_t* pSrc, uint8_t texels[16][4], uint32_t channel)
+            {
+                int32_t palette[8][4];
+                createBc4Palette(pSrc[0], pSrc[1], palette);
+                uint64_t indices = 0;
+                for (uint32_t i = 0; i < 6; i++) indices |= (uint64_t)pSrc[2 + i] << (8 * i);
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    texels[i][channel] = (uint8_t)palette[(indices >> (3 * i)) & 7][0];
+                }
+            }
+
+            // BC7 mode 6: a single RGBA subset with 7-bit endpoints, per-endpoint P-bits and 4-bit indices
+
+            void quantizeBc7Endpoint(const float e[4], uint32_t q[4], uint32_t& pBit)
+            {
+                float bestError = FLT_MAX;
+                for (uint32_t p = 0; p < 2; p++)
+                {
+                    uint32_t candidate[4];
+                    float error = 0;
+                    for (uint32_t c = 0; c < 4; c++)
+                    {
+                        candidate[c] = (uint32_t)std::min(std::max(std::lround((e[c] - (float)p) / 2.0f), 0l), 127l);
+                        float d = (float)((candidate[c] << 1) | p) - e[c];
+                        error += d * d;
+                    }
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        pBit = p;
+                        std::memcpy(q, candidate, sizeof(candidate));
+                    }
+                }
+            }
+
+            void createBc7Palette(const uint32_t q0[4], uint32_t p0, const uint32_t q1[4], uint32_t p1, int32_t palette[16][4])
+            {
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    uint32_t v0 = (q0[c] << 1) | p0;
+                    uint32_t v1 = (q1[c] << 1) | p1;
+                    for (uint32_t i = 0; i < 16; i++) palette[i][c] = ((64 - kWeights4[i]) * v0 + kWeights4[i] * v1 + 32) >> 6;
+                }
+            }
+
+            void encodeBc7Block(const float points[16][4], uint8_t* pDst)
+            {
+                float e0[4], e1[4];
+                fitEndpoints(points, 4, e0, e1);
+                uint32_t q0[4], q1[4], p0, p1;
+                quantizeBc7Endpoint(e0, q0, p0);
+                quantizeBc7Endpoint(e1, q1, p1);
+
+                int32_t palette[16][4];
+                createBc7Palette(q0, p0, q1, p1, palette);
+                uint32_t indices[16];
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    float error;
+                    indices[i] = findClosest(points[i], 4, palette, 16, error);
+                }
+
+                // The MSB of the anchor index is implicit zero
+                if (indices[0] & 8)
+                {
+                    std::swap(q0, q1);
+                    std::swap(p0, p1);
+                    for (uint32_t i = 0; i < 16; i++) indices[i] = 15 - indices[i];
+                }
+
+                BitWriter writer;
+                writer.write(1 << 6, 7);
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    writer.write(q0[c], 7);
+                    writer.write(q1[c], 7);
+                }
+                writer.write(p0, 1);
+                writer.write(p1, 1);
+                writer.write(indices[0], 3);
+                for (uint32_t i = 1; i < 16; i++) writer.write(indices[i], 4);
+                writer.store(pDst);
+            }
+
+            void decodeBc7Block(const uint8_t* pSrc, uint8_t texels[16][4])
+            {
+                BitReader reader(pSrc);
+                if (reader.read(7) != (1 << 6))
+                {
+                    std::memset(texels, 0, 16 * 4);
+                    return;
+                }
+                uint32_t q0[4], q1[4];
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    q0[c] = reader.read(7);
+                    q1[c] = reader.read(7);
+                }
+                uint32_t p0 = reader.read(1);
+                uint32_t p1 = reader.read(1);
+                int32_t palette[16][4];
+                createBc7Palette(q0, p0, q1, p1, palette);
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    uint32_t index = reader.read(i == 0 ? 3 : 4);
+                    for (uint32_t c = 0; c < 4; c++) texels[i][c] = (uint8_t)palette[index][c];
+                }
+            }
+
+            // BC6H unsigned mode 11: a single RGB region with 10-bit endpoints and 4-bit indices.
+            // The encoder works on the half-float bit patterns, which is what the hardware interpolates.
+
+            uint32_t unquantizeBc6h(uint32_t q)
+            {
+                if (q == 0) return 0;
+                if (q == 1023) return 0xFFFF;
+                return ((q << 16) + 0x8000) >> 10;
+            }
+
+            uint32_t quantizeBc6h(float value)
+            {
+                // value is in the unquantized space. Pick the closest of the two candidates around the inverse mapping.
+                int32_t q = (int32_t)std::floor((value - 32.0f) / 64.0f);
+                uint32_t best = 0;
+                float bestError = FLT_MAX;
+                for (int32_t candidate = q; candidate <= q + 1; candidate++)
+                {
+                    uint32_t c = (uint32_t)std::min(std::max(candidate, 0), 1023);
+                    float error = std::abs((float)unquantizeBc6h(c) - value);
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        best = c;
+                    }
+                }
+                return best;
+            }
+
+            void createBc6hPalette(const uint32_t q0[4], const uint32_t q1[4], int32_t palette[16][4])
+            {
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    uint32_t u0 = unquantizeBc6h(q0[c]);
+                    uint32_t u1 = unquantizeBc6h(q1[c]);
+                    for (uint32_t i = 0; i < 16; i++)
+                    {
+                        uint32_t interpolated = ((64 - kWeights4[i]) * u0 + kWeights4[i] * u1 + 32) >> 6;
+                        palette[i][c] = (interpolated * 31) >> 6;  // Final half-float bit pattern
+                    }
+                }
+            }
+
+            void encodeBc6hBlock(const float halfBits[16][4], uint8_t* pDst)
+            {
+                // Fit in the unquantized space, where the palette is linear
+                float points[16][4];
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    for (uint32_t c = 0; c < 3; c++) points[i][c] = halfBits[i][c] * (64.0f / 31.0f);
+                }
+                float e0[4], e1[4];
+                fitEndpoints(points, 3, e0, e1);
+                uint32_t q0[4], q1[4];
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    q0[c] = quantizeBc6h(e0[c]);
+                    q1[c] = quantizeBc6h(e1[c]);
+                }
+
+                int32_t palette[16][4];
+                createBc6hPalette(q0, q1, palette);
+                uint32_t indices[16];
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    float error;
+                    indices[i] = findClosest(halfBits[i], 3, palette, 16, error);
+                }
+
+                if (indices[0] & 8)
+                {
+                    std::swap(q0, q1);
+                    for (uint32_t i = 0; i < 16; i++) indices[i] = 15 - indices[i];
+                }
+
+                BitWriter writer;
+                writer.write(0x3, 5);
+                for (uint32_t c = 0; c < 3; c++) writer.write(q0[c], 10);
+                for (uint32_t c = 0; c < 3; c++) writer.write(q1[c], 10);
+                writer.write(indices[0], 3);
+                for (uint32_t i = 1; i < 16; i++) writer.write(indices[i], 4);
+                writer.store(pDst);
+            }
+
+            void decodeBc6hBlock(const uint8_t* pSrc, float texels[16][4])
+            {
+                BitReader reader(pSrc);
+                if (reader.read(5) != 0x3)
+                {
+                    std::memset(texels, 0, 16 * 4 * sizeof(float));
+                    return;
+                }
+                uint32_t q0[4], q1[4];
+                for (uint32_t c = 0; c < 3; c++) q0[c] = reader.read(10);
+                for (uint32_t c = 0; c < 3; c++) q1[c] = reader.read(10);
+                int32_t palette[16][4];
+                createBc6hPalette(q0, q1, palette);
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    uint32_t index = reader.read(i == 0 ? 3 : 4);
+                    for (uint32_t c = 0; c < 3; c++) texels[i][c] = halfToFloat((uint16_t)palette[index][c]);
+                    texels[i][3] = 1.0f;
+                }
+            }
+
+            uint32_t getBlockSize(ResourceFormat format)
+            {
+                return (format == ResourceFormat::BC1Unorm || format == ResourceFormat::BC4Unorm) ? 8 : 16;
+            }
+
+            // sRGB <-> linear, used by the mip filter
+            float srgbToLinear(float c)
+            {
+                return (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+
+            float linearToSrgb(float c)
+            {
+                return (c <= 0.0031308f) ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+            }
+        }
+
+        bool isFormatSupported(ResourceFormat format)
+        {
+            switch (format)
+            {
+            case ResourceFormat::BC1Unorm:
+            case ResourceFormat::BC3Unorm:
+            case ResourceFormat::BC4Unorm:
+            case ResourceFormat::BC5Unorm:
+            case ResourceFormat::BC6HU16:
+            case ResourceFormat::BC7Unorm:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        ResourceFormat getUncompressedFormat(ResourceFormat format)
+        {
+            assert(isFormatSupported(format));
+            return (format == ResourceFormat::BC6HU16) ? ResourceFormat::RGBA32Float : ResourceFormat::RGBA8Unorm;
+        }
+
+        size_t getCompressedSize(ResourceFormat format, uint32_t width, uint32_t height)
+        {
+            return size_t((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(format);
+        }
+
+        std::vector<uint8_t> compress(ResourceFormat format, uint32_t width, uint32_t height, const void* pSrc)
+        {
+            assert(isFormatSupported(format));
+            uint32_t blocksX = (width + 3) / 4;
+            uint32_t blocksY = (height + 3) / 4;
+            uint32_t blockSize = getBlockSize(format);
+            std::vector<uint8_t> blocks(getCompressedSize(format, width, height));
+
+            bool isFloat = (format == ResourceFormat::BC6HU16);
+            const uint8_t* pSrc8 = (const uint8_t*)pSrc;
+            const float* pSrc32 = (const float*)pSrc;
+
+            parallelFor(blocksY, 1, [&](uint32_t begin, uint32_t end)
+            {
+                float points[16][4];
+                for (uint32_t by = begin; by < end; by++)
+                {
+                    for (uint32_t bx = 0; bx < blocksX; bx++)
+                    {
+                        // Gather the block, replicating the image edges
+                        for (uint32_t i = 0; i < 16; i++)
+                        {
+                            uint32_t x = std::min(bx * 4 + (i % 4), width - 1);
+                            uint32_t y = std::min(by * 4 + (i / 4), height - 1);
+                            size_t texel = (size_t(y) * width + x) * 4;
+                            for (uint32_t c = 0; c < 4; c++)
+                            {
+                                points[i][c] = isFloat ? (float)floatToHalf(pSrc32[texel + c]) : (float)pSrc8[texel + c];
+                            }
+                        }
+
+                        uint8_t* pDst = blocks.data() + (size_t(by) * blocksX + bx) * blockSize;
+                        switch (format)
+                        {
+                        case ResourceFormat::BC1Unorm:
+                            encodeBc1Block(points, pDst);
+                            break;
+                        case ResourceFormat::BC3Unorm:
+                            encodeBc4Block(points, 3, pDst);
+                            encodeBc1Block(points, pDst + 8);
+                            break;
+                        case ResourceFormat::BC4Unorm:
+                            encodeBc4Block(points, 0, pDst);
+                            break;
+                        case ResourceFormat::BC5Unorm:
+                            encodeBc4Block(points, 0, pDst);
+                            encodeBc4Block(points, 1, pDst + 8);
+                            break;
+                        case ResourceFormat::BC6HU16:
+                            encodeBc6hBlock(points, pDst);
+                            break;
+                        case ResourceFormat::BC7Unorm:
+                            encodeBc7Block(points, pDst);
+                            break;
+                        default:
+                            should_not_get_here();
+                        }
+                    }
+                }
+            });
+            return blocks;
+        }
+
+        std::vector<uint8_t> decompress(ResourceFormat format, uint32_t width, uint32_t height, const void* pBlocks)
+        {
+            assert(isFormatSupported(format));
+            uint32_t blocksX = (width + 3) / 4;
+            uint32_t blocksY = (height + 3) / 4;
+            uint32_t blockSize = getBlockSize(format);
+            bool isFloat = (format == ResourceFormat::BC6HU16);
+            uint32_t texelSize = isFloat ? 16 : 4;
+            std::vector<uint8_t> image(size_t(width) * height * texelSize);
+
+            parallelFor(blocksY, 1, [&](uint32_t begin, uint32_t end)
+            {
+                uint8_t texels[16][4];
+                float texels32[16][4];
+                for (uint32_t by = begin; by < end; by++)
+                {
+                    for (uint32_t bx = 0; bx < blocksX; bx++)
+                    {
+                        const uint8_t* pSrc = (const uint8_t*)pBlocks + (size_t(by) * blocksX + bx) * blockSize;
+                        for (uint32_t i = 0; i < 16; i++)
+                        {
+                            texels[i][0] = texels[i][1] = texels[i][2] = 0;
+                            texels[i][3] = 255;
+                        }
+                        switch (format)
+                        {
+                        case ResourceFormat::BC1Unorm:
+                            decodeBc1Block(pSrc, texels, false);
+                            break;
+                        case ResourceFormat::BC3Unorm:
+                            decodeBc1Block(pSrc + 8, texels, true);
+                            decodeBc4Block(pSrc, texels, 3);
+                            break;
+                        case ResourceFormat::BC4Unorm:
+                            decodeBc4Block(pSrc, texels, 0);
+                            break;
+                        case ResourceFormat::BC5Unorm:
+                            decodeBc4Block(pSrc, texels, 0);
+                            decodeBc4Block(pSrc + 8, texels, 1);
+                            break;
+                        case ResourceFormat::BC6HU16:
+                            decodeBc6hBlock(pSrc, texels32);
+                            break;
+                        case ResourceFormat::BC7Unorm:
+                            decodeBc7Block(pSrc, texels);
+                            break;
+                        default:
+                            should_not_get_here();
+                        }
+
+                        for (uint32_t i = 0; i < 16; i++)
+                        {
+                            uint32_t x = bx * 4 + (i % 4);
+                            uint32_t y = by * 4 + (i / 4);
+                            if (x >= width || y >= height) continue;
+                            uint8_t* pDst = image.data() + (size_t(y) * width + x) * texelSize;
+                            if (isFloat) std::memcpy(pDst, texels32[i], 16);
+                            else std::memcpy(pDst, texels[i], 4);
+                        }
+                    }
+                }
+            });
+            return image;
+        }
+
+        std::vector<uint8_t> generateMipLevel(ResourceFormat format, uint32_t width, uint32_t height, const void* pSrc, bool isSrgb)
+        {
+            assert(format == ResourceFormat::RGBA8Unorm || format == ResourceFormat::RGBA32Float);
+            bool isFloat = (format == ResourceFormat::RGBA32Float);
+            uint32_t dstWidth = std::max(1u, width / 2);
+            uint32_t dstHeight = std::max(1u, height / 2);
+            uint32_t texelSize = isFloat ? 16 : 4;
+            std::vector<uint8_t> mip(size_t(dstWidth) * dstHeight * texelSize);
+
+            static float sSrgbToLinear[256];
+            static bool sTableInitialized = [] { for (uint32_t i = 0; i < 256; i++) sSrgbToLinear[i] = srgbToLinear(i / 255.0f); return true; }();
+            (void)sTableInitialized;
+
+            parallelFor(dstHeight, 16, [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t y = begin; y < end; y++)
+                {
+                    // Odd sizes fold the last row/column into the last texel, so it averages a 3-wide footprint instead of dropping it
+                    uint32_t y0 = y * 2, y1 = (y == dstHeight - 1) ? height : std::min(y * 2 + 2, height);
+                    for (uint32_t x = 0; x < dstWidth; x++)
+                    {
+                        uint32_t x0 = x * 2, x1 = (x == dstWidth - 1) ? width : std::min(x * 2 + 2, width);
+                        float weight = 1.0f / float((x1 - x0) * (y1 - y0));
+                        size_t dst = size_t(y) * dstWidth + x;
+                        for (uint32_t c = 0; c < 4; c++)
+                        {
+                            if (isFloat)
+                            {
+                                const float* pSrc32 = (const float*)pSrc;
+                                float sum = 0;
+                                for (uint32_t sy = y0; sy < y1; sy++)
+                                {
+                                    for (uint32_t sx = x0; sx < x1; sx++) sum += pSrc32[(size_t(sy) * width + sx) * 4 + c];
+                                }
+                                ((float*)mip.data())[dst * 4 + c] = sum * weight;
+                            }
+                            else
+                            {
+                                const uint8_t* pSrc8 = (const uint8_t*)pSrc;
+                                bool linearize = isSrgb && c < 3;
+                                float sum = 0;
+                                for (uint32_t sy = y0; sy < y1; sy++)
+                                {
+                                    for (uint32_t sx = x0; sx < x1; sx++)
+                                    {
+                                        uint8_t v = pSrc8[(size_t(sy) * width + sx) * 4 + c];
+                                        sum += linearize ? sSrgbToLinear[v] : v / 255.0f;
+                                    }
+                                }
+                                float value = sum * weight;
+                                if (linearize) value = linearToSrgb(value);
+                                mip[dst * 4 + c] = (uint8_t)std::lround(std::min(std::max(value, 0.0f), 1.0f) * 255.0f);
+                            }
+                        }
+                    }
+                }
+            });
+            return mip;
+        }
+    }
+}
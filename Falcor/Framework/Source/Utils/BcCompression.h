@@ -0,0 +1,80 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include "API/Formats.h"
+
+namespace Falcor
+{
+    /** CPU encoder and decoder for block-compressed texture formats.
+        The encoders expect RGBA8Unorm source data, except BC6HU16 which expects RGBA32Float. Images are processed in parallel, one row of blocks per task.
+        Image sizes don't have to be a multiple of the block size. The edge blocks replicate the last row/column of the image.
+        The encoder emits a single block mode per format: 4-color blocks for BC1, mode 6 for BC7 and mode 11 for BC6H.
+    */
+    namespace BcCompression
+    {
+        /** Check if the encoder supports a format. Supported formats are BC1Unorm, BC3Unorm, BC4Unorm, BC5Unorm, BC6HU16 and BC7Unorm.
+        */
+        bool isFormatSupported(ResourceFormat format);
+
+        /** Get the source format expected by compress() and returned by decompress()
+        */
+        ResourceFormat getUncompressedFormat(ResourceFormat format);
+
+        /** Get the size in bytes of a compressed image
+        */
+        size_t getCompressedSize(ResourceFormat format, uint32_t width, uint32_t height);
+
+        /** Compress an image.
+            \param[in] format The compressed format
+            \param[in] width The image width
+            \param[in] height The image height
+            \param[in] pSrc The image data in the format returned by getUncompressedFormat(), tightly packed
+            \return The compressed blocks, in row-major order
+        */
+        std::vector<uint8_t> compress(ResourceFormat format, uint32_t width, uint32_t height, const void* pSrc);
+
+        /** Decompress an image. Only the block modes emitted by compress() are supported for BC6H and BC7, other blocks decode to zero.
+            \param[in] format The compressed format
+            \param[in] width The image width
+            \param[in] height The image height
+            \param[in] pBlocks The compressed blocks
+            \return The image data in the format returned by getUncompressedFormat()
+        */
+        std::vector<uint8_t> decompress(ResourceFormat format, uint32_t width, uint32_t height, const void* pBlocks);
+
+        /** Create the next level of a mip-chain using a box filter. The size of the result is max(1, width / 2) x max(1, height / 2). For odd sizes the last row/column is averaged into the last texel.
+            \param[in] format The image format. Either RGBA8Unorm or RGBA32Float.
+            \param[in] width The image width
+            \param[in] height The image height
+            \param[in] pSrc The image data
+            \param[in] isSrgb For RGBA8Unorm images, whether the color channels are sRGB-encoded. The filtering is done in linear space in that case.
+        */
+        std::vector<uint8_t> generateMipLevel(ResourceFormat format, uint32_t width, uint32_t height, const void* pSrc, bool isSrgb);
+    }
+}
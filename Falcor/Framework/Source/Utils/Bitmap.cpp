@@ -33,6 +33,7 @@
 #include <cstring>
 #include "StringUtils.h"
 #include "API/Texture.h"
+#include "Utils/ImageProcessing.h"
 
 namespace Falcor
 {
@@ -123,29 +124,38 @@ namespace Falcor
             return nullptr;
         }
 
-        // Convert the image to RGBX image
+        // FreeImage stores the image bottom-up with padded rows. Copy it to a tightly packed buffer, adding an alpha channel to RGB images.
+        const uint8_t* pBits = FreeImage_GetBits(pDib);
+        size_t pitch = FreeImage_GetPitch(pDib);
+        uint32_t srcBpp = bpp;
         if(bpp == 24)
         {
             logWarning("Converting 24-bit texture to 32-bit");
             bpp = 32;
-            auto pNew = FreeImage_ConvertTo32Bits(pDib);
-            FreeImage_Unload(pDib);
-            pDib = pNew;
         }
 
         if (!rgb32FloatSupported && bpp == 96)
         {
             logWarning("Converting 96-bit texture to 128-bit");
             bpp = 128;
-            auto pNew = FreeImage_ConvertToRGBAF(pDib);
-            FreeImage_Unload(pDib);
-            pDib = pNew;
         }
 
         uint32_t bytesPerPixel = bpp / 8;
+        size_t rowSize = pBmp->mWidth * bytesPerPixel;
 
-        pBmp->mpData = new uint8_t[pBmp->mHeight * pBmp->mWidth * bytesPerPixel];
-        FreeImage_ConvertToRawBits(pBmp->mpData, pDib, pBmp->mWidth * bytesPerPixel, bpp, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, isTopDown);
+        pBmp->mpData = new uint8_t[pBmp->mHeight * rowSize];
+        if (srcBpp == 24)
+        {
+            ImageProcessing::convertChannelCount(pBmp->mWidth, pBmp->mHeight, 1, 3, pBits, pitch, 4, pBmp->mpData, rowSize, ImageProcessing::kAlphaOneUnorm8, isTopDown);
+        }
+        else if (srcBpp != bpp)
+        {
+            ImageProcessing::convertChannelCount(pBmp->mWidth, pBmp->mHeight, 4, 3, pBits, pitch, 4, pBmp->mpData, rowSize, ImageProcessing::kAlphaOneFloat, isTopDown);
+        }
+        else
+        {
+            ImageProcessing::copyRows(uint32_t(rowSize), pBmp->mHeight, pBits, pitch, pBmp->mpData, rowSize, isTopDown);
+        }
 
         FreeImage_Unload(pDib);
         return UniqueConstPtr(pBmp);
@@ -275,21 +285,11 @@ namespace Falcor
         FIBITMAP* pImage = nullptr;
         uint32_t bytesPerPixel = getFormatBytesPerBlock(resourceFormat);
 
-        //TODO replace this code for swapping channels. Can't use freeimage masks b/c they only care about 16 bpp images
-        //issue #74 in gitlab
+        // FreeImage expects BGRA. Can't use freeimage masks b/c they only care about 16 bpp images
         if (resourceFormat == ResourceFormat::RGBA8Unorm || resourceFormat == ResourceFormat::RGBA8Snorm || resourceFormat == ResourceFormat::RGBA8UnormSrgb)
         {
-            for (uint32_t a = 0; a < width*height; a++)
-            {
-                uint32_t* pPixel = (uint32_t*)pData;
-                pPixel += a;
-                uint8_t* ch = (uint8_t*)pPixel;
-                std::swap(ch[0], ch[2]);
-                if (is_set(exportFlags, ExportFlags::ExportAlpha) == false)
-                {
-                    ch[3] = 0xff;
-                }
-            }
+            uint8_t alpha = is_set(exportFlags, ExportFlags::ExportAlpha) ? 3 : ImageProcessing::kOne;
+            ImageProcessing::swizzleRgba8(width, height, pData, width * 4, pData, width * 4, { 2, 1, 0, alpha }, false);
         }
 
         if (fileFormat == Bitmap::FileFormat::PfmFile || fileFormat == Bitmap::FileFormat::ExrFile)
@@ -326,25 +326,16 @@ namespace Falcor
             bool scanlineCopy = exportAlpha ? bytesPerPixel == 16 : bytesPerPixel == 12;
 
             pImage = FreeImage_AllocateT(exportAlpha ? FIT_RGBAF : FIT_RGBF, width, height);
-            BYTE* head = (BYTE*)pData;
-            for(unsigned y = 0; y < height; y++) 
+            BYTE* pBits = FreeImage_GetBits(pImage);
+            size_t pitch = FreeImage_GetPitch(pImage);
+            if(scanlineCopy)
             {
-                float* dstBits = (float*)FreeImage_GetScanLine(pImage, height - y - 1);
-                if(scanlineCopy)
-                {
-                    std::memcpy(dstBits, head, bytesPerPixel * width);
-                }
-                else
-                {
-                    assert(exportAlpha == false);
-                    for(unsigned x = 0; x < width; x++) 
-                    {
-                        dstBits[x*3 + 0] = (((float*)head)[x*4 + 0]);
-                        dstBits[x*3 + 1] = (((float*)head)[x*4 + 1]);
-                        dstBits[x*3 + 2] = (((float*)head)[x*4 + 2]);
-                    }
-                }
-                head += bytesPerPixel * width;
+                ImageProcessing::copyRows(bytesPerPixel * width, height, pData, bytesPerPixel * width, pBits, pitch, true);
+            }
+            else
+            {
+                assert(exportAlpha == false);
+                ImageProcessing::convertChannelCount(width, height, 4, 4, pData, bytesPerPixel * width, 3, pBits, pitch, 0, true);
             }
 
             if(fileFormat == Bitmap::FileFormat::ExrFile)
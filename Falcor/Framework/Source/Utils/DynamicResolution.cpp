@@ -0,0 +1,116 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Falcor
+{
+    DynamicResolutionController::DynamicResolutionController(const Desc& desc)
+    {
+        setDesc(desc);
+    }
+
+    void DynamicResolutionController::setDesc(const Desc& desc)
+    {
+        mDesc = desc;
+        assert(mDesc.minScale > 0 && mDesc.minScale <= mDesc.maxScale);
+        reset();
+    }
+
+    void DynamicResolutionController::reset()
+    {
+        mScale = mDesc.maxScale;
+        mCost = 0;
+        mFramesWithHeadroom = 0;
+    }
+
+    float DynamicResolutionController::quantize(float scale) const
+    {
+        // Round down, with some slack so a scale computed as an exact multiple doesn't lose a step to float error
+        if (mDesc.scaleStep > 0) scale = std::floor(scale / mDesc.scaleStep + 1e-3f) * mDesc.scaleStep;
+        return std::min(std::max(scale, mDesc.minScale), mDesc.maxScale);
+    }
+
+    float DynamicResolutionController::getScaleForTime(float time) const
+    {
+        // The largest scale predicted to take at most 'time'
+        return quantize(std::sqrt(time / mCost));
+    }
+
+    float DynamicResolutionController::update(float frameTime, float measuredScale)
+    {
+        if (frameTime <= 0 || measuredScale <= 0) return mScale;
+
+        // Normalize to a full-resolution frame
+        float cost = frameTime / (measuredScale * measuredScale);
+        mCost = (mCost == 0) ? cost : mCost + (cost - mCost) * mDesc.smoothing;
+
+        // Spikes don't wait for the average
+        if (frameTime > mDesc.targetFrameTime * mDesc.panicRatio) mCost = std::max(mCost, cost);
+
+        const float target = mDesc.targetFrameTime;
+        const float headroomTime = target * mDesc.headroom;
+        float predicted = mCost * mScale * mScale;
+
+        if (predicted > target)
+        {
+            // Drop straight to a scale with headroom, so the next frames land between the two thresholds
+            mScale = std::min(mScale, getScaleForTime(headroomTime));
+            mFramesWithHeadroom = 0;
+        }
+        else
+        {
+            float upScale = getScaleForTime(headroomTime);
+            if (upScale > mScale)
+            {
+                if (++mFramesWithHeadroom >= mDesc.upscaleDelay)
+                {
+                    mScale = upScale;
+                    mFramesWithHeadroom = 0;
+                }
+            }
+            else
+            {
+                mFramesWithHeadroom = 0;
+            }
+        }
+        return mScale;
+    }
+
+    glm::uvec2 DynamicResolutionController::getRenderSize(const glm::uvec2& fullSize, float scale)
+    {
+        glm::uvec2 size;
+        for (int i = 0; i < 2; i++)
+        {
+            size[i] = std::max(1u, std::min(fullSize[i], (uint32_t)std::lround(fullSize[i] * scale)));
+        }
+        return size;
+    }
+}
@@ -0,0 +1,92 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "glm/vec2.hpp"
+
+namespace Falcor
+{
+    /** Picks the internal render resolution from measured GPU frame times, to keep the frame within a budget.
+        The cost of a frame is modeled as proportional to the pixel count, so each sample gives an estimate of the time a full-resolution frame would take.
+        The estimate is smoothed over time. The resolution drops as soon as the predicted time is over budget, and only goes back up after the
+        predicted time at the higher resolution has been under the headroom for a number of frames. The gap between the two thresholds keeps it from oscillating.
+        The controller is CPU only, the caller measures the frames (see RenderingPipeline).
+    */
+    class DynamicResolutionController
+    {
+    public:
+        struct Desc
+        {
+            float targetFrameTime = 16.0f;  ///< Budget for the measured passes, in milliseconds
+            float minScale = 0.5f;          ///< Smallest per-axis scale
+            float maxScale = 1.0f;          ///< Largest per-axis scale
+            float scaleStep = 0.05f;        ///< The scale is a multiple of this, so small changes in the timings don't change the resolution
+            float smoothing = 0.2f;         ///< Weight of a new sample in the exponential moving average of the cost
+            float headroom = 0.85f;         ///< Fraction of the budget the predicted time must fit in. Used for the scale picked after a drop, and to go back up.
+            uint32_t upscaleDelay = 30;     ///< Number of consecutive frames with headroom before the resolution goes up
+            float panicRatio = 1.25f;       ///< A single frame over this fraction of the budget drops the resolution without waiting for the average
+        };
+
+        DynamicResolutionController(const Desc& desc);
+
+        /** Add a frame time measurement and pick the scale for the next frame
+            \param[in] frameTime Measured GPU time of the frame, in milliseconds. Samples <= 0 are ignored.
+            \param[in] measuredScale The scale the measured frame was rendered at. GPU timings arrive a few frames late, so this may differ from getScale().
+            \return The new per-axis scale
+        */
+        float update(float frameTime, float measuredScale);
+
+        /** Get the current per-axis scale
+        */
+        float getScale() const { return mScale; }
+
+        /** Get the predicted time of a full-resolution frame, in milliseconds. 0 until the first sample.
+        */
+        float getFullResolutionTime() const { return mCost; }
+
+        /** Get the render size for a full size, using the current scale. Each dimension is at least 1.
+        */
+        glm::uvec2 getRenderSize(const glm::uvec2& fullSize) const { return getRenderSize(fullSize, mScale); }
+        static glm::uvec2 getRenderSize(const glm::uvec2& fullSize, float scale);
+
+        /** Forget the timing history and go back to the maximum scale
+        */
+        void reset();
+
+        const Desc& getDesc() const { return mDesc; }
+        void setDesc(const Desc& desc);
+
+    private:
+        float quantize(float scale) const;
+        float getScaleForTime(float time) const;
+
+        Desc mDesc;
+        float mScale = 1;
+        float mCost = 0;
+        uint32_t mFramesWithHeadroom = 0;
+    };
+}
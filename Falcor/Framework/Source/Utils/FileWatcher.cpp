@@ -0,0 +1,249 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "FileWatcher.h"
+#include <experimental/filesystem>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <chrono>
+
+#ifndef _WIN32
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::experimental::filesystem;
+
+namespace Falcor
+{
+    namespace
+    {
+        time_t getModifiedTime(const std::string& filename)
+        {
+            struct stat s;
+            return (stat(filename.c_str(), &s) == 0) ? s.st_mtime : 0;
+        }
+
+        void splitPath(const std::string& path, std::string& dir, std::string& file)
+        {
+            fs::path p(path);
+            dir = p.parent_path().string();
+            file = p.filename().string();
+        }
+    }
+
+    FileWatcher::SharedPtr FileWatcher::create(const ChangeCallback& callback, uint32_t pollIntervalMs)
+    {
+        return SharedPtr(new FileWatcher(callback, pollIntervalMs));
+    }
+
+    FileWatcher::FileWatcher(const ChangeCallback& callback, uint32_t pollIntervalMs) : mCallback(callback), mPollIntervalMs(pollIntervalMs)
+    {
+#ifndef _WIN32
+        mInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (mInotifyFd < 0)
+        {
+            logWarning("FileWatcher: inotify_init1() failed, falling back to polling file modification times");
+        }
+#endif
+        mThread = std::thread(&FileWatcher::threadFunc, this);
+    }
+
+    FileWatcher::~FileWatcher()
+    {
+        mTerminate = true;
+        if (mThread.joinable()) mThread.join();
+#ifndef _WIN32
+        if (mInotifyFd >= 0) close(mInotifyFd);
+#endif
+    }
+
+    std::string FileWatcher::canonicalizePath(const std::string& filename)
+    {
+        std::string path = filename;
+        std::replace(path.begin(), path.end(), '\\', '/');
+        std::error_code ec;
+        fs::path canon = fs::canonical(path, ec);
+        return ec ? path : canon.string();
+    }
+
+    bool FileWatcher::watchFile(const std::string& filename)
+    {
+        std::string path = canonicalizePath(filename);
+        if (fs::exists(path) == false) return false;
+
+        std::string dir, file;
+        splitPath(path, dir, file);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto& directory = mDirectories[dir];
+        if (directory.files.empty())
+        {
+#ifndef _WIN32
+            if (mInotifyFd >= 0)
+            {
+                // Watch the directory rather than the file: editors which save through a temporary file replace the inode, which would silently drop a file watch.
+                directory.watchHandle = inotify_add_watch(mInotifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+                if (directory.watchHandle < 0)
+                {
+                    logWarning("FileWatcher: can't watch directory '" + dir + "'");
+                    mDirectories.erase(dir);
+                    return false;
+                }
+                mWatchHandles[directory.watchHandle] = dir;
+            }
+#endif
+        }
+        directory.files.insert(file);
+        if (mInotifyFd < 0) mFileTimes[path] = getModifiedTime(path);
+        return true;
+    }
+
+    void FileWatcher::unwatchFile(const std::string& filename)
+    {
+        std::string path = canonicalizePath(filename);
+        std::string dir, file;
+        splitPath(path, dir, file);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mDirectories.find(dir);
+        if (it == mDirectories.end()) return;
+
+        it->second.files.erase(file);
+        mFileTimes.erase(path);
+        if (it->second.files.empty())
+        {
+#ifndef _WIN32
+            if (it->second.watchHandle >= 0)
+            {
+                inotify_rm_watch(mInotifyFd, it->second.watchHandle);
+                mWatchHandles.erase(it->second.watchHandle);
+            }
+#endif
+            mDirectories.erase(it);
+        }
+    }
+
+    bool FileWatcher::isWatching(const std::string& filename) const
+    {
+        std::string path = canonicalizePath(filename);
+        std::string dir, file;
+        splitPath(path, dir, file);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mDirectories.find(dir);
+        return it != mDirectories.end() && it->second.files.count(file) != 0;
+    }
+
+    std::vector<std::string> FileWatcher::getChangedFiles()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::vector<std::string> changed;
+        changed.swap(mChangedFiles);
+        mChangedSet.clear();
+        return changed;
+    }
+
+    void FileWatcher::onFileChanged(const std::string& filename)
+    {
+        // Called with the mutex held
+        if (mChangedSet.insert(filename).second)
+        {
+            mChangedFiles.push_back(filename);
+        }
+    }
+
+    void FileWatcher::pollForChanges()
+    {
+        std::vector<std::string> changed;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (auto& f : mFileTimes)
+            {
+                time_t t = getModifiedTime(f.first);
+                if (t != f.second)
+                {
+                    f.second = t;
+                    onFileChanged(f.first);
+                    changed.push_back(f.first);
+                }
+            }
+        }
+
+        if (mCallback)
+        {
+            for (const auto& f : changed) mCallback(f);
+        }
+    }
+
+    void FileWatcher::threadFunc()
+    {
+        while (mTerminate == false)
+        {
+#ifndef _WIN32
+            if (mInotifyFd >= 0)
+            {
+                pollfd pfd = { mInotifyFd, POLLIN, 0 };
+                if (poll(&pfd, 1, (int)mPollIntervalMs) <= 0) continue;
+
+                alignas(inotify_event) char buffer[16 * 1024];
+                std::vector<std::string> changed;
+                ssize_t length;
+                while ((length = read(mInotifyFd, buffer, sizeof(buffer))) > 0)
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    for (ssize_t offset = 0; offset < length;)
+                    {
+                        const inotify_event* pEvent = reinterpret_cast<const inotify_event*>(buffer + offset);
+                        offset += sizeof(inotify_event) + pEvent->len;
+                        if (pEvent->len == 0) continue;
+
+                        auto dirIt = mWatchHandles.find(pEvent->wd);
+                        if (dirIt == mWatchHandles.end()) continue;
+                        const auto& files = mDirectories.at(dirIt->second).files;
+                        if (files.count(pEvent->name) == 0) continue;
+
+                        std::string path = dirIt->second + '/' + pEvent->name;
+                        onFileChanged(path);
+                        changed.push_back(path);
+                    }
+                }
+
+                if (mCallback)
+                {
+                    for (const auto& f : changed) mCallback(f);
+                }
+                continue;
+            }
+#endif
+            pollForChanges();
+            std::this_thread::sleep_for(std::chrono::milliseconds(mPollIntervalMs));
+        }
+    }
+}
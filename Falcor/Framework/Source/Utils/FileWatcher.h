@@ -0,0 +1,106 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+namespace Falcor
+{
+    /** Watches a set of files for modifications on a background thread.
+        On Linux the watcher registers an inotify watch for every directory containing a watched file, so editors which save by
+        writing in place as well as editors which save by renaming a temporary file are both detected. On other platforms the
+        watcher falls back to polling the modification time of the watched files.
+        Changes are accumulated until the owner calls getChangedFiles(), which allows the changes to be consumed at a well defined point (e.g. a frame boundary).
+    */
+    class FileWatcher
+    {
+    public:
+        using SharedPtr = std::shared_ptr<FileWatcher>;
+        using ChangeCallback = std::function<void(const std::string&)>;
+
+        /** Create a new watcher.
+            \param[in] callback Optional function to call from the watcher thread whenever a watched file changes.
+            \param[in] pollIntervalMs The interval at which the watcher thread checks for changes and for termination.
+        */
+        static SharedPtr create(const ChangeCallback& callback = {}, uint32_t pollIntervalMs = 50);
+        ~FileWatcher();
+
+        /** Start watching a file. The file path is canonicalized, so the same file can be registered using different paths.
+            \return false if the file doesn't exist or its directory can't be watched, otherwise true
+        */
+        bool watchFile(const std::string& filename);
+
+        /** Stop watching a file.
+        */
+        void unwatchFile(const std::string& filename);
+
+        /** Check whether a file is being watched.
+        */
+        bool isWatching(const std::string& filename) const;
+
+        /** Get the canonical paths of all the files which changed since the last call. Each file is reported once, regardless of the number of events it triggered.
+        */
+        std::vector<std::string> getChangedFiles();
+
+        /** Canonicalize a path the same way the watcher does. Useful when comparing the results of getChangedFiles() with other paths.
+        */
+        static std::string canonicalizePath(const std::string& filename);
+
+    private:
+        FileWatcher(const ChangeCallback& callback, uint32_t pollIntervalMs);
+        void threadFunc();
+        void pollForChanges();
+        void onFileChanged(const std::string& filename);
+
+        struct Directory
+        {
+            int watchHandle = -1;
+            std::unordered_set<std::string> files;  // File names, relative to the directory
+        };
+
+        ChangeCallback mCallback;
+        uint32_t mPollIntervalMs;
+
+        mutable std::mutex mMutex;
+        std::unordered_map<std::string, Directory> mDirectories;
+        std::unordered_map<int, std::string> mWatchHandles;
+        std::unordered_map<std::string, time_t> mFileTimes;     // Only used when polling
+        std::vector<std::string> mChangedFiles;
+        std::unordered_set<std::string> mChangedSet;
+
+        int mInotifyFd = -1;
+        std::atomic<bool> mTerminate{ false };
+        std::thread mThread;
+    };
+}
@@ -0,0 +1,242 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "FrameBatchStream.h"
+#include "Utils/CpuTimer.h"
+#include <chrono>
+#include <cstring>
+
+namespace Falcor
+{
+    // Channels start on a cache line, which also satisfies the alignment of every element type
+    static const size_t kChannelAlignment = 64;
+
+    FrameBatchStream::SharedPtr FrameBatchStream::create(const Desc& desc)
+    {
+        if (desc.batchSize == 0 || desc.bufferCount == 0 || desc.channels.empty())
+        {
+            logError("FrameBatchStream requires at least one channel, one frame per batch and one batch");
+            return nullptr;
+        }
+        for (const auto& c : desc.channels)
+        {
+            if (c.width == 0 || c.height == 0 || c.format == ResourceFormat::Unknown || isCompressedFormat(c.format))
+            {
+                logError("FrameBatchStream channel '" + c.name + "' must have a size and an uncompressed format");
+                return nullptr;
+            }
+        }
+        return SharedPtr(new FrameBatchStream(desc));
+    }
+
+    FrameBatchStream::FrameBatchStream(const Desc& desc) : mDesc(desc)
+    {
+        size_t batchBytes = 0;
+        for (const auto& c : desc.channels)
+        {
+            size_t frameSize = size_t(c.width) * c.height * getFormatBytesPerBlock(c.format);
+            mFrameSizes.push_back(frameSize);
+            mChannelOffsets.push_back(batchBytes);
+            batchBytes = align_to(kChannelAlignment, batchBytes + frameSize * desc.batchSize);
+        }
+
+        mBatches.resize(desc.bufferCount);
+        for (auto& b : mBatches) b.data.resize(batchBytes);
+    }
+
+    bool FrameBatchStream::beginFrame()
+    {
+        assert(mFrameOpen == false);
+        std::unique_lock<std::mutex> l(mMutex);
+        if (mClosed) return false;
+
+        if (mFilling == kInvalidBatch)
+        {
+            auto findFree = [this]() -> uint32_t
+            {
+                for (uint32_t i = 0; i < (uint32_t)mBatches.size(); i++)
+                {
+                    if (mBatches[i].state == BatchState::Free) return i;
+                }
+                return kInvalidBatch;
+            };
+
+            uint32_t batch = findFree();
+            if (batch == kInvalidBatch)
+            {
+                if (mDesc.dropWhenFull)
+                {
+                    mStats.framesDropped++;
+                    return false;
+                }
+
+                CpuTimer timer;
+                timer.update();
+                mBatchFreed.wait(l, [&]() { batch = findFree(); return batch != kInvalidBatch || mClosed; });
+                timer.update();
+                mStats.stallCount++;
+                mStats.stallTime += timer.getElapsedTime();
+                if (batch == kInvalidBatch) return false;
+            }
+
+            mBatches[batch].state = BatchState::Filling;
+            mBatches[batch].frameCount = 0;
+            mFilling = batch;
+        }
+
+        mFrameOpen = true;
+        return true;
+    }
+
+    uint8_t* FrameBatchStream::getFrameData(uint32_t channel)
+    {
+        assert(mFrameOpen && channel < mFrameSizes.size());
+        Batch& b = mBatches[mFilling];
+        return b.data.data() + mChannelOffsets[channel] + mFrameSizes[channel] * b.frameCount;
+    }
+
+    void FrameBatchStream::endFrame()
+    {
+        assert(mFrameOpen);
+        mFrameOpen = false;
+
+        std::unique_lock<std::mutex> l(mMutex);
+        mStats.framesSubmitted++;
+        if (++mBatches[mFilling].frameCount == mDesc.batchSize)
+        {
+            publish(l);
+        }
+    }
+
+    bool FrameBatchStream::pushFrame(const std::vector<const void*>& channelData)
+    {
+        assert(channelData.size() == mFrameSizes.size());
+        if (beginFrame() == false) return false;
+        // The batch is owned by the producer until it's published, so the copy doesn't need the lock
+        for (uint32_t c = 0; c < (uint32_t)mFrameSizes.size(); c++)
+        {
+            std::memcpy(getFrameData(c), channelData[c], mFrameSizes[c]);
+        }
+        endFrame();
+        return true;
+    }
+
+    void FrameBatchStream::publish(std::unique_lock<std::mutex>& lock)
+    {
+        Batch& b = mBatches[mFilling];
+        b.state = BatchState::Published;
+        b.index = mStats.batchesPublished++;
+        mPublished.push_back(mFilling);
+        mFilling = kInvalidBatch;
+        lock.unlock();
+        mBatchPublished.notify_one();
+    }
+
+    void FrameBatchStream::flush()
+    {
+        assert(mFrameOpen == false);
+        std::unique_lock<std::mutex> l(mMutex);
+        if (mFilling == kInvalidBatch) return;
+        if (mBatches[mFilling].frameCount == 0)
+        {
+            mBatches[mFilling].state = BatchState::Free;
+            mFilling = kInvalidBatch;
+            return;
+        }
+        publish(l);
+    }
+
+    void FrameBatchStream::close()
+    {
+        flush();
+        {
+            std::lock_guard<std::mutex> l(mMutex);
+            mClosed = true;
+        }
+        mBatchPublished.notify_all();
+        mBatchFreed.notify_all();
+    }
+
+    uint32_t FrameBatchStream::acquireBatch(uint32_t timeoutMs)
+    {
+        std::unique_lock<std::mutex> l(mMutex);
+        auto ready = [this]() { return mPublished.size() || mClosed; };
+
+        CpuTimer timer;
+        timer.update();
+        if (timeoutMs == kInfinite)
+        {
+            mBatchPublished.wait(l, ready);
+        }
+        else
+        {
+            mBatchPublished.wait_for(l, std::chrono::milliseconds(timeoutMs), ready);
+        }
+        timer.update();
+        mStats.waitTime += timer.getElapsedTime();
+
+        if (mPublished.empty()) return kInvalidBatch;
+        uint32_t batch = mPublished.front();
+        mPublished.pop_front();
+        mBatches[batch].state = BatchState::Acquired;
+        return batch;
+    }
+
+    const uint8_t* FrameBatchStream::getBatchData(uint32_t batch, uint32_t channel) const
+    {
+        assert(mBatches[batch].state == BatchState::Acquired && channel < mChannelOffsets.size());
+        return mBatches[batch].data.data() + mChannelOffsets[channel];
+    }
+
+    uint32_t FrameBatchStream::getBatchFrameCount(uint32_t batch) const
+    {
+        return mBatches[batch].frameCount;
+    }
+
+    uint64_t FrameBatchStream::getBatchIndex(uint32_t batch) const
+    {
+        return mBatches[batch].index;
+    }
+
+    void FrameBatchStream::releaseBatch(uint32_t batch)
+    {
+        {
+            std::lock_guard<std::mutex> l(mMutex);
+            assert(mBatches[batch].state == BatchState::Acquired);
+            mBatches[batch].state = BatchState::Free;
+            mStats.batchesConsumed++;
+        }
+        mBatchFreed.notify_one();
+    }
+
+    FrameBatchStream::Stats FrameBatchStream::getStats() const
+    {
+        std::lock_guard<std::mutex> l(mMutex);
+        return mStats;
+    }
+}
@@ -0,0 +1,174 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include <deque>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include "API/Formats.h"
+
+namespace Falcor
+{
+    /** A multi-buffered stream of frame batches, e.g., G-buffer channels streamed to a training loop.
+        The producer (usually the render thread) writes frames into the batch it's filling. A full batch is published and the consumer acquires published batches
+        in order, reads them in place and releases them. The batches are allocated once, so the consumer can wrap them without copying (see PythonEmbedding::exportBatchStream()).
+        With the default two buffers the producer fills one batch while the consumer reads the other. When the consumer holds all the batches the producer
+        either drops frames, to keep rendering at full rate, or blocks.
+        Each channel of a batch is stored as a contiguous [frame][row][column][component] array.
+    */
+    class FrameBatchStream
+    {
+    public:
+        using SharedPtr = std::shared_ptr<FrameBatchStream>;
+
+        struct Channel
+        {
+            std::string name;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            ResourceFormat format = ResourceFormat::Unknown;    ///< Can't be a compressed format
+        };
+
+        struct Desc
+        {
+            std::vector<Channel> channels;
+            uint32_t batchSize = 8;         ///< The number of frames in a batch
+            uint32_t bufferCount = 2;       ///< The number of batches. Bounds the memory used by the stream.
+            bool dropWhenFull = true;       ///< If true, frames are dropped instead of blocking the producer when the consumer holds all the batches
+        };
+
+        struct Stats
+        {
+            uint64_t framesSubmitted = 0;   ///< Frames written into a batch
+            uint64_t framesDropped = 0;
+            uint64_t batchesPublished = 0;
+            uint64_t batchesConsumed = 0;   ///< Batches released by the consumer
+            uint64_t stallCount = 0;        ///< Number of frames for which the producer had to wait for a batch
+            double stallTime = 0;           ///< Total time the producer spent waiting, in seconds
+            double waitTime = 0;            ///< Total time the consumer spent waiting for a batch, in seconds
+        };
+
+        static const uint32_t kInvalidBatch = uint32_t(-1);
+        static const uint32_t kInfinite = uint32_t(-1);
+
+        /** Create a stream. Returns nullptr if the description is invalid.
+        */
+        static SharedPtr create(const Desc& desc);
+
+        /** Start writing a frame. Publishes nothing until the batch is full.
+            \return false if the frame was dropped, in which case getFrameData() and endFrame() must not be called
+        */
+        bool beginFrame();
+
+        /** Get the memory of a channel for the frame being written. Only valid between beginFrame() and endFrame().
+        */
+        uint8_t* getFrameData(uint32_t channel);
+
+        /** Finish writing the frame. Publishes the batch when it's full.
+        */
+        void endFrame();
+
+        /** Copy a frame into the stream
+            \param[in] channelData The frame data of each channel, tightly packed
+            \return false if the frame was dropped
+        */
+        bool pushFrame(const std::vector<const void*>& channelData);
+
+        /** Publish the batch being filled, even if it's not full
+        */
+        void flush();
+
+        /** Publish the batch being filled and stop the stream. The consumer can still acquire the published batches, after that acquireBatch() fails immediately.
+        */
+        void close();
+
+        /** Acquire the oldest published batch. Can be called from any thread.
+            \param[in] timeoutMs The maximum time to wait, in milliseconds
+            \return The batch, or kInvalidBatch if no batch was published in time or the stream was closed
+        */
+        uint32_t acquireBatch(uint32_t timeoutMs = kInfinite);
+
+        /** Get the memory of a channel in an acquired batch. The frames are contiguous.
+        */
+        const uint8_t* getBatchData(uint32_t batch, uint32_t channel) const;
+
+        /** Get the number of frames in an acquired batch. Lower than the batch size if the batch was flushed.
+        */
+        uint32_t getBatchFrameCount(uint32_t batch) const;
+
+        /** Get the sequence number of an acquired batch, starting at 0
+        */
+        uint64_t getBatchIndex(uint32_t batch) const;
+
+        /** Release an acquired batch, so the producer can fill it again
+        */
+        void releaseBatch(uint32_t batch);
+
+        /** Get the size of a channel's frame in bytes
+        */
+        size_t getFrameSize(uint32_t channel) const { return mFrameSizes[channel]; }
+
+        const Desc& getDesc() const { return mDesc; }
+        Stats getStats() const;
+
+    private:
+        FrameBatchStream(const Desc& desc);
+        void publish(std::unique_lock<std::mutex>& lock);
+
+        enum class BatchState
+        {
+            Free,
+            Filling,
+            Published,
+            Acquired,
+        };
+
+        struct Batch
+        {
+            BatchState state = BatchState::Free;
+            uint32_t frameCount = 0;
+            uint64_t index = 0;
+            std::vector<uint8_t> data;
+        };
+
+        Desc mDesc;
+        std::vector<size_t> mFrameSizes;
+        std::vector<size_t> mChannelOffsets;        // Offset of each channel in a batch's data
+
+        mutable std::mutex mMutex;
+        std::condition_variable mBatchFreed;
+        std::condition_variable mBatchPublished;
+        std::vector<Batch> mBatches;
+        std::deque<uint32_t> mPublished;
+        uint32_t mFilling = kInvalidBatch;          // Owned by the producer, so its frames are written without the lock
+        bool mFrameOpen = false;
+        bool mClosed = false;
+        Stats mStats;
+    };
+}
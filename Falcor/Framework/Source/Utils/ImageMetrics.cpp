@@ -0,0 +1,618 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "ImageMetrics.h"
+#include "Utils/Bitmap.h"
+#include "Utils/ImageProcessing.h"
+#include "Utils/ParallelFor.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kBandHeight = 16;    // Rows per task
+        const double kNaN = std::numeric_limits<double>::quiet_NaN();
+        const float kPi = 3.14159265358979323846f;
+
+        const std::string kMetricNames[] = { "mse", "relmse", "smape", "psnr", "ssim", "flip", "tmse" };
+        static_assert(arraysize(kMetricNames) == ImageMetrics::kMetricCount, "Missing metric names");
+
+        uint32_t getBandCount(uint32_t height)
+        {
+            return (height + kBandHeight - 1) / kBandHeight;
+        }
+
+        // Calls func(begin, end, band) for each band of rows, in parallel
+        void forEachBand(uint32_t height, const std::function<void(uint32_t, uint32_t, uint32_t)>& func)
+        {
+            parallelFor(height, kBandHeight, [&](uint32_t begin, uint32_t end) { func(begin, end, begin / kBandHeight); });
+        }
+
+        double horizontalSum(__m128 v)
+        {
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, v);
+            return double(lanes[0]) + double(lanes[1]) + double(lanes[2]) + double(lanes[3]);
+        }
+
+        // Separable filtering of single-channel planes
+
+        struct Kernel
+        {
+            int32_t radius = 0;
+            std::vector<float> weights;     // 2 * radius + 1 taps
+        };
+
+        /** A Gaussian or one of its derivatives. The Gaussian sums to 1, the positive and negative lobes of the derivatives sum to 1 and -1.
+        */
+        Kernel createGaussianKernel(float sigma, uint32_t derivative)
+        {
+            Kernel kernel;
+            kernel.radius = std::max(1, int32_t(std::ceil(3 * sigma)));
+            kernel.weights.resize(2 * kernel.radius + 1);
+
+            double positive = 0, negative = 0;
+            std::vector<double> weights(kernel.weights.size());
+            for (int32_t i = -kernel.radius; i <= kernel.radius; i++)
+            {
+                double x = i;
+                double g = std::exp(-x * x / (2.0 * sigma * sigma));
+                double w = (derivative == 0) ? g : (derivative == 1) ? -x * g : (x * x / (sigma * sigma) - 1) * g;
+                weights[i + kernel.radius] = w;
+                if (w > 0) positive += w;
+                else negative -= w;
+            }
+            for (size_t i = 0; i < weights.size(); i++)
+            {
+                kernel.weights[i] = float(weights[i] > 0 ? weights[i] / positive : weights[i] / negative);
+            }
+            return kernel;
+        }
+
+        void convolveRow(const float* pSrc, float* pDst, int32_t width, const Kernel& kernel)
+        {
+            const int32_t r = kernel.radius;
+            const float* pWeights = kernel.weights.data();
+            const int32_t tapCount = 2 * r + 1;
+
+            auto convolvePixel = [&](int32_t x)
+            {
+                float sum = 0;
+                for (int32_t t = 0; t < tapCount; t++) sum += pWeights[t] * pSrc[std::min(std::max(x + t - r, 0), width - 1)];
+                pDst[x] = sum;
+            };
+
+            // Pixels whose footprint is inside the row are processed 4 at a time, the edges are clamped
+            int32_t x = 0;
+            for (; x < std::min(r, width); x++) convolvePixel(x);
+            for (; x + 3 + r < width; x += 4)
+            {
+                __m128 sum = _mm_setzero_ps();
+                for (int32_t t = 0; t < tapCount; t++)
+                {
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(pWeights[t]), _mm_loadu_ps(pSrc + x + t - r)));
+                }
+                _mm_storeu_ps(pDst + x, sum);
+            }
+            for (; x < width; x++) convolvePixel(x);
+        }
+
+        // pRows is scratch space reused across rows. The FLIP kernels grow with the pixels per degree, so the tap count has no fixed bound
+        void convolveColumns(const float* pSrc, float* pDst, int32_t width, int32_t height, int32_t y, const Kernel& kernel, std::vector<const float*>& pRows)
+        {
+            const int32_t r = kernel.radius;
+            const int32_t tapCount = 2 * r + 1;
+            pRows.resize(tapCount);
+            for (int32_t t = 0; t < tapCount; t++) pRows[t] = pSrc + size_t(std::min(std::max(y + t - r, 0), height - 1)) * width;
+
+            int32_t x = 0;
+            for (; x + 4 <= width; x += 4)
+            {
+                __m128 sum = _mm_setzero_ps();
+                for (int32_t t = 0; t < tapCount; t++)
+                {
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kernel.weights[t]), _mm_loadu_ps(pRows[t] + x)));
+                }
+                _mm_storeu_ps(pDst + x, sum);
+            }
+            for (; x < width; x++)
+            {
+                float sum = 0;
+                for (int32_t t = 0; t < tapCount; t++) sum += kernel.weights[t] * pRows[t][x];
+                pDst[x] = sum;
+            }
+        }
+
+        std::vector<float> convolve(const std::vector<float>& src, uint32_t width, uint32_t height, const Kernel& kernelX, const Kernel& kernelY)
+        {
+            std::vector<float> temp(src.size()), dst(src.size());
+            forEachBand(height, [&](uint32_t begin, uint32_t end, uint32_t)
+            {
+                for (uint32_t y = begin; y < end; y++) convolveRow(&src[size_t(y) * width], &temp[size_t(y) * width], width, kernelX);
+            });
+            forEachBand(height, [&](uint32_t begin, uint32_t end, uint32_t)
+            {
+                std::vector<const float*> pRows;
+                for (uint32_t y = begin; y < end; y++) convolveColumns(temp.data(), &dst[size_t(y) * width], width, height, y, kernelY, pRows);
+            });
+            return dst;
+        }
+
+        // Sums a per-pixel function over the image. The bands are summed in order, so the result is deterministic.
+        double sumPixels(uint32_t width, uint32_t height, const std::function<double(size_t)>& func)
+        {
+            std::vector<double> bandSums(getBandCount(height), 0.0);
+            forEachBand(height, [&](uint32_t begin, uint32_t end, uint32_t band)
+            {
+                double sum = 0;
+                for (size_t i = size_t(begin) * width; i < size_t(end) * width; i++) sum += func(i);
+                bandSums[band] = sum;
+            });
+            double sum = 0;
+            for (double s : bandSums) sum += s;
+            return sum;
+        }
+
+        // Pixel metrics
+
+        struct PixelSums
+        {
+            double squaredError = 0;
+            double relative = 0;
+            double smape = 0;
+            double temporal = 0;
+        };
+
+        PixelSums sumPixelErrors(const ImageMetrics::Image& test, const ImageMetrics::Image& ref, const ImageMetrics::Image* pPrevTest, const ImageMetrics::Image* pPrevRef, float epsilon)
+        {
+            std::vector<PixelSums> bandSums(getBandCount(test.height));
+            forEachBand(test.height, [&](uint32_t begin, uint32_t end, uint32_t band)
+            {
+                // The alpha lane is masked to zero, where all the terms are zero
+                const __m128 rgbMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+                const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+                const __m128 eps = _mm_set1_ps(epsilon);
+
+                PixelSums& sums = bandSums[band];
+                for (uint32_t y = begin; y < end; y++)
+                {
+                    __m128 se = _mm_setzero_ps(), rel = _mm_setzero_ps(), smape = _mm_setzero_ps(), temporal = _mm_setzero_ps();
+                    size_t rowStart = size_t(y) * test.width * 4;
+                    for (size_t i = rowStart; i < rowStart + test.width * 4; i += 4)
+                    {
+                        __m128 t = _mm_and_ps(_mm_loadu_ps(&test.data[i]), rgbMask);
+                        __m128 r = _mm_and_ps(_mm_loadu_ps(&ref.data[i]), rgbMask);
+                        __m128 d = _mm_sub_ps(t, r);
+                        __m128 d2 = _mm_mul_ps(d, d);
+                        se = _mm_add_ps(se, d2);
+                        rel = _mm_add_ps(rel, _mm_div_ps(d2, _mm_add_ps(_mm_mul_ps(r, r), eps)));
+                        __m128 sum = _mm_add_ps(_mm_add_ps(_mm_and_ps(t, absMask), _mm_and_ps(r, absMask)), eps);
+                        smape = _mm_add_ps(smape, _mm_div_ps(_mm_and_ps(d, absMask), sum));
+                        if (pPrevTest)
+                        {
+                            __m128 pt = _mm_and_ps(_mm_loadu_ps(&pPrevTest->data[i]), rgbMask);
+                            __m128 pr = _mm_and_ps(_mm_loadu_ps(&pPrevRef->data[i]), rgbMask);
+                            __m128 dd = _mm_sub_ps(_mm_sub_ps(t, pt), _mm_sub_ps(r, pr));
+                            temporal = _mm_add_ps(temporal, _mm_mul_ps(dd, dd));
+                        }
+                    }
+                    sums.squaredError += horizontalSum(se);
+                    sums.relative += horizontalSum(rel);
+                    sums.smape += horizontalSum(smape);
+                    sums.temporal += horizontalSum(temporal);
+                }
+            });
+
+            PixelSums total;
+            for (const PixelSums& s : bandSums)
+            {
+                total.squaredError += s.squaredError;
+                total.relative += s.relative;
+                total.smape += s.smape;
+                total.temporal += s.temporal;
+            }
+            return total;
+        }
+
+        // SSIM
+
+        float linearToSrgb(float c)
+        {
+            return (c <= 0.0031308f) ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+        }
+
+        // sRGB-encoded luminance of the display value of a pixel
+        float getDisplayLuminance(const float* pPixel, float scale)
+        {
+            float y = scale * (0.2126f * pPixel[0] + 0.7152f * pPixel[1] + 0.0722f * pPixel[2]);
+            return linearToSrgb(std::max(0.0f, std::min(y, 1.0f)));
+        }
+
+        double computeSsim(const ImageMetrics::Image& test, const ImageMetrics::Image& ref, float scale)
+        {
+            const uint32_t width = test.width, height = test.height;
+            const size_t count = size_t(width) * height;
+            std::vector<float> x(count), y(count), xx(count), yy(count), xy(count);
+            forEachBand(height, [&](uint32_t begin, uint32_t end, uint32_t)
+            {
+                for (size_t i = size_t(begin) * width; i < size_t(end) * width; i++)
+                {
+                    x[i] = getDisplayLuminance(&test.data[i * 4], scale);
+                    y[i] = getDisplayLuminance(&ref.data[i * 4], scale);
+                    xx[i] = x[i] * x[i];
+                    yy[i] = y[i] * y[i];
+                    xy[i] = x[i] * y[i];
+                }
+            });
+
+            const Kernel window = createGaussianKernel(1.5f, 0);
+            std::vector<float> muX = convolve(x, width, height, window, window);
+            std::vector<float> muY = convolve(y, width, height, window, window);
+            std::vector<float> meanXX = convolve(xx, width, height, window, window);
+            std::vector<float> meanYY = convolve(yy, width, height, window, window);
+            std::vector<float> meanXY = convolve(xy, width, height, window, window);
+
+            const double c1 = 0.01 * 0.01, c2 = 0.03 * 0.03;
+            double sum = sumPixels(width, height, [&](size_t i)
+            {
+                double mx = muX[i], my = muY[i];
+                double varX = meanXX[i] - mx * mx, varY = meanYY[i] - my * my, covXY = meanXY[i] - mx * my;
+                return ((2 * mx * my + c1) * (2 * covXY + c2)) / ((mx * mx + my * my + c1) * (varX + varY + c2));
+            });
+            return sum / count;
+        }
+
+        // FLIP
+
+        struct Color
+        {
+            float v[3];
+        };
+
+        const float kWhiteX = 0.950428545f, kWhiteZ = 1.088900371f;     // D65, with Y = 1
+
+        Color linearRgbToXyz(const Color& c)
+        {
+            return { { 0.4124564f * c.v[0] + 0.3575761f * c.v[1] + 0.1804375f * c.v[2],
+                       0.2126729f * c.v[0] + 0.7151522f * c.v[1] + 0.0721750f * c.v[2],
+                       0.0193339f * c.v[0] + 0.1191920f * c.v[1] + 0.9503041f * c.v[2] } };
+        }
+
+        Color xyzToLinearRgb(const Color& c)
+        {
+            return { { 3.2404542f * c.v[0] - 1.5371385f * c.v[1] - 0.4985314f * c.v[2],
+                      -0.9692660f * c.v[0] + 1.8760108f * c.v[1] + 0.0415560f * c.v[2],
+                       0.0556434f * c.v[0] - 0.2040259f * c.v[1] + 1.0572252f * c.v[2] } };
+        }
+
+        // The opponent space in which FLIP applies the contrast sensitivity filters
+        Color xyzToYCxCz(const Color& c)
+        {
+            return { { 116.0f * c.v[1] - 16.0f, 500.0f * (c.v[0] / kWhiteX - c.v[1]), 200.0f * (c.v[1] - c.v[2] / kWhiteZ) } };
+        }
+
+        Color yCxCzToXyz(const Color& c)
+        {
+            float y = (c.v[0] + 16.0f) / 116.0f;
+            return { { (c.v[1] / 500.0f + y) * kWhiteX, y, (y - c.v[2] / 200.0f) * kWhiteZ } };
+        }
+
+        // CIELAB with the Hunt adjustment of the chroma
+        Color linearRgbToHuntLab(const Color& rgb)
+        {
+            Color xyz = linearRgbToXyz(rgb);
+            auto f = [](float t) { const float d = 6.0f / 29.0f; return (t > d * d * d) ? std::cbrt(t) : t / (3 * d * d) + 4.0f / 29.0f; };
+            float fx = f(xyz.v[0] / kWhiteX), fy = f(xyz.v[1]), fz = f(xyz.v[2] / kWhiteZ);
+            float l = 116.0f * fy - 16.0f;
+            return { { l, 0.01f * l * 500.0f * (fx - fy), 0.01f * l * 200.0f * (fy - fz) } };
+        }
+
+        float hyab(const Color& a, const Color& b)
+        {
+            float da = a.v[1] - b.v[1], db = a.v[2] - b.v[2];
+            return std::abs(a.v[0] - b.v[0]) + std::sqrt(da * da + db * db);
+        }
+
+        const float kColorExponent = 0.7f;
+        const float kFeatureExponent = 0.5f;
+        const float kCompressionPoint = 0.4f;   // Fraction of the maximum color error below which errors are expanded
+        const float kCompressionValue = 0.95f;  // The remapped value at that point
+
+        float getMaxColorError()
+        {
+            static const float sMax = std::pow(hyab(linearRgbToHuntLab({ { 0, 1, 0 } }), linearRgbToHuntLab({ { 0, 0, 1 } })), kColorExponent);
+            return sMax;
+        }
+
+        Kernel createCsfKernel(float b, float pixelsPerDegree)
+        {
+            float sigmaDegrees = std::sqrt(b / (2 * kPi * kPi));
+            return createGaussianKernel(sigmaDegrees * pixelsPerDegree, 0);
+        }
+
+        double computeFlip(const ImageMetrics::Image& test, const ImageMetrics::Image& ref, float scale, float pixelsPerDegree)
+        {
+            const uint32_t width = test.width, height = test.height;
+            const size_t count = size_t(width) * height;
+
+            // Split both images into YCxCz planes, and keep the luminance for the feature detection
+            std::vector<float> planes[2][3];
+            std::vector<float> luminance[2];
+            for (uint32_t img = 0; img < 2; img++)
+            {
+                for (auto& p : planes[img]) p.resize(count);
+                luminance[img].resize(count);
+            }
+            forEachBand(height, [&](uint32_t begin, uint32_t end, uint32_t)
+            {
+                for (size_t i = size_t(begin) * width; i < size_t(end) * width; i++)
+                {
+                    for (uint32_t img = 0; img < 2; img++)
+                    {
+                        const float* pPixel = &(img == 0 ? test : ref).data[i * 4];
+                        Color rgb;
+                        for (uint32_t c = 0; c < 3; c++) rgb.v[c] = std::max(0.0f, std::min(pPixel[c] * scale, 1.0f));
+                        Color xyz = linearRgbToXyz(rgb);
+                        Color ycxcz = xyzToYCxCz(xyz);
+                        for (uint32_t c = 0; c < 3; c++) planes[img][c][i] = ycxcz.v[c];
+                        luminance[img][i] = xyz.v[1];
+                    }
+                }
+            });
+
+            // Contrast sensitivity filters. The blue-yellow filter is a sum of two Gaussians weighted by their mass.
+            const Kernel achromatic = createCsfKernel(0.0047f, pixelsPerDegree);
+            const Kernel redGreen = createCsfKernel(0.0053f, pixelsPerDegree);
+            const Kernel blueYellow[2] = { createCsfKernel(0.04f, pixelsPerDegree), createCsfKernel(0.025f, pixelsPerDegree) };
+            float blueYellowWeight[2] = { 34.1f * std::sqrt(0.04f / kPi), 13.5f * std::sqrt(0.025f / kPi) };
+            float weightSum = blueYellowWeight[0] + blueYellowWeight[1];
+            for (float& w : blueYellowWeight) w /= weightSum;
+
+            // Edge and point detectors
+            const float featureSigma = 0.5f * 0.082f * pixelsPerDegree;
+            const Kernel gaussian = createGaussianKernel(featureSigma, 0);
+            const Kernel firstDerivative = createGaussianKernel(featureSigma, 1);
+            const Kernel secondDerivative = createGaussianKernel(featureSigma, 2);
+
+            std::vector<float> filtered[2][3];
+            std::vector<float> edgeX[2], edgeY[2], pointX[2], pointY[2];
+            for (uint32_t img = 0; img < 2; img++)
+            {
+                filtered[img][0] = convolve(planes[img][0], width, height, achromatic, achromatic);
+                filtered[img][1] = convolve(planes[img][1], width, height, redGreen, redGreen);
+                filtered[img][2] = convolve(planes[img][2], width, height, blueYellow[0], blueYellow[0]);
+                std::vector<float> wide = convolve(planes[img][2], width, height, blueYellow[1], blueYellow[1]);
+                for (size_t i = 0; i < count; i++) filtered[img][2][i] = blueYellowWeight[0] * filtered[img][2][i] + blueYellowWeight[1] * wide[i];
+
+                edgeX[img] = convolve(luminance[img], width, height, firstDerivative, gaussian);
+                edgeY[img] = convolve(luminance[img], width, height, gaussian, firstDerivative);
+                pointX[img] = convolve(luminance[img], width, height, secondDerivative, gaussian);
+                pointY[img] = convolve(luminance[img], width, height, gaussian, secondDerivative);
+            }
+
+            const float maxError = getMaxColorError();
+            const float compressionStart = kCompressionPoint * maxError;
+            double sum = sumPixels(width, height, [&](size_t i)
+            {
+                Color lab[2];
+                for (uint32_t img = 0; img < 2; img++)
+                {
+                    Color rgb = xyzToLinearRgb(yCxCzToXyz({ { filtered[img][0][i], filtered[img][1][i], filtered[img][2][i] } }));
+                    for (float& c : rgb.v) c = std::max(0.0f, std::min(c, 1.0f));
+                    lab[img] = linearRgbToHuntLab(rgb);
+                }
+
+                // Large color errors are compressed into the top of the range
+                float colorError = std::pow(hyab(lab[0], lab[1]), kColorExponent);
+                if (colorError < compressionStart) colorError *= kCompressionValue / compressionStart;
+                else colorError = kCompressionValue + (colorError - compressionStart) / (maxError - compressionStart) * (1.0f - kCompressionValue);
+
+                float edge = std::abs(std::hypot(edgeX[0][i], edgeY[0][i]) - std::hypot(edgeX[1][i], edgeY[1][i]));
+                float point = std::abs(std::hypot(pointX[0][i], pointY[0][i]) - std::hypot(pointX[1][i], pointY[1][i]));
+                float featureError = std::pow(std::max(edge, point) / std::sqrt(2.0f), kFeatureExponent);
+
+                return double(std::pow(std::min(colorError, 1.0f), 1.0f - featureError));
+            });
+            return sum / count;
+        }
+    }
+
+    ImageMetrics::UniquePtr ImageMetrics::create(const Options& options)
+    {
+        return UniquePtr(new ImageMetrics(options));
+    }
+
+    ImageMetrics::Values ImageMetrics::compare(const Image& test, const Image& reference, const Options& options)
+    {
+        return compareFrame(test, reference, nullptr, nullptr, options);
+    }
+
+    ImageMetrics::Values ImageMetrics::compareFrame(const Image& test, const Image& reference, const Image* pPrevTest, const Image* pPrevReference, const Options& options)
+    {
+        Values values;
+        values.fill(kNaN);
+
+        size_t pixelCount = size_t(test.width) * test.height;
+        if (test.width != reference.width || test.height != reference.height || pixelCount == 0 || test.data.size() != pixelCount * 4 || reference.data.size() != pixelCount * 4)
+        {
+            logError("ImageMetrics::compare() - the images are empty or their sizes don't match");
+            return values;
+        }
+
+        auto isEnabled = [&](Metric m) { return (options.metrics & getMetricBit(m)) != 0; };
+        bool temporal = isEnabled(Metric::TemporalMse) && pPrevTest && pPrevReference;
+        uint32_t pixelMetrics = getMetricBit(Metric::Mse) | getMetricBit(Metric::RelMse) | getMetricBit(Metric::Smape) | getMetricBit(Metric::Psnr);
+        if ((options.metrics & pixelMetrics) || temporal)
+        {
+            PixelSums sums = sumPixelErrors(test, reference, temporal ? pPrevTest : nullptr, temporal ? pPrevReference : nullptr, options.epsilon);
+            double valueCount = double(pixelCount) * 3;
+            double mse = sums.squaredError / valueCount;
+            if (isEnabled(Metric::Mse)) values[uint32_t(Metric::Mse)] = mse;
+            if (isEnabled(Metric::RelMse)) values[uint32_t(Metric::RelMse)] = sums.relative / valueCount;
+            if (isEnabled(Metric::Smape)) values[uint32_t(Metric::Smape)] = sums.smape / valueCount;
+            if (isEnabled(Metric::Psnr))
+            {
+                double peak = options.psnrPeak;
+                values[uint32_t(Metric::Psnr)] = (mse > 0) ? 10.0 * std::log10(peak * peak / mse) : std::numeric_limits<double>::infinity();
+            }
+            if (temporal) values[uint32_t(Metric::TemporalMse)] = sums.temporal / valueCount;
+        }
+
+        float scale = std::exp2(options.exposure);
+        if (isEnabled(Metric::Ssim)) values[uint32_t(Metric::Ssim)] = computeSsim(test, reference, scale);
+        if (isEnabled(Metric::Flip)) values[uint32_t(Metric::Flip)] = computeFlip(test, reference, scale, options.pixelsPerDegree);
+        return values;
+    }
+
+    bool ImageMetrics::addFrame(Image test, Image reference)
+    {
+        if (test.width != reference.width || test.height != reference.height)
+        {
+            logError("ImageMetrics::addFrame() - the test and reference images have different sizes");
+            return false;
+        }
+        bool hasPrevFrame = mFrameValues.size() > 0;
+        if (hasPrevFrame && (test.width != mPrevTest.width || test.height != mPrevTest.height))
+        {
+            logError("ImageMetrics::addFrame() - the frame size changed");
+            return false;
+        }
+
+        mFrameValues.push_back(compareFrame(test, reference, hasPrevFrame ? &mPrevTest : nullptr, hasPrevFrame ? &mPrevReference : nullptr, mOptions));
+        mPrevTest = std::move(test);
+        mPrevReference = std::move(reference);
+        return true;
+    }
+
+    ImageMetrics::Values ImageMetrics::getMean() const
+    {
+        Values mean;
+        for (uint32_t m = 0; m < kMetricCount; m++)
+        {
+            double sum = 0;
+            uint32_t count = 0;
+            for (const Values& values : mFrameValues)
+            {
+                if (std::isnan(values[m])) continue;
+
+                // Average PSNR through the MSE, so a single identical frame doesn't make it infinite
+                double peak = mOptions.psnrPeak;
+                sum += (m == uint32_t(Metric::Psnr)) ? peak * peak / std::pow(10.0, values[m] / 10.0) : values[m];
+                count++;
+            }
+            mean[m] = count ? sum / count : kNaN;
+            if (count && m == uint32_t(Metric::Psnr))
+            {
+                double peak = mOptions.psnrPeak;
+                mean[m] = (mean[m] > 0) ? 10.0 * std::log10(peak * peak / mean[m]) : std::numeric_limits<double>::infinity();
+            }
+        }
+        return mean;
+    }
+
+    void ImageMetrics::reset()
+    {
+        mFrameValues.clear();
+        mPrevTest = {};
+        mPrevReference = {};
+    }
+
+    bool ImageMetrics::loadImage(const std::string& filename, Image& image)
+    {
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(filename, true);
+        if (!pBitmap) return false;
+
+        const uint32_t width = pBitmap->getWidth(), height = pBitmap->getHeight();
+        const uint32_t pixelCount = width * height;
+        const uint8_t* pData = pBitmap->getData();
+        image.width = width;
+        image.height = height;
+        image.data.resize(size_t(pixelCount) * 4);
+
+        switch (pBitmap->getFormat())
+        {
+        case ResourceFormat::RGBA32Float:
+            std::memcpy(image.data.data(), pData, image.data.size() * sizeof(float));
+            break;
+        case ResourceFormat::RGB32Float:
+            ImageProcessing::convertChannelCount(width, height, 4, 3, pData, width * 12, 4, image.data.data(), width * 16, ImageProcessing::kAlphaOneFloat, false);
+            break;
+        case ResourceFormat::RGBA16Float:
+            ImageProcessing::halfToFloat(pixelCount * 4, (const uint16_t*)pData, image.data.data());
+            break;
+        case ResourceFormat::RGB16Float:
+        {
+            std::vector<uint16_t> rgba(size_t(pixelCount) * 4);
+            ImageProcessing::convertChannelCount(width, height, 2, 3, pData, width * 6, 4, rgba.data(), width * 8, ImageProcessing::kAlphaOneHalf, false);
+            ImageProcessing::halfToFloat(pixelCount * 4, rgba.data(), image.data.data());
+            break;
+        }
+        case ResourceFormat::BGRA8Unorm:
+        case ResourceFormat::BGRX8Unorm:
+        {
+            uint8_t alpha = (pBitmap->getFormat() == ResourceFormat::BGRA8Unorm) ? 3 : ImageProcessing::kOne;
+            std::vector<uint8_t> rgba(size_t(pixelCount) * 4);
+            ImageProcessing::swizzleRgba8(width, height, pData, width * 4, rgba.data(), width * 4, { 2, 1, 0, alpha }, false);
+            ImageProcessing::srgbToLinear(pixelCount, 4, rgba.data(), image.data.data());
+            break;
+        }
+        default:
+            logError("ImageMetrics::loadImage() - " + filename + " has an unsupported format (" + to_string(pBitmap->getFormat()) + ")");
+            image = {};
+            return false;
+        }
+        return true;
+    }
+
+    const std::string& ImageMetrics::getMetricName(Metric metric)
+    {
+        return kMetricNames[uint32_t(metric)];
+    }
+
+    bool ImageMetrics::findMetric(const std::string& name, Metric& metric)
+    {
+        for (uint32_t m = 0; m < kMetricCount; m++)
+        {
+            if (kMetricNames[m] == name)
+            {
+                metric = Metric(m);
+                return true;
+            }
+        }
+        return false;
+    }
+}
@@ -0,0 +1,137 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <array>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** Error metrics between a test image (e.g., denoised output) and a reference (e.g., a high-spp render).
+        Pixel metrics are computed on the linear RGB values. SSIM and FLIP work on display values: the images are scaled by 2^exposure and clamped to [0, 1].
+        The images are processed in bands of rows on the worker threads, and the filters and per-pixel sums use SSE.
+        Sequences are streamed: addFrame() keeps only the previous frame pair, which the temporal metric needs.
+    */
+    class ImageMetrics
+    {
+    public:
+        using UniquePtr = std::unique_ptr<ImageMetrics>;
+
+        enum class Metric : uint32_t
+        {
+            Mse,            ///< Mean squared error
+            RelMse,         ///< Squared error relative to the squared reference, mean(d^2 / (r^2 + epsilon))
+            Smape,          ///< Symmetric mean absolute percentage error, mean(|d| / (|t| + |r| + epsilon)), in [0, 1]
+            Psnr,           ///< Peak signal-to-noise ratio in dB, computed from the MSE. Infinite for identical images.
+            Ssim,           ///< Mean structural similarity of the display luminance (11x11 Gaussian window, sigma 1.5). 1 for identical images.
+            Flip,           ///< Mean perceptual error following LDR-FLIP (Andersson et al. 2020): CSF-filtered HyAB color difference weighted by edge and point features. In [0, 1].
+            TemporalMse,    ///< MSE between the frame-to-frame differences of the test and the reference sequences. Measures flickering, only computed from the second frame on.
+            Count
+        };
+
+        static const uint32_t kMetricCount = uint32_t(Metric::Count);
+        static const uint32_t kAllMetrics = (1u << kMetricCount) - 1;
+        static uint32_t getMetricBit(Metric metric) { return 1u << uint32_t(metric); }
+
+        /** Metric values, indexed by Metric. Metrics which were not computed are NaN.
+        */
+        using Values = std::array<double, kMetricCount>;
+
+        /** A linear RGBA32Float image, tightly packed. The alpha channel is ignored.
+        */
+        struct Image
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            std::vector<float> data;
+        };
+
+        struct Options
+        {
+            uint32_t metrics = kAllMetrics;     ///< A combination of getMetricBit() values
+            float epsilon = 0.01f;              ///< Avoids divisions by zero in relMSE and SMAPE
+            float psnrPeak = 1.0f;              ///< The peak signal value for PSNR
+            float exposure = 0.0f;              ///< Exposure in stops applied before SSIM and FLIP
+            float pixelsPerDegree = 67.0f;      ///< The viewing condition for FLIP. The default is a 0.7m wide 4K display seen from 0.7m.
+        };
+
+        /** Create an object to compare sequences
+        */
+        static UniquePtr create(const Options& options);
+        static UniquePtr create() { return create(Options()); }
+
+        /** Compare a single pair of images
+            \return The metric values. All the values are NaN if the image sizes don't match.
+        */
+        static Values compare(const Image& test, const Image& reference, const Options& options);
+        static Values compare(const Image& test, const Image& reference) { return compare(test, reference, Options()); }
+
+        /** Add the next frame of the sequences. Computes the frame's metrics, including the temporal metric against the previous frame.
+            The images are moved into the object, which keeps them until the next frame is added.
+            \return false if the image sizes don't match each other or the previous frame
+        */
+        bool addFrame(Image test, Image reference);
+
+        /** Get the metrics of each frame added so far
+        */
+        const std::vector<Values>& getFrameValues() const { return mFrameValues; }
+
+        /** Get the mean of each metric over the frames, ignoring frames where it wasn't computed. PSNR is computed from the mean MSE.
+        */
+        Values getMean() const;
+
+        /** Forget the frames added so far
+        */
+        void reset();
+
+        const Options& getOptions() const { return mOptions; }
+
+        /** Load an image file into a linear RGBA32Float image. 8-bit images are sRGB-decoded, 16-bit float images are expanded.
+            \return false if the file can't be loaded or its format isn't supported
+        */
+        static bool loadImage(const std::string& filename, Image& image);
+
+        /** Get the short name of a metric, e.g., "relmse"
+        */
+        static const std::string& getMetricName(Metric metric);
+
+        /** Find a metric from its short name
+            \return false if the name is unknown
+        */
+        static bool findMetric(const std::string& name, Metric& metric);
+
+    private:
+        ImageMetrics(const Options& options) : mOptions(options) {}
+        static Values compareFrame(const Image& test, const Image& reference, const Image* pPrevTest, const Image* pPrevReference, const Options& options);
+
+        Options mOptions;
+        std::vector<Values> mFrameValues;
+        Image mPrevTest;
+        Image mPrevReference;
+    };
+}
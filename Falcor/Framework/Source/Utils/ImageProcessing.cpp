@@ -0,0 +1,734 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "ImageProcessing.h"
+#include "Utils/ParallelFor.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define falcor_target_ssse3
+#define falcor_target_f16c
+#else
+#include <immintrin.h>
+#include <cpuid.h>
+#define falcor_target_ssse3 __attribute__((target("ssse3")))
+#define falcor_target_f16c __attribute__((target("avx,f16c")))
+#endif
+
+namespace Falcor
+{
+    namespace ImageProcessing
+    {
+        namespace
+        {
+            // The amount of data processed by each task in Parallel mode
+            const size_t kChunkBytes = 64 * 1024;
+
+            void forEachRow(uint32_t height, size_t rowBytes, Mode mode, const std::function<void(uint32_t, uint32_t)>& func)
+            {
+                if (mode == Mode::Parallel)
+                {
+                    uint32_t grainSize = (uint32_t)std::max<size_t>(1, kChunkBytes / std::max<size_t>(rowBytes, 1));
+                    parallelFor(height, grainSize, func);
+                }
+                else
+                {
+                    func(0, height);
+                }
+            }
+
+            const uint8_t* getSrcRow(const void* pSrc, size_t pitch, uint32_t y)
+            {
+                return (const uint8_t*)pSrc + y * pitch;
+            }
+
+            uint8_t* getDstRow(void* pDst, size_t pitch, uint32_t y, uint32_t height, bool flip)
+            {
+                return (uint8_t*)pDst + (flip ? height - y - 1 : y) * pitch;
+            }
+
+            void cpuid(int info[4], int leaf)
+            {
+#ifdef _MSC_VER
+                __cpuid(info, leaf);
+#else
+                unsigned int a, b, c, d;
+                __cpuid(leaf, a, b, c, d);
+                info[0] = (int)a; info[1] = (int)b; info[2] = (int)c; info[3] = (int)d;
+#endif
+            }
+
+            bool checkSsse3Support()
+            {
+                int info[4];
+                cpuid(info, 1);
+                return (info[2] & (1 << 9)) != 0;
+            }
+
+            bool checkF16cSupport()
+            {
+                int info[4];
+                cpuid(info, 1);
+                bool osxsave = (info[2] & (1 << 27)) != 0;
+                bool avx = (info[2] & (1 << 28)) != 0;
+                bool f16c = (info[2] & (1 << 29)) != 0;
+                if (!osxsave || !avx || !f16c) return false;
+
+                // Make sure the OS saves the YMM registers
+#ifdef _MSC_VER
+                uint64_t xcr0 = _xgetbv(0);
+#else
+                uint32_t eax, edx;
+                __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+                uint64_t xcr0 = eax;
+#endif
+                return (xcr0 & 0x6) == 0x6;
+            }
+
+            // Swizzle
+
+            void swizzleRowScalar(const uint8_t* pSrc, uint8_t* pDst, uint32_t width, const Swizzle& swizzle)
+            {
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    // Read the whole texel first, the conversion may be in place
+                    uint8_t texel[6] = { pSrc[4 * x], pSrc[4 * x + 1], pSrc[4 * x + 2], pSrc[4 * x + 3], 0, 0xff };
+                    for (uint32_t c = 0; c < 4; c++) pDst[4 * x + c] = texel[swizzle[c]];
+                }
+            }
+
+            falcor_target_ssse3 void swizzleRowSsse3(const uint8_t* pSrc, uint8_t* pDst, uint32_t width, const Swizzle& swizzle)
+            {
+                // pshufb writes zero for indices with the high bit set, kOne channels are or'ed in afterwards
+                alignas(16) uint8_t shuffle[16];
+                alignas(16) uint8_t ones[16];
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    uint8_t s = swizzle[i % 4];
+                    shuffle[i] = (s < 4) ? uint8_t((i & ~3u) + s) : 0x80;
+                    ones[i] = (s == kOne) ? 0xff : 0;
+                }
+                const __m128i vShuffle = _mm_load_si128((const __m128i*)shuffle);
+                const __m128i vOnes = _mm_load_si128((const __m128i*)ones);
+
+                uint32_t x = 0;
+                for (; x + 4 <= width; x += 4)
+                {
+                    __m128i v = _mm_loadu_si128((const __m128i*)(pSrc + 4 * x));
+                    v = _mm_or_si128(_mm_shuffle_epi8(v, vShuffle), vOnes);
+                    _mm_storeu_si128((__m128i*)(pDst + 4 * x), v);
+                }
+                swizzleRowScalar(pSrc + 4 * x, pDst + 4 * x, width - x, swizzle);
+            }
+
+            // Channel count conversion
+
+            template<typename T>
+            void convertRowScalar(const uint8_t* pSrc, uint32_t srcChannels, uint8_t* pDst, uint32_t dstChannels, uint32_t width, uint32_t alpha)
+            {
+                const T* pSrcT = (const T*)pSrc;
+                T* pDstT = (T*)pDst;
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    for (uint32_t c = 0; c < dstChannels; c++)
+                    {
+                        T value = (c == 3) ? T(alpha) : T(0);
+                        pDstT[x * dstChannels + c] = (c < srcChannels) ? pSrcT[x * srcChannels + c] : value;
+                    }
+                }
+            }
+
+            void convertRowScalar(uint32_t bytesPerChannel, const uint8_t* pSrc, uint32_t srcChannels, uint8_t* pDst, uint32_t dstChannels, uint32_t width, uint32_t alpha)
+            {
+                switch (bytesPerChannel)
+                {
+                case 1:
+                    convertRowScalar<uint8_t>(pSrc, srcChannels, pDst, dstChannels, width, alpha);
+                    break;
+                case 2:
+                    convertRowScalar<uint16_t>(pSrc, srcChannels, pDst, dstChannels, width, alpha);
+                    break;
+                default:
+                    convertRowScalar<uint32_t>(pSrc, srcChannels, pDst, dstChannels, width, alpha);
+                    break;
+                }
+            }
+
+            // 8-bit RGB to RGBA, 4 pixels per iteration
+            falcor_target_ssse3 uint32_t expandRow8Ssse3(const uint8_t* pSrc, uint8_t* pDst, uint32_t width, uint32_t alpha)
+            {
+                const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128);
+                const __m128i vAlpha = _mm_set1_epi32(int(alpha << 24));
+
+                // Each iteration reads 16 bytes but only uses 12, stop before reading past the end of the row
+                uint32_t x = 0;
+                for (; x + 6 <= width; x += 4)
+                {
+                    __m128i v = _mm_loadu_si128((const __m128i*)(pSrc + 3 * x));
+                    v = _mm_or_si128(_mm_shuffle_epi8(v, shuffle), vAlpha);
+                    _mm_storeu_si128((__m128i*)(pDst + 4 * x), v);
+                }
+                return x;
+            }
+
+            // 8-bit RGBA to RGB, 4 pixels per iteration
+            falcor_target_ssse3 uint32_t shrinkRow8Ssse3(const uint8_t* pSrc, uint8_t* pDst, uint32_t width)
+            {
+                const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -128, -128, -128, -128);
+
+                uint32_t x = 0;
+                for (; x + 4 <= width; x += 4)
+                {
+                    __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pSrc + 4 * x)), shuffle);
+                    _mm_storel_epi64((__m128i*)(pDst + 3 * x), v);
+                    int32_t last = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+                    std::memcpy(pDst + 3 * x + 8, &last, sizeof(last));
+                }
+                return x;
+            }
+
+            // 32-bit RGB to RGBA, one pixel per iteration. Reads 4 bytes past each pixel, so the last pixel is left to the caller.
+            uint32_t expandRow32Sse2(const uint8_t* pSrc, uint8_t* pDst, uint32_t width, uint32_t alpha)
+            {
+                const __m128i mask = _mm_setr_epi32(-1, -1, -1, 0);
+                const __m128i vAlpha = _mm_setr_epi32(0, 0, 0, int(alpha));
+
+                uint32_t x = 0;
+                for (; x + 2 <= width; x++)
+                {
+                    __m128i v = _mm_loadu_si128((const __m128i*)(pSrc + 12 * x));
+                    _mm_storeu_si128((__m128i*)(pDst + 16 * x), _mm_or_si128(_mm_and_si128(v, mask), vAlpha));
+                }
+                return x;
+            }
+
+            // 32-bit RGBA to RGB, one pixel per iteration. Each store writes 4 bytes of the next pixel, which are overwritten by the next iteration.
+            uint32_t shrinkRow32Sse2(const uint8_t* pSrc, uint8_t* pDst, uint32_t width)
+            {
+                uint32_t x = 0;
+                for (; x + 2 <= width; x++)
+                {
+                    _mm_storeu_si128((__m128i*)(pDst + 12 * x), _mm_loadu_si128((const __m128i*)(pSrc + 16 * x)));
+                }
+                return x;
+            }
+
+            // sRGB
+
+            float srgbToLinearValue(float c)
+            {
+                return (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+
+            float linearToSrgbValue(float c)
+            {
+                return (c <= 0.0031308f) ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+            }
+
+            const float* getSrgbToLinearTable()
+            {
+                static float sTable[256];
+                static bool sInitialized = [] { for (uint32_t i = 0; i < 256; i++) sTable[i] = srgbToLinearValue(i / 255.0f); return true; }();
+                (void)sInitialized;
+                return sTable;
+            }
+
+            /** Encoding to sRGB without pow(). The [0, 1] range is split into buckets holding the code of their lower bound.
+                Codes are less than a bucket apart, so the code of a value is either the code of its bucket or the next one.
+                The thresholds are the smallest floats which round to the next code.
+            */
+            struct SrgbEncodeTable
+            {
+                static const uint32_t kBucketCount = 4096;
+                uint8_t bucketCode[kBucketCount];
+                float threshold[256];
+
+                SrgbEncodeTable()
+                {
+                    for (uint32_t c = 0; c < 255; c++)
+                    {
+                        double x = (c + 0.5) / 255.0;
+                        double t = (x <= 0.04045) ? x / 12.92 : std::pow((x + 0.055) / 1.055, 2.4);
+                        float f = float(t);
+                        if (double(f) < t) f = std::nextafter(f, 2.0f);
+                        threshold[c] = f;
+                    }
+                    threshold[255] = 2.0f;
+
+                    for (uint32_t b = 0; b < kBucketCount; b++)
+                    {
+                        float x = float(b) / kBucketCount;
+                        bucketCode[b] = uint8_t(std::upper_bound(threshold, threshold + 255, x) - threshold);
+                        assert(b == 0 || bucketCode[b] - bucketCode[b - 1] <= 1);
+                    }
+                }
+
+                uint8_t encode(float x, uint32_t bucket) const
+                {
+                    uint8_t c = bucketCode[bucket];
+                    return c + (x >= threshold[c] ? 1 : 0);
+                }
+            };
+
+            const SrgbEncodeTable& getSrgbEncodeTable()
+            {
+                static const SrgbEncodeTable sTable;
+                return sTable;
+            }
+
+            uint8_t linearToUnorm8(float x)
+            {
+                return uint8_t(std::max(0.0f, std::min(x, 1.0f)) * 255.0f + 0.5f);
+            }
+
+            void linearToSrgbSse2(const float* pSrc, uint8_t* pDst, uint32_t count, uint32_t channels)
+            {
+                const SrgbEncodeTable& table = getSrgbEncodeTable();
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 one = _mm_set1_ps(1.0f);
+                const __m128 bucketScale = _mm_set1_ps(float(SrgbEncodeTable::kBucketCount));
+                const __m128 lastBucket = _mm_set1_ps(float(SrgbEncodeTable::kBucketCount - 1));
+                const __m128 unormScale = _mm_set1_ps(255.0f);
+                const __m128 half = _mm_set1_ps(0.5f);
+
+                // Groups of 4 values. With 4 channels each group is a pixel and the 4th lane is alpha.
+                uint32_t i = 0;
+                for (; i + 4 <= count; i += 4)
+                {
+                    __m128 v = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(pSrc + i), one), zero);
+                    alignas(16) float values[4];
+                    alignas(16) int32_t buckets[4];
+                    alignas(16) int32_t unorm[4];
+                    _mm_store_ps(values, v);
+                    _mm_store_si128((__m128i*)buckets, _mm_cvttps_epi32(_mm_min_ps(_mm_mul_ps(v, bucketScale), lastBucket)));
+                    _mm_store_si128((__m128i*)unorm, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, unormScale), half)));
+                    for (uint32_t lane = 0; lane < 4; lane++)
+                    {
+                        pDst[i + lane] = (channels == 4 && lane == 3) ? uint8_t(unorm[3]) : table.encode(values[lane], buckets[lane]);
+                    }
+                }
+                for (; i < count; i++)
+                {
+                    float x = std::max(0.0f, std::min(pSrc[i], 1.0f));
+                    uint32_t bucket = std::min(uint32_t(x * SrgbEncodeTable::kBucketCount), SrgbEncodeTable::kBucketCount - 1);
+                    pDst[i] = (channels == 4 && (i % 4) == 3) ? linearToUnorm8(x) : table.encode(x, bucket);
+                }
+            }
+
+            // Half floats. The scalar conversions are exact and round to nearest even like F16C, but NaNs lose their payload.
+
+            uint16_t floatToHalfValue(float f)
+            {
+                uint32_t u;
+                std::memcpy(&u, &f, sizeof(u));
+                uint32_t sign = (u >> 16) & 0x8000;
+                u &= 0x7fffffff;
+
+                uint16_t h;
+                if (u >= 0x47800000)
+                {
+                    // Too large for a half, or inf/NaN
+                    h = (u > 0x7f800000) ? 0x7e00 : 0x7c00;
+                }
+                else if (u < 0x38800000)
+                {
+                    // Denormal or zero. Adding 0.5 aligns the mantissa so the FPU does the rounding.
+                    float v;
+                    std::memcpy(&v, &u, sizeof(v));
+                    v += 0.5f;
+                    uint32_t r;
+                    std::memcpy(&r, &v, sizeof(r));
+                    h = uint16_t(r - 0x3f000000);
+                }
+                else
+                {
+                    uint32_t mantissaOdd = (u >> 13) & 1;
+                    u += 0xc8000fff + mantissaOdd;  // Rebias the exponent from 127 to 15 and round
+                    h = uint16_t(u >> 13);
+                }
+                return uint16_t(h | sign);
+            }
+
+            float halfToFloatValue(uint16_t h)
+            {
+                uint32_t u = uint32_t(h & 0x7fff) << 13;
+                uint32_t exponent = u & 0x0f800000;
+                u += (127 - 15) << 23;
+                if (exponent == 0x0f800000)
+                {
+                    // Inf/NaN
+                    u += (128 - 16) << 23;
+                }
+                else if (exponent == 0)
+                {
+                    // Denormal. Renormalize with the FPU.
+                    u += 1 << 23;
+                    float f;
+                    std::memcpy(&f, &u, sizeof(f));
+                    f -= 6.103515625e-05f;  // 2^-14
+                    std::memcpy(&u, &f, sizeof(u));
+                }
+                u |= uint32_t(h & 0x8000) << 16;
+                float f;
+                std::memcpy(&f, &u, sizeof(f));
+                return f;
+            }
+
+            falcor_target_f16c void floatToHalfF16c(const float* pSrc, uint16_t* pDst, uint32_t count)
+            {
+                uint32_t i = 0;
+                for (; i + 8 <= count; i += 8)
+                {
+                    __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(pSrc + i), 0);
+                    _mm_storeu_si128((__m128i*)(pDst + i), h);
+                }
+                for (; i < count; i++) pDst[i] = floatToHalfValue(pSrc[i]);
+            }
+
+            falcor_target_f16c void halfToFloatF16c(const uint16_t* pSrc, float* pDst, uint32_t count)
+            {
+                uint32_t i = 0;
+                for (; i + 8 <= count; i += 8)
+                {
+                    __m256 f = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(pSrc + i)));
+                    _mm256_storeu_ps(pDst + i, f);
+                }
+                for (; i < count; i++) pDst[i] = halfToFloatValue(pSrc[i]);
+            }
+
+            // Resampling
+
+            /** The filter taps of each destination pixel along one axis. Every pixel has the same number of taps, unused taps have a zero weight.
+            */
+            struct FilterTaps
+            {
+                uint32_t count = 0;
+                std::vector<uint32_t> index;    // Clamped source pixel of each tap
+                std::vector<float> weight;      // Normalized weights
+            };
+
+            double lanczos3(double x)
+            {
+                const double kPi = 3.14159265358979323846;
+                x = std::abs(x);
+                if (x < 1e-8) return 1;
+                if (x >= 3) return 0;
+                double px = kPi * x;
+                return 3 * std::sin(px) * std::sin(px / 3) / (px * px);
+            }
+
+            FilterTaps computeFilterTaps(uint32_t srcSize, uint32_t dstSize, Filter filter)
+            {
+                // When downsampling the filter is stretched to cover the source pixels
+                double scale = double(srcSize) / dstSize;
+                double filterScale = std::max(scale, 1.0);
+                double support = (filter == Filter::Box ? 0.5 : 3.0) * filterScale;
+
+                FilterTaps taps;
+                taps.count = uint32_t(std::ceil(2 * support)) + 1;
+                taps.index.resize(dstSize * taps.count);
+                taps.weight.resize(dstSize * taps.count);
+
+                std::vector<double> weights(taps.count);
+                for (uint32_t i = 0; i < dstSize; i++)
+                {
+                    double center = (i + 0.5) * scale;
+                    int32_t first = int32_t(std::floor(center - support));
+                    double sum = 0;
+                    for (uint32_t t = 0; t < taps.count; t++)
+                    {
+                        int32_t j = first + int32_t(t);
+                        double w;
+                        if (filter == Filter::Box)
+                        {
+                            // The coverage of the source pixel by the destination pixel's footprint
+                            w = std::max(0.0, std::min(double(j + 1), center + support) - std::max(double(j), center - support));
+                        }
+                        else
+                        {
+                            w = lanczos3((j + 0.5 - center) / filterScale);
+                        }
+                        weights[t] = w;
+                        sum += w;
+                        taps.index[i * taps.count + t] = uint32_t(std::min(std::max(j, 0), int32_t(srcSize) - 1));
+                    }
+                    for (uint32_t t = 0; t < taps.count; t++)
+                    {
+                        taps.weight[i * taps.count + t] = float(sum != 0 ? weights[t] / sum : 0);
+                    }
+                }
+                return taps;
+            }
+
+            void resampleRowScalar(const float* pSrc, float* pDst, uint32_t dstWidth, uint32_t channels, const FilterTaps& taps)
+            {
+                for (uint32_t x = 0; x < dstWidth; x++)
+                {
+                    const uint32_t* pIndex = &taps.index[x * taps.count];
+                    const float* pWeight = &taps.weight[x * taps.count];
+                    for (uint32_t c = 0; c < channels; c++)
+                    {
+                        float sum = 0;
+                        for (uint32_t t = 0; t < taps.count; t++) sum += pWeight[t] * pSrc[pIndex[t] * channels + c];
+                        pDst[x * channels + c] = sum;
+                    }
+                }
+            }
+
+            // 4 channels, one pixel per SSE register
+            void resampleRow4Sse2(const float* pSrc, float* pDst, uint32_t dstWidth, const FilterTaps& taps)
+            {
+                for (uint32_t x = 0; x < dstWidth; x++)
+                {
+                    const uint32_t* pIndex = &taps.index[x * taps.count];
+                    const float* pWeight = &taps.weight[x * taps.count];
+                    __m128 sum = _mm_setzero_ps();
+                    for (uint32_t t = 0; t < taps.count; t++)
+                    {
+                        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(pWeight[t]), _mm_loadu_ps(pSrc + pIndex[t] * 4)));
+                    }
+                    _mm_storeu_ps(pDst + x * 4, sum);
+                }
+            }
+
+            // Blends whole rows: dst = sum(weight[t] * row[t])
+            void blendRows(const float* pRows, size_t rowSize, float* pDst, const uint32_t* pIndex, const float* pWeight, uint32_t tapCount, bool simd)
+            {
+                size_t i = 0;
+                if (simd)
+                {
+                    for (; i + 4 <= rowSize; i += 4)
+                    {
+                        __m128 sum = _mm_setzero_ps();
+                        for (uint32_t t = 0; t < tapCount; t++)
+                        {
+                            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(pWeight[t]), _mm_loadu_ps(pRows + pIndex[t] * rowSize + i)));
+                        }
+                        _mm_storeu_ps(pDst + i, sum);
+                    }
+                }
+                for (; i < rowSize; i++)
+                {
+                    float sum = 0;
+                    for (uint32_t t = 0; t < tapCount; t++) sum += pWeight[t] * pRows[pIndex[t] * rowSize + i];
+                    pDst[i] = sum;
+                }
+            }
+        }
+
+        bool isSsse3Supported()
+        {
+            static const bool sSupported = checkSsse3Support();
+            return sSupported;
+        }
+
+        bool isF16cSupported()
+        {
+            static const bool sSupported = checkF16cSupport();
+            return sSupported;
+        }
+
+        void copyRows(uint32_t rowSize, uint32_t height, const void* pSrc, size_t srcPitch, void* pDst, size_t dstPitch, bool flip, Mode mode)
+        {
+            forEachRow(height, rowSize, mode, [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t y = begin; y < end; y++)
+                {
+                    std::memcpy(getDstRow(pDst, dstPitch, y, height, flip), getSrcRow(pSrc, srcPitch, y), rowSize);
+                }
+            });
+        }
+
+        void flipVertical(uint32_t rowSize, uint32_t height, void* pData, size_t pitch, Mode mode)
+        {
+            // Swap the rows of the top half with the bottom half
+            forEachRow(height / 2, rowSize * 2, mode, [&](uint32_t begin, uint32_t end)
+            {
+                std::vector<uint8_t> temp(rowSize);
+                for (uint32_t y = begin; y < end; y++)
+                {
+                    uint8_t* pTop = getDstRow(pData, pitch, y, height, false);
+                    uint8_t* pBottom = getDstRow(pData, pitch, y, height, true);
+                    std::memcpy(temp.data(), pTop, rowSize);
+                    std::memcpy(pTop, pBottom, rowSize);
+                    std::memcpy(pBottom, temp.data(), rowSize);
+                }
+            });
+        }
+
+        void swizzleRgba8(uint32_t width, uint32_t height, const void* pSrc, size_t srcPitch, void* pDst, size_t dstPitch, const Swizzle& swizzle, bool flip, Mode mode)
+        {
+            for (uint8_t s : swizzle) assert(s <= kOne);
+            assert(pSrc != pDst || (srcPitch == dstPitch && flip == false));
+
+            bool useSsse3 = mode != Mode::Scalar && isSsse3Supported();
+            forEachRow(height, width * 4, mode, [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t y = begin; y < end; y++)
+                {
+                    const uint8_t* pSrcRow = getSrcRow(pSrc, srcPitch, y);
+                    uint8_t* pDstRow = getDstRow(pDst, dstPitch, y, height, flip);
+                    if (useSsse3) swizzleRowSsse3(pSrcRow, pDstRow, width, swizzle);
+                    else swizzleRowScalar(pSrcRow, pDstRow, width, swizzle);
+                }
+            });
+        }
+
+        void convertChannelCount(uint32_t width, uint32_t height, uint32_t bytesPerChannel, uint32_t srcChannels, const void* pSrc, size_t srcPitch, uint32_t dstChannels, void* pDst, size_t dstPitch, uint32_t alpha, bool flip, Mode mode)
+        {
+            assert(bytesPerChannel == 1 || bytesPerChannel == 2 || bytesPerChannel == 4);
+            assert(srcChannels >= 1 && srcChannels <= 4 && dstChannels >= 1 && dstChannels <= 4);
+            assert(pSrc != pDst);
+
+            bool simd = mode != Mode::Scalar;
+            bool useSsse3 = simd && isSsse3Supported() && bytesPerChannel == 1;
+            bool useSse2 = simd && bytesPerChannel == 4;
+            bool expand = srcChannels == 3 && dstChannels == 4;
+            bool shrink = srcChannels == 4 && dstChannels == 3;
+
+            forEachRow(height, width * bytesPerChannel * std::max(srcChannels, dstChannels), mode, [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t y = begin; y < end; y++)
+                {
+                    const uint8_t* pSrcRow = getSrcRow(pSrc, srcPitch, y);
+                    uint8_t* pDstRow = getDstRow(pDst, dstPitch, y, height, flip);
+
+                    // The SIMD paths return the number of pixels they converted, the scalar code does the rest
+                    uint32_t x = 0;
+                    if (useSsse3 && expand) x = expandRow8Ssse3(pSrcRow, pDstRow, width, alpha);
+                    else if (useSsse3 && shrink) x = shrinkRow8Ssse3(pSrcRow, pDstRow, width);
+                    else if (useSse2 && expand) x = expandRow32Sse2(pSrcRow, pDstRow, width, alpha);
+                    else if (useSse2 && shrink) x = shrinkRow32Sse2(pSrcRow, pDstRow, width);
+
+                    size_t srcPixelSize = bytesPerChannel * srcChannels;
+                    size_t dstPixelSize = bytesPerChannel * dstChannels;
+                    convertRowScalar(bytesPerChannel, pSrcRow + x * srcPixelSize, srcChannels, pDstRow + x * dstPixelSize, dstChannels, width - x, alpha);
+                }
+            });
+        }
+
+        void srgbToLinear(uint32_t pixelCount, uint32_t channels, const uint8_t* pSrc, float* pDst, Mode mode)
+        {
+            // A table lookup is faster than any arithmetic approximation, so the SIMD modes only differ by using the table
+            const float* pTable = (mode == Mode::Scalar) ? nullptr : getSrgbToLinearTable();
+            forEachRow(pixelCount, channels * sizeof(float), mode, [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t i = begin; i < end; i++)
+                {
+                    for (uint32_t c = 0; c < channels; c++)
+                    {
+                        uint8_t v = pSrc[i * channels + c];
+                        if (channels == 4 && c == 3) pDst[i * channels + c] = v / 255.0f;
+                        else pDst[i * channels + c] = pTable ? pTable[v] : srgbToLinearValue(v / 255.0f);
+                    }
+                }
+            });
+        }
+
+        void linearToSrgb(uint32_t pixelCount, uint32_t channels, const float* pSrc, uint8_t* pDst, Mode mode)
+        {
+            // Chunks start on pixel boundaries which are multiples of 4 values, so the alpha lanes line up in the SIMD code
+            forEachRow(pixelCount, channels * sizeof(float), mode, [&](uint32_t begin, uint32_t end)
+            {
+                if (mode == Mode::Scalar)
+                {
+                    for (uint32_t i = begin * channels; i < end * channels; i++)
+                    {
+                        float x = std::max(0.0f, std::min(pSrc[i], 1.0f));
+                        pDst[i] = (channels == 4 && (i % 4) == 3) ? linearToUnorm8(x) : uint8_t(linearToSrgbValue(x) * 255.0f + 0.5f);
+                    }
+                }
+                else
+                {
+                    linearToSrgbSse2(pSrc + begin * channels, pDst + begin * channels, (end - begin) * channels, channels);
+                }
+            });
+        }
+
+        void floatToHalf(uint32_t count, const float* pSrc, uint16_t* pDst, Mode mode)
+        {
+            bool useF16c = mode != Mode::Scalar && isF16cSupported();
+            forEachRow(count, sizeof(float), mode, [&](uint32_t begin, uint32_t end)
+            {
+                if (useF16c) floatToHalfF16c(pSrc + begin, pDst + begin, end - begin);
+                else for (uint32_t i = begin; i < end; i++) pDst[i] = floatToHalfValue(pSrc[i]);
+            });
+        }
+
+        void halfToFloat(uint32_t count, const uint16_t* pSrc, float* pDst, Mode mode)
+        {
+            bool useF16c = mode != Mode::Scalar && isF16cSupported();
+            forEachRow(count, sizeof(float), mode, [&](uint32_t begin, uint32_t end)
+            {
+                if (useF16c) halfToFloatF16c(pSrc + begin, pDst + begin, end - begin);
+                else for (uint32_t i = begin; i < end; i++) pDst[i] = halfToFloatValue(pSrc[i]);
+            });
+        }
+
+        std::vector<float> resample(uint32_t width, uint32_t height, uint32_t channels, const float* pSrc, uint32_t dstWidth, uint32_t dstHeight, Filter filter, Mode mode)
+        {
+            std::vector<float> dst;
+            if (width == 0 || height == 0 || dstWidth == 0 || dstHeight == 0 || channels == 0)
+            {
+                logError("ImageProcessing::resample() - the image sizes and the channel count must be larger than 0");
+                return dst;
+            }
+
+            FilterTaps horizontal = computeFilterTaps(width, dstWidth, filter);
+            FilterTaps vertical = computeFilterTaps(height, dstHeight, filter);
+            bool simd = mode != Mode::Scalar;
+
+            // Resample the rows, then blend the resampled rows
+            size_t rowSize = size_t(dstWidth) * channels;
+            std::vector<float> rows(rowSize * height);
+            forEachRow(height, rowSize * sizeof(float), mode, [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t y = begin; y < end; y++)
+                {
+                    const float* pSrcRow = pSrc + size_t(y) * width * channels;
+                    float* pDstRow = rows.data() + y * rowSize;
+                    if (simd && channels == 4) resampleRow4Sse2(pSrcRow, pDstRow, dstWidth, horizontal);
+                    else resampleRowScalar(pSrcRow, pDstRow, dstWidth, channels, horizontal);
+                }
+            });
+
+            dst.resize(rowSize * dstHeight);
+            forEachRow(dstHeight, rowSize * vertical.count * sizeof(float), mode, [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t y = begin; y < end; y++)
+                {
+                    blendRows(rows.data(), rowSize, dst.data() + y * rowSize, &vertical.index[y * vertical.count], &vertical.weight[y * vertical.count], vertical.count, simd);
+                }
+            });
+            return dst;
+        }
+    }
+}
@@ -0,0 +1,130 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <array>
+#include <vector>
+
+namespace Falcor
+{
+    /** CPU pixel-format conversion and resampling for tools and file I/O (Bitmap loading and saving, reference images, thumbnails).
+        The functions use SSE/SSSE3/F16C when the CPU supports them and process the rows in parallel on the worker threads (see parallelFor()).
+        Unless stated otherwise, images are arrays of rows. A row pitch is the distance in bytes between the start of consecutive rows.
+        When 'flip' is set, the first source row is written to the last destination row.
+    */
+    namespace ImageProcessing
+    {
+        enum class Mode
+        {
+            Scalar,     ///< Plain C++, single threaded. Used as a reference.
+            Simd,       ///< The fastest instruction set supported by the CPU, single threaded
+            Parallel,   ///< SIMD, split into chunks of rows processed on the worker threads
+        };
+
+        enum class Filter
+        {
+            Box,        ///< Area average. The exact result for integer downsampling ratios.
+            Lanczos3,   ///< Sharper, may overshoot around edges
+        };
+
+        /** A channel mapping for swizzleRgba8(). Entry i is the source channel of destination channel i, or kZero/kOne.
+        */
+        using Swizzle = std::array<uint8_t, 4>;
+        static const uint8_t kZero = 4;     ///< Write 0 to the channel
+        static const uint8_t kOne = 5;      ///< Write 0xff to the channel
+
+        /** Bit patterns of 1.0 for the 'alpha' parameter of convertChannelCount()
+        */
+        static const uint32_t kAlphaOneUnorm8 = 0xff;
+        static const uint32_t kAlphaOneHalf = 0x3c00;
+        static const uint32_t kAlphaOneFloat = 0x3f800000;
+
+        /** Copy rows of bytes
+            \param[in] rowSize The number of bytes to copy per row
+            \param[in] height The number of rows
+            \param[in] pSrc The source image. Must not overlap the destination.
+            \param[in] srcPitch The source row pitch
+            \param[out] pDst The destination image
+            \param[in] dstPitch The destination row pitch
+            \param[in] flip Flip the image vertically
+        */
+        void copyRows(uint32_t rowSize, uint32_t height, const void* pSrc, size_t srcPitch, void* pDst, size_t dstPitch, bool flip, Mode mode = Mode::Parallel);
+
+        /** Flip an image vertically, in place
+        */
+        void flipVertical(uint32_t rowSize, uint32_t height, void* pData, size_t pitch, Mode mode = Mode::Parallel);
+
+        /** Reorder the channels of an image with 4 channels of 8 bits, e.g., RGBA to BGRA.
+            The conversion can be done in place if pSrc == pDst, the pitches are equal and flip is false.
+        */
+        void swizzleRgba8(uint32_t width, uint32_t height, const void* pSrc, size_t srcPitch, void* pDst, size_t dstPitch, const Swizzle& swizzle, bool flip, Mode mode = Mode::Parallel);
+
+        /** Add or remove channels, e.g., RGB to RGBA. The channels are copied as raw bits.
+            \param[in] bytesPerChannel The size of a channel. Either 1, 2 or 4.
+            \param[in] srcChannels The number of source channels, 1 to 4
+            \param[in] dstChannels The number of destination channels, 1 to 4
+            \param[in] alpha The bit pattern written to the alpha channel when it's added. Other added channels are zero.
+        */
+        void convertChannelCount(uint32_t width, uint32_t height, uint32_t bytesPerChannel, uint32_t srcChannels, const void* pSrc, size_t srcPitch, uint32_t dstChannels, void* pDst, size_t dstPitch, uint32_t alpha, bool flip, Mode mode = Mode::Parallel);
+
+        /** Convert 8-bit sRGB-encoded values to linear floats. The images are tightly packed.
+            With 4 channels the 4th channel is treated as a linear alpha channel.
+        */
+        void srgbToLinear(uint32_t pixelCount, uint32_t channels, const uint8_t* pSrc, float* pDst, Mode mode = Mode::Parallel);
+
+        /** Convert linear floats to 8-bit sRGB-encoded values, correctly rounded. Values are clamped to [0, 1]. The images are tightly packed.
+            With 4 channels the 4th channel is treated as a linear alpha channel.
+        */
+        void linearToSrgb(uint32_t pixelCount, uint32_t channels, const float* pSrc, uint8_t* pDst, Mode mode = Mode::Parallel);
+
+        /** Convert 32-bit floats to 16-bit floats, rounding to nearest even
+        */
+        void floatToHalf(uint32_t count, const float* pSrc, uint16_t* pDst, Mode mode = Mode::Parallel);
+
+        /** Convert 16-bit floats to 32-bit floats
+        */
+        void halfToFloat(uint32_t count, const uint16_t* pSrc, float* pDst, Mode mode = Mode::Parallel);
+
+        /** Resample a floating-point image with a separable filter. Usually used for downsampling, e.g., to create thumbnails.
+            The image edges are clamped.
+            \param[in] width The source width
+            \param[in] height The source height
+            \param[in] channels The number of channels per pixel
+            \param[in] pSrc The source image, tightly packed
+            \param[in] dstWidth The destination width
+            \param[in] dstHeight The destination height
+            \param[in] filter The reconstruction filter
+            \return The resampled image, tightly packed
+        */
+        std::vector<float> resample(uint32_t width, uint32_t height, uint32_t channels, const float* pSrc, uint32_t dstWidth, uint32_t dstHeight, Filter filter, Mode mode = Mode::Parallel);
+
+        /** Check which instruction sets are used by the SIMD code paths
+        */
+        bool isSsse3Supported();
+        bool isF16cSupported();
+    }
+}
@@ -1,5 +1,5 @@
 /***************************************************************************
-# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
 #
 # Redistribution and use in source and binary forms, with or without
 # modification, are permitted provided that the following conditions
@@ -29,6 +29,18 @@
 #include "Logger.h"
 #include "Utils/Platform/OS.h"
 #include <cstdio>
+#include <csignal>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <unordered_map>
+#include <exception>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 namespace Falcor
 {
@@ -38,9 +50,318 @@ namespace Falcor
     bool Logger::sShowErrorBox = false;
 #endif
 
-    FILE* Logger::sLogFile = nullptr;
     Logger::Level Logger::sVerbosity = Logger::Level::Warning;
 
+    const char* getLogLevelString(Logger::Level L);
+
+    namespace
+    {
+        const size_t kRingSize = 256 * 1024;                    // Per thread
+        const size_t kMaxRecordSize = kRingSize / 4;            // Larger messages bypass the ring
+        const auto kFlushInterval = std::chrono::milliseconds(50);
+        const auto kRateLimitWindow = std::chrono::seconds(1);
+
+        struct RecordHeader
+        {
+            uint32_t size;          // Size of the record, including the header and padding. 0 marks the end of the buffer.
+            uint32_t length;        // Length of the message
+            uint64_t sequence;      // Global order of the message
+            Logger::Level level;
+        };
+
+        /** Single-producer single-consumer ring of variable-sized records.
+            The owning thread writes, the consumer (the writer thread or a flush) reads.
+        */
+        class MessageRing
+        {
+        public:
+            MessageRing() : mData(kRingSize) {}
+
+            bool push(Logger::Level level, uint64_t sequence, const std::string& msg)
+            {
+                size_t recordSize = align_to(8, sizeof(RecordHeader) + msg.size());
+                size_t head = mHead.load(std::memory_order_relaxed);
+                size_t tail = mTail.load(std::memory_order_acquire);
+                size_t offset = head % kRingSize;
+                size_t contiguous = kRingSize - offset;
+                size_t needed = recordSize + ((recordSize > contiguous) ? contiguous : 0);
+                if (kRingSize - (head - tail) < needed) return false;
+
+                if (recordSize > contiguous)
+                {
+                    // Skip the end of the buffer
+                    uint32_t endMarker = 0;
+                    std::memcpy(&mData[offset], &endMarker, sizeof(endMarker));
+                    head += contiguous;
+                    offset = 0;
+                }
+
+                RecordHeader header = { (uint32_t)recordSize, (uint32_t)msg.size(), sequence, level };
+                std::memcpy(&mData[offset], &header, sizeof(header));
+                std::memcpy(&mData[offset + sizeof(header)], msg.data(), msg.size());
+                mHead.store(head + recordSize, std::memory_order_release);
+                return true;
+            }
+
+            size_t getUsedSize() const { return mHead.load(std::memory_order_relaxed) - mTail.load(std::memory_order_relaxed); }
+
+            /** Visit the pending records without consuming them. Returns the position after the last one.
+                It only reads the buffer, so the signal handler can call it while a consumer is draining. Records that don't look valid, which can happen in that case, end the walk.
+            */
+            template<typename Func>
+            size_t peek(Func func) const
+            {
+                size_t tail = mTail.load(std::memory_order_relaxed);
+                size_t head = mHead.load(std::memory_order_acquire);
+                while (tail != head)
+                {
+                    size_t offset = tail % kRingSize;
+                    RecordHeader header;
+                    std::memcpy(&header.size, &mData[offset], sizeof(header.size));
+                    if (header.size == 0)
+                    {
+                        tail += kRingSize - offset;
+                        continue;
+                    }
+                    std::memcpy(&header, &mData[offset], sizeof(header));
+                    if (header.size < sizeof(header) || header.size > kRingSize - offset || header.length > header.size - sizeof(header)) break;
+                    func(header, (const char*)&mData[offset + sizeof(header)]);
+                    tail += header.size;
+                }
+                return tail;
+            }
+
+            template<typename Func>
+            void drain(Func func)
+            {
+                mTail.store(peek(func), std::memory_order_release);
+            }
+
+            bool isEmpty() const { return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_relaxed); }
+
+            std::atomic<bool> orphaned{ false };    // Set when the owning thread exits
+
+        private:
+            std::vector<uint8_t> mData;
+            alignas(64) std::atomic<size_t> mHead{ 0 };
+            alignas(64) std::atomic<size_t> mTail{ 0 };
+        };
+
+        struct PendingMessage
+        {
+            uint64_t sequence;
+            Logger::Level level;
+            std::string text;
+        };
+
+        struct RepeatInfo
+        {
+            std::chrono::steady_clock::time_point windowStart;
+            uint32_t count;
+            uint32_t suppressed;
+            Logger::Level level;
+        };
+
+        FILE* sLogFile = nullptr;
+        int sLogFd = -1;                    // sLogFile's descriptor, which the signal handler writes to
+        std::string sLogFilename;
+        std::atomic<uint64_t> sSequence{ 0 };
+        std::atomic<uint32_t> sMaxRepeatsPerSecond{ 10 };
+
+        std::mutex sRingsMutex;             // Protects the list of rings. Producers only take it once per thread.
+        std::vector<std::shared_ptr<MessageRing>> sRings;
+
+        std::recursive_mutex sConsumerMutex;    // Serializes the consumers and the file writes
+        std::vector<PendingMessage> sBatch;
+        std::unordered_map<std::string, RepeatInfo> sRepeats;
+
+        std::mutex sWakeMutex;
+        std::condition_variable sWakeCondition;
+        std::thread sWriterThread;
+        std::atomic<bool> sWriterRunning{ false };
+
+        struct ThreadRingHandle
+        {
+            std::shared_ptr<MessageRing> pRing;
+            ~ThreadRingHandle() { if (pRing) pRing->orphaned = true; }
+        };
+
+        MessageRing* getThreadRing()
+        {
+            static thread_local ThreadRingHandle sHandle;
+            if (sHandle.pRing == nullptr)
+            {
+                sHandle.pRing = std::make_shared<MessageRing>();
+                std::lock_guard<std::mutex> lock(sRingsMutex);
+                sRings.push_back(sHandle.pRing);
+            }
+            return sHandle.pRing.get();
+        }
+
+        void wakeWriter()
+        {
+            sWakeCondition.notify_one();
+        }
+
+        void writeLine(Logger::Level level, const std::string& text, const char* suffix = nullptr)
+        {
+            std::string s = getLogLevelString(level) + std::string("\t") + text + (suffix ? suffix : "") + "\n";
+            std::fwrite(s.data(), 1, s.size(), sLogFile);
+            if (isDebuggerPresent())
+            {
+                printToDebugWindow(s);
+            }
+        }
+
+        void writeRepeatSummary(const std::string& text, const RepeatInfo& info)
+        {
+            writeLine(info.level, text, (" [repeated " + std::to_string(info.suppressed) + " more times]").c_str());
+        }
+
+        // Returns true if the message should be written
+        bool checkRateLimit(const PendingMessage& msg, std::chrono::steady_clock::time_point now)
+        {
+            // Errors are never suppressed, a repeated error is still worth seeing every time
+            uint32_t maxRepeats = sMaxRepeatsPerSecond.load(std::memory_order_relaxed);
+            if (maxRepeats == 0 || msg.level >= Logger::Level::Error) return true;
+
+            auto it = sRepeats.find(msg.text);
+            if (it == sRepeats.end())
+            {
+                sRepeats[msg.text] = { now, 1, 0, msg.level };
+                return true;
+            }
+            RepeatInfo& info = it->second;
+            if (++info.count <= maxRepeats) return true;
+            info.suppressed++;
+            return false;
+        }
+
+        void expireRepeats(std::chrono::steady_clock::time_point now, bool expireAll)
+        {
+            for (auto it = sRepeats.begin(); it != sRepeats.end();)
+            {
+                if (expireAll || now - it->second.windowStart >= kRateLimitWindow)
+                {
+                    if (it->second.suppressed) writeRepeatSummary(it->first, it->second);
+                    it = sRepeats.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        // Write all the pending messages. Must be called with sConsumerMutex held.
+        void drainRings(bool expireAllRepeats)
+        {
+            if (sLogFile == nullptr) return;
+
+            std::vector<std::shared_ptr<MessageRing>> rings;
+            {
+                std::lock_guard<std::mutex> lock(sRingsMutex);
+                rings = sRings;
+                // Rings of exited threads are released once empty
+                sRings.erase(std::remove_if(sRings.begin(), sRings.end(), [](const std::shared_ptr<MessageRing>& pRing) { return pRing->orphaned && pRing->isEmpty(); }), sRings.end());
+            }
+
+            sBatch.clear();
+            for (auto& pRing : rings)
+            {
+                pRing->drain([](const RecordHeader& header, const char* pText)
+                {
+                    sBatch.push_back({ header.sequence, header.level, std::string(pText, header.length) });
+                });
+            }
+
+            // Restore the global order across threads
+            std::sort(sBatch.begin(), sBatch.end(), [](const PendingMessage& a, const PendingMessage& b) { return a.sequence < b.sequence; });
+
+            auto now = std::chrono::steady_clock::now();
+            expireRepeats(now, false);
+            for (const auto& msg : sBatch)
+            {
+                if (checkRateLimit(msg, now)) writeLine(msg.level, msg.text);
+            }
+            if (expireAllRepeats) expireRepeats(now, true);
+            fflush(sLogFile);
+        }
+
+        void writerThreadFunc()
+        {
+            while (sWriterRunning)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(sWakeMutex);
+                    sWakeCondition.wait_for(lock, kFlushInterval);
+                }
+                std::lock_guard<std::recursive_mutex> lock(sConsumerMutex);
+                drainRings(false);
+            }
+        }
+
+        void crashFlush()
+        {
+            // The crashing thread might be the one holding the lock. Don't deadlock in that case.
+            if (sConsumerMutex.try_lock())
+            {
+                drainRings(true);
+                sConsumerMutex.unlock();
+            }
+        }
+
+        void writeToLogFd(const char* pData, size_t size)
+        {
+#ifdef _WIN32
+            _write(sLogFd, pData, (unsigned int)size);
+#else
+            ssize_t written = ::write(sLogFd, pData, size);
+            (void)written;
+#endif
+        }
+
+        using SignalHandler = void(*)(int);
+        const int kCrashSignals[] = { SIGSEGV, SIGABRT, SIGFPE, SIGILL };
+        SignalHandler sPrevSignalHandlers[arraysize(kCrashSignals)] = {};
+
+        void signalHandler(int sig)
+        {
+            // Only async-signal-safe calls here: no locks, no allocations and no stdio. The records still in the rings are written to the file
+            // descriptor as they are, ring by ring, which keeps the per-thread order. Lines the writer thread has buffered but not flushed are lost.
+            if (sLogFd >= 0)
+            {
+                for (size_t i = 0; i < sRings.size(); i++)
+                {
+                    sRings[i]->peek([](const RecordHeader& header, const char* pText)
+                    {
+                        const char* pLevel = getLogLevelString(header.level);
+                        writeToLogFd(pLevel, std::strlen(pLevel));
+                        writeToLogFd("\t", 1);
+                        writeToLogFd(pText, header.length);
+                        writeToLogFd("\n", 1);
+                    });
+                }
+            }
+
+            // Hand the signal to the handler that was installed before ours
+            for (size_t i = 0; i < arraysize(kCrashSignals); i++)
+            {
+                if (kCrashSignals[i] == sig) std::signal(sig, (sPrevSignalHandlers[i] == SIG_ERR) ? SIG_DFL : sPrevSignalHandlers[i]);
+            }
+            std::raise(sig);
+        }
+
+        std::terminate_handler sPrevTerminateHandler = nullptr;
+
+        void terminateHandler()
+        {
+            crashFlush();
+            if (sPrevTerminateHandler) sPrevTerminateHandler();
+            std::abort();
+        }
+    }
+
     static FILE* openLogFile()
     {
         FILE* pFile = nullptr;
@@ -58,6 +379,7 @@ namespace Falcor
             if(pFile != nullptr)
             {
                 // Success
+                sLogFilename = logFile;
                 return pFile;
             }
         }
@@ -72,6 +394,22 @@ namespace Falcor
         sLogFile = openLogFile();
         sInit = sLogFile != nullptr;
         assert(sInit);
+
+        if (sInit)
+        {
+            sWriterRunning = true;
+            sWriterThread = std::thread(writerThreadFunc);
+
+            // Make sure the pending messages reach the file when the application crashes or exits without calling shutdown()
+#ifdef _WIN32
+            sLogFd = _fileno(sLogFile);
+#else
+            sLogFd = fileno(sLogFile);
+#endif
+            for (size_t i = 0; i < arraysize(kCrashSignals); i++) sPrevSignalHandlers[i] = std::signal(kCrashSignals[i], signalHandler);
+            sPrevTerminateHandler = std::set_terminate(terminateHandler);
+            std::atexit(shutdown);
+        }
 #endif
         return sInit;
     }
@@ -81,15 +419,43 @@ namespace Falcor
     void Logger::shutdown()
     {
 #if _LOG_ENABLED
+        if (sWriterThread.joinable())
+        {
+            sWriterRunning = false;
+            wakeWriter();
+            sWriterThread.join();
+        }
+
+        std::lock_guard<std::recursive_mutex> lock(sConsumerMutex);
         if(sLogFile)
         {
+            sInit = false;
+            drainRings(true);
+            sLogFd = -1;
             fclose(sLogFile);
             sLogFile = nullptr;
-            sInit = false;
         }
 #endif
     }
 
+    void Logger::flush()
+    {
+#if _LOG_ENABLED
+        std::lock_guard<std::recursive_mutex> lock(sConsumerMutex);
+        drainRings(false);
+#endif
+    }
+
+    const std::string& Logger::getLogFilename()
+    {
+        return sLogFilename;
+    }
+
+    void Logger::setRateLimit(uint32_t maxRepeatsPerSecond)
+    {
+        sMaxRepeatsPerSecond = maxRepeatsPerSecond;
+    }
+
     const char* getLogLevelString(Logger::Level L)
     {
         const char* c = nullptr;
@@ -99,6 +465,7 @@ namespace Falcor
             create_level_case(Logger::Level::Info);
             create_level_case(Logger::Level::Warning);
             create_level_case(Logger::Level::Error);
+            create_level_case(Logger::Level::Fatal);
         default:
             should_not_get_here();
         }
@@ -113,13 +480,30 @@ namespace Falcor
         {
             if(L >= sVerbosity)
             {
-                std::string s = getLogLevelString(L) + std::string("\t") + msg + "\n";
-                std::fprintf(sLogFile, "%s", s.c_str());
-                fflush(sLogFile);   // Slows down execution, but ensures that the message will be printed in case of a crash
-                if (isDebuggerPresent())
+                // Only copy the message here. Formatting and I/O happen on the writer thread.
+                uint64_t sequence = sSequence.fetch_add(1, std::memory_order_relaxed);
+                bool queued = false;
+                if (sizeof(RecordHeader) + msg.size() <= kMaxRecordSize)
                 {
-                    printToDebugWindow(s);
+                    MessageRing* pRing = getThreadRing();
+                    while ((queued = pRing->push(L, sequence, msg)) == false)
+                    {
+                        // The ring is full. Let the writer catch up.
+                        wakeWriter();
+                        std::this_thread::yield();
+                    }
+                    if (pRing->getUsedSize() > kRingSize / 2) wakeWriter();
                 }
+
+                if (queued == false)
+                {
+                    std::lock_guard<std::recursive_mutex> lock(sConsumerMutex);
+                    drainRings(false);
+                    if (sLogFile) writeLine(L, msg);
+                }
+
+                // Errors often precede a crash. Make sure they reach the file.
+                if (L >= Level::Error) flush();
             }
         }
 #endif
@@ -141,4 +525,4 @@ namespace Falcor
 
         if (L >= Level::Fatal) assert(false);   // PETRIK: Assert on errors even without debugger attached
     }
-}
\ No newline at end of file
+}
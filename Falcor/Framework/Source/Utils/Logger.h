@@ -34,6 +34,8 @@ namespace Falcor
     /** Container class for logging messages. 
     *   To enable log messages, make sure _LOG_ENABLED is set to true in FalcorConfig.h.
     *   Messages are printed to a log file in the application directory. Using Logger#ShowBoxOnError() you can control if a message box will be shown as well.
+    *   Logging is asynchronous. Each thread copies its messages into its own lock-free ring buffer and a background thread formats them and writes them to the file.
+    *   The order of messages is preserved per thread. Errors, crashes and shutdown flush the pending messages synchronously.
     */
     class Logger
     {
@@ -53,6 +55,19 @@ namespace Falcor
         */
         static void shutdown();
 
+        /** Write all the pending messages to the log file. Called automatically on errors and when the application crashes.
+        */
+        static void flush();
+
+        /** Get the path of the log file. Empty if the logger is disabled.
+        */
+        static const std::string& getLogFilename();
+
+        /** Limit the number of times an identical info or warning message is written per second. Further repeats are counted and reported in a single line once the second is over. Errors are never limited.
+            \param[in] maxRepeatsPerSecond The number of repeats to write. 0 disables the limit.
+        */
+        static void setRateLimit(uint32_t maxRepeatsPerSecond);
+
         /** Controls weather or not to show message box on log messages.
             \param[in] showBox true to show a message box, false to disable it.
         */
@@ -81,7 +96,6 @@ namespace Falcor
 
         Logger() = delete;
         static bool sShowErrorBox;
-        static FILE* sLogFile;
         static bool sInit;
         static Level sVerbosity;
         static bool init();
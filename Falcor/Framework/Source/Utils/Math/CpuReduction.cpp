@@ -0,0 +1,255 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "CpuReduction.h"
+#include "Utils/ParallelFor.h"
+#include <cmath>
+#include <limits>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kTexelsPerChunk = 64 * 1024;
+
+        // The partial result of a range of rows
+        struct Partial
+        {
+            double a[4] = { 0, 0, 0, 0 };      // Sum, or sum of log luminance in a[0]
+            double b[4] = { 0, 0, 0, 0 };      // Sum of squares
+            float minValue = 1.0f;              // Same initial range as the GPU implementation
+            float maxValue = 0.0f;
+            std::vector<uint32_t> histogram;
+        };
+
+        inline glm::vec4 loadTexel(const float* p, uint32_t channelCount)
+        {
+            glm::vec4 t(0, 0, 0, 1);
+            for (uint32_t c = 0; c < channelCount; c++) t[c] = p[c];
+            return t;
+        }
+
+        inline float luminance(const glm::vec4& t)
+        {
+            return 0.2126f * t.x + 0.7152f * t.y + 0.0722f * t.z;
+        }
+
+        void reduceRowsScalar(ReductionType type, const float* pData, uint32_t width, uint32_t channelCount, uint32_t rowBegin, uint32_t rowEnd, const HistogramRange& range, Partial& partial)
+        {
+            for (uint32_t y = rowBegin; y < rowEnd; y++)
+            {
+                const float* pRow = pData + size_t(y) * width * channelCount;
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    glm::vec4 t = loadTexel(pRow + x * channelCount, channelCount);
+                    switch (type)
+                    {
+                    case ReductionType::MinMax:
+                        if (t.x != 1.0f)
+                        {
+                            partial.minValue = std::min(partial.minValue, t.x);
+                            partial.maxValue = std::max(partial.maxValue, t.x);
+                        }
+                        break;
+                    case ReductionType::Sum:
+                    case ReductionType::Mean:
+                    case ReductionType::Variance:
+                        for (uint32_t c = 0; c < 4; c++)
+                        {
+                            partial.a[c] += t[c];
+                            partial.b[c] += double(t[c]) * t[c];
+                        }
+                        break;
+                    case ReductionType::LogAverageLuminance:
+                        partial.a[0] += std::log(kLuminanceEpsilon + luminance(t));
+                        break;
+                    case ReductionType::Histogram:
+                        partial.histogram[CpuReduction::getHistogramBin(luminance(t), range)]++;
+                        break;
+                    default:
+                        should_not_get_here();
+                    }
+                }
+            }
+        }
+
+        // SSE versions of the cases which map well to it. Rows are accumulated in float, then added to the double totals, the same way the GPU accumulates
+        // groups before combining them.
+        void reduceRowsSimd(ReductionType type, const float* pData, uint32_t width, uint32_t channelCount, uint32_t rowBegin, uint32_t rowEnd, const HistogramRange& range, Partial& partial)
+        {
+            bool isSum = (type == ReductionType::Sum || type == ReductionType::Mean || type == ReductionType::Variance);
+            if (isSum && channelCount == 4)
+            {
+                for (uint32_t y = rowBegin; y < rowEnd; y++)
+                {
+                    const float* pRow = pData + size_t(y) * width * 4;
+                    __m128 sum = _mm_setzero_ps(), sumSq = _mm_setzero_ps();
+                    for (uint32_t x = 0; x < width; x++)
+                    {
+                        __m128 t = _mm_loadu_ps(pRow + x * 4);
+                        sum = _mm_add_ps(sum, t);
+                        sumSq = _mm_add_ps(sumSq, _mm_mul_ps(t, t));
+                    }
+                    alignas(16) float s[4], s2[4];
+                    _mm_store_ps(s, sum);
+                    _mm_store_ps(s2, sumSq);
+                    for (uint32_t c = 0; c < 4; c++)
+                    {
+                        partial.a[c] += s[c];
+                        partial.b[c] += s2[c];
+                    }
+                }
+            }
+            else if (type == ReductionType::MinMax && channelCount == 1)
+            {
+                const __m128 one = _mm_set1_ps(1.0f);
+                __m128 vmin = one, vmax = _mm_setzero_ps();
+                for (uint32_t y = rowBegin; y < rowEnd; y++)
+                {
+                    const float* pRow = pData + size_t(y) * width;
+                    uint32_t x = 0;
+                    for (; x + 4 <= width; x += 4)
+                    {
+                        __m128 v = _mm_loadu_ps(pRow + x);
+                        // Skipped texels are replaced by 1 for the min and 0 for the max, which are the initial values and don't change the result
+                        __m128 skip = _mm_cmpeq_ps(v, one);
+                        vmin = _mm_min_ps(vmin, _mm_or_ps(_mm_and_ps(skip, one), _mm_andnot_ps(skip, v)));
+                        vmax = _mm_max_ps(vmax, _mm_andnot_ps(skip, v));
+                    }
+                    for (; x < width; x++)
+                    {
+                        if (pRow[x] != 1.0f)
+                        {
+                            partial.minValue = std::min(partial.minValue, pRow[x]);
+                            partial.maxValue = std::max(partial.maxValue, pRow[x]);
+                        }
+                    }
+                }
+                alignas(16) float mn[4], mx[4];
+                _mm_store_ps(mn, vmin);
+                _mm_store_ps(mx, vmax);
+                for (uint32_t i = 0; i < 4; i++)
+                {
+                    partial.minValue = std::min(partial.minValue, mn[i]);
+                    partial.maxValue = std::max(partial.maxValue, mx[i]);
+                }
+            }
+            else
+            {
+                // log() and the histogram scatter don't vectorize with plain SSE
+                reduceRowsScalar(type, pData, width, channelCount, rowBegin, rowEnd, range, partial);
+            }
+        }
+    }
+
+    uint32_t CpuReduction::getHistogramBin(float luminance, const HistogramRange& range)
+    {
+        if (!(luminance > 0)) return 0;
+        float t = (std::log2(luminance) - range.minLog2) * (float(kHistogramBinCount) / (range.maxLog2 - range.minLog2));
+        if (!(t > 0)) return 0;
+        return std::min((uint32_t)t, kHistogramBinCount - 1);
+    }
+
+    ReductionResult CpuReduction::reduce(ReductionType type, const float* pData, uint32_t width, uint32_t height, uint32_t channelCount, const HistogramRange& range, Mode mode)
+    {
+        assert(channelCount >= 1 && channelCount <= 4);
+        ReductionResult result;
+        if (width == 0 || height == 0) return result;
+
+        uint32_t rowsPerChunk = (mode == Mode::Parallel) ? std::max(1u, kTexelsPerChunk / width) : height;
+        uint32_t chunkCount = (height + rowsPerChunk - 1) / rowsPerChunk;
+        std::vector<Partial> partials(chunkCount);
+        if (type == ReductionType::Histogram)
+        {
+            for (auto& p : partials) p.histogram.assign(kHistogramBinCount, 0);
+        }
+
+        auto reduceChunk = [&](uint32_t begin, uint32_t end)
+        {
+            Partial& partial = partials[begin / rowsPerChunk];
+            if (mode == Mode::Scalar) reduceRowsScalar(type, pData, width, channelCount, begin, end, range, partial);
+            else                      reduceRowsSimd(type, pData, width, channelCount, begin, end, range, partial);
+        };
+
+        if (mode == Mode::Parallel) parallelFor(height, rowsPerChunk, reduceChunk);
+        else                        reduceChunk(0, height);
+
+        // Combine the chunks in order, so the result doesn't depend on the scheduling
+        Partial total;
+        total.histogram.assign(type == ReductionType::Histogram ? kHistogramBinCount : 0, 0);
+        for (const auto& p : partials)
+        {
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                total.a[c] += p.a[c];
+                total.b[c] += p.b[c];
+            }
+            total.minValue = std::min(total.minValue, p.minValue);
+            total.maxValue = std::max(total.maxValue, p.maxValue);
+            for (size_t i = 0; i < total.histogram.size(); i++) total.histogram[i] += p.histogram[i];
+        }
+
+        double count = double(width) * height;
+        switch (type)
+        {
+        case ReductionType::MinMax:
+            result.value = glm::vec4(total.minValue, total.maxValue, 0, 0);
+            break;
+        case ReductionType::Sum:
+            result.value = glm::vec4(total.a[0], total.a[1], total.a[2], total.a[3]);
+            break;
+        case ReductionType::Mean:
+            result.value = glm::vec4(total.a[0] / count, total.a[1] / count, total.a[2] / count, total.a[3] / count);
+            break;
+        case ReductionType::Variance:
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                double mean = total.a[c] / count;
+                result.mean[c] = float(mean);
+                result.value[c] = float(std::max(0.0, total.b[c] / count - mean * mean));
+            }
+            break;
+        case ReductionType::LogAverageLuminance:
+            result.value = glm::vec4(float(std::exp(total.a[0] / count)), 0, 0, 0);
+            break;
+        case ReductionType::Histogram:
+            result.histogram = std::move(total.histogram);
+            break;
+        default:
+            should_not_get_here();
+        }
+        result.valid = true;
+        return result;
+    }
+}
@@ -0,0 +1,94 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "glm/vec4.hpp"
+#include <vector>
+
+namespace Falcor
+{
+    /** The reductions supported by ParallelReduction (GPU) and CpuReduction. Both implementations follow the same definitions, so a CPU result can be used as
+        the reference for the GPU one, and either can feed the same consumer.
+        The input is treated as RGBA. Channels missing from the input read as 0, except alpha which reads as 1.
+    */
+    enum class ReductionType
+    {
+        MinMax,                 ///< Range of the red channel, skipping texels equal to 1 (cleared depth). Used for SDSM. Result is (min, max, 0, 0), or (1, 0, 0, 0) if every texel was skipped.
+        Sum,                    ///< Per-channel sum
+        Mean,                   ///< Per-channel mean
+        Variance,               ///< Per-channel population variance. The mean is returned as well.
+        LogAverageLuminance,    ///< exp(mean(log(kLuminanceEpsilon + L))) where L is the Rec.709 luminance of the RGB channels. Result is (average, 0, 0, 0).
+        Histogram,              ///< kHistogramBinCount bins of log2(L). See HistogramRange.
+    };
+
+    /** The log2 luminance range covered by the histogram. Values below the range, including black, go to the first bin. Values above the range go to the last bin.
+    */
+    struct HistogramRange
+    {
+        float minLog2 = -10.0f;
+        float maxLog2 = 6.0f;
+    };
+
+    struct ReductionResult
+    {
+        glm::vec4 value = glm::vec4(0);     ///< See ReductionType. Unused for Histogram.
+        glm::vec4 mean = glm::vec4(0);      ///< Variance only: the per-channel mean
+        std::vector<uint32_t> histogram;    ///< Histogram only: kHistogramBinCount bins
+        bool valid = false;                 ///< False until a result is available. The GPU implementation returns results after the readback latency.
+    };
+
+    static const uint32_t kHistogramBinCount = 256;
+    static const float kLuminanceEpsilon = 1e-4f;
+
+    /** CPU implementation of the reductions. Uses SSE and the worker threads.
+    */
+    class CpuReduction
+    {
+    public:
+        enum class Mode
+        {
+            Scalar,     ///< Single threaded reference
+            Simd,       ///< SSE, single threaded
+            Parallel,   ///< SSE, rows split between the worker threads
+        };
+
+        /** Reduce an image
+            \param[in] type The reduction to run
+            \param[in] pData The image data. Rows are tightly packed.
+            \param[in] width The width of the image
+            \param[in] height The height of the image
+            \param[in] channelCount The number of float channels per texel, 1 to 4
+            \param[in] range The histogram range. Ignored unless type is Histogram.
+            \param[in] mode The implementation to use
+        */
+        static ReductionResult reduce(ReductionType type, const float* pData, uint32_t width, uint32_t height, uint32_t channelCount, const HistogramRange& range = HistogramRange(), Mode mode = Mode::Parallel);
+
+        /** Get the histogram bin of a luminance value
+        */
+        static uint32_t getHistogramBin(float luminance, const HistogramRange& range);
+    };
+}
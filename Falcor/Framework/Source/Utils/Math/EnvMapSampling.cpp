@@ -0,0 +1,219 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "EnvMapSampling.h"
+#include "Utils/ParallelFor.h"
+#include <cmath>
+
+namespace Falcor
+{
+    namespace
+    {
+        const float kPi = 3.14159265358979323846f;
+        const float kOneMinusEpsilon = 0x1.fffffep-1f;
+
+        // Vose's alias method. Zero-weight sets become uniform.
+        void buildAliasTable(const std::vector<double>& weights, double total, std::vector<float>& prob, std::vector<uint32_t>& alias, std::vector<double>& scaled, std::vector<uint32_t>& small, std::vector<uint32_t>& large)
+        {
+            uint32_t n = (uint32_t)weights.size();
+            prob.assign(n, 1.0f);
+            alias.resize(n);
+            for (uint32_t i = 0; i < n; i++) alias[i] = i;
+            if (total <= 0) return;
+
+            scaled.resize(n);
+            small.clear();
+            large.clear();
+            for (uint32_t i = 0; i < n; i++)
+            {
+                scaled[i] = weights[i] * n / total;
+                (scaled[i] < 1.0 ? small : large).push_back(i);
+            }
+
+            while (small.size() && large.size())
+            {
+                uint32_t s = small.back();
+                small.pop_back();
+                uint32_t l = large.back();
+
+                prob[s] = (float)scaled[s];
+                alias[s] = l;
+                scaled[l] -= 1.0 - scaled[s];
+                if (scaled[l] < 1.0)
+                {
+                    large.pop_back();
+                    small.push_back(l);
+                }
+            }
+            // Whatever is left is 1 up to rounding errors, and keeps the default prob/alias
+        }
+
+        // Pick an index from an alias table entry and return a new uniform number in [0,1) for the position within the selected bucket
+        uint32_t selectAlias(uint32_t index, float f, float prob, float alias, float& jitter)
+        {
+            if (f < prob)
+            {
+                jitter = f / prob;
+                return index;
+            }
+            jitter = (f - prob) / (1.0f - prob);
+            return (uint32_t)alias;
+        }
+
+        bool isValidWeight(float w)
+        {
+            return std::isfinite(w) && w > 0;
+        }
+    }
+
+    std::vector<float> EnvMapSampler::computeLuminance(uint32_t width, uint32_t height, const float* pData, uint32_t channelCount)
+    {
+        std::vector<float> luminance(size_t(width) * height);
+        for (size_t i = 0; i < luminance.size(); i++)
+        {
+            const float* p = pData + i * channelCount;
+            luminance[i] = 0.2126f * p[0] + 0.7152f * p[1] + 0.0722f * p[2];
+        }
+        return luminance;
+    }
+
+    void EnvMapSampler::build(uint32_t width, uint32_t height, const float* pLuminance)
+    {
+        mWidth = width;
+        mHeight = height;
+        mConditional.resize(size_t(width) * height);
+        mMarginal.resize(height);
+
+        std::vector<double> rowWeights(height);
+
+        // Conditional tables, one row per iteration. The rows don't depend on each other.
+        // A row with no weight gets a uniform table, and is never picked by the marginal table unless the whole map is black.
+        parallelFor(height, 16, [&](uint32_t begin, uint32_t end)
+        {
+            std::vector<double> weights(width), scaled;
+            std::vector<float> prob;
+            std::vector<uint32_t> alias, small, large;
+
+            for (uint32_t row = begin; row < end; row++)
+            {
+                // Texels near the poles cover a smaller solid angle
+                double sinTheta = std::sin(kPi * (row + 0.5) / height);
+                double total = 0;
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    float l = pLuminance[size_t(row) * width + x];
+                    weights[x] = isValidWeight(l) ? l * sinTheta : 0.0;
+                    total += weights[x];
+                }
+                rowWeights[row] = total;
+
+                buildAliasTable(weights, total, prob, alias, scaled, small, large);
+                glm::vec4* pRow = &mConditional[size_t(row) * width];
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    // The density is filled once the total is known
+                    pRow[x] = glm::vec4(prob[x], (float)alias[x], (float)weights[x], 0);
+                }
+            }
+        });
+
+        double total = 0;
+        for (double w : rowWeights) total += w;
+
+        std::vector<double> scaled;
+        std::vector<float> prob;
+        std::vector<uint32_t> alias, small, large;
+        buildAliasTable(rowWeights, total, prob, alias, scaled, small, large);
+        for (uint32_t row = 0; row < height; row++)
+        {
+            mMarginal[row] = glm::vec2(prob[row], (float)alias[row]);
+        }
+
+        // Convert the texel weights to uv-space densities. A black map is sampled uniformly.
+        double scale = (total > 0) ? double(width) * height / total : 0.0;
+        parallelFor(height, 64, [&](uint32_t begin, uint32_t end)
+        {
+            for (size_t i = size_t(begin) * width; i < size_t(end) * width; i++)
+            {
+                mConditional[i].z = (total > 0) ? float(mConditional[i].z * scale) : 1.0f;
+            }
+        });
+    }
+
+    EnvMapSampler::Sample EnvMapSampler::sample(const glm::vec2& u) const
+    {
+        assert(mWidth && mHeight);
+        Sample s;
+
+        float y = u.y * mHeight;
+        uint32_t row = std::min((uint32_t)y, mHeight - 1);
+        float jitterY;
+        row = selectAlias(row, y - row, mMarginal[row].x, mMarginal[row].y, jitterY);
+
+        float x = u.x * mWidth;
+        uint32_t col = std::min((uint32_t)x, mWidth - 1);
+        const glm::vec4& entry = mConditional[size_t(row) * mWidth + col];
+        float jitterX;
+        col = selectAlias(col, x - col, entry.x, entry.y, jitterX);
+
+        s.uv.x = (col + std::min(jitterX, kOneMinusEpsilon)) / mWidth;
+        s.uv.y = (row + std::min(jitterY, kOneMinusEpsilon)) / mHeight;
+
+        // Rounding can push the sample into the neighboring texel. Use the density of the texel the sample ends up in, so it matches what evalPdf() returns for the same direction.
+        s.pdf = evalPdf(s.uv);
+        return s;
+    }
+
+    float EnvMapSampler::evalPdf(const glm::vec2& uv) const
+    {
+        uint32_t col = std::min((uint32_t)std::max(uv.x * mWidth, 0.0f), mWidth - 1);
+        uint32_t row = std::min((uint32_t)std::max(uv.y * mHeight, 0.0f), mHeight - 1);
+        return mConditional[size_t(row) * mWidth + col].z;
+    }
+
+    glm::vec3 EnvMapSampler::latLongToDirection(const glm::vec2& uv)
+    {
+        float theta = uv.y * kPi;
+        float phi = (2.0f * uv.x - 1.0f) * kPi;
+        float sinTheta = std::sin(theta);
+        return glm::vec3(sinTheta * std::sin(phi), std::cos(theta), -sinTheta * std::cos(phi));
+    }
+
+    glm::vec2 EnvMapSampler::directionToLatLong(const glm::vec3& dir)
+    {
+        float u = (1.0f + std::atan2(dir.x, -dir.z) / kPi) * 0.5f;
+        float v = std::acos(std::max(-1.0f, std::min(1.0f, dir.y))) / kPi;
+        return glm::vec2(u, v);
+    }
+
+    float EnvMapSampler::uvPdfToSolidAngle(float pdf, float v)
+    {
+        float sinTheta = std::sin(v * kPi);
+        return (sinTheta > 0) ? pdf / (2.0f * kPi * kPi * sinTheta) : 0.0f;
+    }
+}
@@ -0,0 +1,100 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "glm/vec2.hpp"
+#include "glm/vec3.hpp"
+#include "glm/vec4.hpp"
+#include <vector>
+
+namespace Falcor
+{
+    /** Importance sampling of a latitude-longitude environment map.
+        Texels are chosen proportionally to luminance * sin(theta), which is their share of the radiance arriving over the sphere. The distribution is
+        stored as a 2D alias table: a marginal table selects the row, then a per-row conditional table selects the column, so sampling is O(1) on both the CPU and
+        the GPU. Rows are built in parallel.
+        The mapping matches wsVectorToLatLong() in the shaders: u = (1 + atan2(x, -z) / pi) / 2, v = acos(y) / pi, and row 0 is the top (+Y) of the map.
+    */
+    class EnvMapSampler
+    {
+    public:
+        struct Sample
+        {
+            glm::vec2 uv;       ///< Lat-long coordinates of the sample
+            float pdf;          ///< Density with respect to the [0,1]^2 uv domain
+        };
+
+        /** Build the sampling tables.
+            \param[in] width The width of the map
+            \param[in] height The height of the map
+            \param[in] pLuminance Luminance of every texel, top row first. Negative and non-finite values are treated as 0.
+        */
+        void build(uint32_t width, uint32_t height, const float* pLuminance);
+
+        /** Compute the luminance of an RGB(A) float image, as expected by build()
+            \param[in] pData The image data, top row first
+            \param[in] channelCount 3 or 4
+        */
+        static std::vector<float> computeLuminance(uint32_t width, uint32_t height, const float* pData, uint32_t channelCount);
+
+        /** Draw a sample from two uniform random numbers in [0,1)
+        */
+        Sample sample(const glm::vec2& u) const;
+
+        /** Evaluate the uv-space density of a point
+        */
+        float evalPdf(const glm::vec2& uv) const;
+
+        /** Convert between a direction and lat-long coordinates
+        */
+        static glm::vec3 latLongToDirection(const glm::vec2& uv);
+        static glm::vec2 directionToLatLong(const glm::vec3& dir);
+
+        /** Convert a uv-space density to a solid angle density, for use in MIS with BSDF samples.
+            \param[in] pdf The uv-space density
+            \param[in] v The v coordinate of the sample
+        */
+        static float uvPdfToSolidAngle(float pdf, float v);
+
+        uint32_t getWidth() const { return mWidth; }
+        uint32_t getHeight() const { return mHeight; }
+
+        /** Per-texel table, top row first: x = probability of keeping the column, y = alias column, z = uv-space density of the texel.
+        */
+        const std::vector<glm::vec4>& getConditionalTable() const { return mConditional; }
+
+        /** Per-row table: x = probability of keeping the row, y = alias row.
+        */
+        const std::vector<glm::vec2>& getMarginalTable() const { return mMarginal; }
+
+    private:
+        uint32_t mWidth = 0;
+        uint32_t mHeight = 0;
+        std::vector<glm::vec4> mConditional;
+        std::vector<glm::vec2> mMarginal;
+    };
+}
@@ -0,0 +1,280 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "FrustumCulling.h"
+#include "Utils/ParallelFor.h"
+#include <limits>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define falcor_target_avx
+#else
+#include <immintrin.h>
+#include <cpuid.h>
+#define falcor_target_avx __attribute__((target("avx")))
+#endif
+
+namespace Falcor
+{
+    void BoundingBoxSoA::resize(uint32_t count)
+    {
+        uint32_t paddedCount = align_to(kPadding, count);
+
+        // Padding and new boxes have a NaN center. Every comparison fails, so they are never visible
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        mCenterX.resize(paddedCount, nan);
+        mCenterY.resize(paddedCount, nan);
+        mCenterZ.resize(paddedCount, nan);
+        mExtentX.resize(paddedCount, 0.0f);
+        mExtentY.resize(paddedCount, 0.0f);
+        mExtentZ.resize(paddedCount, 0.0f);
+
+        for (uint32_t i = count; i < std::min(mCount, paddedCount); i++)
+        {
+            mCenterX[i] = mCenterY[i] = mCenterZ[i] = nan;
+        }
+        mCount = count;
+    }
+
+    void BoundingBoxSoA::set(uint32_t index, const BoundingBox& box)
+    {
+        assert(index < mCount);
+        mCenterX[index] = box.center.x;
+        mCenterY[index] = box.center.y;
+        mCenterZ[index] = box.center.z;
+        mExtentX[index] = box.extent.x;
+        mExtentY[index] = box.extent.y;
+        mExtentZ[index] = box.extent.z;
+    }
+
+    BoundingBox BoundingBoxSoA::get(uint32_t index) const
+    {
+        assert(index < mCount);
+        BoundingBox box;
+        box.center = glm::vec3(mCenterX[index], mCenterY[index], mCenterZ[index]);
+        box.extent = glm::vec3(mExtentX[index], mExtentY[index], mExtentZ[index]);
+        return box;
+    }
+
+    namespace
+    {
+        // The plane data broadcast-ready: normal, absolute value of the normal and w
+        struct PlaneData
+        {
+            float n[3];
+            float absN[3];
+            float w;
+        };
+
+        void preparePlanes(const FrustumCulling::Planes& planes, PlaneData data[6])
+        {
+            for (uint32_t p = 0; p < 6; p++)
+            {
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    data[p].n[c] = planes[p][c];
+                    data[p].absN[c] = abs(planes[p][c]);
+                }
+                data[p].w = planes[p].w;
+            }
+        }
+
+        // Appends the indices of the set bits in mask, offset by base
+        inline void appendVisible(uint32_t mask, uint32_t base, std::vector<uint32_t>& visible)
+        {
+            while (mask)
+            {
+#ifdef _MSC_VER
+                unsigned long bit;
+                _BitScanForward(&bit, mask);
+#else
+                uint32_t bit = __builtin_ctz(mask);
+#endif
+                visible.push_back(base + bit);
+                mask &= mask - 1;
+            }
+        }
+
+        void cullScalar(const PlaneData planes[6], const BoundingBoxSoA& boxes, uint32_t begin, uint32_t end, std::vector<uint32_t>& visible)
+        {
+            const float* cx = boxes.getCenterX(); const float* cy = boxes.getCenterY(); const float* cz = boxes.getCenterZ();
+            const float* ex = boxes.getExtentX(); const float* ey = boxes.getExtentY(); const float* ez = boxes.getExtentZ();
+
+            for (uint32_t i = begin; i < end; i++)
+            {
+                bool isInside = true;
+                for (uint32_t p = 0; p < 6; p++)
+                {
+                    const PlaneData& pl = planes[p];
+                    float d = cx[i] * pl.n[0] + cy[i] * pl.n[1] + cz[i] * pl.n[2] + ex[i] * pl.absN[0] + ey[i] * pl.absN[1] + ez[i] * pl.absN[2] + pl.w;
+                    isInside = isInside && (d > 0);
+                }
+                if (isInside) visible.push_back(i);
+            }
+        }
+
+        // begin and end must be multiples of 4. Reading past the box count is fine because of the padding.
+        void cullSse(const PlaneData planes[6], const BoundingBoxSoA& boxes, uint32_t begin, uint32_t end, std::vector<uint32_t>& visible)
+        {
+            const float* cx = boxes.getCenterX(); const float* cy = boxes.getCenterY(); const float* cz = boxes.getCenterZ();
+            const float* ex = boxes.getExtentX(); const float* ey = boxes.getExtentY(); const float* ez = boxes.getExtentZ();
+            const __m128 zero = _mm_setzero_ps();
+
+            for (uint32_t i = begin; i < end; i += 4)
+            {
+                __m128 vcx = _mm_loadu_ps(cx + i), vcy = _mm_loadu_ps(cy + i), vcz = _mm_loadu_ps(cz + i);
+                __m128 vex = _mm_loadu_ps(ex + i), vey = _mm_loadu_ps(ey + i), vez = _mm_loadu_ps(ez + i);
+                __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+                for (uint32_t p = 0; p < 6; p++)
+                {
+                    const PlaneData& pl = planes[p];
+                    __m128 d = _mm_set1_ps(pl.w);
+                    d = _mm_add_ps(d, _mm_mul_ps(vcx, _mm_set1_ps(pl.n[0])));
+                    d = _mm_add_ps(d, _mm_mul_ps(vcy, _mm_set1_ps(pl.n[1])));
+                    d = _mm_add_ps(d, _mm_mul_ps(vcz, _mm_set1_ps(pl.n[2])));
+                    d = _mm_add_ps(d, _mm_mul_ps(vex, _mm_set1_ps(pl.absN[0])));
+                    d = _mm_add_ps(d, _mm_mul_ps(vey, _mm_set1_ps(pl.absN[1])));
+                    d = _mm_add_ps(d, _mm_mul_ps(vez, _mm_set1_ps(pl.absN[2])));
+                    inside = _mm_and_ps(inside, _mm_cmpgt_ps(d, zero));
+                }
+                appendVisible((uint32_t)_mm_movemask_ps(inside), i, visible);
+            }
+        }
+
+        // begin and end must be multiples of 8
+        falcor_target_avx void cullAvx(const PlaneData planes[6], const BoundingBoxSoA& boxes, uint32_t begin, uint32_t end, std::vector<uint32_t>& visible)
+        {
+            const float* cx = boxes.getCenterX(); const float* cy = boxes.getCenterY(); const float* cz = boxes.getCenterZ();
+            const float* ex = boxes.getExtentX(); const float* ey = boxes.getExtentY(); const float* ez = boxes.getExtentZ();
+            const __m256 zero = _mm256_setzero_ps();
+
+            // Broadcast the planes once
+            __m256 n[6][3], absN[6][3], w[6];
+            for (uint32_t p = 0; p < 6; p++)
+            {
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    n[p][c] = _mm256_set1_ps(planes[p].n[c]);
+                    absN[p][c] = _mm256_set1_ps(planes[p].absN[c]);
+                }
+                w[p] = _mm256_set1_ps(planes[p].w);
+            }
+
+            for (uint32_t i = begin; i < end; i += 8)
+            {
+                __m256 vcx = _mm256_loadu_ps(cx + i), vcy = _mm256_loadu_ps(cy + i), vcz = _mm256_loadu_ps(cz + i);
+                __m256 vex = _mm256_loadu_ps(ex + i), vey = _mm256_loadu_ps(ey + i), vez = _mm256_loadu_ps(ez + i);
+                __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+                for (uint32_t p = 0; p < 6; p++)
+                {
+                    __m256 d = w[p];
+                    d = _mm256_add_ps(d, _mm256_mul_ps(vcx, n[p][0]));
+                    d = _mm256_add_ps(d, _mm256_mul_ps(vcy, n[p][1]));
+                    d = _mm256_add_ps(d, _mm256_mul_ps(vcz, n[p][2]));
+                    d = _mm256_add_ps(d, _mm256_mul_ps(vex, absN[p][0]));
+                    d = _mm256_add_ps(d, _mm256_mul_ps(vey, absN[p][1]));
+                    d = _mm256_add_ps(d, _mm256_mul_ps(vez, absN[p][2]));
+                    inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, zero, _CMP_GT_OQ));
+                }
+                appendVisible((uint32_t)_mm256_movemask_ps(inside), i, visible);
+            }
+        }
+
+        bool checkAvxSupport()
+        {
+#ifdef _MSC_VER
+            int info[4];
+            __cpuid(info, 1);
+            bool osxsave = (info[2] & (1 << 27)) != 0;
+            bool avx = (info[2] & (1 << 28)) != 0;
+            // Make sure the OS saves the YMM registers
+            return osxsave && avx && ((_xgetbv(0) & 0x6) == 0x6);
+#else
+            return __builtin_cpu_supports("avx");
+#endif
+        }
+
+        void cullRange(const PlaneData planes[6], const BoundingBoxSoA& boxes, uint32_t begin, uint32_t end, std::vector<uint32_t>& visible)
+        {
+            // The SIMD paths may produce indices of padding boxes, but padding boxes are never visible
+            end = align_to(BoundingBoxSoA::kPadding, end);
+            if (FrustumCulling::isAvxSupported()) cullAvx(planes, boxes, begin, end, visible);
+            else cullSse(planes, boxes, begin, end, visible);
+        }
+    }
+
+    bool FrustumCulling::isAvxSupported()
+    {
+        static const bool sSupported = checkAvxSupport();
+        return sSupported;
+    }
+
+    void FrustumCulling::cull(const Planes& planes, const BoundingBoxSoA& boxes, std::vector<uint32_t>& visible, Mode mode)
+    {
+        visible.clear();
+        PlaneData planeData[6];
+        preparePlanes(planes, planeData);
+
+        uint32_t count = boxes.size();
+        if (mode == Mode::Scalar)
+        {
+            cullScalar(planeData, boxes, 0, count, visible);
+            return;
+        }
+
+        if (mode == Mode::Simd || count <= kChunkSize)
+        {
+            cullRange(planeData, boxes, 0, count, visible);
+            return;
+        }
+
+        // Each chunk writes into its own list. The lists are concatenated in order, so the result is sorted
+        uint32_t chunkCount = (count + kChunkSize - 1) / kChunkSize;
+        std::vector<std::vector<uint32_t>> chunkVisible(chunkCount);
+        parallelFor(chunkCount, 1, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t chunk = begin; chunk < end; chunk++)
+            {
+                chunkVisible[chunk].reserve(kChunkSize);
+                cullRange(planeData, boxes, chunk * kChunkSize, std::min(count, (chunk + 1) * kChunkSize), chunkVisible[chunk]);
+            }
+        });
+
+        size_t total = 0;
+        for (const auto& c : chunkVisible) total += c.size();
+        visible.resize(total);
+        size_t offset = 0;
+        for (const auto& c : chunkVisible)
+        {
+            if (c.size()) memcpy(visible.data() + offset, c.data(), c.size() * sizeof(uint32_t));
+            offset += c.size();
+        }
+    }
+}
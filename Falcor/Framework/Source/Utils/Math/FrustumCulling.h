@@ -0,0 +1,105 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "Utils/AABB.h"
+#include "glm/vec4.hpp"
+#include <array>
+#include <vector>
+
+namespace Falcor
+{
+    /** Structure-of-arrays storage for bounding boxes, laid out for SIMD processing.
+        The arrays are padded to a multiple of kPadding with boxes that always fail the frustum test.
+    */
+    class BoundingBoxSoA
+    {
+    public:
+        static const uint32_t kPadding = 8;
+
+        /** Resize the array. New boxes are empty and always culled until set() is called.
+        */
+        void resize(uint32_t count);
+
+        /** Get the number of boxes, not including the padding
+        */
+        uint32_t size() const { return mCount; }
+
+        /** Set a box
+        */
+        void set(uint32_t index, const BoundingBox& box);
+
+        /** Get a box
+        */
+        BoundingBox get(uint32_t index) const;
+
+        const float* getCenterX() const { return mCenterX.data(); }
+        const float* getCenterY() const { return mCenterY.data(); }
+        const float* getCenterZ() const { return mCenterZ.data(); }
+        const float* getExtentX() const { return mExtentX.data(); }
+        const float* getExtentY() const { return mExtentY.data(); }
+        const float* getExtentZ() const { return mExtentZ.data(); }
+
+    private:
+        uint32_t mCount = 0;
+        std::vector<float> mCenterX, mCenterY, mCenterZ;
+        std::vector<float> mExtentX, mExtentY, mExtentZ;
+    };
+
+    /** Tests bounding boxes against a frustum.
+        Planes are given as (n, w) such that a point p is on the inner side of the plane if dot(n, p) + w > 0. A box is visible if it's not entirely outside any of the planes.
+        This matches Camera::isObjectCulled().
+    */
+    class FrustumCulling
+    {
+    public:
+        using Planes = std::array<glm::vec4, 6>;
+
+        enum class Mode
+        {
+            Scalar,     ///< One box at a time. Used as a reference.
+            Simd,       ///< 8 boxes per iteration when AVX is available, 4 otherwise. Single threaded.
+            Parallel,   ///< SIMD, split into chunks processed on the worker threads
+        };
+
+        /** Cull boxes against a frustum
+            \param[in] planes The frustum planes
+            \param[in] boxes The boxes to test
+            \param[out] visible The indices of the visible boxes, in increasing order
+            \param[in] mode The implementation to use
+        */
+        static void cull(const Planes& planes, const BoundingBoxSoA& boxes, std::vector<uint32_t>& visible, Mode mode = Mode::Parallel);
+
+        /** Check if the AVX code path is used
+        */
+        static bool isAvxSupported();
+
+        /** The number of boxes processed by each thread in Parallel mode
+        */
+        static const uint32_t kChunkSize = 4096;
+    };
+}
@@ -34,29 +34,37 @@
 namespace Falcor
 {
     const char* fsFilename = "Framework/Shaders/ParallelReduction.ps.slang";
+    const char* csFilename = "Framework/Shaders/ParallelReduction.cs.slang";
+
+    // Must match GROUP_WIDTH in ParallelReduction.cs.slang
+    static const uint32_t kGroupWidth = 16;
 
     ParallelReduction::ParallelReduction(ParallelReduction::Type reductionType, uint32_t readbackLatency, uint32_t width, uint32_t height, uint32_t sampleCount) : mReductionType(reductionType)
     {
-        ResourceFormat texFormat;
+        mResultData.resize(readbackLatency + 1);
+        if (reductionType == Type::MinMax)
+        {
+            initMinMax(width, height, sampleCount);
+        }
+        else
+        {
+            if (sampleCount > 1) logError("ParallelReduction: only MinMax supports multisampled textures");
+            initCompute(width, height);
+        }
+    }
+
+    void ParallelReduction::initMinMax(uint32_t width, uint32_t height, uint32_t sampleCount)
+    {
+        ResourceFormat texFormat = ResourceFormat::RG32Float;
         Program::DefineList defines;
         defines.add("_SAMPLE_COUNT", std::to_string(sampleCount));
         defines.add("_TILE_SIZE", std::to_string(kTileSize));
-        switch(reductionType)
-        {
-        case Type::MinMax:
-           texFormat = ResourceFormat::RG32Float;
-           defines.add("_MIN_MAX_REDUCTION");
-           break;
-        default:
-            should_not_get_here();
-            return;
-        }
+        defines.add("_MIN_MAX_REDUCTION");
 
         Sampler::Desc samplerDesc;
         samplerDesc.setAddressingMode(Sampler::AddressMode::Clamp, Sampler::AddressMode::Clamp, Sampler::AddressMode::Clamp).setFilterMode(Sampler::Filter::Point, Sampler::Filter::Point, Sampler::Filter::Point).setLodParams(0, 0, 0);
         mpPointSampler = Sampler::create(samplerDesc);
 
-        mResultData.resize(readbackLatency + 1);
         for(auto& res : mResultData)
         {
             Fbo::Desc fboDesc;
@@ -86,6 +94,71 @@ namespace Falcor
         }
     }
 
+    void ParallelReduction::initCompute(uint32_t width, uint32_t height)
+    {
+        Program::DefineList defines;
+        switch (mReductionType)
+        {
+        case Type::Sum:
+        case Type::Mean:
+            defines.add("_REDUCE_SUM");
+            break;
+        case Type::Variance:
+            defines.add("_REDUCE_VARIANCE");
+            break;
+        case Type::LogAverageLuminance:
+            defines.add("_REDUCE_LOG_LUMINANCE");
+            break;
+        case Type::Histogram:
+            defines.add("_REDUCE_HISTOGRAM");
+            break;
+        default:
+            should_not_get_here();
+            return;
+        }
+        defines.add("_LUMINANCE_EPSILON", std::to_string(kLuminanceEpsilon));
+        defines.add("_HISTOGRAM_BIN_COUNT", std::to_string(kHistogramBinCount));
+
+        Program::Desc desc(csFilename);
+#ifdef FALCOR_D3D12
+        // Wave intrinsics require shader model 6.0
+        desc.setShaderModel("6_0");
+        defines.add("_USE_WAVE_INTRINSICS");
+#endif
+
+        auto createPass = [&](ComputePass& pass, const std::string& entryPoint)
+        {
+            Program::Desc passDesc = desc;
+            passDesc.csEntry(entryPoint);
+            pass.pProgram = ComputeProgram::create(passDesc, defines);
+            pass.pVars = ComputeVars::create(pass.pProgram->getReflector());
+            pass.pState = ComputeState::create();
+            pass.pState->setProgram(pass.pProgram);
+        };
+        createPass(mTilesPass, "reduceTiles");
+
+        mGroupCount = uvec2((width + kGroupWidth - 1) / kGroupWidth, (height + kGroupWidth - 1) / kGroupWidth);
+        if (mReductionType != Type::Histogram)
+        {
+            // The histogram is accumulated straight into the result texture with atomics. The other reductions write 2 partial results per group, which
+            // a second pass combines.
+            createPass(mFinalPass, "reduceFinal");
+            mpPartials = StructuredBuffer::create(mTilesPass.pProgram, "gPartials", mGroupCount.x * mGroupCount.y * 2);
+        }
+
+        for (auto& res : mResultData)
+        {
+            if (mReductionType == Type::Histogram)
+            {
+                res.pResultTex = Texture::create2D(kHistogramBinCount, 1, ResourceFormat::R32Uint, 1, 1, nullptr, Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource);
+            }
+            else
+            {
+                res.pResultTex = Texture::create2D(2, 1, ResourceFormat::RGBA32Float, 1, 1, nullptr, Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource);
+            }
+        }
+    }
+
     ParallelReduction::UniquePtr ParallelReduction::create(Type reductionType, uint32_t readbackLatency, uint32_t width, uint32_t height, uint32_t sampleCount)
     {
         return ParallelReduction::UniquePtr(new ParallelReduction(reductionType, readbackLatency, width, height, sampleCount));
@@ -112,34 +185,110 @@ namespace Falcor
 
     glm::vec4 ParallelReduction::reduce(RenderContext* pRenderCtx, Texture::SharedPtr pInput)
     {
-        const FullScreenPass* pProgram = mpFirstIterProg.get();
-
-        for(size_t i = 0; i < mpTmpResultFbo.size(); i++)
-        {
-            runProgram(pRenderCtx, pInput, pProgram, mpTmpResultFbo[i], mpVars, mpPointSampler);
-            pProgram = mpRestIterProg.get();
-            pInput = mpTmpResultFbo[i]->getColorTexture(0);
-        }
+        if (mReductionType == Type::MinMax) reduceMinMax(pRenderCtx, pInput);
+        else                                reduceCompute(pRenderCtx, pInput);
 
-        runProgram(pRenderCtx, pInput, pProgram, mResultData[mCurFbo].pFbo, mpVars, mpPointSampler);
-        mResultData[mCurFbo].pReadTask = pRenderCtx->asyncReadTextureSubresource(mResultData[mCurFbo].pFbo->getColorTexture(0).get(), 0);
-        // Read back the results
+        // Read back the oldest result in flight
         mCurFbo = (mCurFbo + 1) % mResultData.size();
-        glm::vec4 result(0);
         if(mResultData[mCurFbo].pReadTask)
         {
             auto texData = mResultData[mCurFbo].pReadTask->getData();
             mResultData[mCurFbo].pReadTask = nullptr;
 
+            const vec4* pValues = reinterpret_cast<const vec4*>(texData.data());
             switch (mReductionType)
             {
             case Type::MinMax:
-                result = vec4(*reinterpret_cast<vec2*>(texData.data()), 0, 0);
+                mResult.value = vec4(*reinterpret_cast<vec2*>(texData.data()), 0, 0);
+                break;
+            case Type::Sum:
+            case Type::Mean:
+            case Type::LogAverageLuminance:
+                mResult.value = pValues[0];
+                break;
+            case Type::Variance:
+                mResult.value = pValues[0];
+                mResult.mean = pValues[1];
+                break;
+            case Type::Histogram:
+                mResult.histogram.resize(kHistogramBinCount);
+                std::memcpy(mResult.histogram.data(), texData.data(), kHistogramBinCount * sizeof(uint32_t));
                 break;
             default:
                 should_not_get_here();
             }
+            mResult.valid = true;
+        }
+        return mResult.value;
+    }
+
+    void ParallelReduction::reduceCompute(RenderContext* pRenderCtx, Texture::SharedPtr pInput)
+    {
+        Texture::SharedPtr pResultTex = mResultData[mCurFbo].pResultTex;
+        uvec2 dims(pInput->getWidth(), pInput->getHeight());
+        uvec2 groupCount((dims.x + kGroupWidth - 1) / kGroupWidth, (dims.y + kGroupWidth - 1) / kGroupWidth);
+        if (groupCount.x * groupCount.y > mGroupCount.x * mGroupCount.y)
+        {
+            logError("ParallelReduction: the input texture is larger than the size the object was created with");
+            return;
+        }
+
+        float histogramScale = float(kHistogramBinCount) / (mHistogramRange.maxLog2 - mHistogramRange.minLog2);
+        for (ComputePass* pPass : { &mTilesPass, &mFinalPass })
+        {
+            if (pPass->pVars == nullptr) continue;
+            auto pCB = pPass->pVars["PerPassCB"];
+            pCB["gDims"] = dims;
+            pCB["gPartialCount"] = groupCount.x * groupCount.y;
+            pCB["gHistogramMin"] = mHistogramRange.minLog2;
+            pCB["gHistogramScale"] = histogramScale;
+            pCB["gMean"] = (uint32_t)(mReductionType == Type::Mean);
+        }
+
+        // First pass, one group per tile
+        if (mReductionType == Type::Histogram)
+        {
+            pRenderCtx->clearUAV(pResultTex->getUAV().get(), uvec4(0));
+            mTilesPass.pVars->setTexture("gHistogram", pResultTex);
         }
-        return result;
+        else
+        {
+            mTilesPass.pVars->setStructuredBuffer("gPartials", mpPartials);
+        }
+        mTilesPass.pVars->setTexture("gInput", pInput);
+        pRenderCtx->pushComputeState(mTilesPass.pState);
+        pRenderCtx->pushComputeVars(mTilesPass.pVars);
+        pRenderCtx->dispatch(groupCount.x, groupCount.y, 1);
+        pRenderCtx->popComputeVars();
+        pRenderCtx->popComputeState();
+
+        // Second pass, a single group combines the partial results and normalizes them
+        if (mReductionType != Type::Histogram)
+        {
+            mFinalPass.pVars->setStructuredBuffer("gPartials", mpPartials);
+            mFinalPass.pVars->setTexture("gResult", pResultTex);
+            pRenderCtx->pushComputeState(mFinalPass.pState);
+            pRenderCtx->pushComputeVars(mFinalPass.pVars);
+            pRenderCtx->dispatch(1, 1, 1);
+            pRenderCtx->popComputeVars();
+            pRenderCtx->popComputeState();
+        }
+
+        mResultData[mCurFbo].pReadTask = pRenderCtx->asyncReadTextureSubresource(pResultTex.get(), 0);
+    }
+
+    void ParallelReduction::reduceMinMax(RenderContext* pRenderCtx, Texture::SharedPtr pInput)
+    {
+        const FullScreenPass* pProgram = mpFirstIterProg.get();
+
+        for(size_t i = 0; i < mpTmpResultFbo.size(); i++)
+        {
+            runProgram(pRenderCtx, pInput, pProgram, mpTmpResultFbo[i], mpVars, mpPointSampler);
+            pProgram = mpRestIterProg.get();
+            pInput = mpTmpResultFbo[i]->getColorTexture(0);
+        }
+
+        runProgram(pRenderCtx, pInput, pProgram, mResultData[mCurFbo].pFbo, mpVars, mpPointSampler);
+        mResultData[mCurFbo].pReadTask = pRenderCtx->asyncReadTextureSubresource(mResultData[mCurFbo].pFbo->getColorTexture(0).get(), 0);
     }
 }
\ No newline at end of file
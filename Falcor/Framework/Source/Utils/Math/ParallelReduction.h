@@ -29,44 +29,92 @@
 #include "Framework.h"
 #include "Graphics/FullScreenPass.h"
 #include "Graphics/Program/ProgramVars.h"
+#include "Graphics/ComputeState.h"
 #include "API/FBO.h"
 #include "API/Sampler.h"
 #include "API/CopyContext.h"
+#include "Utils/Math/CpuReduction.h"
 
 namespace Falcor
 {
     class RenderContext;
     class Texture;
 
+    /** Reduces a texture to a few values on the GPU and reads the result back to the CPU.
+        The readback is asynchronous: reduce() returns the result computed readbackLatency calls earlier, so the CPU never waits on the GPU unless the latency is 0.
+        MinMax uses a gather-based pixel shader and supports multisampled textures. The other reductions run in compute shaders, using wave intrinsics
+        when the shader model supports them. See ReductionType for the definitions, which CpuReduction follows as well.
+    */
     class ParallelReduction
     {
     public:
         using UniquePtr = std::unique_ptr<ParallelReduction>;
-        enum class Type
-        {
-            MinMax
-        };
+        using Type = ReductionType;
+        using Result = ReductionResult;
+
+        /** Create a new object
+            \param[in] reductionType The reduction to run
+            \param[in] readbackLatency The number of reduce() calls between issuing a reduction and reading its result back
+            \param[in] width The width of the textures which will be reduced
+            \param[in] height The height of the textures which will be reduced
+            \param[in] sampleCount The sample count of the textures. Only MinMax supports multisampled textures.
+        */
         static UniquePtr create(Type reductionType, uint32_t readbackLatency, uint32_t width, uint32_t height, uint32_t sampleCount = 1);
+
+        /** Run the reduction and read back the oldest result in flight
+            \return The value of the result. See getResult() for the other fields.
+        */
         glm::vec4 reduce(RenderContext* pRenderCtx, Texture::SharedPtr pInput);
 
+        /** Get the last result read back by reduce()
+        */
+        const Result& getResult() const { return mResult; }
+
+        /** Set the range of the luminance histogram. Takes effect on the next reduce() call.
+        */
+        void setHistogramRange(const HistogramRange& range) { mHistogramRange = range; }
+        const HistogramRange& getHistogramRange() const { return mHistogramRange; }
+
+        uint32_t getReadbackLatency() const { return uint32_t(mResultData.size()) - 1; }
+
     private:
         ParallelReduction(Type reductionType, uint32_t readbackLatency, uint32_t width, uint32_t height, uint32_t sampleCount);
+        void initMinMax(uint32_t width, uint32_t height, uint32_t sampleCount);
+        void initCompute(uint32_t width, uint32_t height);
+        void reduceMinMax(RenderContext* pRenderCtx, Texture::SharedPtr pInput);
+        void reduceCompute(RenderContext* pRenderCtx, Texture::SharedPtr pInput);
+
         FullScreenPass::UniquePtr mpFirstIterProg;
         FullScreenPass::UniquePtr mpRestIterProg;
         GraphicsVars::SharedPtr mpVars;
 
+        // Compute path
+        struct ComputePass
+        {
+            ComputeProgram::SharedPtr pProgram;
+            ComputeVars::SharedPtr pVars;
+            ComputeState::SharedPtr pState;
+        };
+        ComputePass mTilesPass;
+        ComputePass mFinalPass;
+        StructuredBuffer::SharedPtr mpPartials;
+        uvec2 mGroupCount;
+
         struct ResultData
         {
             CopyContext::ReadTextureTask::SharedPtr pReadTask;
-            Fbo::SharedPtr pFbo;
+            Fbo::SharedPtr pFbo;                // MinMax
+            Texture::SharedPtr pResultTex;      // Compute path. 2x1 RGBA32Float, or kHistogramBinCount x 1 R32Uint for the histogram.
         };
         std::vector<ResultData> mResultData;
 
         uint32_t mCurFbo = 0;
         Type mReductionType;
         Sampler::SharedPtr mpPointSampler;
+        HistogramRange mHistogramRange;
+        Result mResult;
 
         std::vector<Fbo::SharedPtr> mpTmpResultFbo;
         static const uint32_t kTileSize = 16;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,165 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "ParallelFor.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+
+namespace Falcor
+{
+    namespace
+    {
+        struct Job
+        {
+            const std::function<void(uint32_t, uint32_t)>* pFunc = nullptr;
+            uint32_t count = 0;
+            uint32_t grainSize = 0;
+            uint32_t chunkCount = 0;
+            std::atomic<uint32_t> nextChunk{ 0 };
+            std::atomic<uint32_t> workerCount{ 0 };    // Number of worker threads holding a reference to the job
+
+            // Returns false when there are no chunks left to start
+            bool runChunk()
+            {
+                uint32_t chunk = nextChunk.fetch_add(1);
+                if (chunk >= chunkCount) return false;
+                uint32_t begin = chunk * grainSize;
+                uint32_t end = std::min(begin + grainSize, count);
+                (*pFunc)(begin, end);
+                return true;
+            }
+        };
+
+        class WorkerPool
+        {
+        public:
+            WorkerPool()
+            {
+                uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+                for (uint32_t i = 0; i < threadCount; i++)
+                {
+                    mThreads.emplace_back(&WorkerPool::workerLoop, this);
+                }
+            }
+
+            ~WorkerPool()
+            {
+                {
+                    std::lock_guard<std::mutex> l(mMutex);
+                    mTerminate = true;
+                }
+                mCondition.notify_all();
+                for (auto& t : mThreads) t.join();
+            }
+
+            uint32_t getThreadCount() const { return (uint32_t)mThreads.size() + 1; }
+
+            void run(Job& job)
+            {
+                {
+                    std::lock_guard<std::mutex> l(mMutex);
+                    mJobs.push_back(&job);
+                }
+                mCondition.notify_all();
+
+                // Participate, then wait for the workers to finish the chunks they started.
+                // Once the job is out of the queue no new worker can pick it up.
+                while (job.runChunk()) {}
+                {
+                    std::lock_guard<std::mutex> l(mMutex);
+                    auto it = std::find(mJobs.begin(), mJobs.end(), &job);
+                    if (it != mJobs.end()) mJobs.erase(it);
+                }
+                while (job.workerCount.load() != 0) std::this_thread::yield();
+            }
+
+        private:
+            void workerLoop()
+            {
+                while (true)
+                {
+                    Job* pJob = nullptr;
+                    {
+                        std::unique_lock<std::mutex> l(mMutex);
+                        mCondition.wait(l, [this] { return mTerminate || mJobs.size(); });
+                        if (mTerminate) return;
+                        pJob = mJobs.front();
+                        if (pJob->nextChunk.load() >= pJob->chunkCount)
+                        {
+                            // All the chunks were started. The owner will wait for the running ones
+                            mJobs.pop_front();
+                            continue;
+                        }
+                        pJob->workerCount.fetch_add(1);
+                    }
+
+                    while (pJob->runChunk()) {}
+                    pJob->workerCount.fetch_sub(1);
+                }
+            }
+
+            std::vector<std::thread> mThreads;
+            std::deque<Job*> mJobs;
+            std::mutex mMutex;
+            std::condition_variable mCondition;
+            bool mTerminate = false;
+        };
+
+        WorkerPool& getWorkerPool()
+        {
+            static WorkerPool sPool;
+            return sPool;
+        }
+    }
+
+    void parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& func)
+    {
+        if (count == 0) return;
+        grainSize = std::max(grainSize, 1u);
+        if (count <= grainSize)
+        {
+            func(0, count);
+            return;
+        }
+
+        Job job;
+        job.pFunc = &func;
+        job.count = count;
+        job.grainSize = grainSize;
+        job.chunkCount = (count + grainSize - 1) / grainSize;
+        getWorkerPool().run(job);
+    }
+
+    uint32_t getParallelForThreadCount()
+    {
+        return getWorkerPool().getThreadCount();
+    }
+}
@@ -0,0 +1,377 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "PerformanceBaseline.h"
+#include "Utils/Platform/OS.h"
+#include "rapidjson/document.h"
+#include "rapidjson/error/en.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/prettywriter.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        const char* kVersionKey = "version";
+        const char* kDescriptionKey = "description";
+        const char* kFramesKey = "frames";
+        const char* kEventsKey = "events";
+        const char* kCpuKey = "cpu";
+        const char* kGpuKey = "gpu";
+
+        std::string writeJson(const rapidjson::Document& jdoc)
+        {
+            rapidjson::StringBuffer buffer;
+            rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+            writer.SetIndent(' ', 4);
+            jdoc.Accept(writer);
+            return std::string(buffer.GetString(), buffer.GetSize());
+        }
+
+        void addString(rapidjson::Value& jval, rapidjson::Document::AllocatorType& jallocator, const std::string& key, const std::string& value)
+        {
+            rapidjson::Value jkey, jstring;
+            jkey.SetString(key.c_str(), (uint32_t)key.size(), jallocator);
+            jstring.SetString(value.c_str(), (uint32_t)value.size(), jallocator);
+            jval.AddMember(jkey, jstring, jallocator);
+        }
+
+        void addArray(rapidjson::Value& jval, rapidjson::Document::AllocatorType& jallocator, const char* key, const std::vector<float>& samples)
+        {
+            rapidjson::Value jarray(rapidjson::kArrayType);
+            for (float s : samples) jarray.PushBack(s, jallocator);
+            jval.AddMember(rapidjson::StringRef(key), jarray, jallocator);
+        }
+
+        bool fromJsonArray(const rapidjson::Value& jval, const char* key, std::vector<float>& samples)
+        {
+            auto it = jval.FindMember(key);
+            if (it == jval.MemberEnd()) return true;
+            if (it->value.IsArray() == false) return false;
+            for (rapidjson::SizeType i = 0; i < it->value.Size(); i++)
+            {
+                if (it->value[i].IsNumber() == false) return false;
+                samples.push_back(it->value[i].GetFloat());
+            }
+            return true;
+        }
+    }
+
+    void PerformanceBaseline::addSample(const std::string& event, float cpuMs, float gpuMs)
+    {
+        Event& e = mEvents[event];
+        e.cpuMs.push_back(cpuMs);
+        e.gpuMs.push_back(gpuMs);
+    }
+
+    std::string PerformanceBaseline::toJson() const
+    {
+        rapidjson::Document jdoc;
+        jdoc.SetObject();
+        auto& jallocator = jdoc.GetAllocator();
+
+        jdoc.AddMember(rapidjson::StringRef(kVersionKey), kVersion, jallocator);
+        addString(jdoc, jallocator, kDescriptionKey, mDescription);
+        jdoc.AddMember(rapidjson::StringRef(kFramesKey), mFrameCount, jallocator);
+
+        rapidjson::Value jevents(rapidjson::kObjectType);
+        for (const auto& e : mEvents)
+        {
+            rapidjson::Value jevent(rapidjson::kObjectType);
+            addArray(jevent, jallocator, kCpuKey, e.second.cpuMs);
+            addArray(jevent, jallocator, kGpuKey, e.second.gpuMs);
+
+            rapidjson::Value jkey;
+            jkey.SetString(e.first.c_str(), (uint32_t)e.first.size(), jallocator);
+            jevents.AddMember(jkey, jevent, jallocator);
+        }
+        jdoc.AddMember(rapidjson::StringRef(kEventsKey), jevents, jallocator);
+        return writeJson(jdoc);
+    }
+
+    bool PerformanceBaseline::fromJson(const std::string& json, PerformanceBaseline& baseline, std::string& error)
+    {
+        rapidjson::Document jdoc;
+        jdoc.Parse(json.c_str());
+        if (jdoc.HasParseError())
+        {
+            size_t line = std::count(json.begin(), json.begin() + jdoc.GetErrorOffset(), '\n');
+            error = "JSON parse error in line " + std::to_string(line) + ". " + rapidjson::GetParseError_En(jdoc.GetParseError());
+            return false;
+        }
+        if (jdoc.IsObject() == false)
+        {
+            error = "The baseline is not a JSON object";
+            return false;
+        }
+
+        auto version = jdoc.FindMember(kVersionKey);
+        if (version == jdoc.MemberEnd() || version->value.IsUint() == false)
+        {
+            error = "The baseline has no version";
+            return false;
+        }
+        if (version->value.GetUint() > kVersion)
+        {
+            error = "The baseline version " + std::to_string(version->value.GetUint()) + " is newer than the supported version " + std::to_string(kVersion);
+            return false;
+        }
+
+        PerformanceBaseline result;
+        auto description = jdoc.FindMember(kDescriptionKey);
+        if (description != jdoc.MemberEnd() && description->value.IsString()) result.mDescription = description->value.GetString();
+        auto frames = jdoc.FindMember(kFramesKey);
+        if (frames != jdoc.MemberEnd() && frames->value.IsUint()) result.mFrameCount = frames->value.GetUint();
+
+        auto events = jdoc.FindMember(kEventsKey);
+        if (events == jdoc.MemberEnd() || events->value.IsObject() == false)
+        {
+            error = "The baseline has no events";
+            return false;
+        }
+        for (auto it = events->value.MemberBegin(); it != events->value.MemberEnd(); it++)
+        {
+            Event& e = result.mEvents[it->name.GetString()];
+            if (it->value.IsObject() == false || !fromJsonArray(it->value, kCpuKey, e.cpuMs) || !fromJsonArray(it->value, kGpuKey, e.gpuMs))
+            {
+                error = std::string("Malformed samples for event '") + it->name.GetString() + "'";
+                return false;
+            }
+        }
+
+        baseline = std::move(result);
+        return true;
+    }
+
+    bool PerformanceBaseline::save(const std::string& filename) const
+    {
+        std::ofstream outputStream(filename.c_str());
+        if (outputStream.fail())
+        {
+            logError("Cannot write to " + filename + ".\n");
+            return false;
+        }
+        outputStream << toJson();
+        return true;
+    }
+
+    bool PerformanceBaseline::load(const std::string& filename, PerformanceBaseline& baseline)
+    {
+        if (doesFileExist(filename) == false)
+        {
+            logWarning("Can't find performance baseline " + filename);
+            return false;
+        }
+
+        std::string error;
+        if (fromJson(readFile(filename), baseline, error) == false)
+        {
+            logWarning("Error when loading performance baseline " + filename + ". " + error);
+            return false;
+        }
+        return true;
+    }
+
+    float PerformanceBaseline::median(std::vector<float> samples)
+    {
+        if (samples.empty()) return 0;
+        size_t mid = samples.size() / 2;
+        std::nth_element(samples.begin(), samples.begin() + mid, samples.end());
+        float m = samples[mid];
+        if ((samples.size() & 1) == 0)
+        {
+            m = (m + *std::max_element(samples.begin(), samples.begin() + mid)) * 0.5f;
+        }
+        return m;
+    }
+
+    float PerformanceBaseline::rankSumPValue(const std::vector<float>& a, const std::vector<float>& b)
+    {
+        struct Sample
+        {
+            float value;
+            bool fromB;
+        };
+
+        std::vector<Sample> samples;
+        samples.reserve(a.size() + b.size());
+        for (float v : a) samples.push_back({ v, false });
+        for (float v : b) samples.push_back({ v, true });
+        std::sort(samples.begin(), samples.end(), [](const Sample& l, const Sample& r) { return l.value < r.value; });
+
+        // Sum the ranks of b, giving tied values their average rank
+        double n = double(samples.size());
+        double rankSumB = 0;
+        double tieTerm = 0;
+        for (size_t i = 0; i < samples.size();)
+        {
+            size_t j = i;
+            while (j < samples.size() && samples[j].value == samples[i].value) j++;
+            double t = double(j - i);
+            double rank = (double(i + 1) + double(j)) * 0.5;
+            for (size_t k = i; k < j; k++)
+            {
+                if (samples[k].fromB) rankSumB += rank;
+            }
+            tieTerm += t * t * t - t;
+            i = j;
+        }
+
+        double na = double(a.size());
+        double nb = double(b.size());
+        if (na == 0 || nb == 0) return 1;
+
+        double u = rankSumB - nb * (nb + 1) * 0.5;
+        double mean = na * nb * 0.5;
+        double variance = na * nb / 12.0 * ((n + 1) - tieTerm / (n * (n - 1)));
+        if (variance <= 0) return 1;
+
+        // Normal approximation with continuity correction
+        double z = (u - mean - 0.5) / std::sqrt(variance);
+        return float(0.5 * std::erfc(z / std::sqrt(2.0)));
+    }
+
+    PerformanceBaseline::Comparison PerformanceBaseline::compare(const PerformanceBaseline& baseline, const PerformanceBaseline& current, const CompareOptions& options)
+    {
+        Comparison comparison;
+        comparison.options = options;
+
+        auto compareMetric = [&](const std::string& name, bool gpu, const std::vector<float>& base, const std::vector<float>& curr)
+        {
+            MetricComparison m;
+            m.event = name;
+            m.gpu = gpu;
+            m.baselineMedian = median(base);
+            m.currentMedian = median(curr);
+            if (m.baselineMedian < options.minTimeMs && m.currentMedian < options.minTimeMs)
+            {
+                m.verdict = Verdict::Unchanged;
+            }
+            else if (base.size() < options.minSamples || curr.size() < options.minSamples)
+            {
+                m.verdict = Verdict::InsufficientData;
+            }
+            else
+            {
+                m.change = (m.currentMedian - m.baselineMedian) / std::max(m.baselineMedian, options.minTimeMs);
+                if (m.change >= 0)
+                {
+                    m.pValue = rankSumPValue(base, curr);
+                    if (m.change > options.threshold && m.pValue < options.significance) m.verdict = Verdict::Regression;
+                }
+                else
+                {
+                    m.pValue = rankSumPValue(curr, base);
+                    if (-m.change > options.threshold && m.pValue < options.significance) m.verdict = Verdict::Improvement;
+                }
+            }
+            comparison.regressed = comparison.regressed || (m.verdict == Verdict::Regression);
+            comparison.metrics.push_back(m);
+        };
+
+        auto addUnmatched = [&](const std::string& name, const Event& e, Verdict verdict)
+        {
+            for (bool gpu : { false, true })
+            {
+                MetricComparison m;
+                m.event = name;
+                m.gpu = gpu;
+                float med = median(gpu ? e.gpuMs : e.cpuMs);
+                (verdict == Verdict::Missing ? m.baselineMedian : m.currentMedian) = med;
+                m.verdict = verdict;
+                comparison.metrics.push_back(m);
+            }
+        };
+
+        for (const auto& b : baseline.mEvents)
+        {
+            auto c = current.mEvents.find(b.first);
+            if (c == current.mEvents.end())
+            {
+                addUnmatched(b.first, b.second, Verdict::Missing);
+                continue;
+            }
+            compareMetric(b.first, false, b.second.cpuMs, c->second.cpuMs);
+            compareMetric(b.first, true, b.second.gpuMs, c->second.gpuMs);
+        }
+
+        for (const auto& c : current.mEvents)
+        {
+            if (baseline.mEvents.count(c.first) == 0) addUnmatched(c.first, c.second, Verdict::New);
+        }
+        return comparison;
+    }
+
+    std::string PerformanceBaseline::Comparison::toJson() const
+    {
+        rapidjson::Document jdoc;
+        jdoc.SetObject();
+        auto& jallocator = jdoc.GetAllocator();
+
+        jdoc.AddMember(rapidjson::StringRef(kVersionKey), kVersion, jallocator);
+        addString(jdoc, jallocator, "verdict", regressed ? "regression" : "pass");
+        jdoc.AddMember("threshold", options.threshold, jallocator);
+        jdoc.AddMember("significance", options.significance, jallocator);
+        jdoc.AddMember("min_samples", options.minSamples, jallocator);
+
+        rapidjson::Value jmetrics(rapidjson::kArrayType);
+        for (const MetricComparison& m : metrics)
+        {
+            rapidjson::Value jmetric(rapidjson::kObjectType);
+            addString(jmetric, jallocator, "event", m.event);
+            addString(jmetric, jallocator, "metric", m.gpu ? kGpuKey : kCpuKey);
+            jmetric.AddMember("baseline_median", m.baselineMedian, jallocator);
+            jmetric.AddMember("current_median", m.currentMedian, jallocator);
+            jmetric.AddMember("change", m.change, jallocator);
+            jmetric.AddMember("p_value", m.pValue, jallocator);
+            addString(jmetric, jallocator, "verdict", to_string(m.verdict));
+            jmetrics.PushBack(jmetric, jallocator);
+        }
+        jdoc.AddMember("metrics", jmetrics, jallocator);
+        return writeJson(jdoc);
+    }
+
+    const std::string to_string(PerformanceBaseline::Verdict verdict)
+    {
+        switch (verdict)
+        {
+        case PerformanceBaseline::Verdict::Unchanged: return "unchanged";
+        case PerformanceBaseline::Verdict::Regression: return "regression";
+        case PerformanceBaseline::Verdict::Improvement: return "improvement";
+        case PerformanceBaseline::Verdict::InsufficientData: return "insufficient_data";
+        case PerformanceBaseline::Verdict::Missing: return "missing";
+        case PerformanceBaseline::Verdict::New: return "new";
+        default:
+            should_not_get_here();
+            return "";
+        }
+    }
+}
@@ -0,0 +1,147 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** Per-event CPU and GPU timing distributions recorded over a number of frames, stored as versioned JSON.
+        SampleTest records one in benchmark mode and compares it against a baseline recorded earlier. The comparison is CPU only, so recorded results can be compared offline.
+    */
+    class PerformanceBaseline
+    {
+    public:
+        static const uint32_t kVersion = 1;
+
+        /** The samples of an event, one per frame, in milliseconds
+        */
+        struct Event
+        {
+            std::vector<float> cpuMs;
+            std::vector<float> gpuMs;
+        };
+
+        /** Add an event's times for a frame
+        */
+        void addSample(const std::string& event, float cpuMs, float gpuMs);
+
+        /** Count a recorded frame
+        */
+        void endFrame() { mFrameCount++; }
+
+        const std::map<std::string, Event>& getEvents() const { return mEvents; }
+        uint32_t getFrameCount() const { return mFrameCount; }
+
+        /** A description of the run, e.g., the sample and the GPU. Stored in the JSON, not used by the comparison.
+        */
+        void setDescription(const std::string& description) { mDescription = description; }
+        const std::string& getDescription() const { return mDescription; }
+
+        /** Serialize to JSON
+        */
+        std::string toJson() const;
+
+        /** Parse JSON written by toJson(). Fails on malformed input and on newer versions.
+            \param[in] json The JSON string
+            \param[out] baseline The parsed baseline
+            \param[out] error The reason for a failure
+            \return Whether parsing succeeded
+        */
+        static bool fromJson(const std::string& json, PerformanceBaseline& baseline, std::string& error);
+
+        /** Save to a JSON file
+        */
+        bool save(const std::string& filename) const;
+
+        /** Load from a JSON file. Logs a warning and returns false on failure.
+        */
+        static bool load(const std::string& filename, PerformanceBaseline& baseline);
+
+        struct CompareOptions
+        {
+            float threshold = 0.05f;        ///< Relative change of the median that counts as a regression or an improvement
+            float significance = 0.01f;     ///< Significance level of the rank-sum test. Both the test and the threshold must pass for a verdict other than Unchanged.
+            uint32_t minSamples = 10;       ///< Metrics with fewer samples in either run are reported as InsufficientData
+            float minTimeMs = 0.01f;        ///< Metrics with both medians under this are ignored (reported as Unchanged), since timer resolution dominates
+        };
+
+        enum class Verdict
+        {
+            Unchanged,
+            Regression,
+            Improvement,
+            InsufficientData,
+            Missing,        ///< The event is in the baseline but not in the run
+            New,            ///< The event is in the run but not in the baseline
+        };
+
+        struct MetricComparison
+        {
+            std::string event;
+            bool gpu;                       ///< Whether the metric is the GPU time, otherwise the CPU time
+            float baselineMedian = 0;
+            float currentMedian = 0;
+            float change = 0;               ///< Relative change of the median
+            float pValue = 1;               ///< One-sided p-value, in the direction of the change
+            Verdict verdict = Verdict::Unchanged;
+        };
+
+        struct Comparison
+        {
+            CompareOptions options;
+            std::vector<MetricComparison> metrics;
+            bool regressed = false;         ///< Whether any metric regressed. Missing and new events don't fail the comparison.
+
+            /** Serialize the verdict to JSON
+            */
+            std::string toJson() const;
+        };
+
+        /** Compare a run against a baseline. Each event's CPU and GPU times are compared with the Mann-Whitney rank-sum test, which is robust to outliers
+            and doesn't assume the times are normally distributed, and with the relative change of the medians.
+        */
+        static Comparison compare(const PerformanceBaseline& baseline, const PerformanceBaseline& current, const CompareOptions& options);
+
+        /** Get the median of samples, 0 if there are none
+        */
+        static float median(std::vector<float> samples);
+
+        /** Get the one-sided p-value of the Mann-Whitney U test for `b` being stochastically greater than `a`, using the normal approximation with tie correction
+        */
+        static float rankSumPValue(const std::vector<float>& a, const std::vector<float>& b);
+
+    private:
+        std::map<std::string, Event> mEvents;
+        uint32_t mFrameCount = 0;
+        std::string mDescription;
+    };
+
+    const std::string to_string(PerformanceBaseline::Verdict verdict);
+}
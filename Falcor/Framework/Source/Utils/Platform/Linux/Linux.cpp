@@ -30,6 +30,7 @@
 #include "Utils/StringUtils.h"
 #include "Utils/Platform/OS.h"
 #include "Utils/Logger.h"
+#include "Utils/FileWatcher.h"
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -42,6 +43,9 @@
 #include <algorithm>
 #include <experimental/filesystem>
 #include <dlfcn.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
 namespace fs = std::experimental::filesystem;
 
 namespace Falcor
@@ -189,16 +193,25 @@ namespace Falcor
         return (stat(pathname, &sb) == 0) && S_ISDIR(sb.st_mode);
     }
     
+    static std::unordered_map<std::string, FileWatcher::SharedPtr> fileWatchers;
+
     void monitorFileUpdates(const std::string& filePath, const std::function<void()>& callback)
     {
-        (void)filePath; (void)callback;
-        should_not_get_here();
+        // Only have one watcher per file. Destroying the previous watcher joins its thread.
+        fileWatchers.erase(filePath);
+
+        FileWatcher::SharedPtr pWatcher = FileWatcher::create([callback](const std::string&) { if (callback) callback(); });
+        if (pWatcher->watchFile(filePath) == false)
+        {
+            logError("Failed to monitor file updates for '" + filePath + "'");
+            return;
+        }
+        fileWatchers[filePath] = pWatcher;
     }
 
     void closeSharedFile(const std::string& filePath)
     {
-        (void)filePath;
-        should_not_get_here();
+        fileWatchers.erase(filePath);
     }
 
     std::string getTempFilename()
@@ -513,4 +526,37 @@ namespace Falcor
     {
         return dlsym(dll, funcName.c_str());
     }
-}
\ No newline at end of file
+
+    uint64_t getProcessPeakUsedPhysicalMemory()
+    {
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+        return (uint64_t)usage.ru_maxrss * 1024; // ru_maxrss is in kilobytes
+    }
+
+    const void* mapFileForReading(const std::string& filename, size_t& size)
+    {
+        size = 0;
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return nullptr;
+
+        struct stat s;
+        if (fstat(fd, &s) != 0 || s.st_size == 0)
+        {
+            close(fd);
+            return nullptr;
+        }
+
+        // The mapping stays valid after the file is closed
+        void* pData = mmap(nullptr, (size_t)s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (pData == MAP_FAILED) return nullptr;
+        size = (size_t)s.st_size;
+        return pData;
+    }
+
+    void unmapFile(const void* pData, size_t size)
+    {
+        if (pData) munmap(const_cast<void*>(pData), size);
+    }
+}
@@ -286,6 +286,21 @@ namespace Falcor
     */
     uint64_t  getProcessUsedVirtualMemory();
 
+    /** Get the peak physical memory used by this process (peak working set / resident set size), in bytes
+    */
+    uint64_t getProcessPeakUsedPhysicalMemory();
+
+    /** Map a file into memory for reading
+        \param[in] filename The file to map
+        \param[out] size The size of the file in bytes
+        \return A pointer to the file's content, or nullptr if the file couldn't be mapped. Release it with unmapFile().
+    */
+    const void* mapFileForReading(const std::string& filename, size_t& size);
+
+    /** Unmap a file mapped with mapFileForReading()
+    */
+    void unmapFile(const void* pData, size_t size);
+
     /** Returns index of most significant set bit, or 0 if no bits were set.
     */
     uint32_t bitScanReverse(uint32_t a);
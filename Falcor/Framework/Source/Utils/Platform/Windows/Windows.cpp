@@ -514,6 +514,42 @@ namespace Falcor
         return virtualMemUsedByMe;
     }
 
+    uint64_t getProcessPeakUsedPhysicalMemory()
+    {
+        PROCESS_MEMORY_COUNTERS pmc;
+        GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+        return pmc.PeakWorkingSetSize;
+    }
+
+    const void* mapFileForReading(const std::string& filename, size_t& size)
+    {
+        size = 0;
+        HANDLE hFile = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (hFile == INVALID_HANDLE_VALUE) return nullptr;
+
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(hFile, &fileSize) == FALSE || fileSize.QuadPart == 0)
+        {
+            CloseHandle(hFile);
+            return nullptr;
+        }
+
+        HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(hFile);
+        if (hMapping == nullptr) return nullptr;
+
+        // The view keeps the mapping alive, no need to hold on to the handles
+        const void* pData = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(hMapping);
+        if (pData) size = (size_t)fileSize.QuadPart;
+        return pData;
+    }
+
+    void unmapFile(const void* pData, size_t size)
+    {
+        if (pData) UnmapViewOfFile(pData);
+    }
+
     uint32_t bitScanReverse(uint32_t a)
     {
         unsigned long index;
@@ -34,6 +34,7 @@
 #include <fstream>
 #include <sstream>
 #include <cstdio>
+#include <algorithm>
 
 namespace Falcor
 {
@@ -181,6 +182,18 @@ namespace Falcor
         return results;
     }
 
+    void Profiler::getEventTimes(std::vector<EventTimes>& times)
+    {
+        times.clear();
+        for (size_t i = 0; i < sProfilerVector.size(); i++)
+        {
+            const EventData* pData = sProfilerVector[i];
+            // An event started more than once a frame is in the vector once per start
+            if (std::find(sProfilerVector.begin(), sProfilerVector.begin() + i, pData) != sProfilerVector.begin() + i) continue;
+            times.push_back({ pData->name, pData->cpuTotal, (float)getGpuTime(pData) });
+        }
+    }
+
     void Profiler::endFrame()
     {
         for (EventData* pData : sProfilerVector)
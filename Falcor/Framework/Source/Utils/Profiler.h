@@ -148,6 +148,21 @@ namespace Falcor
         */
         static void clearEvents();
 
+        /** The times of an event, in milliseconds
+        */
+        struct EventTimes
+        {
+            std::string name;
+            float cpuMs;
+            float gpuMs;
+        };
+
+        /** Get the times of the events of the current frame, in the order they were first started.
+            Should be called before endFrame(). Due to the double-buffering, the GPU times are for the previous frame.
+            \param[out] times The event times
+        */
+        static void getEventTimes(std::vector<EventTimes>& times);
+
     private:
         static double getGpuTime(const EventData* pData);
         static double getCpuTime(const EventData* pData);
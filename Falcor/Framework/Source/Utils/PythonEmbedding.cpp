@@ -32,12 +32,17 @@
 
 #include "Python.h"
 #include "PythonEmbedding.h"
+#include "Framework.h"
+#include "API/Buffer.h"
+#include "Utils/Bitmap.h"
+#include "Utils/FrameBatchStream.h"
 #include <ctime>
 #include <chrono>
 
 // Requires use of pybind11.  See README.txt in sample "LearningWithEmbeddedPython" for more info
 namespace py = pybind11;
 using namespace py::literals;
+using namespace Falcor;
 
 // If using this fragine sharing scheme, create a global variable for the interpreter that everyone can reuse
 #ifdef PYTHON_USE_SIMPLE_SHARING
@@ -46,6 +51,131 @@ namespace {
 };
 #endif
 
+namespace
+{
+    // Formats whose channels don't fit in whole bytes. These are exposed as a single channel holding the raw texel.
+    bool isPackedFormat(ResourceFormat format)
+    {
+        switch (format)
+        {
+        case ResourceFormat::R24UnormX8:
+        case ResourceFormat::RGB5A1Unorm:
+        case ResourceFormat::RGB10A2Unorm:
+        case ResourceFormat::RGB10A2Uint:
+        case ResourceFormat::R32FloatX32:
+        case ResourceFormat::R11G11B10Float:
+        case ResourceFormat::RGB9E5Float:
+        case ResourceFormat::R5G6B5Unorm:
+        case ResourceFormat::D32FloatS8X24:
+        case ResourceFormat::D24UnormS8:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // The NumPy element type and channel count used to expose a format
+    bool getArrayLayout(ResourceFormat format, py::dtype& dtype, uint32_t& channels)
+    {
+        if (format == ResourceFormat::Unknown || isCompressedFormat(format))
+        {
+            logError("PythonEmbedding: can't export format " + to_string(format) + " as a NumPy array");
+            return false;
+        }
+
+        uint32_t texelBytes = getFormatBytesPerBlock(format);
+        bool packed = isPackedFormat(format) || (texelBytes % getFormatChannelCount(format)) != 0;
+        channels = packed ? 1 : getFormatChannelCount(format);
+        uint32_t channelBytes = texelBytes / channels;
+
+        char kind = 'u';
+        if (packed == false)
+        {
+            switch (getFormatType(format))
+            {
+            case FormatType::Float:
+                kind = 'f';
+                break;
+            case FormatType::Snorm:
+            case FormatType::Sint:
+                kind = 'i';
+                break;
+            default:
+                break;
+            }
+        }
+        dtype = py::dtype(std::string(1, kind) + std::to_string(channelBytes));
+        return true;
+    }
+
+    py::array makeImageArray(void* pData, uint32_t frames, uint32_t width, uint32_t height, ResourceFormat format, py::handle base)
+    {
+        py::dtype dtype;
+        uint32_t channels;
+        if (getArrayLayout(format, dtype, channels) == false) return py::array();
+
+        size_t channelBytes = dtype.itemsize();
+        std::vector<size_t> shape = { height, width, channels };
+        std::vector<size_t> strides = { width * channels * channelBytes, channels * channelBytes, channelBytes };
+        if (frames > 0)
+        {
+            shape.insert(shape.begin(), frames);
+            strides.insert(strides.begin(), height * strides[0]);
+        }
+        return py::array(dtype, shape, strides, pData, base);
+    }
+
+    // Keeps a batch acquired while Python holds arrays referencing it
+    struct BatchLease
+    {
+        FrameBatchStream::SharedPtr pStream;
+        uint32_t batch;
+        ~BatchLease() { pStream->releaseBatch(batch); }
+    };
+}
+
+PYBIND11_EMBEDDED_MODULE(falcor_buffers, m)
+{
+    py::class_<FrameBatchStream, FrameBatchStream::SharedPtr>(m, "FrameBatchStream")
+        .def("next_batch", [](const FrameBatchStream::SharedPtr& pStream, int32_t timeoutMs) -> py::object
+        {
+            uint32_t batch;
+            {
+                py::gil_scoped_release release;
+                batch = pStream->acquireBatch(timeoutMs < 0 ? FrameBatchStream::kInfinite : uint32_t(timeoutMs));
+            }
+            if (batch == FrameBatchStream::kInvalidBatch) return py::none();
+
+            // Every array of the batch shares the lease, the last one to be collected returns the batch to the producer
+            auto pLease = new std::shared_ptr<BatchLease>(new BatchLease{ pStream, batch });
+            py::capsule base(pLease, [](void* p) { delete reinterpret_cast<std::shared_ptr<BatchLease>*>(p); });
+
+            py::dict arrays;
+            const auto& channels = pStream->getDesc().channels;
+            uint32_t frames = pStream->getBatchFrameCount(batch);
+            for (uint32_t c = 0; c < uint32_t(channels.size()); c++)
+            {
+                void* pData = const_cast<uint8_t*>(pStream->getBatchData(batch, c));
+                arrays[py::str(channels[c].name)] = makeImageArray(pData, frames, channels[c].width, channels[c].height, channels[c].format, base);
+            }
+            return std::move(arrays);
+        }, py::arg("timeout_ms") = -1)
+        .def("stats", [](const FrameBatchStream::SharedPtr& pStream)
+        {
+            FrameBatchStream::Stats stats = pStream->getStats();
+            py::dict d;
+            d["frames_submitted"] = stats.framesSubmitted;
+            d["frames_dropped"] = stats.framesDropped;
+            d["batches_published"] = stats.batchesPublished;
+            d["batches_consumed"] = stats.batchesConsumed;
+            d["stall_count"] = stats.stallCount;
+            d["stall_time"] = stats.stallTime;
+            d["wait_time"] = stats.waitTime;
+            return d;
+        })
+        .def("close", &FrameBatchStream::close);
+}
+
 
 PythonEmbedding::PythonEmbedding(bool redirectStdout) :
     mRedirectStdout(redirectStdout)
@@ -116,6 +246,13 @@ PythonEmbedding::PythonEmbedding(bool redirectStdout) :
 
 PythonEmbedding::~PythonEmbedding()
 {
+    // Take the GIL back for good, the interpreter expects to be finalized by the thread that created it
+    if (mpSavedThreadState)
+    {
+        PyEval_RestoreThread(mpSavedThreadState);
+        mpSavedThreadState = nullptr;
+    }
+
     // TODO: Need to figure out how to shutdown appropriately
     /*
     if (mpInterp)
@@ -133,6 +270,7 @@ std::string PythonEmbedding::getPythonVersion(void)
 
 std::string PythonEmbedding::getModuleVersion(const char* moduleName, const char* attrName)
 {
+    py::gil_scoped_acquire gil;
     // Check.  Have we loaded the specified module?
     std::string strName = std::string(moduleName);
     auto found = mModuleList.find(strName);
@@ -168,6 +306,7 @@ std::string PythonEmbedding::getModuleVersion(const char* moduleName, const char
 
 bool PythonEmbedding::importModule(const char* moduleName, const char* importAs)
 {
+    py::gil_scoped_acquire gil;
     bool success = false;
 
     // Check.  Have we already loaded this module?
@@ -208,6 +347,7 @@ bool PythonEmbedding::importModule(const char* moduleName, const char* importAs)
 
 bool PythonEmbedding::fromModuleImport(const char* moduleName, const char* toImport, const char* importAs)
 {
+    py::gil_scoped_acquire gil;
     bool success = false;
 
     // Check.  Have we already loaded this object?  (Could be a module, could be a class, could be a function)
@@ -271,10 +411,12 @@ pybind11::dict PythonEmbedding::getGlobals(void)
 
 bool PythonEmbedding::doesGlobalVarExist(const char* globalVarName)
 {
+    py::gil_scoped_acquire gil;
     return mGlobals.contains(py::str(std::string(globalVarName)));
 }
 bool PythonEmbedding::doesGlobalVarExist(const std::string &globalVarName)
 {
+    py::gil_scoped_acquire gil;
     return mGlobals.contains(py::str(globalVarName));
 }
 
@@ -310,11 +452,13 @@ void PythonEmbedding::clearPythonState(void)
 
 bool PythonEmbedding::executeFile(const char* scriptFile)
 {
+    py::gil_scoped_acquire gil;
     return commonExecRoutine(py::str(scriptFile), false);
 }
 
 bool PythonEmbedding::executeString(const char* scriptCode)
 {
+    py::gil_scoped_acquire gil;
     if (!scriptCode) return false;
     if (scriptCode[0] != '\n')
     {
@@ -328,26 +472,31 @@ bool PythonEmbedding::executeString(const char* scriptCode)
 
 bool PythonEmbedding::executeString(const std::string &scriptCode)
 {
+    py::gil_scoped_acquire gil;
     return commonExecRoutine(py::str(scriptCode.c_str()), true);
 }
 
 bool PythonEmbedding::executeFile(const char* scriptFile, pybind11::dict localNamespace)
 {
+    py::gil_scoped_acquire gil;
     return commonExecRoutine(py::str(scriptFile), false, true, localNamespace);
 }
 
 bool PythonEmbedding::executeFile(const std::string &scriptFile, pybind11::dict localNamespace)
 {
+    py::gil_scoped_acquire gil;
     return commonExecRoutine(py::str(scriptFile.c_str()), false, true, localNamespace);
 }
 
 bool PythonEmbedding::executeString(const char* scriptCode, pybind11::dict localNamespace)
 {
+    py::gil_scoped_acquire gil;
     return commonExecRoutine(py::str(scriptCode), true, true, localNamespace);
 }
 
 bool PythonEmbedding::executeString(const std::string &scriptCode, pybind11::dict localNamespace)
 {
+    py::gil_scoped_acquire gil;
     return commonExecRoutine(py::str(scriptCode.c_str()), true, true, localNamespace);
 }
 
@@ -397,6 +546,59 @@ bool PythonEmbedding::commonExecRoutine(const pybind11::str &input, bool asStrin
     return success;
 }
 
+void PythonEmbedding::enableBackgroundThreads(void)
+{
+    if (mpSavedThreadState == nullptr)
+    {
+        mpSavedThreadState = PyEval_SaveThread();
+    }
+}
+
+py::array PythonEmbedding::exportArray(std::vector<uint8_t>&& data, uint32_t width, uint32_t height, ResourceFormat format)
+{
+    // The capsule owns the vector, NumPy frees it when the array (and any view of it) is collected
+    assert(data.size() >= size_t(width) * height * getFormatBytesPerBlock(format));
+    auto pData = new std::vector<uint8_t>(std::move(data));
+    py::capsule base(pData, [](void* p) { delete reinterpret_cast<std::vector<uint8_t>*>(p); });
+    return makeImageArray(pData->data(), 0, width, height, format, base);
+}
+
+py::array PythonEmbedding::exportBitmap(std::unique_ptr<const Bitmap> pBitmap)
+{
+    if (!pBitmap) return py::array();
+    const Bitmap* pRaw = pBitmap.release();
+    py::capsule base(pRaw, [](void* p) { delete reinterpret_cast<const Bitmap*>(p); });
+    return makeImageArray(pRaw->getData(), 0, pRaw->getWidth(), pRaw->getHeight(), pRaw->getFormat(), base);
+}
+
+py::array PythonEmbedding::exportReadbackBuffer(const std::shared_ptr<Buffer>& pBuffer, uint32_t width, uint32_t height, ResourceFormat format)
+{
+    if (!pBuffer || pBuffer->getCpuAccess() != Buffer::CpuAccess::Read)
+    {
+        logError("PythonEmbedding::exportReadbackBuffer() - the buffer must be created with CpuAccess::Read");
+        return py::array();
+    }
+    assert(pBuffer->getSize() >= size_t(width) * height * getFormatBytesPerBlock(format));
+
+    // The mapping stays valid until the last array referencing it is collected
+    void* pData = pBuffer->map(Buffer::MapType::Read);
+    auto pOwner = new Buffer::SharedPtr(pBuffer);
+    py::capsule base(pOwner, [](void* p)
+    {
+        auto pOwner = reinterpret_cast<Buffer::SharedPtr*>(p);
+        (*pOwner)->unmap();
+        delete pOwner;
+    });
+    return makeImageArray(pData, 0, width, height, format, base);
+}
+
+void PythonEmbedding::exportBatchStream(const std::string &globalVarName, const std::shared_ptr<FrameBatchStream>& pStream)
+{
+    py::gil_scoped_acquire gil;
+    py::module::import("falcor_buffers");
+    mGlobals[globalVarName.c_str()] = py::cast(pStream);
+}
+
 double PythonEmbedding::lastExecutionTime(bool totalTime)
 {
     return totalTime ? mLastCostTotal : mLastCostPython;
@@ -421,6 +623,7 @@ void PythonEmbedding::checkRedirectionImports(void)
 
 void PythonEmbedding::redirectStdout(bool redirect)
 {
+    py::gil_scoped_acquire gil;
     // If we're enabling redirection, ensure Python's io and sys modules are loaded.
     if (redirect)
     {
@@ -441,6 +644,7 @@ void PythonEmbedding::redirectStdout(bool redirect)
 
 void PythonEmbedding::redirectStderr(bool redirect)
 {
+    py::gil_scoped_acquire gil;
     // If we're enabling redirection, ensure Python's io and sys modules are loaded.
     if (redirect)
     {
@@ -48,6 +48,15 @@
 #include "pybind11/pybind11.h"
 #include "pybind11/embed.h"
 #include "pybind11/eval.h"
+#include "pybind11/numpy.h"
+
+namespace Falcor
+{
+    class Bitmap;
+    class Buffer;
+    class FrameBatchStream;
+    enum class ResourceFormat : uint32_t;
+}
 
 /** If PYTHON_USE_SIMPLE_SHARING is defined, use a simplistic and fragile approach that
         allows usage of multiple PythonEmbedding class instantiations simultaneously (but
@@ -178,6 +187,40 @@ public:
     */
     double lastExecutionTime( bool totalTime = true );
 
+    /** Methods to hand CPU-side image data to Python as NumPy arrays without copying it.
+          -> The returned array is shaped [height][width][channels] with a dtype matching the format. Packed formats (e.g., RGB10A2)
+             are exposed as a single unsigned integer channel.
+          -> The array keeps the memory alive, so it remains valid after the C++ side lets go of it.
+          -> Must be called while holding the GIL (i.e., from the thread that owns this embedding, or under a pybind11::gil_scoped_acquire).
+    */
+    static pybind11::array exportArray(std::vector<uint8_t>&& data, uint32_t width, uint32_t height, Falcor::ResourceFormat format);
+    static pybind11::array exportBitmap(std::unique_ptr<const Falcor::Bitmap> pBitmap);
+
+    /** Export a read-back buffer (a buffer created with Buffer::CpuAccess::Read) as a NumPy array. The buffer stays mapped
+          as long as the array is alive. The caller must make sure the GPU finished writing it (e.g., by flushing and waiting
+          on the copy) before Python reads the array.
+    */
+    static pybind11::array exportReadbackBuffer(const std::shared_ptr<Falcor::Buffer>& pBuffer, uint32_t width, uint32_t height, Falcor::ResourceFormat format);
+
+    /** Make a frame batch stream available to Python as the global variable <globalVarName>.
+          -> In Python, stream.next_batch(timeout_ms=-1) returns a dict mapping each channel name to an array shaped
+             [frames][height][width][channels] that aliases the batch memory, or None once the stream is closed (or on timeout).
+             The batch is returned to the producer when all of its arrays are garbage collected.
+          -> stream.stats() returns the stream statistics as a dict, stream.close() stops the stream.
+          -> next_batch() releases the GIL while waiting, so a Python training thread can consume batches while C++ keeps rendering
+             (see enableBackgroundThreads()).
+    */
+    void exportBatchStream(const std::string &globalVarName, const std::shared_ptr<Falcor::FrameBatchStream>& pStream);
+
+    /** By default the thread that created this class holds Python's global interpreter lock (GIL) forever, so threads
+          started from Python only run while executeFile()/executeString() are running. After calling this, the GIL is
+          released between calls, so Python threads (e.g., a training loop consuming a FrameBatchStream) keep running
+          while the application renders.
+          -> All methods of this class acquire the GIL as needed. Code using operator[] or getGlobals() directly must
+             hold a pybind11::gil_scoped_acquire while doing so.
+    */
+    void enableBackgroundThreads(void);
+
 private:
     // Internal member variables
 
@@ -195,6 +238,7 @@ private:
 
     double                        mLastCostTotal = -1;     // The cost of the last executeFile()/executeString() call
     double                        mLastCostPython = -1;    // The cost of the Python code from the last executeFile()/executeString() call
+    PyThreadState*                mpSavedThreadState = nullptr; // Our thread state while the GIL is released (see enableBackgroundThreads())
 
     /** Stores a list of modules we've tried to load.
     */
@@ -83,6 +83,7 @@ namespace Falcor
         auto model = pybind11::enum_<Model::LoadFlags>(m, "ModelLoadFlags");
         model.val(Model::LoadFlags::None).val(Model::LoadFlags::DontGenerateTangentSpace).val(Model::LoadFlags::FindDegeneratePrimitives).val(Model::LoadFlags::AssumeLinearSpaceTextures);
         model.val(Model::LoadFlags::DontMergeMeshes).val(Model::LoadFlags::BuffersAsShaderResource).val(Model::LoadFlags::RemoveInstancing).val(Model::LoadFlags::UseSpecGlossMaterials);
+        model.val(Model::LoadFlags::DontUseBakedCache).val(Model::LoadFlags::OptimizeMeshes).val(Model::LoadFlags::CompressVertices);
 
         // Scene load flags
         auto scene = pybind11::enum_<Scene::LoadFlags>(m, "SceneLoadFlags");
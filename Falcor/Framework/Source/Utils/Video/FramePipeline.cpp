@@ -0,0 +1,220 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "FramePipeline.h"
+#include "Utils/CpuTimer.h"
+#include <cstring>
+
+namespace Falcor
+{
+    FramePipeline::UniquePtr FramePipeline::create(const Desc& desc, const ConvertFunc& convertFunc, const EncodeFunc& encodeFunc)
+    {
+        if (desc.queueDepth == 0 || desc.workerCount == 0)
+        {
+            logError("FramePipeline requires at least one slot and one worker thread");
+            return nullptr;
+        }
+        return UniquePtr(new FramePipeline(desc, convertFunc, encodeFunc));
+    }
+
+    FramePipeline::FramePipeline(const Desc& desc, const ConvertFunc& convertFunc, const EncodeFunc& encodeFunc) : mDesc(desc), mConvertFunc(convertFunc), mEncodeFunc(encodeFunc)
+    {
+        mSlots.resize(desc.queueDepth);
+        for (auto& s : mSlots) s.data.resize(desc.frameSize);
+        for (uint32_t i = 0; i < desc.workerCount; i++)
+        {
+            mWorkers.emplace_back(&FramePipeline::workerLoop, this, i);
+        }
+        mEncodeThread = std::thread(&FramePipeline::encodeLoop, this);
+    }
+
+    FramePipeline::~FramePipeline()
+    {
+        flush();
+        {
+            std::lock_guard<std::mutex> l(mMutex);
+            mTerminate = true;
+        }
+        mSlotQueued.notify_all();
+        mSlotConverted.notify_all();
+        for (auto& t : mWorkers) t.join();
+        mEncodeThread.join();
+    }
+
+    uint32_t FramePipeline::acquireSlot()
+    {
+        std::unique_lock<std::mutex> l(mMutex);
+        auto findFree = [this]() -> uint32_t
+        {
+            for (uint32_t i = 0; i < (uint32_t)mSlots.size(); i++)
+            {
+                if (mSlots[i].state == SlotState::Free) return i;
+            }
+            return uint32_t(-1);
+        };
+
+        uint32_t slot = findFree();
+        if (slot == uint32_t(-1))
+        {
+            if (mDesc.dropWhenFull)
+            {
+                mStats.framesDropped++;
+                return slot;
+            }
+
+            CpuTimer timer;
+            timer.update();
+            mSlotFreed.wait(l, [&]() { slot = findFree(); return slot != uint32_t(-1); });
+            timer.update();
+            mStats.stallCount++;
+            mStats.stallTime += timer.getElapsedTime();
+        }
+
+        mSlots[slot].state = SlotState::Filling;
+        mSlots[slot].frameIndex = mStats.framesSubmitted++;
+        uint32_t inFlight = uint32_t(mStats.framesSubmitted - mNextEncodeFrame);
+        mStats.maxFramesInFlight = std::max(mStats.maxFramesInFlight, inFlight);
+        return slot;
+    }
+
+    void FramePipeline::submitSlot(uint32_t slot)
+    {
+        {
+            std::lock_guard<std::mutex> l(mMutex);
+            mSlots[slot].state = SlotState::Queued;
+            mConvertQueue.push_back(slot);
+        }
+        mSlotQueued.notify_one();
+    }
+
+    bool FramePipeline::pushFrame(const void* pData)
+    {
+        uint32_t slot = acquireSlot();
+        if (slot == uint32_t(-1)) return false;
+        // The slot is owned by this thread until it's submitted, so the copy doesn't need the lock
+        std::memcpy(mSlots[slot].data.data(), pData, mDesc.frameSize);
+        submitSlot(slot);
+        return true;
+    }
+
+    bool FramePipeline::pushFrame(std::vector<uint8_t>&& data)
+    {
+        if (data.size() < mDesc.frameSize)
+        {
+            logError("FramePipeline::pushFrame() - the frame is smaller than the frame size the pipeline was created with");
+            return false;
+        }
+        uint32_t slot = acquireSlot();
+        if (slot == uint32_t(-1)) return false;
+        mSlots[slot].data.swap(data);
+        submitSlot(slot);
+        return true;
+    }
+
+    void FramePipeline::flush()
+    {
+        std::unique_lock<std::mutex> l(mMutex);
+        mSlotFreed.wait(l, [this]() { return mNextEncodeFrame == mStats.framesSubmitted; });
+    }
+
+    FramePipeline::Stats FramePipeline::getStats() const
+    {
+        std::lock_guard<std::mutex> l(mMutex);
+        return mStats;
+    }
+
+    void FramePipeline::workerLoop(uint32_t workerIndex)
+    {
+        while (true)
+        {
+            uint32_t slot;
+            {
+                std::unique_lock<std::mutex> l(mMutex);
+                mSlotQueued.wait(l, [this]() { return mTerminate || mConvertQueue.size(); });
+                if (mTerminate) return;
+                slot = mConvertQueue.front();
+                mConvertQueue.pop_front();
+                mSlots[slot].state = SlotState::Converting;
+            }
+
+            CpuTimer timer;
+            timer.update();
+            mConvertFunc(workerIndex, slot, mSlots[slot].data.data());
+            timer.update();
+
+            {
+                std::lock_guard<std::mutex> l(mMutex);
+                mSlots[slot].state = SlotState::Converted;
+                mStats.convertTime += timer.getElapsedTime();
+            }
+            // Only the encode thread waits on this, but the frame it's waiting for may not be this one
+            mSlotConverted.notify_all();
+        }
+    }
+
+    void FramePipeline::encodeLoop()
+    {
+        while (true)
+        {
+            uint32_t slot = uint32_t(-1);
+            uint64_t frameIndex;
+            {
+                std::unique_lock<std::mutex> l(mMutex);
+                mSlotConverted.wait(l, [&]()
+                {
+                    if (mTerminate) return true;
+                    for (uint32_t i = 0; i < (uint32_t)mSlots.size(); i++)
+                    {
+                        if (mSlots[i].state == SlotState::Converted && mSlots[i].frameIndex == mNextEncodeFrame)
+                        {
+                            slot = i;
+                            return true;
+                        }
+                    }
+                    return false;
+                });
+                if (slot == uint32_t(-1)) return;
+                frameIndex = mNextEncodeFrame;
+            }
+
+            CpuTimer timer;
+            timer.update();
+            mEncodeFunc(slot, frameIndex);
+            timer.update();
+
+            {
+                std::lock_guard<std::mutex> l(mMutex);
+                mSlots[slot].state = SlotState::Free;
+                mNextEncodeFrame++;
+                mStats.framesEncoded++;
+                mStats.encodeTime += timer.getElapsedTime();
+            }
+            mSlotFreed.notify_all();
+        }
+    }
+}
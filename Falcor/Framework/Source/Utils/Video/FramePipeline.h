@@ -0,0 +1,147 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+namespace Falcor
+{
+    /** A bounded pipeline for captured frames.
+        pushFrame() copies a frame into one of queueDepth slots and returns. Worker threads run the conversion function on the slots, possibly out of order.
+        A dedicated thread runs the encode function on the converted slots in submission order, then returns the slots to the pool.
+        When all the slots are in use pushFrame() either blocks or drops the frame, and the time spent blocked is reported in the stats. This is the
+        back-pressure of the pipeline: if it stalls, the encoder can't keep up with the capture rate.
+        The pipeline doesn't know what a frame is. The owner keeps its per-slot and per-worker state (output pictures, conversion contexts) indexed by the
+        indices passed to the callbacks.
+    */
+    class FramePipeline
+    {
+    public:
+        using UniquePtr = std::unique_ptr<FramePipeline>;
+
+        /** Called on a worker thread
+            \param[in] workerIndex The index of the worker thread, in [0, workerCount)
+            \param[in] slot The index of the slot holding the frame, in [0, queueDepth)
+            \param[in] pData The frame data
+        */
+        using ConvertFunc = std::function<void(uint32_t workerIndex, uint32_t slot, const uint8_t* pData)>;
+
+        /** Called on the encode thread, in submission order
+            \param[in] slot The index of the slot holding the converted frame
+            \param[in] frameIndex The index of the frame, starting at 0
+        */
+        using EncodeFunc = std::function<void(uint32_t slot, uint64_t frameIndex)>;
+
+        struct Desc
+        {
+            size_t frameSize = 0;           ///< The size of a frame in bytes
+            uint32_t queueDepth = 4;        ///< The number of frames in flight. Bounds the memory used by the pipeline.
+            uint32_t workerCount = 2;       ///< The number of conversion threads
+            bool dropWhenFull = false;      ///< If true, pushFrame() drops the frame instead of blocking when all the slots are in use
+        };
+
+        struct Stats
+        {
+            uint64_t framesSubmitted = 0;
+            uint64_t framesEncoded = 0;
+            uint64_t framesDropped = 0;
+            uint64_t stallCount = 0;        ///< Number of pushFrame() calls which had to wait for a slot
+            double stallTime = 0;           ///< Total time spent waiting for a slot, in seconds
+            uint32_t maxFramesInFlight = 0;
+            double convertTime = 0;         ///< Total time spent in the conversion function, in seconds, summed over the workers
+            double encodeTime = 0;          ///< Total time spent in the encode function, in seconds
+        };
+
+        static UniquePtr create(const Desc& desc, const ConvertFunc& convertFunc, const EncodeFunc& encodeFunc);
+
+        /** Waits for the frames in flight, then stops the threads
+        */
+        ~FramePipeline();
+
+        /** Copy a frame into the pipeline
+            \return false if the frame was dropped
+        */
+        bool pushFrame(const void* pData);
+
+        /** Move a frame into the pipeline. Avoids the copy when the data was produced in a vector, like a readback.
+            \return false if the frame was dropped
+        */
+        bool pushFrame(std::vector<uint8_t>&& data);
+
+        /** Wait until all the submitted frames were encoded
+        */
+        void flush();
+
+        Stats getStats() const;
+        const Desc& getDesc() const { return mDesc; }
+
+    private:
+        FramePipeline(const Desc& desc, const ConvertFunc& convertFunc, const EncodeFunc& encodeFunc);
+        uint32_t acquireSlot();
+        void submitSlot(uint32_t slot);
+        void workerLoop(uint32_t workerIndex);
+        void encodeLoop();
+
+        enum class SlotState
+        {
+            Free,
+            Filling,
+            Queued,
+            Converting,
+            Converted,
+        };
+
+        struct Slot
+        {
+            SlotState state = SlotState::Free;
+            uint64_t frameIndex = 0;
+            std::vector<uint8_t> data;
+        };
+
+        Desc mDesc;
+        ConvertFunc mConvertFunc;
+        EncodeFunc mEncodeFunc;
+
+        mutable std::mutex mMutex;
+        std::condition_variable mSlotFreed;         // Signaled by the encode thread
+        std::condition_variable mSlotQueued;        // Signaled by pushFrame(), wakes the workers
+        std::condition_variable mSlotConverted;     // Signaled by the workers, wakes the encode thread
+        std::vector<Slot> mSlots;
+        std::deque<uint32_t> mConvertQueue;
+        uint64_t mNextEncodeFrame = 0;
+        bool mTerminate = false;
+        Stats mStats;
+
+        std::vector<std::thread> mWorkers;
+        std::thread mEncodeThread;
+    };
+}
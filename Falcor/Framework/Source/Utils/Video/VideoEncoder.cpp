@@ -167,7 +167,7 @@ namespace Falcor
         return pFrame;
     }
 
-    bool openVideo(AVCodec* pCodec, AVCodecContext* pCodecCtx, AVFrame*& pFrame, const std::string& filename)
+    bool openVideo(AVCodec* pCodec, AVCodecContext* pCodecCtx, const std::string& filename)
     {
         AVDictionary* param = nullptr;
 
@@ -189,13 +189,6 @@ namespace Falcor
             return error(filename, "Can't open video codec.");
         }
         av_dict_free(&param);
-
-        // create a frame
-        pFrame = allocateFrame(pCodecCtx->pix_fmt, pCodecCtx->width, pCodecCtx->height, filename);
-        if(pFrame == nullptr)
-        {
-            return false;
-        }
         return true;
     }
 
@@ -224,6 +217,17 @@ namespace Falcor
         return pVC;
     }
 
+    static bool createFrames(AVCodecContext* pCodecCtx, std::vector<AVFrame*>& frames, uint32_t count, const std::string& filename)
+    {
+        for(uint32_t i = 0; i < count; i++)
+        {
+            AVFrame* pFrame = allocateFrame(pCodecCtx->pix_fmt, pCodecCtx->width, pCodecCtx->height, filename);
+            if(pFrame == nullptr) return false;
+            frames.push_back(pFrame);
+        }
+        return true;
+    }
+
     bool VideoEncoder::init(const Desc& desc)
     {
         // av_register_all() is deprecated since 58.9.100, but Linux repos may not get a newer version, so this call cannot be completely removed.
@@ -257,7 +261,7 @@ namespace Falcor
         }
 
         // Open the video stream
-        if(openVideo(pVideoCodec, mpCodecContext, mpFrame, mFilename) == false)
+        if(openVideo(pVideoCodec, mpCodecContext, mFilename) == false)
         {
             return false;
         }
@@ -285,17 +289,33 @@ namespace Falcor
 
         mFormat = desc.format;
         mRowPitch = getFormatBytesPerBlock(desc.format) * desc.width;
-        if(desc.flipY)
+        mFlipY = desc.flipY;
+        mReadbackLatency = desc.readbackLatency;
+        mReadbackSlots.resize(mReadbackLatency + 1);
+
+        // Each slot of the pipeline gets its own output picture, and each conversion thread its own scaling context
+        FramePipeline::Desc pipelineDesc;
+        pipelineDesc.frameSize = size_t(mRowPitch) * desc.height;
+        pipelineDesc.queueDepth = std::max(1u, desc.queueDepth);
+        pipelineDesc.workerCount = std::max(1u, desc.conversionThreads);
+        if(createFrames(mpCodecContext, mFrames, pipelineDesc.queueDepth, mFilename) == false)
         {
-            mpFlippedImage = new uint8_t[desc.height * mRowPitch];
+            return false;
         }
-
-        mpSwsContext = sws_getContext(desc.width, desc.height, getPictureFormatFromFalcorFormat(desc.format), desc.width, desc.height, mpCodecContext->pix_fmt, SWS_POINT, nullptr, nullptr, nullptr);
-        if(mpSwsContext == nullptr)
+        for(uint32_t i = 0; i < pipelineDesc.workerCount; i++)
         {
-            return error(mFilename, "Failed to allocate SWScale context");
+            SwsContext* pSwsContext = sws_getContext(desc.width, desc.height, getPictureFormatFromFalcorFormat(desc.format), desc.width, desc.height, mpCodecContext->pix_fmt, SWS_POINT, nullptr, nullptr, nullptr);
+            if(pSwsContext == nullptr)
+            {
+                return error(mFilename, "Failed to allocate SWScale context");
+            }
+            mSwsContexts.push_back(pSwsContext);
         }
-        return true;
+
+        auto convertFunc = [this](uint32_t workerIndex, uint32_t slot, const uint8_t* pData) { convertFrame(workerIndex, slot, pData); };
+        auto encodeFunc = [this](uint32_t slot, uint64_t frameIndex) { encodeFrame(slot, frameIndex); };
+        mpPipeline = FramePipeline::create(pipelineDesc, convertFunc, encodeFunc);
+        return mpPipeline != nullptr;
     }
 
     bool flush(AVCodecContext* pCodecContext, AVFormatContext* pOutputContext, AVStream* pOutputStream, const std::string& filename)
@@ -333,6 +353,18 @@ namespace Falcor
 
     void VideoEncoder::endCapture()
     {
+        if(mpPipeline)
+        {
+            readbackFrames(0);
+            mpPipeline->flush();
+            const auto stats = mpPipeline->getStats();
+            logInfo("Video capture: " + std::to_string(stats.framesEncoded) + " frames encoded. Capture stalled " + std::to_string(stats.stallCount) + " times, " +
+                std::to_string(stats.stallTime * 1000) + "ms in total. Conversion " + std::to_string(stats.convertTime * 1000 / std::max<uint64_t>(1, stats.framesEncoded)) +
+                "ms/frame, encoding " + std::to_string(stats.encodeTime * 1000 / std::max<uint64_t>(1, stats.framesEncoded)) + "ms/frame.");
+            // Stop the threads before releasing the contexts they use
+            mpPipeline = nullptr;
+        }
+
         if(mpOutputContext)
         {
             // Flush the codex
@@ -343,53 +375,96 @@ namespace Falcor
 
             avio_closep(&mpOutputContext->pb);
             avcodec_free_context(&mpCodecContext);
-            av_frame_free(&mpFrame);
-            sws_freeContext(mpSwsContext);
             avformat_free_context(mpOutputContext);
             mpOutputContext = nullptr;
             mpOutputStream = nullptr;
         }
-        safe_delete(mpFlippedImage)
+        for(auto& pFrame : mFrames) av_frame_free(&pFrame);
+        mFrames.clear();
+        for(auto pSwsContext : mSwsContexts) sws_freeContext(pSwsContext);
+        mSwsContexts.clear();
     }
 
     void VideoEncoder::appendFrame(const void* pData)
     {
-        if(mpFlippedImage)
-        {
-            // Flip the image
-            for(int32_t h = 0; h < mpCodecContext->height; h++)
-            {
-                const uint8_t* pSrc = (uint8_t*)pData + h * mRowPitch;
-                uint8_t* pDst = mpFlippedImage + (mpCodecContext->height - 1 - h) * mRowPitch;
-                memcpy(pDst, pSrc, mRowPitch);
-            }
+        if(mpPipeline) mpPipeline->pushFrame(pData);
+    }
+
+    void VideoEncoder::appendFrame(CopyContext* pCtx, const Texture* pTexture)
+    {
+        if(mpPipeline == nullptr) return;
+
+        // At most readbackLatency frames are in flight here, so the next slot is free. Its buffer is reused, the copy goes out with the next flush.
+        ReadbackSlot& slot = mReadbackSlots[(mFirstReadback + mPendingReadbacks) % mReadbackSlots.size()];
+        slot.pTask = pCtx->asyncReadTextureSubresource(pTexture, 0, slot.pBuffer, false);
+        slot.pBuffer = slot.pTask->getBuffer();
+        mPendingReadbacks++;
+        readbackFrames(mReadbackLatency);
+    }
 
-            pData = mpFlippedImage;
+    void VideoEncoder::readbackFrames(uint32_t maxPending)
+    {
+        // Frames are read back in order. The oldest ones are taken as soon as their copy is done, and waited for once more than maxPending are in flight.
+        while(mPendingReadbacks && (mPendingReadbacks > maxPending || mReadbackSlots[mFirstReadback].pTask->isReady()))
+        {
+            ReadbackSlot& slot = mReadbackSlots[mFirstReadback];
+            mpPipeline->pushFrame(slot.pTask->getData());
+            slot.pTask = nullptr;
+            mFirstReadback = (mFirstReadback + 1) % (uint32_t)mReadbackSlots.size();
+            mPendingReadbacks--;
         }
+    }
 
+    FramePipeline::Stats VideoEncoder::getStats() const
+    {
+        return mpPipeline ? mpPipeline->getStats() : FramePipeline::Stats();
+    }
+
+    void VideoEncoder::convertFrame(uint32_t workerIndex, uint32_t slot, const uint8_t* pData)
+    {
         uint8_t* src[AV_NUM_DATA_POINTERS] = {0};
         int32_t rowPitch[AV_NUM_DATA_POINTERS] = {0};
-        src[0] = (uint8_t*)pData;
-        rowPitch[0] = (int32_t)mRowPitch;
+        if(mFlipY)
+        {
+            // Start at the last row and walk up, so the flip is free
+            src[0] = const_cast<uint8_t*>(pData) + size_t(mpCodecContext->height - 1) * mRowPitch;
+            rowPitch[0] = -(int32_t)mRowPitch;
+        }
+        else
+        {
+            src[0] = const_cast<uint8_t*>(pData);
+            rowPitch[0] = (int32_t)mRowPitch;
+        }
 
         // Scale and convert the image
-        sws_scale(mpSwsContext, src, rowPitch, 0, mpCodecContext->height, mpFrame->data, mpFrame->linesize);
+        AVFrame* pFrame = mFrames[slot];
+        av_frame_make_writable(pFrame);
+        sws_scale(mSwsContexts[workerIndex], src, rowPitch, 0, mpCodecContext->height, pFrame->data, pFrame->linesize);
+    }
 
-        // Encode the frame
-        int r = avcodec_send_frame(mpCodecContext, mpFrame);
-        mpFrame->pts++;
+    void VideoEncoder::encodeFrame(uint32_t slot, uint64_t frameIndex)
+    {
+        AVFrame* pFrame = mFrames[slot];
+        pFrame->pts = (int64_t)frameIndex;
+
+        // Encode the frame. If the encoder's input is full, write out the packets it produced and try again.
+        int r = avcodec_send_frame(mpCodecContext, pFrame);
         if(r == AVERROR(EAGAIN))
         {
             if(flush(mpCodecContext, mpOutputContext, mpOutputStream, mFilename) == false)
             {
                 return;
             }
+            r = avcodec_send_frame(mpCodecContext, pFrame);
         }
-        else if(r < 0)
+        if(r < 0)
         {
             error(mFilename, "Can't send video frame");
             return;
         }
+
+        // Write out whatever the encoder has ready, so packets don't pile up in the encoder
+        flush(mpCodecContext, mpOutputContext, mpOutputStream, mFilename);
     }
 
     const std::string VideoEncoder::getSupportedContainerForCodec(CodecID codec)
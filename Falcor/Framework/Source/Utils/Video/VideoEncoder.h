@@ -27,6 +27,8 @@
 ***************************************************************************/
 #pragma once
 #include <string>
+#include "FramePipeline.h"
+#include "API/CopyContext.h"
 
 struct AVFormatContext;
 struct AVStream;
@@ -36,6 +38,10 @@ struct AVCodecContext;
 
 namespace Falcor
 {
+    /** Encodes frames into a video file.
+        Frames go through a FramePipeline: appendFrame() only copies the frame. The color conversion runs on worker threads and the encoding on a
+        dedicated thread, so the caller's frame rate is only affected when the pipeline is full.
+    */
     class VideoEncoder
     {
     public:
@@ -62,28 +68,62 @@ namespace Falcor
             ResourceFormat format = ResourceFormat::BGRA8UnormSrgb;
             bool flipY = false;
             std::string filename;
+            uint32_t queueDepth = 4;            ///< Frames in flight in the encoding pipeline
+            uint32_t conversionThreads = 2;     ///< Threads running the color conversion
+            uint32_t readbackLatency = 2;       ///< Frames between a GPU readback and its use. See appendFrame(CopyContext*, const Texture*).
         };
 
         ~VideoEncoder();
 
         static UniquePtr create(const Desc& desc);
+
+        /** Append a frame. The data is copied, the function returns before the frame is encoded.
+            \param[in] pData The image, in the format and size the encoder was created with
+        */
         void appendFrame(const void* pData);
+
+        /** Append a frame from a texture. The texture is copied to one of readbackLatency + 1 persistent staging buffers and submitted with the
+            context's next flush. The copy is read back once its fence completes, or after readbackLatency frames, so the CPU usually doesn't wait for the GPU.
+        */
+        void appendFrame(CopyContext* pCtx, const Texture* pTexture);
+
+        /** Encode the remaining frames and close the file
+        */
         void endCapture();
 
+        /** Get the statistics of the encoding pipeline
+        */
+        FramePipeline::Stats getStats() const;
+
         static const std::string getSupportedContainerForCodec(CodecID codec);
     private:
         VideoEncoder(const std::string& filename);
         bool init(const Desc& desc);
+        void convertFrame(uint32_t workerIndex, uint32_t slot, const uint8_t* pData);
+        void encodeFrame(uint32_t slot, uint64_t frameIndex);
+        void readbackFrames(uint32_t maxPending);
 
         AVFormatContext* mpOutputContext = nullptr;
         AVStream*        mpOutputStream  = nullptr;
-        AVFrame*         mpFrame         = nullptr;
-        SwsContext*      mpSwsContext    = nullptr;
         AVCodecContext*  mpCodecContext = nullptr;
+        std::vector<AVFrame*> mFrames;              // One per pipeline slot
+        std::vector<SwsContext*> mSwsContexts;      // One per conversion thread. Scaling contexts can't be shared between threads.
 
         const std::string mFilename;
         ResourceFormat mFormat;
         uint32_t mRowPitch = 0;
-        uint8_t* mpFlippedImage = nullptr; // Used in case the image memory layout if bottom->top
+        bool mFlipY = false;
+        FramePipeline::UniquePtr mpPipeline;
+
+        // Ring of staging buffers for the texture readbacks. The frames in flight are the slots following mFirstReadback.
+        struct ReadbackSlot
+        {
+            Buffer::SharedPtr pBuffer;
+            CopyContext::ReadTextureTask::SharedPtr pTask;
+        };
+        std::vector<ReadbackSlot> mReadbackSlots;
+        uint32_t mFirstReadback = 0;
+        uint32_t mPendingReadbacks = 0;
+        uint32_t mReadbackLatency = 0;
     };
 }
\ No newline at end of file
@@ -129,9 +129,8 @@ void LiveTrainRenderer::doPythonTrain( Texture::SharedPtr fromTex )
     // Pass Python information about our rendered image (used as the target/output for this training run on the network)
     mGlobals["imgW"] = 512;
     mGlobals["imgH"] = 512;
-    mGlobals["imgData"] = py::array_t<unsigned char>( { 512, 512, 4 },                                                                       // Shape of the array
-                                                      { 512 * 4 * sizeof(unsigned char), 4 * sizeof(unsigned char), sizeof(unsigned char) }, // data stride
-                                                      textureData.data());  // raw buffer data (w*h*4 array of uchars)
+    //    The array takes ownership of the texture data rather than copying it (a 512x512x4 array of uchars)
+    mGlobals["imgData"] = PythonEmbedding::exportArray(std::move(textureData), 512, 512, fromTex->getFormat());
 
     // If Python successfully transforms the input data into the NumPy arrays needed for the model training....
     mLastTrainTime = executeStringAndSetFlags( mPythonTrain );
@@ -0,0 +1,216 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "ImageCompare.h"
+#include <experimental/filesystem>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::experimental::filesystem;
+
+namespace
+{
+    const char* kImageExtensions[] = { ".png", ".jpg", ".jpeg", ".tga", ".bmp", ".hdr", ".exr", ".pfm" };
+
+    bool isImageFile(const std::string& filename)
+    {
+        for (const char* ext : kImageExtensions)
+        {
+            if (hasSuffix(filename, ext, false)) return true;
+        }
+        return false;
+    }
+
+    std::vector<std::string> getImageFiles(const std::string& path)
+    {
+        std::vector<std::string> files;
+        if (isDirectoryExists(path) == false)
+        {
+            files.push_back(path);
+            return files;
+        }
+        for (const auto& entry : fs::directory_iterator(path))
+        {
+            std::string filename = entry.path().string();
+            if (fs::is_regular_file(entry.path()) && isImageFile(filename)) files.push_back(filename);
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    std::string toString(double value)
+    {
+        std::ostringstream s;
+        s.precision(8);
+        s << value;
+        return s.str();
+    }
+}
+
+void ImageCompare::onLoad(SampleCallbacks* pSample, const RenderContext::SharedPtr& pRenderContext)
+{
+    ArgList args = pSample->getArgList();
+    if (args.argExists("metrics"))
+    {
+        mOptions.metrics = 0;
+        std::stringstream names(args["metrics"].asString());
+        std::string name;
+        while (std::getline(names, name, ','))
+        {
+            ImageMetrics::Metric metric;
+            if (ImageMetrics::findMetric(name, metric)) mOptions.metrics |= ImageMetrics::getMetricBit(metric);
+            else logWarning("ImageCompare: unknown metric '" + name + "'");
+        }
+    }
+    if (args.argExists("exposure")) mOptions.exposure = args["exposure"].asFloat();
+    if (args.argExists("ppd"))
+    {
+        // Same range as the GUI. The FLIP filters are sized from it, so a bad value would only make the comparison fail or take forever
+        float ppd = args["ppd"].asFloat();
+        mOptions.pixelsPerDegree = std::min(std::max(ppd, 1.0f), 1000.0f);
+        if (ppd != mOptions.pixelsPerDegree) logWarning("ImageCompare: pixels per degree clamped to " + std::to_string(mOptions.pixelsPerDegree));
+    }
+
+    if (args.argExists("ref") == false || args.argExists("test") == false) return;
+
+    mRefPath = args["ref"].asString();
+    mTestPath = args["test"].asString();
+    if (comparePaths(mTestPath, mRefPath))
+    {
+        logInfo(getSummary());
+        if (args.argExists("out")) writeCsv(args["out"].asString());
+    }
+    pSample->shutdown();
+}
+
+bool ImageCompare::comparePaths(const std::string& testPath, const std::string& refPath)
+{
+    std::vector<std::string> testFiles = getImageFiles(testPath);
+    std::vector<std::string> refFiles = getImageFiles(refPath);
+    if (testFiles.empty() || testFiles.size() != refFiles.size())
+    {
+        logError("ImageCompare: found " + std::to_string(testFiles.size()) + " test images and " + std::to_string(refFiles.size()) + " reference images");
+        return false;
+    }
+
+    // The frames are streamed, only the previous pair is kept in memory
+    mpMetrics = ImageMetrics::create(mOptions);
+    mFrameNames.clear();
+    for (size_t i = 0; i < testFiles.size(); i++)
+    {
+        ImageMetrics::Image test, ref;
+        if (!ImageMetrics::loadImage(testFiles[i], test) || !ImageMetrics::loadImage(refFiles[i], ref) || !mpMetrics->addFrame(std::move(test), std::move(ref)))
+        {
+            logError("ImageCompare: can't compare " + testFiles[i] + " against " + refFiles[i]);
+            return false;
+        }
+        mFrameNames.push_back(getFilenameFromPath(testFiles[i]));
+    }
+    return true;
+}
+
+bool ImageCompare::writeCsv(const std::string& filename) const
+{
+    std::ofstream file(filename);
+    if (file.fail())
+    {
+        logError("ImageCompare: can't open " + filename);
+        return false;
+    }
+
+    file << "frame";
+    for (uint32_t m = 0; m < ImageMetrics::kMetricCount; m++)
+    {
+        if (mOptions.metrics & ImageMetrics::getMetricBit(ImageMetrics::Metric(m))) file << "," << ImageMetrics::getMetricName(ImageMetrics::Metric(m));
+    }
+    file << "\n";
+
+    auto writeRow = [&](const std::string& name, const ImageMetrics::Values& values)
+    {
+        file << name;
+        for (uint32_t m = 0; m < ImageMetrics::kMetricCount; m++)
+        {
+            if (mOptions.metrics & ImageMetrics::getMetricBit(ImageMetrics::Metric(m))) file << "," << (std::isnan(values[m]) ? "" : toString(values[m]));
+        }
+        file << "\n";
+    };
+    const auto& frames = mpMetrics->getFrameValues();
+    for (size_t i = 0; i < frames.size(); i++) writeRow(mFrameNames[i], frames[i]);
+    writeRow("mean", mpMetrics->getMean());
+    return true;
+}
+
+std::string ImageCompare::getSummary() const
+{
+    if (!mpMetrics) return "";
+
+    std::string s = "Compared " + std::to_string(mpMetrics->getFrameValues().size()) + " images (exposure " + std::to_string(mOptions.exposure) + ", " + std::to_string(mOptions.pixelsPerDegree) + " ppd)";
+    ImageMetrics::Values mean = mpMetrics->getMean();
+    for (uint32_t m = 0; m < ImageMetrics::kMetricCount; m++)
+    {
+        if (std::isnan(mean[m]) == false) s += "\n" + ImageMetrics::getMetricName(ImageMetrics::Metric(m)) + ": " + toString(mean[m]);
+    }
+    return s;
+}
+
+void ImageCompare::onGuiRender(SampleCallbacks* pSample, Gui* pGui)
+{
+    pGui->addFloatVar("Exposure", mOptions.exposure, -16, 16);
+    pGui->addFloatVar("Pixels Per Degree", mOptions.pixelsPerDegree, 1, 1000);
+
+    std::string filename;
+    if (pGui->addButton("Select Reference") && openFileDialog("Image files\0*.png;*.jpg;*.jpeg;*.tga;*.bmp;*.hdr;*.exr;*.pfm\0\0", filename)) mRefPath = filename;
+    if (pGui->addButton("Select Test", true) && openFileDialog("Image files\0*.png;*.jpg;*.jpeg;*.tga;*.bmp;*.hdr;*.exr;*.pfm\0\0", filename)) mTestPath = filename;
+    pGui->addText(("Reference: " + mRefPath + "\nTest: " + mTestPath).c_str());
+
+    if (mRefPath.size() && mTestPath.size() && pGui->addButton("Compare"))
+    {
+        comparePaths(mTestPath, mRefPath);
+    }
+    if (mpMetrics && mpMetrics->getFrameValues().size())
+    {
+        pGui->addText(getSummary().c_str());
+        if (pGui->addButton("Save CSV") && saveFileDialog("CSV files\0*.csv\0\0", filename)) writeCsv(filename);
+    }
+}
+
+void ImageCompare::onFrameRender(SampleCallbacks* pSample, const RenderContext::SharedPtr& pRenderContext, const Fbo::SharedPtr& pTargetFbo)
+{
+    const glm::vec4 clearColor(0.38f, 0.52f, 0.10f, 1);
+    pRenderContext->clearFbo(pTargetFbo.get(), clearColor, 1.0f, 0, FboAttachmentType::All);
+}
+
+int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPSTR lpCmdLine, _In_ int nShowCmd)
+{
+    ImageCompare::UniquePtr pRenderer = std::make_unique<ImageCompare>();
+    SampleConfig config;
+    config.windowDesc.title = "Image Compare";
+    config.windowDesc.resizableWindow = true;
+    Sample::run(config, pRenderer);
+    return 0;
+}
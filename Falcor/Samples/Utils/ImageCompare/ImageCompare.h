@@ -0,0 +1,56 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "Falcor.h"
+#include "Utils/ImageMetrics.h"
+
+using namespace Falcor;
+
+/** Compares test images against references with the metrics in ImageMetrics, e.g., to evaluate a denoiser against high-spp renders.
+    Command line: ImageCompare.exe -ref <file or folder> -test <file or folder> [-metrics mse,relmse,smape,psnr,ssim,flip,tmse] [-exposure <stops>] [-ppd <pixels per degree>] [-out <file.csv>]
+    Folders are compared as sequences: the images are sorted by name and paired in order, so the temporal metric compares consecutive frames.
+    When paths are passed on the command line, the application exits once they are compared.
+*/
+class ImageCompare : public Renderer
+{
+public:
+    void onLoad(SampleCallbacks* pSample, const RenderContext::SharedPtr& pRenderContext) override;
+    void onFrameRender(SampleCallbacks* pSample, const RenderContext::SharedPtr& pRenderContext, const Fbo::SharedPtr& pTargetFbo) override;
+    void onGuiRender(SampleCallbacks* pSample, Gui* pGui) override;
+
+private:
+    bool comparePaths(const std::string& testPath, const std::string& refPath);
+    bool writeCsv(const std::string& filename) const;
+    std::string getSummary() const;
+
+    ImageMetrics::Options mOptions;
+    ImageMetrics::UniquePtr mpMetrics;
+    std::vector<std::string> mFrameNames;
+    std::string mTestPath;
+    std::string mRefPath;
+};
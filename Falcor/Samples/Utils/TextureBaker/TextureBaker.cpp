@@ -0,0 +1,202 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "TextureBaker.h"
+#include "Graphics/TextureHelper.h"
+#include "Utils/BcCompression.h"
+#include "Utils/ParallelFor.h"
+#include <experimental/filesystem>
+
+namespace fs = std::experimental::filesystem;
+
+namespace
+{
+    struct FormatDesc
+    {
+        const char* name;
+        ResourceFormat format;
+    };
+
+    const FormatDesc kFormats[] =
+    {
+        { "auto", ResourceFormat::Unknown },
+        { "bc1", ResourceFormat::BC1Unorm },
+        { "bc3", ResourceFormat::BC3Unorm },
+        { "bc4", ResourceFormat::BC4Unorm },
+        { "bc5", ResourceFormat::BC5Unorm },
+        { "bc6h", ResourceFormat::BC6HU16 },
+        { "bc7", ResourceFormat::BC7Unorm },
+    };
+
+    const char* kImageExtensions[] = { ".png", ".jpg", ".jpeg", ".tga", ".bmp", ".hdr", ".exr", ".pfm" };
+
+    bool isImageFile(const std::string& filename)
+    {
+        for (const char* ext : kImageExtensions)
+        {
+            if (hasSuffix(filename, ext, false)) return true;
+        }
+        return false;
+    }
+
+    std::string toMB(size_t bytes)
+    {
+        return std::to_string(double(bytes) / (1024.0 * 1024.0)) + " MB";
+    }
+}
+
+void TextureBaker::onLoad(SampleCallbacks* pSample, const RenderContext::SharedPtr& pRenderContext)
+{
+    ArgList args = pSample->getArgList();
+    if (args.argExists("format"))
+    {
+        std::string format = args["format"].asString();
+        for (uint32_t i = 0; i < arraysize(kFormats); i++)
+        {
+            if (format == kFormats[i].name) mFormat = i;
+        }
+    }
+    mSrgb = !args.argExists("linear");
+
+    std::vector<ArgList::Arg> paths = args.getValues("bake");
+    if (paths.empty()) return;
+
+    resetStats();
+    for (const auto& path : paths)
+    {
+        bakePath(path.asString());
+    }
+    logStats();
+    pSample->shutdown();
+}
+
+void TextureBaker::bakePath(const std::string& path)
+{
+    if (isDirectoryExists(path))
+    {
+        for (const auto& entry : fs::recursive_directory_iterator(path))
+        {
+            std::string filename = entry.path().string();
+            if (fs::is_regular_file(entry.path()) && isImageFile(filename)) bakeFile(filename);
+        }
+    }
+    else
+    {
+        bakeFile(path);
+    }
+}
+
+void TextureBaker::bakeFile(const std::string& filename)
+{
+    TextureBakeStats stats;
+    if (bakeTextureFile(filename, kFormats[mFormat].format, mSrgb, &stats) == false)
+    {
+        mStats.failedCount++;
+        return;
+    }
+
+    mStats.fileCount++;
+    mStats.pixelCount += uint64_t(stats.width) * stats.height;
+    mStats.uncompressedSize += stats.uncompressedSize;
+    mStats.compressedSize += stats.compressedSize;
+    mStats.encodeTime += stats.encodeTime;
+    logInfo("Baked " + filename + " (" + std::to_string(stats.width) + "x" + std::to_string(stats.height) + ", " + std::to_string(stats.mipCount) + " mips) to " + to_string(stats.format) +
+        ": " + toMB(stats.uncompressedSize) + " -> " + toMB(stats.compressedSize) + " in " + std::to_string(stats.encodeTime) + "s");
+}
+
+void TextureBaker::resetStats()
+{
+    mStats = {};
+}
+
+void TextureBaker::logStats()
+{
+    std::string msg = "Baked " + std::to_string(mStats.fileCount) + " textures";
+    if (mStats.failedCount) msg += " (" + std::to_string(mStats.failedCount) + " failed)";
+    msg += " using " + std::to_string(getParallelForThreadCount()) + " threads.\n";
+    if (mStats.encodeTime > 0)
+    {
+        msg += "Encode throughput: " + std::to_string(double(mStats.pixelCount) / 1.0e6 / mStats.encodeTime) + " MPix/s (top mip level)\n";
+    }
+    msg += "VRAM: " + toMB(mStats.uncompressedSize) + " uncompressed, " + toMB(mStats.compressedSize) + " baked, " + toMB(mStats.uncompressedSize - mStats.compressedSize) + " saved";
+    logInfo(msg);
+}
+
+void TextureBaker::onGuiRender(SampleCallbacks* pSample, Gui* pGui)
+{
+    Gui::DropdownList formats;
+    for (uint32_t i = 0; i < arraysize(kFormats); i++) formats.push_back({ (int32_t)i, kFormats[i].name });
+    pGui->addDropdown("Format", formats, mFormat);
+    pGui->addCheckBox("sRGB Mip Filtering", mSrgb);
+
+    std::string filename;
+    if (pGui->addButton("Bake File") && openFileDialog("Image files\0*.png;*.jpg;*.jpeg;*.tga;*.bmp;*.hdr;*.exr;*.pfm\0\0", filename))
+    {
+        resetStats();
+        bakeFile(filename);
+        logStats();
+    }
+    if (pGui->addButton("Bake Folder", true) && openFileDialog("Any file in the folder\0*.*\0\0", filename))
+    {
+        resetStats();
+        bakePath(getDirectoryFromFile(filename));
+        logStats();
+    }
+
+    if (mStats.fileCount)
+    {
+        std::string msg = std::to_string(mStats.fileCount) + " textures baked\n";
+        msg += "Encode: " + std::to_string(double(mStats.pixelCount) / 1.0e6 / mStats.encodeTime) + " MPix/s\n";
+        msg += "Uncompressed: " + toMB(mStats.uncompressedSize) + "\n";
+        msg += "Baked: " + toMB(mStats.compressedSize) + "\n";
+        msg += "Saved: " + toMB(mStats.uncompressedSize - mStats.compressedSize);
+        pGui->addText(msg.c_str());
+    }
+}
+
+void TextureBaker::onDroppedFile(SampleCallbacks* pSample, const std::string& filename)
+{
+    resetStats();
+    bakePath(filename);
+    logStats();
+}
+
+void TextureBaker::onFrameRender(SampleCallbacks* pSample, const RenderContext::SharedPtr& pRenderContext, const Fbo::SharedPtr& pTargetFbo)
+{
+    const glm::vec4 clearColor(0.38f, 0.52f, 0.10f, 1);
+    pRenderContext->clearFbo(pTargetFbo.get(), clearColor, 1.0f, 0, FboAttachmentType::All);
+}
+
+int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPSTR lpCmdLine, _In_ int nShowCmd)
+{
+    TextureBaker::UniquePtr pRenderer = std::make_unique<TextureBaker>();
+    SampleConfig config;
+    config.windowDesc.title = "Texture Baker";
+    config.windowDesc.resizableWindow = true;
+    Sample::run(config, pRenderer);
+    return 0;
+}
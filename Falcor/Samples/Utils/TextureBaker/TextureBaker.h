@@ -0,0 +1,63 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "Falcor.h"
+
+using namespace Falcor;
+
+/** Bakes image files into block-compressed DDS files with precomputed mips, which createTextureFromFile() then loads instead of the images.
+    Command line: TextureBaker.exe -bake <file or folder> [-bake ...] [-format auto|bc1|bc3|bc4|bc5|bc6h|bc7] [-linear]
+    When files are passed on the command line, the application exits once they are baked.
+*/
+class TextureBaker : public Renderer
+{
+public:
+    void onLoad(SampleCallbacks* pSample, const RenderContext::SharedPtr& pRenderContext) override;
+    void onFrameRender(SampleCallbacks* pSample, const RenderContext::SharedPtr& pRenderContext, const Fbo::SharedPtr& pTargetFbo) override;
+    void onGuiRender(SampleCallbacks* pSample, Gui* pGui) override;
+    void onDroppedFile(SampleCallbacks* pSample, const std::string& filename) override;
+
+private:
+    void bakePath(const std::string& path);
+    void bakeFile(const std::string& filename);
+    void resetStats();
+    void logStats();
+
+    uint32_t mFormat = 0;   ///< Index into kFormats
+    bool mSrgb = true;
+
+    struct
+    {
+        uint32_t fileCount = 0;
+        uint32_t failedCount = 0;
+        uint64_t pixelCount = 0;
+        size_t uncompressedSize = 0;
+        size_t compressedSize = 0;
+        double encodeTime = 0;
+    } mStats;
+};
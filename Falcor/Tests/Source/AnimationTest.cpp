@@ -0,0 +1,406 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "AnimationTest.h"
+#include "Utils/CpuTimer.h"
+#include "Utils/ParallelFor.h"
+#include <random>
+#include <functional>
+
+void AnimationTest::addTests()
+{
+    addTestToList<TestInterpolation>();
+    addTestToList<TestCursors>();
+    addTestToList<TestHierarchyOrder>();
+    addTestToList<TestInverseTranspose>();
+    addTestToList<TestCrowdBenchmark>();
+}
+
+static const float kDuration = 10.0f;
+static const float kTicksPerSecond = 2.0f;
+
+static glm::quat randomQuat(std::mt19937& rng)
+{
+    std::normal_distribution<float> dist;
+    glm::vec4 v(dist(rng), dist(rng), dist(rng), dist(rng));
+    v = glm::normalize(v);
+    return glm::quat(v.w, v.x, v.y, v.z);
+}
+
+static glm::vec3 randomVec(std::mt19937& rng, float minValue, float maxValue)
+{
+    std::uniform_real_distribution<float> dist(minValue, maxValue);
+    return glm::vec3(dist(rng), dist(rng), dist(rng));
+}
+
+// Random keys in [0, kDuration). Channels are occasionally left empty to cover the defaults.
+static Animation::AnimationSet createAnimationSet(std::mt19937& rng, uint32_t boneID, uint32_t keyCount)
+{
+    Animation::AnimationSet set;
+    set.boneID = boneID;
+    std::uniform_real_distribution<float> dist(0, 1);
+    auto times = [&](uint32_t count)
+    {
+        std::vector<float> t(count, 0);
+        for (uint32_t i = 1; i < count; i++) t[i] = t[i - 1] + (0.2f + dist(rng));
+        for (auto& time : t) time *= (kDuration * 0.95f) / (t.back() + 1);
+        return t;
+    };
+    bool emptyScale = (boneID % 5) == 1;
+    bool emptyTranslation = (boneID % 7) == 2;
+    for (float time : times(emptyTranslation ? 0 : keyCount)) set.translation.keys.push_back({ randomVec(rng, -2, 2), time });
+    for (float time : times(emptyScale ? 0 : keyCount / 2 + 1)) set.scaling.keys.push_back({ randomVec(rng, 0.5f, 2), time });
+    for (float time : times(keyCount)) set.rotation.keys.push_back({ randomQuat(rng), time });
+    return set;
+}
+
+// Reference implementation, written independently from the optimized path
+static glm::quat referenceSlerp(glm::quat a, glm::quat b, float t)
+{
+    double d = double(a.x) * b.x + double(a.y) * b.y + double(a.z) * b.z + double(a.w) * b.w;
+    if (d < 0)
+    {
+        d = -d;
+        b = glm::quat(-b.w, -b.x, -b.y, -b.z);
+    }
+    double wa = 1 - t, wb = t;
+    if (d < 0.9999)
+    {
+        double angle = std::acos(d);
+        wa = std::sin((1 - t) * angle) / std::sin(angle);
+        wb = std::sin(t * angle) / std::sin(angle);
+    }
+    return glm::quat(float(wa * a.w + wb * b.w), float(wa * a.x + wb * b.x), float(wa * a.y + wb * b.y), float(wa * a.z + wb * b.z));
+}
+
+static glm::vec3 rotate(const glm::quat& q, const glm::vec3& v)
+{
+    glm::vec3 u(q.x, q.y, q.z);
+    return u * (2 * glm::dot(u, v)) + v * (q.w * q.w - glm::dot(u, u)) + glm::cross(u, v) * (2 * q.w);
+}
+
+template<typename T, typename Interpolate>
+static T referenceKey(const Animation::AnimationChannel<T>& channel, float ticks, const T& defaultValue, Interpolate interpolate)
+{
+    if (channel.keys.empty()) return defaultValue;
+    size_t cur = 0;
+    for (size_t i = 0; i < channel.keys.size(); i++)
+    {
+        if (channel.keys[i].time <= ticks) cur = i;
+    }
+    size_t next = (cur + 1) % channel.keys.size();
+    float diff = channel.keys[next].time - channel.keys[cur].time;
+    if (diff < 0) diff += kDuration;
+    float ratio = (diff == 0) ? 0 : (ticks - channel.keys[cur].time) / diff;
+    return interpolate(channel.keys[cur].value, channel.keys[next].value, ratio);
+}
+
+static glm::mat4 referenceTransform(const Animation::AnimationSet& set, double time)
+{
+    float ticks = (float)fmod(time * kTicksPerSecond, kDuration);
+    auto lerp = [](const glm::vec3& a, const glm::vec3& b, float t) { return a + (b - a) * t; };
+    glm::vec3 t = referenceKey(set.translation, ticks, glm::vec3(0), lerp);
+    glm::vec3 s = referenceKey(set.scaling, ticks, glm::vec3(1), lerp);
+    glm::quat r = referenceKey(set.rotation, ticks, glm::quat(1, 0, 0, 0), referenceSlerp);
+
+    glm::mat4 m;
+    m[0] = glm::vec4(rotate(r, glm::vec3(s.x, 0, 0)), 0);
+    m[1] = glm::vec4(rotate(r, glm::vec3(0, s.y, 0)), 0);
+    m[2] = glm::vec4(rotate(r, glm::vec3(0, 0, s.z)), 0);
+    m[3] = glm::vec4(t, 1);
+    return m;
+}
+
+static float maxDifference(const glm::mat4& a, const glm::mat4& b)
+{
+    float diff = 0;
+    for (int c = 0; c < 4; c++)
+    {
+        for (int r = 0; r < 4; r++) diff = std::max(diff, std::abs(a[c][r] - b[c][r]));
+    }
+    return diff;
+}
+
+// Generic inverse using Gauss-Jordan elimination with partial pivoting
+static glm::mat4 referenceInverse(const glm::mat4& m)
+{
+    double a[4][8];
+    for (int r = 0; r < 4; r++)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            a[r][c] = m[c][r];
+            a[r][c + 4] = (r == c) ? 1 : 0;
+        }
+    }
+    for (int c = 0; c < 4; c++)
+    {
+        int pivot = c;
+        for (int r = c + 1; r < 4; r++) if (std::abs(a[r][c]) > std::abs(a[pivot][c])) pivot = r;
+        for (int k = 0; k < 8; k++) std::swap(a[c][k], a[pivot][k]);
+        double inv = 1.0 / a[c][c];
+        for (int k = 0; k < 8; k++) a[c][k] *= inv;
+        for (int r = 0; r < 4; r++)
+        {
+            if (r == c) continue;
+            double f = a[r][c];
+            for (int k = 0; k < 8; k++) a[r][k] -= f * a[c][k];
+        }
+    }
+    glm::mat4 result;
+    for (int r = 0; r < 4; r++)
+    {
+        for (int c = 0; c < 4; c++) result[c][r] = float(a[r][c + 4]);
+    }
+    return result;
+}
+
+static glm::mat4 randomAffine(std::mt19937& rng)
+{
+    Animation::AnimationSet set;
+    set.translation.keys.push_back({ randomVec(rng, -5, 5), 0 });
+    set.scaling.keys.push_back({ randomVec(rng, 0.5f, 2), 0 });
+    set.rotation.keys.push_back({ randomQuat(rng), 0 });
+    return referenceTransform(set, 0);
+}
+
+// Bones are listed children first, so a controller which evaluates in index order reads stale parent transforms
+static std::vector<Bone> createSkeleton(std::mt19937& rng, uint32_t boneCount)
+{
+    std::vector<Bone> bones(boneCount);
+    for (uint32_t i = 0; i < boneCount; i++)
+    {
+        Bone& bone = bones[i];
+        bone.boneID = i;
+        bone.name = "bone" + std::to_string(i);
+        bone.parentID = (i == boneCount - 1) ? AnimationController::kInvalidBoneID : std::uniform_int_distribution<uint32_t>(i + 1, boneCount - 1)(rng);
+        bone.offset = randomAffine(rng);
+        bone.originalLocalTransform = randomAffine(rng);
+        bone.localTransform = bone.originalLocalTransform;
+    }
+    return bones;
+}
+
+static std::vector<glm::mat4> referenceBoneMatrices(const std::vector<Bone>& bones, const std::vector<glm::mat4>& locals)
+{
+    std::vector<glm::mat4> global(bones.size());
+    std::vector<bool> done(bones.size(), false);
+    std::function<void(uint32_t)> evaluate = [&](uint32_t i)
+    {
+        if (done[i]) return;
+        global[i] = locals[i];
+        if (bones[i].parentID != AnimationController::kInvalidBoneID)
+        {
+            evaluate(bones[i].parentID);
+            global[i] = global[bones[i].parentID] * locals[i];
+        }
+        done[i] = true;
+    };
+    std::vector<glm::mat4> result(bones.size());
+    for (uint32_t i = 0; i < bones.size(); i++)
+    {
+        evaluate(i);
+        result[i] = global[i] * bones[i].offset;
+    }
+    return result;
+}
+
+testing_func(AnimationTest, TestInterpolation)
+{
+    // 13 tracks, so the last SIMD batch is partially filled
+    std::mt19937 rng(1);
+    std::vector<Animation::AnimationSet> sets;
+    for (uint32_t i = 0; i < 13; i++) sets.push_back(createAnimationSet(rng, i, 2 + i));
+    auto pAnimation = Animation::create("test", sets, kDuration, kTicksPerSecond);
+    if (pAnimation->getTrackCount() != sets.size()) return test_fail("Wrong track count");
+
+    std::vector<glm::mat4> locals(sets.size());
+    float maxError = 0;
+    for (uint32_t frame = 0; frame < 500; frame++)
+    {
+        double time = frame * (1.0 / 60.0);
+        pAnimation->evaluate(time, locals.data());
+        for (uint32_t i = 0; i < sets.size(); i++) maxError = std::max(maxError, maxDifference(locals[i], referenceTransform(sets[i], time)));
+    }
+    if (maxError > 2e-3f) return test_fail("The interpolated transforms don't match the reference");
+    return test_pass();
+}
+
+testing_func(AnimationTest, TestCursors)
+{
+    // Random jumps backwards and forwards, including long jumps which skip many keys and wrap around the loop
+    std::mt19937 rng(2);
+    std::vector<Animation::AnimationSet> sets;
+    for (uint32_t i = 0; i < 8; i++) sets.push_back(createAnimationSet(rng, i, 40));
+    auto pAnimation = Animation::create("test", sets, kDuration, kTicksPerSecond);
+
+    std::uniform_real_distribution<double> step(-1.0, 4.0);
+    std::vector<glm::mat4> locals(sets.size());
+    double time = 0;
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        time = std::max(0.0, time + step(rng) * ((i % 10) == 0 ? 1.0 : 0.05));
+        pAnimation->evaluate(time, locals.data());
+        for (uint32_t j = 0; j < sets.size(); j++)
+        {
+            if (maxDifference(locals[j], referenceTransform(sets[j], time)) > 2e-3f) return test_fail("The cached key doesn't match a full search");
+        }
+    }
+
+    // A copy gets its own cursors
+    auto pCopy = Animation::create(*pAnimation);
+    std::vector<glm::mat4> copyLocals(sets.size());
+    pCopy->evaluate(1.0, copyLocals.data());
+    pAnimation->evaluate(1.0, locals.data());
+    for (uint32_t j = 0; j < sets.size(); j++)
+    {
+        if (maxDifference(locals[j], copyLocals[j]) != 0) return test_fail("The copy evaluates differently");
+    }
+    return test_pass();
+}
+
+testing_func(AnimationTest, TestHierarchyOrder)
+{
+    std::mt19937 rng(3);
+    std::vector<Bone> bones = createSkeleton(rng, 40);
+    auto pController = AnimationController::create(bones);
+
+    const auto& order = pController->getEvaluationOrder();
+    std::vector<bool> evaluated(bones.size(), false);
+    for (uint32_t i : order)
+    {
+        if (bones[i].parentID != AnimationController::kInvalidBoneID && evaluated[bones[i].parentID] == false) return test_fail("A bone is evaluated before its parent");
+        evaluated[i] = true;
+    }
+
+    // Bind pose
+    std::vector<glm::mat4> locals;
+    for (const auto& bone : bones) locals.push_back(bone.originalLocalTransform);
+    std::vector<glm::mat4> reference = referenceBoneMatrices(bones, locals);
+    for (uint32_t i = 0; i < bones.size(); i++)
+    {
+        if (maxDifference(pController->getBoneMatrices()[i], reference[i]) > 1e-3f * (1 + std::abs(reference[i][3][0]))) return test_fail("Wrong bind pose");
+    }
+
+    // Animated, with some bones left at their bind pose
+    std::vector<Animation::AnimationSet> sets;
+    for (uint32_t i = 0; i < bones.size(); i += 2) sets.push_back(createAnimationSet(rng, i, 10));
+    pController->addAnimation(Animation::create("test", sets, kDuration, kTicksPerSecond));
+    pController->setActiveAnimation(0);
+    pController->animate(3.3);
+    for (const auto& set : sets) locals[set.boneID] = referenceTransform(set, 3.3);
+    reference = referenceBoneMatrices(bones, locals);
+    for (uint32_t i = 0; i < bones.size(); i++)
+    {
+        float scale = 1;
+        for (int c = 0; c < 4; c++) scale = std::max(scale, glm::length(reference[i][c]));
+        if (maxDifference(pController->getBoneMatrices()[i], reference[i]) > 2e-3f * scale) return test_fail("Wrong animated pose");
+    }
+    return test_pass();
+}
+
+testing_func(AnimationTest, TestInverseTranspose)
+{
+    std::mt19937 rng(4);
+    std::vector<Bone> bones = createSkeleton(rng, 16);
+    auto pController = AnimationController::create(bones);
+    for (uint32_t i = 0; i < bones.size(); i++)
+    {
+        const glm::mat4& m = pController->getBoneMatrices()[i];
+        glm::mat4 reference = glm::transpose(referenceInverse(m));
+        const glm::mat4& result = pController->getBoneInvTransposeMatrices()[i];
+        float scale = 1;
+        for (int c = 0; c < 4; c++) scale = std::max(scale, glm::length(reference[c]));
+        if (maxDifference(result, reference) > 1e-4f * scale) return test_fail("The inverse transpose doesn't match a generic inverse");
+    }
+    return test_pass();
+}
+
+testing_func(AnimationTest, TestCrowdBenchmark)
+{
+    // A crowd of skinned characters sharing a few animation clips, like a Scene with many instances of the same models
+    const uint32_t characterCount = 2000;
+    const uint32_t boneCount = 60;
+    const uint32_t keyCount = 30;
+    std::mt19937 rng(5);
+
+    std::vector<AnimationController::UniquePtr> controllers;
+    for (uint32_t clip = 0; clip < 4; clip++)
+    {
+        std::vector<Bone> bones = createSkeleton(rng, boneCount);
+        std::vector<Animation::AnimationSet> sets;
+        for (uint32_t i = 0; i < boneCount; i++) sets.push_back(createAnimationSet(rng, i, keyCount));
+        auto pController = AnimationController::create(bones);
+        pController->addAnimation(Animation::create("clip", sets, kDuration, kTicksPerSecond));
+        pController->setActiveAnimation(0);
+        controllers.push_back(std::move(pController));
+    }
+    while (controllers.size() < characterCount) controllers.push_back(AnimationController::create(*controllers[controllers.size() % 4]));
+
+    const uint32_t frameCount = 30;
+    auto timeOffset = [](uint32_t character) { return character * 0.37; };
+
+    CpuTimer timer;
+    timer.update();
+    for (uint32_t frame = 0; frame < frameCount; frame++)
+    {
+        for (uint32_t c = 0; c < characterCount; c++) controllers[c]->animate(frame / 60.0 + timeOffset(c));
+    }
+    timer.update();
+    double serialTime = timer.getElapsedTime();
+    std::vector<glm::mat4> serialResult = controllers[characterCount - 1]->getBoneMatrices();
+
+    timer.update();
+    for (uint32_t frame = 0; frame < frameCount; frame++)
+    {
+        parallelFor(characterCount, 1, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t c = begin; c < end; c++) controllers[c]->animate(frame / 60.0 + timeOffset(c));
+        });
+    }
+    timer.update();
+    double parallelTime = timer.getElapsedTime();
+
+    for (uint32_t i = 0; i < boneCount; i++)
+    {
+        if (maxDifference(serialResult[i], controllers[characterCount - 1]->getBoneMatrices()[i]) != 0) return test_fail("Parallel evaluation changed the result");
+    }
+
+    double bonesPerFrame = double(characterCount) * boneCount;
+    logInfo("Animating " + std::to_string(characterCount) + " characters with " + std::to_string(boneCount) + " bones: " +
+        std::to_string(serialTime * 1000 / frameCount) + " ms/frame serial, " + std::to_string(parallelTime * 1000 / frameCount) + " ms/frame on " +
+        std::to_string(getParallelForThreadCount()) + " threads (" + std::to_string(bonesPerFrame * frameCount / serialTime / 1e6) + "M bones/s serial)");
+    return test_pass();
+}
+
+int main()
+{
+    AnimationTest animTest;
+    animTest.init();
+    animTest.run();
+    return 0;
+}
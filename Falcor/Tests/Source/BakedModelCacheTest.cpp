@@ -0,0 +1,187 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "BakedModelCacheTest.h"
+#include <fstream>
+#include <cstdio>
+
+void BakedModelCacheTest::addTests()
+{
+    addTestToList<TestTruncatedFile>();
+    addTestToList<TestCorruptCounts>();
+    addTestToList<TestCorruptTexture>();
+}
+
+static const std::string kCacheFilename = "BakedModelCacheTest.fbake";
+static const time_t kSourceTime = 1234;
+
+template<typename T>
+static void append(std::vector<uint8_t>& file, const T& value)
+{
+    const uint8_t* pBytes = (const uint8_t*)&value;
+    file.insert(file.end(), pBytes, pBytes + sizeof(T));
+}
+
+// The header BakedModelCache writes for a model imported without flags
+static std::vector<uint8_t> createHeader()
+{
+    std::vector<uint8_t> file;
+    append(file, uint32_t(0x4B425346));    // 'FSBK'
+    append(file, uint32_t(3));             // Version
+    append(file, uint32_t(Model::LoadFlags::None));
+    append(file, int64_t(kSourceTime));
+    return file;
+}
+
+// A complete file with no textures, one material and no meshes
+static std::vector<uint8_t> createMaterialOnlyFile()
+{
+    std::vector<uint8_t> file = createHeader();
+    append(file, uint32_t(0));
+    append(file, uint32_t(1));
+    const std::string name = "Material";
+    append(file, uint32_t(name.size()));
+    file.insert(file.end(), name.begin(), name.end());
+    for (uint32_t i = 0; i < 3; i++) append(file, uint32_t(0));       // Shading model, alpha mode, double-sided
+    append(file, glm::vec4(1));                                        // Base color
+    append(file, glm::vec4(0));                                        // Specular
+    append(file, glm::vec3(0));                                        // Emissive
+    for (uint32_t i = 0; i < 4; i++) append(file, 0.5f);               // Alpha threshold, height scale and offset, IoR
+    for (uint32_t i = 0; i < 7; i++) append(file, int32_t(-1));        // No textures
+    append(file, uint32_t(0));
+    return file;
+}
+
+// A file with a single embedded texture and nothing else. dataSize is the blob size written in the file, the data itself is always 16 bytes.
+static std::vector<uint8_t> createTextureFile(uint32_t width, uint32_t height, ResourceFormat format, uint32_t mipCount, uint64_t dataSize)
+{
+    std::vector<uint8_t> file = createHeader();
+    append(file, uint32_t(1));
+    append(file, uint32_t(0));              // Embedded
+    append(file, uint32_t(0));              // No source filename
+    append(file, width);
+    append(file, height);
+    append(file, format);
+    append(file, mipCount);
+    append(file, dataSize);
+    file.resize(align_to(16, file.size()) + 16, 0xFF);
+    append(file, uint32_t(0));              // Materials
+    append(file, uint32_t(0));              // Meshes
+    return file;
+}
+
+static bool importFile(const std::vector<uint8_t>& file, uint32_t& meshCount)
+{
+    {
+        std::ofstream stream(kCacheFilename, std::ios::binary | std::ios::trunc);
+        stream.write((const char*)file.data(), file.size());
+    }
+    Model::SharedPtr pModel = Model::create();
+    bool result = BakedModelCache::import(*pModel, kCacheFilename, Model::LoadFlags::None, kSourceTime);
+    meshCount = pModel->getMeshCount();
+    std::remove(kCacheFilename.c_str());
+    return result;
+}
+
+testing_func(BakedModelCacheTest, TestTruncatedFile)
+{
+    std::vector<uint8_t> file = createMaterialOnlyFile();
+    uint32_t meshCount;
+    if (!importFile(file, meshCount)) return test_fail("A complete file was rejected");
+
+    // Every truncation is rejected, including the ones that cut a count off
+    for (size_t size = 0; size < file.size(); size++)
+    {
+        std::vector<uint8_t> truncated(file.begin(), file.begin() + size);
+        if (importFile(truncated, meshCount)) return test_fail("A file truncated to " + std::to_string(size) + " bytes was accepted");
+        if (meshCount) return test_fail("A rejected file changed the model");
+    }
+    return test_pass();
+}
+
+testing_func(BakedModelCacheTest, TestCorruptCounts)
+{
+    // A count larger than what the rest of the file can hold is rejected before it sizes anything, wherever it is
+    const uint32_t kCounts[] = { 0xFFFFFFFF, 0x10000000, 2 };
+    for (uint32_t count : kCounts)
+    {
+        for (uint32_t table = 0; table < 3; table++)
+        {
+            // Textures, materials, meshes
+            std::vector<uint8_t> file = createHeader();
+            for (uint32_t t = 0; t < table; t++) append(file, uint32_t(0));
+            append(file, count);
+            for (uint32_t t = table + 1; t < 3; t++) append(file, uint32_t(0));
+
+            uint32_t meshCount;
+            if (importFile(file, meshCount)) return test_fail("A corrupt count was accepted");
+            if (meshCount) return test_fail("A rejected file changed the model");
+        }
+    }
+    return test_pass();
+}
+
+testing_func(BakedModelCacheTest, TestCorruptTexture)
+{
+    // A 2x2 RGBA8 texture with a single mip is exactly the 16 bytes of data
+    uint32_t meshCount;
+    if (!importFile(createTextureFile(2, 2, ResourceFormat::RGBA8Unorm, 1, 16), meshCount)) return test_fail("A valid texture was rejected");
+
+    // Descriptions that don't match the data are rejected before anything is uploaded
+    struct
+    {
+        uint32_t width, height;
+        ResourceFormat format;
+        uint32_t mipCount;
+        uint64_t dataSize;
+        const char* desc;
+    } kCorrupt[] =
+    {
+        { 2, 2, ResourceFormat::RGBA8Unorm, 1, 12, "a short blob" },
+        { 4, 4, ResourceFormat::RGBA8Unorm, 1, 16, "a larger texture" },
+        { 2, 2, ResourceFormat::RGBA32Float, 1, 16, "a larger format" },
+        { 2, 2, ResourceFormat::RGBA8Unorm, 3, 16, "too many mips" },
+        { 2, 2, ResourceFormat::RGBA8Unorm, 0, 16, "no mips" },
+        { 0, 4, ResourceFormat::RGBA8Unorm, 1, 0, "an empty texture" },
+        { 2, 2, ResourceFormat(0xFFFF), 1, 16, "an invalid format" },
+        { 2, 2, ResourceFormat::BC1Unorm, 1, 16, "a compressed format" },
+        { 2, 2, ResourceFormat::RGBA8Unorm, 1, ~0ull - 8, "a blob size that overflows" },
+    };
+    for (const auto& c : kCorrupt)
+    {
+        if (importFile(createTextureFile(c.width, c.height, c.format, c.mipCount, c.dataSize), meshCount)) return test_fail(std::string("A texture with ") + c.desc + " was accepted");
+    }
+    return test_pass();
+}
+
+int main()
+{
+    BakedModelCacheTest bmct;
+    bmct.init();
+    bmct.run();
+    return 0;
+}
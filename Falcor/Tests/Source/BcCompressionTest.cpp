@@ -0,0 +1,211 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "BcCompressionTest.h"
+#include "Utils/CpuTimer.h"
+#include <random>
+#include <cmath>
+
+void BcCompressionTest::addTests()
+{
+    addTestToList<TestBlockSizes>();
+    addTestToList<TestRoundTripQuality>();
+    addTestToList<TestSolidColorExact>();
+    addTestToList<TestMipGeneration>();
+    addTestToList<TestEncodeThroughput>();
+}
+
+static const ResourceFormat kFormats[] = { ResourceFormat::BC1Unorm, ResourceFormat::BC3Unorm, ResourceFormat::BC4Unorm, ResourceFormat::BC5Unorm, ResourceFormat::BC6HU16, ResourceFormat::BC7Unorm };
+static const char* kFormatNames[] = { "BC1", "BC3", "BC4", "BC5", "BC6H", "BC7" };
+
+// Smooth gradients with some noise, similar to the content of a typical material texture
+static std::vector<uint8_t> createTestImage(ResourceFormat format, uint32_t width, uint32_t height, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> noise(-0.03f, 0.03f);
+    bool isFloat = BcCompression::getUncompressedFormat(format) == ResourceFormat::RGBA32Float;
+    std::vector<uint8_t> image(size_t(width) * height * (isFloat ? 16 : 4));
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            float u = (float)x / width, v = (float)y / height;
+            float color[4] = { u, v, 0.5f + 0.5f * std::sin(6.0f * u + 3.0f * v), 0.25f + 0.5f * u * v };
+            size_t texel = size_t(y) * width + x;
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                float value = std::min(std::max(color[c] + noise(rng), 0.0f), 1.0f);
+                if (isFloat) ((float*)image.data())[texel * 4 + c] = value * 16.0f;   // HDR range
+                else image[texel * 4 + c] = (uint8_t)std::lround(value * 255.0f);
+            }
+        }
+    }
+    return image;
+}
+
+// PSNR over the channels the format stores. For float images the error is measured relative to the peak value.
+static float computePsnr(ResourceFormat format, uint32_t width, uint32_t height, const std::vector<uint8_t>& reference, const std::vector<uint8_t>& result)
+{
+    uint32_t channels = 4;
+    if (format == ResourceFormat::BC1Unorm || format == ResourceFormat::BC6HU16) channels = 3;
+    if (format == ResourceFormat::BC4Unorm) channels = 1;
+    if (format == ResourceFormat::BC5Unorm) channels = 2;
+
+    bool isFloat = (format == ResourceFormat::BC6HU16);
+    double mse = 0;
+    size_t texelCount = size_t(width) * height;
+    for (size_t i = 0; i < texelCount; i++)
+    {
+        for (uint32_t c = 0; c < channels; c++)
+        {
+            double a = isFloat ? ((const float*)reference.data())[i * 4 + c] : reference[i * 4 + c];
+            double b = isFloat ? ((const float*)result.data())[i * 4 + c] : result[i * 4 + c];
+            mse += (a - b) * (a - b);
+        }
+    }
+    mse /= double(texelCount * channels);
+    double peak = isFloat ? 16.0 : 255.0;
+    return mse == 0 ? 100.0f : (float)(10.0 * std::log10(peak * peak / mse));
+}
+
+testing_func(BcCompressionTest, TestBlockSizes)
+{
+    // Non multiple-of-4 sizes round up to whole blocks
+    const uint32_t sizes[][2] = { { 1, 1 }, { 4, 4 }, { 5, 3 }, { 17, 9 } };
+    for (uint32_t f = 0; f < arraysize(kFormats); f++)
+    {
+        uint32_t blockSize = (kFormats[f] == ResourceFormat::BC1Unorm || kFormats[f] == ResourceFormat::BC4Unorm) ? 8 : 16;
+        for (const auto& size : sizes)
+        {
+            std::vector<uint8_t> image = createTestImage(kFormats[f], size[0], size[1], 1);
+            std::vector<uint8_t> blocks = BcCompression::compress(kFormats[f], size[0], size[1], image.data());
+            size_t expected = size_t((size[0] + 3) / 4) * ((size[1] + 3) / 4) * blockSize;
+            if (blocks.size() != expected || BcCompression::getCompressedSize(kFormats[f], size[0], size[1]) != expected)
+            {
+                return test_fail(std::string(kFormatNames[f]) + " produced the wrong number of blocks");
+            }
+            if (BcCompression::decompress(kFormats[f], size[0], size[1], blocks.data()).size() != image.size())
+            {
+                return test_fail(std::string(kFormatNames[f]) + " decompressed to the wrong size");
+            }
+        }
+    }
+    return test_pass();
+}
+
+testing_func(BcCompressionTest, TestRoundTripQuality)
+{
+    // Conservative lower bounds. Quality regressions in the encoder show up as several dB drops.
+    const float kMinPsnr[] = { 32.0f, 32.0f, 38.0f, 38.0f, 33.0f, 34.0f };
+    const uint32_t kSize = 128;
+    for (uint32_t f = 0; f < arraysize(kFormats); f++)
+    {
+        std::vector<uint8_t> image = createTestImage(kFormats[f], kSize, kSize, 2);
+        std::vector<uint8_t> blocks = BcCompression::compress(kFormats[f], kSize, kSize, image.data());
+        std::vector<uint8_t> result = BcCompression::decompress(kFormats[f], kSize, kSize, blocks.data());
+        float psnr = computePsnr(kFormats[f], kSize, kSize, image, result);
+        logInfo(std::string(kFormatNames[f]) + " PSNR " + std::to_string(psnr) + " dB");
+        if (psnr < kMinPsnr[f])
+        {
+            return test_fail(std::string(kFormatNames[f]) + " round-trip quality is too low (" + std::to_string(psnr) + " dB)");
+        }
+    }
+    return test_pass();
+}
+
+testing_func(BcCompressionTest, TestSolidColorExact)
+{
+    // A color which is exactly representable in RGB565 and, having only odd values, with a single BC7 P-bit.
+    // It must survive a round-trip unchanged.
+    const uint8_t rgba[4] = { 255, 65, 33, 255 };
+    std::vector<uint8_t> image(8 * 8 * 4);
+    for (size_t i = 0; i < image.size(); i++) image[i] = rgba[i % 4];
+
+    for (ResourceFormat format : { ResourceFormat::BC1Unorm, ResourceFormat::BC3Unorm, ResourceFormat::BC7Unorm })
+    {
+        std::vector<uint8_t> blocks = BcCompression::compress(format, 8, 8, image.data());
+        std::vector<uint8_t> result = BcCompression::decompress(format, 8, 8, blocks.data());
+        if (result != image) return test_fail("Solid color block is not reproduced exactly");
+    }
+
+    std::vector<float> hdr(8 * 8 * 4);
+    for (size_t i = 0; i < hdr.size(); i++) hdr[i] = (i % 4 == 3) ? 1.0f : 0.0f;
+    std::vector<uint8_t> blocks = BcCompression::compress(ResourceFormat::BC6HU16, 8, 8, hdr.data());
+    std::vector<uint8_t> result = BcCompression::decompress(ResourceFormat::BC6HU16, 8, 8, blocks.data());
+    if (std::memcmp(result.data(), hdr.data(), result.size()) != 0) return test_fail("BC6H doesn't preserve black");
+
+    return test_pass();
+}
+
+testing_func(BcCompressionTest, TestMipGeneration)
+{
+    // A 2x2 checker of black and white averages to mid-gray in linear space, which is 188 in sRGB
+    const uint8_t checker[16] = { 0, 0, 0, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0, 0, 0, 255 };
+    std::vector<uint8_t> linear = BcCompression::generateMipLevel(ResourceFormat::RGBA8Unorm, 2, 2, checker, false);
+    std::vector<uint8_t> srgb = BcCompression::generateMipLevel(ResourceFormat::RGBA8Unorm, 2, 2, checker, true);
+    if (linear.size() != 4 || linear[0] != 128 || linear[3] != 255) return test_fail("Linear mip filter is wrong");
+    if (srgb.size() != 4 || srgb[0] != 188 || srgb[3] != 255) return test_fail("sRGB mip filter doesn't filter in linear space");
+
+    // Odd sizes: 5x3 -> 2x1 -> 1x1
+    std::vector<float> image(5 * 3 * 4, 2.0f);
+    std::vector<uint8_t> mip1 = BcCompression::generateMipLevel(ResourceFormat::RGBA32Float, 5, 3, image.data(), false);
+    if (mip1.size() != 2 * 1 * 16) return test_fail("Wrong mip size for odd dimensions");
+    std::vector<uint8_t> mip2 = BcCompression::generateMipLevel(ResourceFormat::RGBA32Float, 2, 1, mip1.data(), false);
+    if (mip2.size() != 16 || ((const float*)mip2.data())[0] != 2.0f) return test_fail("Wrong 1x1 mip");
+
+    // The last column of an odd width isn't dropped: 3x2 with a bright last column -> 1x1 averaging all 6 texels
+    std::vector<float> edge(3 * 2 * 4, 0.0f);
+    for (uint32_t y = 0; y < 2; y++) edge[(y * 3 + 2) * 4] = 3.0f;
+    std::vector<uint8_t> edgeMip = BcCompression::generateMipLevel(ResourceFormat::RGBA32Float, 3, 2, edge.data(), false);
+    if (edgeMip.size() != 16 || ((const float*)edgeMip.data())[0] != 1.0f) return test_fail("The last column of an odd width isn't folded into the mip");
+
+    return test_pass();
+}
+
+testing_func(BcCompressionTest, TestEncodeThroughput)
+{
+    const uint32_t kSize = 1024;
+    for (uint32_t f = 0; f < arraysize(kFormats); f++)
+    {
+        std::vector<uint8_t> image = createTestImage(kFormats[f], kSize, kSize, 3);
+        auto start = CpuTimer::getCurrentTimePoint();
+        std::vector<uint8_t> blocks = BcCompression::compress(kFormats[f], kSize, kSize, image.data());
+        double ms = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+        double mpixPerSec = (double(kSize) * kSize / 1e6) / (ms / 1000.0);
+        float ratio = (float)image.size() / blocks.size();
+        logInfo(std::string(kFormatNames[f]) + " encode: " + std::to_string(mpixPerSec) + " MPix/s, " + std::to_string(ratio) + ":1 compression");
+    }
+    return test_pass();
+}
+
+int main()
+{
+    BcCompressionTest bct;
+    bct.init();
+    bct.run();
+    return 0;
+}
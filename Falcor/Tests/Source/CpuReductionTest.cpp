@@ -0,0 +1,172 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "CpuReductionTest.h"
+#include "Utils/CpuTimer.h"
+#include <random>
+#include <cmath>
+
+void CpuReductionTest::addTests()
+{
+    addTestToList<TestKnownValues>();
+    addTestToList<TestModesAgree>();
+    addTestToList<TestMinMaxSkipsClearedDepth>();
+    addTestToList<TestHistogramBins>();
+    addTestToList<TestThroughput>();
+}
+
+static const CpuReduction::Mode kModes[] = { CpuReduction::Mode::Scalar, CpuReduction::Mode::Simd, CpuReduction::Mode::Parallel };
+
+static std::vector<float> createRandomImage(uint32_t width, uint32_t height, uint32_t channelCount, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(0.0f, 4.0f);
+    std::vector<float> data(size_t(width) * height * channelCount);
+    for (auto& v : data) v = dist(rng);
+    return data;
+}
+
+static bool isClose(float a, float b, float relTolerance)
+{
+    return std::abs(a - b) <= relTolerance * std::max(1.0f, std::max(std::abs(a), std::abs(b)));
+}
+
+testing_func(CpuReductionTest, TestKnownValues)
+{
+    // 2x2 RGB image. Alpha is missing and must read as 1.
+    const float data[] = { 1, 2, 3,   3, 2, 1,   0, 0, 0,   4, 4, 4 };
+    for (auto mode : kModes)
+    {
+        ReductionResult sum = CpuReduction::reduce(ReductionType::Sum, data, 2, 2, 3, HistogramRange(), mode);
+        if (sum.value != glm::vec4(8, 8, 8, 4)) return test_fail("Wrong sum");
+
+        ReductionResult mean = CpuReduction::reduce(ReductionType::Mean, data, 2, 2, 3, HistogramRange(), mode);
+        if (mean.value != glm::vec4(2, 2, 2, 1)) return test_fail("Wrong mean");
+
+        ReductionResult variance = CpuReduction::reduce(ReductionType::Variance, data, 2, 2, 3, HistogramRange(), mode);
+        if (variance.mean != glm::vec4(2, 2, 2, 1)) return test_fail("Wrong variance mean");
+        // Red: (1, 3, 0, 4) -> E[x^2] = 26/4, mean^2 = 4
+        if (!isClose(variance.value.x, 2.5f, 1e-6f) || !isClose(variance.value.y, 2.0f, 1e-6f) || variance.value.w != 0) return test_fail("Wrong variance");
+    }
+
+    // Constant luminance: the log average is the luminance itself
+    std::vector<float> gray(64 * 64 * 4, 0.5f);
+    ReductionResult logAvg = CpuReduction::reduce(ReductionType::LogAverageLuminance, gray.data(), 64, 64, 4);
+    if (!isClose(logAvg.value.x, 0.5f + kLuminanceEpsilon, 1e-5f)) return test_fail("Wrong log-average luminance");
+    return test_pass();
+}
+
+testing_func(CpuReductionTest, TestModesAgree)
+{
+    // Odd sizes, so the SIMD remainders and the partial last chunk get exercised
+    const uint32_t w = 1037, h = 611;
+    for (uint32_t channelCount = 1; channelCount <= 4; channelCount++)
+    {
+        std::vector<float> data = createRandomImage(w, h, channelCount, channelCount);
+        for (auto type : { ReductionType::MinMax, ReductionType::Sum, ReductionType::Mean, ReductionType::Variance, ReductionType::LogAverageLuminance, ReductionType::Histogram })
+        {
+            ReductionResult ref = CpuReduction::reduce(type, data.data(), w, h, channelCount, HistogramRange(), CpuReduction::Mode::Scalar);
+            for (auto mode : { CpuReduction::Mode::Simd, CpuReduction::Mode::Parallel })
+            {
+                ReductionResult r = CpuReduction::reduce(type, data.data(), w, h, channelCount, HistogramRange(), mode);
+                if (!r.valid) return test_fail("Result is not valid");
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    // Sums are accumulated per row in float by the SIMD path
+                    if (!isClose(r.value[c], ref.value[c], 1e-5f) || !isClose(r.mean[c], ref.mean[c], 1e-5f)) return test_fail("Modes disagree");
+                }
+                if (r.histogram != ref.histogram) return test_fail("Histograms disagree");
+            }
+        }
+    }
+    return test_pass();
+}
+
+testing_func(CpuReductionTest, TestMinMaxSkipsClearedDepth)
+{
+    const uint32_t w = 67, h = 33;
+    for (auto mode : kModes)
+    {
+        std::vector<float> depth(w * h, 1.0f);
+        ReductionResult empty = CpuReduction::reduce(ReductionType::MinMax, depth.data(), w, h, 1, HistogramRange(), mode);
+        if (empty.value != glm::vec4(1, 0, 0, 0)) return test_fail("A cleared depth buffer should return the initial range");
+
+        depth[5 * w + 66] = 0.25f;
+        depth[32 * w + 3] = 0.75f;
+        ReductionResult range = CpuReduction::reduce(ReductionType::MinMax, depth.data(), w, h, 1, HistogramRange(), mode);
+        if (range.value != glm::vec4(0.25f, 0.75f, 0, 0)) return test_fail("Wrong depth range");
+    }
+    return test_pass();
+}
+
+testing_func(CpuReductionTest, TestHistogramBins)
+{
+    HistogramRange range;
+    range.minLog2 = -8;
+    range.maxLog2 = 8;
+    // 16 stops over 256 bins: 16 bins per stop
+    if (CpuReduction::getHistogramBin(0.0f, range) != 0) return test_fail("Black should go to the first bin");
+    if (CpuReduction::getHistogramBin(1e-6f, range) != 0) return test_fail("Values below the range should go to the first bin");
+    if (CpuReduction::getHistogramBin(1e6f, range) != kHistogramBinCount - 1) return test_fail("Values above the range should go to the last bin");
+    if (CpuReduction::getHistogramBin(1.0f, range) != 128) return test_fail("Wrong bin for 1");
+    if (CpuReduction::getHistogramBin(2.0f, range) != 144) return test_fail("Wrong bin for 2");
+    if (CpuReduction::getHistogramBin(std::nanf(""), range) != 0) return test_fail("NaN should go to the first bin");
+
+    const uint32_t w = 300, h = 200;
+    std::vector<float> data = createRandomImage(w, h, 3, 7);
+    ReductionResult r = CpuReduction::reduce(ReductionType::Histogram, data.data(), w, h, 3, range);
+    if (r.histogram.size() != kHistogramBinCount) return test_fail("Wrong bin count");
+    uint64_t total = 0;
+    for (auto b : r.histogram) total += b;
+    if (total != w * h) return test_fail("Every texel should be counted once");
+    return test_pass();
+}
+
+testing_func(CpuReductionTest, TestThroughput)
+{
+    const uint32_t w = 1920, h = 1080;
+    std::vector<float> data = createRandomImage(w, h, 4, 11);
+    std::string msg = "1080p RGBA32F reduction:";
+    for (auto mode : kModes)
+    {
+        CpuTimer timer;
+        timer.update();
+        CpuReduction::reduce(ReductionType::Variance, data.data(), w, h, 4, HistogramRange(), mode);
+        timer.update();
+        msg += std::string(mode == CpuReduction::Mode::Scalar ? " scalar " : (mode == CpuReduction::Mode::Simd ? ", SIMD " : ", parallel ")) + std::to_string(timer.getElapsedTime() * 1000) + "ms";
+    }
+    logInfo(msg);
+    return test_pass();
+}
+
+int main()
+{
+    CpuReductionTest crt;
+    crt.init();
+    crt.run();
+    return 0;
+}
@@ -0,0 +1,189 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "DescriptorTableCacheTest.h"
+#include "Utils/CpuTimer.h"
+#include <random>
+
+using Cache = DescriptorTableCache<uint32_t>;
+
+void DescriptorTableCacheTest::addTests()
+{
+    addTestToList<TestLookup>();
+    addTestToList<TestEviction>();
+    addTestToList<TestRebindPattern>();
+    addTestToList<TestPerformance>();
+}
+
+// The views stand in for the SRVs and UAVs a set references
+using View = std::shared_ptr<int>;
+
+static DescriptorTableKey createKey(uint64_t layout, const std::vector<View>& views)
+{
+    DescriptorTableKey key;
+    key.add(layout);
+    for (const auto& v : views) key.add(v.get());
+    return key;
+}
+
+static std::vector<std::shared_ptr<const void>> getRefs(const std::vector<View>& views)
+{
+    return std::vector<std::shared_ptr<const void>>(views.begin(), views.end());
+}
+
+testing_func(DescriptorTableCacheTest, TestLookup)
+{
+    Cache cache;
+    View a = std::make_shared<int>(0);
+    View b = std::make_shared<int>(1);
+
+    if (cache.find(createKey(0, { a, b }), 1)) return test_fail("Empty cache returned a table");
+    cache.insert(createKey(0, { a, b }), 7, getRefs({ a, b }), 1);
+
+    const uint32_t* pTable = cache.find(createKey(0, { a, b }), 2);
+    if (!pTable || *pTable != 7) return test_fail("Cached table not found");
+
+    // Order, layout and length are part of the key
+    if (cache.find(createKey(0, { b, a }), 2)) return test_fail("Views in a different order matched");
+    if (cache.find(createKey(1, { a, b }), 2)) return test_fail("A different layout matched");
+    if (cache.find(createKey(0, { a }), 2)) return test_fail("A shorter key matched");
+
+    // Inserting an existing key replaces the table
+    cache.insert(createKey(0, { a, b }), 8, getRefs({ a, b }), 2);
+    pTable = cache.find(createKey(0, { a, b }), 2);
+    if (!pTable || *pTable != 8 || cache.getEntryCount() != 1) return test_fail("The table wasn't replaced");
+
+    const auto& stats = cache.getStats();
+    if (stats.lookupCount != 6 || stats.hitCount != 2 || stats.insertCount != 2) return test_fail("Wrong statistics");
+    return test_pass();
+}
+
+testing_func(DescriptorTableCacheTest, TestEviction)
+{
+    Cache cache(4, 2);
+    std::vector<View> views;
+    for (uint32_t i = 0; i < 6; i++) views.push_back(std::make_shared<int>(i));
+    std::weak_ptr<int> pFirst = views[0];
+
+    // The least recently used entry is evicted when the cache is full
+    for (uint32_t i = 0; i < 4; i++) cache.insert(createKey(0, { views[i] }), i, getRefs({ views[i] }), 1);
+    cache.find(createKey(0, { views[0] }), 1);
+    cache.insert(createKey(0, { views[4] }), 4, getRefs({ views[4] }), 1);
+    if (cache.getEntryCount() != 4 || cache.getStats().capacityEvictionCount != 1) return test_fail("The cache grew beyond its size");
+    if (!cache.find(createKey(0, { views[0] }), 1) || cache.find(createKey(0, { views[1] }), 1)) return test_fail("The wrong entry was evicted");
+
+    // Entries not used for more than maxAge fence values are retired together. Views are kept alive while cached.
+    cache.find(createKey(0, { views[4] }), 3);
+    views[0] = nullptr;
+    if (pFirst.expired()) return test_fail("A cached view was released");
+    cache.evictStale(5);
+    if (cache.getEntryCount() != 1 || cache.getStats().staleEvictionCount != 3) return test_fail("Stale entries weren't retired");
+    if (!pFirst.expired()) return test_fail("An evicted view wasn't released");
+    if (!cache.find(createKey(0, { views[4] }), 5)) return test_fail("A recently used entry was retired");
+
+    cache.clear();
+    if (cache.getEntryCount() != 0 || cache.find(createKey(0, { views[4] }), 5)) return test_fail("The cache wasn't cleared");
+    return test_pass();
+}
+
+testing_func(DescriptorTableCacheTest, TestRebindPattern)
+{
+    // Simulates the SVGF a-trous passes: every iteration rebinds one of two ping-pong textures with the same normals, each frame
+    Cache cache;
+    View normals = std::make_shared<int>(0);
+    View pingPong[2] = { std::make_shared<int>(1), std::make_shared<int>(2) };
+    View perFrameCb;
+
+    const uint32_t kFrames = 100;
+    const uint32_t kIterations = 5;
+    uint32_t tableCount = 0;
+    for (uint64_t frame = 1; frame <= kFrames; frame++)
+    {
+        // The constant buffer changes every frame, so its set can't be reused
+        perFrameCb = std::make_shared<int>(3);
+        for (uint32_t i = 0; i < kIterations; i++)
+        {
+            std::vector<View> textures = { pingPong[i & 1], normals };
+            std::vector<View> constants = { perFrameCb };
+            for (const auto& views : { textures, constants })
+            {
+                DescriptorTableKey key = createKey(views.size(), views);
+                if (cache.find(key, frame) == nullptr) cache.insert(key, tableCount++, getRefs(views), frame);
+            }
+        }
+        cache.evictStale(frame);
+    }
+
+    // Two texture tables in total, and one constant table per frame
+    const auto& stats = cache.getStats();
+    if (tableCount != 2 + kFrames) return test_fail("Wrong number of tables created: " + std::to_string(tableCount));
+    logInfo("Table cache hit rate for the a-trous pattern: " + std::to_string(stats.getHitRate()));
+    if (stats.getHitRate() < 0.89f) return test_fail("Low hit rate");
+    if (cache.getEntryCount() > 2 + 9 + 1) return test_fail("Stale per-frame tables weren't retired");
+    return test_pass();
+}
+
+testing_func(DescriptorTableCacheTest, TestPerformance)
+{
+    Cache cache;
+    std::vector<View> views;
+    for (uint32_t i = 0; i < 256; i++) views.push_back(std::make_shared<int>(i));
+
+    // Sets of 4 to 16 views drawn from a small pool, as in a scene rebinding material textures
+    std::mt19937 rng(4321);
+    std::vector<DescriptorTableKey> keys(2048);
+    std::vector<std::vector<View>> keyViews(keys.size());
+    for (size_t k = 0; k < keys.size(); k++)
+    {
+        uint32_t count = 4 + rng() % 13;
+        for (uint32_t v = 0; v < count; v++) keyViews[k].push_back(views[rng() % views.size()]);
+        keys[k] = createKey(count, keyViews[k]);
+    }
+
+    const uint32_t kLookups = 1000000;
+    auto start = CpuTimer::getCurrentTimePoint();
+    for (uint32_t i = 0; i < kLookups; i++)
+    {
+        uint32_t k = rng() % keys.size();
+        uint64_t fence = i / 1000;
+        if (cache.find(keys[k], fence) == nullptr) cache.insert(keys[k], k, getRefs(keyViews[k]), fence);
+        if ((i % 1000) == 0) cache.evictStale(fence);
+    }
+    double ms = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+    logInfo("DescriptorTableCache: " + std::to_string(ms * 1e6 / kLookups) + "ns per lookup, hit rate " + std::to_string(cache.getStats().getHitRate()));
+
+    // Timings are noisy, so this only reports them
+    return test_pass();
+}
+
+int main()
+{
+    DescriptorTableCacheTest dtct;
+    dtct.init();
+    dtct.run();
+    return 0;
+}
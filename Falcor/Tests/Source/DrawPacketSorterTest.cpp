@@ -0,0 +1,129 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "DrawPacketSorterTest.h"
+#include <random>
+
+void DrawPacketSorterTest::addTests()
+{
+    addTestToList<TestKeyLayout>();
+    addTestToList<TestSortOrder>();
+    addTestToList<TestStability>();
+}
+
+testing_func(DrawPacketSorterTest, TestKeyLayout)
+{
+    uint64_t key = DrawPacketSorter::createKey(3, 1234, 156789, 2345, 0.5f);
+    if (DrawPacketSorter::getPass(key) != 3 || DrawPacketSorter::getMaterialID(key) != 1234 || DrawPacketSorter::getVaoID(key) != 156789 || DrawPacketSorter::getInstanceID(key) != 2345)
+    {
+        return test_fail("Fields don't round-trip through the key");
+    }
+
+    uint32_t maxBucket = (1u << DrawPacketSorter::kDepthBits) - 1;
+    if (DrawPacketSorter::getDepthBucket(DrawPacketSorter::createKey(0, 0, 0, 0, -1.0f)) != 0 || DrawPacketSorter::getDepthBucket(DrawPacketSorter::createKey(0, 0, 0, 0, 2.0f)) != maxBucket)
+    {
+        return test_fail("Depth isn't clamped to [0, 1]");
+    }
+
+    // Each field must dominate all the less significant ones
+    if (DrawPacketSorter::createKey(1, 0, 0, 0, 0) <= DrawPacketSorter::createKey(0, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 1) ||
+        DrawPacketSorter::createKey(0, 1, 0, 0, 0) <= DrawPacketSorter::createKey(0, 0, 0xFFFFFFFF, 0xFFFFFFFF, 1) ||
+        DrawPacketSorter::createKey(0, 0, 1, 0, 0) <= DrawPacketSorter::createKey(0, 0, 0, 0xFFFFFFFF, 1) ||
+        DrawPacketSorter::createKey(0, 0, 0, 1, 0) <= DrawPacketSorter::createKey(0, 0, 0, 0, 1))
+    {
+        return test_fail("Key fields overlap");
+    }
+
+    return test_pass();
+}
+
+testing_func(DrawPacketSorterTest, TestSortOrder)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint32_t> material(0, 31);
+    std::uniform_int_distribution<uint32_t> vao(0, 255);
+    std::uniform_int_distribution<uint32_t> instance(0, 63);
+    std::uniform_real_distribution<float> depth(0, 1);
+
+    DrawPacketSorter sorter;
+    std::vector<uint64_t> keys;
+    for (uint32_t i = 0; i < 10000; i++)
+    {
+        uint64_t key = DrawPacketSorter::createKey(i % 2, material(rng), vao(rng), instance(rng), depth(rng));
+        keys.push_back(key);
+        sorter.addPacket(key, i);
+    }
+    sorter.sort();
+
+    std::vector<uint64_t> expected = keys;
+    std::sort(expected.begin(), expected.end());
+    for (uint32_t i = 0; i < sorter.getCount(); i++)
+    {
+        if (sorter.getKey(i) != expected[i]) return test_fail("Keys are not sorted");
+        if (keys[sorter.getPayload(i)] != sorter.getKey(i)) return test_fail("Payload got separated from its key");
+    }
+
+    // Reuse after clear()
+    sorter.clear();
+    sorter.addPacket(5, 0);
+    sorter.addPacket(1, 1);
+    sorter.sort();
+    if (sorter.getCount() != 2 || sorter.getPayload(0) != 1 || sorter.getPayload(1) != 0)
+    {
+        return test_fail("Sorting after clear() failed");
+    }
+
+    return test_pass();
+}
+
+testing_func(DrawPacketSorterTest, TestStability)
+{
+    // Equal keys must keep the order they were added in. Only a few digits differ, so most radix passes are skipped
+    DrawPacketSorter sorter;
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        sorter.addPacket(DrawPacketSorter::createKey(0, (i * 7) % 3, 0, 0, 0), i);
+    }
+    sorter.sort();
+
+    for (uint32_t i = 1; i < sorter.getCount(); i++)
+    {
+        if (sorter.getKey(i) == sorter.getKey(i - 1) && sorter.getPayload(i) < sorter.getPayload(i - 1))
+        {
+            return test_fail("Sort is not stable");
+        }
+    }
+    return test_pass();
+}
+
+int main()
+{
+    DrawPacketSorterTest dpst;
+    dpst.init();
+    dpst.run();
+    return 0;
+}
@@ -0,0 +1,219 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "DynamicResolutionTest.h"
+#include <random>
+#include <deque>
+
+void DynamicResolutionTest::addTests()
+{
+    addTestToList<TestConvergesUnderBudget>();
+    addTestToList<TestSpikeDropsImmediately>();
+    addTestToList<TestUpscaleHysteresis>();
+    addTestToList<TestCameraPanTrace>();
+    addTestToList<TestLimitsAndRenderSize>();
+}
+
+// Replays a trace of full-resolution frame costs through the controller. The simulated frame time scales with the pixel count plus a fixed part,
+// and the timings reach the controller kLatency frames late, like GPU timer queries.
+struct TraceResult
+{
+    std::vector<float> scales;      // Scale used for each frame
+    std::vector<float> frameTimes;  // Simulated time of each frame
+    uint32_t scaleChanges(size_t firstFrame) const
+    {
+        uint32_t changes = 0;
+        for (size_t i = std::max<size_t>(firstFrame, 1); i < scales.size(); i++) changes += (scales[i] != scales[i - 1]) ? 1 : 0;
+        return changes;
+    }
+};
+
+static const uint32_t kLatency = 2;
+
+static TraceResult replay(DynamicResolutionController& controller, const std::vector<float>& fullResCosts, float fixedCost, float noise, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> noiseDist(1 - noise, 1 + noise);
+    std::deque<std::pair<float, float>> pending;
+    TraceResult result;
+    for (float cost : fullResCosts)
+    {
+        float scale = controller.getScale();
+        float frameTime = (fixedCost + cost * scale * scale) * noiseDist(rng);
+        result.scales.push_back(scale);
+        result.frameTimes.push_back(frameTime);
+        pending.push_back({ frameTime, scale });
+        if (pending.size() > kLatency)
+        {
+            controller.update(pending.front().first, pending.front().second);
+            pending.pop_front();
+        }
+    }
+    return result;
+}
+
+static DynamicResolutionController::Desc createDesc()
+{
+    DynamicResolutionController::Desc desc;
+    desc.targetFrameTime = 16.0f;
+    return desc;
+}
+
+testing_func(DynamicResolutionTest, TestConvergesUnderBudget)
+{
+    // 25 ms at full resolution, with 5% noise
+    DynamicResolutionController controller(createDesc());
+    TraceResult result = replay(controller, std::vector<float>(600, 24.0f), 1.0f, 0.05f, 1);
+
+    if (result.scales[60] >= 1.0f) return test_fail("The scale should have dropped");
+    if (result.scaleChanges(60) != 0) return test_fail("The scale keeps changing after it settled");
+    uint32_t overBudget = 0;
+    for (size_t i = 60; i < result.frameTimes.size(); i++) overBudget += (result.frameTimes[i] > 16.0f) ? 1 : 0;
+    if (overBudget != 0) return test_fail("Frames are over budget after it settled");
+
+    // It shouldn't give away more than a couple of steps below the best scale
+    float bestScale = std::sqrt((16.0f * 0.85f - 1.0f) / 24.0f);
+    if (result.scales.back() < bestScale - 2 * createDesc().scaleStep) return test_fail("The scale is too conservative");
+    return test_pass();
+}
+
+testing_func(DynamicResolutionTest, TestSpikeDropsImmediately)
+{
+    DynamicResolutionController controller(createDesc());
+    for (uint32_t i = 0; i < 100; i++) controller.update(10.0f, controller.getScale());
+    if (controller.getScale() != 1.0f) return test_fail("A light load should stay at full resolution");
+
+    // One frame at twice the budget
+    float scale = controller.update(32.0f, 1.0f);
+    if (scale >= 1.0f) return test_fail("A spike should drop the resolution right away");
+    if (32.0f * scale * scale > 16.0f) return test_fail("The drop should fit the spike in the budget");
+
+    // A frame a bit over budget moves the average, but not past the target
+    DynamicResolutionController steady(createDesc());
+    for (uint32_t i = 0; i < 100; i++) steady.update(12.0f, 1.0f);
+    if (steady.update(17.0f, 1.0f) != 1.0f) return test_fail("A single frame slightly over budget shouldn't change the scale");
+    return test_pass();
+}
+
+testing_func(DynamicResolutionTest, TestUpscaleHysteresis)
+{
+    DynamicResolutionController::Desc desc = createDesc();
+    DynamicResolutionController controller(desc);
+    for (uint32_t i = 0; i < 100; i++) controller.update(40.0f * controller.getScale() * controller.getScale(), controller.getScale());
+    float lowScale = controller.getScale();
+    if (lowScale > 0.6f) return test_fail("Heavy load should drop the scale");
+
+    // The load gets light. The average needs a few frames to follow, then the scale must still wait for upscaleDelay frames.
+    uint32_t frames = 0;
+    while (controller.getScale() == lowScale && frames < 1000)
+    {
+        controller.update(8.0f * controller.getScale() * controller.getScale(), controller.getScale());
+        frames++;
+    }
+    if (frames < desc.upscaleDelay) return test_fail("The scale went up before upscaleDelay frames");
+    if (frames > desc.upscaleDelay + 30) return test_fail("The scale took too long to go up");
+    if (controller.getScale() != desc.maxScale) return test_fail("8 ms at full resolution fits the budget");
+
+    // Alternating between a heavy and a light frame must not make the scale bounce every frame
+    DynamicResolutionController alternating(desc);
+    uint32_t changes = 0;
+    float prevScale = alternating.getScale();
+    for (uint32_t i = 0; i < 400; i++)
+    {
+        float s = alternating.getScale();
+        alternating.update(((i & 1) ? 21.0f : 15.0f) * s * s, s);
+        changes += (alternating.getScale() != prevScale) ? 1 : 0;
+        prevScale = alternating.getScale();
+    }
+    if (changes > 2) return test_fail("The scale oscillates");
+    return test_pass();
+}
+
+testing_func(DynamicResolutionTest, TestCameraPanTrace)
+{
+    // A camera pan from a light region into a heavy one and back: 10 ms -> 30 ms -> 10 ms at full resolution, with ramps
+    std::vector<float> trace;
+    for (uint32_t i = 0; i < 120; i++) trace.push_back(10.0f);
+    for (uint32_t i = 0; i < 20; i++) trace.push_back(10.0f + 20.0f * (i + 1) / 20.0f);
+    for (uint32_t i = 0; i < 300; i++) trace.push_back(30.0f);
+    for (uint32_t i = 0; i < 20; i++) trace.push_back(30.0f - 20.0f * (i + 1) / 20.0f);
+    for (uint32_t i = 0; i < 200; i++) trace.push_back(10.0f);
+
+    DynamicResolutionController controller(createDesc());
+    TraceResult result = replay(controller, trace, 0.5f, 0.03f, 7);
+
+    // Frames over budget are only allowed while the ramp is in flight, plus the timing latency
+    uint32_t overBudget = 0;
+    for (float t : result.frameTimes) overBudget += (t > 16.0f) ? 1 : 0;
+    if (overBudget > 20) return test_fail("Too many frames over budget: " + std::to_string(overBudget));
+    if (result.scales[130] != 1.0f && result.scales[119] != 1.0f) return test_fail("The light region should render at full resolution");
+    if (result.scales[300] > 0.75f) return test_fail("The heavy region should render at a lower scale");
+    if (result.scaleChanges(200) > 2) return test_fail("The scale changes in the heavy region after it settled");
+    if (result.scales.back() != 1.0f) return test_fail("The scale should recover after the pan");
+    return test_pass();
+}
+
+testing_func(DynamicResolutionTest, TestLimitsAndRenderSize)
+{
+    DynamicResolutionController::Desc desc = createDesc();
+    desc.minScale = 0.6f;
+    desc.maxScale = 0.9f;
+    DynamicResolutionController controller(desc);
+    if (controller.getScale() != 0.9f) return test_fail("The controller should start at the maximum scale");
+    controller.update(1000.0f, 0.9f);
+    if (controller.getScale() != 0.6f) return test_fail("The scale should be clamped to the minimum");
+    for (uint32_t i = 0; i < 1000; i++) controller.update(0.1f, controller.getScale());
+    if (controller.getScale() != 0.9f) return test_fail("The scale should be clamped to the maximum");
+
+    // Invalid samples are ignored
+    float scale = controller.getScale();
+    controller.update(0.0f, scale);
+    controller.update(-1.0f, scale);
+    if (controller.getScale() != scale) return test_fail("Invalid samples should be ignored");
+
+    // The scale is always a multiple of the step
+    DynamicResolutionController stepped(createDesc());
+    stepped.update(23.0f, 1.0f);
+    float steps = stepped.getScale() / createDesc().scaleStep;
+    if (std::abs(steps - std::round(steps)) > 1e-4f) return test_fail("The scale is not a multiple of the step");
+
+    if (DynamicResolutionController::getRenderSize(glm::uvec2(1920, 1080), 0.5f) != glm::uvec2(960, 540)) return test_fail("Wrong render size");
+    if (DynamicResolutionController::getRenderSize(glm::uvec2(1, 3), 0.1f) != glm::uvec2(1, 1)) return test_fail("Render size can't be 0");
+    if (DynamicResolutionController::getRenderSize(glm::uvec2(1280, 720), 1.0f) != glm::uvec2(1280, 720)) return test_fail("Full scale should be the full size");
+
+    controller.reset();
+    if (controller.getScale() != 0.9f || controller.getFullResolutionTime() != 0) return test_fail("reset() should forget the history");
+    return test_pass();
+}
+
+int main()
+{
+    DynamicResolutionTest dynamicResolutionTest;
+    dynamicResolutionTest.init();
+    dynamicResolutionTest.run();
+    return 0;
+}
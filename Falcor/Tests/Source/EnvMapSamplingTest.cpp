@@ -0,0 +1,299 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "EnvMapSamplingTest.h"
+#include "Utils/CpuTimer.h"
+#include <random>
+#include <cmath>
+
+void EnvMapSamplingTest::addTests()
+{
+    addTestToList<TestDirectionMapping>();
+    addTestToList<TestPdfNormalization>();
+    addTestToList<TestSampleDistribution>();
+    addTestToList<TestBlackMap>();
+    addTestToList<TestVarianceReduction>();
+    addTestToList<TestBuildTime>();
+}
+
+static const float kPi = 3.14159265358979323846f;
+
+// A dim sky with a small, very bright sun. Most of the irradiance comes from a tiny fraction of the texels, which is the case importance sampling is for.
+static std::vector<float> createSkyLuminance(uint32_t width, uint32_t height, const glm::vec3& sunDir)
+{
+    std::vector<float> luminance(size_t(width) * height);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            glm::vec3 dir = EnvMapSampler::latLongToDirection(glm::vec2((x + 0.5f) / width, (y + 0.5f) / height));
+            float l = dir.y > 0 ? 0.3f + 0.2f * dir.y : 0.05f;
+            if (glm::dot(dir, sunDir) > std::cos(0.04f)) l = 2000.0f;
+            luminance[size_t(y) * width + x] = l;
+        }
+    }
+    return luminance;
+}
+
+static float lookup(const std::vector<float>& luminance, uint32_t width, uint32_t height, const glm::vec2& uv)
+{
+    uint32_t x = std::min((uint32_t)(uv.x * width), width - 1);
+    uint32_t y = std::min((uint32_t)(uv.y * height), height - 1);
+    return luminance[size_t(y) * width + x];
+}
+
+testing_func(EnvMapSamplingTest, TestDirectionMapping)
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(0.001f, 0.999f);
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        glm::vec2 uv(dist(rng), dist(rng));
+        glm::vec3 dir = EnvMapSampler::latLongToDirection(uv);
+        if (std::abs(glm::length(dir) - 1.0f) > 1e-5f) return test_fail("Direction is not normalized");
+        glm::vec2 back = EnvMapSampler::directionToLatLong(dir);
+        if (std::abs(back.x - uv.x) > 1e-4f || std::abs(back.y - uv.y) > 1e-4f) return test_fail("Lat-long mapping doesn't round-trip");
+    }
+
+    // Row 0 is the top of the map
+    if (EnvMapSampler::latLongToDirection(glm::vec2(0.5f, 0.0f)).y < 0.999f) return test_fail("v = 0 should map to +Y");
+    return test_pass();
+}
+
+testing_func(EnvMapSamplingTest, TestPdfNormalization)
+{
+    const uint32_t w = 64, h = 32;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(0.0f, 10.0f);
+    std::vector<float> luminance(w * h);
+    for (auto& l : luminance) l = dist(rng);
+    luminance[5] = -1.0f;
+    luminance[6] = std::numeric_limits<float>::quiet_NaN();
+
+    EnvMapSampler sampler;
+    sampler.build(w, h, luminance.data());
+
+    // The uv density integrates to 1
+    double sum = 0;
+    for (const auto& e : sampler.getConditionalTable()) sum += e.z;
+    if (std::abs(sum / (w * h) - 1.0) > 1e-4) return test_fail("uv density doesn't integrate to 1");
+    if (sampler.getConditionalTable()[5].z != 0 || sampler.getConditionalTable()[6].z != 0) return test_fail("Invalid texels should have 0 density");
+
+    // So does the solid angle density
+    double sphere = 0;
+    const uint32_t n = 512;
+    for (uint32_t y = 0; y < n; y++)
+    {
+        for (uint32_t x = 0; x < n; x++)
+        {
+            glm::vec2 uv((x + 0.5f) / n, (y + 0.5f) / n);
+            float sinTheta = std::sin(uv.y * kPi);
+            sphere += EnvMapSampler::uvPdfToSolidAngle(sampler.evalPdf(uv), uv.y) * sinTheta * (2 * kPi / n) * (kPi / n);
+        }
+    }
+    if (std::abs(sphere - 1.0) > 0.01) return test_fail("Solid angle density doesn't integrate to 1");
+    return test_pass();
+}
+
+testing_func(EnvMapSamplingTest, TestSampleDistribution)
+{
+    const uint32_t w = 16, h = 8;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> luminance(w * h);
+    for (auto& l : luminance) l = dist(rng) * dist(rng) * 4.0f;
+    luminance[17] = 0.0f;
+
+    EnvMapSampler sampler;
+    sampler.build(w, h, luminance.data());
+
+    const uint32_t sampleCount = 1 << 20;
+    std::vector<uint32_t> histogram(w * h, 0);
+    for (uint32_t i = 0; i < sampleCount; i++)
+    {
+        EnvMapSampler::Sample s = sampler.sample(glm::vec2(dist(rng), dist(rng)));
+        if (s.uv.x < 0 || s.uv.x >= 1 || s.uv.y < 0 || s.uv.y >= 1) return test_fail("Sample outside of the map");
+        if (std::abs(s.pdf - sampler.evalPdf(s.uv)) > 1e-6f * s.pdf) return test_fail("Sample pdf doesn't match evalPdf()");
+        histogram[uint32_t(s.uv.y * h) * w + uint32_t(s.uv.x * w)]++;
+    }
+
+    if (histogram[17] != 0) return test_fail("Black texel was sampled");
+    for (uint32_t i = 0; i < w * h; i++)
+    {
+        double expected = sampler.getConditionalTable()[i].z / double(w * h) * sampleCount;
+        // 5 standard deviations of a binomial
+        if (std::abs(histogram[i] - expected) > 5.0 * std::sqrt(expected) + 1) return test_fail("Sample histogram doesn't match the density");
+    }
+    return test_pass();
+}
+
+testing_func(EnvMapSamplingTest, TestBlackMap)
+{
+    std::vector<float> luminance(8 * 4, 0.0f);
+    EnvMapSampler sampler;
+    sampler.build(8, 4, luminance.data());
+    for (const auto& e : sampler.getConditionalTable())
+    {
+        if (e.z != 1.0f) return test_fail("A black map should be sampled uniformly");
+    }
+    EnvMapSampler::Sample s = sampler.sample(glm::vec2(0.3f, 0.7f));
+    if (std::abs(s.uv.x - 0.3f) > 1e-5f || std::abs(s.uv.y - 0.7f) > 1e-5f) return test_fail("Uniform sampling should be the identity");
+    return test_pass();
+}
+
+// Estimate the irradiance at a surface facing `n` with cosine sampling, environment sampling and both combined with MIS, the way SimpleDiffuseGIPass does
+testing_func(EnvMapSamplingTest, TestVarianceReduction)
+{
+    const uint32_t w = 512, h = 256;
+    glm::vec3 sunDir = glm::normalize(glm::vec3(0.4f, 0.7f, -0.3f));
+    std::vector<float> luminance = createSkyLuminance(w, h, sunDir);
+    EnvMapSampler sampler;
+    sampler.build(w, h, luminance.data());
+
+    const glm::vec3 n(0, 1, 0);
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+
+    auto cosineSample = [&](float& pdf)
+    {
+        float r = std::sqrt(dist(rng)), phi = 2 * kPi * dist(rng);
+        glm::vec3 d(r * std::cos(phi), std::sqrt(std::max(0.0f, 1 - r * r)), r * std::sin(phi));
+        pdf = d.y / kPi;
+        return d;
+    };
+    auto envPdf = [&](const glm::vec3& d)
+    {
+        glm::vec2 uv = EnvMapSampler::directionToLatLong(d);
+        return EnvMapSampler::uvPdfToSolidAngle(sampler.evalPdf(uv), uv.y);
+    };
+    auto radiance = [&](const glm::vec3& d) { return lookup(luminance, w, h, EnvMapSampler::directionToLatLong(d)); };
+
+    enum { Cosine, Env, Mis, Count };
+    auto estimate = [&](int technique)
+    {
+        float result = 0;
+        if (technique != Env)
+        {
+            float pdf;
+            glm::vec3 d = cosineSample(pdf);
+            if (pdf > 0)
+            {
+                float weight = 1.0f;
+                if (technique == Mis)
+                {
+                    float pe = envPdf(d);
+                    weight = pdf * pdf / (pdf * pdf + pe * pe);
+                }
+                result += weight * radiance(d) * d.y / pdf;
+            }
+        }
+        if (technique != Cosine)
+        {
+            EnvMapSampler::Sample s = sampler.sample(glm::vec2(dist(rng), dist(rng)));
+            glm::vec3 d = EnvMapSampler::latLongToDirection(s.uv);
+            float pe = EnvMapSampler::uvPdfToSolidAngle(s.pdf, s.uv.y);
+            float cosTheta = glm::dot(d, n);
+            if (pe > 0 && cosTheta > 0)
+            {
+                float weight = 1.0f;
+                if (technique == Mis)
+                {
+                    float pc = cosTheta / kPi;
+                    weight = pe * pe / (pe * pe + pc * pc);
+                }
+                result += weight * lookup(luminance, w, h, s.uv) * cosTheta / pe;
+            }
+        }
+        return result;
+    };
+
+    // Reference by brute-force integration over the texels
+    double reference = 0;
+    for (uint32_t y = 0; y < h; y++)
+    {
+        for (uint32_t x = 0; x < w; x++)
+        {
+            glm::vec2 uv((x + 0.5f) / w, (y + 0.5f) / h);
+            glm::vec3 d = EnvMapSampler::latLongToDirection(uv);
+            double solidAngle = std::sin(uv.y * kPi) * (2 * kPi / w) * (kPi / h);
+            reference += luminance[y * w + x] * std::max(0.0f, d.y) * solidAngle;
+        }
+    }
+
+    const uint32_t sampleCount = 1 << 16;
+    double mean[Count], variance[Count];
+    for (int t = 0; t < Count; t++)
+    {
+        double sum = 0, sumSq = 0;
+        for (uint32_t i = 0; i < sampleCount; i++)
+        {
+            double v = estimate(t);
+            sum += v;
+            sumSq += v * v;
+        }
+        mean[t] = sum / sampleCount;
+        variance[t] = sumSq / sampleCount - mean[t] * mean[t];
+    }
+
+    logInfo("Irradiance reference " + std::to_string(reference) + ", per-sample variance: cosine " + std::to_string(variance[Cosine]) +
+        ", environment " + std::to_string(variance[Env]) + ", MIS " + std::to_string(variance[Mis]));
+
+    for (int t = 0; t < Count; t++)
+    {
+        // Allow 5 standard errors
+        if (std::abs(mean[t] - reference) > 5.0 * std::sqrt(variance[t] / sampleCount) + 1e-3 * reference) return test_fail("Estimator is biased");
+    }
+    if (variance[Env] * 10 > variance[Cosine]) return test_fail("Environment sampling should reduce the variance by at least 10x");
+    if (variance[Mis] > variance[Cosine]) return test_fail("MIS should reduce the variance");
+    return test_pass();
+}
+
+testing_func(EnvMapSamplingTest, TestBuildTime)
+{
+    // The size of MonValley_G_DirtRoad_3k.hdr
+    const uint32_t w = 3072, h = 1536;
+    std::vector<float> luminance = createSkyLuminance(w, h, glm::normalize(glm::vec3(0.4f, 0.7f, -0.3f)));
+    EnvMapSampler sampler;
+    CpuTimer timer;
+    timer.update();
+    sampler.build(w, h, luminance.data());
+    timer.update();
+    logInfo("Sampling tables for a " + std::to_string(w) + "x" + std::to_string(h) + " map built in " + std::to_string(timer.getElapsedTime() * 1000) + "ms");
+
+    double sum = 0;
+    for (const auto& e : sampler.getConditionalTable()) sum += e.z;
+    if (std::abs(sum / (double(w) * h) - 1.0) > 1e-3) return test_fail("uv density doesn't integrate to 1");
+    return test_pass();
+}
+
+int main()
+{
+    EnvMapSamplingTest emst;
+    emst.init();
+    emst.run();
+    return 0;
+}
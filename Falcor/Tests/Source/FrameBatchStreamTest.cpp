@@ -0,0 +1,275 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "FrameBatchStreamTest.h"
+#include "Utils/CpuTimer.h"
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+void FrameBatchStreamTest::addTests()
+{
+    addTestToList<TestBatchOrder>();
+    addTestToList<TestChannelLayout>();
+    addTestToList<TestDropWhenFull>();
+    addTestToList<TestFlushAndClose>();
+    addTestToList<TestThroughput>();
+}
+
+static FrameBatchStream::Channel channel(const std::string& name, uint32_t width, uint32_t height, ResourceFormat format)
+{
+    FrameBatchStream::Channel c;
+    c.name = name;
+    c.width = width;
+    c.height = height;
+    c.format = format;
+    return c;
+}
+
+testing_func(FrameBatchStreamTest, TestBatchOrder)
+{
+    // A blocking stream must deliver every frame, in order, to a consumer on another thread
+    FrameBatchStream::Desc desc;
+    desc.channels = { channel("index", 1, 1, ResourceFormat::R32Uint) };
+    desc.batchSize = 4;
+    desc.bufferCount = 2;
+    desc.dropWhenFull = false;
+    auto pStream = FrameBatchStream::create(desc);
+
+    const uint32_t frameCount = 400;
+    std::vector<uint32_t> received;
+    bool inOrder = true;
+    std::thread consumer([&]()
+    {
+        uint64_t expectedIndex = 0;
+        while (true)
+        {
+            uint32_t batch = pStream->acquireBatch();
+            if (batch == FrameBatchStream::kInvalidBatch) break;
+            inOrder = inOrder && (pStream->getBatchIndex(batch) == expectedIndex++);
+            const uint32_t* pData = reinterpret_cast<const uint32_t*>(pStream->getBatchData(batch, 0));
+            for (uint32_t i = 0; i < pStream->getBatchFrameCount(batch); i++) received.push_back(pData[i]);
+            pStream->releaseBatch(batch);
+        }
+    });
+
+    for (uint32_t i = 0; i < frameCount; i++)
+    {
+        if (pStream->pushFrame({ &i }) == false) return test_fail("A blocking stream dropped a frame");
+    }
+    pStream->close();
+    consumer.join();
+
+    if (inOrder == false) return test_fail("Batches were acquired out of order");
+    if (received.size() != frameCount) return test_fail("Frames were lost");
+    for (uint32_t i = 0; i < frameCount; i++)
+    {
+        if (received[i] != i) return test_fail("Frames were received out of order");
+    }
+    auto stats = pStream->getStats();
+    if (stats.batchesPublished != frameCount / desc.batchSize || stats.batchesConsumed != stats.batchesPublished || stats.framesDropped != 0) return test_fail("Wrong stats");
+    return test_pass();
+}
+
+testing_func(FrameBatchStreamTest, TestChannelLayout)
+{
+    // Channels of a G-buffer with different formats. Frames are written in place through getFrameData().
+    FrameBatchStream::Desc desc;
+    desc.channels = { channel("color", 5, 3, ResourceFormat::RGBA8Unorm), channel("normal", 5, 3, ResourceFormat::RGBA32Float), channel("depth", 5, 3, ResourceFormat::R32Float) };
+    desc.batchSize = 3;
+    auto pStream = FrameBatchStream::create(desc);
+    if (pStream->getFrameSize(0) != 5 * 3 * 4 || pStream->getFrameSize(1) != 5 * 3 * 16 || pStream->getFrameSize(2) != 5 * 3 * 4) return test_fail("Wrong frame sizes");
+
+    for (uint32_t f = 0; f < desc.batchSize; f++)
+    {
+        if (pStream->beginFrame() == false) return test_fail("The frame shouldn't be dropped");
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            std::memset(pStream->getFrameData(c), int(c * 16 + f + 1), pStream->getFrameSize(c));
+        }
+        pStream->endFrame();
+    }
+
+    uint32_t batch = pStream->acquireBatch(0);
+    if (batch == FrameBatchStream::kInvalidBatch) return test_fail("A full batch should be published");
+    if (pStream->getBatchFrameCount(batch) != desc.batchSize) return test_fail("Wrong frame count");
+    for (uint32_t c = 0; c < 3; c++)
+    {
+        const uint8_t* pData = pStream->getBatchData(batch, c);
+        if (reinterpret_cast<uintptr_t>(pData) % 16 != 0) return test_fail("Channels should be aligned");
+        for (uint32_t f = 0; f < desc.batchSize; f++)
+        {
+            size_t size = pStream->getFrameSize(c);
+            const uint8_t* pFrame = pData + f * size;
+            if (pFrame[0] != uint8_t(c * 16 + f + 1) || pFrame[size - 1] != uint8_t(c * 16 + f + 1)) return test_fail("Frames should be contiguous within a channel");
+        }
+    }
+    pStream->releaseBatch(batch);
+
+    desc.channels.push_back(channel("compressed", 4, 4, ResourceFormat::BC1Unorm));
+    if (FrameBatchStream::create(desc) != nullptr) return test_fail("Compressed channels should be rejected");
+    return test_pass();
+}
+
+testing_func(FrameBatchStreamTest, TestDropWhenFull)
+{
+    FrameBatchStream::Desc desc;
+    desc.channels = { channel("index", 1, 1, ResourceFormat::R32Uint) };
+    desc.batchSize = 2;
+    desc.bufferCount = 2;
+    auto pStream = FrameBatchStream::create(desc);
+
+    // The consumer holds one batch, the other is published but not acquired yet, so the next frames are dropped
+    uint32_t accepted = 0;
+    for (uint32_t i = 0; i < 4; i++) accepted += pStream->pushFrame({ &i }) ? 1 : 0;
+    uint32_t held = pStream->acquireBatch(0);
+    for (uint32_t i = 4; i < 10; i++) accepted += pStream->pushFrame({ &i }) ? 1 : 0;
+    if (accepted != 4) return test_fail("Frames should be dropped while every batch is in use");
+    if (pStream->getStats().framesDropped != 6 || pStream->getStats().stallCount != 0) return test_fail("Wrong drop stats");
+
+    // Releasing a batch lets the producer continue
+    pStream->releaseBatch(held);
+    uint32_t value = 10;
+    if (pStream->pushFrame({ &value }) == false) return test_fail("A released batch should be refilled");
+    uint32_t batch = pStream->acquireBatch(0);
+    if (batch == FrameBatchStream::kInvalidBatch || pStream->getBatchIndex(batch) != 1) return test_fail("Expected the second batch");
+    if (reinterpret_cast<const uint32_t*>(pStream->getBatchData(batch, 0))[1] != 3) return test_fail("Dropped frames shouldn't be written");
+    pStream->releaseBatch(batch);
+    return test_pass();
+}
+
+testing_func(FrameBatchStreamTest, TestFlushAndClose)
+{
+    FrameBatchStream::Desc desc;
+    desc.channels = { channel("index", 1, 1, ResourceFormat::R32Uint) };
+    desc.batchSize = 8;
+    auto pStream = FrameBatchStream::create(desc);
+
+    if (pStream->acquireBatch(1) != FrameBatchStream::kInvalidBatch) return test_fail("Nothing should be published yet");
+    for (uint32_t i = 0; i < 3; i++) pStream->pushFrame({ &i });
+    if (pStream->acquireBatch(1) != FrameBatchStream::kInvalidBatch) return test_fail("A partial batch shouldn't be published");
+    pStream->flush();
+    uint32_t batch = pStream->acquireBatch(0);
+    if (batch == FrameBatchStream::kInvalidBatch || pStream->getBatchFrameCount(batch) != 3) return test_fail("Flush should publish the partial batch");
+    pStream->releaseBatch(batch);
+    pStream->flush();
+    if (pStream->getStats().batchesPublished != 1) return test_fail("Flushing an empty batch shouldn't publish it");
+
+    // A blocked consumer is woken by close(), and the last batch is still delivered
+    uint32_t value = 7;
+    pStream->pushFrame({ &value });
+    std::atomic<uint32_t> acquired(0);
+    std::thread consumer([&]()
+    {
+        uint32_t b;
+        while ((b = pStream->acquireBatch()) != FrameBatchStream::kInvalidBatch)
+        {
+            acquired++;
+            pStream->releaseBatch(b);
+        }
+    });
+    pStream->close();
+    consumer.join();
+    if (acquired != 1) return test_fail("The batch flushed by close() should be delivered");
+    if (pStream->pushFrame({ &value })) return test_fail("A closed stream shouldn't accept frames");
+    return test_pass();
+}
+
+testing_func(FrameBatchStreamTest, TestThroughput)
+{
+    // CPU-generated 512x512 G-buffer frames: color, normals and depth, about 5MB per frame. The producer writes the frames in place, like a readback
+    // copied out of a staging buffer, while a consumer thread reads every byte of each batch, like a training step converting it to a tensor.
+    const uint32_t size = 512, frameCount = 240;
+    FrameBatchStream::Desc desc;
+    desc.channels = { channel("color", size, size, ResourceFormat::RGBA8Unorm), channel("normal", size, size, ResourceFormat::RGBA32Float), channel("depth", size, size, ResourceFormat::R32Float) };
+    desc.batchSize = 8;
+
+    auto run = [&](bool dropWhenFull, uint32_t consumerDelayMs, FrameBatchStream::Stats& stats)
+    {
+        desc.dropWhenFull = dropWhenFull;
+        auto pStream = FrameBatchStream::create(desc);
+        std::atomic<uint64_t> checksum(0);
+        std::thread consumer([&]()
+        {
+            uint32_t batch;
+            while ((batch = pStream->acquireBatch()) != FrameBatchStream::kInvalidBatch)
+            {
+                uint64_t sum = 0;
+                for (uint32_t c = 0; c < desc.channels.size(); c++)
+                {
+                    const uint32_t* pData = reinterpret_cast<const uint32_t*>(pStream->getBatchData(batch, c));
+                    size_t count = pStream->getFrameSize(c) * pStream->getBatchFrameCount(batch) / sizeof(uint32_t);
+                    for (size_t i = 0; i < count; i++) sum += pData[i];
+                }
+                checksum += sum;
+                if (consumerDelayMs) std::this_thread::sleep_for(std::chrono::milliseconds(consumerDelayMs));
+                pStream->releaseBatch(batch);
+            }
+        });
+
+        CpuTimer timer;
+        timer.update();
+        for (uint32_t f = 0; f < frameCount; f++)
+        {
+            if (pStream->beginFrame() == false) continue;
+            for (uint32_t c = 0; c < desc.channels.size(); c++)
+            {
+                uint32_t* pData = reinterpret_cast<uint32_t*>(pStream->getFrameData(c));
+                size_t count = pStream->getFrameSize(c) / sizeof(uint32_t);
+                for (size_t i = 0; i < count; i++) pData[i] = uint32_t(i * 2654435761u) ^ f;
+            }
+            pStream->endFrame();
+        }
+        pStream->close();
+        timer.update();
+        consumer.join();
+        stats = pStream->getStats();
+        return frameCount / timer.getElapsedTime();
+    };
+
+    size_t frameBytes = 0;
+    for (const auto& c : desc.channels) frameBytes += size_t(c.width) * c.height * getFormatBytesPerBlock(c.format);
+
+    FrameBatchStream::Stats blockStats, dropStats;
+    double blockFps = run(false, 0, blockStats);
+    double dropFps = run(true, 20, dropStats);
+    logInfo("512x512 G-buffer stream: blocking " + std::to_string(blockFps) + " fps (" + std::to_string(blockFps * frameBytes / (1 << 30)) + " GB/s, producer stalled " +
+        std::to_string(blockStats.stallTime * 1000) + "ms), dropping with a slow consumer " + std::to_string(dropFps) + " fps (" + std::to_string(dropStats.framesDropped) + " of " +
+        std::to_string(frameCount) + " frames dropped)");
+    if (blockStats.framesDropped != 0 || blockStats.framesSubmitted != frameCount) return test_fail("The blocking stream should deliver every frame");
+    if (dropStats.stallCount != 0) return test_fail("The dropping stream should never block the producer");
+    if (dropStats.framesSubmitted + dropStats.framesDropped != frameCount) return test_fail("Every frame should be submitted or dropped");
+    return test_pass();
+}
+
+int main()
+{
+    FrameBatchStreamTest fbst;
+    fbst.init();
+    fbst.run();
+    return 0;
+}
@@ -0,0 +1,224 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "FramePipelineTest.h"
+#include "Utils/CpuTimer.h"
+#include <random>
+#include <atomic>
+#include <chrono>
+
+void FramePipelineTest::addTests()
+{
+    addTestToList<TestEncodeOrder>();
+    addTestToList<TestBackPressure>();
+    addTestToList<TestDropWhenFull>();
+    addTestToList<TestMovedFrames>();
+    addTestToList<TestThroughput>();
+}
+
+static void sleepMs(uint32_t ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+testing_func(FramePipelineTest, TestEncodeOrder)
+{
+    // Conversion times vary, so the workers finish out of order. The encoder must still see the frames in submission order.
+    FramePipeline::Desc desc;
+    desc.frameSize = sizeof(uint32_t);
+    desc.queueDepth = 6;
+    desc.workerCount = 4;
+    std::vector<uint32_t> converted(desc.queueDepth);
+    std::vector<uint32_t> encoded;
+    auto convert = [&](uint32_t, uint32_t slot, const uint8_t* pData)
+    {
+        uint32_t value = *reinterpret_cast<const uint32_t*>(pData);
+        sleepMs((value * 7) % 5);
+        converted[slot] = value;
+    };
+    auto encode = [&](uint32_t slot, uint64_t frameIndex)
+    {
+        if (converted[slot] == frameIndex) encoded.push_back(converted[slot]);
+    };
+
+    const uint32_t frameCount = 64;
+    {
+        auto pPipeline = FramePipeline::create(desc, convert, encode);
+        for (uint32_t i = 0; i < frameCount; i++) pPipeline->pushFrame(&i);
+        pPipeline->flush();
+        auto stats = pPipeline->getStats();
+        if (stats.framesSubmitted != frameCount || stats.framesEncoded != frameCount) return test_fail("Frames were lost");
+        if (stats.maxFramesInFlight > desc.queueDepth) return test_fail("The queue isn't bounded");
+    }
+    if (encoded.size() != frameCount) return test_fail("A frame was encoded with the wrong data");
+    for (uint32_t i = 0; i < frameCount; i++)
+    {
+        if (encoded[i] != i) return test_fail("Frames were encoded out of order");
+    }
+    return test_pass();
+}
+
+testing_func(FramePipelineTest, TestBackPressure)
+{
+    // The encoder is much slower than the producer
+    FramePipeline::Desc desc;
+    desc.frameSize = 16;
+    desc.queueDepth = 3;
+    desc.workerCount = 2;
+    auto pPipeline = FramePipeline::create(desc, [](uint32_t, uint32_t, const uint8_t*) {}, [](uint32_t, uint64_t) { sleepMs(5); });
+    std::vector<uint8_t> frame(desc.frameSize);
+    for (uint32_t i = 0; i < 20; i++) pPipeline->pushFrame(frame.data());
+    pPipeline->flush();
+    auto stats = pPipeline->getStats();
+    if (stats.framesEncoded != 20 || stats.framesDropped != 0) return test_fail("All the frames should be encoded");
+    if (stats.stallCount == 0 || stats.stallTime <= 0) return test_fail("The stalls should be reported");
+    if (stats.maxFramesInFlight != desc.queueDepth) return test_fail("The queue should have filled up");
+    return test_pass();
+}
+
+testing_func(FramePipelineTest, TestDropWhenFull)
+{
+    FramePipeline::Desc desc;
+    desc.frameSize = 16;
+    desc.queueDepth = 2;
+    desc.workerCount = 1;
+    desc.dropWhenFull = true;
+    std::atomic<bool> release(false);
+    auto pPipeline = FramePipeline::create(desc, [](uint32_t, uint32_t, const uint8_t*) {}, [&](uint32_t, uint64_t) { while (!release) sleepMs(1); });
+    std::vector<uint8_t> frame(desc.frameSize);
+    uint32_t accepted = 0;
+    for (uint32_t i = 0; i < 10; i++) accepted += pPipeline->pushFrame(frame.data()) ? 1 : 0;
+    release = true;
+    pPipeline->flush();
+    auto stats = pPipeline->getStats();
+    if (accepted != desc.queueDepth) return test_fail("Only the frames which fit should be accepted");
+    if (stats.framesDropped != 10 - desc.queueDepth || stats.stallCount != 0) return test_fail("Wrong drop stats");
+    if (stats.framesEncoded != accepted) return test_fail("The accepted frames should be encoded");
+    return test_pass();
+}
+
+testing_func(FramePipelineTest, TestMovedFrames)
+{
+    FramePipeline::Desc desc;
+    desc.frameSize = 1024;
+    desc.queueDepth = 2;
+    std::atomic<uint32_t> sum(0);
+    auto pPipeline = FramePipeline::create(desc, [&](uint32_t, uint32_t, const uint8_t* pData) { sum += pData[0] + pData[desc.frameSize - 1]; }, [](uint32_t, uint64_t) {});
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        std::vector<uint8_t> frame(desc.frameSize, uint8_t(i));
+        pPipeline->pushFrame(std::move(frame));
+    }
+    if (pPipeline->pushFrame(std::vector<uint8_t>(16)) == true) return test_fail("A frame smaller than the frame size should be rejected");
+    pPipeline->flush();
+    if (sum != 2 * (0 + 1 + 2 + 3 + 4 + 5 + 6 + 7)) return test_fail("Wrong frame data");
+    return test_pass();
+}
+
+// Synthetic color conversion with roughly the cost of sws_scale: BGRA to planar YUV 4:2:0
+static void convertToYuv420(const uint8_t* pSrc, uint32_t width, uint32_t height, std::vector<uint8_t>& dst)
+{
+    uint8_t* pY = dst.data();
+    uint8_t* pU = pY + width * height;
+    uint8_t* pV = pU + (width / 2) * (height / 2);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            const uint8_t* p = pSrc + (y * width + x) * 4;
+            int b = p[0], g = p[1], r = p[2];
+            pY[y * width + x] = uint8_t(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+            if (((x | y) & 1) == 0)
+            {
+                uint32_t i = (y / 2) * (width / 2) + x / 2;
+                pU[i] = uint8_t(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+                pV[i] = uint8_t(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+            }
+        }
+    }
+}
+
+testing_func(FramePipelineTest, TestThroughput)
+{
+    const uint32_t width = 1920, height = 1080, frameCount = 60;
+    std::vector<uint8_t> frame(width * height * 4);
+    std::mt19937 rng(3);
+    for (auto& v : frame) v = uint8_t(rng());
+
+    auto run = [&](uint32_t workerCount, uint32_t queueDepth, double& stallMs)
+    {
+        FramePipeline::Desc desc;
+        desc.frameSize = frame.size();
+        desc.queueDepth = queueDepth;
+        desc.workerCount = workerCount;
+        std::vector<std::vector<uint8_t>> pictures(queueDepth, std::vector<uint8_t>(width * height * 3 / 2));
+        uint64_t checksum = 0;
+        auto convert = [&](uint32_t, uint32_t slot, const uint8_t* pData) { convertToYuv420(pData, width, height, pictures[slot]); };
+        // The "encoder" touches every byte of the picture
+        auto encode = [&](uint32_t slot, uint64_t) { for (auto v : pictures[slot]) checksum += v; };
+
+        CpuTimer timer;
+        timer.update();
+        {
+            auto pPipeline = FramePipeline::create(desc, convert, encode);
+            for (uint32_t i = 0; i < frameCount; i++) pPipeline->pushFrame(frame.data());
+            pPipeline->flush();
+            stallMs = pPipeline->getStats().stallTime * 1000;
+        }
+        timer.update();
+        return frameCount / timer.getElapsedTime();
+    };
+
+    // The synchronous baseline: conversion and encoding on the caller's thread
+    CpuTimer timer;
+    timer.update();
+    std::vector<uint8_t> picture(width * height * 3 / 2);
+    uint64_t checksum = 0;
+    for (uint32_t i = 0; i < frameCount; i++)
+    {
+        convertToYuv420(frame.data(), width, height, picture);
+        for (auto v : picture) checksum += v;
+    }
+    timer.update();
+    double syncFps = frameCount / timer.getElapsedTime();
+
+    double stall1, stall4;
+    double fps1 = run(1, 4, stall1);
+    double fps4 = run(4, 8, stall4);
+    logInfo("1080p capture pipeline: synchronous " + std::to_string(syncFps) + " fps, 1 worker " + std::to_string(fps1) + " fps (stalled " + std::to_string(stall1) +
+        "ms), 4 workers " + std::to_string(fps4) + " fps (stalled " + std::to_string(stall4) + "ms). Hardware threads: " + std::to_string(std::thread::hardware_concurrency()));
+    if (checksum == 0) return test_fail("Unexpected checksum");
+    return test_pass();
+}
+
+int main()
+{
+    FramePipelineTest fpt;
+    fpt.init();
+    fpt.run();
+    return 0;
+}
@@ -0,0 +1,199 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "FrustumCullingTest.h"
+#include "Utils/CpuTimer.h"
+#include <random>
+
+void FrustumCullingTest::addTests()
+{
+    addTestToList<TestPadding>();
+    addTestToList<TestMatchesReference>();
+    addTestToList<TestPerformance>();
+}
+
+// An axis-aligned box frustum from -size to size on every axis
+static FrustumCulling::Planes createBoxFrustum(float size)
+{
+    FrustumCulling::Planes planes;
+    planes[0] = glm::vec4(1, 0, 0, size);
+    planes[1] = glm::vec4(-1, 0, 0, size);
+    planes[2] = glm::vec4(0, 1, 0, size);
+    planes[3] = glm::vec4(0, -1, 0, size);
+    planes[4] = glm::vec4(0, 0, 1, size);
+    planes[5] = glm::vec4(0, 0, -1, size);
+    return planes;
+}
+
+// A frustum with randomly oriented planes, all passing at a distance of 'size' from the origin
+static FrustumCulling::Planes createRandomFrustum(std::mt19937& rng, float size)
+{
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    FrustumCulling::Planes planes;
+    for (auto& p : planes)
+    {
+        glm::vec3 n(dist(rng), dist(rng), dist(rng) + 0.01f);
+        p = glm::vec4(glm::normalize(n), size);
+    }
+    return planes;
+}
+
+static void createRandomBoxes(std::mt19937& rng, uint32_t count, float range, BoundingBoxSoA& boxes)
+{
+    std::uniform_real_distribution<float> pos(-range, range);
+    std::uniform_real_distribution<float> ext(0.0f, range * 0.05f);
+    boxes.resize(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        BoundingBox box;
+        box.center = glm::vec3(pos(rng), pos(rng), pos(rng));
+        box.extent = glm::vec3(ext(rng), ext(rng), ext(rng));
+        boxes.set(i, box);
+    }
+}
+
+static bool compareModes(const FrustumCulling::Planes& planes, const BoundingBoxSoA& boxes, std::string& error)
+{
+    std::vector<uint32_t> reference, simd, parallel;
+    FrustumCulling::cull(planes, boxes, reference, FrustumCulling::Mode::Scalar);
+    FrustumCulling::cull(planes, boxes, simd, FrustumCulling::Mode::Simd);
+    FrustumCulling::cull(planes, boxes, parallel, FrustumCulling::Mode::Parallel);
+
+    if (simd != reference)
+    {
+        error = "SIMD culling doesn't match the scalar reference";
+        return false;
+    }
+    if (parallel != reference)
+    {
+        error = "Parallel culling doesn't match the scalar reference";
+        return false;
+    }
+    return true;
+}
+
+testing_func(FrustumCullingTest, TestPadding)
+{
+    // 11 boxes, all inside the frustum. The 5 padding boxes must never show up
+    BoundingBoxSoA boxes;
+    boxes.resize(11);
+    for (uint32_t i = 0; i < 11; i++)
+    {
+        boxes.set(i, BoundingBox::fromMinMax(glm::vec3(-1), glm::vec3(1)));
+    }
+
+    std::vector<uint32_t> visible;
+    FrustumCulling::cull(createBoxFrustum(10), boxes, visible, FrustumCulling::Mode::Simd);
+    if (visible.size() != 11 || visible.back() != 10)
+    {
+        return test_fail("Padding boxes were reported as visible");
+    }
+
+    // Shrinking the array must hide the removed boxes
+    boxes.resize(3);
+    FrustumCulling::cull(createBoxFrustum(10), boxes, visible, FrustumCulling::Mode::Simd);
+    if (visible.size() != 3)
+    {
+        return test_fail("Boxes removed by resize() were reported as visible");
+    }
+
+    // Boxes which intersect a plane are visible, boxes which are entirely outside are not
+    boxes.set(0, BoundingBox::fromMinMax(glm::vec3(9), glm::vec3(11)));
+    boxes.set(1, BoundingBox::fromMinMax(glm::vec3(10.5f), glm::vec3(11)));
+    boxes.set(2, BoundingBox::fromMinMax(glm::vec3(-11, 0, 0), glm::vec3(-10.5f, 0, 0)));
+    FrustumCulling::cull(createBoxFrustum(10), boxes, visible, FrustumCulling::Mode::Simd);
+    if (visible.size() != 1 || visible[0] != 0)
+    {
+        return test_fail("Intersecting box culled or outside box not culled");
+    }
+
+    return test_pass();
+}
+
+testing_func(FrustumCullingTest, TestMatchesReference)
+{
+    std::mt19937 rng(1234);
+    std::string error;
+
+    // Sizes around the SIMD width and the parallel chunk size
+    const uint32_t counts[] = { 0, 1, 7, 8, 9, 31, FrustumCulling::kChunkSize - 1, FrustumCulling::kChunkSize + 1, FrustumCulling::kChunkSize * 5 + 3 };
+    for (uint32_t count : counts)
+    {
+        BoundingBoxSoA boxes;
+        createRandomBoxes(rng, count, 100, boxes);
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            if (compareModes(createRandomFrustum(rng, 50), boxes, error) == false) return test_fail(error + " (" + std::to_string(count) + " boxes)");
+        }
+        if (compareModes(createBoxFrustum(50), boxes, error) == false) return test_fail(error + " (" + std::to_string(count) + " boxes)");
+    }
+
+    return test_pass();
+}
+
+testing_func(FrustumCullingTest, TestPerformance)
+{
+    const uint32_t kBoxCount = 128 * 1024;
+    const uint32_t kIterations = 20;
+
+    std::mt19937 rng(5678);
+    BoundingBoxSoA boxes;
+    createRandomBoxes(rng, kBoxCount, 100, boxes);
+    FrustumCulling::Planes planes = createBoxFrustum(50);
+
+    const FrustumCulling::Mode modes[] = { FrustumCulling::Mode::Scalar, FrustumCulling::Mode::Simd, FrustumCulling::Mode::Parallel };
+    const char* names[] = { "Scalar", "SIMD", "Parallel" };
+    float times[3];
+    std::vector<uint32_t> visible;
+    for (uint32_t m = 0; m < 3; m++)
+    {
+        FrustumCulling::cull(planes, boxes, visible, modes[m]);
+        auto start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < kIterations; i++)
+        {
+            FrustumCulling::cull(planes, boxes, visible, modes[m]);
+        }
+        times[m] = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) / kIterations;
+        logInfo(std::string(names[m]) + " culling of " + std::to_string(kBoxCount) + " boxes: " + std::to_string(times[m]) + "ms, " + std::to_string(visible.size()) + " visible");
+    }
+
+    // Timings are noisy, only catch gross regressions
+    if (times[1] > times[0] * 1.5f)
+    {
+        return test_fail("SIMD culling is slower than the scalar reference");
+    }
+
+    return test_pass();
+}
+
+int main()
+{
+    FrustumCullingTest fct;
+    fct.init();
+    fct.run();
+    return 0;
+}
@@ -0,0 +1,194 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "HistogramExposureTest.h"
+#include "Utils/CpuTimer.h"
+#include <random>
+#include <cmath>
+
+void HistogramExposureTest::addTests()
+{
+    addTestToList<TestUniformImage>();
+    addTestToList<TestPercentilesRejectOutliers>();
+    addTestToList<TestEmptyHistogram>();
+    addTestToList<TestAdaptation>();
+    addTestToList<TestCostVersusMipChain>();
+}
+
+static std::vector<uint32_t> buildHistogram(const std::vector<float>& rgb, uint32_t width, uint32_t height, const HistogramExposure::Settings& settings)
+{
+    return CpuReduction::reduce(ReductionType::Histogram, rgb.data(), width, height, 3, settings.range).histogram;
+}
+
+// The result is quantized to the bin centers
+static bool isWithinBin(float luminance, float expected, const HistogramExposure::Settings& settings)
+{
+    float binWidth = (settings.range.maxLog2 - settings.range.minLog2) / kHistogramBinCount;
+    return std::abs(std::log2(luminance) - std::log2(expected)) <= 0.5f * binWidth + 1e-4f;
+}
+
+testing_func(HistogramExposureTest, TestUniformImage)
+{
+    HistogramExposure::Settings settings;
+    const uint32_t w = 64, h = 32;
+    for (float l : { 0.01f, 0.18f, 1.0f, 20.0f })
+    {
+        std::vector<float> rgb(w * h * 3, l);
+        float avg = HistogramExposure::computeAverageLuminance(buildHistogram(rgb, w, h, settings), settings);
+        if (!isWithinBin(avg, l, settings)) return test_fail("Wrong average luminance for a uniform image");
+    }
+    return test_pass();
+}
+
+testing_func(HistogramExposureTest, TestPercentilesRejectOutliers)
+{
+    // 4% of the image is a very bright light source
+    HistogramExposure::Settings settings;
+    settings.lowPercentile = 0.0f;
+    settings.highPercentile = 0.95f;
+    const uint32_t w = 100, h = 100;
+    std::vector<float> rgb(w * h * 3, 0.18f);
+    for (uint32_t i = 0; i < 400 * 3; i++) rgb[i] = 50.0f;
+    std::vector<uint32_t> histogram = buildHistogram(rgb, w, h, settings);
+    float avg = HistogramExposure::computeAverageLuminance(histogram, settings);
+    if (!isWithinBin(avg, 0.18f, settings)) return test_fail("The percentiles should reject the outliers");
+
+    // Without the percentiles, the outliers pull the average
+    settings.lowPercentile = 0;
+    settings.highPercentile = 1;
+    float unclipped = HistogramExposure::computeAverageLuminance(histogram, settings);
+    if (isWithinBin(unclipped, 0.18f, settings)) return test_fail("The outliers should change the unclipped average");
+    return test_pass();
+}
+
+testing_func(HistogramExposureTest, TestEmptyHistogram)
+{
+    HistogramExposure::Settings settings;
+    std::vector<uint32_t> histogram(kHistogramBinCount, 0);
+    if (HistogramExposure::computeAverageLuminance(histogram, settings) != 1.0f) return test_fail("An empty histogram should return 1");
+
+    // Equal percentiles select nothing
+    histogram[100] = 10;
+    settings.lowPercentile = settings.highPercentile = 0.5f;
+    if (HistogramExposure::computeAverageLuminance(histogram, settings) != 1.0f) return test_fail("An empty selection should return 1");
+    return test_pass();
+}
+
+testing_func(HistogramExposureTest, TestAdaptation)
+{
+    HistogramExposure::Settings settings;
+    if (HistogramExposure::adapt(0, 0.5f, 0.016f, settings) != 0.5f) return test_fail("Without history the target should be used");
+    if (HistogramExposure::adapt(0.25f, 4.0f, 0, settings) != 0.25f) return test_fail("No time passed, nothing should change");
+
+    // Converges monotonically, faster towards brighter values
+    float up = 0.25f, down = 4.0f;
+    for (uint32_t frame = 0; frame < 60; frame++)
+    {
+        float nextUp = HistogramExposure::adapt(up, 4.0f, 1.0f / 60, settings);
+        float nextDown = HistogramExposure::adapt(down, 0.25f, 1.0f / 60, settings);
+        if (nextUp < up || nextUp > 4.0f || nextDown > down || nextDown < 0.25f) return test_fail("Adaptation should be monotonic");
+        up = nextUp;
+        down = nextDown;
+    }
+    // After 1 second, 1 - exp(-speed) of the distance in log2 is covered
+    float expectedUp = std::exp2(-2.0f + 4.0f * (1 - std::exp(-settings.speedUp)));
+    float expectedDown = std::exp2(2.0f - 4.0f * (1 - std::exp(-settings.speedDown)));
+    if (std::abs(up - expectedUp) > 1e-3f * expectedUp || std::abs(down - expectedDown) > 1e-3f * expectedDown) return test_fail("Wrong adaptation rate");
+    return test_pass();
+}
+
+// CPU version of the luminance-mip path: log luminance at the lower power of 2 size, then a full mip chain
+static float mipChainAverage(const std::vector<float>& rgb, uint32_t width, uint32_t height)
+{
+    uint32_t w = 1, h = 1;
+    while (w * 2 <= width) w *= 2;
+    while (h * 2 <= height) h *= 2;
+    std::vector<float> level(w * h);
+    for (uint32_t y = 0; y < h; y++)
+    {
+        for (uint32_t x = 0; x < w; x++)
+        {
+            const float* p = &rgb[(size_t(y * height / h) * width + x * width / w) * 3];
+            level[y * w + x] = std::log2(std::max(0.0001f, 0.2126f * p[0] + 0.7152f * p[1] + 0.0722f * p[2]));
+        }
+    }
+    while (w > 1 || h > 1)
+    {
+        uint32_t nw = std::max(1u, w / 2), nh = std::max(1u, h / 2);
+        std::vector<float> next(nw * nh);
+        for (uint32_t y = 0; y < nh; y++)
+        {
+            for (uint32_t x = 0; x < nw; x++)
+            {
+                uint32_t x1 = std::min(x * 2 + 1, w - 1), y1 = std::min(y * 2 + 1, h - 1);
+                next[y * nw + x] = 0.25f * (level[y * 2 * w + x * 2] + level[y * 2 * w + x1] + level[y1 * w + x * 2] + level[y1 * w + x1]);
+            }
+        }
+        level.swap(next);
+        w = nw;
+        h = nh;
+    }
+    return std::exp2(level[0]);
+}
+
+testing_func(HistogramExposureTest, TestCostVersusMipChain)
+{
+    HistogramExposure::Settings settings;
+    settings.lowPercentile = 0;
+    settings.highPercentile = 1;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> dist(-6.0f, 4.0f);
+
+    for (auto size : { glm::uvec2(1920, 1080), glm::uvec2(3840, 2160) })
+    {
+        std::vector<float> rgb(size_t(size.x) * size.y * 3);
+        for (size_t i = 0; i < rgb.size(); i += 3) rgb[i] = rgb[i + 1] = rgb[i + 2] = std::exp2(dist(rng));
+
+        CpuTimer timer;
+        timer.update();
+        float histogramAvg = HistogramExposure::computeAverageLuminance(buildHistogram(rgb, size.x, size.y, settings), settings);
+        timer.update();
+        float histogramTime = timer.getElapsedTime() * 1000;
+        float mipAvg = mipChainAverage(rgb, size.x, size.y);
+        timer.update();
+        float mipTime = timer.getElapsedTime() * 1000;
+
+        logInfo(std::to_string(size.x) + "x" + std::to_string(size.y) + " CPU reference: histogram " + std::to_string(histogramTime) + "ms, mip chain " + std::to_string(mipTime) + "ms");
+
+        // Both are geometric means. The mip chain only sees the lower power of 2 resample, and the histogram is quantized to bins.
+        if (std::abs(std::log2(histogramAvg) - std::log2(mipAvg)) > 0.1f) return test_fail("The histogram and mip chain averages disagree");
+    }
+    return test_pass();
+}
+
+int main()
+{
+    HistogramExposureTest het;
+    het.init();
+    het.run();
+    return 0;
+}
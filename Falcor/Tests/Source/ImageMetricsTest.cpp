@@ -0,0 +1,252 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "ImageMetricsTest.h"
+#include "Utils/CpuTimer.h"
+#include <random>
+#include <cmath>
+
+using Metric = ImageMetrics::Metric;
+
+void ImageMetricsTest::addTests()
+{
+    addTestToList<TestPixelMetrics>();
+    addTestToList<TestIdentical>();
+    addTestToList<TestNoise>();
+    addTestToList<TestSequence>();
+    addTestToList<TestHighPixelsPerDegree>();
+    addTestToList<TestPerformance>();
+}
+
+static ImageMetrics::Image createConstantImage(uint32_t width, uint32_t height, float value)
+{
+    ImageMetrics::Image image;
+    image.width = width;
+    image.height = height;
+    image.data.assign(size_t(width) * height * 4, value);
+    return image;
+}
+
+// A smooth gradient with some structure, so the windowed metrics have something to look at
+static ImageMetrics::Image createPatternImage(uint32_t width, uint32_t height)
+{
+    ImageMetrics::Image image = createConstantImage(width, height, 1.0f);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            float* pPixel = &image.data[(size_t(y) * width + x) * 4];
+            pPixel[0] = 0.5f + 0.4f * std::sin(x * 0.1f);
+            pPixel[1] = 0.5f + 0.4f * std::cos(y * 0.07f);
+            pPixel[2] = float(x + y) / float(width + height);
+        }
+    }
+    return image;
+}
+
+static ImageMetrics::Image addNoise(const ImageMetrics::Image& image, float amplitude, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-amplitude, amplitude);
+    ImageMetrics::Image noisy = image;
+    for (float& v : noisy.data) v = std::max(0.0f, v + dist(rng));
+    return noisy;
+}
+
+static double getValue(const ImageMetrics::Values& values, Metric metric)
+{
+    return values[uint32_t(metric)];
+}
+
+static bool isClose(double a, double b, double tolerance)
+{
+    return std::abs(a - b) <= tolerance * std::max(1.0, std::abs(b));
+}
+
+testing_func(ImageMetricsTest, TestPixelMetrics)
+{
+    // Widths around the SIMD width and heights around the band height
+    const uint32_t sizes[][2] = { { 1, 1 }, { 3, 17 }, { 64, 33 } };
+    for (const auto& size : sizes)
+    {
+        ImageMetrics::Image ref = createConstantImage(size[0], size[1], 0.5f);
+        ImageMetrics::Image test = createConstantImage(size[0], size[1], 0.6f);
+        ImageMetrics::Values values = ImageMetrics::compare(test, ref);
+
+        const double eps = 0.01;
+        const double d = double(0.6f) - double(0.5f);
+        if (!isClose(getValue(values, Metric::Mse), d * d, 1e-5)) return test_fail("Wrong MSE");
+        if (!isClose(getValue(values, Metric::RelMse), d * d / (0.25 + eps), 1e-5)) return test_fail("Wrong relMSE");
+        if (!isClose(getValue(values, Metric::Smape), d / (1.1 + eps), 1e-5)) return test_fail("Wrong SMAPE");
+        if (!isClose(getValue(values, Metric::Psnr), 20.0, 1e-4)) return test_fail("Wrong PSNR");
+        if (!std::isnan(getValue(values, Metric::TemporalMse))) return test_fail("Temporal MSE computed for a single image pair");
+    }
+
+    // Disabled metrics aren't computed
+    ImageMetrics::Options options;
+    options.metrics = ImageMetrics::getMetricBit(Metric::Smape);
+    ImageMetrics::Values values = ImageMetrics::compare(createConstantImage(4, 4, 0), createConstantImage(4, 4, 1), options);
+    if (!std::isnan(getValue(values, Metric::Mse)) || !std::isnan(getValue(values, Metric::Flip))) return test_fail("A disabled metric was computed");
+    if (!isClose(getValue(values, Metric::Smape), 1.0 / 1.01, 1e-5)) return test_fail("Wrong SMAPE for black against white");
+
+    // Mismatched sizes
+    values = ImageMetrics::compare(createConstantImage(4, 4, 0), createConstantImage(4, 5, 0));
+    if (!std::isnan(getValue(values, Metric::Mse))) return test_fail("Images of different sizes were compared");
+
+    // Metric names
+    Metric metric;
+    if (!ImageMetrics::findMetric("tmse", metric) || metric != Metric::TemporalMse || ImageMetrics::findMetric("foo", metric)) return test_fail("Metric names aren't found");
+    return test_pass();
+}
+
+testing_func(ImageMetricsTest, TestIdentical)
+{
+    ImageMetrics::Image image = createPatternImage(67, 41);
+    ImageMetrics::Values values = ImageMetrics::compare(image, image);
+    if (getValue(values, Metric::Mse) != 0 || getValue(values, Metric::Smape) != 0) return test_fail("Identical images have a pixel error");
+    if (!std::isinf(getValue(values, Metric::Psnr))) return test_fail("PSNR of identical images isn't infinite");
+    if (!isClose(getValue(values, Metric::Ssim), 1.0, 1e-5)) return test_fail("SSIM of identical images isn't 1");
+    if (getValue(values, Metric::Flip) > 1e-6) return test_fail("FLIP of identical images isn't 0");
+
+    // Black against white is close to the maximum FLIP error
+    values = ImageMetrics::compare(createConstantImage(32, 32, 0), createConstantImage(32, 32, 1));
+    if (getValue(values, Metric::Flip) < 0.9) return test_fail("FLIP of black against white is too low");
+    return test_pass();
+}
+
+testing_func(ImageMetricsTest, TestNoise)
+{
+    // More noise is worse for every metric
+    ImageMetrics::Image ref = createPatternImage(128, 96);
+    ImageMetrics::Values prev = ImageMetrics::compare(ref, ref);
+    const float amplitudes[] = { 0.02f, 0.1f, 0.3f };
+    for (float amplitude : amplitudes)
+    {
+        ImageMetrics::Values values = ImageMetrics::compare(addNoise(ref, amplitude, 3), ref);
+        for (Metric m : { Metric::Mse, Metric::RelMse, Metric::Smape, Metric::Flip })
+        {
+            if (!(getValue(values, m) > getValue(prev, m))) return test_fail(ImageMetrics::getMetricName(m) + " doesn't increase with the noise");
+        }
+        if (!(getValue(values, Metric::Ssim) < getValue(prev, Metric::Ssim))) return test_fail("SSIM doesn't decrease with the noise");
+        if (!(getValue(values, Metric::Psnr) < getValue(prev, Metric::Psnr))) return test_fail("PSNR doesn't decrease with the noise");
+        prev = values;
+    }
+
+    // The exposure brings out errors in dark images
+    ImageMetrics::Image dark = createConstantImage(32, 32, 0.01f), darkNoisy = addNoise(dark, 0.005f, 4);
+    ImageMetrics::Options exposed;
+    exposed.exposure = 5;
+    double flip = getValue(ImageMetrics::compare(darkNoisy, dark), Metric::Flip);
+    double exposedFlip = getValue(ImageMetrics::compare(darkNoisy, dark, exposed), Metric::Flip);
+    if (!(exposedFlip > flip)) return test_fail("The exposure doesn't increase FLIP of a dark image");
+    return test_pass();
+}
+
+testing_func(ImageMetricsTest, TestSequence)
+{
+    ImageMetrics::Image ref = createPatternImage(40, 24);
+    ImageMetrics::Image offset = ref;
+    for (float& v : offset.data) v += 0.1f;
+
+    // A constant error doesn't flicker
+    ImageMetrics::UniquePtr pMetrics = ImageMetrics::create();
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        if (!pMetrics->addFrame(offset, ref)) return test_fail("addFrame() failed");
+    }
+    const auto& frames = pMetrics->getFrameValues();
+    if (frames.size() != 3 || !std::isnan(getValue(frames[0], Metric::TemporalMse))) return test_fail("The first frame has a temporal error");
+    if (!isClose(getValue(frames[2], Metric::TemporalMse), 0, 1e-9)) return test_fail("A static error has a temporal error");
+    if (!isClose(getValue(pMetrics->getMean(), Metric::Mse), getValue(frames[0], Metric::Mse), 1e-9)) return test_fail("Wrong mean MSE");
+
+    // A test sequence alternating between two errors flickers
+    pMetrics->reset();
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        pMetrics->addFrame((i & 1) ? offset : ref, ref);
+    }
+    double tmse = getValue(pMetrics->getMean(), Metric::TemporalMse);
+    if (!isClose(tmse, double(0.1f) * double(0.1f), 1e-4)) return test_fail("Wrong temporal MSE of a flickering sequence");
+
+    // The mean PSNR comes from the mean MSE, so it stays finite when some frames are exact
+    double psnr = getValue(pMetrics->getMean(), Metric::Psnr);
+    if (!isClose(psnr, 10 * std::log10(1.0 / (0.5 * double(0.1f) * double(0.1f))), 1e-4)) return test_fail("Wrong mean PSNR");
+
+    // Frame sizes must match
+    if (pMetrics->addFrame(createConstantImage(40, 24, 0), createConstantImage(40, 25, 0))) return test_fail("Mismatched test and reference sizes were accepted");
+    if (pMetrics->addFrame(createConstantImage(41, 24, 0), createConstantImage(41, 24, 0))) return test_fail("A frame size change was accepted");
+    return test_pass();
+}
+
+testing_func(ImageMetricsTest, TestHighPixelsPerDegree)
+{
+    // The FLIP filters grow with the pixels per degree, up to hundreds of taps at the top of the ImageCompare range
+    ImageMetrics::Image ref = createPatternImage(48, 40);
+    ImageMetrics::Image test = addNoise(ref, 0.1f, 5);
+    ImageMetrics::Options options;
+    options.metrics = ImageMetrics::getMetricBit(Metric::Flip);
+    for (float ppd : { 67.0f, 500.0f, 1000.0f })
+    {
+        options.pixelsPerDegree = ppd;
+        double identical = getValue(ImageMetrics::compare(ref, ref, options), Metric::Flip);
+        double flip = getValue(ImageMetrics::compare(test, ref, options), Metric::Flip);
+        if (!(identical <= 1e-6)) return test_fail("FLIP of identical images isn't 0 at " + std::to_string(ppd) + " ppd");
+        if (!(flip > 0 && flip <= 1)) return test_fail("FLIP is out of range at " + std::to_string(ppd) + " ppd");
+    }
+    return test_pass();
+}
+
+testing_func(ImageMetricsTest, TestPerformance)
+{
+    // 1080p, the typical reference image size
+    const uint32_t kWidth = 1920, kHeight = 1080;
+    ImageMetrics::Image ref = createPatternImage(kWidth, kHeight);
+    ImageMetrics::Image test = addNoise(ref, 0.05f, 5);
+
+    std::string line = "ImageMetrics (1920x1080):";
+    for (uint32_t m = 0; m < ImageMetrics::kMetricCount; m++)
+    {
+        if (Metric(m) == Metric::TemporalMse) continue;
+        ImageMetrics::Options options;
+        options.metrics = ImageMetrics::getMetricBit(Metric(m));
+        auto start = CpuTimer::getCurrentTimePoint();
+        ImageMetrics::compare(test, ref, options);
+        line += " " + ImageMetrics::getMetricName(Metric(m)) + " " + std::to_string(CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint())) + "ms";
+    }
+    logInfo(line);
+
+    // Timings are noisy, so this only reports them
+    return test_pass();
+}
+
+int main()
+{
+    ImageMetricsTest imt;
+    imt.init();
+    imt.run();
+    return 0;
+}
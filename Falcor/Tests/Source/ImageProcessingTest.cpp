@@ -0,0 +1,351 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "ImageProcessingTest.h"
+#include "Utils/CpuTimer.h"
+#include <random>
+#include <cstring>
+#include <cmath>
+
+using namespace ImageProcessing;
+
+void ImageProcessingTest::addTests()
+{
+    addTestToList<TestCopyAndFlip>();
+    addTestToList<TestSwizzle>();
+    addTestToList<TestChannelCount>();
+    addTestToList<TestSrgb>();
+    addTestToList<TestHalf>();
+    addTestToList<TestResample>();
+    addTestToList<TestPerformance>();
+}
+
+static const Mode kModes[] = { Mode::Scalar, Mode::Simd, Mode::Parallel };
+static const char* kModeNames[] = { "Scalar", "SIMD", "Parallel" };
+
+// Widths around the SIMD widths, and a height large enough to be split in Parallel mode
+static const uint32_t kWidths[] = { 1, 3, 4, 5, 7, 8, 9, 17, 1000 };
+static const uint32_t kHeight = 300;
+
+static std::vector<uint8_t> createRandomBytes(std::mt19937& rng, size_t size)
+{
+    std::vector<uint8_t> data(size);
+    for (auto& d : data) d = uint8_t(rng());
+    return data;
+}
+
+testing_func(ImageProcessingTest, TestCopyAndFlip)
+{
+    std::mt19937 rng(1);
+    const uint32_t rowSize = 13, height = 7, srcPitch = 16, dstPitch = 20;
+    std::vector<uint8_t> src = createRandomBytes(rng, srcPitch * height);
+
+    for (Mode mode : kModes)
+    {
+        std::vector<uint8_t> dst(dstPitch * height, 0xcd);
+        copyRows(rowSize, height, src.data(), srcPitch, dst.data(), dstPitch, true, mode);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            if (memcmp(&dst[(height - y - 1) * dstPitch], &src[y * srcPitch], rowSize) != 0) return test_fail("Flipped copy doesn't match the source");
+            if (dst[y * dstPitch + rowSize] != 0xcd) return test_fail("Copy wrote past the end of a row");
+        }
+
+        // Flipping twice in place restores the image, odd heights leave the middle row alone
+        std::vector<uint8_t> data = src;
+        flipVertical(rowSize, height, data.data(), srcPitch, mode);
+        if (memcmp(&data[(height - 1) * srcPitch], &src[0], rowSize) != 0 || memcmp(&data[3 * srcPitch], &src[3 * srcPitch], rowSize) != 0)
+        {
+            return test_fail("In-place flip is incorrect");
+        }
+        flipVertical(rowSize, height, data.data(), srcPitch, mode);
+        if (data != src) return test_fail("Flipping twice doesn't restore the image");
+    }
+    return test_pass();
+}
+
+testing_func(ImageProcessingTest, TestSwizzle)
+{
+    // RGBA to BGRA with opaque alpha, as done when saving images
+    const Swizzle toBgrx = { 2, 1, 0, kOne };
+    uint8_t texels[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    swizzleRgba8(2, 1, texels, 8, texels, 8, toBgrx, false, Mode::Simd);
+    const uint8_t expected[8] = { 3, 2, 1, 0xff, 7, 6, 5, 0xff };
+    if (memcmp(texels, expected, 8) != 0) return test_fail("In-place swizzle is incorrect");
+
+    std::mt19937 rng(2);
+    const Swizzle swizzles[] = { { 2, 1, 0, 3 }, { 3, 3, 0, kZero }, toBgrx };
+    for (uint32_t width : kWidths)
+    {
+        std::vector<uint8_t> src = createRandomBytes(rng, width * 4 * kHeight);
+        for (const Swizzle& swizzle : swizzles)
+        {
+            std::vector<uint8_t> reference(src.size()), result(src.size());
+            swizzleRgba8(width, kHeight, src.data(), width * 4, reference.data(), width * 4, swizzle, true, Mode::Scalar);
+            for (Mode mode : { Mode::Simd, Mode::Parallel })
+            {
+                swizzleRgba8(width, kHeight, src.data(), width * 4, result.data(), width * 4, swizzle, true, mode);
+                if (result != reference) return test_fail("Swizzle doesn't match the scalar reference (width " + std::to_string(width) + ")");
+            }
+        }
+    }
+    return test_pass();
+}
+
+testing_func(ImageProcessingTest, TestChannelCount)
+{
+    // RGB to RGBA adds an opaque alpha channel
+    const float rgb[6] = { 1, 2, 3, 4, 5, 6 };
+    float rgba[8];
+    convertChannelCount(2, 1, 4, 3, rgb, sizeof(rgb), 4, rgba, sizeof(rgba), kAlphaOneFloat, false, Mode::Simd);
+    const float expected[8] = { 1, 2, 3, 1, 4, 5, 6, 1 };
+    if (memcmp(rgba, expected, sizeof(rgba)) != 0) return test_fail("RGB to RGBA conversion is incorrect");
+
+    std::mt19937 rng(3);
+    const uint32_t channelPairs[][2] = { { 3, 4 }, { 4, 3 }, { 1, 4 }, { 4, 1 }, { 2, 3 } };
+    for (uint32_t bytesPerChannel : { 1u, 2u, 4u })
+    {
+        for (const auto& pair : channelPairs)
+        {
+            for (uint32_t width : kWidths)
+            {
+                // Source rows are padded, to catch reads past the end of a row
+                size_t srcPitch = width * pair[0] * bytesPerChannel + 5;
+                size_t dstPitch = width * pair[1] * bytesPerChannel;
+                std::vector<uint8_t> src = createRandomBytes(rng, srcPitch * kHeight);
+                std::vector<uint8_t> reference(dstPitch * kHeight), result(dstPitch * kHeight);
+                convertChannelCount(width, kHeight, bytesPerChannel, pair[0], src.data(), srcPitch, pair[1], reference.data(), dstPitch, 0xff, true, Mode::Scalar);
+                for (Mode mode : { Mode::Simd, Mode::Parallel })
+                {
+                    convertChannelCount(width, kHeight, bytesPerChannel, pair[0], src.data(), srcPitch, pair[1], result.data(), dstPitch, 0xff, true, mode);
+                    if (result != reference)
+                    {
+                        return test_fail("Channel conversion doesn't match the scalar reference (" + std::to_string(bytesPerChannel) + " bytes, " + std::to_string(pair[0]) + " to " +
+                            std::to_string(pair[1]) + " channels, width " + std::to_string(width) + ")");
+                    }
+                }
+            }
+        }
+    }
+    return test_pass();
+}
+
+testing_func(ImageProcessingTest, TestSrgb)
+{
+    // Decoding all the 8-bit values matches the reference, and encoding them again is lossless
+    std::vector<uint8_t> codes(256 * 4);
+    for (uint32_t i = 0; i < codes.size(); i++) codes[i] = uint8_t(i / 4);
+    std::vector<float> reference(codes.size()), linear(codes.size());
+    srgbToLinear(256, 4, codes.data(), reference.data(), Mode::Scalar);
+    srgbToLinear(256, 4, codes.data(), linear.data(), Mode::Parallel);
+    if (linear != reference) return test_fail("sRGB decoding doesn't match the scalar reference");
+    if (linear[4 * 128 + 3] != 128 / 255.0f) return test_fail("Alpha was sRGB-decoded");
+
+    std::vector<uint8_t> encoded(codes.size());
+    for (Mode mode : kModes)
+    {
+        linearToSrgb(256, 4, linear.data(), encoded.data(), mode);
+        if (encoded != codes) return test_fail(std::string("sRGB round-trip isn't lossless in ") + kModeNames[uint32_t(mode)] + " mode");
+    }
+
+    // Encoding is correctly rounded, the reference may be off by one due to float precision
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<float> dist(-0.1f, 1.1f);
+    std::vector<float> values(100003);
+    for (auto& v : values) v = dist(rng);
+    values[0] = 0.0f; values[1] = 1.0f; values[2] = 0.0031308f;
+    std::vector<uint8_t> scalar(values.size()), simd(values.size());
+    linearToSrgb(uint32_t(values.size()), 1, values.data(), scalar.data(), Mode::Scalar);
+    linearToSrgb(uint32_t(values.size()), 1, values.data(), simd.data(), Mode::Parallel);
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        double x = std::max(0.0, std::min(double(values[i]), 1.0));
+        double s = (x <= 0.0031308) ? x * 12.92 : 1.055 * std::pow(x, 1.0 / 2.4) - 0.055;
+        int exact = int(std::floor(s * 255.0 + 0.5));
+        if (std::abs(int(scalar[i]) - exact) > 1) return test_fail("Scalar sRGB encoding is inaccurate");
+        if (std::abs(int(simd[i]) - exact) > 1 || (simd[i] != exact && std::abs(s * 255.0 - std::floor(s * 255.0) - 0.5) > 1e-4))
+        {
+            return test_fail("SIMD sRGB encoding isn't correctly rounded for " + std::to_string(values[i]));
+        }
+    }
+    return test_pass();
+}
+
+testing_func(ImageProcessingTest, TestHalf)
+{
+    // Every half converts to the same float in all the modes, and back to the same half
+    std::vector<uint16_t> halfs(65536);
+    for (uint32_t i = 0; i < 65536; i++) halfs[i] = uint16_t(i);
+    std::vector<float> reference(65536), floats(65536);
+    halfToFloat(65536, halfs.data(), reference.data(), Mode::Scalar);
+    std::vector<uint16_t> roundTrip(65536);
+    for (Mode mode : kModes)
+    {
+        halfToFloat(65536, halfs.data(), floats.data(), mode);
+        floatToHalf(65536, floats.data(), roundTrip.data(), mode);
+        for (uint32_t i = 0; i < 65536; i++)
+        {
+            bool isNan = (i & 0x7c00) == 0x7c00 && (i & 0x3ff) != 0;
+            if (isNan)
+            {
+                if (std::isnan(floats[i]) == false || (roundTrip[i] & 0x7fff) <= 0x7c00) return test_fail("Half NaN conversion is incorrect");
+                continue;
+            }
+            if (memcmp(&floats[i], &reference[i], sizeof(float)) != 0) return test_fail("Half to float doesn't match the scalar reference for " + std::to_string(i));
+            if (roundTrip[i] != i) return test_fail(std::string("Half round-trip isn't lossless in ") + kModeNames[uint32_t(mode)] + " mode");
+        }
+    }
+
+    // Rounding to nearest even, overflow and denormals
+    const float values[] = { 1.0f + 1.0f / 2048, 1.0f + 3.0f / 2048, 65504.0f, 65519.0f, 65520.0f, 1e10f, -1e10f, 5.96e-8f, 2.98e-8f, 2.99e-8f, 1e-10f, -0.0f };
+    const uint16_t expected[] = { 0x3c00, 0x3c02, 0x7bff, 0x7bff, 0x7c00, 0x7c00, 0xfc00, 0x0001, 0x0000, 0x0001, 0x0000, 0x8000 };
+    const uint32_t count = sizeof(values) / sizeof(values[0]);
+    uint16_t result[count];
+    for (Mode mode : kModes)
+    {
+        floatToHalf(count, values, result, mode);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (result[i] != expected[i]) return test_fail(std::string("Float to half is incorrect in ") + kModeNames[uint32_t(mode)] + " mode for " + std::to_string(values[i]));
+        }
+    }
+
+    // Random floats over the half range
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> dist(-70000.0f, 70000.0f);
+    std::vector<float> randomFloats(10007);
+    for (auto& f : randomFloats) f = dist(rng) * std::pow(2.0f, -float(rng() % 30));
+    std::vector<uint16_t> scalar(randomFloats.size()), simd(randomFloats.size());
+    floatToHalf(uint32_t(randomFloats.size()), randomFloats.data(), scalar.data(), Mode::Scalar);
+    floatToHalf(uint32_t(randomFloats.size()), randomFloats.data(), simd.data(), Mode::Parallel);
+    if (scalar != simd) return test_fail("Float to half doesn't match the scalar reference");
+
+    return test_pass();
+}
+
+testing_func(ImageProcessingTest, TestResample)
+{
+    // A 2x box downsample averages 2x2 blocks
+    const float src[16] = { 0, 1, 2, 3,  4, 5, 6, 7,  8, 9, 10, 11,  12, 13, 14, 15 };
+    std::vector<float> half = resample(4, 4, 1, src, 2, 2, Filter::Box);
+    const float expected[4] = { 2.5f, 4.5f, 10.5f, 12.5f };
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        if (std::abs(half[i] - expected[i]) > 1e-5f) return test_fail("Box downsampling is incorrect");
+    }
+
+    // Resampling a constant image keeps it constant, the SIMD paths match the reference
+    std::mt19937 rng(6);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    const uint32_t sizes[][4] = { { 64, 48, 16, 12 }, { 100, 37, 33, 10 }, { 20, 20, 45, 31 }, { 1, 9, 1, 2 } };
+    for (Filter filter : { Filter::Box, Filter::Lanczos3 })
+    {
+        for (uint32_t channels : { 1u, 3u, 4u })
+        {
+            for (const auto& size : sizes)
+            {
+                std::vector<float> constant(size[0] * size[1] * channels, 0.75f);
+                std::vector<float> result = resample(size[0], size[1], channels, constant.data(), size[2], size[3], filter, Mode::Parallel);
+                for (float v : result)
+                {
+                    if (std::abs(v - 0.75f) > 1e-5f) return test_fail("Resampling doesn't preserve a constant image");
+                }
+
+                std::vector<float> image(constant.size());
+                for (auto& v : image) v = dist(rng);
+                std::vector<float> reference = resample(size[0], size[1], channels, image.data(), size[2], size[3], filter, Mode::Scalar);
+                for (Mode mode : { Mode::Simd, Mode::Parallel })
+                {
+                    result = resample(size[0], size[1], channels, image.data(), size[2], size[3], filter, mode);
+                    if (result.size() != reference.size()) return test_fail("Resampled image has the wrong size");
+                    for (size_t i = 0; i < result.size(); i++)
+                    {
+                        if (std::abs(result[i] - reference[i]) > 1e-5f) return test_fail("Resampling doesn't match the scalar reference");
+                    }
+                }
+            }
+        }
+    }
+    return test_pass();
+}
+
+testing_func(ImageProcessingTest, TestPerformance)
+{
+    // A 1080p RGBA image, the typical reference image size
+    const uint32_t kWidth = 1920, kHeight = 1080, kPixelCount = kWidth * kHeight;
+    const uint32_t kIterations = 3;
+
+    std::mt19937 rng(7);
+    std::vector<uint8_t> rgba8 = createRandomBytes(rng, kPixelCount * 4);
+    std::vector<uint8_t> rgb8(kPixelCount * 3), rgba8Out(kPixelCount * 4);
+    std::vector<float> rgba32(kPixelCount * 4);
+    std::vector<uint16_t> rgba16(kPixelCount * 4);
+    srgbToLinear(kPixelCount, 4, rgba8.data(), rgba32.data());
+
+    struct Benchmark
+    {
+        const char* name;
+        size_t bytes;   // Bytes read and written per run
+        std::function<void(Mode)> func;
+    };
+    const Benchmark benchmarks[] =
+    {
+        { "RGBA8 swizzle", kPixelCount * 8, [&](Mode m) { swizzleRgba8(kWidth, kHeight, rgba8.data(), kWidth * 4, rgba8Out.data(), kWidth * 4, { 2, 1, 0, kOne }, true, m); } },
+        { "RGB8 to RGBA8", kPixelCount * 7, [&](Mode m) { convertChannelCount(kWidth, kHeight, 1, 3, rgb8.data(), kWidth * 3, 4, rgba8Out.data(), kWidth * 4, kAlphaOneUnorm8, true, m); } },
+        { "sRGB to linear", kPixelCount * 20, [&](Mode m) { srgbToLinear(kPixelCount, 4, rgba8.data(), rgba32.data(), m); } },
+        { "Linear to sRGB", kPixelCount * 20, [&](Mode m) { linearToSrgb(kPixelCount, 4, rgba32.data(), rgba8Out.data(), m); } },
+        { "Float to half", kPixelCount * 24, [&](Mode m) { floatToHalf(kPixelCount * 4, rgba32.data(), rgba16.data(), m); } },
+        { "Half to float", kPixelCount * 24, [&](Mode m) { halfToFloat(kPixelCount * 4, rgba16.data(), rgba32.data(), m); } },
+        { "Box downsample 4x", kPixelCount * 17, [&](Mode m) { resample(kWidth, kHeight, 4, rgba32.data(), kWidth / 4, kHeight / 4, Filter::Box, m); } },
+        { "Lanczos3 downsample 4x", kPixelCount * 17, [&](Mode m) { resample(kWidth, kHeight, 4, rgba32.data(), kWidth / 4, kHeight / 4, Filter::Lanczos3, m); } },
+    };
+
+    logInfo(std::string("ImageProcessing: SSSE3 ") + (isSsse3Supported() ? "on" : "off") + ", F16C " + (isF16cSupported() ? "on" : "off"));
+    for (const Benchmark& b : benchmarks)
+    {
+        std::string line = std::string(b.name) + " (1920x1080):";
+        for (uint32_t m = 0; m < 3; m++)
+        {
+            b.func(kModes[m]);
+            auto start = CpuTimer::getCurrentTimePoint();
+            for (uint32_t i = 0; i < kIterations; i++) b.func(kModes[m]);
+            double ms = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) / kIterations;
+            line += std::string(" ") + kModeNames[m] + " " + std::to_string(ms) + "ms (" + std::to_string(b.bytes / (ms * 1e6)) + " GB/s)";
+        }
+        logInfo(line);
+    }
+
+    // Timings are noisy, so this only reports them
+    return test_pass();
+}
+
+int main()
+{
+    ImageProcessingTest ipt;
+    ipt.init();
+    ipt.run();
+    return 0;
+}
@@ -0,0 +1,169 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "LoggerTest.h"
+#include "Utils/CpuTimer.h"
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+void LoggerTest::addTests()
+{
+    addTestToList<TestMultithreadedOrdering>();
+    addTestToList<TestRateLimit>();
+    addTestToList<TestLatency>();
+}
+
+static std::vector<std::string> readLogLines(const std::string& tag)
+{
+    Logger::flush();
+    std::ifstream file(Logger::getLogFilename());
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.find(tag) != std::string::npos) lines.push_back(line);
+    }
+    return lines;
+}
+
+testing_func(LoggerTest, TestMultithreadedOrdering)
+{
+    if (Logger::enabled() == false) return test_pass();
+
+    const uint32_t kThreadCount = 4;
+    const uint32_t kMessageCount = 5000;
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < kThreadCount; t++)
+    {
+        threads.emplace_back([t]()
+        {
+            for (uint32_t i = 0; i < kMessageCount; i++) logWarning("OrderingTest " + std::to_string(t) + " " + std::to_string(i));
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    // Every message must be there, in order per thread
+    std::vector<std::string> lines = readLogLines("OrderingTest ");
+    std::vector<int32_t> last(kThreadCount, -1);
+    for (const auto& line : lines)
+    {
+        std::istringstream stream(line.substr(line.find("OrderingTest ") + 13));
+        uint32_t thread, index;
+        stream >> thread >> index;
+        if (thread >= kThreadCount || (int32_t)index != last[thread] + 1) return test_fail("Messages are missing or out of order");
+        last[thread] = index;
+    }
+    for (int32_t l : last)
+    {
+        if (l != kMessageCount - 1) return test_fail("Messages are missing");
+    }
+
+    return test_pass();
+}
+
+testing_func(LoggerTest, TestRateLimit)
+{
+    if (Logger::enabled() == false) return test_pass();
+
+    Logger::setRateLimit(10);
+    for (uint32_t i = 0; i < 1000; i++) logWarning("RateLimitTest");
+    if (readLogLines("RateLimitTest").size() != 10) return test_fail("Repeated messages were not rate-limited");
+
+    // Once the window is over, a single line reports the suppressed messages
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    std::vector<std::string> lines = readLogLines("RateLimitTest");
+    if (lines.size() != 11 || lines.back().find("repeated 990 more times") == std::string::npos) return test_fail("Suppressed messages were not reported");
+
+    // Errors are never limited
+    bool showBox = Logger::isBoxShownOnError();
+    Logger::showBoxOnError(false);
+    for (uint32_t i = 0; i < 20; i++) logError("RateLimitErrorTest");
+    Logger::showBoxOnError(showBox);
+    if (readLogLines("RateLimitErrorTest").size() != 20) return test_fail("Repeated errors were rate-limited");
+
+    return test_pass();
+}
+
+testing_func(LoggerTest, TestLatency)
+{
+    if (Logger::enabled() == false) return test_pass();
+
+    const uint32_t kMessageCount = 100000;
+    Logger::setRateLimit(0);
+
+    // The calling thread's cost of a message, which is what a render loop pays
+    std::vector<float> latency(kMessageCount);
+    auto start = CpuTimer::getCurrentTimePoint();
+    for (uint32_t i = 0; i < kMessageCount; i++)
+    {
+        auto msgStart = CpuTimer::getCurrentTimePoint();
+        logWarning("LatencyTest message " + std::to_string(i));
+        latency[i] = CpuTimer::calcDuration(msgStart, CpuTimer::getCurrentTimePoint());
+    }
+    float enqueueTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+    Logger::flush();
+    float totalTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+    Logger::setRateLimit(10);
+
+    std::sort(latency.begin(), latency.end());
+    float average = enqueueTime / kMessageCount;
+
+    // Reference: formatting and a flushed write per message on the calling thread
+    const uint32_t kSyncCount = 10000;
+    std::string tempFilename = Logger::getLogFilename() + ".sync";
+    FILE* pFile = std::fopen(tempFilename.c_str(), "w");
+    start = CpuTimer::getCurrentTimePoint();
+    for (uint32_t i = 0; i < kSyncCount; i++)
+    {
+        std::string s = std::string("(Logger::Level::Warning)\t") + "LatencyTest message " + std::to_string(i) + "\n";
+        std::fprintf(pFile, "%s", s.c_str());
+        fflush(pFile);
+    }
+    float syncAverage = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) / kSyncCount;
+    std::fclose(pFile);
+    std::remove(tempFilename.c_str());
+
+    logInfo("Logger: " + std::to_string(kMessageCount / (totalTime / 1000.0f)) + " messages/s written, " + std::to_string(kMessageCount / (enqueueTime / 1000.0f)) + " messages/s enqueued");
+    logInfo("Logger latency: average " + std::to_string(average * 1000.0f) + "us, median " + std::to_string(latency[kMessageCount / 2] * 1000.0f) + "us, 99th percentile " +
+        std::to_string(latency[kMessageCount * 99 / 100] * 1000.0f) + "us, max " + std::to_string(latency.back() * 1000.0f) + "us");
+    logInfo("Synchronous fprintf+fflush latency: average " + std::to_string(syncAverage * 1000.0f) + "us");
+
+    // Timings are noisy, only catch gross regressions
+    if (latency[kMessageCount / 2] > syncAverage) return test_fail("Asynchronous logging is slower than a synchronous write");
+
+    return test_pass();
+}
+
+int main()
+{
+    LoggerTest lt;
+    lt.init();
+    lt.run();
+    return 0;
+}
@@ -0,0 +1,263 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "MeshOptimizerTest.h"
+#include "Utils/CpuTimer.h"
+#include <random>
+#include <array>
+
+void MeshOptimizerTest::addTests()
+{
+    addTestToList<TestVertexCache>();
+    addTestToList<TestOverdraw>();
+    addTestToList<TestVertexFetch>();
+    addTestToList<TestMeshlets>();
+    addTestToList<TestOptimize>();
+}
+
+struct TestMesh
+{
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+};
+
+// Regular grid in the XY plane, facing +Z
+static TestMesh createGrid(uint32_t size)
+{
+    TestMesh mesh;
+    for (uint32_t y = 0; y <= size; y++)
+    {
+        for (uint32_t x = 0; x <= size; x++) mesh.positions.push_back(glm::vec3(float(x), float(y), 0));
+    }
+    for (uint32_t y = 0; y < size; y++)
+    {
+        for (uint32_t x = 0; x < size; x++)
+        {
+            uint32_t v = y * (size + 1) + x;
+            uint32_t quad[6] = { v, v + 1, v + size + 2, v, v + size + 2, v + size + 1 };
+            mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+        }
+    }
+    return mesh;
+}
+
+// UV sphere with outward-facing counter-clockwise triangles
+static TestMesh createSphere(uint32_t rings, uint32_t segments)
+{
+    TestMesh mesh;
+    const float pi = 3.14159265f;
+    for (uint32_t r = 0; r <= rings; r++)
+    {
+        float theta = pi * r / rings;
+        for (uint32_t s = 0; s <= segments; s++)
+        {
+            float phi = 2 * pi * s / segments;
+            mesh.positions.push_back(glm::vec3(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)));
+        }
+    }
+    for (uint32_t r = 0; r < rings; r++)
+    {
+        for (uint32_t s = 0; s < segments; s++)
+        {
+            uint32_t v = r * (segments + 1) + s;
+            uint32_t w = v + segments + 1;
+            if (r != 0) mesh.indices.insert(mesh.indices.end(), { v, w, v + 1 });
+            if (r != rings - 1) mesh.indices.insert(mesh.indices.end(), { v + 1, w, w + 1 });
+        }
+    }
+    return mesh;
+}
+
+static void shuffleTriangles(std::vector<uint32_t>& indices, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    for (size_t t = indices.size() / 3; t > 1; t--)
+    {
+        size_t other = std::uniform_int_distribution<size_t>(0, t - 1)(rng);
+        for (uint32_t i = 0; i < 3; i++) std::swap(indices[(t - 1) * 3 + i], indices[other * 3 + i]);
+    }
+}
+
+// The set of triangles, with each triangle rotated so its smallest index comes first. The winding is preserved.
+static std::vector<std::array<uint32_t, 3>> getTriangleSet(const std::vector<uint32_t>& indices, const std::vector<uint32_t>* pVertexOrder = nullptr)
+{
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (size_t t = 0; t < indices.size(); t += 3)
+    {
+        std::array<uint32_t, 3> tri;
+        for (uint32_t i = 0; i < 3; i++) tri[i] = pVertexOrder ? (*pVertexOrder)[indices[t + i]] : indices[t + i];
+        while (tri[0] > tri[1] || tri[0] > tri[2]) std::rotate(tri.begin(), tri.begin() + 1, tri.end());
+        triangles.push_back(tri);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+testing_func(MeshOptimizerTest, TestVertexCache)
+{
+    TestMesh grid = createGrid(100);
+    shuffleTriangles(grid.indices, 1);
+    uint32_t vertexCount = (uint32_t)grid.positions.size();
+
+    std::vector<uint32_t> optimized = MeshOptimizer::optimizeVertexCache(grid.indices, vertexCount);
+    if (getTriangleSet(optimized) != getTriangleSet(grid.indices)) return test_fail("The triangles changed");
+
+    VertexCacheStats before = MeshOptimizer::analyzeVertexCache(grid.indices, vertexCount, 16);
+    VertexCacheStats after = MeshOptimizer::analyzeVertexCache(optimized, vertexCount, 16);
+    if (before.acmr < 2.5f) return test_fail("The shuffled grid should thrash the cache");
+    if (after.acmr > 0.8f || after.atvr > 1.6f) return test_fail("The optimized grid should be close to the ideal ACMR of 0.5");
+
+    // Degenerate triangles and unreferenced vertices
+    std::vector<uint32_t> degenerate = { 0, 0, 1, 2, 3, 4, 4, 4, 4 };
+    if (getTriangleSet(MeshOptimizer::optimizeVertexCache(degenerate, 8)) != getTriangleSet(degenerate)) return test_fail("Degenerate triangles were not preserved");
+    return test_pass();
+}
+
+testing_func(MeshOptimizerTest, TestOverdraw)
+{
+    TestMesh sphere = createSphere(48, 96);
+    uint32_t vertexCount = (uint32_t)sphere.positions.size();
+    std::vector<uint32_t> cacheOptimized = MeshOptimizer::optimizeVertexCache(sphere.indices, vertexCount);
+    float cacheAcmr = MeshOptimizer::analyzeVertexCache(cacheOptimized, vertexCount, 16).acmr;
+
+    const float threshold = 1.05f;
+    std::vector<uint32_t> optimized = MeshOptimizer::optimizeOverdraw(cacheOptimized, sphere.positions.data(), vertexCount, 16, threshold);
+    if (getTriangleSet(optimized) != getTriangleSet(sphere.indices)) return test_fail("The triangles changed");
+    float acmr = MeshOptimizer::analyzeVertexCache(optimized, vertexCount, 16).acmr;
+    if (acmr > cacheAcmr * threshold + 1e-3f) return test_fail("The overdraw pass lost too much vertex reuse");
+    if (optimized == cacheOptimized) return test_fail("The clusters were not reordered");
+
+    // The threshold is an upper bound, the clusters are free to move as long as each one keeps its own ACMR
+    std::vector<uint32_t> unchanged = MeshOptimizer::optimizeOverdraw(cacheOptimized, sphere.positions.data(), vertexCount, 16, 1.0f);
+    if (getTriangleSet(unchanged) != getTriangleSet(sphere.indices)) return test_fail("The triangles changed");
+    return test_pass();
+}
+
+testing_func(MeshOptimizerTest, TestVertexFetch)
+{
+    TestMesh grid = createGrid(20);
+    shuffleTriangles(grid.indices, 2);
+    // Drop a few triangles so some vertices are unused
+    grid.indices.resize(grid.indices.size() - 3 * 30);
+
+    std::vector<uint32_t> vertexOrder;
+    std::vector<uint32_t> remapped = MeshOptimizer::optimizeVertexFetch(grid.indices, (uint32_t)grid.positions.size(), vertexOrder);
+    if (getTriangleSet(remapped, &vertexOrder) != getTriangleSet(grid.indices)) return test_fail("The remapped triangles don't match");
+
+    std::vector<bool> used(grid.positions.size(), false);
+    for (uint32_t index : grid.indices) used[index] = true;
+    if (vertexOrder.size() != (size_t)std::count(used.begin(), used.end(), true)) return test_fail("Unused vertices should be dropped");
+
+    // Vertices are referenced in increasing order the first time
+    uint32_t next = 0;
+    for (uint32_t index : remapped)
+    {
+        if (index > next) return test_fail("The vertices are not in first-use order");
+        if (index == next) next++;
+    }
+    return test_pass();
+}
+
+testing_func(MeshOptimizerTest, TestMeshlets)
+{
+    TestMesh sphere = createSphere(32, 64);
+    uint32_t vertexCount = (uint32_t)sphere.positions.size();
+    std::vector<uint32_t> indices = MeshOptimizer::optimizeVertexCache(sphere.indices, vertexCount);
+    const uint32_t maxVertices = 64, maxTriangles = 124;
+    MeshletData data = MeshOptimizer::buildMeshlets(indices, sphere.positions.data(), vertexCount, maxVertices, maxTriangles);
+
+    std::vector<uint32_t> rebuilt;
+    for (const auto& meshlet : data.meshlets)
+    {
+        if (meshlet.vertexCount > maxVertices || meshlet.triangleCount > maxTriangles || meshlet.triangleCount == 0) return test_fail("Meshlet limits exceeded");
+        for (uint32_t i = 0; i < meshlet.triangleCount * 3; i++)
+        {
+            uint32_t local = data.triangles[meshlet.triangleOffset + i];
+            if (local >= meshlet.vertexCount) return test_fail("Local index out of range");
+            rebuilt.push_back(data.vertices[meshlet.vertexOffset + local]);
+        }
+        for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+        {
+            if (glm::length(sphere.positions[data.vertices[meshlet.vertexOffset + i]] - meshlet.center) > meshlet.radius * 1.0001f) return test_fail("A vertex is outside the bounding sphere");
+        }
+    }
+    if (rebuilt != indices) return test_fail("The meshlets don't reproduce the index buffer");
+    if (data.meshlets.size() > (indices.size() / 3 + maxTriangles - 1) / maxTriangles * 2) return test_fail("The meshlets are poorly filled");
+
+    // The cone test must be conservative, and still cull something
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> dist(-4, 4);
+    uint32_t culled = 0;
+    for (uint32_t view = 0; view < 64; view++)
+    {
+        glm::vec3 viewPosition(dist(rng), dist(rng), dist(rng));
+        if (glm::length(viewPosition) < 1.5f) continue;
+        for (const auto& meshlet : data.meshlets)
+        {
+            if (MeshOptimizer::isMeshletBackFacing(meshlet, viewPosition) == false) continue;
+            culled++;
+            for (uint32_t t = 0; t < meshlet.triangleCount; t++)
+            {
+                glm::vec3 p[3];
+                for (uint32_t i = 0; i < 3; i++) p[i] = sphere.positions[data.vertices[meshlet.vertexOffset + data.triangles[meshlet.triangleOffset + t * 3 + i]]];
+                glm::vec3 n = glm::cross(p[1] - p[0], p[2] - p[0]);
+                if (glm::dot(p[0] - viewPosition, n) < -1e-5f) return test_fail("A meshlet with a front-facing triangle was culled");
+            }
+        }
+    }
+    if (culled == 0) return test_fail("The normal cones never cull");
+    return test_pass();
+}
+
+testing_func(MeshOptimizerTest, TestOptimize)
+{
+    TestMesh sphere = createSphere(256, 512);
+    shuffleTriangles(sphere.indices, 4);
+    uint32_t vertexCount = (uint32_t)sphere.positions.size();
+
+    CpuTimer timer;
+    timer.update();
+    MeshOptimizer::Result result = MeshOptimizer::optimize(sphere.indices, sphere.positions.data(), vertexCount, MeshOptimizer::Desc());
+    timer.update();
+
+    if (getTriangleSet(result.indices, &result.vertexOrder) != getTriangleSet(sphere.indices)) return test_fail("The optimized mesh doesn't match the source");
+    if (result.after.acmr >= result.before.acmr * 0.5f || result.after.atvr > 1.6f) return test_fail("The optimization didn't improve the vertex reuse");
+    if (result.meshlets.meshlets.empty() || result.meshlets.vertices.size() < result.vertexOrder.size()) return test_fail("Meshlets are missing");
+
+    logInfo(std::to_string(sphere.indices.size() / 3) + " triangles optimized in " + std::to_string(timer.getElapsedTime() * 1000) + " ms. ACMR " +
+        std::to_string(result.before.acmr) + " -> " + std::to_string(result.after.acmr) + ", ATVR " + std::to_string(result.before.atvr) + " -> " +
+        std::to_string(result.after.atvr) + ", " + std::to_string(result.meshlets.meshlets.size()) + " meshlets");
+    return test_pass();
+}
+
+int main()
+{
+    MeshOptimizerTest meshOptimizerTest;
+    meshOptimizerTest.init();
+    meshOptimizerTest.run();
+    return 0;
+}
@@ -0,0 +1,232 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "PerformanceBaselineTest.h"
+#include <random>
+
+void PerformanceBaselineTest::addTests()
+{
+    addTestToList<TestIdenticalDistributions>();
+    addTestToList<TestRegression>();
+    addTestToList<TestOutlierRobustness>();
+    addTestToList<TestImprovement>();
+    addTestToList<TestMissingAndNewEvents>();
+    addTestToList<TestInsufficientData>();
+    addTestToList<TestJsonRoundTrip>();
+    addTestToList<TestRejectNewerVersion>();
+}
+
+using Verdict = PerformanceBaseline::Verdict;
+
+// Records a run of one event with noisy frame times. The GPU time is a fixed fraction of the CPU time.
+static PerformanceBaseline record(const std::string& event, uint32_t frames, float meanMs, float noise, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> noiseDist(1 - noise, 1 + noise);
+    PerformanceBaseline run;
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        float cpuMs = meanMs * noiseDist(rng);
+        run.addSample(event, cpuMs, cpuMs * 0.5f);
+        run.endFrame();
+    }
+    return run;
+}
+
+static const PerformanceBaseline::MetricComparison* findMetric(const PerformanceBaseline::Comparison& comparison, const std::string& event, bool gpu)
+{
+    for (const auto& m : comparison.metrics)
+    {
+        if (m.event == event && m.gpu == gpu) return &m;
+    }
+    return nullptr;
+}
+
+testing_func(PerformanceBaselineTest, TestIdenticalDistributions)
+{
+    // Different seeds of the same distribution shouldn't be flagged
+    PerformanceBaseline::CompareOptions options;
+    for (uint32_t seed = 0; seed < 20; seed++)
+    {
+        PerformanceBaseline baseline = record("pass", 100, 2, 0.1f, seed);
+        PerformanceBaseline current = record("pass", 100, 2, 0.1f, seed + 1000);
+        PerformanceBaseline::Comparison comparison = PerformanceBaseline::compare(baseline, current, options);
+        if (comparison.metrics.size() != 2) return test_fail("Expected a CPU and a GPU metric");
+        if (comparison.regressed) return test_fail("Identical distributions reported as a regression with seed " + std::to_string(seed));
+        for (const auto& m : comparison.metrics)
+        {
+            if (m.verdict != Verdict::Unchanged) return test_fail("Identical distributions reported as " + to_string(m.verdict));
+        }
+    }
+
+    // Identical samples tie on every rank
+    PerformanceBaseline run = record("pass", 50, 2, 0.1f, 1);
+    if (PerformanceBaseline::rankSumPValue(run.getEvents().at("pass").cpuMs, run.getEvents().at("pass").cpuMs) < 0.4f) return test_fail("Identical samples should have a high p-value");
+    return test_pass();
+}
+
+testing_func(PerformanceBaselineTest, TestRegression)
+{
+    PerformanceBaseline baseline = record("pass", 100, 2, 0.1f, 1);
+    PerformanceBaseline current = record("pass", 100, 2.4f, 0.1f, 2);
+    PerformanceBaseline::Comparison comparison = PerformanceBaseline::compare(baseline, current, {});
+    if (comparison.regressed == false) return test_fail("A 20% slowdown wasn't reported");
+    const auto* pCpu = findMetric(comparison, "pass", false);
+    const auto* pGpu = findMetric(comparison, "pass", true);
+    if (!pCpu || !pGpu) return test_fail("Missing metrics");
+    if (pCpu->verdict != Verdict::Regression || pGpu->verdict != Verdict::Regression) return test_fail("Expected both metrics to regress");
+    if (pCpu->change < 0.15f || pCpu->change > 0.25f) return test_fail("Wrong relative change " + std::to_string(pCpu->change));
+    if (pCpu->pValue > 1e-6f) return test_fail("Expected a tiny p-value, got " + std::to_string(pCpu->pValue));
+
+    // A significant change under the threshold isn't a regression
+    PerformanceBaseline::CompareOptions options;
+    options.threshold = 0.3f;
+    comparison = PerformanceBaseline::compare(baseline, current, options);
+    if (comparison.regressed) return test_fail("A change under the threshold was reported");
+    return test_pass();
+}
+
+testing_func(PerformanceBaselineTest, TestOutlierRobustness)
+{
+    // A few frames hitching by 10x move the mean by more than the threshold, but not the ranks
+    PerformanceBaseline baseline = record("pass", 100, 2, 0.1f, 1);
+    PerformanceBaseline current;
+    PerformanceBaseline noisy = record("pass", 100, 2, 0.1f, 2);
+    const auto& samples = noisy.getEvents().at("pass").cpuMs;
+    float mean = 0;
+    for (uint32_t i = 0; i < samples.size(); i++)
+    {
+        float ms = (i % 25 == 0) ? samples[i] * 10 : samples[i];
+        current.addSample("pass", ms, ms * 0.5f);
+        mean += ms / samples.size();
+    }
+    if (mean < 2 * 1.2f) return test_fail("The outliers should move the mean past the threshold");
+
+    PerformanceBaseline::Comparison comparison = PerformanceBaseline::compare(baseline, current, {});
+    if (comparison.regressed) return test_fail("Outliers were reported as a regression");
+    return test_pass();
+}
+
+testing_func(PerformanceBaselineTest, TestImprovement)
+{
+    PerformanceBaseline baseline = record("pass", 60, 3, 0.05f, 1);
+    PerformanceBaseline current = record("pass", 60, 2.4f, 0.05f, 2);
+    PerformanceBaseline::Comparison comparison = PerformanceBaseline::compare(baseline, current, {});
+    if (comparison.regressed) return test_fail("An improvement was reported as a regression");
+    const auto* pCpu = findMetric(comparison, "pass", false);
+    if (!pCpu || pCpu->verdict != Verdict::Improvement) return test_fail("Expected an improvement");
+    if (pCpu->change > -0.15f) return test_fail("Wrong relative change " + std::to_string(pCpu->change));
+    return test_pass();
+}
+
+testing_func(PerformanceBaselineTest, TestMissingAndNewEvents)
+{
+    PerformanceBaseline baseline = record("old", 20, 1, 0.1f, 1);
+    PerformanceBaseline current = record("new", 20, 1, 0.1f, 2);
+    PerformanceBaseline::Comparison comparison = PerformanceBaseline::compare(baseline, current, {});
+    if (comparison.regressed) return test_fail("Renamed events shouldn't fail the comparison");
+    const auto* pOld = findMetric(comparison, "old", false);
+    const auto* pNew = findMetric(comparison, "new", true);
+    if (!pOld || pOld->verdict != Verdict::Missing) return test_fail("Expected a missing event");
+    if (!pNew || pNew->verdict != Verdict::New) return test_fail("Expected a new event");
+    if (pOld->baselineMedian <= 0 || pNew->currentMedian <= 0) return test_fail("Unmatched events should report their median");
+
+    // Events too short to time reliably are ignored
+    baseline.addSample("tiny", 0.001f, 0);
+    current.addSample("tiny", 0.005f, 0);
+    comparison = PerformanceBaseline::compare(baseline, current, {});
+    const auto* pTiny = findMetric(comparison, "tiny", false);
+    if (!pTiny || pTiny->verdict != Verdict::Unchanged) return test_fail("Events under the minimal time should be unchanged");
+    return test_pass();
+}
+
+testing_func(PerformanceBaselineTest, TestInsufficientData)
+{
+    PerformanceBaseline baseline = record("pass", 100, 2, 0.1f, 1);
+    PerformanceBaseline current = record("pass", 5, 4, 0.1f, 2);
+    PerformanceBaseline::Comparison comparison = PerformanceBaseline::compare(baseline, current, {});
+    if (comparison.regressed) return test_fail("Too few samples shouldn't fail the comparison");
+    const auto* pCpu = findMetric(comparison, "pass", false);
+    if (!pCpu || pCpu->verdict != Verdict::InsufficientData) return test_fail("Expected insufficient data");
+
+    PerformanceBaseline::CompareOptions options;
+    options.minSamples = 5;
+    comparison = PerformanceBaseline::compare(baseline, current, options);
+    if (comparison.regressed == false) return test_fail("A 2x slowdown over 5 frames wasn't reported");
+    return test_pass();
+}
+
+testing_func(PerformanceBaselineTest, TestJsonRoundTrip)
+{
+    PerformanceBaseline baseline = record("pass", 10, 2, 0.1f, 1);
+    baseline.addSample("other \"quoted\"", 0.25f, 1.5f);
+    baseline.setDescription("test run");
+    std::string json = baseline.toJson();
+
+    PerformanceBaseline loaded;
+    std::string error;
+    if (PerformanceBaseline::fromJson(json, loaded, error) == false) return test_fail("Parsing failed: " + error);
+    if (loaded.getDescription() != "test run" || loaded.getFrameCount() != 10) return test_fail("Wrong header after the round-trip");
+    if (loaded.getEvents().size() != 2) return test_fail("Wrong event count after the round-trip");
+    for (const auto& e : baseline.getEvents())
+    {
+        auto it = loaded.getEvents().find(e.first);
+        if (it == loaded.getEvents().end()) return test_fail("Missing event " + e.first);
+        if (it->second.cpuMs != e.second.cpuMs || it->second.gpuMs != e.second.gpuMs) return test_fail("Samples changed in the round-trip of " + e.first);
+    }
+
+    // The verdict is machine-readable
+    PerformanceBaseline current = record("pass", 10, 4, 0.1f, 2);
+    PerformanceBaseline::Comparison comparison = PerformanceBaseline::compare(baseline, current, {});
+    std::string verdict = comparison.toJson();
+    if (verdict.find("\"verdict\": \"regression\"") == std::string::npos) return test_fail("The verdict JSON doesn't report the regression:\n" + verdict);
+
+    if (PerformanceBaseline::fromJson("{ \"version\": 1, \"events\": { \"pass\": { \"cpu\": [1, \"x\"] } } }", loaded, error)) return test_fail("Malformed samples were accepted");
+    if (PerformanceBaseline::fromJson("{ \"version\": 1, ", loaded, error)) return test_fail("Truncated JSON was accepted");
+    return test_pass();
+}
+
+testing_func(PerformanceBaselineTest, TestRejectNewerVersion)
+{
+    PerformanceBaseline loaded;
+    std::string error;
+    std::string json = "{ \"version\": " + std::to_string(PerformanceBaseline::kVersion + 1) + ", \"events\": {} }";
+    if (PerformanceBaseline::fromJson(json, loaded, error)) return test_fail("A newer version was accepted");
+    if (error.find("version") == std::string::npos) return test_fail("The error doesn't mention the version: " + error);
+    if (PerformanceBaseline::fromJson("{ \"events\": {} }", loaded, error)) return test_fail("A baseline without a version was accepted");
+    json = "{ \"version\": " + std::to_string(PerformanceBaseline::kVersion) + ", \"events\": {} }";
+    if (PerformanceBaseline::fromJson(json, loaded, error) == false) return test_fail("The current version was rejected: " + error);
+    return test_pass();
+}
+
+int main()
+{
+    PerformanceBaselineTest pbt;
+    pbt.init();
+    pbt.run();
+    return 0;
+}
@@ -0,0 +1,197 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "QueueScheduleTest.h"
+
+void QueueScheduleTest::addTests()
+{
+    addTestToList<TestGraphicsOnly>();
+    addTestToList<TestForkJoin>();
+    addTestToList<TestForkAtFrameStart>();
+    addTestToList<TestRedundantFences>();
+    addTestToList<TestHandoff>();
+    addTestToList<TestLifetimes>();
+    addTestToList<TestDenoiserGraph>();
+}
+
+using Pass = QueueSchedule::Pass;
+static const QueueSchedule::Queue kGfx = QueueSchedule::Queue::Graphics;
+static const QueueSchedule::Queue kCompute = QueueSchedule::Queue::Compute;
+
+static Pass pass(QueueSchedule::Queue queue, std::vector<uint32_t> dependencies = {}, float cost = 1)
+{
+    Pass p;
+    p.queue = queue;
+    p.cost = cost;
+    p.dependencies = dependencies;
+    return p;
+}
+
+// Compares the schedule against its expected dump, and reports both on mismatch
+static bool matchesGolden(const QueueSchedule& schedule, const std::vector<std::string>& names, const std::string& golden, std::string& error)
+{
+    std::string result = schedule.toString(names);
+    if (result == golden) return true;
+    error = "Expected:\n" + golden + "Got:\n" + result;
+    return false;
+}
+
+testing_func(QueueScheduleTest, TestGraphicsOnly)
+{
+    QueueSchedule schedule = QueueSchedule::build({ pass(kGfx), pass(kGfx, { 0 }), pass(kGfx, { 1 }) });
+    std::string error;
+    if (!matchesGolden(schedule, {},
+        "graphics: 0 1 2\n"
+        "critical path 3 of 3: 0 1 2\n", error)) return test_fail(error);
+    for (uint32_t p = 0; p < schedule.getPassCount(); p++)
+    {
+        if (schedule.signalsAfter(p)) return test_fail("A single queue shouldn't signal");
+        if (schedule.getLifetimeEnd(p) != p) return test_fail("A single queue shouldn't extend lifetimes");
+    }
+    return test_pass();
+}
+
+testing_func(QueueScheduleTest, TestForkJoin)
+{
+    // The compute pass overlaps the longer graphics pass, both consume pass 0 and pass 3 consumes both
+    QueueSchedule schedule = QueueSchedule::build({ pass(kGfx), pass(kCompute, { 0 }, 2), pass(kGfx, { 0 }, 3), pass(kGfx, { 1, 2 }) });
+    std::string error;
+    if (!matchesGolden(schedule, {},
+        "graphics: 0 2 3\n"
+        "compute: 1\n"
+        "fence graphics 0 -> 1\n"
+        "fence compute 1 -> 3\n"
+        "critical path 5 of 7: 0 2 3\n", error)) return test_fail(error);
+    if (!schedule.signalsAfter(0) || !schedule.signalsAfter(1) || schedule.signalsAfter(2) || schedule.signalsAfter(3)) return test_fail("Wrong signals");
+    return test_pass();
+}
+
+testing_func(QueueScheduleTest, TestForkAtFrameStart)
+{
+    // The compute pass is the first one, so it only waits for the work submitted before the frame. Nothing consumes pass 2, so the frame ends with a join.
+    QueueSchedule schedule = QueueSchedule::build({ pass(kCompute, {}, 2), pass(kGfx), pass(kCompute, { 0 }), pass(kGfx, { 0, 1 }) });
+    std::string error;
+    if (!matchesGolden(schedule, {},
+        "graphics: 1 3\n"
+        "compute: 0 2\n"
+        "fence graphics start -> 0\n"
+        "fence compute 0 -> 3\n"
+        "fence compute 2 -> end\n"
+        "critical path 3 of 5: 0 2\n", error)) return test_fail(error);
+    return test_pass();
+}
+
+testing_func(QueueScheduleTest, TestRedundantFences)
+{
+    // Pass 3 reads pass 0, which the compute queue already waited for. Pass 5's wait on pass 4 also covers pass 1.
+    QueueSchedule schedule = QueueSchedule::build(
+    {
+        pass(kGfx), pass(kGfx), pass(kCompute, { 0, 1 }), pass(kCompute, { 0 }), pass(kGfx, { 2 }), pass(kCompute, { 1, 4 }), pass(kGfx, { 3 })
+    });
+    std::string error;
+    if (!matchesGolden(schedule, {},
+        "graphics: 0 1 4 6\n"
+        "compute: 2 3 5\n"
+        "fence graphics 1 -> 2\n"
+        "fence compute 2 -> 4\n"
+        "fence graphics 4 -> 5\n"
+        "fence compute 3 -> 6\n"
+        "fence compute 5 -> end\n"
+        "critical path 5 of 7: 0 1 2 4 5\n", error)) return test_fail(error);
+    if (schedule.getFences().size() != 5) return test_fail("Wrong fence count");
+    return test_pass();
+}
+
+testing_func(QueueScheduleTest, TestHandoff)
+{
+    // The graphics queue transitions a resource for pass 3, which needs a new wait even though pass 3 has no dependencies
+    std::vector<Pass> passes = { pass(kGfx), pass(kCompute, { 0 }), pass(kGfx), pass(kCompute), pass(kGfx, { 1, 3 }) };
+    passes[3].handoff = true;
+    QueueSchedule schedule = QueueSchedule::build(passes);
+    std::string error;
+    if (!matchesGolden(schedule, {},
+        "graphics: 0 2 4\n"
+        "compute: 1 3\n"
+        "fence graphics 0 -> 1\n"
+        "handoff graphics 2 -> 3\n"
+        "fence compute 3 -> 4\n"
+        "critical path 4 of 5: 0 2 3 4\n", error)) return test_fail(error);
+    // The handoff signals right before the wait, not after pass 2
+    if (schedule.signalsAfter(2)) return test_fail("The handoff shouldn't signal after its source pass");
+    return test_pass();
+}
+
+testing_func(QueueScheduleTest, TestLifetimes)
+{
+    // Pass 1 overlaps pass 2, up to pass 4 which waits for it. Pass 2 overlaps pass 3, and pass 3 overlaps pass 4 until pass 5 waits for it.
+    QueueSchedule schedule = QueueSchedule::build({ pass(kGfx), pass(kCompute, { 0 }), pass(kGfx, { 0 }), pass(kCompute, { 1 }), pass(kGfx, { 1 }), pass(kGfx, { 3 }) });
+    const uint32_t expected[] = { 0, 2, 3, 4, 4, 5 };
+    for (uint32_t p = 0; p < schedule.getPassCount(); p++)
+    {
+        if (schedule.getLifetimeEnd(p) != expected[p])
+        {
+            return test_fail("Pass " + std::to_string(p) + " lifetime ends at " + std::to_string(schedule.getLifetimeEnd(p)) + ", expected " + std::to_string(expected[p]));
+        }
+    }
+    return test_pass();
+}
+
+testing_func(QueueScheduleTest, TestDenoiserGraph)
+{
+    // A path tracer with SVGF, where the variance estimation and the tone-mapping histogram run on the compute queue. The costs are in ms.
+    enum { GBuffer, PathTrace, Variance, Temporal, ATrous, Histogram, ToneMap, Count };
+    std::vector<std::string> names = { "gbuffer", "pathtrace", "variance", "temporal", "atrous", "histogram", "tonemap" };
+    std::vector<Pass> passes =
+    {
+        pass(kGfx, {}, 1.5f),                               // G-buffer
+        pass(kGfx, { GBuffer }, 6),                         // Path tracing
+        pass(kCompute, { GBuffer }, 1),                     // Variance estimation from the previous frame's moments
+        pass(kGfx, { PathTrace, Variance }, 1),             // Temporal accumulation
+        pass(kGfx, { GBuffer, Temporal }, 2),               // A-trous filter
+        pass(kCompute, { ATrous }, 0.5f),                   // Luminance histogram
+        pass(kGfx, { ATrous, Histogram }, 0.5f),            // Tone mapping
+    };
+    QueueSchedule schedule = QueueSchedule::build(passes);
+    std::string error;
+    if (!matchesGolden(schedule, names,
+        "graphics: gbuffer pathtrace temporal atrous tonemap\n"
+        "compute: variance histogram\n"
+        "fence graphics gbuffer -> variance\n"
+        "fence compute variance -> temporal\n"
+        "fence graphics atrous -> histogram\n"
+        "fence compute histogram -> tonemap\n"
+        "critical path 11.5 of 12.5: gbuffer pathtrace temporal atrous histogram tonemap\n", error)) return test_fail(error);
+    return test_pass();
+}
+
+int main()
+{
+    QueueScheduleTest qst;
+    qst.init();
+    qst.run();
+    return 0;
+}
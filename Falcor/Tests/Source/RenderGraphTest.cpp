@@ -0,0 +1,308 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "RenderGraphTest.h"
+#include "Utils/CpuTimer.h"
+
+void RenderGraphTest::addTests()
+{
+    addTestToList<TestSlotsMatchFields>();
+    addTestToList<TestExternalInputWithoutRecompile>();
+    addTestToList<TestPlannedTransitions>();
+    addTestToList<TestComputeAffinity>();
+    addTestToList<TestExecutionBenchmark>();
+}
+
+// A pass that does nothing but fetch its resources, the way a real pass does at the start of execute()
+class SyntheticPass : public RenderPass
+{
+public:
+    using SharedPtr = std::shared_ptr<SyntheticPass>;
+
+    // Slots are the field indices, in the order reflect() adds them
+    enum Slot : uint32_t { kIn, kOut, kScratch0, kScratch1, kSlotCount };
+    static const std::string kFieldNames[kSlotCount];
+
+    static SharedPtr create(bool isFirst) { return SharedPtr(new SyntheticPass(isFirst)); }
+
+    RenderPassReflection reflect() const override
+    {
+        mReflectCount++;
+        RenderPassReflection r;
+        auto& input = r.addInput(kFieldNames[kIn]);
+        if (mIsFirst) input.setFlags(RenderPassReflection::Field::Flags::Optional);
+        r.addOutput(kFieldNames[kOut]).setDimensions(16, 16, 1).setFormat(ResourceFormat::RGBA8Unorm);
+        r.addInternal(kFieldNames[kScratch0]).setDimensions(16, 16, 1).setFormat(ResourceFormat::RGBA8Unorm);
+        r.addInternal(kFieldNames[kScratch1]).setDimensions(16, 16, 1).setFormat(ResourceFormat::R32Float);
+        return r;
+    }
+
+    void execute(RenderContext* pContext, const RenderData* pData) override
+    {
+        for (uint32_t s = 0; s < kSlotCount; s++)
+        {
+            mTextures[s] = mUseNames ? pData->getTexture(kFieldNames[s]).get() : pData->getTexture(s).get();
+            mChecksum += uintptr_t(mTextures[s]);
+        }
+        mpLastData = pData;
+        mInState = mTextures[kIn] ? mTextures[kIn]->getGlobalState() : Resource::State::Undefined;
+        mOutState = mTextures[kOut]->getGlobalState();
+    }
+
+    QueueSchedule::Queue getQueueAffinity() const override { return mComputeAffinity ? QueueSchedule::Queue::Compute : QueueSchedule::Queue::Graphics; }
+
+    void executeCompute(ComputeContext* pContext, const RenderData* pData) override
+    {
+        mpComputeContext = pContext;
+        execute(nullptr, pData);
+    }
+
+    bool mComputeAffinity = false;
+    ComputeContext* mpComputeContext = nullptr;
+
+    bool mUseNames = false;
+    Texture* mTextures[kSlotCount] = {};
+    uintptr_t mChecksum = 0;
+    Resource::State mInState = Resource::State::Undefined;
+    Resource::State mOutState = Resource::State::Undefined;
+    const RenderData* mpLastData = nullptr;
+    mutable uint32_t mReflectCount = 0;
+
+private:
+    SyntheticPass(bool isFirst) : RenderPass("SyntheticPass"), mIsFirst(isFirst) {}
+    bool mIsFirst;
+};
+
+const std::string SyntheticPass::kFieldNames[kSlotCount] = { "in", "out", "scratch0", "scratch1" };
+
+static std::string passName(uint32_t i)
+{
+    return "pass" + std::to_string(i);
+}
+
+// A chain of passes, each one reading the previous pass' output
+static RenderGraph::SharedPtr createChain(uint32_t passCount, std::vector<SyntheticPass::SharedPtr>& passes)
+{
+    RenderGraph::SharedPtr pGraph = RenderGraph::create("Synthetic");
+    for (uint32_t i = 0; i < passCount; i++)
+    {
+        passes.push_back(SyntheticPass::create(i == 0));
+        pGraph->addPass(passes.back(), passName(i));
+        if (i > 0) pGraph->addEdge(passName(i - 1) + ".out", passName(i) + ".in");
+    }
+    pGraph->markOutput(passName(passCount - 1) + ".out");
+    return pGraph;
+}
+
+testing_func(RenderGraphTest, TestSlotsMatchFields)
+{
+    RenderContext* pContext = gpDevice->getRenderContext().get();
+    std::vector<SyntheticPass::SharedPtr> passes;
+    RenderGraph::SharedPtr pGraph = createChain(5, passes);
+    pGraph->execute(pContext);
+
+    for (uint32_t i = 0; i < passes.size(); i++)
+    {
+        const RenderData* pData = passes[i]->mpLastData;
+        if (!pData) return test_fail("A pass didn't execute");
+        if (pData->getName() != passName(i)) return test_fail("Wrong pass name in RenderData");
+        if (pData->getSlotCount() != SyntheticPass::kSlotCount) return test_fail("Wrong slot count");
+        for (uint32_t s = 0; s < SyntheticPass::kSlotCount; s++)
+        {
+            if (pData->getSlot(SyntheticPass::kFieldNames[s]) != s) return test_fail("Slot doesn't match the field index");
+            if (pData->getTexture(s) != pData->getTexture(SyntheticPass::kFieldNames[s])) return test_fail("Slot and name lookups disagree");
+        }
+        if (!passes[i]->mTextures[SyntheticPass::kOut] || !passes[i]->mTextures[SyntheticPass::kScratch0]) return test_fail("Outputs and internals should be allocated");
+        if (i > 0 && passes[i]->mTextures[SyntheticPass::kIn] != passes[i - 1]->mTextures[SyntheticPass::kOut]) return test_fail("An input is not bound to the output it's connected to");
+        if (pData->getSlot("missing") != RenderPassReflection::kInvalidField) return test_fail("Unknown field names should return kInvalidField");
+        if (pData->getTexture(SyntheticPass::kSlotCount) != nullptr) return test_fail("Out of range slots should return nullptr");
+    }
+    if (passes[0]->mTextures[SyntheticPass::kIn] != nullptr) return test_fail("An unconnected input should be unbound");
+    if (pGraph->getOutput(passName(4) + ".out").get() != passes[4]->mTextures[SyntheticPass::kOut]) return test_fail("The graph output doesn't match the pass output");
+    return test_pass();
+}
+
+testing_func(RenderGraphTest, TestExternalInputWithoutRecompile)
+{
+    RenderContext* pContext = gpDevice->getRenderContext().get();
+    std::vector<SyntheticPass::SharedPtr> passes;
+    RenderGraph::SharedPtr pGraph = createChain(3, passes);
+    pGraph->execute(pContext);
+    uint32_t reflectCount = passes[0]->mReflectCount;
+
+    // Executing again must not recompile
+    pGraph->execute(pContext);
+    if (passes[0]->mReflectCount != reflectCount) return test_fail("The graph recompiled without changes");
+
+    // Binding an input patches the plan in place
+    Texture::SharedPtr pInput = Texture::create2D(16, 16, ResourceFormat::RGBA8Unorm, 1, 1, nullptr, Resource::BindFlags::ShaderResource);
+    pGraph->setInput(passName(0) + ".in", pInput);
+    pGraph->execute(pContext);
+    if (passes[0]->mTextures[SyntheticPass::kIn] != pInput.get()) return test_fail("The external input is not bound");
+    if (passes[0]->mReflectCount != reflectCount) return test_fail("Binding an input recompiled the graph");
+
+    Texture::SharedPtr pOtherInput = Texture::create2D(16, 16, ResourceFormat::RGBA8Unorm, 1, 1, nullptr, Resource::BindFlags::ShaderResource);
+    pGraph->setInput(passName(0) + ".in", pOtherInput);
+    pGraph->execute(pContext);
+    if (passes[0]->mTextures[SyntheticPass::kIn] != pOtherInput.get()) return test_fail("Replacing the external input didn't update the binding");
+
+    // A recompilation resolves the external input again
+    pGraph->unmarkOutput(passName(2) + ".out");
+    pGraph->markOutput(passName(2) + ".out");
+    pGraph->execute(pContext);
+    if (passes[0]->mReflectCount == reflectCount) return test_fail("Changing the outputs should recompile");
+    if (passes[0]->mTextures[SyntheticPass::kIn] != pOtherInput.get()) return test_fail("The external input was lost by the recompilation");
+    return test_pass();
+}
+
+testing_func(RenderGraphTest, TestPlannedTransitions)
+{
+    // The graph transitions the resources before each pass, so the passes find them in the state their reflection asked for.
+    // On the first frame the resources are not where the plan expects them, which must not matter.
+    RenderContext* pContext = gpDevice->getRenderContext().get();
+    std::vector<SyntheticPass::SharedPtr> passes;
+    RenderGraph::SharedPtr pGraph = createChain(4, passes);
+    Texture::SharedPtr pInputs[2];
+    for (auto& pInput : pInputs) pInput = Texture::create2D(16, 16, ResourceFormat::RGBA8Unorm, 1, 1, nullptr, Resource::BindFlags::ShaderResource);
+    for (uint32_t frame = 0; frame < 4; frame++)
+    {
+        // The first pass' input is unbound when the graph compiles, then bound and replaced each frame without recompiling
+        if (frame > 0) pGraph->setInput(passName(0) + ".in", pInputs[frame % 2]);
+        pGraph->execute(pContext);
+        if (frame > 0 && passes[0]->mTextures[SyntheticPass::kIn] != pInputs[frame % 2].get()) return test_fail("The external input is not bound");
+        for (uint32_t i = 0; i < passes.size(); i++)
+        {
+            if (passes[i]->mOutState != Resource::State::RenderTarget) return test_fail("An output is not in the RenderTarget state");
+            if ((i > 0 || frame > 0) && passes[i]->mInState != Resource::State::ShaderResource) return test_fail("An input is not in the ShaderResource state");
+        }
+    }
+    pContext->flush(true);
+    return test_pass();
+}
+
+testing_func(RenderGraphTest, TestComputeAffinity)
+{
+    RenderContext* pContext = gpDevice->getRenderContext().get();
+    std::vector<SyntheticPass::SharedPtr> passes;
+    RenderGraph::SharedPtr pGraph = createChain(3, passes);
+    passes[1]->mComputeAffinity = true;
+    for (uint32_t frame = 0; frame < 3; frame++)
+    {
+        pGraph->execute(pContext);
+        if (passes[1]->mpLastData == nullptr || passes[1]->mpComputeContext == nullptr) return test_fail("executeCompute() wasn't called");
+        if (passes[1]->mInState != Resource::State::NonPixelShader) return test_fail("A compute pass input is not in the NonPixelShader state");
+        if (passes[2]->mInState != Resource::State::ShaderResource) return test_fail("A graphics pass input is not in the ShaderResource state");
+    }
+
+    // The test device has no compute queue, so the graph runs on the graphics queue
+    const QueueSchedule& schedule = pGraph->getQueueSchedule();
+    if (schedule.getPassCount() != 3) return test_fail("Wrong pass count in the schedule");
+    bool async = gpDevice->getCommandQueueCount(LowLevelContextData::CommandQueueType::Compute) > 0;
+    if (!async)
+    {
+        if (passes[1]->mpComputeContext != pContext) return test_fail("A compute pass should use the graphics context without a compute queue");
+        if (schedule.getFences().size()) return test_fail("A single queue shouldn't need fences");
+    }
+    else if (schedule.getQueue(1) != QueueSchedule::Queue::Compute) return test_fail("The compute pass is not on the compute queue");
+
+    // Disabling async compute recompiles the graph onto the graphics queue
+    pGraph->setAsyncCompute(false);
+    pGraph->execute(pContext);
+    if (pGraph->getQueueSchedule().getQueuePasses(QueueSchedule::Queue::Compute).size()) return test_fail("Async compute is disabled");
+    if (passes[1]->mpComputeContext != pContext) return test_fail("A compute pass should use the graphics context when async compute is disabled");
+    pContext->flush(true);
+    return test_pass();
+}
+
+testing_func(RenderGraphTest, TestExecutionBenchmark)
+{
+    const uint32_t passCount = 100;
+    const uint32_t frameCount = 1000;
+    RenderContext* pContext = gpDevice->getRenderContext().get();
+    std::vector<SyntheticPass::SharedPtr> passes;
+    RenderGraph::SharedPtr pGraph = createChain(passCount, passes);
+    pGraph->execute(pContext);
+
+    auto runFrames = [&](bool useNames)
+    {
+        for (auto& pPass : passes) pPass->mUseNames = useNames;
+        CpuTimer timer;
+        timer.update();
+        for (uint32_t f = 0; f < frameCount; f++) pGraph->execute(pContext);
+        timer.update();
+        pContext->flush(true);
+        return timer.getElapsedTime() * 1000 / frameCount;
+    };
+
+    uintptr_t checksumBefore = passes.back()->mChecksum;
+    double slotMs = runFrames(false);
+    uintptr_t slotChecksum = passes.back()->mChecksum - checksumBefore;
+    double nameMs = runFrames(true);
+    uintptr_t nameChecksum = passes.back()->mChecksum - checksumBefore - slotChecksum;
+    if (slotChecksum != nameChecksum) return test_fail("Slot and name lookups bound different resources");
+
+    // The previous per-frame cost: a `passName.fieldName` string and a hash lookup per resource, through the same ResourceCache.
+    // The fields are registered but not allocated, which doesn't change the lookup cost.
+    ResourceCache::SharedPtr pCache = ResourceCache::create();
+    RenderPassReflection reflection = passes[1]->reflect();
+    std::vector<std::string> names;
+    for (uint32_t i = 0; i < passCount; i++)
+    {
+        names.push_back(passName(i));
+        for (uint32_t s = 0; s < SyntheticPass::kSlotCount; s++) pCache->registerField(passName(i) + '.' + SyntheticPass::kFieldNames[s], reflection.getField(s), i);
+    }
+    uintptr_t legacyChecksum = 0;
+    CpuTimer timer;
+    timer.update();
+    for (uint32_t f = 0; f < frameCount; f++)
+    {
+        for (uint32_t i = 0; i < passCount; i++)
+        {
+            for (uint32_t s = 0; s < SyntheticPass::kSlotCount; s++)
+            {
+                legacyChecksum += uintptr_t(std::dynamic_pointer_cast<Texture>(pCache->getResource(names[i] + '.' + SyntheticPass::kFieldNames[s])).get()) + 1;
+            }
+        }
+    }
+    timer.update();
+    double legacyMs = timer.getElapsedTime() * 1000 / frameCount;
+
+    // The graph times include recording the planned barriers
+    logInfo("Executing a " + std::to_string(passCount) + "-pass graph with " + std::to_string(SyntheticPass::kSlotCount) + " resources per pass: " +
+        std::to_string(slotMs * 1000) + " us/frame by slot, " + std::to_string(nameMs * 1000) + " us/frame by name, " +
+        std::to_string(legacyMs * 1000) + " us/frame for the per-frame string lookups alone");
+    if (legacyChecksum == 0) return test_fail("Unexpected checksum");
+    return test_pass();
+}
+
+int main()
+{
+    RenderGraphTest rgt;
+    rgt.init(true);
+    rgt.run();
+    return 0;
+}
@@ -0,0 +1,151 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "ResourceBarrierPlanTest.h"
+
+void ResourceBarrierPlanTest::addTests()
+{
+    addTestToList<TestChain>();
+    addTestToList<TestSplitAcrossIdlePasses>();
+    addTestToList<TestUavBarriers>();
+    addTestToList<TestRedundantReads>();
+    addTestToList<TestDenoiserGraph>();
+}
+
+using Access = ResourceBarrierPlan::Access;
+static const Resource::State kRtv = Resource::State::RenderTarget;
+static const Resource::State kSrv = Resource::State::ShaderResource;
+static const Resource::State kUav = Resource::State::UnorderedAccess;
+
+static Access read(uint32_t resource, Resource::State state = kSrv) { return { resource, state, false }; }
+static Access write(uint32_t resource, Resource::State state = kRtv) { return { resource, state, true }; }
+
+// Compares the plan against its expected dump, and reports both on mismatch
+static bool matchesGolden(const ResourceBarrierPlan& plan, const std::vector<std::string>& names, const std::string& golden, std::string& error)
+{
+    std::string result = plan.toString(names);
+    if (result == golden) return true;
+    error = "Expected:\n" + golden + "Got:\n" + result;
+    return false;
+}
+
+testing_func(ResourceBarrierPlanTest, TestChain)
+{
+    // 0 writes a, 1 reads a and writes b, 2 reads b and writes c
+    std::vector<std::vector<Access>> passes = { { write(0) }, { read(0), write(1) }, { read(1), write(2) } };
+    ResourceBarrierPlan plan = ResourceBarrierPlan::build(3, passes);
+    std::string error;
+    if (!matchesGolden(plan, { "a", "b", "c" },
+        "pass 0: transition a ShaderResource->RenderTarget; begin b ShaderResource->RenderTarget;\n"
+        "pass 1: transition a RenderTarget->ShaderResource; end b ShaderResource->RenderTarget;\n"
+        "pass 2: transition b RenderTarget->ShaderResource;\n", error)) return test_fail(error);
+    return test_pass();
+}
+
+testing_func(ResourceBarrierPlanTest, TestSplitAcrossIdlePasses)
+{
+    // A G-buffer written by pass 0 and only read by pass 3. The transition overlaps passes 1 and 2.
+    std::vector<std::vector<Access>> passes = { { write(0) }, { write(1) }, { read(1), write(2) }, { read(0), read(2), write(3) } };
+    ResourceBarrierPlan plan = ResourceBarrierPlan::build(4, passes);
+    std::string error;
+    if (!matchesGolden(plan, { "gbuffer", "a", "b", "out" },
+        "pass 0: transition gbuffer ShaderResource->RenderTarget; begin a ShaderResource->RenderTarget; begin b ShaderResource->RenderTarget;\n"
+        "pass 1: begin gbuffer RenderTarget->ShaderResource; end a ShaderResource->RenderTarget;\n"
+        "pass 2: transition a RenderTarget->ShaderResource; end b ShaderResource->RenderTarget;\n"
+        "pass 3: end gbuffer RenderTarget->ShaderResource; transition b RenderTarget->ShaderResource;\n", error)) return test_fail(error);
+    if (plan.getBarrierCount() != 9) return test_fail("Wrong barrier count");
+    return test_pass();
+}
+
+testing_func(ResourceBarrierPlanTest, TestUavBarriers)
+{
+    // Compute passes: 0 writes, 1 reads and writes, 2 and 3 only read. Reads after reads need no barrier.
+    std::vector<std::vector<Access>> passes = { { write(0, kUav) }, { write(0, kUav) }, { read(0, kUav) }, { read(0, kUav) }, { read(0) } };
+    ResourceBarrierPlan plan = ResourceBarrierPlan::build(1, passes);
+    std::string error;
+    if (!matchesGolden(plan, { "buffer" },
+        "pass 0: transition buffer ShaderResource->UnorderedAccess;\n"
+        "pass 1: uav buffer;\n"
+        "pass 2: uav buffer;\n"
+        "pass 4: transition buffer UnorderedAccess->ShaderResource;\n", error)) return test_fail(error);
+    return test_pass();
+}
+
+testing_func(ResourceBarrierPlanTest, TestRedundantReads)
+{
+    // Several passes read the same texture: a single transition. Pass 1 also lists its output twice, as an input and an output; the write wins.
+    std::vector<std::vector<Access>> passes = { { write(0) }, { read(0), read(1), write(1) }, { read(0) }, { read(0), read(1) } };
+    ResourceBarrierPlan plan = ResourceBarrierPlan::build(2, passes);
+    std::string error;
+    if (!matchesGolden(plan, { "color", "inout" },
+        "pass 0: transition color ShaderResource->RenderTarget; begin inout ShaderResource->RenderTarget;\n"
+        "pass 1: transition color RenderTarget->ShaderResource; end inout ShaderResource->RenderTarget;\n"
+        "pass 2: begin inout RenderTarget->ShaderResource;\n"
+        "pass 3: end inout RenderTarget->ShaderResource;\n", error)) return test_fail(error);
+
+    // A resource used in a single state never needs a transition
+    ResourceBarrierPlan readOnly = ResourceBarrierPlan::build(1, { { read(0) }, {}, { read(0) } });
+    if (readOnly.getBarrierCount() != 0) return test_fail("A read-only resource shouldn't transition");
+    return test_pass();
+}
+
+testing_func(ResourceBarrierPlanTest, TestDenoiserGraph)
+{
+    // Shaped like a G-buffer + shading + temporal accumulation + 3 a-trous iterations ping-ponging between two textures.
+    // The history is read in one half of the frame and written in the other, so both of its transitions are split.
+    enum { Pos, Norm, Color, History, Integrated, Ping, Pong, Output, Count };
+    std::vector<std::string> names = { "pos", "norm", "color", "history", "integrated", "ping", "pong", "output" };
+    std::vector<std::vector<Access>> passes =
+    {
+        { write(Pos), write(Norm) },                                            // G-buffer
+        { read(Pos), read(Norm), write(Color, kUav) },                          // Ray traced shading
+        { read(Color), read(Pos), read(History), write(Integrated) },           // Temporal accumulation
+        { read(Integrated), read(Norm), write(Ping) },                          // A-trous 0
+        { read(Ping), read(Norm), write(Pong), write(History) },                // A-trous 1, also feeds the next frame's history
+        { read(Pong), read(Norm), write(Ping) },                                // A-trous 2
+        { read(Ping), write(Output) },                                          // Tone mapping
+    };
+    ResourceBarrierPlan plan = ResourceBarrierPlan::build(Count, passes);
+    std::string error;
+    if (!matchesGolden(plan, names,
+        "pass 0: transition pos ShaderResource->RenderTarget; transition norm ShaderResource->RenderTarget; begin color ShaderResource->UnorderedAccess; begin history RenderTarget->ShaderResource; begin integrated ShaderResource->RenderTarget; begin ping ShaderResource->RenderTarget; begin pong ShaderResource->RenderTarget;\n"
+        "pass 1: transition pos RenderTarget->ShaderResource; transition norm RenderTarget->ShaderResource; end color ShaderResource->UnorderedAccess;\n"
+        "pass 2: transition color UnorderedAccess->ShaderResource; end history RenderTarget->ShaderResource; end integrated ShaderResource->RenderTarget;\n"
+        "pass 3: begin history ShaderResource->RenderTarget; transition integrated RenderTarget->ShaderResource; end ping ShaderResource->RenderTarget;\n"
+        "pass 4: end history ShaderResource->RenderTarget; transition ping RenderTarget->ShaderResource; end pong ShaderResource->RenderTarget;\n"
+        "pass 5: transition ping ShaderResource->RenderTarget; transition pong RenderTarget->ShaderResource;\n"
+        "pass 6: transition ping RenderTarget->ShaderResource;\n", error)) return test_fail(error);
+    return test_pass();
+}
+
+int main()
+{
+    ResourceBarrierPlanTest rbpt;
+    rbpt.init();
+    rbpt.run();
+    return 0;
+}
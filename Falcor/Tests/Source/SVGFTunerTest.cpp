@@ -0,0 +1,176 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "SVGFTunerTest.h"
+#include <cmath>
+#include <cstdio>
+
+void SVGFTunerTest::addTests()
+{
+    addTestToList<TestDenoiserMatchesShaders>();
+    addTestToList<TestParetoFront>();
+    addTestToList<TestParamsRoundTrip>();
+}
+
+static float getLuminance(float v)
+{
+    return (0.2126f + 0.7152f + 0.0722f) * v;
+}
+
+// A 2x1 gray image with a single normal and depth, so the depth and normal weights are 1. The world positions are at the
+// pixel corners, which the identity previous view-projection maps back onto the same pixel with a bilinear weight of 1.
+static SVGFFrame createFrame(float left, float right)
+{
+    SVGFFrame frame;
+    frame.width = 2;
+    frame.height = 1;
+    frame.prevViewProj = glm::mat4(1.0f);
+    for (uint32_t x = 0; x < 2; x++)
+    {
+        float v = x ? right : left;
+        frame.color.push_back(glm::vec4(v, v, v, 1));
+        frame.reference.push_back(glm::vec4(v, v, v, 1));
+        frame.worldPos.push_back(glm::vec4(float(x) - 1, 1, 0.5f, 1));
+        frame.worldNorm.push_back(glm::vec4(0, 0, 1, 1));
+    }
+    return frame;
+}
+
+// SVGFATrous.ps.hlsl for the fixture: the 3x3 variance Gaussian only sees the center (0.25) and the other pixel (0.125),
+// the 5x5 kernel weighs them 0.375 and 0.25
+static void aTrous(const float color[2], const float variance[2], float sigmaL, float result[2])
+{
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        uint32_t j = 1 - i;
+        float filteredVariance = (0.25f * variance[i] + 0.125f * variance[j]) / 0.375f;
+        float weightL = std::exp(-std::abs(getLuminance(color[i]) - getLuminance(color[j])) / (sigmaL * std::sqrt(filteredVariance) + 0.001f));
+        result[i] = (0.375f * color[i] + 0.25f * weightL * color[j]) / (0.375f + 0.25f * weightL);
+    }
+}
+
+testing_func(SVGFTunerTest, TestDenoiserMatchesShaders)
+{
+    // With two iterations the second one steps 2 pixels and only sees the center, so the output is the first iteration's
+    SVGFParams params;
+    params.iterations = 2;
+    SVGFCpuDenoiser::UniquePtr pDenoiser = SVGFCpuDenoiser::create(2, 1, params);
+
+    const float frameColors[2][2] = { { 0.2f, 0.6f }, { 0.5f, 0.3f } };
+    float history[2] = { 0, 0 };
+    float moments[2][2] = { { 0, 0 }, { 0, 0 } };
+    for (uint32_t f = 0; f < 2; f++)
+    {
+        // SVGFTemporalPlusVariance.ps.hlsl: the first frame has no history, the second one has a history length of 1
+        float alpha = (f == 0) ? 1.0f : std::max(params.alpha, 0.5f);
+        float alphaMoments = (f == 0) ? 1.0f : std::max(params.alphaMoments, 0.5f);
+        float color[2], variance[2];
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            float l = getLuminance(frameColors[f][i]);
+            color[i] = history[i] + (frameColors[f][i] - history[i]) * alpha;
+            moments[i][0] += (l - moments[i][0]) * alphaMoments;
+            moments[i][1] += (l * l - moments[i][1]) * alphaMoments;
+            variance[i] = std::max(0.0f, moments[i][0] - moments[i][1] * moments[i][1]);
+        }
+
+        float expected[2];
+        aTrous(color, variance, params.sigmaL, expected);
+
+        std::vector<glm::vec4> output;
+        pDenoiser->denoise(createFrame(frameColors[f][0], frameColors[f][1]), output);
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                if (std::abs(output[i][c] - expected[i]) > 1e-5f) return test_fail("Frame " + std::to_string(f) + " differs from the shaders");
+            }
+            if (output[i].w != 1) return test_fail("The output alpha isn't 1");
+        }
+
+        // The first a-trous iteration's output is the next frame's color history
+        history[0] = expected[0];
+        history[1] = expected[1];
+    }
+    return test_pass();
+}
+
+testing_func(SVGFTunerTest, TestParetoFront)
+{
+    // Point 1 is dominated by point 0, point 4 by point 3, and point 5 has no error
+    const std::vector<double> errors = { 0.5, 0.6, 0.9, 0.3, 0.35, NAN, 0.1 };
+    const std::vector<double> ms     = { 2.0, 3.0, 1.0, 4.0, 4.0,  0.5, 8.0 };
+    const std::vector<size_t> front = SVGFTuner::findParetoFront(errors, ms);
+    const std::vector<size_t> expected = { 2, 0, 3, 6 };
+    if (front != expected) return test_fail("Wrong Pareto front");
+
+    // No point on the front may be dominated by any other point
+    for (size_t i : front)
+    {
+        for (size_t j = 0; j < errors.size(); j++)
+        {
+            bool dominates = errors[j] <= errors[i] && ms[j] <= ms[i] && (errors[j] < errors[i] || ms[j] < ms[i]);
+            if (dominates) return test_fail("A point on the Pareto front is dominated");
+        }
+    }
+
+    if (SVGFTuner::findParetoFront({}, {}).size()) return test_fail("The Pareto front of nothing isn't empty");
+    return test_pass();
+}
+
+testing_func(SVGFTunerTest, TestParamsRoundTrip)
+{
+    SVGFParams params;
+    params.iterations = 3;
+    params.sigmaZ = 2.5f;
+    params.sigmaN = 64;
+    params.sigmaL = 7.25f;
+    params.alpha = 0.125f;
+    params.alphaMoments = 0.5f;
+
+    const std::string filename = "SVGFTunerTest.svgf.txt";
+    if (!params.save(filename)) return test_fail("Can't save the parameters");
+    SVGFParams loaded;
+    bool success = loaded.load(filename);
+    std::remove(filename.c_str());
+    if (!success) return test_fail("Can't load the parameters");
+
+    if (loaded.iterations != params.iterations || loaded.sigmaZ != params.sigmaZ || loaded.sigmaN != params.sigmaN || loaded.sigmaL != params.sigmaL ||
+        loaded.alpha != params.alpha || loaded.alphaMoments != params.alphaMoments)
+    {
+        return test_fail("The parameters changed in the round trip: " + loaded.toString());
+    }
+    return test_pass();
+}
+
+int main()
+{
+    SVGFTunerTest stt;
+    stt.init();
+    stt.run();
+    return 0;
+}
@@ -0,0 +1,230 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "ShaderHotReloadTest.h"
+#include "Utils/CpuTimer.h"
+#include <experimental/filesystem>
+#include <fstream>
+#include <chrono>
+#include <thread>
+
+namespace fs = std::experimental::filesystem;
+
+void ShaderHotReloadTest::addTests()
+{
+    addTestToList<TestParseIncludes>();
+    addTestToList<TestAffectedPrograms>();
+    addTestToList<TestScanFromDisk>();
+    addTestToList<TestFileWatcher>();
+}
+
+static bool contains(const std::vector<std::string>& v, const std::string& s)
+{
+    return std::find(v.begin(), v.end(), s) != v.end();
+}
+
+static std::string createTempDirectory()
+{
+    fs::path dir = fs::temp_directory_path() / "FalcorShaderHotReloadTest";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    return FileWatcher::canonicalizePath(dir.string());
+}
+
+static void writeFile(const std::string& filename, const std::string& content)
+{
+    std::ofstream(filename, std::ios::trunc) << content;
+}
+
+// Wait until the watcher reports the expected file, or give up after a timeout
+static bool waitForChange(FileWatcher::SharedPtr pWatcher, const std::string& filename, std::vector<std::string>& changed)
+{
+    for (uint32_t i = 0; i < 200; i++)
+    {
+        auto files = pWatcher->getChangedFiles();
+        changed.insert(changed.end(), files.begin(), files.end());
+        if (contains(changed, filename)) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+testing_func(ShaderHotReloadTest, TestParseIncludes)
+{
+    const std::string source =
+        "#include \"HostDeviceSharedMacros.h\"\n"
+        "  #  include <Effects/SVGFCommon.hlsli>\n"
+        "// #include \"Commented.hlsli\"\n"
+        "/* #include \"Block.hlsli\"\n"
+        "   import Disabled; */\n"
+        "import Shading;\n"
+        "__import Raytracing.standardShadowRay ;\n"
+        "#define includeMe 1\n"
+        "float4 main() : SV_TARGET { return float4(0); } // import Trailing;\n";
+
+    auto includes = ShaderDependencyGraph::parseIncludes(source);
+    if (includes.size() != 4) return test_fail("Wrong number of includes");
+    if (includes[0] != "HostDeviceSharedMacros.h") return test_fail("Quoted include not parsed");
+    if (includes[1] != "Effects/SVGFCommon.hlsli") return test_fail("Angle bracket include not parsed");
+    if (includes[2] != "Shading.slang") return test_fail("Import not parsed");
+    if (includes[3] != "Raytracing/standardShadowRay.slang") return test_fail("Module path not converted to a file path");
+    return test_pass();
+}
+
+testing_func(ShaderHotReloadTest, TestAffectedPrograms)
+{
+    // Paths don't exist on disk, the graph is only fed resolved edges
+    ShaderDependencyGraph graph;
+    graph.setFileIncludes("/shaders/SVGFATrous.ps.hlsl", { "/shaders/SVGFCommon.hlsli" });
+    graph.setFileIncludes("/shaders/SVGFReproject.ps.hlsl", { "/shaders/SVGFCommon.hlsli" });
+    graph.setFileIncludes("/shaders/SVGFCommon.hlsli", {});
+    graph.setFileIncludes("/shaders/GGXGlobalIllumination.rt.hlsl", { "/shaders/standardShadowRay.hlsli", "/shaders/Common.hlsli" });
+    graph.setFileIncludes("/shaders/AmbientOcclusion.rt.hlsl", { "/shaders/Common.hlsli" });
+    graph.setFileIncludes("/shaders/Common.hlsli", { "/shaders/standardShadowRay.hlsli" });
+
+    int atrous, reproject, ggx, ao;
+    graph.addProgramFiles(&atrous, { "/shaders/SVGFATrous.ps.hlsl" });
+    graph.addProgramFiles(&reproject, { "/shaders/SVGFReproject.ps.hlsl" });
+    graph.addProgramFiles(&ggx, { "/shaders/GGXGlobalIllumination.rt.hlsl" });
+    graph.addProgramFiles(&ao, { "/shaders/AmbientOcclusion.rt.hlsl" });
+
+    auto affected = graph.getAffectedPrograms("/shaders/SVGFATrous.ps.hlsl");
+    if (affected.size() != 1 || affected[0] != &atrous) return test_fail("Editing a pass shader should only reload that pass");
+
+    affected = graph.getAffectedPrograms("/shaders/SVGFCommon.hlsli");
+    if (affected.size() != 2) return test_fail("Editing a shared include should reload its users");
+
+    // Transitive: AO reaches the shadow ray header through Common.hlsli
+    affected = graph.getAffectedPrograms("/shaders/standardShadowRay.hlsli");
+    if (affected.size() != 2 || std::count(affected.begin(), affected.end(), &ao) != 1) return test_fail("Transitive includes are not tracked");
+
+    // Changing the edges of a file must update the reverse edges
+    graph.setFileIncludes("/shaders/Common.hlsli", {});
+    affected = graph.getAffectedPrograms("/shaders/standardShadowRay.hlsli");
+    if (affected.size() != 1 || affected[0] != &ggx) return test_fail("Removed include is still tracked");
+
+    graph.removeProgram(&ggx);
+    if (graph.getAffectedPrograms("/shaders/standardShadowRay.hlsli").size()) return test_fail("Removed program is still tracked");
+    if (graph.getAffectedPrograms("/shaders/Unknown.hlsli").size()) return test_fail("Unknown file affects programs");
+    return test_pass();
+}
+
+testing_func(ShaderHotReloadTest, TestScanFromDisk)
+{
+    std::string dir = createTempDirectory();
+    fs::create_directories(dir + "/Raytracing");
+    fs::create_directories(dir + "/Data");
+    writeFile(dir + "/Pass.rt.hlsl", "#include \"Raytracing/standardShadowRay.hlsli\"\nimport Shading;\n");
+    writeFile(dir + "/Raytracing/standardShadowRay.hlsli", "#include \"rayCommon.hlsli\"\n");
+    writeFile(dir + "/Raytracing/rayCommon.hlsli", "float foo;\n");
+    writeFile(dir + "/Data/Shading.slang", "#include \"Missing.hlsli\"\n");
+
+    ShaderDependencyGraph graph;
+    graph.setSearchPaths({ dir + "/Data" });
+    int program;
+    graph.addProgramFiles(&program, { dir + "/Pass.rt.hlsl" });
+
+    // Local includes are resolved relative to the including file, the rest through the search paths
+    for (const char* file : { "/Raytracing/rayCommon.hlsli", "/Raytracing/standardShadowRay.hlsli", "/Data/Shading.slang" })
+    {
+        auto affected = graph.getAffectedPrograms(dir + file);
+        if (affected.size() != 1 || affected[0] != &program) return test_fail(std::string("Include not resolved: ") + file);
+    }
+
+    // Rescanning a file picks up a new include
+    writeFile(dir + "/Extra.hlsli", "\n");
+    writeFile(dir + "/Data/Shading.slang", "#include \"../Extra.hlsli\"\n");
+    if (graph.getAffectedPrograms(dir + "/Extra.hlsli").size()) return test_fail("Include found before rescanning");
+    graph.scanFile(dir + "/Data/Shading.slang");
+    if (graph.getAffectedPrograms(dir + "/Extra.hlsli").size() != 1) return test_fail("New include not found after rescanning");
+
+    fs::remove_all(dir);
+    return test_pass();
+}
+
+testing_func(ShaderHotReloadTest, TestFileWatcher)
+{
+    std::string dir = createTempDirectory();
+    std::string watched = dir + "/SVGFATrous.ps.hlsl";
+    std::string other = dir + "/Unwatched.hlsli";
+    writeFile(watched, "// v1\n");
+    writeFile(other, "// v1\n");
+
+    FileWatcher::SharedPtr pWatcher = FileWatcher::create();
+    if (pWatcher->watchFile(watched) == false) return test_fail("Can't watch file");
+    if (pWatcher->watchFile(dir + "/DoesNotExist.hlsl")) return test_fail("Watching a file which doesn't exist");
+    if (pWatcher->isWatching(dir + "/./SVGFATrous.ps.hlsl") == false) return test_fail("Path is not canonicalized");
+
+    // Polling relies on the modification time, which has a 1 second resolution
+#ifdef _WIN32
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+#endif
+
+    // In-place write
+    CpuTimer timer;
+    timer.update();
+    writeFile(other, "// v2\n");
+    writeFile(watched, "// v2\n");
+    std::vector<std::string> changed;
+    if (waitForChange(pWatcher, watched, changed) == false) return test_fail("In-place write not detected");
+    timer.update();
+    logInfo("File change detected after " + std::to_string(timer.getElapsedTime() * 1000) + "ms");
+    if (contains(changed, other)) return test_fail("Unwatched file reported");
+
+#ifdef _WIN32
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+#endif
+
+    // Save through a temporary file, like most editors do
+    writeFile(watched + ".tmp", "// v3\n");
+    fs::rename(watched + ".tmp", watched);
+    changed.clear();
+    if (waitForChange(pWatcher, watched, changed) == false) return test_fail("Save through rename not detected");
+
+    // Multiple events for the same file are coalesced
+    for (uint32_t i = 0; i < 4; i++) writeFile(watched, "// v" + std::to_string(4 + i) + "\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    changed = pWatcher->getChangedFiles();
+    if (std::count(changed.begin(), changed.end(), watched) > 1) return test_fail("Duplicate change events");
+
+    pWatcher->unwatchFile(watched);
+    writeFile(watched, "// v8\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    if (pWatcher->getChangedFiles().size()) return test_fail("Change reported after unwatching");
+
+    pWatcher = nullptr;
+    fs::remove_all(dir);
+    return test_pass();
+}
+
+int main()
+{
+    ShaderHotReloadTest shrt;
+    shrt.init();
+    shrt.run();
+    return 0;
+}
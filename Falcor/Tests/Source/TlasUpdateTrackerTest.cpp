@@ -0,0 +1,184 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "TlasUpdateTrackerTest.h"
+
+void TlasUpdateTrackerTest::addTests()
+{
+    addTestToList<TestDirtyRanges>();
+    addTestToList<TestBuildModes>();
+    addTestToList<TestSahGrowth>();
+}
+
+static BoundingBox unitBox(const glm::vec3& center)
+{
+    return BoundingBox::fromMinMax(center - glm::vec3(0.5f), center + glm::vec3(0.5f));
+}
+
+// Builds a tracker with instanceCount unit boxes along the x axis, and performs the initial rebuild
+static void initTracker(TlasUpdateTracker& tracker, uint32_t instanceCount)
+{
+    tracker.reset(instanceCount);
+    for (uint32_t i = 0; i < instanceCount; i++)
+    {
+        tracker.setBounds(i, unitBox(glm::vec3(float(i), 0, 0)));
+    }
+    tracker.onBuild(tracker.chooseBuildMode(true));
+}
+
+testing_func(TlasUpdateTrackerTest, TestDirtyRanges)
+{
+    TlasUpdateTracker tracker;
+    initTracker(tracker, 16);
+
+    if (tracker.hasDirtyInstances() || tracker.getDirtyRanges().size() != 0)
+    {
+        return test_fail("Instances are dirty after the initial build");
+    }
+
+    tracker.markDirty(1);
+    tracker.markDirty(2);
+    tracker.markDirty(2);
+    tracker.markDirty(5);
+    tracker.markDirty(15);
+
+    if (tracker.getDirtyCount() != 4)
+    {
+        return test_fail("Marking an instance twice changed the dirty count");
+    }
+
+    auto ranges = tracker.getDirtyRanges();
+    if (ranges.size() != 3 || ranges[0].first != 1 || ranges[0].count != 2 || ranges[1].first != 5 || ranges[1].count != 1 || ranges[2].first != 15 || ranges[2].count != 1)
+    {
+        return test_fail("Dirty ranges are incorrect");
+    }
+
+    // With a gap of 2, instances 1-5 should be merged into a single upload
+    ranges = tracker.getDirtyRanges(2);
+    if (ranges.size() != 2 || ranges[0].first != 1 || ranges[0].count != 5 || ranges[1].first != 15 || ranges[1].count != 1)
+    {
+        return test_fail("Merged dirty ranges are incorrect");
+    }
+
+    return test_pass();
+}
+
+testing_func(TlasUpdateTrackerTest, TestBuildModes)
+{
+    TlasUpdateTracker tracker;
+    tracker.reset(4);
+    if (tracker.chooseBuildMode(true) != TlasUpdateTracker::BuildMode::Rebuild)
+    {
+        return test_fail("A reset tracker should request a rebuild");
+    }
+
+    initTracker(tracker, 4);
+    if (tracker.chooseBuildMode(true) != TlasUpdateTracker::BuildMode::None)
+    {
+        return test_fail("A clean tracker should not request a build");
+    }
+
+    // A small move should be refit
+    tracker.markDirty(0);
+    tracker.setBounds(0, unitBox(glm::vec3(0.01f, 0, 0)));
+    if (tracker.chooseBuildMode(true) != TlasUpdateTracker::BuildMode::Refit)
+    {
+        return test_fail("A small move should be refit");
+    }
+
+    if (tracker.chooseBuildMode(false) != TlasUpdateTracker::BuildMode::Rebuild)
+    {
+        return test_fail("Refit was chosen even though it is not allowed");
+    }
+
+    // Check the refit limit
+    tracker.setMaxRefitCount(2);
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        tracker.markDirty(0);
+        tracker.onBuild(tracker.chooseBuildMode(true));
+    }
+    tracker.markDirty(0);
+    if (tracker.getRefitCount() != 2 || tracker.chooseBuildMode(true) != TlasUpdateTracker::BuildMode::Rebuild)
+    {
+        return test_fail("The maximum refit count was not respected");
+    }
+
+    tracker.onBuild(TlasUpdateTracker::BuildMode::Rebuild);
+    if (tracker.getRefitCount() != 0 || tracker.hasDirtyInstances())
+    {
+        return test_fail("Rebuilding didn't reset the tracker state");
+    }
+
+    return test_pass();
+}
+
+testing_func(TlasUpdateTrackerTest, TestSahGrowth)
+{
+    TlasUpdateTracker tracker;
+    initTracker(tracker, 4);
+    tracker.setRebuildThreshold(1.5f);
+
+    if (tracker.getSahGrowth() != 1.0f)
+    {
+        return test_fail("SAH growth should be 1 after a rebuild");
+    }
+
+    // Moving an instance by one unit along x doubles the area of the union for that instance: 6 -> 10. Total is (18 + 10) / 24
+    tracker.markDirty(3);
+    tracker.setBounds(3, unitBox(glm::vec3(4, 0, 0)));
+    float expected = 28.0f / 24.0f;
+    if (abs(tracker.getSahGrowth() - expected) > 1e-5f || tracker.chooseBuildMode(true) != TlasUpdateTracker::BuildMode::Refit)
+    {
+        return test_fail("SAH growth after a small move is incorrect");
+    }
+    tracker.onBuild(TlasUpdateTracker::BuildMode::Refit);
+
+    // Growth is measured against the last rebuild, so it accumulates over refits
+    tracker.markDirty(2);
+    tracker.setBounds(2, unitBox(glm::vec3(2, 0, 10)));
+    if (tracker.getSahGrowth() <= expected || tracker.chooseBuildMode(true) != TlasUpdateTracker::BuildMode::Rebuild)
+    {
+        return test_fail("Accumulated SAH growth didn't trigger a rebuild");
+    }
+
+    tracker.onBuild(TlasUpdateTracker::BuildMode::Rebuild);
+    if (tracker.getSahGrowth() != 1.0f)
+    {
+        return test_fail("SAH growth wasn't reset by a rebuild");
+    }
+
+    return test_pass();
+}
+
+int main()
+{
+    TlasUpdateTrackerTest tlasTest;
+    tlasTest.init();
+    tlasTest.run();
+    return 0;
+}
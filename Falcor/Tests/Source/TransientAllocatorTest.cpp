@@ -0,0 +1,298 @@
+/***************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "TransientAllocatorTest.h"
+#include "Utils/CpuTimer.h"
+#include <map>
+#include <random>
+
+using Tier = TransientAllocator::Tier;
+
+void TransientAllocatorTest::addTests()
+{
+    addTestToList<TestTiers>();
+    addTestToList<TestDeferredRelease>();
+    addTestToList<TestPageReuse>();
+    addTestToList<TestFuzz>();
+    addTestToList<TestPerformance>();
+}
+
+// Stands in for the GPU heap. Tracks the pages the allocator created and checks that live allocations don't overlap.
+struct PageTracker
+{
+    std::map<uint32_t, uint64_t> pages;
+    std::vector<std::map<uint64_t, uint64_t>> ranges;   // Per page, offset -> end of the live allocations
+    uint32_t createCount = 0;
+    bool error = false;
+
+    TransientAllocator::Callbacks getCallbacks()
+    {
+        TransientAllocator::Callbacks callbacks;
+        callbacks.createPage = [this](uint32_t page, uint64_t size)
+        {
+            if (pages.count(page)) error = true;
+            pages[page] = size;
+            createCount++;
+        };
+        callbacks.destroyPage = [this](uint32_t page)
+        {
+            if (pages.erase(page) == 0) error = true;
+            if (page < ranges.size() && ranges[page].size()) error = true;
+        };
+        return callbacks;
+    }
+
+    // Returns false if the allocation is outside of its page or overlaps another live allocation
+    bool add(const TransientAllocator::Allocation& a)
+    {
+        auto page = pages.find(a.page);
+        if (page == pages.end() || a.offset + a.size > page->second) return false;
+        if (a.page >= ranges.size()) ranges.resize(a.page + 1);
+        auto& r = ranges[a.page];
+        auto next = r.lower_bound(a.offset);
+        if (next != r.end() && next->first < a.offset + a.size) return false;
+        if (next != r.begin() && std::prev(next)->second > a.offset) return false;
+        r[a.offset] = a.offset + a.size;
+        return true;
+    }
+
+    void remove(const TransientAllocator::Allocation& a)
+    {
+        ranges[a.page].erase(a.offset);
+    }
+};
+
+static TransientAllocator::Desc createDesc()
+{
+    TransientAllocator::Desc desc;
+    desc.pageSize = 1024 * 1024;
+    desc.slabSize = 64 * 1024;
+    desc.maxIdlePages = 1;
+    desc.megaPageCacheSize = 16 * 1024 * 1024;
+    return desc;
+}
+
+testing_func(TransientAllocatorTest, TestTiers)
+{
+    PageTracker tracker;
+    auto pAllocator = TransientAllocator::create(createDesc(), tracker.getCallbacks());
+
+    auto small = pAllocator->allocate(100);
+    auto aligned = pAllocator->allocate(100, 4096);
+    auto medium = pAllocator->allocate(100 * 1024, 512);
+    auto full = pAllocator->allocate(1024 * 1024);
+    auto mega = pAllocator->allocate(3 * 1024 * 1024 + 1);
+    if (small.tier != Tier::Small || aligned.tier != Tier::Medium || medium.tier != Tier::Medium || full.tier != Tier::Medium || mega.tier != Tier::Mega) return test_fail("Allocation served by the wrong tier");
+    if ((small.offset % 256) || (aligned.offset % 4096) || (medium.offset % 512) || mega.offset != 0) return test_fail("Misaligned allocation");
+    for (const auto& a : { small, aligned, medium, full, mega })
+    {
+        if (!tracker.add(a)) return test_fail("Overlapping allocations");
+    }
+
+    // A 3MB+1 mega-page is rounded up to the 3.5MB bucket
+    if (tracker.pages[mega.page] != 3584 * 1024) return test_fail("Wrong mega-page bucket size");
+
+    auto stats = pAllocator->getStats();
+    if (stats.liveCount[uint32_t(Tier::Small)] != 1 || stats.liveCount[uint32_t(Tier::Medium)] != 3 || stats.liveCount[uint32_t(Tier::Mega)] != 1) return test_fail("Wrong live allocation count");
+    if (stats.smallWastedBytes != 156 || stats.slabCount != 1 || stats.pageCount != 2) return test_fail("Wrong small tier statistics");
+    if (!pAllocator->validate() || tracker.error) return test_fail("Inconsistent allocator state");
+    return test_pass();
+}
+
+testing_func(TransientAllocatorTest, TestDeferredRelease)
+{
+    PageTracker tracker;
+    auto pAllocator = TransientAllocator::create(createDesc(), tracker.getCallbacks());
+
+    auto a = pAllocator->allocate(64 * 1024);
+    pAllocator->release(a, 1);
+    pAllocator->executeDeferredReleases(0);
+    if (pAllocator->getStats().pendingReleaseCount != 1) return test_fail("Released before the fence value was reached");
+
+    // The memory isn't reused while the release is pending
+    auto b = pAllocator->allocate(64 * 1024);
+    if (b.page == a.page && b.offset == a.offset) return test_fail("Memory reused before the fence value was reached");
+
+    pAllocator->release(b, 2);
+    pAllocator->executeDeferredReleases(2);
+    auto stats = pAllocator->getStats();
+    if (stats.pendingReleaseCount != 0 || stats.liveCount[uint32_t(Tier::Medium)] != 0) return test_fail("Releases not executed");
+
+    // Everything was released, so the page is idle and a new allocation reuses its start
+    auto c = pAllocator->allocate(64 * 1024);
+    if (c.page != a.page || c.offset != 0 || stats.pageCreateCount != 1) return test_fail("Released memory wasn't reused");
+    if (!pAllocator->validate() || tracker.error) return test_fail("Inconsistent allocator state");
+    return test_pass();
+}
+
+testing_func(TransientAllocatorTest, TestPageReuse)
+{
+    PageTracker tracker;
+    auto desc = createDesc();
+    auto pAllocator = TransientAllocator::create(desc, tracker.getCallbacks());
+
+    // Mega-pages of the same bucket are reused
+    uint64_t fence = 0;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        auto a = pAllocator->allocate(5 * 1024 * 1024 - i * 1024);
+        pAllocator->release(a, ++fence);
+        pAllocator->executeDeferredReleases(fence);
+    }
+    auto stats = pAllocator->getStats();
+    if (stats.megaPageCreateCount != 1 || stats.megaPageReuseCount != 9 || stats.cachedMegaPageCount != 1) return test_fail("Mega-pages weren't reused");
+
+    // The cache is trimmed to its budget, oldest first
+    std::vector<TransientAllocator::Allocation> megas;
+    for (uint32_t i = 0; i < 6; i++) megas.push_back(pAllocator->allocate(4 * 1024 * 1024));
+    for (const auto& a : megas) pAllocator->release(a, fence);
+    pAllocator->executeDeferredReleases(fence);
+    stats = pAllocator->getStats();
+    if (stats.cachedMegaPageBytes > desc.megaPageCacheSize || stats.megaPageCount != 0) return test_fail("The mega-page cache exceeds its budget");
+    if (tracker.pages.count(megas[0].page) || !tracker.pages.count(megas[5].page)) return test_fail("The mega-page cache wasn't trimmed oldest first");
+
+    // Only maxIdlePages empty medium pages are kept
+    std::vector<TransientAllocator::Allocation> pages;
+    for (uint32_t i = 0; i < 4; i++) pages.push_back(pAllocator->allocate(desc.pageSize));
+    for (const auto& a : pages) pAllocator->release(a, fence);
+    pAllocator->executeDeferredReleases(fence);
+    stats = pAllocator->getStats();
+    if (stats.pageCount != desc.maxIdlePages || stats.idlePageCount != desc.maxIdlePages) return test_fail("Wrong number of idle pages");
+    if (!pAllocator->validate() || tracker.error) return test_fail("Inconsistent allocator state");
+
+    // Destroying the allocator destroys all the pages
+    pAllocator = nullptr;
+    if (tracker.pages.size() || tracker.error) return test_fail("Pages leaked");
+    return test_pass();
+}
+
+testing_func(TransientAllocatorTest, TestFuzz)
+{
+    PageTracker tracker;
+    auto desc = createDesc();
+    auto pAllocator = TransientAllocator::create(desc, tracker.getCallbacks());
+
+    struct Live
+    {
+        TransientAllocator::Allocation allocation;
+        uint64_t alignment;
+    };
+
+    std::mt19937 rng(1234);
+    std::vector<Live> live;
+    uint64_t cpuFence = 1;
+    uint64_t gpuFence = 0;
+    const uint32_t kSteps = 200000;
+    for (uint32_t step = 0; step < kSteps; step++)
+    {
+        uint32_t action = rng() % 100;
+        if (action < 50 || live.empty())
+        {
+            // Log-uniform sizes from 1 byte to 4MB, mostly small ones
+            uint64_t size = 1 + (rng() % (1ull << (rng() % (rng() % 64 == 0 ? 22 : 17))));
+            uint64_t alignment = 1ull << (rng() % 13);
+            auto a = pAllocator->allocate(size, alignment);
+            if (!a.isValid() || a.size != size) return test_fail("Allocation failed");
+            if (a.offset % alignment) return test_fail("Misaligned allocation");
+            if (!tracker.add(a)) return test_fail("Overlapping allocations");
+            live.push_back({ a, alignment });
+        }
+        else if (action < 95)
+        {
+            size_t i = rng() % live.size();
+            tracker.remove(live[i].allocation);
+            pAllocator->release(live[i].allocation, cpuFence);
+            live[i] = live.back();
+            live.pop_back();
+        }
+        else
+        {
+            // Signal the fence and let the GPU catch up with some latency
+            cpuFence++;
+            gpuFence = std::max(gpuFence, cpuFence - 1 - rng() % 3);
+            pAllocator->executeDeferredReleases(gpuFence);
+        }
+
+        if ((step % 5000) == 0 && !pAllocator->validate()) return test_fail("Inconsistent allocator state at step " + std::to_string(step));
+    }
+
+    auto stats = pAllocator->getStats();
+    uint64_t liveCount = stats.liveCount[0] + stats.liveCount[1] + stats.liveCount[2];
+    if (liveCount != live.size() + stats.pendingReleaseCount) return test_fail("Wrong live allocation count");
+    logInfo(stats.toString());
+
+    for (const auto& l : live)
+    {
+        tracker.remove(l.allocation);
+        pAllocator->release(l.allocation, cpuFence);
+    }
+    pAllocator->executeDeferredReleases(cpuFence);
+    stats = pAllocator->getStats();
+    if (stats.liveBytes[0] || stats.liveBytes[1] || stats.liveBytes[2] || stats.smallWastedBytes || stats.megaPageCount) return test_fail("Allocations leaked");
+    if (stats.pageCount > desc.maxIdlePages + stats.slabCount) return test_fail("Empty pages weren't destroyed");
+    if (!pAllocator->validate() || tracker.error) return test_fail("Inconsistent allocator state");
+    return test_pass();
+}
+
+testing_func(TransientAllocatorTest, TestPerformance)
+{
+    PageTracker tracker;
+    auto pAllocator = TransientAllocator::create(createDesc(), tracker.getCallbacks());
+
+    // A frame's worth of constant buffers and dynamic buffers, released a couple of frames later
+    const uint32_t kFrames = 1000;
+    const uint32_t kAllocationsPerFrame = 1000;
+    std::mt19937 rng(5678);
+    std::vector<uint64_t> sizes(kAllocationsPerFrame);
+    for (auto& s : sizes) s = (rng() % 8) ? 64 + rng() % 2048 : 4096 + rng() % (256 * 1024);
+
+    std::vector<std::vector<TransientAllocator::Allocation>> inFlight(3);
+    auto start = CpuTimer::getCurrentTimePoint();
+    for (uint64_t frame = 1; frame <= kFrames; frame++)
+    {
+        auto& allocations = inFlight[frame % inFlight.size()];
+        for (const auto& a : allocations) pAllocator->release(a, frame);
+        allocations.clear();
+        for (uint64_t s : sizes) allocations.push_back(pAllocator->allocate(s, 256));
+        pAllocator->executeDeferredReleases(frame - 1);
+    }
+    double ms = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+    double nsPerOp = ms * 1e6 / (double(kFrames) * kAllocationsPerFrame);
+    logInfo("TransientAllocator: " + std::to_string(nsPerOp) + "ns per allocation and release");
+    logInfo(pAllocator->getStats().toString());
+
+    // Timings are noisy, so this only reports them
+    return test_pass();
+}
+
+int main()
+{
+    TransientAllocatorTest tat;
+    tat.init();
+    tat.run();
+    return 0;
+}
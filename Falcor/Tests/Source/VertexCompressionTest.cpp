@@ -0,0 +1,204 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "VertexCompressionTest.h"
+#include <random>
+
+void VertexCompressionTest::addTests()
+{
+    addTestToList<TestPositionQuantization>();
+    addTestToList<TestPositionEdgeCases>();
+    addTestToList<TestOctahedral>();
+    addTestToList<TestOctahedralEdgeCases>();
+    addTestToList<TestHalf>();
+}
+
+static glm::vec3 randomDirection(std::mt19937& rng)
+{
+    std::normal_distribution<float> dist;
+    glm::vec3 dir;
+    do
+    {
+        dir = glm::vec3(dist(rng), dist(rng), dist(rng));
+    } while (glm::length(dir) < 1e-3f);
+    return glm::normalize(dir);
+}
+
+static float angleBetween(const glm::vec3& a, const glm::vec3& b)
+{
+    // atan2 keeps the precision for tiny angles, acos of the dot product doesn't
+    return std::atan2(glm::length(glm::cross(a, b)), glm::dot(a, b));
+}
+
+testing_func(VertexCompressionTest, TestPositionQuantization)
+{
+    std::mt19937 rng(7);
+    const glm::vec3 boxMin(-120.5f, 3.0f, -0.25f);
+    const glm::vec3 boxMax(80.0f, 3.5f, 1000.0f);
+    std::uniform_real_distribution<float> dist(0, 1);
+
+    VertexCompression::PositionQuantization quantization = VertexCompression::computePositionQuantization(boxMin, boxMax);
+    glm::vec3 bound = VertexCompression::getPositionErrorBound(quantization);
+    for (uint32_t i = 0; i < 100000; i++)
+    {
+        glm::vec3 t(dist(rng), dist(rng), dist(rng));
+        glm::vec3 p = boxMin + (boxMax - boxMin) * t;
+        int16_t encoded[4];
+        VertexCompression::encodePosition(p, quantization, encoded);
+        if (encoded[3] != 32767) return test_fail("W must decode to 1");
+        glm::vec3 decoded = VertexCompression::decodePosition(encoded, quantization);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (std::abs(decoded[axis] - p[axis]) > bound[axis]) return test_fail("Position error exceeds the bound");
+        }
+
+        // Decoding and re-encoding must be stable
+        int16_t reencoded[4];
+        VertexCompression::encodePosition(decoded, quantization, reencoded);
+        if (memcmp(encoded, reencoded, sizeof(encoded))) return test_fail("Position round trip is not stable");
+    }
+    return test_pass();
+}
+
+testing_func(VertexCompressionTest, TestPositionEdgeCases)
+{
+    // The box corners are exact
+    const glm::vec3 boxMin(-1, -2, -3), boxMax(4, 5, 6);
+    VertexCompression::PositionQuantization quantization = VertexCompression::computePositionQuantization(boxMin, boxMax);
+    int16_t encoded[4];
+    VertexCompression::encodePosition(boxMin, quantization, encoded);
+    if (encoded[0] != -32767 || encoded[1] != -32767 || encoded[2] != -32767) return test_fail("The box minimum should map to -1");
+    if (VertexCompression::decodePosition(encoded, quantization) != boxMin) return test_fail("The box minimum didn't round trip");
+    VertexCompression::encodePosition(boxMax, quantization, encoded);
+    if (VertexCompression::decodePosition(encoded, quantization) != boxMax) return test_fail("The box maximum didn't round trip");
+
+    // -32768 decodes as -1, same as the hardware
+    int16_t minimum[4] = { -32768, -32768, -32768, 32767 };
+    if (VertexCompression::decodePosition(minimum, quantization) != boxMin) return test_fail("-32768 should decode to -1");
+
+    // Flat and point boxes must not divide by zero
+    const glm::vec3 flatMin(0, 2, 0), flatMax(10, 2, 10);
+    quantization = VertexCompression::computePositionQuantization(flatMin, flatMax);
+    VertexCompression::encodePosition(glm::vec3(5, 2, 7.5f), quantization, encoded);
+    glm::vec3 decoded = VertexCompression::decodePosition(encoded, quantization);
+    if (decoded.y != 2 || std::abs(decoded.z - 7.5f) > VertexCompression::getPositionErrorBound(quantization).z) return test_fail("Flat box is not handled");
+    quantization = VertexCompression::computePositionQuantization(flatMin, flatMin);
+    VertexCompression::encodePosition(flatMin, quantization, encoded);
+    if (VertexCompression::decodePosition(encoded, quantization) != flatMin) return test_fail("Point box is not handled");
+    return test_pass();
+}
+
+testing_func(VertexCompressionTest, TestOctahedral)
+{
+    std::mt19937 rng(11);
+    float maxError = 0;
+    for (uint32_t i = 0; i < 200000; i++)
+    {
+        glm::vec3 dir = randomDirection(rng);
+        int16_t encoded[2];
+        VertexCompression::encodeOctahedral(dir, encoded);
+        glm::vec3 decoded = VertexCompression::decodeOctahedral(encoded);
+        if (std::abs(glm::length(decoded) - 1) > 1e-5f) return test_fail("The decoded direction is not normalized");
+        maxError = std::max(maxError, angleBetween(dir, decoded));
+
+        // Scaling the input must not change the encoding
+        int16_t scaled[2];
+        VertexCompression::encodeOctahedral(dir * 37.0f, scaled);
+        if (std::abs(scaled[0] - encoded[0]) > 1 || std::abs(scaled[1] - encoded[1]) > 1) return test_fail("The encoding depends on the vector length");
+    }
+    if (maxError > VertexCompression::kOctahedralErrorBound) return test_fail("Octahedral error exceeds the bound");
+    return test_pass();
+}
+
+testing_func(VertexCompressionTest, TestOctahedralEdgeCases)
+{
+    // Axes and the octahedron edges, where the lower hemisphere folds over
+    const glm::vec3 dirs[] =
+    {
+        glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, -1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1),
+        glm::vec3(1, 1, 0), glm::vec3(-1, 1, 0), glm::vec3(1, -1, 0), glm::vec3(-1, -1, 0),
+        glm::vec3(1, 1, -1), glm::vec3(-1, -1, -1), glm::vec3(1e-6f, 0, -1), glm::vec3(0, -1e-6f, -1),
+    };
+    for (const auto& dir : dirs)
+    {
+        int16_t encoded[2];
+        VertexCompression::encodeOctahedral(dir, encoded);
+        glm::vec3 decoded = VertexCompression::decodeOctahedral(encoded);
+        if (angleBetween(glm::normalize(dir), decoded) > VertexCompression::kOctahedralErrorBound) return test_fail("Edge case direction didn't round trip");
+    }
+
+    // A zero vector encodes to +Z instead of NaNs
+    int16_t encoded[2];
+    VertexCompression::encodeOctahedral(glm::vec3(0), encoded);
+    if (VertexCompression::decodeOctahedral(encoded) != glm::vec3(0, 0, 1)) return test_fail("Zero vector should decode to +Z");
+    return test_pass();
+}
+
+testing_func(VertexCompressionTest, TestHalf)
+{
+    // Exact values
+    const float exact[] = { 0.0f, 1.0f, -1.0f, 0.5f, 0.25f, 2048.0f, 65504.0f, -65504.0f, 6.103515625e-05f, 5.9604644775390625e-08f };
+    for (float value : exact)
+    {
+        if (VertexCompression::decodeHalf(VertexCompression::encodeHalf(value)) != value) return test_fail("Exact value didn't round trip");
+    }
+    if (VertexCompression::encodeHalf(1.0f) != 0x3C00 || VertexCompression::encodeHalf(-2.0f) != 0xC000) return test_fail("Wrong bit pattern");
+
+    // Ties round to even: 1 + 2^-11 is halfway between 1 and the next half
+    if (VertexCompression::encodeHalf(1.0f + 1.0f / 2048.0f) != 0x3C00) return test_fail("Ties should round to even");
+    if (VertexCompression::encodeHalf(1.0f + 3.0f / 2048.0f) != 0x3C02) return test_fail("Ties should round to even");
+
+    // Clamping and specials
+    if (VertexCompression::encodeHalf(1e6f) != 0x7BFF || VertexCompression::encodeHalf(-1e6f) != 0xFBFF) return test_fail("Out of range values should clamp");
+    if (!std::isnan(VertexCompression::decodeHalf(VertexCompression::encodeHalf(std::nanf(""))))) return test_fail("NaN should stay NaN");
+    if (VertexCompression::encodeHalf(1e-10f) != 0) return test_fail("Tiny values should flush to zero");
+
+    // Every half value round trips, and random floats stay within the error bound
+    for (uint32_t bits = 0; bits < 0x7C00; bits++)
+    {
+        float value = VertexCompression::decodeHalf((uint16_t)bits);
+        if (VertexCompression::encodeHalf(value) != bits) return test_fail("Half value didn't round trip");
+    }
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> dist(-16, 16);
+    for (uint32_t i = 0; i < 100000; i++)
+    {
+        float value = dist(rng);
+        if (std::abs(value) < 6.103515625e-05f) continue;
+        float decoded = VertexCompression::decodeHalf(VertexCompression::encodeHalf(value));
+        if (std::abs(decoded - value) > std::abs(value) * VertexCompression::kHalfRelativeErrorBound) return test_fail("Half error exceeds the bound");
+    }
+    return test_pass();
+}
+
+int main()
+{
+    VertexCompressionTest vertexCompressionTest;
+    vertexCompressionTest.init();
+    vertexCompressionTest.run();
+    return 0;
+}
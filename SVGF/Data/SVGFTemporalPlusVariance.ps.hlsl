@@ -22,7 +22,8 @@ cbuffer PerFrameCB
   float4x4 gPrevViewProjMatrix;
   uint  gTexWidth;
   uint  gTexHeight;
-  uint2 gTexDim;
+  uint2 gTexDim;       // Render size of this frame; with dynamic resolution, only this top-left corner of the textures is rendered
+  uint2 gPrevTexDim;   // Render size of the previous frame, i.e., the valid region of the history textures
   float gAlpha;
   float gAlphaMoments;
 }
@@ -42,7 +43,7 @@ float getLuminance(float3 color) {
 }
 
 bool isBackProjectionValid(int2 prevPixPos) {
-  if (any(prevPixPos < int2(0, 0)) || any(prevPixPos >= gTexDim)) return false;
+  if (any(prevPixPos < int2(0, 0)) || any(prevPixPos >= gPrevTexDim)) return false;
 
   // TODO: normal comparison
 
@@ -155,13 +156,14 @@ GBuffer main(float2 texC : TEXCOORD, float4 pos : SV_Position)
   float  alpha = gAlpha;
   float  alphaMoments = gAlphaMoments;
 
-  // Compute previous pixel position using the current world position
+  // Compute previous pixel position using the current world position.  The history was rendered at the previous frame's
+  // render size, so reproject into that, which keeps the history valid when the dynamic resolution changes.
   // https://docs.google.com/presentation/d/1YkDE7YAqoffC9wUmDxFo9WZjiLqWI5SlQRojOeCBPGs/edit#slide=id.g2492ec6f45_0_342
   float4 prevViewPos = mul(worldPos, gPrevViewProjMatrix); // the order due to row-major  https://stackoverflow.com/questions/16578765/hlsl-mul-variables-clarification
   float4 prevScreenPos = prevViewPos / prevViewPos.w;
   float2 prevPixPos = float2 (
-    (prevScreenPos.x + 1.f) / 2.f * gTexDim.x,
-    (1.f - prevScreenPos.y) / 2.f * gTexDim.y
+    (prevScreenPos.x + 1.f) / 2.f * gPrevTexDim.x,
+    (1.f - prevScreenPos.y) / 2.f * gPrevTexDim.y
     );
 
   // Perform filter. If 2x2 fails, then try 3x3
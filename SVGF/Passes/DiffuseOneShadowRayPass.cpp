@@ -85,8 +85,8 @@ void DiffuseOneShadowRayPass::execute(RenderContext* pRenderContext)
 	rayGenVars["gDiffuseMatl"] = mpResManager->getTexture("MaterialDiffuse");
 	rayGenVars["gOutput"] = pDstTex;
 
-	// Shoot our rays and shade our primary hit points
-	mpRays->execute(pRenderContext, mpResManager->getScreenSize());
+	// Shoot our rays and shade our primary hit points (only the top-left render size, with dynamic resolution)
+	mpRays->execute(pRenderContext, mpResManager->getRenderSize());
 }
 
 
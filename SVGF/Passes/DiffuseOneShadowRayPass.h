@@ -50,6 +50,7 @@ protected:
   // Override some functions that provide information to the RenderPipeline class
   bool requiresScene() override { return true; }
   bool usesRayTracing() override { return true; }
+  bool supportsDynamicResolution() override { return true; }
 
   // Rendering state
   RayLaunch::SharedPtr                    mpRays;                 ///< Our wrapper around a DX Raytracing pass
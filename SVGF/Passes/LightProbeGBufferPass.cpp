@@ -139,6 +139,9 @@ void LightProbeGBufferPass::execute(RenderContext* pRenderContext)
 	rayGenVars["RayGenCB"]["gLensRadius"]  = mLensRadius;
 	rayGenVars["RayGenCB"]["gFocalLen"]    = mFocalLength;
 
+	// With dynamic resolution, we only render the top-left corner of the G-buffer textures
+	uvec2 renderSize = mpResManager->getRenderSize();
+
 	if (mUseJitter)
 	{
 		// Determine our offset in the pixel
@@ -147,7 +150,7 @@ void LightProbeGBufferPass::execute(RenderContext* pRenderContext)
 
 		// Set our shader and the scene camera to use the computed jitter
 		rayGenVars["RayGenCB"]["gPixelJitter"] = vec2( xOff + 0.5f, yOff + 0.5f );
-		mpScene->getActiveCamera()->setJitter(xOff / float(wsPos->getWidth()), yOff / float(wsPos->getHeight()));
+		mpScene->getActiveCamera()->setJitter(xOff / float(renderSize.x), yOff / float(renderSize.y));
 	}
 	else
 	{
@@ -157,5 +160,5 @@ void LightProbeGBufferPass::execute(RenderContext* pRenderContext)
 	}
 
 	// Launch our ray tracing
-	mpRays->execute( pRenderContext, uvec2(wsPos->getWidth(),wsPos->getHeight()) );
+	mpRays->execute( pRenderContext, renderSize );
 }
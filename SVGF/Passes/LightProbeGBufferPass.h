@@ -44,6 +44,7 @@ protected:
 	bool requiresScene() override      { return true; }
 	bool usesRayTracing() override     { return true; }
 	bool usesEnvironmentMap() override { return true; }
+	bool supportsDynamicResolution() override { return true; }
 
 	// Internal pass state
 	RayLaunch::SharedPtr        mpRays;            ///< Our wrapper around a DX Raytracing pass
@@ -0,0 +1,82 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "Falcor.h"
+#include "SVGFParams.h"
+#include <fstream>
+
+namespace {
+	struct ParamDesc
+	{
+		const char* name;
+		float SVGFParams::* pValue;
+	};
+
+	const ParamDesc kFloatParams[] = {
+		{ "sigmaZ", &SVGFParams::sigmaZ },
+		{ "sigmaN", &SVGFParams::sigmaN },
+		{ "sigmaL", &SVGFParams::sigmaL },
+		{ "alpha", &SVGFParams::alpha },
+		{ "alphaMoments", &SVGFParams::alphaMoments },
+	};
+};
+
+bool SVGFParams::load(const std::string& filename)
+{
+	std::ifstream file(filename);
+	if (file.fail())
+	{
+		logError("SVGFParams: can't open " + filename);
+		return false;
+	}
+
+	// Unknown names are skipped, missing ones keep their current value
+	std::string name;
+	float value;
+	while (file >> name >> value)
+	{
+		if (name == "iterations") iterations = int(value);
+		for (const auto& p : kFloatParams)
+		{
+			if (name == p.name) this->*p.pValue = value;
+		}
+	}
+	return true;
+}
+
+bool SVGFParams::save(const std::string& filename) const
+{
+	std::ofstream file(filename);
+	if (file.fail())
+	{
+		logError("SVGFParams: can't open " + filename);
+		return false;
+	}
+	file << toString();
+	return true;
+}
+
+std::string SVGFParams::toString() const
+{
+	std::string s = "iterations " + std::to_string(iterations) + "\n";
+	for (const auto& p : kFloatParams)
+	{
+		s += std::string(p.name) + " " + std::to_string(this->*p.pValue) + "\n";
+	}
+	return s;
+}
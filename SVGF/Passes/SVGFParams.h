@@ -0,0 +1,36 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#pragma once
+#include <string>
+
+// The user-facing SVGF parameters, shared by the GPU pass and the CPU denoiser the tuner runs.  Presets are
+//      stored as "name value" lines, which is what the tuner writes and the pass's "Load preset" button reads.
+struct SVGFParams
+{
+	int   iterations = 1;       ///< Number of a-trous wavelet iterations
+	float sigmaZ = 1;           ///< Tunes the weight for depth
+	float sigmaN = 128;         ///< Tunes the weight for normal
+	float sigmaL = 4;           ///< Tunes the weight for luminance
+	float alpha = 0.2f;         ///< Minimum blend weight of the new frame into the integrated color
+	float alphaMoments = 0.2f;  ///< Minimum blend weight of the new frame into the luminance moments
+
+	bool load(const std::string& filename);
+	bool save(const std::string& filename) const;
+	std::string toString() const;
+};
@@ -17,6 +17,7 @@
 **********************************************************************************************************************/
 
 #include "SVGFPass.h"
+#include <fstream>
 
 namespace {
 	const char* kTemporalPlusVarianceShader = "SVGFTemporalPlusVariance.ps.hlsl";
@@ -127,16 +128,47 @@ void SVGFPass::resize(uint32_t width, uint32_t height)
 	mAccumCount = 0;
 
 	mTexDim = ivec2(width, height);
+
+	// The reduction is sized for the screen
+	mpVarianceReduction = nullptr;
 }
 
 void SVGFPass::renderGui(Gui* pGui)
 {
 	int dirty = 0;
 	dirty |= (int)pGui->addCheckBox(mDoSVGF ? "SVGF is on" : "SVGF is off", mDoSVGF);
-	dirty |= (int)pGui->addIntVar("No. of iterations", mATrousIteration, 1, 5, 1);
-	dirty |= (int)pGui->addFloatVar("Depth sigma", mATrousSigmaZ, 1, 10, 0.5);
-	dirty |= (int)pGui->addFloatVar("Normal sigma", mATrousSigmaN, 1, 150, 1);
-	dirty |= (int)pGui->addFloatVar("Luminance sigma", mATrousSigmaL, 1, 100, 0.5);
+	dirty |= (int)pGui->addIntVar("No. of iterations", mParams.iterations, 1, 5, 1);
+	dirty |= (int)pGui->addFloatVar("Depth sigma", mParams.sigmaZ, 1, 10, 0.5);
+	dirty |= (int)pGui->addFloatVar("Normal sigma", mParams.sigmaN, 1, 150, 1);
+	dirty |= (int)pGui->addFloatVar("Luminance sigma", mParams.sigmaL, 1, 100, 0.5);
+	dirty |= (int)pGui->addFloatVar("Color alpha", mParams.alpha, 0.01f, 1, 0.01f);
+	dirty |= (int)pGui->addFloatVar("Moments alpha", mParams.alphaMoments, 0.01f, 1, 0.01f);
+
+	// Presets are written by the tuner (SVGF.exe -tune <corpus>)
+	std::string filename;
+	if (pGui->addButton("Load preset") && openFileDialog("SVGF presets\0*.svgf.txt\0\0", filename))
+	{
+		dirty |= (int)mParams.load(filename);
+	}
+
+	if (pGui->addCheckBox("Record tuning corpus", mRecordCorpus) && mRecordCorpus)
+	{
+		// Recording starts over in the chosen folder
+		mRecordCorpus = openFileDialog("Any file in the folder\0*.*\0\0", filename);
+		if (mRecordCorpus)
+		{
+			mCorpusDir = getDirectoryFromFile(filename);
+			mRecordedFrameCount = 0;
+		}
+	}
+	if (mRecordCorpus) pGui->addText(("Recorded " + std::to_string(mRecordedFrameCount) + " frames to " + mCorpusDir).c_str());
+
+	pGui->addCheckBox("Show convergence statistics", mShowConvergenceStats);
+	if (mShowConvergenceStats)
+	{
+		if (pGui->addIntVar("Readback latency", mStatsReadbackLatency, 0, 8)) mpVarianceReduction = nullptr;
+		pGui->addText(("Mean variance: " + std::to_string(mMeanVariance)).c_str());
+	}
 
 	if (dirty) setRefreshFlag();
 }
@@ -148,8 +180,10 @@ void SVGFPass::execute(RenderContext* pRenderContext) {
 	Texture::SharedPtr pWorldNormTex = mpResManager->getTexture(kWorldNorm);
 	Texture::SharedPtr pOutputTex = mpResManager->getTexture(mOutputTexName);
 
+	if (mRecordCorpus) recordCorpusFrame(pRawColorTex, pWorldPosTex, pWorldNormTex);
 	executeTemporalPlusVariance(pRenderContext, pRawColorTex, pWorldPosTex, pWorldNormTex);
 	executeATrous(pRenderContext, pWorldNormTex, pOutputTex);
+	if (mShowConvergenceStats) updateConvergenceStats(pRenderContext);
 
 	// Update fields to be used in next iteration
 	std::swap(mpPrevTPVFbo, mpTPVFbo);
@@ -168,9 +202,10 @@ void SVGFPass::executeTemporalPlusVariance(RenderContext* pRenderContext,
 	auto shaderVars = mpTemporalPlusVarianceShader->getVars();
 	
 	shaderVars["PerFrameCB"]["gPrevViewProjMatrix"] = mpPrevViewProjMatrix;
-	shaderVars["PerFrameCB"]["gTexDim"]							= mTexDim;
-	shaderVars["PerFrameCB"]["gAlpha"]							= 0.2f;
-	shaderVars["PerFrameCB"]["gAlphaMoments"]				= 0.2f;
+	shaderVars["PerFrameCB"]["gTexDim"]							= mpResManager->getRenderSize();
+	shaderVars["PerFrameCB"]["gPrevTexDim"]					= mpResManager->getPrevRenderSize();
+	shaderVars["PerFrameCB"]["gAlpha"]							= mParams.alpha;
+	shaderVars["PerFrameCB"]["gAlphaMoments"]				= mParams.alphaMoments;
 
 	shaderVars["gRawColorTex"]  = pRawColorTex;
 	shaderVars["gWorldPosTex"]  = pWorldPosTex;
@@ -180,7 +215,7 @@ void SVGFPass::executeTemporalPlusVariance(RenderContext* pRenderContext,
 	shaderVars["gPrevMoments"] = pPrevMoment;
 	shaderVars["gPrevHistoryLength"] = pPrevHistoryLength;
 
-	mpGfxState->setFbo(mpTPVFbo);
+	setFboWithRenderViewport(mpTPVFbo);
 	mpTemporalPlusVarianceShader->execute(pRenderContext, mpGfxState);
 }
 
@@ -203,27 +238,19 @@ void SVGFPass::executeATrous(RenderContext* pRenderContext, Texture::SharedPtr p
 	pRenderContext->blit(pTPVVariance->getSRV(), pATrousVariance[0]->getRTV());
 
 	int neighborDist = 1;
-	int atrousDepth = 2;
-	pATrousColor[0]->captureToFile(0, 0,
-			"D:\\Academics\\497\\SVGF-DirectX\\testImages\\SVGFz" + std::to_string(mATrousSigmaZ) +
-			"n" + std::to_string(mATrousSigmaN) +
-			"l" + std::to_string(mATrousSigmaL) +
-			"i" + std::to_string(0) + ".EXR",
-			Bitmap::FileFormat::ExrFile);
-
-	for (int i = 0; i < mATrousIteration; i++) {
+	for (int i = 0; i < mParams.iterations; i++) {
 		// Set shader parameters for our ATrous process
 		auto shaderVars = mpATrousShader->getVars();
-		shaderVars["PerFrameCB"]["gTexDim"] = mTexDim;
+		shaderVars["PerFrameCB"]["gTexDim"] = mpResManager->getRenderSize();
 		shaderVars["PerFrameCB"]["gNeighborDist"] = neighborDist;
-		shaderVars["PerFrameCB"]["sigmaZ"] = mATrousSigmaZ;
-		shaderVars["PerFrameCB"]["sigmaN"] = mATrousSigmaN;
-		shaderVars["PerFrameCB"]["sigmaL"] = mATrousSigmaL;
+		shaderVars["PerFrameCB"]["sigmaZ"] = mParams.sigmaZ;
+		shaderVars["PerFrameCB"]["sigmaN"] = mParams.sigmaN;
+		shaderVars["PerFrameCB"]["sigmaL"] = mParams.sigmaL;
 		shaderVars["gColorTex"] = pATrousColor[i % 2];
 		shaderVars["gVarianceTex"] = pATrousVariance[i % 2];
 		shaderVars["gWorldNormTex"] = pWorldNormTex;
 
-		mpGfxState->setFbo(mpATrousFbo[(i + 1) % 2]);
+		setFboWithRenderViewport(mpATrousFbo[(i + 1) % 2]);
 		mpATrousShader->execute(pRenderContext, mpGfxState);
 		
 		if (i == 0) {
@@ -232,20 +259,58 @@ void SVGFPass::executeATrous(RenderContext* pRenderContext, Texture::SharedPtr p
 		}
 
 		neighborDist *= 2;
-
-		// Save result to a texture for testing
-		pATrousColor[(i + 1) % 2]->captureToFile(0, 0,
-			"D:\\Academics\\497\\SVGF-DirectX\\testImages\\SVGFz" + std::to_string(mATrousSigmaZ) +
-				"n" + std::to_string(mATrousSigmaN) + 
-				"l" + std::to_string(mATrousSigmaL) +
-				"i" + std::to_string(i + 1) + ".EXR",
-			Bitmap::FileFormat::ExrFile);
 	}
 
 	// Save the final result to output texture
-	pRenderContext->blit(pATrousColor[mATrousIteration % 2]->getSRV(), pOutputTex->getRTV());
+	pRenderContext->blit(pATrousColor[mParams.iterations % 2]->getSRV(), pOutputTex->getRTV());
+}
+
+void SVGFPass::setFboWithRenderViewport(Fbo::SharedPtr pFbo)
+{
+	// With dynamic resolution, only shade the part of the textures the other passes rendered this frame
+	uvec2 renderSize = mpResManager->getRenderSize();
+	mpGfxState->setFbo(pFbo, false);
+	mpGfxState->setViewport(0, GraphicsState::Viewport(0.0f, 0.0f, float(renderSize.x), float(renderSize.y), 0.0f, 1.0f), true);
+}
+
+void SVGFPass::updateConvergenceStats(RenderContext* pRenderContext)
+{
+	// Recreated lazily, after a resize or a latency change
+	if (!mpVarianceReduction)
+	{
+		mpVarianceReduction = ParallelReduction::create(ParallelReduction::Type::Mean, mStatsReadbackLatency, mTexDim.x, mTexDim.y);
+	}
+
+	mpVarianceReduction->reduce(pRenderContext, mpTPVFbo->getColorTexture(TPVTextureLocation::Variance));
+	const auto& result = mpVarianceReduction->getResult();
+	if (result.valid) mMeanVariance = result.value.x;
 }
 
+void SVGFPass::recordCorpusFrame(Texture::SharedPtr pRawColorTex, Texture::SharedPtr pWorldPosTex, Texture::SharedPtr pWorldNormTex)
+{
+	// The CPU denoiser works on whole images, so frames rendered at a reduced dynamic resolution are skipped
+	if (mpResManager->getRenderSize() != uvec2(mTexDim))
+	{
+		logWarning("SVGFPass: skipping a corpus frame rendered at a reduced resolution");
+		return;
+	}
+
+	char frameName[32];
+	snprintf(frameName, sizeof(frameName), "frame%04u", mRecordedFrameCount++);
+	std::string prefix = mCorpusDir + "/" + frameName;
+
+	// Positions and normals keep their w (depth in the normal texture), and everything stays 32-bit float
+	const Bitmap::ExportFlags flags = Bitmap::ExportFlags::ExportAlpha | Bitmap::ExportFlags::Uncompressed;
+	pRawColorTex->captureToFile(0, 0, prefix + "_color.exr", Bitmap::FileFormat::ExrFile, flags);
+	pWorldPosTex->captureToFile(0, 0, prefix + "_position.exr", Bitmap::FileFormat::ExrFile, flags);
+	pWorldNormTex->captureToFile(0, 0, prefix + "_normal.exr", Bitmap::FileFormat::ExrFile, flags);
+
+	// The reprojection matrix, in glm's column-major order
+	std::ofstream file(prefix + ".txt");
+	file.precision(9);
+	const float* pMatrix = &mpPrevViewProjMatrix[0][0];
+	for (uint32_t i = 0; i < 16; i++) file << pMatrix[i] << ((i % 4 == 3) ? "\n" : " ");
+}
 
 void SVGFPass::stateRefreshed()
 {
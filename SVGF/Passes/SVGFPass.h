@@ -20,6 +20,8 @@
 #include "../SharedUtils/RenderPass.h"
 #include "../SharedUtils/SimpleVars.h"
 #include "../SharedUtils/FullscreenLaunch.h"
+#include "SVGFParams.h"
+#include "Utils/Math/ParallelReduction.h"
 
 class SVGFPass : public ::RenderPass, inherit_shared_from_this<::RenderPass, SVGFPass>
 {
@@ -48,6 +50,7 @@ protected:
 		RenderContext* pRenderContext, 
 		Texture::SharedPtr pWorldNormTex,
 		Texture::SharedPtr pOutputTex);
+	void setFboWithRenderViewport(Fbo::SharedPtr pFbo);
 
 	void renderGui(Gui* pGui) override;
 	void resize(uint32_t width, uint32_t height) override;
@@ -56,6 +59,7 @@ protected:
 	// Override some functions that provide information to the RenderPipeline class
 	bool appliesPostprocess() override { return true; }
 	bool hasAnimation() override { return false; }
+	bool supportsDynamicResolution() override { return true; }
 
 	// A helper utility to determine if the current scene (if any) has had any camera motion
 	bool hasCameraMoved();
@@ -88,11 +92,21 @@ protected:
 	
 	// GUI fields (also used as input variables in the pass
 	bool mDoSVGF = true;
-	int mATrousIteration = 1;
-	float mATrousSigmaZ = 1; // tunes the weight for depth 
-	float mATrousSigmaN = 128; // tunes the weight for normal
-	float mATrousSigmaL = 4; // tunes the weight for luminance
+	SVGFParams mParams;
 
 	// How many frames have we accumulated so far?
 	uint32_t                      mAccumCount = 0;
+
+	// Convergence statistics: the mean of the temporal variance estimate, read back asynchronously
+	void updateConvergenceStats(RenderContext* pRenderContext);
+	ParallelReduction::UniquePtr  mpVarianceReduction;
+	int                           mStatsReadbackLatency = 2;
+	bool                          mShowConvergenceStats = false;
+	float                         mMeanVariance = 0;
+
+	// Corpus recording: dumps the inputs of each frame so the tuner can replay them through its CPU denoiser
+	void recordCorpusFrame(Texture::SharedPtr pRawColorTex, Texture::SharedPtr pWorldPosTex, Texture::SharedPtr pWorldNormTex);
+	bool                          mRecordCorpus = false;
+	std::string                   mCorpusDir;
+	uint32_t                      mRecordedFrameCount = 0;
 };
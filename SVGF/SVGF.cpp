@@ -22,9 +22,19 @@
 #include "../SharedUtils/RenderingPipeline.h"
 #include "Passes/DiffuseOneShadowRayPass.h"
 #include "Passes/SVGFPass.h"
+#include "Tuner/SVGFTuner.h"
 
 int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPSTR lpCmdLine, _In_ int nShowCmd)
 {
+	// With -tune, search the SVGF parameters over a recorded corpus on the CPU instead of rendering
+	ArgList args;
+	args.parseCommandLine(lpCmdLine);
+	if (args.argExists("tune"))
+	{
+		Logger::showBoxOnError(false);
+		return SVGFTuner::run(args) ? 0 : 1;
+	}
+
 	// Create our rendering pipeline
 	RenderingPipeline* pipeline = new RenderingPipeline();
 
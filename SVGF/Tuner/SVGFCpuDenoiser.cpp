@@ -0,0 +1,255 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "SVGFCpuDenoiser.h"
+
+namespace {
+	float getLuminance(const glm::vec4& color)
+	{
+		return 0.2126f * color.x + 0.7152f * color.y + 0.0722f * color.z;
+	}
+
+	const float kVarianceKernel[9] = {
+		0.0625f, 0.125f, 0.0625f,
+		0.125f,  0.25f,  0.125f,
+		0.0625f, 0.125f, 0.0625f
+	};
+
+	const float kATrousKernel[25] = {
+		0.0625f, 0.0625f, 0.0625f, 0.0625f, 0.0625f,
+		0.0625f, 0.25f,   0.25f,   0.25f,   0.0625f,
+		0.0625f, 0.25f,   0.375f,  0.25f,   0.0625f,
+		0.0625f, 0.25f,   0.25f,   0.25f,   0.0625f,
+		0.0625f, 0.0625f, 0.0625f, 0.0625f, 0.0625f
+	};
+};
+
+SVGFCpuDenoiser::UniquePtr SVGFCpuDenoiser::create(uint32_t width, uint32_t height, const SVGFParams& params)
+{
+	return UniquePtr(new SVGFCpuDenoiser(width, height, params));
+}
+
+SVGFCpuDenoiser::SVGFCpuDenoiser(uint32_t width, uint32_t height, const SVGFParams& params)
+	: mWidth(width), mHeight(height), mParams(params)
+{
+	size_t count = size_t(width) * height;
+	for (TemporalState* pState : { &mCurr, &mPrev })
+	{
+		pState->integratedColor.resize(count);
+		pState->moments.resize(count);
+		pState->historyLength.resize(count);
+		pState->variance.resize(count);
+	}
+	for (uint32_t i = 0; i < 2; i++)
+	{
+		mATrousColor[i].resize(count);
+		mATrousVariance[i].resize(count);
+	}
+	reset();
+}
+
+void SVGFCpuDenoiser::reset()
+{
+	// A new FBO starts out cleared, so the first frame blends with a zero history of length 0, i.e., with alpha 1
+	std::fill(mPrev.integratedColor.begin(), mPrev.integratedColor.end(), glm::vec4(0));
+	std::fill(mPrev.moments.begin(), mPrev.moments.end(), glm::vec2(0));
+	std::fill(mPrev.historyLength.begin(), mPrev.historyLength.end(), 0.0f);
+}
+
+void SVGFCpuDenoiser::denoise(const SVGFFrame& frame, std::vector<glm::vec4>& output)
+{
+	assert(frame.width == mWidth && frame.height == mHeight);
+	temporalPlusVariance(frame);
+
+	// The a-trous iterations ping-pong, and the first one's output becomes the next frame's color history
+	mATrousColor[0] = mCurr.integratedColor;
+	mATrousVariance[0] = mCurr.variance;
+	int neighborDist = 1;
+	for (int i = 0; i < mParams.iterations; i++)
+	{
+		aTrous(frame, mATrousColor[i % 2], mATrousVariance[i % 2], neighborDist, mATrousColor[(i + 1) % 2], mATrousVariance[(i + 1) % 2]);
+		if (i == 0) mCurr.integratedColor = mATrousColor[1];
+		neighborDist *= 2;
+	}
+	output = mATrousColor[mParams.iterations % 2];
+	std::swap(mCurr, mPrev);
+}
+
+void SVGFCpuDenoiser::temporalPlusVariance(const SVGFFrame& frame)
+{
+	const int width = int(mWidth), height = int(mHeight);
+	auto isBackProjectionValid = [&](const glm::ivec2& p) { return p.x >= 0 && p.y >= 0 && p.x < width && p.y < height; };
+
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			size_t index = size_t(y) * width + x;
+
+			// Reproject into the previous frame
+			glm::vec4 prevViewPos = frame.prevViewProj * frame.worldPos[index];
+			glm::vec4 prevScreenPos = prevViewPos / prevViewPos.w;
+			glm::vec2 prevPixPos((prevScreenPos.x + 1.f) / 2.f * width, (1.f - prevScreenPos.y) / 2.f * height);
+
+			// The HLSL truncates towards zero and, like it, the 3x3 fallback doesn't reset the history length the 2x2 filter accumulated
+			glm::vec4 prevColor(0.f);
+			glm::vec2 prevMoments(0.f);
+			float prevHistoryLength = 0.f;
+			const glm::ivec2 basePos = glm::ivec2(prevPixPos);
+
+			// 2x2 bilinear tap filter
+			const glm::ivec2 offsets[4] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+			glm::vec2 f = glm::fract(prevPixPos);
+			const float bilinearWeights[4] = { (1 - f.x) * (1 - f.y), f.x * (1 - f.y), f.x * f.y, (1 - f.x) * f.y };
+			float weightSum = 0.f;
+			for (int s = 0; s < 4; s++)
+			{
+				glm::ivec2 p = basePos + offsets[s];
+				if (isBackProjectionValid(p))
+				{
+					size_t i = size_t(p.y) * width + p.x;
+					prevColor += bilinearWeights[s] * mPrev.integratedColor[i];
+					prevMoments += bilinearWeights[s] * mPrev.moments[i];
+					prevHistoryLength += bilinearWeights[s] * mPrev.historyLength[i];
+					weightSum += bilinearWeights[s];
+				}
+			}
+			bool valid = weightSum > 0.01f;
+			if (valid)
+			{
+				prevColor /= weightSum;
+				prevMoments /= weightSum;
+				prevHistoryLength /= weightSum;
+			}
+			else
+			{
+				// 3x3 uniform tap filter
+				prevColor = glm::vec4(0.f);
+				prevMoments = glm::vec2(0.f);
+				weightSum = 0.f;
+				for (int dx = -1; dx <= 1; dx++)
+				{
+					for (int dy = -1; dy <= 1; dy++)
+					{
+						glm::ivec2 p = basePos + glm::ivec2(dx, dy);
+						if (isBackProjectionValid(p))
+						{
+							size_t i = size_t(p.y) * width + p.x;
+							prevColor += mPrev.integratedColor[i];
+							prevMoments += mPrev.moments[i];
+							prevHistoryLength += mPrev.historyLength[i];
+							weightSum++;
+						}
+					}
+				}
+				if (weightSum > 0)
+				{
+					prevColor /= weightSum;
+					prevMoments /= weightSum;
+					prevHistoryLength /= weightSum;
+				}
+				valid = weightSum > 0;
+			}
+
+			float historyLength = 1.f, alpha = 1.f, alphaMoments = 1.f;
+			if (valid)
+			{
+				historyLength = std::min(32.f, prevHistoryLength + 1.f);
+				alpha = std::max(mParams.alpha, 1.f / historyLength);
+				alphaMoments = std::max(mParams.alphaMoments, 1.f / historyLength);
+			}
+
+			const glm::vec4& rawColor = frame.color[index];
+			float luminance = getLuminance(rawColor);
+			glm::vec2 moments = glm::mix(prevMoments, glm::vec2(luminance, luminance * luminance), alphaMoments);
+
+			mCurr.integratedColor[index] = glm::mix(prevColor, rawColor, alpha);
+			mCurr.moments[index] = moments;
+			mCurr.historyLength[index] = historyLength;
+			mCurr.variance[index] = std::max(0.f, moments.x - moments.y * moments.y);   // As written in the shader
+		}
+	}
+}
+
+void SVGFCpuDenoiser::aTrous(const SVGFFrame& frame, const std::vector<glm::vec4>& srcColor, const std::vector<float>& srcVariance, int neighborDist, std::vector<glm::vec4>& dstColor, std::vector<float>& dstVariance) const
+{
+	const int width = int(mWidth), height = int(mHeight);
+	auto isInside = [&](int x, int y) { return x >= 0 && y >= 0 && x < width && y < height; };
+
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			size_t index = size_t(y) * width + x;
+
+			// 3x3 Gaussian of the variance
+			float varianceWeightSum = 0.f, filteredVariance = 0.f;
+			for (int dx = -1; dx <= 1; dx++)
+			{
+				for (int dy = -1; dy <= 1; dy++)
+				{
+					if (isInside(x + dx, y + dy))
+					{
+						float w = kVarianceKernel[(dy + 1) * 3 + (dx + 1)];
+						varianceWeightSum += w;
+						filteredVariance += w * srcVariance[size_t(y + dy) * width + x + dx];
+					}
+				}
+			}
+			if (varianceWeightSum > 0.001f) filteredVariance /= varianceWeightSum;
+
+			const glm::vec4& normPlusDepth = frame.worldNorm[index];
+			glm::vec4 color = srcColor[index];
+			float variance = srcVariance[index];
+			float luminance = getLuminance(color);
+			float denomWeightL = mParams.sigmaL * std::sqrt(filteredVariance) + 0.001f;
+
+			glm::vec4 colorSum(0.f);
+			float varianceSum = 0.f, weightSum = 0.f;
+			for (int dx = -2; dx <= 2; dx++)
+			{
+				for (int dy = -2; dy <= 2; dy++)
+				{
+					int nx = x + neighborDist * dx, ny = y + neighborDist * dy;
+					if (!isInside(nx, ny)) continue;
+
+					size_t n = size_t(ny) * width + nx;
+					const glm::vec4& neighborNormPlusDepth = frame.worldNorm[n];
+					const glm::vec4& neighborColor = srcColor[n];
+
+					float weightZ = std::exp(-std::abs(normPlusDepth.w - neighborNormPlusDepth.w) / mParams.sigmaZ);
+					float weightN = std::pow(std::max(0.f, glm::dot(glm::vec3(normPlusDepth), glm::vec3(neighborNormPlusDepth))), mParams.sigmaN);
+					float weightL = std::exp(-std::abs(luminance - getLuminance(neighborColor)) / denomWeightL);
+
+					float weight = kATrousKernel[(dy + 2) * 5 + (dx + 2)] * weightZ * weightN * weightL;
+					weightSum += weight;
+					varianceSum += weight * weight * srcVariance[n];
+					colorSum += neighborColor * weight;
+				}
+			}
+
+			if (weightSum > 0.001f)
+			{
+				color = colorSum / weightSum;
+				variance = varianceSum / weightSum * weightSum;   // As written in the shader
+			}
+			dstColor[index] = glm::vec4(glm::vec3(color), 1.f);
+			dstVariance[index] = variance;
+		}
+	}
+}
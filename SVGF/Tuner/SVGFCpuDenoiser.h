@@ -0,0 +1,74 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// A CPU port of SVGFPass (SVGFTemporalPlusVariance.ps.hlsl followed by SVGFATrous.ps.hlsl), so the tuner can replay
+//      recorded frames through many parameter sets in parallel without a GPU.  It follows the shaders line by line,
+//      quirks included, so parameters tuned here carry over to the pass.  Each denoiser is single threaded; the
+//      tuner runs one per worker thread.
+
+#pragma once
+#include "Falcor.h"
+#include "../Passes/SVGFParams.h"
+
+// The inputs of one frame of SVGFPass, as recorded by its "Record tuning corpus" option
+struct SVGFFrame
+{
+	uint32_t               width = 0;
+	uint32_t               height = 0;
+	std::vector<glm::vec4> color;          ///< The noisy color
+	std::vector<glm::vec4> worldPos;
+	std::vector<glm::vec4> worldNorm;      ///< Normal in xyz, depth in w
+	std::vector<glm::vec4> reference;      ///< The converged color the output is scored against
+	glm::mat4              prevViewProj;   ///< The previous frame's view-projection, used to reproject the history
+};
+
+class SVGFCpuDenoiser
+{
+public:
+	using UniquePtr = std::unique_ptr<SVGFCpuDenoiser>;
+
+	static UniquePtr create(uint32_t width, uint32_t height, const SVGFParams& params);
+
+	// Forget the history, like SVGFPass does when the scene is loaded
+	void reset();
+
+	// Denoise the next frame of a sequence.  The output is RGBA, with alpha 1.
+	void denoise(const SVGFFrame& frame, std::vector<glm::vec4>& output);
+
+private:
+	SVGFCpuDenoiser(uint32_t width, uint32_t height, const SVGFParams& params);
+	void temporalPlusVariance(const SVGFFrame& frame);
+	void aTrous(const SVGFFrame& frame, const std::vector<glm::vec4>& srcColor, const std::vector<float>& srcVariance, int neighborDist, std::vector<glm::vec4>& dstColor, std::vector<float>& dstVariance) const;
+
+	// The render targets of the temporal pass, for the current and the previous frame
+	struct TemporalState
+	{
+		std::vector<glm::vec4> integratedColor;
+		std::vector<glm::vec2> moments;
+		std::vector<float>     historyLength;
+		std::vector<float>     variance;
+	};
+
+	uint32_t               mWidth;
+	uint32_t               mHeight;
+	SVGFParams             mParams;
+	TemporalState          mCurr;
+	TemporalState          mPrev;
+	std::vector<glm::vec4> mATrousColor[2];
+	std::vector<float>     mATrousVariance[2];
+};
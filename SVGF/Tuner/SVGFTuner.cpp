@@ -0,0 +1,596 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "SVGFTuner.h"
+#include "Utils/CpuTimer.h"
+#include "Utils/ParallelFor.h"
+#include <experimental/filesystem>
+#include <cfloat>
+#include <fstream>
+#include <random>
+
+namespace fs = std::experimental::filesystem;
+
+namespace {
+	using Point = SVGFTuner::Point;
+
+	// The search range of each parameter.  Sigmas and blend weights are searched on a log scale.
+	struct Range
+	{
+		const char* name;
+		float min;
+		float max;
+		bool  logScale;
+	};
+
+	const Range kRanges[SVGFTuner::kDimCount] = {
+		{ "iterations",   1,     5,   false },
+		{ "sigmaZ",       1,     10,  false },
+		{ "sigmaN",       1,     150, true },
+		{ "sigmaL",       1,     100, true },
+		{ "alpha",        0.05f, 1,   true },
+		{ "alphaMoments", 0.05f, 1,   true },
+	};
+
+	float fromUnit(float u, const Range& r)
+	{
+		return r.logScale ? r.min * std::pow(r.max / r.min, u) : r.min + u * (r.max - r.min);
+	}
+
+	float toUnit(float v, const Range& r)
+	{
+		float u = r.logScale ? std::log(v / r.min) / std::log(r.max / r.min) : (v - r.min) / (r.max - r.min);
+		return glm::clamp(u, 0.f, 1.f);
+	}
+
+	// Iterations are discrete, so points which only differ within a step are the same candidate
+	void quantizeIterations(Point& p)
+	{
+		const float steps = kRanges[0].max - kRanges[0].min;
+		p[0] = std::round(p[0] * steps) / steps;
+	}
+
+	float getDistance(const Point& a, const Point& b)
+	{
+		float d2 = 0;
+		for (uint32_t d = 0; d < SVGFTuner::kDimCount; d++) d2 += (a[d] - b[d]) * (a[d] - b[d]);
+		return std::sqrt(d2);
+	}
+
+	ImageMetrics::Image toImage(uint32_t width, uint32_t height, const std::vector<glm::vec4>& pixels)
+	{
+		ImageMetrics::Image image;
+		image.width = width;
+		image.height = height;
+		image.data.assign(&pixels[0].x, &pixels[0].x + pixels.size() * 4);
+		return image;
+	}
+
+	// A Gaussian process with a squared exponential kernel of fixed length scale over standardized values.  Small
+	//      enough for the few hundred evaluations a tuning run makes, so there's no hyperparameter fitting.
+	class GaussianProcess
+	{
+	public:
+		GaussianProcess(const std::vector<Point>& points, const std::vector<double>& values) : mPoints(points)
+		{
+			const size_t n = points.size();
+			for (double v : values) mMean += v / n;
+			double variance = 0;
+			for (double v : values) variance += (v - mMean) * (v - mMean) / n;
+			mScale = variance > 0 ? std::sqrt(variance) : 1;
+
+			// Cholesky factorization of the kernel matrix, with a little noise on the diagonal for stability
+			mL.assign(n * n, 0);
+			for (size_t i = 0; i < n; i++)
+			{
+				for (size_t j = 0; j <= i; j++)
+				{
+					double sum = kernel(points[i], points[j]) + ((i == j) ? kNoise : 0);
+					for (size_t k = 0; k < j; k++) sum -= mL[i * n + k] * mL[j * n + k];
+					mL[i * n + j] = (i == j) ? std::sqrt(std::max(sum, 1e-12)) : sum / mL[j * n + j];
+				}
+			}
+
+			// alpha = K^-1 y
+			mAlpha.resize(n);
+			for (size_t i = 0; i < n; i++) mAlpha[i] = (values[i] - mMean) / mScale;
+			solveLower(mAlpha);
+			for (size_t i = n; i-- > 0;)
+			{
+				for (size_t k = i + 1; k < n; k++) mAlpha[i] -= mL[k * n + i] * mAlpha[k];
+				mAlpha[i] /= mL[i * n + i];
+			}
+		}
+
+		void predict(const Point& p, double& mean, double& stdDev) const
+		{
+			const size_t n = mPoints.size();
+			std::vector<double> k(n);
+			mean = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				k[i] = kernel(p, mPoints[i]);
+				mean += k[i] * mAlpha[i];
+			}
+			solveLower(k);
+			double variance = 1;
+			for (double v : k) variance -= v * v;
+			mean = mMean + mean * mScale;
+			stdDev = std::sqrt(std::max(variance, 0.0)) * mScale;
+		}
+
+	private:
+		static constexpr double kLengthScale = 0.25;
+		static constexpr double kNoise = 1e-4;
+
+		static double kernel(const Point& a, const Point& b)
+		{
+			double d = getDistance(a, b);
+			return std::exp(-0.5 * d * d / (kLengthScale * kLengthScale));
+		}
+
+		void solveLower(std::vector<double>& x) const
+		{
+			const size_t n = mPoints.size();
+			for (size_t i = 0; i < n; i++)
+			{
+				for (size_t k = 0; k < i; k++) x[i] -= mL[i * n + k] * x[k];
+				x[i] /= mL[i * n + i];
+			}
+		}
+
+		std::vector<Point>  mPoints;
+		std::vector<double> mL;
+		std::vector<double> mAlpha;
+		double              mMean = 0;
+		double              mScale = 1;
+	};
+
+	double getExpectedImprovement(double best, double mean, double stdDev)
+	{
+		if (stdDev <= 0) return std::max(0.0, best - mean);
+		double z = (best - mean) / stdDev;
+		double cdf = 0.5 * std::erfc(-z / std::sqrt(2.0));
+		double pdf = std::exp(-0.5 * z * z) / std::sqrt(2.0 * 3.14159265358979323846);
+		return (best - mean) * cdf + stdDev * pdf;
+	}
+
+	std::string paramsToCsv(const SVGFParams& p)
+	{
+		return std::to_string(p.iterations) + "," + std::to_string(p.sigmaZ) + "," + std::to_string(p.sigmaN) + "," + std::to_string(p.sigmaL) + "," +
+			std::to_string(p.alpha) + "," + std::to_string(p.alphaMoments);
+	}
+};
+
+bool SVGFTuner::run(const ArgList& args)
+{
+	SVGFTuner tuner;
+	if (args.argExists("out")) tuner.mOutDir = args["out"].asString();
+	if (args.argExists("search")) tuner.mSearch = args["search"].asString();
+	if (args.argExists("steps")) tuner.mSteps = std::max(1u, args["steps"].asUint());
+	if (args.argExists("evaluations")) tuner.mEvaluationCount = std::max(1u, args["evaluations"].asUint());
+	if (args.argExists("budget")) tuner.mBudgetMs = args["budget"].asFloat();
+	if (args.argExists("metric"))
+	{
+		// PSNR grows with quality, and its mean isn't an error to minimize. SSIM is turned into 1 - SSIM.
+		ImageMetrics::Metric metric;
+		if (ImageMetrics::findMetric(args["metric"].asString(), metric) && metric != ImageMetrics::Metric::Psnr) tuner.mMetric = metric;
+		else logWarning("SVGFTuner: can't tune for metric '" + args["metric"].asString() + "', using " + ImageMetrics::getMetricName(tuner.mMetric));
+	}
+
+	if (!tuner.loadCorpus(args["tune"].asString())) return false;
+
+	// The default parameters go first, and normalize the errors of each scene
+	SVGFParams defaults;
+	Evaluation baseline = tuner.evaluate(defaults);
+	for (size_t s = 0; s < tuner.mScenes.size(); s++)
+	{
+		if (baseline.sceneError[s] > 0) tuner.mScenes[s].baselineError = baseline.sceneError[s];
+	}
+	baseline = tuner.evaluate(defaults);
+	tuner.measureTime(baseline);
+	tuner.mEvaluations.push_back(baseline);
+	tuner.mPoints.push_back(toPoint(defaults));
+
+	if (tuner.mSearch == "grid") tuner.searchGrid();
+	else tuner.searchBayes();
+	return tuner.writeResults();
+}
+
+bool SVGFTuner::loadCorpus(const std::string& path)
+{
+	if (isDirectoryExists(path) == false)
+	{
+		logError("SVGFTuner: can't find the corpus folder " + path);
+		return false;
+	}
+
+	// The corpus is either a single scene, or a folder of scenes
+	bool isScene = false;
+	std::vector<std::string> sceneDirs;
+	for (const auto& entry : fs::directory_iterator(path))
+	{
+		if (fs::is_directory(entry.path())) sceneDirs.push_back(entry.path().string());
+		else if (hasSuffix(entry.path().string(), "_color.exr", false)) isScene = true;
+	}
+	if (isScene)
+	{
+		std::string name = fs::path(path).filename().string();
+		if (!loadScene(path, name.empty() ? "scene" : name)) return false;
+	}
+	else
+	{
+		std::sort(sceneDirs.begin(), sceneDirs.end());
+		for (const auto& dir : sceneDirs)
+		{
+			if (!loadScene(dir, fs::path(dir).filename().string())) return false;
+		}
+	}
+
+	if (mScenes.empty())
+	{
+		logError("SVGFTuner: found no recorded frames in " + path);
+		return false;
+	}
+	return true;
+}
+
+bool SVGFTuner::loadScene(const std::string& path, const std::string& name)
+{
+	const std::string kColorSuffix = "_color.exr";
+	std::vector<std::string> prefixes;
+	for (const auto& entry : fs::directory_iterator(path))
+	{
+		std::string filename = entry.path().string();
+		if (hasSuffix(filename, kColorSuffix, false)) prefixes.push_back(filename.substr(0, filename.size() - kColorSuffix.size()));
+	}
+	if (prefixes.empty()) return true;
+	std::sort(prefixes.begin(), prefixes.end());
+
+	Scene scene;
+	scene.name = name;
+	for (const auto& prefix : prefixes)
+	{
+		SVGFFrame frame;
+		auto loadImage = [&](const std::string& suffix, std::vector<glm::vec4>& pixels)
+		{
+			ImageMetrics::Image image;
+			if (!ImageMetrics::loadImage(prefix + suffix, image)) return false;
+			if (frame.width == 0)
+			{
+				frame.width = image.width;
+				frame.height = image.height;
+			}
+			if (image.width != frame.width || image.height != frame.height) return false;
+			pixels.resize(size_t(image.width) * image.height);
+			std::memcpy(&pixels[0].x, image.data.data(), image.data.size() * sizeof(float));
+			return true;
+		};
+
+		std::ifstream matrixFile(prefix + ".txt");
+		float* pMatrix = &frame.prevViewProj[0][0];
+		for (uint32_t i = 0; i < 16; i++) matrixFile >> pMatrix[i];
+
+		if (!loadImage(kColorSuffix, frame.color) || !loadImage("_position.exr", frame.worldPos) || !loadImage("_normal.exr", frame.worldNorm) ||
+			!loadImage("_reference.exr", frame.reference) || matrixFile.fail())
+		{
+			logError("SVGFTuner: frame " + prefix + " is incomplete or its images have different sizes");
+			return false;
+		}
+		if (scene.frames.size() && (frame.width != scene.frames[0].width || frame.height != scene.frames[0].height))
+		{
+			logError("SVGFTuner: the frames of scene " + name + " have different sizes");
+			return false;
+		}
+		scene.frames.push_back(std::move(frame));
+	}
+
+	if (mMetric == ImageMetrics::Metric::TemporalMse && scene.frames.size() < 2)
+	{
+		logError("SVGFTuner: the temporal metric needs at least 2 frames in scene " + name);
+		return false;
+	}
+	logInfo("SVGFTuner: loaded " + std::to_string(scene.frames.size()) + " frames of scene " + name);
+	mScenes.push_back(std::move(scene));
+	return true;
+}
+
+SVGFParams SVGFTuner::toParams(const Point& p)
+{
+	SVGFParams params;
+	params.iterations = int(std::round(fromUnit(p[0], kRanges[0])));
+	params.sigmaZ = fromUnit(p[1], kRanges[1]);
+	params.sigmaN = fromUnit(p[2], kRanges[2]);
+	params.sigmaL = fromUnit(p[3], kRanges[3]);
+	params.alpha = fromUnit(p[4], kRanges[4]);
+	params.alphaMoments = fromUnit(p[5], kRanges[5]);
+	return params;
+}
+
+SVGFTuner::Point SVGFTuner::toPoint(const SVGFParams& params)
+{
+	return { toUnit(float(params.iterations), kRanges[0]), toUnit(params.sigmaZ, kRanges[1]), toUnit(params.sigmaN, kRanges[2]),
+		toUnit(params.sigmaL, kRanges[3]), toUnit(params.alpha, kRanges[4]), toUnit(params.alphaMoments, kRanges[5]) };
+}
+
+void SVGFTuner::evaluate(const std::vector<Point>& points)
+{
+	// One candidate per task.  The scenes are shared read-only, each task has its own denoisers.
+	std::vector<Evaluation> evaluations(points.size());
+	parallelFor(uint32_t(points.size()), 1, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; i++) evaluations[i] = evaluate(toParams(points[i]));
+	});
+
+	// Timed one at a time afterwards, so the times don't include the contention with the other candidates
+	for (Evaluation& e : evaluations) measureTime(e);
+
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		mEvaluations.push_back(std::move(evaluations[i]));
+		mPoints.push_back(points[i]);
+	}
+	logInfo("SVGFTuner: " + std::to_string(mEvaluations.size()) + " evaluations");
+}
+
+SVGFTuner::Evaluation SVGFTuner::evaluate(const SVGFParams& params) const
+{
+	Evaluation e;
+	e.params = params;
+
+	ImageMetrics::Options metricOptions;
+	metricOptions.metrics = ImageMetrics::getMetricBit(mMetric);
+	for (const Scene& scene : mScenes)
+	{
+		const uint32_t width = scene.frames[0].width, height = scene.frames[0].height;
+		SVGFCpuDenoiser::UniquePtr pDenoiser = SVGFCpuDenoiser::create(width, height, params);
+		ImageMetrics::UniquePtr pMetrics = ImageMetrics::create(metricOptions);
+
+		std::vector<glm::vec4> output;
+		for (const SVGFFrame& frame : scene.frames)
+		{
+			pDenoiser->denoise(frame, output);
+			pMetrics->addFrame(toImage(width, height, output), toImage(width, height, frame.reference));
+		}
+
+		double value = pMetrics->getMean()[uint32_t(mMetric)];
+		e.sceneError.push_back(mMetric == ImageMetrics::Metric::Ssim ? 1 - value : value);
+		e.error += e.sceneError.back() / scene.baselineError / mScenes.size();
+	}
+	return e;
+}
+
+void SVGFTuner::measureTime(Evaluation& e) const
+{
+	e.sceneMs.clear();
+	e.ms = 0;
+	for (const Scene& scene : mScenes)
+	{
+		SVGFCpuDenoiser::UniquePtr pDenoiser = SVGFCpuDenoiser::create(scene.frames[0].width, scene.frames[0].height, e.params);
+		std::vector<glm::vec4> output;
+		double ms = 0;
+		for (const SVGFFrame& frame : scene.frames)
+		{
+			auto start = CpuTimer::getCurrentTimePoint();
+			pDenoiser->denoise(frame, output);
+			ms += CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+		}
+		e.sceneMs.push_back(ms / scene.frames.size());
+		e.ms += e.sceneMs.back() / mScenes.size();
+	}
+}
+
+void SVGFTuner::searchGrid()
+{
+	// Every iteration count, and mSteps values of each of the other parameters
+	const uint32_t iterationSteps = uint32_t(kRanges[0].max - kRanges[0].min) + 1;
+	uint32_t count = iterationSteps;
+	for (uint32_t d = 1; d < kDimCount; d++) count *= mSteps;
+	logInfo("SVGFTuner: grid search over " + std::to_string(count) + " parameter sets");
+
+	std::vector<Point> points;
+	for (uint32_t index = 0; index < count; index++)
+	{
+		Point p;
+		p[0] = float(index % iterationSteps) / float(iterationSteps - 1);
+		uint32_t rest = index / iterationSteps;
+		for (uint32_t d = 1; d < kDimCount; d++)
+		{
+			p[d] = (mSteps > 1) ? float(rest % mSteps) / float(mSteps - 1) : 0.5f;
+			rest /= mSteps;
+		}
+		points.push_back(p);
+
+		// Evaluated in batches to report progress
+		if (points.size() == 64 || index + 1 == count)
+		{
+			evaluate(points);
+			points.clear();
+		}
+	}
+}
+
+void SVGFTuner::searchBayes()
+{
+	// ParEGO: each proposal minimizes the expected improvement of a randomly weighted scalarization of error and time,
+	//      so successive batches spread along the Pareto front instead of converging on a single trade-off.
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> uniform;
+	std::normal_distribution<float> perturbation(0, 0.05f);
+	const uint32_t batchSize = std::max(1u, getParallelForThreadCount());
+	const uint32_t totalCount = mEvaluationCount + 1;
+
+	// Start with random points
+	std::vector<Point> points(std::min(mEvaluationCount, std::max(2 * kDimCount, batchSize)));
+	for (Point& p : points)
+	{
+		for (float& v : p) v = uniform(rng);
+		quantizeIterations(p);
+	}
+	evaluate(points);
+
+	while (mEvaluations.size() < totalCount)
+	{
+		std::vector<Point> batch;
+		uint32_t batchCount = std::min(batchSize, uint32_t(totalCount - mEvaluations.size()));
+		for (uint32_t b = 0; b < batchCount; b++)
+		{
+			// Augmented Chebyshev scalarization of the log error and log time, normalized over the evaluations so far
+			const size_t n = mEvaluations.size();
+			std::vector<double> logError(n), logMs(n);
+			double minError = DBL_MAX, maxError = -DBL_MAX, minMs = DBL_MAX, maxMs = -DBL_MAX;
+			for (size_t i = 0; i < n; i++)
+			{
+				logError[i] = std::isfinite(mEvaluations[i].error) ? std::log(std::max(mEvaluations[i].error, 1e-12)) : NAN;
+				logMs[i] = std::log(std::max(mEvaluations[i].ms, 1e-6));
+				if (std::isfinite(logError[i]))
+				{
+					minError = std::min(minError, logError[i]);
+					maxError = std::max(maxError, logError[i]);
+				}
+				minMs = std::min(minMs, logMs[i]);
+				maxMs = std::max(maxMs, logMs[i]);
+			}
+
+			const double weight = uniform(rng);
+			std::vector<double> values(n);
+			for (size_t i = 0; i < n; i++)
+			{
+				double e = std::isfinite(logError[i]) ? (logError[i] - minError) / std::max(maxError - minError, 1e-12) : 1;
+				double t = (logMs[i] - minMs) / std::max(maxMs - minMs, 1e-12);
+				values[i] = std::max(weight * e, (1 - weight) * t) + 0.05 * (weight * e + (1 - weight) * t);
+			}
+			GaussianProcess gp(mPoints, values);
+			size_t bestIndex = std::min_element(values.begin(), values.end()) - values.begin();
+
+			// Candidates are random points and perturbations of the best one, away from what's already evaluated or proposed
+			Point bestCandidate = mPoints[bestIndex];
+			double bestImprovement = -1;
+			for (uint32_t c = 0; c < 2000; c++)
+			{
+				Point p;
+				for (uint32_t d = 0; d < kDimCount; d++)
+				{
+					p[d] = (c % 2) ? uniform(rng) : glm::clamp(mPoints[bestIndex][d] + perturbation(rng), 0.f, 1.f);
+				}
+				quantizeIterations(p);
+
+				bool isNew = true;
+				for (const Point& q : mPoints) isNew = isNew && getDistance(p, q) > 0.02f;
+				for (const Point& q : batch) isNew = isNew && getDistance(p, q) > 0.02f;
+				if (!isNew) continue;
+
+				double mean, stdDev;
+				gp.predict(p, mean, stdDev);
+				double improvement = getExpectedImprovement(values[bestIndex], mean, stdDev);
+				if (improvement > bestImprovement)
+				{
+					bestImprovement = improvement;
+					bestCandidate = p;
+				}
+			}
+			batch.push_back(bestCandidate);
+		}
+		evaluate(batch);
+	}
+}
+
+std::vector<size_t> SVGFTuner::findParetoFront(const std::vector<double>& errors, const std::vector<double>& ms)
+{
+	assert(errors.size() == ms.size());
+	std::vector<size_t> order(errors.size());
+	for (size_t i = 0; i < order.size(); i++) order[i] = i;
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return (ms[a] != ms[b]) ? ms[a] < ms[b] : errors[a] < errors[b]; });
+
+	// From the fastest, each point on the front has a lower error than all the faster ones
+	std::vector<size_t> front;
+	double bestError = DBL_MAX;
+	for (size_t i : order)
+	{
+		if (std::isfinite(errors[i]) && errors[i] < bestError)
+		{
+			front.push_back(i);
+			bestError = errors[i];
+		}
+	}
+	return front;
+}
+
+std::vector<size_t> SVGFTuner::getParetoFront(int32_t scene) const
+{
+	std::vector<double> errors, ms;
+	for (const Evaluation& e : mEvaluations)
+	{
+		errors.push_back((scene < 0) ? e.error : e.sceneError[scene]);
+		ms.push_back((scene < 0) ? e.ms : e.sceneMs[scene]);
+	}
+	return findParetoFront(errors, ms);
+}
+
+bool SVGFTuner::writeResults() const
+{
+	fs::create_directories(mOutDir);
+	const std::string paramNames = "iterations,sigmaZ,sigmaN,sigmaL,alpha,alphaMoments";
+	const std::string metricName = ImageMetrics::getMetricName(mMetric);
+
+	std::ofstream evaluations(mOutDir + "/evaluations.csv");
+	if (evaluations.fail())
+	{
+		logError("SVGFTuner: can't write to " + mOutDir);
+		return false;
+	}
+	evaluations << paramNames;
+	for (const Scene& scene : mScenes) evaluations << "," << scene.name << " " << metricName << "," << scene.name << " ms";
+	evaluations << ",relative error,ms\n";
+	for (const Evaluation& e : mEvaluations)
+	{
+		evaluations << paramsToCsv(e.params);
+		for (size_t s = 0; s < mScenes.size(); s++) evaluations << "," << e.sceneError[s] << "," << e.sceneMs[s];
+		evaluations << "," << e.error << "," << e.ms << "\n";
+	}
+
+	// The front and the preset of each scene, then of the whole corpus ("all") with the errors relative to the defaults
+	std::ofstream pareto(mOutDir + "/pareto.csv");
+	pareto << "scene," << paramNames << ",error,ms\n";
+	std::string summary = "SVGFTuner: " + std::to_string(mEvaluations.size()) + " evaluations, presets for " + metricName +
+		(mBudgetMs > 0 ? " within " + std::to_string(mBudgetMs) + " ms per frame" : "") + ":";
+	for (int32_t s = -1; s < int32_t(mScenes.size()); s++)
+	{
+		std::string name = (s < 0) ? "all" : mScenes[s].name;
+		std::vector<size_t> front = getParetoFront(s);
+		if (front.empty()) continue;
+
+		size_t preset = front[0];
+		for (size_t i : front)
+		{
+			const Evaluation& e = mEvaluations[i];
+			double error = (s < 0) ? e.error : e.sceneError[s];
+			double ms = (s < 0) ? e.ms : e.sceneMs[s];
+			pareto << name << "," << paramsToCsv(e.params) << "," << error << "," << ms << "\n";
+			if (mBudgetMs <= 0 || ms <= mBudgetMs) preset = i;
+		}
+
+		const Evaluation& e = mEvaluations[preset];
+		e.params.save(mOutDir + "/" + name + ".svgf.txt");
+		double relativeError = (s < 0) ? e.error : e.sceneError[s] / mScenes[s].baselineError;
+		summary += "\n  " + name + ": " + paramsToCsv(e.params) + " (" + std::to_string(relativeError) + "x the default error, " +
+			std::to_string((s < 0) ? e.ms : e.sceneMs[s]) + " ms)";
+	}
+	logInfo(summary);
+	return true;
+}
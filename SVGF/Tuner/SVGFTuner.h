@@ -0,0 +1,92 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Searches the SVGF parameters for the best trade-offs between quality and cost over a corpus of recorded frames.
+//      Each candidate parameter set is run through the CPU denoiser on every scene of the corpus, scored against the
+//      scene's references with ImageMetrics, and timed.  The tuner writes all the evaluations, the Pareto front of
+//      error versus time, and a preset per scene that SVGFPass's "Load preset" button reads.
+//
+//      Command line: SVGF.exe -tune <corpus> [-out <folder>] [-search grid|bayes] [-steps <n>] [-evaluations <n>]
+//                             [-metric relmse|mse|smape|ssim|flip|tmse] [-budget <ms per frame>]
+//
+//      The corpus holds one folder per scene, or is itself a single scene.  A scene folder holds the frames written by
+//      SVGFPass's "Record tuning corpus" option (frameNNNN_color.exr, frameNNNN_position.exr, frameNNNN_normal.exr and
+//      frameNNNN.txt), plus a converged frameNNNN_reference.exr for each frame, e.g., rendered with the
+//      SimpleAccumulationPass along the same camera path.
+
+#pragma once
+#include "SVGFCpuDenoiser.h"
+#include "Utils/ImageMetrics.h"
+
+class SVGFTuner
+{
+public:
+	// Run the tuner with the command line arguments above.  Returns false if the corpus can't be loaded.
+	static bool run(const ArgList& args);
+
+	// Candidates are searched in the unit cube, one dimension per parameter
+	static const uint32_t kDimCount = 6;
+	using Point = std::array<float, kDimCount>;
+
+	// Indices of the points on the Pareto front of error versus time, sorted by time.  Points with a non-finite error are skipped.
+	static std::vector<size_t> findParetoFront(const std::vector<double>& errors, const std::vector<double>& ms);
+
+private:
+	struct Scene
+	{
+		std::string            name;
+		std::vector<SVGFFrame> frames;
+		double                 baselineError = 1;   ///< The error of the default parameters, which normalizes the scene's errors
+	};
+
+	struct Evaluation
+	{
+		SVGFParams          params;
+		std::vector<double> sceneError;   ///< The mean metric over the frames of each scene
+		std::vector<double> sceneMs;      ///< The mean denoising time per frame of each scene
+		double              error = 0;    ///< The mean over the scenes of the error relative to the default parameters
+		double              ms = 0;       ///< The mean time per frame over the scenes
+	};
+
+	bool loadCorpus(const std::string& path);
+	bool loadScene(const std::string& path, const std::string& name);
+	static SVGFParams toParams(const Point& p);
+	static Point toPoint(const SVGFParams& params);
+
+	void evaluate(const std::vector<Point>& points);
+	// The errors of a candidate.  The times are left for measureTime(), which must not run concurrently with other work.
+	Evaluation evaluate(const SVGFParams& params) const;
+	void measureTime(Evaluation& e) const;
+	void searchGrid();
+	void searchBayes();
+
+	// Indices of the evaluations on the Pareto front of a scene (or of the means with scene = -1), sorted by time
+	std::vector<size_t> getParetoFront(int32_t scene) const;
+	bool writeResults() const;
+
+	std::vector<Scene>       mScenes;
+	std::vector<Evaluation>  mEvaluations;
+	std::vector<Point>       mPoints;   ///< The search point of each evaluation
+
+	ImageMetrics::Metric     mMetric = ImageMetrics::Metric::RelMse;
+	std::string              mSearch = "bayes";
+	uint32_t                 mSteps = 3;
+	uint32_t                 mEvaluationCount = 64;
+	float                    mBudgetMs = 0;     ///< The time budget of the presets, 0 for no limit
+	std::string              mOutDir = ".";
+};
@@ -72,6 +72,9 @@ public:
 	// Want to sent variables to your HLSL code, you do that via the SimpleVars structure
 	SimpleVars::SharedPtr getVars();
 
+	// Access the scene renderer, e.g., to toggle draw sorting or display its draw statistics
+	SceneRenderer::SharedPtr getSceneRenderer() { return mpSceneRenderer; }
+
 protected:
 	RasterLaunch(GraphicsProgram::SharedPtr &existingProgram);
 	
@@ -29,8 +29,9 @@ namespace {
 
 
 RenderingPipeline::RenderingPipeline() 
-	: Renderer()
+	: Renderer(), mDynamicResolution(DynamicResolutionController::Desc())
 {
+	for (uint32_t i = 0; i < kFrameTimerCount; i++) mFrameTimerScales[i] = 0.0f;
 }
 
 uint32_t RenderingPipeline::addPass(::RenderPass::SharedPtr pNewPass)
@@ -156,6 +157,19 @@ void RenderingPipeline::updatePipelineRequirementFlags(void)
 		}
 	}
 
+	// Dynamic resolution is only usable if every active pass renders into the scaled sub-rectangle
+	mPipeSupportsDynamicRes = false;
+	for (uint32_t passNum = 0; passNum < mActivePasses.size(); passNum++)
+	{
+		if (!mActivePasses[passNum]) continue;
+		if (!mActivePasses[passNum]->supportsDynamicResolution())
+		{
+			mPipeSupportsDynamicRes = false;
+			break;
+		}
+		mPipeSupportsDynamicRes = true;
+	}
+
 	mPipeRequiresScene = mPipeRequiresScene || mPipeNeedsDefaultScene;
 }
 
@@ -275,6 +289,30 @@ void RenderingPipeline::onGuiRender(SampleCallbacks* pSample, Gui* pGui)
 		pGui->addSeparator();
 	}
 
+	if (mPipeSupportsDynamicRes && mpResourceManager)
+	{
+		if (pGui->addCheckBox("Dynamic resolution", mUseDynamicResolution))
+		{
+			mDynamicResolution.reset();
+			mGlobalPipeRefresh = true;
+		}
+		if (mUseDynamicResolution)
+		{
+			DynamicResolutionController::Desc desc = mDynamicResolution.getDesc();
+			bool changed = pGui->addFloatVar("GPU budget (ms)", desc.targetFrameTime, 1.0f, 100.0f, 0.5f);
+			changed = pGui->addFloatVar("Min scale", desc.minScale, 0.25f, desc.maxScale, 0.05f) || changed;
+			if (changed) mDynamicResolution.setDesc(desc);
+
+			uvec2 renderSize = mpResourceManager->getRenderSize();
+			char buf[128];
+			sprintf_s(buf, "Render scale: %.2f (%d x %d)", mpResourceManager->getRenderScale(), renderSize.x, renderSize.y);
+			pGui->addText(buf);
+			sprintf_s(buf, "Predicted full resolution time: %.2f ms", mDynamicResolution.getFullResolutionTime());
+			pGui->addText(buf);
+		}
+		pGui->addSeparator();
+	}
+
 	if (mPipeRequiresRayTracing && mpResourceManager)
 	{
 		pGui->addText("Set ray tracing min traversal distance:");
@@ -662,6 +700,10 @@ void RenderingPipeline::onFrameRender(SampleCallbacks* pSample, const RenderCont
 		mGlobalPipeRefresh = false;
 	}
 
+	// Pick the render size for this frame, and time the passes for the next ones
+	updateDynamicResolution();
+	if (mpFrameTimers[mFrameTimerIndex]) mpFrameTimers[mFrameTimerIndex]->begin();
+
     // Execute all of the passes in the current pipeline
     for (uint32_t passNum = 0; passNum < mActivePasses.size(); passNum++)
     {
@@ -681,10 +723,20 @@ void RenderingPipeline::onFrameRender(SampleCallbacks* pSample, const RenderCont
         }
     }
 
-	// Now that we're done rendering, grab out output texture and blit it into our target FBO
+	if (mpFrameTimers[mFrameTimerIndex])
+	{
+		mpFrameTimers[mFrameTimerIndex]->end();
+		mFrameTimerScales[mFrameTimerIndex] = mpResourceManager->getRenderScale();
+		mFrameTimerIndex = (mFrameTimerIndex + 1) % kFrameTimerCount;
+	}
+
+	// Now that we're done rendering, grab out output texture and blit it into our target FBO.  With dynamic resolution,
+	//     only the top-left corner was rendered, and the blit upscales it.
 	if (pTargetFbo && mpResourceManager->getTexture(mOutputBufferIndex))
 	{
-		pRenderContext->blit(mpResourceManager->getTexture(mOutputBufferIndex)->getSRV(), pTargetFbo->getColorTexture(0)->getRTV());
+		uvec2 renderSize = mpResourceManager->getRenderSize();
+		uvec4 srcRect = mUseDynamicResolution ? uvec4(0, 0, renderSize.x, renderSize.y) : uvec4(-1);
+		pRenderContext->blit(mpResourceManager->getTexture(mOutputBufferIndex)->getSRV(), pTargetFbo->getColorTexture(0)->getRTV(), srcRect);
 	}
 
 	// Once we're done rendering, clear the pipeline dirty state.
@@ -694,6 +746,33 @@ void RenderingPipeline::onFrameRender(SampleCallbacks* pSample, const RenderCont
 	pRenderContext->popGraphicsState();
 }
 
+void RenderingPipeline::updateDynamicResolution(void)
+{
+	if (!mUseDynamicResolution || !mPipeSupportsDynamicRes)
+	{
+		// Timings measured at another scale, or before the toggle, would mislead the controller once it's re-enabled
+		mUseDynamicResolution = false;
+		for (uint32_t i = 0; i < kFrameTimerCount; i++)
+		{
+			mpFrameTimers[i] = nullptr;
+			mFrameTimerScales[i] = 0.0f;
+		}
+		mpResourceManager->setRenderScale(1.0f);
+		return;
+	}
+
+	// The timer we're about to reuse measured the frame kFrameTimerCount frames ago
+	if (!mpFrameTimers[mFrameTimerIndex])
+	{
+		mpFrameTimers[mFrameTimerIndex] = GpuTimer::create();
+	}
+	else if (mFrameTimerScales[mFrameTimerIndex] > 0.0f)
+	{
+		mDynamicResolution.update(float(mpFrameTimers[mFrameTimerIndex]->getElapsedTime()), mFrameTimerScales[mFrameTimerIndex]);
+	}
+	mpResourceManager->setRenderScale(mDynamicResolution.getScale());
+}
+
 void RenderingPipeline::onInitNewScene(RenderContext* pRenderContext, Scene::SharedPtr pScene)
 {
 	// Stash the scene in the pipeline
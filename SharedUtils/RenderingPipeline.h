@@ -114,6 +114,9 @@ private:
 	// Extract profiling data
 	void extractProfilingData(void);
 
+	// Feed the oldest pending frame time to the dynamic resolution controller and set the render scale for this frame
+	void updateDynamicResolution(void);
+
 	enum UIOptions { CanRemove = 0x1u, CanAddAfter = 0x2u };
 
 	// Internal state
@@ -158,6 +161,16 @@ private:
 	bool mPipeUsesEnvMap         = false;
 	bool mPipeNeedsDefaultScene  = false;
 	bool mPipeHasAnimation       = true;
+	bool mPipeSupportsDynamicRes = false;
+
+	// Dynamic resolution.  The GPU time of the pass loop is measured with a ring of timers, so the result is
+	//     read kFrameTimerCount frames later, when the GPU is done with it, and without stalling.
+	static const uint32_t kFrameTimerCount = 3;
+	bool                        mUseDynamicResolution = false;
+	DynamicResolutionController mDynamicResolution;
+	GpuTimer::SharedPtr         mpFrameTimers[kFrameTimerCount];
+	float                       mFrameTimerScales[kFrameTimerCount];   ///< Render scale of the frame each timer measured, or 0 if there's nothing to read
+	uint32_t                    mFrameTimerIndex = 0;
 
 	// Helpers to clarify code querying if a pass can be removed (or another can be added after it)
 	bool canRemovePass(uint32_t passNum);
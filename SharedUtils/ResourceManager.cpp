@@ -17,10 +17,13 @@
 **********************************************************************************************************************/
 
 #include "ResourceManager.h"
+#include "Utils/ImageProcessing.h"
 
 // The fixed resource name of our output channel
 const std::string ResourceManager::kOutputChannel  = "PipelineOutput";
 const std::string ResourceManager::kEnvironmentMap = "EnvironmentMap";
+const std::string ResourceManager::kEnvironmentMapConditional = "EnvironmentMapConditional";
+const std::string ResourceManager::kEnvironmentMapMarginal = "EnvironmentMapMarginal";
 
 ResourceManager::SharedPtr ResourceManager::create(uint32_t width, uint32_t height, SampleCallbacks *callbacks)
 {
@@ -36,6 +39,10 @@ void ResourceManager::resize(uint32_t width, uint32_t height)
 	mWidth = width;
 	mHeight = height;
 
+	// The history is reallocated, so there is no previous render size to reproject from
+	mRenderSize = DynamicResolutionController::getRenderSize(uvec2(mWidth, mHeight), mRenderScale);
+	mPrevRenderSize = mRenderSize;
+
 	// We can't really do anything with resources when the screen size is 0
 	if (mWidth <= 0 || mHeight <= 0) return;
 
@@ -56,6 +63,14 @@ void ResourceManager::resize(uint32_t width, uint32_t height)
 	mUpdatedFlag = true;
 }
 
+void ResourceManager::setRenderScale(float scale)
+{
+	// Called once per frame, before the passes execute, so the current size becomes last frame's size
+	mRenderScale = glm::clamp(scale, 0.0f, 1.0f);
+	mPrevRenderSize = mRenderSize;
+	mRenderSize = DynamicResolutionController::getRenderSize(uvec2(mWidth, mHeight), mRenderScale);
+}
+
 void ResourceManager::initializeResources()
 {
 	// Create all textures that have not been allocated otherwise.
@@ -82,6 +97,7 @@ bool ResourceManager::updateEnvironmentMap(const std::string &filename)
 		Texture::SharedPtr tmpEnv = Texture::create2D(128, 128, ResourceFormat::RGBA32Float, 1u, 1u, nullptr, ResourceManager::kDefaultFlags);
 		mpAppCallbacks->getRenderContext()->clearUAV(tmpEnv->getUAV().get(), vec4(0.5f, 0.5f, 0.8f, 1.0f));
 		manageTextureResource(ResourceManager::kEnvironmentMap, tmpEnv);
+		updateEnvironmentMapSampling(tmpEnv);
 		mUpdatedFlag = true;
 		return true;
 	}
@@ -90,6 +106,7 @@ bool ResourceManager::updateEnvironmentMap(const std::string &filename)
 		Texture::SharedPtr tmpEnv = Texture::create2D(128, 128, ResourceFormat::RGBA32Float, 1u, 1u, nullptr, ResourceManager::kDefaultFlags);
 		mpAppCallbacks->getRenderContext()->clearUAV(tmpEnv->getUAV().get(), vec4(0.0f, 0.0f, 0.0f, 1.0f));
 		manageTextureResource(ResourceManager::kEnvironmentMap, tmpEnv);
+		updateEnvironmentMapSampling(tmpEnv);
 		mUpdatedFlag = true;
 		return true;
 	}
@@ -103,6 +120,7 @@ bool ResourceManager::updateEnvironmentMap(const std::string &filename)
 			size_t found = filename.find_last_of("/\\");
 			mEnvMapFilename = filename.substr(found + 1).c_str();
 			manageTextureResource(ResourceManager::kEnvironmentMap, envMap);
+			updateEnvironmentMapSampling(envMap);
 			mUpdatedFlag = true;
 			return true;
 		}
@@ -110,6 +128,75 @@ bool ResourceManager::updateEnvironmentMap(const std::string &filename)
 	return false;
 }
 
+void ResourceManager::updateEnvironmentMapSampling(Texture::SharedPtr envMap)
+{
+	CpuTimer timer;
+	timer.update();
+
+	// Grab the top mip level back from the GPU.  This also catches the clears used for the default maps.
+	uint32_t width = envMap->getWidth(), height = envMap->getHeight();
+	ResourceFormat format = envMap->getFormat();
+	uint32_t channels = getFormatChannelCount(format);
+	FormatType type = getFormatType(format);
+	bool isFloat = (type == FormatType::Float) && channels >= 3 && (getFormatBytesPerBlock(format) == 4 * channels || getFormatBytesPerBlock(format) == 2 * channels);
+	bool isRgba8 = (getFormatBytesPerBlock(format) == 4 && channels == 4 && (type == FormatType::Unorm || type == FormatType::UnormSrgb));
+	RenderContext* pContext = mpAppCallbacks->getRenderContext().get();
+	Texture::SharedPtr pReadback = envMap;
+	if (!isFloat && !isRgba8 && isDepthStencilFormat(format) == false && type != FormatType::Uint && type != FormatType::Sint)
+	{
+		// Block-compressed maps (e.g., BC6H from the DDS baker) and other formats are decoded by the GPU into a float copy
+		pReadback = Texture::create2D(width, height, ResourceFormat::RGBA32Float, 1u, 1u, nullptr, Resource::BindFlags::RenderTarget | Resource::BindFlags::ShaderResource);
+		pContext->blit(envMap->getSRV(0, 1), pReadback->getRTV(), uvec4(-1), uvec4(-1), Sampler::Filter::Point);
+		format = ResourceFormat::RGBA32Float;
+		channels = 4;
+		isFloat = true;
+	}
+	std::vector<uint8> texels = pContext->readTextureSubresource(pReadback.get(), 0);
+
+	// Convert to luminance.  Full and half float maps (HDR/EXR files) are used as they are, 8-bit maps are converted, everything else went through the blit above.
+	std::vector<float> luminance;
+	if (isFloat && getFormatBytesPerBlock(format) == 4 * channels)
+	{
+		luminance = EnvMapSampler::computeLuminance(width, height, reinterpret_cast<const float*>(texels.data()), channels);
+	}
+	else if (isFloat)
+	{
+		std::vector<float> texels32(size_t(width) * height * channels);
+		ImageProcessing::halfToFloat(uint32_t(texels32.size()), reinterpret_cast<const uint16_t*>(texels.data()), texels32.data());
+		luminance = EnvMapSampler::computeLuminance(width, height, texels32.data(), channels);
+	}
+	else if (isRgba8)
+	{
+		bool isBgr = (format == ResourceFormat::BGRA8Unorm || format == ResourceFormat::BGRA8UnormSrgb || format == ResourceFormat::BGRX8Unorm || format == ResourceFormat::BGRX8UnormSrgb);
+		std::vector<float> rgb(size_t(width) * height * 3);
+		for (size_t i = 0; i < size_t(width) * height; i++)
+		{
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				float v = texels[i * 4 + (isBgr ? 2 - c : c)] / 255.0f;
+				rgb[i * 3 + c] = isSrgbFormat(format) ? pow(v, 2.2f) : v;
+			}
+		}
+		luminance = EnvMapSampler::computeLuminance(width, height, rgb.data(), 3);
+	}
+	else
+	{
+		logWarning("Environment map format isn't supported for importance sampling.  Falling back to uniform sampling.");
+		luminance.assign(size_t(width) * height, 1.0f);
+	}
+
+	mEnvMapSampler.build(width, height, luminance.data());
+
+	// Upload the tables so shaders can importance sample the map.  See envMapSampling.hlsli.
+	const auto& conditional = mEnvMapSampler.getConditionalTable();
+	const auto& marginal = mEnvMapSampler.getMarginalTable();
+	manageTextureResource(kEnvironmentMapConditional, Texture::create2D(width, height, ResourceFormat::RGBA32Float, 1u, 1u, conditional.data(), Resource::BindFlags::ShaderResource));
+	manageTextureResource(kEnvironmentMapMarginal, Texture::create2D(height, 1, ResourceFormat::RG32Float, 1u, 1u, marginal.data(), Resource::BindFlags::ShaderResource));
+
+	timer.update();
+	logInfo("Built environment map importance sampling tables (" + std::to_string(width) + "x" + std::to_string(height) + ") in " + std::to_string(timer.getElapsedTime() * 1000.0f) + " ms");
+}
+
 uvec2 ResourceManager::getEnvironmentMapSize() const
 {
 	int32_t existingIndex = getTextureIndex(ResourceManager::kEnvironmentMap);
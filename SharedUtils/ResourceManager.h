@@ -18,6 +18,8 @@
 
 #pragma once
 #include "Falcor.h"
+#include "Utils/Math/EnvMapSampling.h"
+#include "Utils/DynamicResolution.h"
 #include <vector>
 #include <map>
 
@@ -31,6 +33,8 @@ public:
 	
 	static const std::string kOutputChannel; 
 	static const std::string kEnvironmentMap;
+	static const std::string kEnvironmentMapConditional;   // Per-texel alias table for importance sampling the environment map (see EnvMapSampler)
+	static const std::string kEnvironmentMapMarginal;      // Per-row alias table for importance sampling the environment map
 
 	// Public ctors and dtors
 	static SharedPtr create(uint32_t width, uint32_t height, SampleCallbacks *callbacks);
@@ -89,6 +93,10 @@ public:
 	Texture::SharedPtr getEnvironmentMap() { return getTexture( kEnvironmentMap );  }
 	uvec2 getEnvironmentMapSize() const;
 
+	// The CPU copy of the environment map importance sampling tables, rebuilt by updateEnvironmentMap().  The same tables
+	//     are available to shaders as the kEnvironmentMapConditional and kEnvironmentMapMarginal textures.
+	const EnvMapSampler& getEnvironmentMapSampler() const { return mEnvMapSampler; }
+
 	// Creates a framebuffer from a set of resources managed by the ResourceManager.  
 	//    -> Note:  This FBO remains valid until haveResourcesChanged() is true, at which point the user needs to recreate it
 	//    -> Color buffers are attached based on their location in the vector.  Invalid indicies (i.e., -1) can be inserted 
@@ -129,6 +137,14 @@ public:
     uint32_t getHeight() const     { return mHeight; }
 	uvec2    getScreenSize() const { return uvec2(mWidth, mHeight); }
 
+	// Dynamic resolution.  Fullscreen channels stay allocated at the screen size, passes that support dynamic resolution
+	//     (see RenderPass::supportsDynamicResolution()) render into the top-left getRenderSize() pixels.  Changing the scale
+	//     does not reallocate anything, so it does not set the haveResourcesChanged() flag.
+	void     setRenderScale(float scale);
+	float    getRenderScale() const     { return mRenderScale; }
+	uvec2    getRenderSize() const      { return mRenderSize; }
+	uvec2    getPrevRenderSize() const  { return mPrevRenderSize; }   // The render size of the previous frame, for passes reading history
+
 	// If resources have changed since last frame (and previous resource pointers may be invalid), this will return true
 	bool haveResourcesChanged() const { return mUpdatedFlag; }
 
@@ -140,7 +156,7 @@ public:
 	void  setMinTDist(float newMinT) { mMinT = newMinT; }
 
 protected:
-	ResourceManager(uint32_t width, uint32_t height, SampleCallbacks *callbacks) : mWidth(width), mHeight(height), mpAppCallbacks(callbacks) {}
+	ResourceManager(uint32_t width, uint32_t height, SampleCallbacks *callbacks) : mWidth(width), mHeight(height), mRenderSize(width, height), mPrevRenderSize(width, height), mpAppCallbacks(callbacks) {}
 
     // Various internal state
     uint32_t mWidth = 0;    
@@ -148,10 +164,16 @@ protected:
 	bool     mIsInitialized = false;
 	bool     mUpdatedFlag = true;
 	float    mMinT = 1.0e-4f;
+	float    mRenderScale = 1.0f;
+	uvec2    mRenderSize;
+	uvec2    mPrevRenderSize;
 
 	// If using the resource manager to manage an environment map, its filename is here.
 	std::string mEnvMapFilename = "";
 
+	// Luminance-based importance sampling tables for the environment map
+	EnvMapSampler mEnvMapSampler;
+
 	// Can specify the default scene to load
 	std::string mDefaultSceneName = "Media/Arcade/Arcade.fscene";
 	bool        mUserSetDefaultScene = false;    // If the developer changes the default scene, assume they want it loaded.
@@ -170,4 +192,7 @@ private:
 	// These are not meant to be exposed outside the class and may not have suitable error checking non-private use.
 	bool hasBindFlag(int32_t index, Resource::BindFlags flag);
 
+	// Read back the environment map and rebuild the importance sampling tables
+	void updateEnvironmentMapSampling(Texture::SharedPtr envMap);
+
 };